@@ -0,0 +1,86 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchChurn.h
+// Desc : Allocation Churn Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __BENCH_CHURN_H__
+#define __BENCH_CHURN_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ChurnDesc structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ChurnDesc
+{
+    std::vector<uint32_t>   Threads;        //!< 計測するスレッド数です.
+    uint32_t                Operations;     //!< 1スレッドあたりの解放 + 確保の回数です.
+    uint32_t                LiveCount;      //!< 1スレッドあたりに保持するブロック数です.
+    uint32_t                MinSize;        //!< 最小確保サイズです.
+    uint32_t                MaxSize;        //!< 最大確保サイズです.
+    uint32_t                Seed;           //!< 乱数シードです.
+    std::string             Filter;         //!< 計測するアロケータ名に含まれる文字列です.
+    uint32_t                FrameCount;     //!< フレームヒープのワークロードで進めるフレーム数です.
+    uint32_t                FrameSize;      //!< フレームヒープの1フレームあたりのバッファサイズです.
+    uint32_t                RingCount;      //!< フレームヒープのリングバッファのフレーム数です.
+
+    ChurnDesc()
+    : Operations( 2000000 )
+    , LiveCount ( 4096 )
+    , MinSize   ( 16 )
+    , MaxSize   ( 256 )
+    , Seed      ( 0x12345678 )
+    , FrameCount( 300 )
+    , FrameSize ( 2 * 1024 * 1024 )
+    , RingCount ( 3 )
+    { /* DO_NOTHING */ }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Random class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class Random
+{
+public:
+    explicit Random( uint32_t seed )
+    : m_State( ( seed != 0 ) ? seed : 0x9e3779b9 )
+    { /* DO_NOTHING */ }
+
+    uint32_t Next()
+    {
+        m_State ^= m_State << 13;
+        m_State ^= m_State >> 17;
+        m_State ^= m_State << 5;
+        return m_State;
+    }
+
+private:
+    uint32_t m_State;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      現在時刻を秒で取得します.
+//-------------------------------------------------------------------------------------------------
+double GetBenchTime();
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      確保と解放を繰り返すワークロードでアロケータの性能を計測します.
+//!
+//! @param[in]      desc        計測設定です.
+//! @retval true    計測に成功.
+//! @retval false   ブロックの破壊を検出.
+//-------------------------------------------------------------------------------------------------
+bool RunChurn( const ChurnDesc& desc );
+
+
+#endif//__BENCH_CHURN_H__
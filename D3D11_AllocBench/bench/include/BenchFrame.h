@@ -0,0 +1,26 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchFrame.h
+// Desc : Frame Heap Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __BENCH_FRAME_H__
+#define __BENCH_FRAME_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchChurn.h>
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      フレームごとに確保し, 数フレーム後にまとめて破棄するワークロードで性能を計測します.
+//!
+//! @param[in]      desc        計測設定です.
+//! @retval true    計測に成功.
+//! @retval false   ブロックの破壊, アライメント違反, またはリングバッファの再利用順の誤りを検出.
+//-------------------------------------------------------------------------------------------------
+bool RunFrame( const ChurnDesc& desc );
+
+
+#endif//__BENCH_FRAME_H__
@@ -0,0 +1,27 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchPlatform.h
+// Desc : Platform Compatibility Layer for Allocator Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __BENCH_PLATFORM_H__
+#define __BENCH_PLATFORM_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdio>
+
+
+//-------------------------------------------------------------------------------------------------
+// ベンチマークは asdx ライブラリをリンクしないため, アロケータのログ出力をここで受け取ります.
+// このヘッダはコンパイラオプションで強制インクルード (/FI, -include) して使用します.
+//-------------------------------------------------------------------------------------------------
+#define DLOGA( fmt, ... )   ((void)0)
+#define ILOGA( fmt, ... )   fprintf( stderr, fmt "\n", ##__VA_ARGS__ )
+#define WLOGA( fmt, ... )   fprintf( stderr, fmt "\n", ##__VA_ARGS__ )
+#define ELOGA( fmt, ... )   fprintf( stderr, "[File: %s, Line: %d] " fmt "\n", __FILE__, __LINE__, ##__VA_ARGS__ )
+#define ELOG                ELOGA
+
+
+#endif//__BENCH_PLATFORM_H__
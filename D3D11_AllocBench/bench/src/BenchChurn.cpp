@@ -0,0 +1,414 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchChurn.cpp
+// Desc : Allocation Churn Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchChurn.h>
+#include <asdxPoolAllocator.h>
+#include <asdxTlsfHeap.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <thread>
+
+
+namespace /* anonymous */ {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ChurnResult structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ChurnResult
+{
+    uint64_t    Operations;     //!< 全スレッドで処理した解放 + 確保の回数です.
+    uint64_t    Errors;         //!< 破壊を検出したブロック数です.
+    double      Seconds;        //!< 計測時間です.
+};
+
+//-------------------------------------------------------------------------------------------------
+//      ブロック末尾に書き込む検査値を求めます.
+//-------------------------------------------------------------------------------------------------
+inline uint32_t GetCheck( const void* ptr, uint32_t size )
+{ return uint32_t( reinterpret_cast<uintptr_t>( ptr ) >> 4 ) ^ ( size * 0x9e3779b9 ); }
+
+//-------------------------------------------------------------------------------------------------
+//      ブロック末尾にサイズと検査値を書き込みます.
+//-------------------------------------------------------------------------------------------------
+inline void Stamp( void* ptr, uint32_t size )
+{
+    uint32_t tail[2] = { size, GetCheck( ptr, size ) };
+    memcpy( static_cast<uint8_t*>( ptr ) + size - sizeof(tail), tail, sizeof(tail) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ブロック末尾の検査値を確認します.
+//-------------------------------------------------------------------------------------------------
+inline bool Verify( const void* ptr, uint32_t size )
+{
+    uint32_t tail[2];
+    memcpy( tail, static_cast<const uint8_t*>( ptr ) + size - sizeof(tail), sizeof(tail) );
+    return tail[0] == size && tail[1] == GetCheck( ptr, size );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SystemHeap structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct SystemHeap
+{
+    static void* Alloc( uint32_t& size )
+    { return ::operator new( size, std::nothrow ); }
+
+    static void Free( void* ptr, uint32_t )
+    { ::operator delete( ptr ); }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PoolHeap structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct PoolHeap
+{
+    static void* Alloc( uint32_t& size )
+    { return asdx::PoolAllocator::GetInstance().Alloc( size ); }
+
+    static void Free( void* ptr, uint32_t size )
+    { asdx::PoolAllocator::GetInstance().Free( ptr, size ); }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TlsfHeap structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct TlsfHeap
+{
+    static asdx::TlsfHeap& GetInstance()
+    {
+        static asdx::TlsfHeap s_Heap;
+        return s_Heap;
+    }
+
+    static bool Reset()
+    {
+        asdx::TlsfHeapDesc desc;
+        desc.PoolSize = 16 * 1024 * 1024;
+        desc.GrowSize = 16 * 1024 * 1024;
+        return GetInstance().Init( desc );
+    }
+
+    static void* Alloc( uint32_t& size )
+    { return GetInstance().Alloc( size ); }
+
+    static void Free( void* ptr, uint32_t )
+    { GetInstance().Free( ptr ); }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// STATS_KIND enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum STATS_KIND
+{
+    STATS_NONE = 0,     //!< 統計情報を表示しません.
+    STATS_POOL,         //!< asdx::PoolAllocator の統計情報を表示します.
+    STATS_TLSF,         //!< asdx::TlsfHeap の統計情報を表示します.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IRecord interface
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct IRecord
+{
+    virtual ~IRecord() {}
+};
+
+template<size_t N>
+struct SystemRecord : public IRecord
+{ uint8_t Payload[N]; };
+
+template<size_t N>
+struct PoolRecord : public IRecord, public asdx::PoolObject
+{ uint8_t Payload[N]; };
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ObjectHeap structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// 履歴やノードのように基底クラス経由で delete される3種類のサイズのオブジェクトを生成します.
+template<template<size_t> class TRecord>
+struct ObjectHeap
+{
+    static void* Alloc( uint32_t& size )
+    {
+        IRecord* ptr;
+        if ( size <= 64 )
+        { ptr = new TRecord<24>(); size = sizeof(TRecord<24>); }
+        else if ( size <= 128 )
+        { ptr = new TRecord<56>(); size = sizeof(TRecord<56>); }
+        else
+        { ptr = new TRecord<120>(); size = sizeof(TRecord<120>); }
+
+        return ptr;
+    }
+
+    static void Free( void* ptr, uint32_t )
+    { delete static_cast<IRecord*>( ptr ); }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Slot structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct Slot
+{
+    void*       Ptr;
+    uint32_t    Size;
+};
+
+//-------------------------------------------------------------------------------------------------
+//      全スレッドの開始をそろえてワーカーを実行します.
+//-------------------------------------------------------------------------------------------------
+template<typename TFunc>
+double RunWorkers( uint32_t threadCount, TFunc func )
+{
+    std::atomic<uint32_t> ready( 0 );
+    std::atomic<bool>     start( false );
+
+    std::vector<std::thread> workers;
+    workers.reserve( threadCount );
+
+    for( uint32_t t=0; t<threadCount; ++t )
+    {
+        workers.emplace_back( [&, t]()
+        {
+            ready.fetch_add( 1 );
+            while( !start.load() )
+            { std::this_thread::yield(); }
+
+            func( t );
+        });
+    }
+
+    while( ready.load() < threadCount )
+    { std::this_thread::yield(); }
+
+    auto begin = GetBenchTime();
+    start.store( true );
+
+    for( auto& worker : workers )
+    { worker.join(); }
+
+    return GetBenchTime() - begin;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      スレッドごとに保持したブロックをランダムに入れ替えます.
+//-------------------------------------------------------------------------------------------------
+template<typename THeap>
+ChurnResult RunLocal( const ChurnDesc& desc, uint32_t threadCount )
+{
+    std::atomic<uint64_t> errors( 0 );
+    auto range = desc.MaxSize - desc.MinSize + 1;
+
+    ChurnResult result = {};
+    result.Seconds = RunWorkers( threadCount, [&]( uint32_t t )
+    {
+        Random random( desc.Seed + t * 7919 );
+        std::vector<Slot> live( desc.LiveCount );
+
+        for( auto& slot : live )
+        {
+            slot.Size = desc.MinSize + random.Next() % range;
+            slot.Ptr  = THeap::Alloc( slot.Size );
+            Stamp( slot.Ptr, slot.Size );
+        }
+
+        uint64_t localErrors = 0;
+        for( uint32_t i=0; i<desc.Operations; ++i )
+        {
+            auto& slot = live[ random.Next() % desc.LiveCount ];
+            if ( !Verify( slot.Ptr, slot.Size ) )
+            { localErrors++; }
+
+            THeap::Free( slot.Ptr, slot.Size );
+
+            slot.Size = desc.MinSize + random.Next() % range;
+            slot.Ptr  = THeap::Alloc( slot.Size );
+            Stamp( slot.Ptr, slot.Size );
+        }
+
+        for( auto& slot : live )
+        {
+            if ( !Verify( slot.Ptr, slot.Size ) )
+            { localErrors++; }
+
+            THeap::Free( slot.Ptr, slot.Size );
+        }
+
+        errors.fetch_add( localErrors );
+    });
+
+    result.Operations = uint64_t( desc.Operations ) * threadCount;
+    result.Errors     = errors.load();
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      全スレッドで共有したスロットを入れ替え, 他スレッドが確保したブロックを解放させます.
+//-------------------------------------------------------------------------------------------------
+template<typename THeap>
+ChurnResult RunCross( const ChurnDesc& desc, uint32_t threadCount )
+{
+    std::atomic<uint64_t> errors( 0 );
+    auto range     = desc.MaxSize - desc.MinSize + 1;
+    auto slotCount = desc.LiveCount * threadCount;
+
+    // ブロック先頭にサイズを置き, 解放するスレッドがサイズを知れるようにします.
+    std::vector<std::atomic<void*>> slots( slotCount );
+    for( auto& slot : slots )
+    { slot.store( nullptr ); }
+
+    auto release = [&]( void* ptr, uint64_t& localErrors )
+    {
+        uint32_t size;
+        memcpy( &size, ptr, sizeof(size) );
+        if ( !Verify( ptr, size ) )
+        { localErrors++; }
+
+        THeap::Free( ptr, size );
+    };
+
+    ChurnResult result = {};
+    result.Seconds = RunWorkers( threadCount, [&]( uint32_t t )
+    {
+        Random   random( desc.Seed + t * 7919 );
+        uint64_t localErrors = 0;
+
+        for( uint32_t i=0; i<desc.Operations; ++i )
+        {
+            auto& slot = slots[ random.Next() % slotCount ];
+
+            auto size = desc.MinSize + random.Next() % range;
+            auto ptr  = THeap::Alloc( size );
+            memcpy( ptr, &size, sizeof(size) );
+            Stamp( ptr, size );
+
+            auto prev = slot.exchange( ptr, std::memory_order_acq_rel );
+            if ( prev != nullptr )
+            { release( prev, localErrors ); }
+        }
+
+        errors.fetch_add( localErrors );
+    });
+
+    uint64_t localErrors = 0;
+    for( auto& slot : slots )
+    {
+        auto ptr = slot.load();
+        if ( ptr != nullptr )
+        { release( ptr, localErrors ); }
+    }
+
+    result.Operations = uint64_t( desc.Operations ) * threadCount;
+    result.Errors     = errors.load() + localErrors;
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      結果を表示します.
+//-------------------------------------------------------------------------------------------------
+void PrintResult( const char* name, uint32_t threads, const ChurnResult& item, STATS_KIND kind )
+{
+    auto mops    = ( item.Seconds > 0.0 ) ? double( item.Operations ) / item.Seconds / 1e6 : 0.0;
+    auto nsPerOp = ( item.Operations > 0 ) ? item.Seconds * 1e9 * threads / double( item.Operations ) : 0.0;
+
+    printf( "%-14s %7u %10.2f %8.1f", name, threads, mops, nsPerOp );
+
+    if ( kind == STATS_POOL )
+    {
+        uint64_t slabs = 0;
+        uint64_t peak  = 0;
+        auto& allocator = asdx::PoolAllocator::GetInstance();
+        for( auto i=0u; i<asdx::PoolAllocator::kClassCount; ++i )
+        {
+            auto stats = allocator.GetStats( i );
+            slabs += stats.SlabCount;
+            peak  += stats.PeakInUse;
+        }
+        printf( " %8llu %10llu", (unsigned long long)slabs, (unsigned long long)peak );
+    }
+    else if ( kind == STATS_TLSF )
+    {
+        // 全ブロック解放後なので, 空きブロック数がプール数と一致すれば全て結合できています.
+        auto stats = TlsfHeap::GetInstance().GetStats();
+        printf( " %8u %10s  peak = %zu KB, free blocks = %u",
+            stats.PoolCount, "-", stats.PeakUsedSize / 1024, stats.FreeBlockCount );
+    }
+
+    printf( "\n" );
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      現在時刻を秒で取得します.
+//-------------------------------------------------------------------------------------------------
+double GetBenchTime()
+{
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double>( now ).count();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      確保と解放を繰り返すワークロードでアロケータの性能を計測します.
+//-------------------------------------------------------------------------------------------------
+bool RunChurn( const ChurnDesc& desc )
+{
+    printf( "operations = %u / thread, live = %u / thread, size = %u - %u\n",
+        desc.Operations, desc.LiveCount, desc.MinSize, desc.MaxSize );
+    printf( "%-14s %7s %10s %8s %8s %10s\n", "allocator", "threads", "Mops/s", "ns/op", "slabs", "peak" );
+
+    auto errors = 0ull;
+    auto run = [&]( const char* name, ChurnResult (*func)( const ChurnDesc&, uint32_t ), uint32_t threads, STATS_KIND kind )
+    {
+        if ( !desc.Filter.empty() && strstr( name, desc.Filter.c_str() ) == nullptr )
+        { return; }
+
+        if ( kind == STATS_TLSF && !TlsfHeap::Reset() )
+        {
+            errors++;
+            return;
+        }
+
+        auto result = func( desc, threads );
+        PrintResult( name, threads, result, kind );
+        errors += result.Errors;
+    };
+
+    for( auto threads : desc.Threads )
+    {
+        run( "system",       RunLocal<SystemHeap>,                 threads, STATS_NONE );
+        run( "pool",         RunLocal<PoolHeap>,                   threads, STATS_POOL );
+        run( "tlsf",         RunLocal<TlsfHeap>,                   threads, STATS_TLSF );
+        run( "system_obj",   RunLocal<ObjectHeap<SystemRecord>>,   threads, STATS_NONE );
+        run( "pool_obj",     RunLocal<ObjectHeap<PoolRecord>>,     threads, STATS_POOL );
+        run( "system_cross", RunCross<SystemHeap>,                 threads, STATS_NONE );
+        run( "pool_cross",   RunCross<PoolHeap>,                   threads, STATS_POOL );
+        run( "tlsf_cross",   RunCross<TlsfHeap>,                   threads, STATS_TLSF );
+    }
+
+    if ( errors != 0 )
+    {
+        fprintf( stderr, "Error : Corrupted Blocks. count = %llu\n", errors );
+        return false;
+    }
+
+    return true;
+}
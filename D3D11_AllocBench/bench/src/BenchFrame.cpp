@@ -0,0 +1,408 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchFrame.cpp
+// Desc : Frame Heap Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchFrame.h>
+#include <asdxFrameHeap.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#if defined(_WIN32)
+    #include <malloc.h>
+#endif//defined(_WIN32)
+
+
+namespace /* anonymous */ {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FrameResult structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct FrameResult
+{
+    uint64_t    Operations;     //!< 全スレッドで確保した回数です.
+    uint64_t    Errors;         //!< 破壊またはアライメント違反を検出したブロック数です.
+    uint64_t    WrapErrors;     //!< リングバッファの再利用順が誤っていたフレーム数です.
+    double      Seconds;        //!< 確保にかかった時間の合計です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Block structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct Block
+{
+    uint8_t*    Ptr;
+    uint32_t    Size;
+    uint8_t     Fill;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Barrier class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class Barrier
+{
+public:
+    explicit Barrier( uint32_t count )
+    : m_Count       ( count )
+    , m_Waiting     ( 0 )
+    , m_Generation  ( 0 )
+    { /* DO_NOTHING */ }
+
+    void Wait()
+    {
+        auto generation = m_Generation.load( std::memory_order_acquire );
+        if ( m_Waiting.fetch_add( 1, std::memory_order_acq_rel ) + 1 == m_Count )
+        {
+            m_Waiting.store( 0, std::memory_order_relaxed );
+            m_Generation.fetch_add( 1, std::memory_order_acq_rel );
+            return;
+        }
+
+        while( m_Generation.load( std::memory_order_acquire ) == generation )
+        { std::this_thread::yield(); }
+    }
+
+private:
+    uint32_t                m_Count;
+    std::atomic<uint32_t>   m_Waiting;
+    std::atomic<uint32_t>   m_Generation;
+};
+
+//-------------------------------------------------------------------------------------------------
+//      ブロック先頭に書き込む検査値を求めます.
+//-------------------------------------------------------------------------------------------------
+inline uint32_t GetCheck( const void* ptr, uint32_t size, uint8_t fill )
+{ return uint32_t( reinterpret_cast<uintptr_t>( ptr ) >> 3 ) ^ ( size * 0x9e3779b9 ) ^ fill; }
+
+//-------------------------------------------------------------------------------------------------
+//      ブロック全体を埋め, 先頭にサイズと検査値を書き込みます.
+//-------------------------------------------------------------------------------------------------
+inline void Stamp( const Block& block )
+{
+    memset( block.Ptr, block.Fill, block.Size );
+
+    uint32_t head[2] = { block.Size, GetCheck( block.Ptr, block.Size, block.Fill ) };
+    memcpy( block.Ptr, head, sizeof(head) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ブロック先頭の検査値と末尾の値を確認します.
+//-------------------------------------------------------------------------------------------------
+inline bool Verify( const Block& block )
+{
+    uint32_t head[2];
+    memcpy( head, block.Ptr, sizeof(head) );
+    return head[0] == block.Size
+        && head[1] == GetCheck( block.Ptr, block.Size, block.Fill )
+        && block.Ptr[ block.Size - 1 ] == block.Fill;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SystemFrame class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// フレームヒープを使わず, 破棄するフレームでブロックを1つずつ解放します.
+class SystemFrame
+{
+public:
+    bool  Init( const ChurnDesc&, uint32_t ) { return true; }
+    void  Term() { /* DO_NOTHING */ }
+    void  NextFrame() { /* DO_NOTHING */ }
+    void* Probe() { return nullptr; }
+
+    void* Alloc( uint32_t, uint32_t size, uint32_t alignment )
+    {
+    #if defined(_WIN32)
+        return _aligned_malloc( size, alignment );
+    #else
+        void* ptr = nullptr;
+        return ( posix_memalign( &ptr, alignment, size ) == 0 ) ? ptr : nullptr;
+    #endif
+    }
+
+    void Free( void* ptr )
+    {
+    #if defined(_WIN32)
+        _aligned_free( ptr );
+    #else
+        free( ptr );
+    #endif
+    }
+
+    void PrintStats() const { /* DO_NOTHING */ }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// HeapFrame class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// 全スレッドから asdx::FrameHeap::Alloc() を呼び出します.
+class HeapFrame
+{
+public:
+    bool Init( const ChurnDesc& desc, uint32_t )
+    { return m_Heap.Init( desc.FrameSize, desc.RingCount ); }
+
+    void Term()
+    { m_Heap.Term(); }
+
+    void NextFrame()
+    { m_Heap.NextFrame(); }
+
+    // フレーム先頭の確保はバッファ先頭を返すので, どのバッファに切り替わったか分かります.
+    void* Probe()
+    { return m_Heap.Alloc( 16, 16 ); }
+
+    void* Alloc( uint32_t, uint32_t size, uint32_t alignment )
+    { return m_Heap.Alloc( size, alignment ); }
+
+    void Free( void* )
+    { /* DO_NOTHING */ }
+
+    void PrintStats() const
+    {
+        printf( " %8u %10zu",
+            m_Heap.GetOverflowCount(),
+            m_Heap.GetHighWaterMark() / 1024 );
+    }
+
+protected:
+    asdx::FrameHeap m_Heap;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ArenaFrame class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// スレッドごとの asdx::FrameArena を経由して確保します.
+class ArenaFrame : public HeapFrame
+{
+public:
+    bool Init( const ChurnDesc& desc, uint32_t threadCount )
+    {
+        if ( !HeapFrame::Init( desc, threadCount ) )
+        { return false; }
+
+        m_Arenas.reset( new asdx::FrameArena[ threadCount ] );
+        for( uint32_t t=0; t<threadCount; ++t )
+        {
+            if ( !m_Arenas[t].Init( &m_Heap ) )
+            { return false; }
+        }
+
+        return true;
+    }
+
+    void Term()
+    {
+        m_Arenas.reset();
+        HeapFrame::Term();
+    }
+
+    void* Alloc( uint32_t thread, uint32_t size, uint32_t alignment )
+    { return m_Arenas[ thread ].Alloc( size, alignment ); }
+
+private:
+    std::unique_ptr<asdx::FrameArena[]> m_Arenas;
+};
+
+//-------------------------------------------------------------------------------------------------
+//      フレームごとに全スレッドで確保し, リングバッファ分のフレームを保持し続けます.
+//-------------------------------------------------------------------------------------------------
+template<typename THeap>
+FrameResult RunFrames( const ChurnDesc& desc, uint32_t threadCount )
+{
+    FrameResult result = {};
+
+    THeap heap;
+    if ( !heap.Init( desc, threadCount ) )
+    {
+        result.Errors = 1;
+        return result;
+    }
+
+    auto range = desc.MaxSize - desc.MinSize + 1;
+    auto ring  = desc.RingCount;
+
+    std::atomic<uint64_t> errors( 0 );
+    Barrier               barrier( threadCount );
+    double                seconds = 0.0;
+
+    // フレーム N のメモリはフレーム N + ring で再利用されるので, 先頭アドレスは ring フレーム周期で一巡します.
+    std::vector<void*> bases( desc.FrameCount, nullptr );
+    bases[0] = heap.Probe();
+
+    auto worker = [&]( uint32_t t )
+    {
+        Random   random( desc.Seed + t * 7919 );
+        uint64_t localErrors = 0;
+
+        std::vector<std::vector<Block>> frames( ring );
+        for( auto& blocks : frames )
+        { blocks.reserve( desc.LiveCount ); }
+
+        for( uint32_t f=0; f<desc.FrameCount; ++f )
+        {
+            barrier.Wait();
+            auto begin = ( t == 0 ) ? GetBenchTime() : 0.0;
+
+            // ring フレーム前のブロックは再利用されたバッファにあるので手放します.
+            auto& blocks = frames[ f % ring ];
+            for( auto& block : blocks )
+            { heap.Free( block.Ptr ); }
+            blocks.clear();
+
+            for( uint32_t i=0; i<desc.LiveCount; ++i )
+            {
+                Block block;
+                auto alignment = 8u << ( random.Next() % 4 );
+                block.Size = desc.MinSize + random.Next() % range;
+                block.Fill = uint8_t( f * 31 + t * 7 + 1 );
+                block.Ptr  = static_cast<uint8_t*>( heap.Alloc( t, block.Size, alignment ) );
+
+                if ( block.Ptr == nullptr || ( reinterpret_cast<uintptr_t>( block.Ptr ) & ( alignment - 1 ) ) != 0 )
+                {
+                    localErrors++;
+                    continue;
+                }
+
+                Stamp( block );
+                blocks.push_back( block );
+            }
+
+            barrier.Wait();
+            if ( t == 0 )
+            { seconds += GetBenchTime() - begin; }
+
+            // 他スレッドの確保と保持中のフレームが重なっていないことを確認します.
+            for( auto& items : frames )
+            {
+                for( auto& block : items )
+                {
+                    if ( !Verify( block ) )
+                    { localErrors++; }
+                }
+            }
+
+            barrier.Wait();
+            if ( t == 0 && f + 1 < desc.FrameCount )
+            {
+                heap.NextFrame();
+                bases[ f + 1 ] = heap.Probe();
+            }
+        }
+
+        for( auto& blocks : frames )
+        {
+            for( auto& block : blocks )
+            { heap.Free( block.Ptr ); }
+        }
+
+        errors.fetch_add( localErrors );
+    };
+
+    std::vector<std::thread> workers;
+    for( uint32_t t=1; t<threadCount; ++t )
+    { workers.emplace_back( worker, t ); }
+
+    worker( 0 );
+
+    for( auto& item : workers )
+    { item.join(); }
+
+    // 同じバッファに戻るのは ring フレームごとで, その間は別のバッファを使っていることを確認します.
+    for( uint32_t f=0; f<desc.FrameCount; ++f )
+    {
+        if ( bases[f] == nullptr )
+        { continue; }
+
+        auto reused  = ( f >= ring ) && ( bases[f] != bases[ f - ring ] );
+        auto swapped = ( f >= 1 && ring > 1 ) && ( bases[f] == bases[ f - 1 ] );
+        if ( reused || swapped )
+        { result.WrapErrors++; }
+    }
+
+    result.Operations = uint64_t( desc.FrameCount ) * desc.LiveCount * threadCount;
+    result.Errors     = errors.load();
+    result.Seconds    = seconds;
+
+    heap.PrintStats();
+    heap.Term();
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      結果を表示します.
+//-------------------------------------------------------------------------------------------------
+void PrintResult( const FrameResult& item, uint32_t threads )
+{
+    auto mops    = ( item.Seconds > 0.0 ) ? double( item.Operations ) / item.Seconds / 1e6 : 0.0;
+    auto nsPerOp = ( item.Operations > 0 ) ? item.Seconds * 1e9 * threads / double( item.Operations ) : 0.0;
+
+    printf( " %10.2f %8.1f", mops, nsPerOp );
+
+    if ( item.Errors != 0 || item.WrapErrors != 0 )
+    { printf( "  errors = %llu, wrap errors = %llu", (unsigned long long)item.Errors, (unsigned long long)item.WrapErrors ); }
+
+    printf( "\n" );
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      フレームごとに確保し, 数フレーム後にまとめて破棄するワークロードで性能を計測します.
+//-------------------------------------------------------------------------------------------------
+bool RunFrame( const ChurnDesc& desc )
+{
+    auto match = [&]( const char* name )
+    { return desc.Filter.empty() || strstr( name, desc.Filter.c_str() ) != nullptr; };
+
+    if ( !match( "system_frame" ) && !match( "frame_heap" ) && !match( "frame_arena" ) )
+    { return true; }
+
+    printf( "\nframes = %u, ring = %u, frame size = %u KB, allocations = %u / thread / frame\n",
+        desc.FrameCount, desc.RingCount, desc.FrameSize / 1024, desc.LiveCount );
+    printf( "%-14s %7s %8s %10s %10s %8s\n", "allocator", "threads", "overflow", "peak KB", "Mops/s", "ns/op" );
+
+    auto errors = 0ull;
+    auto run = [&]( const char* name, FrameResult (*func)( const ChurnDesc&, uint32_t ), uint32_t threads )
+    {
+        if ( !match( name ) )
+        { return; }
+
+        printf( "%-14s %7u", name, threads );
+        if ( strcmp( name, "system_frame" ) == 0 )
+        { printf( " %8s %10s", "-", "-" ); }
+
+        auto result = func( desc, threads );
+        PrintResult( result, threads );
+        errors += result.Errors + result.WrapErrors;
+    };
+
+    for( auto threads : desc.Threads )
+    {
+        run( "system_frame", RunFrames<SystemFrame>, threads );
+        run( "frame_heap",   RunFrames<HeapFrame>,   threads );
+        run( "frame_arena",  RunFrames<ArenaFrame>,  threads );
+    }
+
+    if ( errors != 0 )
+    {
+        fprintf( stderr, "Error : Frame Heap Check Failed. count = %llu\n", errors );
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,137 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : main.cpp
+// Desc : Allocator Benchmark Main Entry Point.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchChurn.h>
+#include <BenchFrame.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+//      カンマ区切りの数値リストを解析します.
+//-------------------------------------------------------------------------------------------------
+void ParseList( const char* text, std::vector<uint32_t>& result )
+{
+    result.clear();
+    for( auto p = text; *p != '\0'; )
+    {
+        char* end = nullptr;
+        auto value = strtoul( p, &end, 0 );
+        if ( end == p )
+        { break; }
+
+        if ( value > 0 )
+        { result.push_back( uint32_t( value ) ); }
+
+        p = ( *end == ',' ) ? end + 1 : end;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      使用方法を表示します.
+//-------------------------------------------------------------------------------------------------
+void PrintUsage()
+{
+    printf( "Usage : bench [options]\n" );
+    printf( "  -threads <a,b,...>   thread counts (default: 1,2,4)\n" );
+    printf( "  -ops <N>             free + alloc pairs per thread (default: 2000000)\n" );
+    printf( "  -live <N>            blocks held per thread (default: 4096)\n" );
+    printf( "  -minsize <N>         minimum block size, at least 16 (default: 16)\n" );
+    printf( "  -maxsize <N>         maximum block size (default: 256)\n" );
+    printf( "  -seed <N>            random seed (default: 305419896)\n" );
+    printf( "  -filter <text>       run only allocators whose name contains <text>\n" );
+    printf( "  -frames <N>          frames run by the frame heap workloads (default: 300)\n" );
+    printf( "  -framesize <KB>      frame heap buffer size per frame (default: 2048)\n" );
+    printf( "  -ring <N>            frames kept alive by the frame heap (default: 3)\n" );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      コマンドライン引数を解析します.
+//-------------------------------------------------------------------------------------------------
+bool ParseArgs( int argc, char** argv, ChurnDesc& desc )
+{
+    for( auto i=1; i<argc; ++i )
+    {
+        auto hasNext = ( i + 1 < argc );
+
+        if ( strcmp( argv[i], "-threads" ) == 0 && hasNext )
+        { ParseList( argv[++i], desc.Threads ); }
+        else if ( strcmp( argv[i], "-ops" ) == 0 && hasNext )
+        { desc.Operations = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else if ( strcmp( argv[i], "-live" ) == 0 && hasNext )
+        { desc.LiveCount = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else if ( strcmp( argv[i], "-minsize" ) == 0 && hasNext )
+        { desc.MinSize = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else if ( strcmp( argv[i], "-maxsize" ) == 0 && hasNext )
+        { desc.MaxSize = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else if ( strcmp( argv[i], "-seed" ) == 0 && hasNext )
+        { desc.Seed = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else if ( strcmp( argv[i], "-filter" ) == 0 && hasNext )
+        { desc.Filter = argv[++i]; }
+        else if ( strcmp( argv[i], "-frames" ) == 0 && hasNext )
+        { desc.FrameCount = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else if ( strcmp( argv[i], "-framesize" ) == 0 && hasNext )
+        { desc.FrameSize = uint32_t( strtoul( argv[++i], nullptr, 0 ) ) * 1024; }
+        else if ( strcmp( argv[i], "-ring" ) == 0 && hasNext )
+        { desc.RingCount = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else
+        {
+            fprintf( stderr, "Error : Unknown Option. option = %s\n", argv[i] );
+            PrintUsage();
+            return false;
+        }
+    }
+
+    // 末尾に検査値を書き込むため 16byte 未満は扱わない.
+    if ( desc.MinSize < 16 || desc.MaxSize < desc.MinSize || desc.LiveCount == 0 )
+    {
+        fprintf( stderr, "Error : Invalid Size Range. min = %u, max = %u, live = %u\n",
+            desc.MinSize, desc.MaxSize, desc.LiveCount );
+        return false;
+    }
+
+    if ( desc.FrameCount == 0 || desc.FrameSize == 0 || desc.RingCount == 0 )
+    {
+        fprintf( stderr, "Error : Invalid Frame Setting. frames = %u, size = %u, ring = %u\n",
+            desc.FrameCount, desc.FrameSize, desc.RingCount );
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-------------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+    ChurnDesc desc;
+    if ( !ParseArgs( argc, argv, desc ) )
+    { return -1; }
+
+    if ( desc.Threads.empty() )
+    {
+        desc.Threads.push_back( 1 );
+        desc.Threads.push_back( 2 );
+        desc.Threads.push_back( 4 );
+    }
+
+    auto ret = RunChurn( desc );
+    ret = RunFrame( desc ) && ret;
+
+    return ret ? 0 : 1;
+}
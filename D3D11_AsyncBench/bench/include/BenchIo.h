@@ -0,0 +1,28 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchIo.h
+// Desc : Async File I/O Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __BENCH_IO_H__
+#define __BENCH_IO_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchLoader.h>
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      作業ディレクトリに書き出したファイルで asdx::IoService を検証し, 負荷試験を行います.
+//!
+//! @param[in]      desc        計測設定です.
+//! @retval true    全ての検証に成功.
+//! @retval false   検証に失敗.
+//! @note       未初期化時 (その場で実行), スレッドプール, io_uring の初期化に失敗した場合のフォールバック,
+//!             io_uring の順に実行します. io_uring が使用できない環境では io_uring の検証を省略します.
+//-------------------------------------------------------------------------------------------------
+bool RunIo( const BenchDesc& desc );
+
+
+#endif//__BENCH_IO_H__
@@ -0,0 +1,80 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchLoader.h
+// Desc : Async Loader Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __BENCH_LOADER_H__
+#define __BENCH_LOADER_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BenchDesc structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BenchDesc
+{
+    uint32_t    Threads;        //!< ワーカースレッド数です. 0 の場合は自動で決定します.
+    uint32_t    Requests;       //!< 負荷試験で要求するリソース数です.
+    uint32_t    DecodeUsec;     //!< 1リソースあたりのデコード時間の最大値 [usec] です.
+    uint32_t    CreateUsec;     //!< 1リソースあたりの生成時間 [usec] です.
+    double      FrameBudget;    //!< 1フレームあたりの生成処理の予算時間 [msec] です.
+    uint32_t    Seed;           //!< 乱数シードです.
+    std::string Dir;            //!< I/O の検証に使用するファイルの作成先です.
+    uint32_t    Batches;        //!< I/O の負荷試験で1スレッドあたりに投入するバッチ数です.
+    uint32_t    QueueDepth;     //!< io_uring の同時発行数です.
+
+    BenchDesc()
+    : Threads       ( 0 )
+    , Requests      ( 2000 )
+    , DecodeUsec    ( 500 )
+    , CreateUsec    ( 100 )
+    , FrameBudget   ( 2.0 )
+    , Seed          ( 0x12345678 )
+    , Dir           ( "async_bench_io" )
+    , Batches       ( 200 )
+    , QueueDepth    ( 8 )
+    { /* DO_NOTHING */ }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Random class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class Random
+{
+public:
+    explicit Random( uint32_t seed )
+    : m_State( ( seed != 0 ) ? seed : 0x9e3779b9 )
+    { /* DO_NOTHING */ }
+
+    uint32_t Next()
+    {
+        m_State ^= m_State << 13;
+        m_State ^= m_State >> 17;
+        m_State ^= m_State << 5;
+        return m_State;
+    }
+
+private:
+    uint32_t m_State;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      デバイスを使用しない疑似リソースで asdx::AsyncLoader を検証し, 負荷試験を行います.
+//!
+//! @param[in]      desc        計測設定です.
+//! @retval true    全ての検証に成功.
+//! @retval false   検証に失敗.
+//! @note       ジョブシステムの未初期化時 (その場で実行), ワーカー1つ, 指定したワーカー数の順に実行します.
+//-------------------------------------------------------------------------------------------------
+bool RunLoader( const BenchDesc& desc );
+
+
+#endif//__BENCH_LOADER_H__
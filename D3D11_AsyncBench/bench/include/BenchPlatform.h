@@ -0,0 +1,40 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchPlatform.h
+// Desc : Platform Compatibility Layer for Async Loading Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __BENCH_PLATFORM_H__
+#define __BENCH_PLATFORM_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdio>
+#include <cstdint>
+
+
+//-------------------------------------------------------------------------------------------------
+// ベンチマークは asdx ライブラリをリンクしないため, ローダーのログ出力をここで受け取ります.
+// このヘッダはコンパイラオプションで強制インクルード (/FI, -include) して使用します.
+// 読み込みの失敗を意図的に発生させるため, 失敗時の警告は出力しません.
+//-------------------------------------------------------------------------------------------------
+#define DLOGA( fmt, ... )   ((void)0)
+#define ILOGA( fmt, ... )   fprintf( stderr, fmt "\n", ##__VA_ARGS__ )
+#define WLOGA( fmt, ... )   ((void)0)
+#define ELOGA( fmt, ... )   fprintf( stderr, "[File: %s, Line: %d] " fmt "\n", __FILE__, __LINE__, ##__VA_ARGS__ )
+#define ELOG                ELOGA
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      高分解能タイマーの現在値を秒単位で取得します.
+//-------------------------------------------------------------------------------------------------
+double GetBenchTime();
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ディレクトリを作成します. 既に存在する場合も成功とし, 同名のファイルがある場合は失敗とします.
+//-------------------------------------------------------------------------------------------------
+bool CreateBenchDirectory( const char* path );
+
+
+#endif//__BENCH_PLATFORM_H__
@@ -0,0 +1,461 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchIo.cpp
+// Desc : Async File I/O Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchPlatform.h>
+#include <BenchIo.h>
+#include <asdxIoService.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+
+//-------------------------------------------------------------------------------------------------
+// Macros
+//-------------------------------------------------------------------------------------------------
+#define BENCH_EXPECT( cond )                                                            \
+    if ( !( cond ) )                                                                    \
+    {                                                                                   \
+        fprintf( stderr, "    failed : %s (line %d)\n", #cond, __LINE__ );              \
+        return false;                                                                   \
+    }
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const uint32_t   kFileCount      = 8;                // 作成するファイル数です.
+static const uint32_t   kMinFileSize    = 64 * 1024;        // ファイルサイズの最小値です.
+static const uint32_t   kMaxFileSize    = 1024 * 1024;      // ファイルサイズの最大値です.
+static const uint32_t   kSubmitThreads  = 4;                // 負荷試験で同時に投入するスレッド数です.
+static const uint32_t   kBadQueueDepth  = 65536;            // io_uring_setup() が拒否する同時発行数です (上限は 32768).
+static const int32_t    kMissingFile    = -1;               // 存在しないファイルを表す番号です.
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IoCorpus structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct IoCorpus
+{
+    std::vector<std::string>            Paths;      //!< ファイルパスです.
+    std::vector<std::vector<uint8_t>>   Data;       //!< ファイルの内容です.
+    std::string                         Missing;    //!< 存在しないファイルのパスです.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// RequestList class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  読み込み要求と格納先をまとめて保持し, 結果をファイルの内容と比較します.
+class RequestList
+{
+public:
+    explicit RequestList( const IoCorpus& corpus )
+    : m_Corpus( corpus )
+    { /* DO_NOTHING */ }
+
+    void Add( int32_t file, uint64_t offset, uint32_t size )
+    {
+        m_Buffers.emplace_back( size + 1, uint8_t( 0xCD ) );
+
+        asdx::IoRequest request = {};
+        request.Path     = ( file == kMissingFile ) ? m_Corpus.Missing.c_str() : m_Corpus.Paths[file].c_str();
+        request.Offset   = offset;
+        request.Size     = size;
+        request.pDst     = m_Buffers.back().data();
+        request.ReadSize = UINT32_MAX;
+
+        m_Requests.push_back( request );
+        m_Files   .push_back( file );
+    }
+
+    uint32_t GetCount() const
+    { return uint32_t( m_Requests.size() ); }
+
+    asdx::IoRequest* GetRequests()
+    { return m_Requests.data(); }
+
+    //---------------------------------------------------------------------------------------------
+    //      読み込み結果を検証します.
+    //---------------------------------------------------------------------------------------------
+    bool Verify( const asdx::IoBatch& batch ) const
+    {
+        auto errorCount = 0u;
+
+        for( size_t i=0; i<m_Requests.size(); ++i )
+        {
+            auto& request = m_Requests[i];
+            auto& buffer  = m_Buffers[i];
+            auto  file    = m_Files[i];
+
+            auto expect = 0u;
+            if ( file != kMissingFile && request.Offset < m_Corpus.Data[file].size() )
+            { expect = uint32_t( (std::min<uint64_t>)( request.Size, m_Corpus.Data[file].size() - request.Offset ) ); }
+
+            if ( expect != request.Size )
+            { errorCount++; }
+
+            BENCH_EXPECT( request.ReadSize == expect );
+            BENCH_EXPECT( expect == 0 || memcmp( buffer.data(), m_Corpus.Data[file].data() + request.Offset, expect ) == 0 );
+
+            // 格納先の範囲外は書き換えられていないことを確認します.
+            BENCH_EXPECT( buffer[request.Size] == 0xCD );
+        }
+
+        BENCH_EXPECT( batch.GetErrorCount() == errorCount );
+        return true;
+    }
+
+private:
+    const IoCorpus&                     m_Corpus;       //!< ファイルです.
+    std::vector<asdx::IoRequest>        m_Requests;     //!< 読み込み要求です.
+    std::vector<int32_t>                m_Files;        //!< 要求ごとのファイル番号です.
+    std::vector<std::vector<uint8_t>>   m_Buffers;      //!< 格納先です. 範囲外の書き込みを検出するため1byte大きく確保します.
+};
+
+//-------------------------------------------------------------------------------------------------
+//      検証用のファイルを書き出します.
+//-------------------------------------------------------------------------------------------------
+bool WriteCorpus( const BenchDesc& desc, IoCorpus& corpus )
+{
+    if ( !CreateBenchDirectory( desc.Dir.c_str() ) )
+    {
+        fprintf( stderr, "Error : Directory Create Failed. path = %s\n", desc.Dir.c_str() );
+        return false;
+    }
+
+    Random random( desc.Seed );
+
+    for( auto i=0u; i<kFileCount; ++i )
+    {
+        // 先頭のファイルは結合の検証に使うため最大サイズにします.
+        auto size = ( i == 0 ) ? kMaxFileSize : kMinFileSize + random.Next() % ( kMaxFileSize - kMinFileSize );
+
+        std::vector<uint8_t> data( size );
+        for( auto& value : data )
+        { value = uint8_t( random.Next() >> 24 ); }
+
+        char path[512];
+        snprintf( path, sizeof(path), "%s/io_%u.bin", desc.Dir.c_str(), i );
+
+        auto pFile = fopen( path, "wb" );
+        if ( pFile == nullptr )
+        {
+            fprintf( stderr, "Error : File Open Failed. path = %s\n", path );
+            return false;
+        }
+
+        auto written = fwrite( data.data(), 1, data.size(), pFile );
+        fclose( pFile );
+
+        if ( written != data.size() )
+        {
+            fprintf( stderr, "Error : File Write Failed. path = %s\n", path );
+            return false;
+        }
+
+        corpus.Paths.push_back( path );
+        corpus.Data .push_back( std::move( data ) );
+    }
+
+    corpus.Missing = desc.Dir + "/io_missing.bin";
+    remove( corpus.Missing.c_str() );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      要求を投入して完了を待ち, 結果を検証します.
+//-------------------------------------------------------------------------------------------------
+bool SubmitAndVerify( RequestList& list )
+{
+    auto& service = asdx::IoService::GetInstance();
+
+    asdx::IoBatch batch;
+    BENCH_EXPECT( service.Submit( list.GetRequests(), list.GetCount(), &batch ) );
+    service.Wait( &batch );
+
+    return list.Verify( batch );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      2つの統計情報の差を求めます.
+//-------------------------------------------------------------------------------------------------
+asdx::IoStats Diff( const asdx::IoStats& a, const asdx::IoStats& b )
+{
+    asdx::IoStats result;
+    result.RequestCount = a.RequestCount - b.RequestCount;
+    result.ReadCount    = a.ReadCount    - b.ReadCount;
+    result.OpenCount    = a.OpenCount    - b.OpenCount;
+    result.ReadBytes    = a.ReadBytes    - b.ReadBytes;
+    result.RetryCount   = a.RetryCount   - b.RetryCount;
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイル内に収まる要求を確認します.
+//-------------------------------------------------------------------------------------------------
+bool CheckExact( const IoCorpus& corpus, Random& random )
+{
+    RequestList list( corpus );
+    for( auto i=0u; i<kFileCount; ++i )
+    {
+        auto fileSize = uint32_t( corpus.Data[i].size() );
+        for( auto j=0; j<8; ++j )
+        {
+            auto size   = 1 + random.Next() % 16384;
+            auto offset = random.Next() % ( fileSize - size );
+            list.Add( int32_t( i ), offset, size );
+        }
+    }
+
+    return SubmitAndVerify( list );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイル終端をまたぐ要求で, 短い読み込みの後に残りを読み直すことを確認します.
+//-------------------------------------------------------------------------------------------------
+bool CheckEof( const IoCorpus& corpus )
+{
+    auto& service = asdx::IoService::GetInstance();
+    auto  before  = service.GetStats();
+
+    RequestList list( corpus );
+    for( auto i=0u; i<kFileCount; ++i )
+    {
+        auto fileSize = corpus.Data[i].size();
+        list.Add( int32_t( i ), fileSize - 1000, 5000 );        // 終端をまたぐ要求です.
+        list.Add( int32_t( i ), fileSize + 10000, 100 );        // 終端より後ろの要求です.
+    }
+
+    BENCH_EXPECT( SubmitAndVerify( list ) );
+
+    // 終端をまたぐ読み込みは, 短い結果の後に再発行され 0 byte で完了します.
+    auto diff = Diff( service.GetStats(), before );
+    BENCH_EXPECT( diff.RetryCount >= kFileCount );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      存在しないファイルの要求が失敗として完了することを確認します.
+//-------------------------------------------------------------------------------------------------
+bool CheckMissing( const IoCorpus& corpus )
+{
+    RequestList list( corpus );
+    list.Add( kMissingFile, 0, 100 );
+    list.Add( kMissingFile, 4096, 100 );
+    list.Add( 0, 0, 100 );
+
+    return SubmitAndVerify( list );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      隣接する要求が1回の読み込みにまとめられることを確認します.
+//-------------------------------------------------------------------------------------------------
+bool CheckMerge( const IoCorpus& corpus, Random& random )
+{
+    auto& service = asdx::IoService::GetInstance();
+    auto  before  = service.GetStats();
+
+    // 投入順に関わらずオフセット順に並べてまとめられます.
+    std::vector<uint32_t> order( 64 );
+    for( auto i=0u; i<order.size(); ++i )
+    { order[i] = i; }
+
+    for( auto i=uint32_t( order.size() ) - 1; i>0; --i )
+    { std::swap( order[i], order[random.Next() % ( i + 1 )] ); }
+
+    RequestList list( corpus );
+    for( auto index : order )
+    { list.Add( 0, index * 4096, 4096 ); }
+
+    BENCH_EXPECT( SubmitAndVerify( list ) );
+
+    auto diff = Diff( service.GetStats(), before );
+    BENCH_EXPECT( diff.OpenCount == 1 );
+    BENCH_EXPECT( diff.ReadCount == 1 );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      複数スレッドからランダムなバッチを投入します.
+//-------------------------------------------------------------------------------------------------
+bool CheckStress( const BenchDesc& desc, const IoCorpus& corpus, char* stats, size_t statsSize )
+{
+    auto& service = asdx::IoService::GetInstance();
+    auto  before  = service.GetStats();
+    auto  start   = GetBenchTime();
+
+    std::atomic<uint32_t> failed( 0 );
+    std::vector<std::thread> threads;
+
+    for( auto t=0u; t<kSubmitThreads; ++t )
+    {
+        threads.emplace_back( [&, t]()
+        {
+            Random random( desc.Seed + t * 7919 );
+
+            for( auto b=0u; b<desc.Batches; ++b )
+            {
+                RequestList list( corpus );
+
+                auto count = 1 + random.Next() % 64;
+                auto prevFile   = kMissingFile;
+                auto prevEnd    = uint64_t( 0 );
+
+                for( auto i=0u; i<count; ++i )
+                {
+                    // 1/16 は存在しないファイル, 1/4 は直前の要求に隣接させます.
+                    auto file = int32_t( random.Next() % ( kFileCount * 2 ) );
+                    file = ( file == int32_t( kFileCount * 2 - 1 ) ) ? kMissingFile : int32_t( file % kFileCount );
+
+                    auto fileSize = ( file != kMissingFile ) ? corpus.Data[file].size() : 1000;
+                    auto offset   = uint64_t( random.Next() % ( fileSize + 100 ) );
+                    auto size     = random.Next() % 20000;
+
+                    if ( random.Next() % 4 == 0 && prevFile != kMissingFile )
+                    {
+                        file   = prevFile;
+                        offset = prevEnd;
+                    }
+
+                    list.Add( file, offset, size );
+                    prevFile = file;
+                    prevEnd  = offset + size;
+                }
+
+                asdx::IoBatch batch;
+                if ( !service.Submit( list.GetRequests(), list.GetCount(), &batch ) )
+                {
+                    failed++;
+                    continue;
+                }
+
+                // 待機方法を交互に変えます. IsDone() の後はすぐにバッチを破棄できます.
+                if ( b & 1 )
+                { service.Wait( &batch ); }
+                else
+                {
+                    while( !batch.IsDone() )
+                    { std::this_thread::yield(); }
+                }
+
+                if ( !list.Verify( batch ) )
+                { failed++; }
+            }
+        });
+    }
+
+    for( auto& thread : threads )
+    { thread.join(); }
+
+    auto totalSec = GetBenchTime() - start;
+    auto diff     = Diff( service.GetStats(), before );
+
+    BENCH_EXPECT( failed.load() == 0 );
+
+    snprintf( stats, statsSize, "%llu requests, %llu reads (%.0f%%), %llu retries, %.1f MB/s",
+        (unsigned long long)diff.RequestCount,
+        (unsigned long long)diff.ReadCount,
+        ( diff.RequestCount > 0 ) ? 100.0 * double( diff.ReadCount ) / double( diff.RequestCount ) : 0.0,
+        (unsigned long long)diff.RetryCount,
+        double( diff.ReadBytes ) / ( 1024.0 * 1024.0 ) / totalSec );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      現在の I/O サービスの設定で全ての検証を行います.
+//-------------------------------------------------------------------------------------------------
+bool RunChecks( const BenchDesc& desc, const IoCorpus& corpus, const char* mode )
+{
+    auto ret = true;
+
+    auto report = [&]( const char* name, bool result, const char* stats )
+    {
+        printf( "  %-12s %-10s %-6s %s\n", mode, name, result ? "ok" : "FAILED", stats );
+        fflush( stdout );
+        ret = ret && result;
+    };
+
+    Random random( desc.Seed );
+
+    report( "exact",   CheckExact( corpus, random ), "" );
+    report( "eof",     CheckEof( corpus ),           "" );
+    report( "missing", CheckMissing( corpus ),       "" );
+    report( "merge",   CheckMerge( corpus, random ), "" );
+
+    char stats[256] = {};
+    report( "stress", CheckStress( desc, corpus, stats, sizeof(stats) ), stats );
+
+    return ret;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      作業ディレクトリのファイルで asdx::IoService を検証します.
+//-------------------------------------------------------------------------------------------------
+bool RunIo( const BenchDesc& desc )
+{
+    IoCorpus corpus;
+    if ( !WriteCorpus( desc, corpus ) )
+    { return false; }
+
+    auto& service = asdx::IoService::GetInstance();
+
+    printf( "\nio service, %u files, %u x %u batches, io_uring queue depth %u\n",
+        kFileCount, kSubmitThreads, desc.Batches, desc.QueueDepth );
+    printf( "  %-12s %-10s %-6s %s\n", "mode", "check", "result", "stats" );
+    fflush( stdout );
+
+    // 未初期化の場合は Submit() の中で読み込みます.
+    auto ret = RunChecks( desc, corpus, "inline" );
+
+    asdx::IoServiceDesc serviceDesc;
+    serviceDesc.ThreadCount = ( desc.Threads > 0 ) ? desc.Threads : 4;
+    serviceDesc.QueueDepth  = desc.QueueDepth;
+
+    // スレッドプールです.
+    serviceDesc.EnableUring = false;
+    if ( !service.Init( serviceDesc ) )
+    { return false; }
+
+    ret = RunChecks( desc, corpus, "thread pool" ) && ret;
+    service.Term();
+
+    // io_uring の初期化に失敗した場合は, スレッドプールで動作する必要があります.
+    serviceDesc.EnableUring = true;
+    serviceDesc.QueueDepth  = kBadQueueDepth;
+    if ( !service.Init( serviceDesc ) )
+    { return false; }
+
+    auto fallback = !service.IsUringEnabled();
+    printf( "  %-12s %-10s %-6s\n", "fallback", "backend", fallback ? "ok" : "FAILED" );
+    ret = RunChecks( desc, corpus, "fallback" ) && fallback && ret;
+    service.Term();
+
+    // io_uring です.
+    serviceDesc.QueueDepth = desc.QueueDepth;
+    if ( !service.Init( serviceDesc ) )
+    { return false; }
+
+    if ( service.IsUringEnabled() )
+    { ret = RunChecks( desc, corpus, "io_uring" ) && ret; }
+    else
+    { printf( "  %-12s %-10s %-6s %s\n", "io_uring", "-", "skip", "io_uring is not available" ); }
+
+    service.Term();
+
+    return ret;
+}
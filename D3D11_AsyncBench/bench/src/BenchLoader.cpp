@@ -0,0 +1,504 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchLoader.cpp
+// Desc : Async Loader Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchPlatform.h>
+#include <BenchLoader.h>
+#include <asdxAsyncLoader.h>
+#include <asdxJobSystem.h>
+#include <asdxRef.h>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+
+//-------------------------------------------------------------------------------------------------
+// Macros
+//-------------------------------------------------------------------------------------------------
+#define BENCH_EXPECT( cond )                                                            \
+    if ( !( cond ) )                                                                    \
+    {                                                                                   \
+        fprintf( stderr, "    failed : %s (line %d)\n", #cond, __LINE__ );              \
+        return false;                                                                   \
+    }
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const uint32_t   kDataSize   = 256;      // デコード結果のサイズです.
+
+//-------------------------------------------------------------------------------------------------
+// Global Variables.
+//-------------------------------------------------------------------------------------------------
+std::atomic<int32_t>    g_LiveCount     ( 0 );  // 生存している疑似リソース数です.
+std::atomic<uint32_t>   g_CreateTotal   ( 0 );  // OnCreate() の呼び出し回数です.
+std::atomic<uint32_t>   g_DiscardTotal  ( 0 );  // OnDiscard() の呼び出し回数です.
+std::atomic<uint32_t>   g_WrongThread   ( 0 );  // メインスレッド以外で OnCreate() / OnDiscard() が呼び出された回数です.
+std::thread::id         g_MainThreadId;         // RunLoader() を呼び出したスレッドの ID です.
+uint32_t                g_CreateSerial = 0;     // OnCreate() の呼び出し順です. メインスレッドでのみ更新します.
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BEHAVIOR enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum BEHAVIOR
+{
+    BEHAVIOR_SUCCESS = 0,       //!< 読み込みに成功します.
+    BEHAVIOR_DECODE_FAIL,       //!< OnDecode() が false を返します.
+    BEHAVIOR_DECODE_THROW,      //!< OnDecode() が例外を送出します.
+    BEHAVIOR_CREATE_FAIL,       //!< OnCreate() が false を返します.
+};
+
+//-------------------------------------------------------------------------------------------------
+//      指定時間だけ CPU を使用します.
+//-------------------------------------------------------------------------------------------------
+void Spin( uint32_t usec )
+{
+    auto end = GetBenchTime() + usec * 1e-6;
+    while( GetBenchTime() < end )
+    { /* DO_NOTHING */ }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      メインスレッドから呼び出されているかチェックします.
+//-------------------------------------------------------------------------------------------------
+void CheckMainThread()
+{
+    if ( std::this_thread::get_id() != g_MainThreadId )
+    { g_WrongThread++; }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FakeResource class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  デバイスを使用せず, 指定された時間と結果でデコードと生成を行う疑似リソースです.
+class FakeResource : public asdx::AsyncResource
+{
+public:
+    static asdx::RefPtr<FakeResource> Create( BEHAVIOR behavior, uint32_t decodeUsec = 0, uint32_t createUsec = 0 )
+    { return asdx::RefPtr<FakeResource>( new FakeResource( behavior, decodeUsec, createUsec ) ); }
+
+    bool IsDecodeDone() const
+    { return m_DecodeDone.load( std::memory_order_acquire ); }
+
+    BEHAVIOR GetBehavior() const
+    { return m_Behavior; }
+
+    asdx::LOAD_STATE GetExpectedState() const
+    { return ( m_Behavior == BEHAVIOR_SUCCESS ) ? asdx::LOAD_STATE_READY : asdx::LOAD_STATE_FAILED; }
+
+    uint32_t GetCreateCount() const
+    { return m_CreateCount; }
+
+    uint32_t GetDiscardCount() const
+    { return m_DiscardCount; }
+
+    uint32_t GetCreateOrder() const
+    { return m_CreateOrder; }
+
+    bool IsDataValid() const
+    { return m_DataValid; }
+
+protected:
+    FakeResource( BEHAVIOR behavior, uint32_t decodeUsec, uint32_t createUsec )
+    : asdx::AsyncResource( "fake" )
+    , m_Behavior    ( behavior )
+    , m_DecodeUsec  ( decodeUsec )
+    , m_CreateUsec  ( createUsec )
+    , m_DecodeDone  ( false )
+    , m_CreateCount ( 0 )
+    , m_DiscardCount( 0 )
+    , m_CreateOrder ( UINT32_MAX )
+    , m_DataValid   ( true )
+    { g_LiveCount++; }
+
+    ~FakeResource()
+    { g_LiveCount--; }
+
+    bool OnDecode() override
+    {
+        Spin( m_DecodeUsec );
+        m_Data.assign( kDataSize, uint8_t( 0xAB ) );
+        m_DecodeDone.store( true, std::memory_order_release );
+
+        if ( m_Behavior == BEHAVIOR_DECODE_THROW )
+        { throw std::runtime_error( "decode exception" ); }
+
+        return m_Behavior != BEHAVIOR_DECODE_FAIL;
+    }
+
+    bool OnCreate() override
+    {
+        CheckMainThread();
+        Spin( m_CreateUsec );
+
+        // デコード結果は OnDiscard() までメインスレッドから参照できる必要があります.
+        if ( m_Data.size() != kDataSize || m_Data[0] != 0xAB )
+        { m_DataValid = false; }
+
+        m_CreateCount++;
+        m_CreateOrder = g_CreateSerial++;
+        g_CreateTotal++;
+        return m_Behavior != BEHAVIOR_CREATE_FAIL;
+    }
+
+    void OnDiscard() override
+    {
+        CheckMainThread();
+        m_DiscardCount++;
+        g_DiscardTotal++;
+        m_Data.clear();
+        m_Data.shrink_to_fit();
+    }
+
+private:
+    BEHAVIOR                m_Behavior;         //!< 読み込み結果です.
+    uint32_t                m_DecodeUsec;       //!< デコード時間です.
+    uint32_t                m_CreateUsec;       //!< 生成時間です.
+    std::atomic<bool>       m_DecodeDone;       //!< デコードが終わったかどうか.
+    uint32_t                m_CreateCount;      //!< OnCreate() の呼び出し回数です.
+    uint32_t                m_DiscardCount;     //!< OnDiscard() の呼び出し回数です.
+    uint32_t                m_CreateOrder;      //!< OnCreate() が呼び出された順番です.
+    bool                    m_DataValid;        //!< OnCreate() でデコード結果が参照できたかどうか.
+    std::vector<uint8_t>    m_Data;             //!< デコード結果です.
+};
+
+using FakeList = std::vector<asdx::RefPtr<FakeResource>>;
+
+//-------------------------------------------------------------------------------------------------
+//      デコードが完了キューに積まれるまで待機します.
+//-------------------------------------------------------------------------------------------------
+void WaitDecoded( const FakeList& list )
+{
+    for( auto& item : list )
+    {
+        while( !item->IsDecodeDone() )
+        { std::this_thread::yield(); }
+    }
+
+    // OnDecode() から戻った後に完了キューへ積まれるため, 少し待ちます.
+    std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      デコードが完了した順に生成されることを確認します.
+//-------------------------------------------------------------------------------------------------
+bool CheckOrder()
+{
+    auto& loader = asdx::AsyncLoader::GetInstance();
+
+    // デコードを行うスレッドが1つなら, 完了順は要求順と一致します.
+    FakeList list;
+    for( auto i=0; i<8; ++i )
+    {
+        auto item = FakeResource::Create( BEHAVIOR_SUCCESS, 100 );
+        BENCH_EXPECT( loader.Request( item.GetPtr() ) );
+        list.push_back( item );
+    }
+
+    WaitDecoded( list );
+
+    auto base = g_CreateSerial;
+    BENCH_EXPECT( loader.Flush( 0.0 ) == list.size() );
+
+    for( size_t i=0; i<list.size(); ++i )
+    {
+        BENCH_EXPECT( list[i]->IsReady() );
+        BENCH_EXPECT( list[i]->GetCreateOrder() == base + i );
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      予算時間内だけ生成され, 最低1つは生成されることを確認します.
+//-------------------------------------------------------------------------------------------------
+bool CheckBudget()
+{
+    auto& loader = asdx::AsyncLoader::GetInstance();
+
+    FakeList list;
+    for( auto i=0; i<8; ++i )
+    {
+        auto item = FakeResource::Create( BEHAVIOR_SUCCESS, 0, 2000 );
+        BENCH_EXPECT( loader.Request( item.GetPtr() ) );
+        list.push_back( item );
+    }
+
+    WaitDecoded( list );
+
+    // 予算時間が生成1回分より短くても1つは処理します.
+    BENCH_EXPECT( loader.Flush( 0.001 ) == 1 );
+
+    // 2 msec の生成は 5 msec の予算で最大3つまでです.
+    auto count = loader.Flush( 5.0 );
+    BENCH_EXPECT( count >= 1 && count <= 3 );
+    BENCH_EXPECT( loader.GetPendingCount() == list.size() - 1 - count );
+
+    BENCH_EXPECT( loader.Flush( 0.0 ) == list.size() - 1 - count );
+    BENCH_EXPECT( loader.GetPendingCount() == 0 );
+
+    for( auto& item : list )
+    {
+        BENCH_EXPECT( item->IsReady() );
+        BENCH_EXPECT( item->IsDataValid() );
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ハンドルを手放したリソースが生成されずに破棄されることを確認します.
+//-------------------------------------------------------------------------------------------------
+bool CheckDropped()
+{
+    auto& loader = asdx::AsyncLoader::GetInstance();
+
+    auto live    = g_LiveCount.load();
+    auto create  = g_CreateTotal.load();
+    auto discard = g_DiscardTotal.load();
+
+    for( auto i=0; i<4; ++i )
+    {
+        auto item = FakeResource::Create( BEHAVIOR_SUCCESS, 100 );
+        BENCH_EXPECT( loader.Request( item.GetPtr() ) );
+    }
+
+    loader.WaitAll();
+
+    BENCH_EXPECT( loader.GetPendingCount() == 0 );
+    BENCH_EXPECT( g_CreateTotal.load()  == create );
+    BENCH_EXPECT( g_DiscardTotal.load() == discard + 4 );
+    BENCH_EXPECT( g_LiveCount.load()    == live );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      失敗したリソースの状態とコールバックを確認します.
+//-------------------------------------------------------------------------------------------------
+bool CheckFailure()
+{
+    auto& loader = asdx::AsyncLoader::GetInstance();
+
+    FakeList list;
+    list.push_back( FakeResource::Create( BEHAVIOR_SUCCESS ) );
+    list.push_back( FakeResource::Create( BEHAVIOR_DECODE_FAIL ) );
+    list.push_back( FakeResource::Create( BEHAVIOR_DECODE_THROW ) );
+    list.push_back( FakeResource::Create( BEHAVIOR_CREATE_FAIL ) );
+
+    for( auto& item : list )
+    { BENCH_EXPECT( loader.Request( item.GetPtr() ) ); }
+
+    loader.WaitAll();
+    BENCH_EXPECT( loader.GetPendingCount() == 0 );
+
+    for( auto& item : list )
+    {
+        auto decoded = ( item->GetBehavior() == BEHAVIOR_SUCCESS )
+                    || ( item->GetBehavior() == BEHAVIOR_CREATE_FAIL );
+
+        BENCH_EXPECT( item->GetState() == item->GetExpectedState() );
+        BENCH_EXPECT( item->GetCreateCount() == ( decoded ? 1u : 0u ) );
+        BENCH_EXPECT( item->GetDiscardCount() == 1 );
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      終了処理で生成前のリソースが失敗として破棄されることを確認します.
+//-------------------------------------------------------------------------------------------------
+bool CheckTerm()
+{
+    auto& loader = asdx::AsyncLoader::GetInstance();
+
+    FakeList list;
+    for( auto i=0; i<8; ++i )
+    {
+        auto item = FakeResource::Create( BEHAVIOR_SUCCESS, 1000 );
+        BENCH_EXPECT( loader.Request( item.GetPtr() ) );
+        list.push_back( item );
+    }
+
+    loader.Term();
+    BENCH_EXPECT( loader.GetPendingCount() == 0 );
+
+    for( auto& item : list )
+    {
+        BENCH_EXPECT( item->IsFailed() );
+        BENCH_EXPECT( item->GetCreateCount()  == 0 );
+        BENCH_EXPECT( item->GetDiscardCount() == 1 );
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      フレームごとに Update() を呼び出して大量の要求を処理します.
+//-------------------------------------------------------------------------------------------------
+bool CheckStress( const BenchDesc& desc, char* stats, size_t statsSize )
+{
+    auto& loader = asdx::AsyncLoader::GetInstance();
+
+    auto live    = g_LiveCount.load();
+    auto create  = g_CreateTotal.load();
+    auto discard = g_DiscardTotal.load();
+
+    Random random( desc.Seed );
+
+    FakeList list;
+    list.reserve( desc.Requests );
+
+    auto expectCreate = 0u;
+    auto start = GetBenchTime();
+
+    for( auto i=0u; i<desc.Requests; ++i )
+    {
+        auto value    = random.Next() % 100;
+        auto behavior = ( value < 90 ) ? BEHAVIOR_SUCCESS
+                      : ( value < 95 ) ? BEHAVIOR_DECODE_FAIL : BEHAVIOR_CREATE_FAIL;
+        auto decode   = ( desc.DecodeUsec > 0 ) ? random.Next() % ( desc.DecodeUsec + 1 ) : 0;
+
+        auto item = FakeResource::Create( behavior, decode, desc.CreateUsec );
+        BENCH_EXPECT( loader.Request( item.GetPtr() ) );
+
+        // 4つに1つは要求直後にハンドルを手放します.
+        if ( random.Next() % 4 != 0 )
+        {
+            if ( behavior != BEHAVIOR_DECODE_FAIL )
+            { expectCreate++; }
+
+            list.push_back( item );
+        }
+    }
+
+    auto frames     = 0u;
+    auto maxCount   = 0u;
+    auto maxMsec    = 0.0;
+
+    while( loader.GetPendingCount() > 0 )
+    {
+        auto begin = GetBenchTime();
+        auto count = loader.Update();
+        auto msec  = ( GetBenchTime() - begin ) * 1000.0;
+
+        if ( count == 0 )
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        frames++;
+        if ( count > maxCount ) { maxCount = count; }
+        if ( msec  > maxMsec  ) { maxMsec  = msec; }
+    }
+
+    auto totalSec = GetBenchTime() - start;
+
+    for( auto& item : list )
+    {
+        BENCH_EXPECT( item->GetState() == item->GetExpectedState() );
+        BENCH_EXPECT( item->GetDiscardCount() == 1 );
+        BENCH_EXPECT( item->GetCreateCount() == ( ( item->GetBehavior() == BEHAVIOR_DECODE_FAIL ) ? 0u : 1u ) );
+        BENCH_EXPECT( item->IsDataValid() );
+    }
+
+    BENCH_EXPECT( g_CreateTotal.load()  == create + expectCreate );
+    BENCH_EXPECT( g_DiscardTotal.load() == discard + desc.Requests );
+
+    list.clear();
+    BENCH_EXPECT( g_LiveCount.load() == live );
+
+    snprintf( stats, statsSize, "%u frames, max %u/frame, max %.2f ms/frame, %.0f req/s",
+        frames, maxCount, maxMsec, desc.Requests / totalSec );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      現在のジョブシステムの設定で全ての検証を行います.
+//-------------------------------------------------------------------------------------------------
+bool RunChecks( const BenchDesc& desc, const char* mode, bool ordered )
+{
+    auto ret = true;
+
+    auto report = [&]( const char* name, bool result, const char* stats )
+    {
+        printf( "  %-12s %-10s %-6s %s\n", mode, name, result ? "ok" : "FAILED", stats );
+        fflush( stdout );
+        ret = ret && result;
+    };
+
+    if ( ordered )
+    { report( "order", CheckOrder(), "" ); }
+
+    report( "budget",  CheckBudget(),  "" );
+    report( "dropped", CheckDropped(), "" );
+    report( "failure", CheckFailure(), "" );
+    report( "term",    CheckTerm(),    "" );
+
+    char stats[256] = {};
+    report( "stress", CheckStress( desc, stats, sizeof(stats) ), stats );
+
+    if ( g_WrongThread.exchange( 0 ) != 0 )
+    {
+        fprintf( stderr, "    failed : OnCreate() / OnDiscard() called outside the main thread.\n" );
+        ret = false;
+    }
+
+    // 検証に失敗した場合も次の設定に影響しないよう, 残った要求を破棄します.
+    asdx::AsyncLoader::GetInstance().Term();
+
+    return ret;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      疑似リソースで asdx::AsyncLoader を検証します.
+//-------------------------------------------------------------------------------------------------
+bool RunLoader( const BenchDesc& desc )
+{
+    g_MainThreadId = std::this_thread::get_id();
+
+    auto& jobSystem = asdx::JobSystem::GetInstance();
+    asdx::AsyncLoader::GetInstance().SetFrameBudget( desc.FrameBudget );
+
+    printf( "\nasync loader, %u requests, decode <= %u usec, create %u usec, budget %.2f ms\n",
+        desc.Requests, desc.DecodeUsec, desc.CreateUsec, desc.FrameBudget );
+    printf( "  %-12s %-10s %-6s %s\n", "mode", "check", "result", "stats" );
+    fflush( stdout );
+
+    // ジョブシステムが未初期化の場合は Request() の中でデコードされます.
+    auto ret = RunChecks( desc, "inline", true );
+
+    // ワーカーが1つの場合はデコードの完了順が要求順と一致するため, 生成順も検証できます.
+    if ( !jobSystem.Init( 1 ) )
+    { return false; }
+
+    ret = RunChecks( desc, "1 worker", true ) && ret;
+    jobSystem.Term();
+
+    if ( !jobSystem.Init( desc.Threads ) )
+    { return false; }
+
+    char mode[32];
+    auto workerCount = jobSystem.GetWorkerCount();
+    snprintf( mode, sizeof(mode), "%u worker%s", workerCount, ( workerCount > 1 ) ? "s" : "" );
+    ret = RunChecks( desc, mode, false ) && ret;
+    jobSystem.Term();
+
+    return ret;
+}
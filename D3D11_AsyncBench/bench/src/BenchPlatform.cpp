@@ -0,0 +1,53 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchPlatform.cpp
+// Desc : Platform Compatibility Layer for Async Loading Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchPlatform.h>
+#include <chrono>
+
+#if defined(WIN32) || defined(_WIN32)
+#include <Windows.h>
+#else
+#include <sys/stat.h>
+#include <cerrno>
+#endif
+
+
+//-------------------------------------------------------------------------------------------------
+//      高分解能タイマーの現在値を秒単位で取得します.
+//-------------------------------------------------------------------------------------------------
+double GetBenchTime()
+{
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double>( now ).count();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ディレクトリを作成します.
+//-------------------------------------------------------------------------------------------------
+bool CreateBenchDirectory( const char* path )
+{
+    // 同名のファイル (ビルドした実行ファイルなど) がある場合は失敗とします.
+#if defined(WIN32) || defined(_WIN32)
+    if ( CreateDirectoryA( path, nullptr ) )
+    { return true; }
+    if ( GetLastError() != ERROR_ALREADY_EXISTS )
+    { return false; }
+
+    auto attr = GetFileAttributesA( path );
+    return ( attr != INVALID_FILE_ATTRIBUTES ) && ( attr & FILE_ATTRIBUTE_DIRECTORY ) != 0;
+#else
+    if ( mkdir( path, 0755 ) == 0 )
+    { return true; }
+    if ( errno != EEXIST )
+    { return false; }
+
+    struct stat st;
+    return ( stat( path, &st ) == 0 ) && S_ISDIR( st.st_mode );
+#endif
+}
@@ -0,0 +1,102 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : main.cpp
+// Desc : Async Loading Benchmark Main Entry Point.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchPlatform.h>
+#include <BenchLoader.h>
+#include <BenchIo.h>
+#include <cstdlib>
+#include <cstring>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+//      使用方法を表示します.
+//-------------------------------------------------------------------------------------------------
+void PrintUsage()
+{
+    printf( "Usage : async_bench [options]\n" );
+    printf( "  -threads <N>         worker threads, 0 = auto (default: 0)\n" );
+    printf( "  -requests <N>        requests issued by the stress check (default: 2000)\n" );
+    printf( "  -decode <usec>       maximum decode time per request (default: 500)\n" );
+    printf( "  -create <usec>       creation time per request (default: 100)\n" );
+    printf( "  -budget <msec>       creation budget per frame (default: 2.0)\n" );
+    printf( "  -seed <N>            random seed (default: 305419896)\n" );
+    printf( "  -dir <dir>           directory for the I/O test files (default: async_bench_io)\n" );
+    printf( "  -batches <N>         I/O batches per submitting thread (default: 200)\n" );
+    printf( "  -depth <N>           io_uring queue depth (default: 8)\n" );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      コマンドライン引数を解析します.
+//-------------------------------------------------------------------------------------------------
+bool ParseArgs( int argc, char** argv, BenchDesc& desc )
+{
+    for( auto i=1; i<argc; ++i )
+    {
+        auto hasNext = ( i + 1 < argc );
+
+        if ( strcmp( argv[i], "-threads" ) == 0 && hasNext )
+        { desc.Threads = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else if ( strcmp( argv[i], "-requests" ) == 0 && hasNext )
+        { desc.Requests = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else if ( strcmp( argv[i], "-decode" ) == 0 && hasNext )
+        { desc.DecodeUsec = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else if ( strcmp( argv[i], "-create" ) == 0 && hasNext )
+        { desc.CreateUsec = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else if ( strcmp( argv[i], "-budget" ) == 0 && hasNext )
+        { desc.FrameBudget = atof( argv[++i] ); }
+        else if ( strcmp( argv[i], "-seed" ) == 0 && hasNext )
+        { desc.Seed = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else if ( strcmp( argv[i], "-dir" ) == 0 && hasNext )
+        { desc.Dir = argv[++i]; }
+        else if ( strcmp( argv[i], "-batches" ) == 0 && hasNext )
+        { desc.Batches = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else if ( strcmp( argv[i], "-depth" ) == 0 && hasNext )
+        { desc.QueueDepth = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else
+        {
+            fprintf( stderr, "Error : Unknown Option. option = %s\n", argv[i] );
+            PrintUsage();
+            return false;
+        }
+    }
+
+    if ( desc.Requests == 0 )
+    {
+        fprintf( stderr, "Error : Invalid Request Count. requests = %u\n", desc.Requests );
+        return false;
+    }
+
+    if ( desc.QueueDepth == 0 || desc.QueueDepth > 4096 )
+    {
+        fprintf( stderr, "Error : Invalid Queue Depth. depth = %u\n", desc.QueueDepth );
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-------------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+    BenchDesc desc;
+    if ( !ParseArgs( argc, argv, desc ) )
+    { return 1; }
+
+    auto ret = RunLoader( desc );
+    ret = RunIo( desc ) && ret;
+
+    return ret ? 0 : 1;
+}
@@ -0,0 +1,47 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchContention.h
+// Desc : Multi Thread Cache Contention Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __BENCH_CONTENTION_H__
+#define __BENCH_CONTENTION_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ContentionDesc structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ContentionDesc
+{
+    std::vector<uint32_t>   Threads;        //!< 計測するスレッド数です.
+    std::vector<uint32_t>   Shards;         //!< 計測するシャード数です.
+    uint32_t                Capacity;       //!< キャッシュ容量 (エントリ数) です.
+    uint32_t                ComputeCost;    //!< ミス時の生成処理の重さ (ループ回数) です.
+    std::string             Filter;         //!< 計測するキャッシュ名に含まれる文字列です.
+
+    ContentionDesc()
+    : Capacity   ( 65536 )
+    , ComputeCost( 2000 )
+    { /* DO_NOTHING */ }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      複数スレッドから同じキャッシュを使用した場合の性能を計測します.
+//!
+//! @param[in]      desc        計測設定です.
+//! @param[in]      trace       アクセストレースです. スレッドごとに開始位置をずらして再生します.
+//! @retval true    計測に成功.
+//! @retval false   生成の重複排除などの検証に失敗.
+//-------------------------------------------------------------------------------------------------
+bool RunContention( const ContentionDesc& desc, const std::vector<uint32_t>& trace );
+
+
+#endif//__BENCH_CONTENTION_H__
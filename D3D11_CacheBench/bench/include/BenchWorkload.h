@@ -0,0 +1,105 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchWorkload.h
+// Desc : Synthetic Cache Access Trace Generator.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __BENCH_WORKLOAD_H__
+#define __BENCH_WORKLOAD_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// WORKLOAD_TYPE enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum WORKLOAD_TYPE
+{
+    WORKLOAD_ZIPF = 0,      //!< Zipf 分布に従うアクセスです.
+    WORKLOAD_LOOP,          //!< キー空間を順番に繰り返し走査するアクセスです.
+    WORKLOAD_MIXED,         //!< Zipf 分布のアクセスに一度きりの走査が割り込むアクセスです.
+    NUM_WORKLOAD_TYPE
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// WorkloadDesc structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct WorkloadDesc
+{
+    WORKLOAD_TYPE   Type;           //!< アクセスパターンです.
+    uint32_t        KeyCount;       //!< キー空間の大きさです.
+    uint32_t        Length;         //!< トレースの長さです.
+    double          Skew;           //!< Zipf 分布の指数です.
+    uint32_t        Seed;           //!< 乱数シードです.
+
+    WorkloadDesc()
+    : Type      ( WORKLOAD_ZIPF )
+    , KeyCount  ( 1u << 20 )
+    , Length    ( 1u << 22 )
+    , Skew      ( 0.9 )
+    , Seed      ( 0x12345678 )
+    { /* DO_NOTHING */ }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      アクセスパターン名を取得します.
+//-------------------------------------------------------------------------------------------------
+const char* GetWorkloadName( WORKLOAD_TYPE type );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      アクセストレースを生成します.
+//!
+//! @param[in]      desc        生成設定です.
+//! @param[out]     trace       生成したキー列の格納先です.
+//! @retval true    生成に成功.
+//! @retval false   生成に失敗.
+//! @note       キーは連番にならないよう並べ替えてあり, 同じ設定からは常に同じトレースを生成します.
+//-------------------------------------------------------------------------------------------------
+bool GenerateWorkload( const WorkloadDesc& desc, std::vector<uint32_t>& trace );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      記録したアクセストレースを読み込みます.
+//!
+//! @param[in]      path        テキストファイルのパスです.
+//! @param[out]     trace       読み込んだキー列の格納先です.
+//! @retval true    読み込みに成功.
+//! @retval false   読み込みに失敗.
+//! @note       1行1アクセスで, 数値の行はそのままキーとし, それ以外の行 (アセットのパスなど) は
+//!             ハッシュ値をキーとします. 空行と '#' で始まる行は無視します.
+//-------------------------------------------------------------------------------------------------
+bool LoadTrace( const char* path, std::vector<uint32_t>& trace );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      アクセストレースを LoadTrace() で読み込める形式で保存します.
+//-------------------------------------------------------------------------------------------------
+bool SaveTrace( const char* path, const std::vector<uint32_t>& trace );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      トレースに含まれる異なるキーの数を取得します.
+//-------------------------------------------------------------------------------------------------
+size_t CountUniqueKeys( const std::vector<uint32_t>& trace );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      キーに対する決定的な重みを取得します.
+//!
+//! @param[in]      key         キーです.
+//! @param[in]      minWeight   重みの最小値です.
+//! @param[in]      maxWeight   重みの最大値です.
+//! @return     [minWeight, maxWeight] の範囲の重みを返却します.
+//-------------------------------------------------------------------------------------------------
+uint32_t GetKeyWeight( uint32_t key, uint32_t minWeight, uint32_t maxWeight );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      高分解能タイマーの現在値を秒単位で取得します.
+//-------------------------------------------------------------------------------------------------
+double GetBenchTime();
+
+
+#endif//__BENCH_WORKLOAD_H__
@@ -0,0 +1,61 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : ListLruCache.h
+// Desc : List Based LRU Cache (Reference Implementation).
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __LIST_LRU_CACHE_H__
+#define __LIST_LRU_CACHE_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <list>
+#include <algorithm>
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ListLruCache class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// 比較用に, 索引を持たない以前の asdx::LruCache と同じアルゴリズムを残しておきます.
+// Contains() と Add() がどちらもリストを線形探索するため, 1回の操作が O(容量) になります.
+template<typename T>
+class ListLruCache
+{
+public:
+    explicit ListLruCache( size_t capacity )
+    : m_Capacity( capacity )
+    , m_Cache   ()
+    { /* DO_NOTHING */ }
+
+    void Add( const T& item )
+    {
+        if ( Contains( item ) )
+        {
+            m_Cache.remove( item );
+            m_Cache.push_back( item );
+        }
+        else if ( m_Cache.size() < m_Capacity )
+        {
+            m_Cache.push_back( item );
+        }
+        else
+        {
+            m_Cache.pop_front();
+            m_Cache.push_back( item );
+        }
+    }
+
+    bool Contains( const T& item ) const
+    { return std::find( m_Cache.cbegin(), m_Cache.cend(), item ) != m_Cache.cend(); }
+
+    size_t GetCount() const
+    { return m_Cache.size(); }
+
+private:
+    size_t          m_Capacity;
+    std::list<T>    m_Cache;
+};
+
+
+#endif//__LIST_LRU_CACHE_H__
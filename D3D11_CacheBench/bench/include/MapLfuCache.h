@@ -0,0 +1,72 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : MapLfuCache.h
+// Desc : Map Based LFU Cache (Reference Implementation).
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __MAP_LFU_CACHE_H__
+#define __MAP_LFU_CACHE_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <map>
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MapLfuCache class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// 比較用に, 以前の asdx::LfuCache と同じアルゴリズムを残しておきます.
+// 追い出しのたびに全要素を走査して最小の参照回数を探すため, 満杯時の追加が O(容量) になります.
+// 参照回数は減衰しません.
+template<typename T>
+class MapLfuCache
+{
+public:
+    explicit MapLfuCache( size_t capacity )
+    : m_Capacity( capacity )
+    , m_Cache   ()
+    { /* DO_NOTHING */ }
+
+    void Add( const T& item )
+    {
+        if ( Contains( item ) )
+        {
+            m_Cache[item]++;
+        }
+        else if ( m_Cache.size() < m_Capacity )
+        {
+            m_Cache[item] = 1;
+        }
+        else
+        {
+            auto iter = m_Cache.begin();
+            auto mini = (*iter).second;
+
+            for( auto it = m_Cache.begin(); it != m_Cache.end(); ++it )
+            {
+                if ( (*it).second < mini )
+                {
+                    mini = (*it).second;
+                    iter = it;
+                }
+            }
+
+            m_Cache.erase( iter );
+            m_Cache[item] = 1;
+        }
+    }
+
+    bool Contains( const T& item ) const
+    { return m_Cache.find( item ) != m_Cache.cend(); }
+
+    size_t GetCount() const
+    { return m_Cache.size(); }
+
+private:
+    size_t                 m_Capacity;
+    std::map<T, size_t>    m_Cache;
+};
+
+
+#endif//__MAP_LFU_CACHE_H__
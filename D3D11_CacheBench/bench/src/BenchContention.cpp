@@ -0,0 +1,298 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchContention.cpp
+// Desc : Multi Thread Cache Contention Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchContention.h>
+#include <BenchWorkload.h>
+#include <asdxLruCache.h>
+#include <asdxLfuCache.h>
+#include <asdxTinyLfuCache.h>
+#include <asdxShardedCache.h>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+
+namespace /* anonymous */ {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ContentionResult structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ContentionResult
+{
+    uint64_t    Operations;     //!< 全スレッドで処理したアクセス数です.
+    uint64_t    Hits;           //!< ヒット数です.
+    uint64_t    Computes;       //!< 生成処理の呼び出し回数です.
+    uint64_t    Waits;          //!< 他スレッドの生成完了を待った回数です.
+    double      Seconds;        //!< 計測時間です.
+};
+
+//-------------------------------------------------------------------------------------------------
+//      デコードの代わりとなる生成処理です.
+//-------------------------------------------------------------------------------------------------
+uint32_t Compute( uint32_t key, uint32_t cost )
+{
+    auto x = key | 1u;
+    for( uint32_t i=0; i<cost; ++i )
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+    }
+    return x;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MutexLruAdapter class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// 1つのミューテックスで LruMap を保護した比較用の実装です. 生成の重複排除は行いません.
+class MutexLruAdapter
+{
+public:
+    MutexLruAdapter( uint32_t capacity, uint32_t, uint32_t cost )
+    : m_Cache   ( capacity )
+    , m_Cost    ( cost )
+    , m_Computes( 0 )
+    { m_Cache.Reserve( capacity ); }
+
+    bool Access( uint32_t key )
+    {
+        {
+            std::lock_guard<std::mutex> locker( m_Mutex );
+            if ( m_Cache.Get( key ) != nullptr )
+            { return true; }
+        }
+
+        m_Computes.fetch_add( 1, std::memory_order_relaxed );
+        auto value = Compute( key, m_Cost );
+
+        std::lock_guard<std::mutex> locker( m_Mutex );
+        m_Cache.Put( key, value );
+        return false;
+    }
+
+    uint64_t GetComputeCount() const
+    { return m_Computes.load(); }
+
+    uint64_t GetWaitCount() const
+    { return 0; }
+
+private:
+    std::mutex                          m_Mutex;
+    asdx::LruMap<uint32_t, uint32_t>    m_Cache;
+    uint32_t                            m_Cost;
+    std::atomic<uint64_t>               m_Computes;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ShardedAdapter class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<template<typename, typename, typename> class TPolicy>
+class ShardedAdapter
+{
+public:
+    ShardedAdapter( uint32_t capacity, uint32_t shards, uint32_t cost )
+    : m_Cache( capacity, shards )
+    , m_Cost ( cost )
+    { /* DO_NOTHING */ }
+
+    bool Access( uint32_t key )
+    {
+        auto hit = true;
+        m_Cache.GetOrCompute( key, [&]( const uint32_t& k, uint32_t& value, size_t& )
+        {
+            hit   = false;
+            value = Compute( k, m_Cost );
+            return true;
+        });
+        return hit;
+    }
+
+    uint64_t GetComputeCount() const
+    { return m_Cache.GetComputeCount(); }
+
+    uint64_t GetWaitCount() const
+    { return m_Cache.GetWaitCount(); }
+
+private:
+    asdx::ShardedCache<uint32_t, uint32_t, TPolicy> m_Cache;
+    uint32_t                                        m_Cost;
+};
+
+//-------------------------------------------------------------------------------------------------
+//      全スレッドでトレースを分担して再生します.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+ContentionResult RunThreads
+(
+    const ContentionDesc&           desc,
+    uint32_t                        threadCount,
+    uint32_t                        shardCount,
+    const std::vector<uint32_t>&    trace
+)
+{
+    T cache( desc.Capacity, shardCount, desc.ComputeCost );
+
+    std::atomic<uint32_t> ready( 0 );
+    std::atomic<bool>     start( false );
+    std::atomic<uint64_t> hits ( 0 );
+
+    std::vector<std::thread> workers;
+    workers.reserve( threadCount );
+
+    for( uint32_t t=0; t<threadCount; ++t )
+    {
+        workers.emplace_back( [&, t]()
+        {
+            auto begin = trace.size() * t / threadCount;
+            auto end   = trace.size() * ( t + 1 ) / threadCount;
+
+            ready.fetch_add( 1 );
+            while( !start.load() )
+            { std::this_thread::yield(); }
+
+            uint64_t localHits = 0;
+            for( auto i=begin; i<end; ++i )
+            {
+                if ( cache.Access( trace[i] ) )
+                { localHits++; }
+            }
+
+            hits.fetch_add( localHits );
+        });
+    }
+
+    while( ready.load() < threadCount )
+    { std::this_thread::yield(); }
+
+    auto begin = GetBenchTime();
+    start.store( true );
+
+    for( auto& worker : workers )
+    { worker.join(); }
+
+    ContentionResult result = {};
+    result.Seconds    = GetBenchTime() - begin;
+    result.Operations = trace.size();
+    result.Hits       = hits.load();
+    result.Computes   = cache.GetComputeCount();
+    result.Waits      = cache.GetWaitCount();
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      結果を表示します.
+//-------------------------------------------------------------------------------------------------
+void PrintResult( const char* name, uint32_t threads, const ContentionResult& item )
+{
+    auto mops    = ( item.Seconds > 0.0 ) ? double( item.Operations ) / item.Seconds / 1e6 : 0.0;
+    auto hitRate = ( item.Operations > 0 ) ? double( item.Hits ) * 100.0 / double( item.Operations ) : 0.0;
+
+    printf( "%-16s %7u %10.2f %8.2f%% %12llu %10llu\n",
+        name,
+        threads,
+        mops,
+        hitRate,
+        (unsigned long long)item.Computes,
+        (unsigned long long)item.Waits );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      同じキーへの同時要求で生成が1回に抑えられることを検証します.
+//-------------------------------------------------------------------------------------------------
+bool VerifyDedup( uint32_t threadCount )
+{
+    static const uint32_t kKeyCount = 64;
+
+    asdx::ShardedCache<uint32_t, uint32_t> cache( kKeyCount * 2, 4 );
+    std::atomic<uint32_t> computes( 0 );
+    std::atomic<bool>     start( false );
+
+    std::vector<std::thread> workers;
+    for( uint32_t t=0; t<threadCount; ++t )
+    {
+        workers.emplace_back( [&]()
+        {
+            while( !start.load() )
+            { std::this_thread::yield(); }
+
+            for( uint32_t key=0; key<kKeyCount; ++key )
+            {
+                cache.GetOrCompute( key, [&]( const uint32_t& k, uint32_t& value, size_t& )
+                {
+                    computes.fetch_add( 1 );
+                    value = Compute( k, 200000 );
+                    return true;
+                });
+            }
+        });
+    }
+
+    start.store( true );
+    for( auto& worker : workers )
+    { worker.join(); }
+
+    printf( "dedup : threads = %u, keys = %u, computes = %u, waits = %llu\n",
+        threadCount, kKeyCount, computes.load(), (unsigned long long)cache.GetWaitCount() );
+
+    if ( computes.load() != kKeyCount )
+    {
+        fprintf( stderr, "Error : Duplicated Compute. expected = %u, actual = %u\n", kKeyCount, computes.load() );
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      複数スレッドから同じキャッシュを使用した場合の性能を計測します.
+//-------------------------------------------------------------------------------------------------
+bool RunContention( const ContentionDesc& desc, const std::vector<uint32_t>& trace )
+{
+    printf( "capacity = %u, compute cost = %u\n", desc.Capacity, desc.ComputeCost );
+    printf( "%-16s %7s %10s %9s %12s %10s\n", "cache", "threads", "Mops/s", "hit", "computes", "waits" );
+
+    auto accept = [&]( const char* name )
+    { return desc.Filter.empty() || strstr( name, desc.Filter.c_str() ) != nullptr; };
+
+    for( auto threads : desc.Threads )
+    {
+        if ( accept( "mutex_lru" ) )
+        { PrintResult( "mutex_lru", threads, RunThreads<MutexLruAdapter>( desc, threads, 1, trace ) ); }
+
+        for( auto shards : desc.Shards )
+        {
+            char name[64];
+
+            snprintf( name, sizeof(name), "sharded_lru_%u", shards );
+            if ( accept( name ) )
+            { PrintResult( name, threads, RunThreads<ShardedAdapter<asdx::LruMap>>( desc, threads, shards, trace ) ); }
+
+            snprintf( name, sizeof(name), "sharded_lfu_%u", shards );
+            if ( accept( name ) )
+            { PrintResult( name, threads, RunThreads<ShardedAdapter<asdx::LfuMap>>( desc, threads, shards, trace ) ); }
+
+            snprintf( name, sizeof(name), "sharded_tlfu_%u", shards );
+            if ( accept( name ) )
+            { PrintResult( name, threads, RunThreads<ShardedAdapter<asdx::TinyLfuMap>>( desc, threads, shards, trace ) ); }
+        }
+    }
+
+    auto maxThreads = 1u;
+    for( auto threads : desc.Threads )
+    { maxThreads = ( threads > maxThreads ) ? threads : maxThreads; }
+
+    return VerifyDedup( ( maxThreads > 1 ) ? maxThreads : 2 );
+}
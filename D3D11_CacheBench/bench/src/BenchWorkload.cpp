@@ -0,0 +1,272 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchWorkload.cpp
+// Desc : Synthetic Cache Access Trace Generator.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchWorkload.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_set>
+
+
+namespace /* anonymous */ {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Random class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class Random
+{
+public:
+    explicit Random( uint32_t seed )
+    : m_State( ( seed != 0 ) ? seed : 0x9e3779b9 )
+    { /* DO_NOTHING */ }
+
+    uint32_t GetU32()
+    {
+        m_State ^= m_State << 13;
+        m_State ^= m_State >> 17;
+        m_State ^= m_State << 5;
+        return m_State;
+    }
+
+    double GetF64()
+    { return double( GetU32() ) / 4294967296.0; }
+
+private:
+    uint32_t m_State;
+};
+
+//-------------------------------------------------------------------------------------------------
+//      キーを攪拌します.
+//-------------------------------------------------------------------------------------------------
+uint32_t MixKey( uint32_t x )
+{
+    // 32bit の全単射なので衝突しない.
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return x;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      Zipf 分布の累積分布表を作成します.
+//-------------------------------------------------------------------------------------------------
+void BuildZipfTable( uint32_t count, double skew, std::vector<double>& cdf )
+{
+    cdf.resize( count );
+
+    auto sum = 0.0;
+    for( uint32_t i=0; i<count; ++i )
+    {
+        sum += 1.0 / pow( double( i + 1 ), skew );
+        cdf[i] = sum;
+    }
+
+    for( uint32_t i=0; i<count; ++i )
+    { cdf[i] /= sum; }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      Zipf 分布に従う順位を取得します.
+//-------------------------------------------------------------------------------------------------
+uint32_t SampleZipf( const std::vector<double>& cdf, Random& random )
+{
+    auto itr = std::lower_bound( cdf.begin(), cdf.end(), random.GetF64() );
+    if ( itr == cdf.end() )
+    { return uint32_t( cdf.size() - 1 ); }
+    return uint32_t( itr - cdf.begin() );
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      アクセスパターン名を取得します.
+//-------------------------------------------------------------------------------------------------
+const char* GetWorkloadName( WORKLOAD_TYPE type )
+{
+    switch( type )
+    {
+    case WORKLOAD_ZIPF:     return "zipf";
+    case WORKLOAD_LOOP:     return "loop";
+    case WORKLOAD_MIXED:    return "mixed";
+    default:                break;
+    }
+
+    return "unknown";
+}
+
+//-------------------------------------------------------------------------------------------------
+//      アクセストレースを生成します.
+//-------------------------------------------------------------------------------------------------
+bool GenerateWorkload( const WorkloadDesc& desc, std::vector<uint32_t>& trace )
+{
+    if ( desc.KeyCount == 0 || desc.Length == 0 )
+    {
+        fprintf( stderr, "Error : Invalid Workload. keys = %u, length = %u\n", desc.KeyCount, desc.Length );
+        return false;
+    }
+
+    Random random( desc.Seed );
+    trace.resize( desc.Length );
+
+    std::vector<double> cdf;
+    if ( desc.Type != WORKLOAD_LOOP )
+    { BuildZipfTable( desc.KeyCount, desc.Skew, cdf ); }
+
+    switch( desc.Type )
+    {
+    case WORKLOAD_ZIPF:
+        {
+            for( uint32_t i=0; i<desc.Length; ++i )
+            { trace[i] = MixKey( SampleZipf( cdf, random ) ); }
+        }
+        break;
+
+    case WORKLOAD_LOOP:
+        {
+            for( uint32_t i=0; i<desc.Length; ++i )
+            { trace[i] = MixKey( i % desc.KeyCount ); }
+        }
+        break;
+
+    case WORKLOAD_MIXED:
+        {
+            // 1/8 の区間ごとに, 人気キーとは重ならない一度きりの走査を挟む.
+            auto scanLength = std::max( desc.Length / 64u, 1u );
+            auto scanKey    = desc.KeyCount;
+            for( uint32_t i=0; i<desc.Length; ++i )
+            {
+                auto phase = i % ( desc.Length / 8u + 1u );
+                if ( phase < scanLength )
+                { trace[i] = MixKey( scanKey++ ); }
+                else
+                { trace[i] = MixKey( SampleZipf( cdf, random ) ); }
+            }
+        }
+        break;
+
+    default:
+        fprintf( stderr, "Error : Unknown Workload. type = %d\n", int( desc.Type ) );
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      記録したアクセストレースを読み込みます.
+//-------------------------------------------------------------------------------------------------
+bool LoadTrace( const char* path, std::vector<uint32_t>& trace )
+{
+    FILE* pFile = fopen( path, "r" );
+    if ( pFile == nullptr )
+    {
+        fprintf( stderr, "Error : File Open Failed. path = %s\n", path );
+        return false;
+    }
+
+    trace.clear();
+
+    char line[4096];
+    while( fgets( line, sizeof(line), pFile ) != nullptr )
+    {
+        // 前後の空白と改行を取り除く.
+        auto pBegin = line;
+        while( *pBegin == ' ' || *pBegin == '\t' )
+        { pBegin++; }
+
+        auto pEnd = pBegin + strlen( pBegin );
+        while( pEnd > pBegin && ( pEnd[-1] == '\n' || pEnd[-1] == '\r' || pEnd[-1] == ' ' || pEnd[-1] == '\t' ) )
+        { pEnd--; }
+        *pEnd = '\0';
+
+        if ( pBegin == pEnd || *pBegin == '#' )
+        { continue; }
+
+        char* pParsed = nullptr;
+        auto value = strtoul( pBegin, &pParsed, 0 );
+        if ( pParsed == pEnd )
+        {
+            trace.push_back( uint32_t( value ) );
+            continue;
+        }
+
+        // FNV-1a でパスなどの文字列をキーにする.
+        uint32_t hash = 2166136261u;
+        for( auto p = pBegin; p != pEnd; ++p )
+        {
+            hash ^= uint8_t( *p );
+            hash *= 16777619u;
+        }
+        trace.push_back( hash );
+    }
+
+    fclose( pFile );
+
+    if ( trace.empty() )
+    {
+        fprintf( stderr, "Error : Empty Trace. path = %s\n", path );
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      アクセストレースを保存します.
+//-------------------------------------------------------------------------------------------------
+bool SaveTrace( const char* path, const std::vector<uint32_t>& trace )
+{
+    FILE* pFile = fopen( path, "w" );
+    if ( pFile == nullptr )
+    {
+        fprintf( stderr, "Error : File Open Failed. path = %s\n", path );
+        return false;
+    }
+
+    for( auto key : trace )
+    { fprintf( pFile, "%u\n", key ); }
+
+    fclose( pFile );
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      トレースに含まれる異なるキーの数を取得します.
+//-------------------------------------------------------------------------------------------------
+size_t CountUniqueKeys( const std::vector<uint32_t>& trace )
+{
+    std::unordered_set<uint32_t> keys( trace.begin(), trace.end() );
+    return keys.size();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      キーに対する決定的な重みを取得します.
+//-------------------------------------------------------------------------------------------------
+uint32_t GetKeyWeight( uint32_t key, uint32_t minWeight, uint32_t maxWeight )
+{
+    if ( maxWeight <= minWeight )
+    { return minWeight; }
+
+    return minWeight + MixKey( key ^ 0xa5a5a5a5 ) % ( maxWeight - minWeight + 1 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      高分解能タイマーの現在値を秒単位で取得します.
+//-------------------------------------------------------------------------------------------------
+double GetBenchTime()
+{
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double>( now ).count();
+}
@@ -0,0 +1,409 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : main.cpp
+// Desc : Cache Benchmark Main Entry Point.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchWorkload.h>
+#include <BenchContention.h>
+#include <ListLruCache.h>
+#include <MapLfuCache.h>
+#include <asdxLruCache.h>
+#include <asdxLfuCache.h>
+#include <asdxTinyLfuCache.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const uint32_t   kMinWeight   = 4  * 1024;   // 重み付き計測での最小エントリサイズ.
+static const uint32_t   kMaxWeight   = 60 * 1024;   // 重み付き計測での最大エントリサイズ.
+static const uint32_t   kCheckPeriod = 4096;        // 経過時間を確認する間隔です.
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BenchDesc structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BenchDesc
+{
+    WorkloadDesc            Workload;       //!< アクセストレースの生成設定です.
+    std::vector<uint32_t>   Capacities;     //!< 計測するキャッシュ容量 (エントリ数) です.
+    double                  MaxTime;        //!< 1計測当たりの最大時間 [sec] です.
+    std::string             Filter;         //!< 計測するキャッシュ名に含まれる文字列です.
+    std::string             TracePath;      //!< 読み込む記録済みトレースのパスです.
+    std::string             SavePath;       //!< 使用したトレースの保存先です.
+    ContentionDesc          Contention;     //!< 複数スレッド計測の設定です.
+
+    BenchDesc()
+    : MaxTime( 5.0 )
+    {
+        Capacities.push_back( 256 );
+        Capacities.push_back( 4096 );
+        Capacities.push_back( 65536 );
+    }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BenchResult structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BenchResult
+{
+    std::string     Name;           //!< キャッシュ名です.
+    uint32_t        Capacity;       //!< 容量 (エントリ数) です.
+    uint64_t        Operations;     //!< 処理したアクセス数です.
+    uint64_t        Hits;           //!< ヒット数です.
+    double          Seconds;        //!< 計測時間です.
+    bool            Completed;      //!< トレースを最後まで処理したかどうか.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SetAdapter class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename TSet>
+class SetAdapter
+{
+public:
+    explicit SetAdapter( uint32_t capacity )
+    : m_Cache( capacity )
+    { /* DO_NOTHING */ }
+
+    bool Access( uint32_t key )
+    {
+        auto hit = m_Cache.Contains( key );
+        m_Cache.Add( key );
+        return hit;
+    }
+
+private:
+    TSet m_Cache;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MapAdapter class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename TMap>
+class MapAdapter
+{
+public:
+    explicit MapAdapter( uint32_t capacity )
+    : m_Cache( capacity )
+    { m_Cache.Reserve( capacity ); }
+
+    bool Access( uint32_t key )
+    {
+        if ( m_Cache.Get( key ) != nullptr )
+        { return true; }
+
+        m_Cache.Put( key, key );
+        return false;
+    }
+
+private:
+    TMap m_Cache;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BytesAdapter class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename TMap>
+class BytesAdapter
+{
+public:
+    // 容量は平均サイズのエントリが capacity 個入るバイト数とする.
+    explicit BytesAdapter( uint32_t capacity )
+    : m_Cache( size_t( capacity ) * ( kMinWeight + kMaxWeight ) / 2 )
+    , m_Evicted( 0 )
+    {
+        m_Cache.Reserve( capacity );
+        m_Cache.SetEvictCallback( [this]( const uint32_t&, uint32_t& weight )
+        { m_Evicted += weight; });
+    }
+
+    bool Access( uint32_t key )
+    {
+        if ( m_Cache.Get( key ) != nullptr )
+        { return true; }
+
+        auto weight = GetKeyWeight( key, kMinWeight, kMaxWeight );
+        m_Cache.Put( key, weight, weight );
+        return false;
+    }
+
+private:
+    TMap        m_Cache;
+    uint64_t    m_Evicted;
+};
+
+//-------------------------------------------------------------------------------------------------
+//      トレースを再生してキャッシュの性能を計測します.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+BenchResult RunCache( const char* name, uint32_t capacity, const std::vector<uint32_t>& trace, double maxTime )
+{
+    T cache( capacity );
+
+    BenchResult result = {};
+    result.Name      = name;
+    result.Capacity  = capacity;
+    result.Completed = true;
+
+    auto begin = GetBenchTime();
+    for( size_t i=0; i<trace.size(); ++i )
+    {
+        if ( cache.Access( trace[i] ) )
+        { result.Hits++; }
+
+        // 線形探索の実装は大容量で極端に遅いため打ち切る.
+        if ( ( i % kCheckPeriod ) == kCheckPeriod - 1 && GetBenchTime() - begin > maxTime )
+        {
+            result.Operations = i + 1;
+            result.Completed  = false;
+            break;
+        }
+    }
+
+    result.Seconds = GetBenchTime() - begin;
+    if ( result.Completed )
+    { result.Operations = trace.size(); }
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      カンマ区切りの数値リストを解析します.
+//-------------------------------------------------------------------------------------------------
+void ParseList( const char* text, std::vector<uint32_t>& result )
+{
+    result.clear();
+    for( auto p = text; *p != '\0'; )
+    {
+        char* end = nullptr;
+        auto value = strtoul( p, &end, 0 );
+        if ( end == p )
+        { break; }
+
+        if ( value > 0 )
+        { result.push_back( uint32_t( value ) ); }
+
+        p = ( *end == ',' ) ? end + 1 : end;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      使用方法を表示します.
+//-------------------------------------------------------------------------------------------------
+void PrintUsage()
+{
+    printf( "Usage : bench [options]\n" );
+    printf( "  -workload <name>     access pattern: zipf, loop, mixed (default: zipf)\n" );
+    printf( "  -keys <N>            size of the key space (default: 1048576)\n" );
+    printf( "  -length <N>          number of accesses (default: 4194304)\n" );
+    printf( "  -skew <S>            zipf exponent (default: 0.9)\n" );
+    printf( "  -seed <N>            trace random seed (default: 305419896)\n" );
+    printf( "  -trace <file>        replay a recorded trace instead (one key or asset path per line)\n" );
+    printf( "  -save <file>         write the trace in use to <file>\n" );
+    printf( "  -capacity <a,b,...>  cache capacities in entries (default: 256,4096,65536)\n" );
+    printf( "  -maxtime <sec>       time limit per run (default: 5)\n" );
+    printf( "  -filter <text>       run only caches whose name contains <text>\n" );
+    printf( "  -threads <a,b,...>   run the multi-thread contention benchmark (uses the last -capacity)\n" );
+    printf( "  -shards <a,b,...>    shard counts for the contention benchmark (default: 1,16,64)\n" );
+    printf( "  -compute <N>         miss penalty in loop iterations for the contention benchmark (default: 2000)\n" );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      コマンドライン引数を解析します.
+//-------------------------------------------------------------------------------------------------
+bool ParseArgs( int argc, char** argv, BenchDesc& desc )
+{
+    for( auto i=1; i<argc; ++i )
+    {
+        auto hasNext = ( i + 1 < argc );
+
+        if ( strcmp( argv[i], "-workload" ) == 0 && hasNext )
+        {
+            auto found = false;
+            ++i;
+            for( auto type=0; type<NUM_WORKLOAD_TYPE; ++type )
+            {
+                if ( strcmp( argv[i], GetWorkloadName( WORKLOAD_TYPE( type ) ) ) == 0 )
+                {
+                    desc.Workload.Type = WORKLOAD_TYPE( type );
+                    found = true;
+                }
+            }
+
+            if ( !found )
+            {
+                fprintf( stderr, "Error : Unknown Workload. name = %s\n", argv[i] );
+                return false;
+            }
+        }
+        else if ( strcmp( argv[i], "-keys" ) == 0 && hasNext )
+        { desc.Workload.KeyCount = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else if ( strcmp( argv[i], "-length" ) == 0 && hasNext )
+        { desc.Workload.Length = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else if ( strcmp( argv[i], "-skew" ) == 0 && hasNext )
+        { desc.Workload.Skew = atof( argv[++i] ); }
+        else if ( strcmp( argv[i], "-seed" ) == 0 && hasNext )
+        { desc.Workload.Seed = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else if ( strcmp( argv[i], "-trace" ) == 0 && hasNext )
+        { desc.TracePath = argv[++i]; }
+        else if ( strcmp( argv[i], "-save" ) == 0 && hasNext )
+        { desc.SavePath = argv[++i]; }
+        else if ( strcmp( argv[i], "-capacity" ) == 0 && hasNext )
+        { ParseList( argv[++i], desc.Capacities ); }
+        else if ( strcmp( argv[i], "-maxtime" ) == 0 && hasNext )
+        { desc.MaxTime = atof( argv[++i] ); }
+        else if ( strcmp( argv[i], "-filter" ) == 0 && hasNext )
+        { desc.Filter = argv[++i]; }
+        else if ( strcmp( argv[i], "-threads" ) == 0 && hasNext )
+        { ParseList( argv[++i], desc.Contention.Threads ); }
+        else if ( strcmp( argv[i], "-shards" ) == 0 && hasNext )
+        { ParseList( argv[++i], desc.Contention.Shards ); }
+        else if ( strcmp( argv[i], "-compute" ) == 0 && hasNext )
+        { desc.Contention.ComputeCost = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else
+        {
+            fprintf( stderr, "Error : Unknown Option. option = %s\n", argv[i] );
+            PrintUsage();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      結果を表示します.
+//-------------------------------------------------------------------------------------------------
+void PrintResult( const BenchResult& item )
+{
+    auto nsPerOp = ( item.Operations > 0 ) ? item.Seconds * 1e9 / double( item.Operations ) : 0.0;
+    auto mops    = ( item.Seconds > 0.0 ) ? double( item.Operations ) / item.Seconds / 1e6 : 0.0;
+    auto hitRate = ( item.Operations > 0 ) ? double( item.Hits ) * 100.0 / double( item.Operations ) : 0.0;
+
+    printf( "%-12s %9u %12llu %10.2f %10.1f %8.2f%% %s\n",
+        item.Name.c_str(),
+        item.Capacity,
+        (unsigned long long)item.Operations,
+        mops,
+        nsPerOp,
+        hitRate,
+        item.Completed ? "" : "(time limit)" );
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-------------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+    BenchDesc desc;
+    if ( !ParseArgs( argc, argv, desc ) )
+    { return -1; }
+
+    std::vector<uint32_t> trace;
+    if ( !desc.TracePath.empty() )
+    {
+        if ( !LoadTrace( desc.TracePath.c_str(), trace ) )
+        { return -1; }
+
+        printf( "trace = %s, keys = %zu, length = %zu\n",
+            desc.TracePath.c_str(),
+            CountUniqueKeys( trace ),
+            trace.size() );
+    }
+    else
+    {
+        if ( !GenerateWorkload( desc.Workload, trace ) )
+        { return -1; }
+
+        printf( "workload = %s, keys = %u, length = %u, skew = %.2f\n",
+            GetWorkloadName( desc.Workload.Type ),
+            desc.Workload.KeyCount,
+            desc.Workload.Length,
+            desc.Workload.Skew );
+    }
+
+    if ( !desc.SavePath.empty() && !SaveTrace( desc.SavePath.c_str(), trace ) )
+    { return -1; }
+
+    // スレッド数が指定された場合は複数スレッドの計測のみ行う.
+    if ( !desc.Contention.Threads.empty() )
+    {
+        if ( desc.Contention.Shards.empty() )
+        {
+            desc.Contention.Shards.push_back( 1 );
+            desc.Contention.Shards.push_back( 16 );
+            desc.Contention.Shards.push_back( 64 );
+        }
+
+        if ( !desc.Capacities.empty() )
+        { desc.Contention.Capacity = desc.Capacities.back(); }
+
+        desc.Contention.Filter = desc.Filter;
+        return RunContention( desc.Contention, trace ) ? 0 : 1;
+    }
+
+    printf( "%-12s %9s %12s %10s %10s %9s\n", "cache", "capacity", "ops", "Mops/s", "ns/op", "hit" );
+
+    auto mismatch = 0;
+
+    for( auto capacity : desc.Capacities )
+    {
+        std::vector<BenchResult> exact;
+
+        auto run = [&]( const char* name, BenchResult (*func)( const char*, uint32_t, const std::vector<uint32_t>&, double ), bool isExact )
+        {
+            if ( !desc.Filter.empty() && strstr( name, desc.Filter.c_str() ) == nullptr )
+            { return; }
+
+            auto result = func( name, capacity, trace, desc.MaxTime );
+            PrintResult( result );
+
+            if ( isExact && result.Completed )
+            { exact.push_back( result ); }
+        };
+
+        run( "list_lru",   RunCache<SetAdapter<ListLruCache<uint32_t>>>,                 true  );
+        run( "lru_set",    RunCache<SetAdapter<asdx::LruCache<uint32_t>>>,               true  );
+        run( "lru_map",    RunCache<MapAdapter<asdx::LruMap<uint32_t, uint32_t>>>,       true  );
+        run( "lru_bytes",  RunCache<BytesAdapter<asdx::LruMap<uint32_t, uint32_t>>>,     false );
+        run( "map_lfu",    RunCache<SetAdapter<MapLfuCache<uint32_t>>>,                  false );
+        run( "lfu_set",    RunCache<SetAdapter<asdx::LfuCache<uint32_t>>>,               false );
+        run( "lfu_map",    RunCache<MapAdapter<asdx::LfuMap<uint32_t, uint32_t>>>,       false );
+        run( "lfu_bytes",  RunCache<BytesAdapter<asdx::LfuMap<uint32_t, uint32_t>>>,     false );
+        run( "tlfu_map",   RunCache<MapAdapter<asdx::TinyLfuMap<uint32_t, uint32_t>>>,   false );
+        run( "tlfu_bytes", RunCache<BytesAdapter<asdx::TinyLfuMap<uint32_t, uint32_t>>>, false );
+
+        // 同じ容量の厳密な LRU はヒット数が一致するはず.
+        for( size_t i=1; i<exact.size(); ++i )
+        {
+            if ( exact[i].Hits != exact[0].Hits )
+            {
+                fprintf( stderr, "Error : Hit Count Mismatch. %s = %llu, %s = %llu\n",
+                    exact[0].Name.c_str(), (unsigned long long)exact[0].Hits,
+                    exact[i].Name.c_str(), (unsigned long long)exact[i].Hits );
+                mismatch++;
+            }
+        }
+    }
+
+    return ( mismatch == 0 ) ? 0 : 1;
+}
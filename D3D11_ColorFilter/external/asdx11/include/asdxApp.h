@@ -19,6 +19,7 @@
 #include <asdxTarget.h>
 #include <asdxTimer.h>
 #include <asdxHid.h>
+#include <asdxDerivedDataCache.h>
 
 #if defined(ASDX_ENABLE_D2D)
 #include <d2d1_1.h>
@@ -247,6 +248,7 @@ protected:
     HICON                           m_hIcon;                //!< アイコンハンドルです.
     HMENU                           m_hMenu;                //!< メニューハンドルです.
     HACCEL                          m_hAccel;               //!< アクセレレータハンドルです.
+    DerivedDataCacheDesc            m_CacheDesc;            //!< 派生データキャッシュの構成設定です. MaxSize に 0 を指定すると使用しません.
 
 #if ASDX_IS_DEBUG
     RefPtr<ID3D11Debug>             m_pD3D11Debug;          //!< デバッグオブジェクトです.
@@ -0,0 +1,369 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxAssetPack.h
+// Desc : Asset Pack Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const uint32_t   ASSET_PACK_MAGIC              = 0x4B415041;    //!< マジックナンバー ('APAK') です.
+static const uint32_t   ASSET_PACK_VERSION            = 2;             //!< ファイルバージョンです.
+static const uint32_t   ASSET_PACK_ALIGNMENT          = 4096;          //!< ペイロードのアライメントです.
+static const uint32_t   ASSET_PACK_DEFAULT_BLOCK_SIZE = 128 * 1024;    //!< 圧縮ブロックサイズの既定値です.
+static const uint32_t   ASSET_PACK_MIN_BLOCK_SIZE     = 64 * 1024;     //!< 圧縮ブロックサイズの最小値です.
+static const uint32_t   ASSET_PACK_MAX_BLOCK_SIZE     = 256 * 1024;    //!< 圧縮ブロックサイズの最大値です.
+static const uint32_t   ASSET_PACK_FLAG_COMPRESSED    = 0x1;           //!< ペイロードがブロック圧縮されていることを示します.
+static const uint32_t   ASSET_PACK_BLOCK_RAW          = 0x80000000;    //!< ブロックが無圧縮で格納されていることを示します.
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AssetPackHeader structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  パックファイルのヘッダです. 直後にエントリ配列, 名前テーブル, ペイロードの順に続きます.
+struct AssetPackHeader
+{
+    uint32_t    Magic;          //!< マジックナンバーです.
+    uint32_t    Version;        //!< ファイルバージョンです.
+    uint32_t    EntryCount;     //!< エントリ数です.
+    uint32_t    Alignment;      //!< ペイロードのアライメントです.
+    uint64_t    NameOffset;     //!< 名前テーブルの位置です.
+    uint64_t    NameSize;       //!< 名前テーブルのサイズです.
+    uint64_t    DataOffset;     //!< 先頭ペイロードの位置です.
+    uint64_t    FileSize;       //!< ファイルサイズです.
+    uint32_t    TocCrc;         //!< エントリ配列と名前テーブルの CRC-32C です.
+    uint32_t    BlockSize;      //!< 圧縮ブロックのサイズです.
+    uint32_t    Reserved[2];    //!< 予約領域です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AssetPackEntry structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  パックファイルのエントリです. ハッシュ値の昇順に格納されます.
+//! @note   圧縮されたペイロードは, ブロックごとの格納サイズの配列 (uint32_t) と各ブロックの順に並びます.
+//!         格納サイズに ASSET_PACK_BLOCK_RAW が立っているブロックは無圧縮です.
+//!         ブロックは独立して圧縮されているため, 並列に展開できます.
+struct AssetPackEntry
+{
+    uint64_t    Hash;           //!< 正規化したパスの XxHash64 です.
+    uint64_t    Offset;         //!< ペイロードの位置です.
+    uint64_t    Size;           //!< 展開後のサイズです.
+    uint64_t    StoredSize;     //!< ファイル上のサイズです.
+    uint32_t    NameOffset;     //!< 名前テーブル上の位置です.
+    uint32_t    Crc;            //!< 展開後のデータの CRC-32C です.
+    uint32_t    Flags;          //!< ASSET_PACK_FLAG_XXX の組み合わせです.
+    uint32_t    Reserved;       //!< 予約領域です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AssetView structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  マップされたペイロードへの参照です. パックを閉じるまで有効です.
+struct AssetView
+{
+    const uint8_t*  pData;      //!< ペイロードの先頭です.
+    uint64_t        Size;       //!< ペイロードのサイズです.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AssetPack class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  パックファイルをメモリマップして, エントリをその場で参照します.
+//! @note   開く際に検証するのはヘッダと目次のみです. ペイロードの CRC は Verify() で検証します.
+//!         圧縮されたエントリはその場で参照できないため, Read() で展開します.
+class AssetPack
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    AssetPack();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~AssetPack();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      パックファイルを開きます.
+    //!
+    //! @param[in]      path        ファイルパスです.
+    //! @retval true    オープンに成功.
+    //! @retval false   オープンに失敗.
+    //---------------------------------------------------------------------------------------------
+    bool Open( const char* path );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      パックファイルを閉じます.
+    //---------------------------------------------------------------------------------------------
+    void Close();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      開いているかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool IsOpen() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリ数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t GetEntryCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリ名を取得します.
+    //!
+    //! @param[in]      index       エントリ番号です.
+    //! @return     エントリ名を返却します. 範囲外の場合は nullptr を返却します.
+    //---------------------------------------------------------------------------------------------
+    const char* GetEntryName( uint32_t index ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリ番号を検索します.
+    //!
+    //! @param[in]      path        パスです. 区切り文字と大文字小文字は区別しません.
+    //! @return     エントリ番号を返却します. 見つからない場合は -1 を返却します.
+    //---------------------------------------------------------------------------------------------
+    int32_t FindIndex( const char* path ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリを検索します.
+    //!
+    //! @param[in]      path        パスです. 区切り文字と大文字小文字は区別しません.
+    //! @param[out]     result      ペイロードへの参照です.
+    //! @retval true    エントリが見つかった.
+    //! @retval false   エントリが見つからなかった, または圧縮されている.
+    //---------------------------------------------------------------------------------------------
+    bool Find( const char* path, AssetView& result ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリを取得します.
+    //!
+    //! @param[in]      index       エントリ番号です.
+    //! @param[out]     result      ペイロードへの参照です.
+    //! @retval true    取得に成功.
+    //! @retval false   範囲外, または圧縮されている.
+    //---------------------------------------------------------------------------------------------
+    bool GetEntry( uint32_t index, AssetView& result ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      展開後のサイズを取得します.
+    //!
+    //! @param[in]      index       エントリ番号です.
+    //! @return     展開後のサイズを返却します. 範囲外の場合は 0 を返却します.
+    //---------------------------------------------------------------------------------------------
+    uint64_t GetSize( uint32_t index ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ファイル上のサイズを取得します.
+    //!
+    //! @param[in]      index       エントリ番号です.
+    //! @return     ファイル上のサイズを返却します. 範囲外の場合は 0 を返却します.
+    //---------------------------------------------------------------------------------------------
+    uint64_t GetStoredSize( uint32_t index ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      圧縮されているかどうかチェックします.
+    //!
+    //! @param[in]      index       エントリ番号です.
+    //---------------------------------------------------------------------------------------------
+    bool IsCompressed( uint32_t index ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリを読み込みます. 圧縮されている場合は展開します.
+    //!
+    //! @param[in]      index       エントリ番号です.
+    //! @param[out]     pDst        出力先です.
+    //! @param[in]      dstSize     出力先のサイズです. GetSize() 以上である必要があります.
+    //! @param[in]      parallel    ブロックをジョブシステム上で並列に展開するかどうか.
+    //! @retval true    読み込みに成功.
+    //! @retval false   読み込みに失敗.
+    //! @note       展開前にペイロード全体の先読みを要求するため, 後続ブロックの読み込みと
+    //!             先頭ブロックの展開が重なります.
+    //---------------------------------------------------------------------------------------------
+    bool Read( uint32_t index, void* pDst, uint64_t dstSize, bool parallel = true ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ペイロードの CRC を検証します. 圧縮されている場合は展開して検証します.
+    //!
+    //! @param[in]      index       エントリ番号です.
+    //! @retval true    一致した.
+    //! @retval false   一致しなかった, または範囲外.
+    //---------------------------------------------------------------------------------------------
+    bool Verify( uint32_t index ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全エントリのペイロードの CRC を検証します.
+    //!
+    //! @return     一致しなかったエントリ数を返却します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t VerifyAll() const;
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    const uint8_t*              m_pBase;        //!< マップした先頭アドレスです.
+    uint64_t                    m_Size;         //!< マップしたサイズです.
+    const AssetPackHeader*      m_pHeader;      //!< ヘッダです.
+    const AssetPackEntry*       m_pEntries;     //!< エントリ配列です.
+    const char*                 m_pNames;       //!< 名前テーブルです.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    AssetPack             ( const AssetPack& ) = delete;
+    AssetPack& operator = ( const AssetPack& ) = delete;
+
+    bool Validate() const;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AssetPackWriter class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  パックファイルを作成します.
+//! @note   ファイルの内容は Write() の際に読み込むため, 登録時点ではファイルを開きません.
+//!         圧縮はジョブシステムが初期化されていればブロック単位で並列に行います.
+class AssetPackWriter
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    AssetPackWriter();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~AssetPackWriter();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ファイルを登録します.
+    //!
+    //! @param[in]      name        パック内のパスです.
+    //! @param[in]      srcPath     読み込むファイルパスです.
+    //! @retval true    登録に成功.
+    //! @retval false   登録に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool AddFile( const char* name, const char* srcPath );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      メモリ上のデータを登録します. データは内部にコピーします.
+    //!
+    //! @param[in]      name        パック内のパスです.
+    //! @param[in]      pData       データです.
+    //! @param[in]      size        データサイズです.
+    //! @retval true    登録に成功.
+    //! @retval false   登録に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool AddMemory( const char* name, const void* pData, size_t size );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      パックファイルを書き出します.
+    //!
+    //! @param[in]      path        出力ファイルパスです.
+    //! @retval true    書き出しに成功.
+    //! @retval false   書き出しに失敗.
+    //! @note       パス名が重複している場合は失敗します.
+    //---------------------------------------------------------------------------------------------
+    bool Write( const char* path );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      圧縮を設定します.
+    //!
+    //! @param[in]      enable      圧縮するかどうか.
+    //! @param[in]      blockSize   圧縮ブロックのサイズです. 64KB から 256KB の範囲に丸めます.
+    //! @note       圧縮率が十分でないエントリは無圧縮で格納します.
+    //---------------------------------------------------------------------------------------------
+    void SetCompression( bool enable, uint32_t blockSize = ASSET_PACK_DEFAULT_BLOCK_SIZE );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      登録済みのエントリ数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t GetEntryCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      登録を全て破棄します.
+    //---------------------------------------------------------------------------------------------
+    void Clear();
+
+private:
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Source structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Source
+    {
+        std::string             Name;       //!< 正規化したパスです.
+        uint64_t                Hash;       //!< パスのハッシュ値です.
+        std::string             Path;       //!< 読み込むファイルパスです. 空の場合は Data を使用します.
+        std::vector<uint8_t>    Data;       //!< メモリ上のデータです.
+    };
+
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    std::vector<Source>     m_Sources;      //!< 登録されたデータです.
+    bool                    m_Compress;     //!< 圧縮するかどうか.
+    uint32_t                m_BlockSize;    //!< 圧縮ブロックのサイズです.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    AssetPackWriter             ( const AssetPackWriter& ) = delete;
+    AssetPackWriter& operator = ( const AssetPackWriter& ) = delete;
+
+    bool LoadSource     ( const Source& source, std::vector<uint8_t>& data ) const;
+    bool CompressBlocks ( const std::vector<uint8_t>& data, std::vector<uint8_t>& result ) const;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      パック内のパスに正規化します.
+//!
+//! @param[in]      path        パスです.
+//! @return     区切り文字を '/' に, 英字を小文字に揃え, 先頭の "./" と "/" を除いたパスを返却します.
+//-------------------------------------------------------------------------------------------------
+std::string NormalizeAssetPath( const char* path );
+
+} // namespace asdx
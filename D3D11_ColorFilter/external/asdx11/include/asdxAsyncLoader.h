@@ -0,0 +1,262 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxAsyncLoader.h
+// Desc : Asynchronous Resource Loader.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <asdxRef.h>
+#include <asdxJobSystem.h>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LOAD_STATE enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum LOAD_STATE
+{
+    LOAD_STATE_LOADING = 0,     //!< 読み込み中です.
+    LOAD_STATE_READY,           //!< 使用可能です.
+    LOAD_STATE_FAILED,          //!< 読み込みに失敗しました.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AsyncResource class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  非同期に読み込むリソースのハンドルです.
+//! @note   OnDecode() はワーカースレッドで, OnCreate() と OnDiscard() はメインスレッドで呼び出されます.
+//!         状態はメインスレッドでのみ変化するため, フレーム中に状態が変わることはありません.
+class AsyncResource : public IReference
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    friend class AsyncLoader;
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      参照カウントを増やします.
+    //---------------------------------------------------------------------------------------------
+    void AddRef() override;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      参照カウントを減らし, 0 になった場合は破棄します.
+    //---------------------------------------------------------------------------------------------
+    void Release() override;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      参照カウントを取得します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t GetCount() const override;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      読み込み状態を取得します.
+    //---------------------------------------------------------------------------------------------
+    LOAD_STATE GetState() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      読み込み中かどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool IsLoading() const
+    { return GetState() == LOAD_STATE_LOADING; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      使用可能かどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool IsReady() const
+    { return GetState() == LOAD_STATE_READY; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      読み込みに失敗したかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool IsFailed() const
+    { return GetState() == LOAD_STATE_FAILED; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ファイルパスを取得します.
+    //---------------------------------------------------------------------------------------------
+    const std::string& GetPath() const;
+
+protected:
+    //=============================================================================================
+    // protected variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // protected methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //!
+    //! @param[in]      path        ファイルパスです.
+    //---------------------------------------------------------------------------------------------
+    explicit AsyncResource( const char* path );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    virtual ~AsyncResource();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ファイルを読み込んでデコードします. ワーカースレッドで呼び出されます.
+    //!
+    //! @retval true    デコードに成功.
+    //! @retval false   デコードに失敗.
+    //! @note       例外を送出した場合はデコードに失敗したものとして扱います.
+    //---------------------------------------------------------------------------------------------
+    virtual bool OnDecode() = 0;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デコード結果から GPU リソースを生成します. メインスレッドで呼び出されます.
+    //!
+    //! @retval true    生成に成功.
+    //! @retval false   生成に失敗.
+    //---------------------------------------------------------------------------------------------
+    virtual bool OnCreate() = 0;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デコード結果を破棄します. 成否に関わらず OnCreate() の後に呼び出されます.
+    //---------------------------------------------------------------------------------------------
+    virtual void OnDiscard()
+    { /* DO_NOTHING */ }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    std::atomic<uint32_t>   m_RefCount;     //!< 参照カウントです.
+    std::atomic<uint32_t>   m_State;        //!< 読み込み状態です.
+    std::string             m_Path;         //!< ファイルパスです.
+    bool                    m_Decoded;      //!< デコードに成功したかどうか.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    AsyncResource             ( const AsyncResource& ) = delete;
+    AsyncResource& operator = ( const AsyncResource& ) = delete;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AsyncLoader class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  リソースをジョブシステム上でデコードし, GPU リソースの生成をメインスレッドで行います.
+//! @note   デコードが完了したリソースはキューに積まれ, Update() で予算時間内だけ OnCreate() を呼び出します.
+//!         Application::MainLoop() が毎フレーム Update() を呼び出します.
+class AsyncLoader
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    static const double kDefaultFrameBudget;    //!< 1フレームあたりの生成処理の予算時間 [msec] の既定値です.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      シングルトンインスタンスを取得します.
+    //---------------------------------------------------------------------------------------------
+    static AsyncLoader& GetInstance();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      読み込みを要求します. 完了するまでローダーが参照を保持します.
+    //!
+    //! @param[in]      pResource       読み込むリソースです.
+    //! @retval true    要求に成功.
+    //! @retval false   要求に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool Request( AsyncResource* pResource );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デコードが完了したリソースの GPU リソースを, 設定された予算時間内で生成します.
+    //!
+    //! @return     処理したリソース数を返却します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t Update();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デコードが完了したリソースの GPU リソースを, 指定した予算時間内で生成します.
+    //!
+    //! @param[in]      budgetMsec      予算時間 [msec] です. 0 以下の場合は全て処理します.
+    //! @return     処理したリソース数を返却します.
+    //! @note       予算時間に関わらず, 最低1つは処理します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t Flush( double budgetMsec );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全ての読み込みが完了するまで待機します. メインスレッドから呼び出します.
+    //---------------------------------------------------------------------------------------------
+    void WaitAll();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      終了処理を行います. デコードの完了を待ち, 生成していないリソースは失敗として破棄します.
+    //---------------------------------------------------------------------------------------------
+    void Term();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      完了していない読み込みの数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t GetPendingCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      1フレームあたりの予算時間を設定します.
+    //!
+    //! @param[in]      budgetMsec      予算時間 [msec] です.
+    //---------------------------------------------------------------------------------------------
+    void SetFrameBudget( double budgetMsec );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      1フレームあたりの予算時間を取得します.
+    //---------------------------------------------------------------------------------------------
+    double GetFrameBudget() const;
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    JobCounter                      m_Counter;          //!< デコードジョブのカウンターです.
+    std::mutex                      m_Lock;             //!< 完了キューのロックです.
+    std::deque<AsyncResource*>      m_Completed;        //!< デコードが完了したリソースです.
+    std::atomic<uint32_t>           m_PendingCount;     //!< 完了していない読み込みの数です.
+    double                          m_FrameBudget;      //!< 1フレームあたりの予算時間 [msec] です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    AsyncLoader ();
+    ~AsyncLoader();
+    AsyncLoader             ( const AsyncLoader& ) = delete;
+    AsyncLoader& operator = ( const AsyncLoader& ) = delete;
+
+    AsyncResource* PopCompleted();
+};
+
+} // namespace asdx
@@ -0,0 +1,118 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxAsyncTexture.h
+// Desc : Asynchronous Texture Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxAsyncLoader.h>
+#include <asdxTexture.h>
+#include <asdxAssetPack.h>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AsyncTexture2D class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  非同期に読み込む2次元テクスチャです.
+//! @note   読み込みが完了するまでは CreateDummyResTexture() で生成したダミーテクスチャを返却します.
+//!         DDS, TGA, WIC で読み込み可能な形式に対応します.
+//!         DerivedDataCache を初期化している場合, DDS 以外はデコード結果をキャッシュし, 次回からデコードを省略します.
+class AsyncTexture2D : public AsyncResource
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      読み込みを開始します.
+    //!
+    //! @param[in]      pDevice         デバイスです.
+    //! @param[in]      pDeviceContext  デバイスコンテキストです.
+    //! @param[in]      path            ファイルパスです.
+    //! @param[out]     result          テクスチャのハンドルです.
+    //! @retval true    要求に成功.
+    //! @retval false   要求に失敗.
+    //---------------------------------------------------------------------------------------------
+    static bool Load(
+        ID3D11Device*               pDevice,
+        ID3D11DeviceContext*        pDeviceContext,
+        const char*                 path,
+        RefPtr<AsyncTexture2D>&     result );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      パックファイルから読み込みを開始します.
+    //!
+    //! @param[in]      pDevice         デバイスです.
+    //! @param[in]      pDeviceContext  デバイスコンテキストです.
+    //! @param[in]      pPack           パックファイルです. 読み込みが完了するまで開いておく必要があります.
+    //! @param[in]      path            パック内のパスです.
+    //! @param[out]     result          テクスチャのハンドルです.
+    //! @retval true    要求に成功.
+    //! @retval false   要求に失敗.
+    //! @note       メモリ上からデコードするため, TGA 形式には対応しません.
+    //---------------------------------------------------------------------------------------------
+    static bool Load(
+        ID3D11Device*               pDevice,
+        ID3D11DeviceContext*        pDeviceContext,
+        const AssetPack*            pPack,
+        const char*                 path,
+        RefPtr<AsyncTexture2D>&     result );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      テクスチャを取得します. 使用可能でない場合はダミーテクスチャを返却します.
+    //---------------------------------------------------------------------------------------------
+    const Texture2D& GetTexture() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      シェーダリソースビューを取得します. 使用可能でない場合はダミーテクスチャのものを返却します.
+    //---------------------------------------------------------------------------------------------
+    ID3D11ShaderResourceView* const GetSRV() const;
+
+protected:
+    //=============================================================================================
+    // protected variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // protected methods.
+    //=============================================================================================
+    bool OnDecode () override;
+    bool OnCreate () override;
+    void OnDiscard() override;
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    RefPtr<ID3D11Device>            m_pDevice;          //!< デバイスです.
+    RefPtr<ID3D11DeviceContext>     m_pDeviceContext;   //!< デバイスコンテキストです.
+    const AssetPack*                m_pPack;            //!< 読み込み元のパックファイルです. nullptr の場合はファイルから読み込みます.
+    ResTexture                      m_Resource;         //!< デコード結果です.
+    Texture2D                       m_Texture;          //!< テクスチャです.
+    Texture2D                       m_Dummy;            //!< 読み込み中および失敗時に使用するダミーテクスチャです.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    AsyncTexture2D ( ID3D11Device* pDevice, ID3D11DeviceContext* pDeviceContext, const AssetPack* pPack, const char* path );
+    ~AsyncTexture2D();
+};
+
+} // namespace asdx
@@ -0,0 +1,368 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxDerivedDataCache.h
+// Desc : Local Derived Data Cache.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <asdxHash.h>
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+// Forward Declarations.
+//-------------------------------------------------------------------------------------------------
+struct ResTexture;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DerivedDataKey structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  派生データを識別する 128bit のキーです.
+struct DerivedDataKey
+{
+    uint64_t    Hi;     //!< 上位 64bit です.
+    uint64_t    Lo;     //!< 下位 64bit です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    DerivedDataKey()
+    : Hi( 0 )
+    , Lo( 0 )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      32文字の16進数文字列に変換します.
+    //---------------------------------------------------------------------------------------------
+    std::string ToString() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      16進数文字列から変換します.
+    //!
+    //! @param[in]      text        32文字の16進数文字列です.
+    //! @param[out]     result      変換結果です.
+    //! @retval true    変換に成功.
+    //! @retval false   変換に失敗.
+    //---------------------------------------------------------------------------------------------
+    static bool FromString( const char* text, DerivedDataKey& result );
+
+    bool operator == ( const DerivedDataKey& value ) const
+    { return Hi == value.Hi && Lo == value.Lo; }
+
+    bool operator != ( const DerivedDataKey& value ) const
+    { return !( *this == value ); }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DerivedDataKeyBuilder class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  変換器の名前とバージョン, 変換パラメータ, 入力データの内容からキーを生成します.
+//! @note   追加した値はそれぞれ長さ付きで連結するため, 区切り位置が異なる入力が同じキーになることはありません.
+//!         変換結果が変わる修正を行った場合は, 変換器のバージョンを上げて古いキャッシュを参照しないようにしてください.
+class DerivedDataKeyBuilder
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //!
+    //! @param[in]      converter   変換器の名前です.
+    //! @param[in]      version     変換器のバージョンです.
+    //---------------------------------------------------------------------------------------------
+    DerivedDataKeyBuilder( const char* converter, uint32_t version );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      データを追加します.
+    //!
+    //! @param[in]      pData       データです.
+    //! @param[in]      size        データサイズです.
+    //! @return     自身への参照を返却します.
+    //---------------------------------------------------------------------------------------------
+    DerivedDataKeyBuilder& Add( const void* pData, size_t size );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      文字列を追加します.
+    //!
+    //! @param[in]      text        null 終端文字列です. nullptr は空文字列として扱います.
+    //! @return     自身への参照を返却します.
+    //---------------------------------------------------------------------------------------------
+    DerivedDataKeyBuilder& Add( const char* text );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      値を追加します. パディングを含まない型を指定してください.
+    //!
+    //! @param[in]      value       追加する値です.
+    //! @return     自身への参照を返却します.
+    //---------------------------------------------------------------------------------------------
+    template<typename T>
+    DerivedDataKeyBuilder& AddValue( const T& value )
+    { return Add( &value, sizeof(T) ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ファイルの内容を追加します.
+    //!
+    //! @param[in]      path        ファイルパスです.
+    //! @retval true    追加に成功.
+    //! @retval false   ファイルを読み込めなかった.
+    //---------------------------------------------------------------------------------------------
+    bool AddFile( const char* path );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      キーを取得します.
+    //---------------------------------------------------------------------------------------------
+    DerivedDataKey GetKey() const;
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    XxHash64    m_Hash[2];      //!< シードの異なる2つのハッシュです.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    void Update( const void* pData, size_t size );
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DerivedDataCacheDesc structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct DerivedDataCacheDesc
+{
+    std::string     Dir;            //!< キャッシュを格納するディレクトリです. 存在しない場合は作成します.
+    uint64_t        MaxSize;        //!< キャッシュの合計サイズの上限です.
+    uint32_t        TrimPercent;    //!< 上限を超えた場合に, 上限の何 % まで削除するかです.
+
+    DerivedDataCacheDesc()
+    : Dir           ( "ddc" )
+    , MaxSize       ( 1024ull * 1024 * 1024 )
+    , TrimPercent   ( 90 )
+    { /* DO_NOTHING */ }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DerivedDataCacheStats structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct DerivedDataCacheStats
+{
+    uint64_t    HitCount;       //!< Get() に成功した回数です.
+    uint64_t    MissCount;      //!< Get() に失敗した回数です.
+    uint64_t    WriteCount;     //!< Put() に成功した回数です.
+    uint64_t    EvictCount;     //!< 容量超過で削除したエントリ数です.
+    uint64_t    CorruptCount;   //!< 破損していたため削除したエントリ数です.
+    uint64_t    ReadBytes;      //!< ヒットしたデータの合計サイズです.
+    uint64_t    WriteBytes;     //!< 書き込んだデータの合計サイズです.
+    uint64_t    EntryCount;     //!< 現在のエントリ数です.
+    uint64_t    TotalSize;      //!< 現在のファイルの合計サイズです.
+
+    DerivedDataCacheStats()
+    : HitCount      ( 0 )
+    , MissCount     ( 0 )
+    , WriteCount    ( 0 )
+    , EvictCount    ( 0 )
+    , CorruptCount  ( 0 )
+    , ReadBytes     ( 0 )
+    , WriteBytes    ( 0 )
+    , EntryCount    ( 0 )
+    , TotalSize     ( 0 )
+    { /* DO_NOTHING */ }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DerivedDataCache class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  変換済みのデータをキーごとに1ファイルとしてローカルディスクに保存します.
+//! @note   書き込みは一時ファイルに書き出してから名前を変更するため, 読み込み側が書き込み途中のファイルを見ることはありません.
+//!         電源断などで内容が欠けたファイルは, 読み込み時の CRC 検証で破損として削除します.
+//!         最後に参照した時刻をファイルの更新日時に記録し, 次回の Init() でも LRU の順序を引き継ぎます.
+//!         全てのメソッドはスレッドセーフです.
+class DerivedDataCache
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      シングルトンインスタンスを取得します.
+    //---------------------------------------------------------------------------------------------
+    static DerivedDataCache& GetInstance();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化処理を行います. 既存のキャッシュファイルを走査して索引を作成します.
+    //!
+    //! @param[in]      desc        構成設定です.
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool Init( const DerivedDataCacheDesc& desc = DerivedDataCacheDesc() );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      終了処理を行います. キャッシュファイルは削除しません.
+    //---------------------------------------------------------------------------------------------
+    void Term();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化済みかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool IsInit() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      データを取得します.
+    //!
+    //! @param[in]      key         キーです.
+    //! @param[out]     result      データの格納先です.
+    //! @retval true    ヒットした.
+    //! @retval false   存在しない, または破損していた.
+    //---------------------------------------------------------------------------------------------
+    bool Get( const DerivedDataKey& key, std::vector<uint8_t>& result );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      データを格納します. 同じキーのデータが存在する場合は置き換えます.
+    //!
+    //! @param[in]      key         キーです.
+    //! @param[in]      pData       データです.
+    //! @param[in]      size        データサイズです.
+    //! @retval true    格納に成功.
+    //! @retval false   格納に失敗.
+    //! @note       合計サイズが上限を超えた場合は, 最も長く参照されていないデータから削除します.
+    //---------------------------------------------------------------------------------------------
+    bool Put( const DerivedDataKey& key, const void* pData, size_t size );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      データを削除します.
+    //!
+    //! @param[in]      key         キーです.
+    //---------------------------------------------------------------------------------------------
+    void Remove( const DerivedDataKey& key );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全てのデータを削除します.
+    //---------------------------------------------------------------------------------------------
+    void Clear();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      統計情報を取得します.
+    //---------------------------------------------------------------------------------------------
+    DerivedDataCacheStats GetStats() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      統計情報のカウンタをリセットします. エントリ数と合計サイズはリセットしません.
+    //---------------------------------------------------------------------------------------------
+    void ResetStats();
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Entry structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Entry
+    {
+        DerivedDataKey  Key;        //!< キーです.
+        uint64_t        Size;       //!< ファイルサイズです.
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // KeyHasher structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct KeyHasher
+    {
+        size_t operator() ( const DerivedDataKey& key ) const
+        { return static_cast<size_t>( key.Lo ); }
+    };
+
+    typedef std::list<Entry>                                                    EntryList;
+    typedef std::unordered_map<DerivedDataKey, EntryList::iterator, KeyHasher>  EntryMap;
+
+    mutable std::mutex      m_Mutex;        //!< 索引と統計情報を保護するミューテックスです.
+    bool                    m_Init;         //!< 初期化済みフラグです.
+    DerivedDataCacheDesc    m_Desc;         //!< 構成設定です.
+    EntryList               m_List;         //!< 参照順のエントリです. 先頭が最後に参照したものです.
+    EntryMap                m_Map;          //!< キーからエントリへの索引です.
+    DerivedDataCacheStats   m_Stats;        //!< 統計情報です.
+    std::atomic<uint32_t>   m_TempCounter;  //!< 一時ファイル名の生成に使用するカウンタです.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    DerivedDataCache();
+    ~DerivedDataCache();
+
+    DerivedDataCache             ( const DerivedDataCache& ) = delete;
+    DerivedDataCache& operator = ( const DerivedDataCache& ) = delete;
+
+    std::string GetFilePath ( const DerivedDataKey& key ) const;
+    bool        Scan        ();
+    void        Touch       ( const DerivedDataKey& key, uint64_t size );
+    void        Erase       ( const DerivedDataKey& key, bool deleteFile );
+    void        Trim        ();
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      テクスチャリソースを, GPU へそのまま転送できる配置のバイナリに変換します.
+//!
+//! @param[in]      texture     変換するテクスチャリソースです.
+//! @param[out]     result      変換結果です.
+//! @retval true    変換に成功.
+//! @retval false   変換に失敗.
+//! @note       サブリソースは D3D11_SUBRESOURCE_DATA と同じ順序 (配列要素ごとにミップレベル順) で,
+//!             行ピッチを保ったまま 16 byte 境界に配置します.
+//-------------------------------------------------------------------------------------------------
+bool EncodeResTexture( const ResTexture& texture, std::vector<uint8_t>& result );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      EncodeResTexture() で変換したバイナリからテクスチャリソースを生成します.
+//!
+//! @param[in]      pData       バイナリデータです.
+//! @param[in]      size        バイナリデータのサイズです.
+//! @param[out]     result      生成したテクスチャリソースです. 不要になったら Release() を呼び出してください.
+//! @retval true    生成に成功.
+//! @retval false   データが不正.
+//-------------------------------------------------------------------------------------------------
+bool DecodeResTexture( const uint8_t* pData, size_t size, ResTexture& result );
+
+} // namespace asdx
@@ -8,12 +8,43 @@
 //-----------------------------------------------------------------------------
 // Includes
 //-----------------------------------------------------------------------------
+#include <cstdint>
 #include <atomic>
 #include <thread>
 
 
 namespace asdx {
 
+//-----------------------------------------------------------------------------
+// Forward Declarations.
+//-----------------------------------------------------------------------------
+class FileUpdateQueue;
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FILE_UPDATE_ACTION enum
+///////////////////////////////////////////////////////////////////////////////
+//! @brief  XV̎ނł. l Windows  FILE_ACTION_XXX Ɠł.
+enum FILE_UPDATE_ACTION
+{
+    FILE_UPDATE_ADDED = 1,              //!< ǉ܂.
+    FILE_UPDATE_REMOVED,                //!< 폜܂.
+    FILE_UPDATE_MODIFIED,               //!< e܂͑ύX܂.
+    FILE_UPDATE_RENAMED_OLD_NAME,       //!< OύXÕpXł.
+    FILE_UPDATE_RENAMED_NEW_NAME,       //!< OύX̃pXł.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FileUpdateEvent structure
+///////////////////////////////////////////////////////////////////////////////
+struct FileUpdateEvent
+{
+    uint32_t        ActionType;         //!< XV̎ނł (FILE_UPDATE_ACTION).
+    const char*     RelativePath;       //!< ĎΏۃfBNg̑΃pXł.
+};
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // IFileUpdateListener interface
 ///////////////////////////////////////////////////////////////////////////////
@@ -32,12 +63,40 @@ struct IFileUpdateListener
         uint32_t    actionType,
         const char* directoryPath,
         const char* relativePath) = 0;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ܂Ƃ߂t@CXV܂Ƃ߂ď܂.
+    //!
+    //! @param[in]      directoryPath   ĎΏۃfBNgł.
+    //! @param[in]      pEvents         XVCxgł. ĂяôݗLł.
+    //! @param[in]      count           XVCxgł.
+    //! @note       ̎ł, CxgƂ OnUpdate() Ăяo܂.
+    //-------------------------------------------------------------------------
+    virtual void OnUpdateBatch(
+        const char*             directoryPath,
+        const FileUpdateEvent*  pEvents,
+        uint32_t                count)
+    {
+        for(uint32_t i=0; i<count; ++i)
+        { OnUpdate(pEvents[i].ActionType, directoryPath, pEvents[i].RelativePath); }
+    }
 };
 
 
 ///////////////////////////////////////////////////////////////////////////////
 // FileWatcher class
 ///////////////////////////////////////////////////////////////////////////////
+//! @brief  fBNgȉċAIɊĎ܂.
+//! @note   Windows ł ReadDirectoryChangesW() , Linux ł inotify gp܂.
+//!         pXւ̒ʒm DebounceMsec ̊Ԃ܂Ƃ, Ō̒ʒm DebounceMsec o߂̂
+//!         1 OnUpdateBatch() Œʒm܂. ܂Ƃ߂ۂɎ̂悤ɏW񂵂܂.
+//!           ǉ  폜 : ʒm܂ (ꎞt@CȂ).
+//!           폜  ǉ : ύXƂĒʒm܂ (uۑȂ).
+//!           ǉ  ύX : ǉƂĒʒm܂.
+//!           OύXO / OύX : 폜 / ǉƂĈ܂.
+//!         Linux ł̓t@Cւ̖OύXŒu悪݂Ȃ, 폜  ǉ ƂĈ,
+//!         Windows ƓuۑύXƂĒʒm܂. VOւ̈ړύXƂĒʒm܂.
+//!         ManualDispatch  false ̏ꍇ͊ĎXbh, true ̏ꍇ Dispatch() ĂяoXbhʒm܂.
 class FileWatcher
 {
     //=========================================================================
@@ -55,6 +114,8 @@ public:
         size_t                  BufferSize;         //!< obt@TCY.
         uint32_t                WaitTimeMsec;       //!< 1[v̑ҋ@(~bP)
         IFileUpdateListener*    pListener;          //!< ύXʒm.
+        uint32_t                DebounceMsec   = 0;     //!< pXւ̒ʒm܂Ƃ߂鎞(~bP).
+        bool                    ManualDispatch = false; //!< true ̏ꍇ Dispatch() ĂяoXbhŒʒm܂.
     };
 
     //=========================================================================
@@ -90,12 +151,22 @@ public:
     //-------------------------------------------------------------------------
     void Term();
 
+    //-------------------------------------------------------------------------
+    //! @brief      ܂Ƃ߂XVʒm܂.
+    //!
+    //! @note       ManualDispatch  true ̏ꍇ̂ݗLł.
+    //!             AvP[V̔Cӂ̃Xbh1t[1ĂяoĂ.
+    //-------------------------------------------------------------------------
+    void Dispatch();
+
 private:
     //=========================================================================
     // private variables.
     //=========================================================================
     std::atomic<bool> m_Finish  = {};       //!< ItO.
     std::thread*      m_pThread = nullptr;  //!< ĎXbh.
+    FileUpdateQueue*  m_pQueue  = nullptr;  //!< ʒm܂Ƃ߂L[.
+    bool              m_Manual  = false;    //!< Dispatch() Œʒm邩ǂ.
 
     //=========================================================================
     // private methods.
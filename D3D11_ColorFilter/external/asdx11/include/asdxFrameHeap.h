@@ -1,4 +1,4 @@
-//-----------------------------------------------------------------------------
+﻿//-----------------------------------------------------------------------------
 // File : FrameHeap.h
 // Desc : Frame Heap
 // Copyright(c) Project Asura. All right reserved.
@@ -9,6 +9,9 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <mutex>
 
 
 namespace asdx {
@@ -16,6 +19,8 @@ namespace asdx {
 ///////////////////////////////////////////////////////////////////////////////
 // FrameHeap class
 ///////////////////////////////////////////////////////////////////////////////
+//! @note   Alloc() は複数スレッドから同時に呼び出せます.
+//!         Init(), Term(), Reset(), NextFrame() は Alloc() と同時に呼び出さないでください.
 class FrameHeap
 {
     //=========================================================================
@@ -27,76 +32,244 @@ public:
     //=========================================================================
     // public variables.
     //=========================================================================
-    /* NOTHING */
+    static const size_t kDefaultAlignment = 16;     //!< デフォルトのアライメントです.
 
     //=========================================================================
     // public methods.
     //=========================================================================
 
     //-------------------------------------------------------------------------
-    //! @brief      RXgN^ł.
+    //! @brief      コンストラクタです.
     //-------------------------------------------------------------------------
     FrameHeap();
 
     //-------------------------------------------------------------------------
-    //! @brief      fXgN^ł.
+    //! @brief      デストラクタです.
     //-------------------------------------------------------------------------
     ~FrameHeap();
 
     //-------------------------------------------------------------------------
-    //! @brief      s܂.
+    //! @brief      初期化処理を行います.
     //!
-    //! @param[in]      size        mۃTCY.
-    //! @retval true    ɐ.
-    //! @retval false   Ɏs.
+    //! @param[in]      size        1フレームあたりのメモリ確保サイズ.
+    //! @param[in]      frameCount  リングバッファのフレーム数.
+    //!                             フレーム N のメモリはフレーム N + frameCount で再利用されます.
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
     //-------------------------------------------------------------------------
-    bool Init(size_t size);
+    bool Init(size_t size, uint32_t frameCount = 1);
 
     //-------------------------------------------------------------------------
-    //! @brief      Is܂.
+    //! @brief      終了処理を行います.
     //-------------------------------------------------------------------------
     void Term();
 
     //-------------------------------------------------------------------------
-    //! @brief      obt@擪ɃItZbgZbg܂.
+    //! @brief      現在のフレームのバッファ先頭にオフセットをリセットします.
     //-------------------------------------------------------------------------
     void Reset();
 
     //-------------------------------------------------------------------------
-    //! @brief      mۂ܂.
+    //! @brief      次のフレームに進みます.
+    //!
+    //! @note       frameCount フレーム前に使用したバッファを再利用するため,
+    //!             そのメモリを参照する処理 (GPU など) が完了してから呼び出してください.
+    //-------------------------------------------------------------------------
+    void NextFrame();
+
+    //-------------------------------------------------------------------------
+    //! @brief      メモリを確保します.
+    //!
+    //! @param[in]      size        確保するメモリサイズ.
+    //! @param[in]      alignment   アライメント (2の累乗).
+    //! @return     確保したメモリへのポインタを返却します.
+    //!             バッファが不足した場合はオーバーフローブロックから確保し,
+    //!             それにも失敗した場合は nullptr が返却されます.
+    //-------------------------------------------------------------------------
+    void* Alloc(size_t size, size_t alignment = kDefaultAlignment);
+
+    //-------------------------------------------------------------------------
+    //! @brief      配列を確保します. コンストラクタは呼び出されません.
     //!
-    //! @param[in]      size        mۂ郁TCY.
-    //! @return     mۂւ̃|C^ԋp܂.
-    //!             mۂɎsꍇ nullptr ԋp܂.
+    //! @param[in]      count       要素数.
+    //! @return     確保したメモリへのポインタを返却します.
     //-------------------------------------------------------------------------
-    void* Alloc(size_t size);
+    template<typename T>
+    T* AllocArray(size_t count)
+    { return static_cast<T*>(Alloc(sizeof(T) * count, alignof(T))); }
 
     //-------------------------------------------------------------------------
-    //! @brief      TCY擾܂.
+    //! @brief      文字列を複製します.
     //!
-    //! @return     TCYԋp܂.
+    //! @param[in]      value       複製するヌル終端文字列.
+    //! @return     フレーム内で有効な複製を返却します.
+    //-------------------------------------------------------------------------
+    const char* CopyString(const char* value);
+
+    //-------------------------------------------------------------------------
+    //! @brief      1フレームあたりのメモリサイズを取得します.
+    //!
+    //! @return     メモリサイズを返却します.
     //-------------------------------------------------------------------------
     size_t GetSize() const;
 
     //-------------------------------------------------------------------------
-    //! @brief      p\ȃTCY擾܂.
+    //! @brief      現在のフレームで利用可能なメモリサイズを取得します.
     //!
-    //! @return     p\ȃTCYԋp܂.
+    //! @return     利用可能なメモリサイズを返却します (オーバーフローブロックは含みません).
     //-------------------------------------------------------------------------
     size_t GetRestSize() const;
 
+    //-------------------------------------------------------------------------
+    //! @brief      フレーム数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetFrameCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      Reset() または NextFrame() でフレームが切り替わった回数を取得します.
+    //-------------------------------------------------------------------------
+    uint64_t GetFrameNumber() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      1フレームで使用したメモリサイズの最大値を取得します.
+    //!
+    //! @return     オーバーフローブロックを含めた最大使用量を返却します.
+    //-------------------------------------------------------------------------
+    size_t GetHighWaterMark() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      オーバーフローブロックを確保した回数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetOverflowCount() const;
+
 private:
+    ///////////////////////////////////////////////////////////////////////////
+    // OverflowBlock structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct OverflowBlock
+    {
+        OverflowBlock*  pNext;      //!< 次のブロックです.
+        uint8_t*        pBuffer;    //!< バッファメモリです.
+        size_t          Size;       //!< バッファサイズです.
+        size_t          Offset;     //!< バッファ先頭からのオフセットです.
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Frame structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Frame
+    {
+        uint8_t*            pBuffer;        //!< バッファメモリです.
+        std::atomic<size_t> Offset;         //!< バッファ先頭からのオフセットです.
+        OverflowBlock*      pOverflow;      //!< オーバーフローブロックです (先頭が最新).
+        size_t              OverflowUsed;   //!< オーバーフローブロックの使用量です.
+    };
+
     //=========================================================================
     // private variables.
     //=========================================================================
-    size_t      m_Size;         //!< obt@TCYł.
-    uint8_t*    m_pBuffer;      //!< obt@ł.
-    size_t      m_Offset;       //!< obt@擪̃ItZbgł.
+    size_t                  m_Size;             //!< 1フレームあたりのバッファサイズです.
+    Frame*                  m_pFrames;          //!< フレームごとのバッファです.
+    uint32_t                m_FrameCount;       //!< フレーム数です.
+    uint32_t                m_FrameIndex;       //!< 現在のフレーム番号です.
+    uint64_t                m_FrameNumber;      //!< フレームが切り替わった回数です.
+    size_t                  m_HighWaterMark;    //!< 終了したフレームの最大使用量です.
+    std::atomic<uint32_t>   m_OverflowCount;    //!< オーバーフローブロックの確保回数です.
+    std::mutex              m_OverflowLock;     //!< オーバーフローブロックを保護するロックです.
 
     //=========================================================================
     // private methods.
     //=========================================================================
+    FrameHeap             (const FrameHeap&) = delete;
+    FrameHeap& operator = (const FrameHeap&) = delete;
+
+    void*  AllocOverflow (Frame& frame, size_t size, size_t alignment);
+    void   ResetFrame    (Frame& frame);
+    size_t GetUsedSize   (const Frame& frame) const;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FrameArena class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief  FrameHeap からチャンク単位でメモリを受け取り, 1スレッド内でアトミック操作なしに確保を行います.
+//! @note   スレッドごとにインスタンスを用意してください. フレームが進むと保持しているチャンクは自動的に破棄されます.
+class FrameArena
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
     /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    FrameArena();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~FrameArena();
+
+    //-------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      pHeap       チャンクを確保するフレームヒープ.
+    //! @param[in]      chunkSize   1回に受け取るチャンクサイズ.
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //-------------------------------------------------------------------------
+    bool Init(FrameHeap* pHeap, size_t chunkSize = 64 * 1024);
+
+    //-------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //-------------------------------------------------------------------------
+    void Term();
+
+    //-------------------------------------------------------------------------
+    //! @brief      メモリを確保します.
+    //!
+    //! @param[in]      size        確保するメモリサイズ.
+    //! @param[in]      alignment   アライメント (2の累乗).
+    //! @return     確保したメモリへのポインタを返却します.
+    //-------------------------------------------------------------------------
+    void* Alloc(size_t size, size_t alignment = FrameHeap::kDefaultAlignment);
+
+    //-------------------------------------------------------------------------
+    //! @brief      配列を確保します. コンストラクタは呼び出されません.
+    //!
+    //! @param[in]      count       要素数.
+    //! @return     確保したメモリへのポインタを返却します.
+    //-------------------------------------------------------------------------
+    template<typename T>
+    T* AllocArray(size_t count)
+    { return static_cast<T*>(Alloc(sizeof(T) * count, alignof(T))); }
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    FrameHeap*  m_pHeap;            //!< フレームヒープです.
+    size_t      m_ChunkSize;        //!< チャンクサイズです.
+    uint8_t*    m_pCursor;          //!< チャンクの書き込み位置です.
+    uint8_t*    m_pEnd;             //!< チャンクの終端です.
+    uint64_t    m_FrameNumber;      //!< チャンクを受け取ったフレームです.
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    FrameArena             (const FrameArena&) = delete;
+    FrameArena& operator = (const FrameArena&) = delete;
 };
 
-} // namespace asdx
\ No newline at end of file
+} // namespace asdx
@@ -8,6 +8,7 @@
 //-------------------------------------------------------------------------------------------------
 // Includes
 //-------------------------------------------------------------------------------------------------
+#include <cstddef>
 #include <cstdint>
 
 
@@ -74,6 +75,16 @@ public:
     //---------------------------------------------------------------------------------------------
     Crc32( const Crc32& value );
 
+    //---------------------------------------------------------------------------------------------
+    //! @brief      データを追加してハッシュキーを更新します.
+    //!
+    //! @param[in]      size        バッファサイズです.
+    //! @param[in]      pBuffer     バッファです.
+    //! @return     自身への参照を返却します.
+    //! @note       分割したデータを順に追加した結果は, 連結したデータのハッシュキーと一致します.
+    //---------------------------------------------------------------------------------------------
+    Crc32& Update( const size_t size, const uint8_t* pBuffer );
+
     //---------------------------------------------------------------------------------------------
     //! @brief      ハッシュキーを取得します.
     //!
@@ -145,6 +156,105 @@ private:
 };
 
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Crc32C class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief      Castagnoli 多項式の CRC32 です.
+//!
+//! @details    SSE4.2 または ARMv8 の CRC32 命令が使える場合は実行時に選択して使用します.
+//!             使えない場合は Crc32 と同じテーブル方式で計算します. Crc32 とは異なる値になります.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class Crc32C
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    Crc32C();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      引数付きコンストラクタです.
+    //!
+    //! @param[in]      size        バッファサイズです.
+    //! @param[in]      pBuffer     バッファです.
+    //---------------------------------------------------------------------------------------------
+    Crc32C( const size_t size, const uint8_t* pBuffer );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      引数付きコンストラクタです.
+    //!
+    //! @param[in]      pBuffer     文字列です.
+    //---------------------------------------------------------------------------------------------
+    explicit Crc32C( const char* pBuffer );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      引数付きコンストラクタです.
+    //!
+    //! @param[in]      value       ハッシュキー.
+    //---------------------------------------------------------------------------------------------
+    explicit Crc32C( const uint32_t value );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      データを追加してハッシュキーを更新します.
+    //!
+    //! @param[in]      size        バッファサイズです.
+    //! @param[in]      pBuffer     バッファです.
+    //! @return     自身への参照を返却します.
+    //---------------------------------------------------------------------------------------------
+    Crc32C& Update( const size_t size, const uint8_t* pBuffer );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ハッシュキーを取得します.
+    //!
+    //! @return     ハッシュキーを返却します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t GetHash() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      等価比較演算子です.
+    //---------------------------------------------------------------------------------------------
+    bool    operator == ( const Crc32C& value ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      非等価比較演算子です.
+    //---------------------------------------------------------------------------------------------
+    bool    operator != ( const Crc32C& value ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      CRC32 命令を使用しているかどうかを取得します.
+    //!
+    //! @retval true    CRC32 命令を使用しています.
+    //! @retval false   テーブル方式で計算しています.
+    //---------------------------------------------------------------------------------------------
+    static bool IsHardwareEnabled();
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    uint32_t     m_Hash;     //!< ハッシュキーです.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    /* NOTHING */
+};
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Fnv1 class
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -408,4 +518,96 @@ private:
     /* NOTHING */
 };
 
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// XxHash64 class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief      xxHash64 による64bitの非暗号学的ハッシュです.
+//!
+//! @details    大きなデータの重複判定やキャッシュキーに使用します.
+//!             Update() でデータを分割して追加でき, 結果は一括で計算した場合と一致します.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class XxHash64
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //!
+    //! @param[in]      seed        シード値です.
+    //---------------------------------------------------------------------------------------------
+    explicit XxHash64( const uint64_t seed = 0 );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      引数付きコンストラクタです.
+    //!
+    //! @param[in]      size        バッファサイズです.
+    //! @param[in]      pBuffer     バッファです.
+    //! @param[in]      seed        シード値です.
+    //---------------------------------------------------------------------------------------------
+    XxHash64( const size_t size, const uint8_t* pBuffer, const uint64_t seed = 0 );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      状態を初期化します.
+    //!
+    //! @param[in]      seed        シード値です.
+    //---------------------------------------------------------------------------------------------
+    void Reset( const uint64_t seed = 0 );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      データを追加します.
+    //!
+    //! @param[in]      size        バッファサイズです.
+    //! @param[in]      pBuffer     バッファです.
+    //! @return     自身への参照を返却します.
+    //---------------------------------------------------------------------------------------------
+    XxHash64& Update( const size_t size, const uint8_t* pBuffer );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ここまでに追加したデータのハッシュキーを取得します.
+    //!
+    //! @return     ハッシュキーを返却します.
+    //! @note       状態は変更しないため, 続けて Update() を呼び出せます.
+    //---------------------------------------------------------------------------------------------
+    uint64_t GetHash() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ハッシュキーを一括で計算します.
+    //!
+    //! @param[in]      size        バッファサイズです.
+    //! @param[in]      pBuffer     バッファです.
+    //! @param[in]      seed        シード値です.
+    //! @return     ハッシュキーを返却します.
+    //---------------------------------------------------------------------------------------------
+    static uint64_t Compute( const size_t size, const uint8_t* pBuffer, const uint64_t seed = 0 );
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    uint64_t    m_Acc[4];       //!< ストライプごとのアキュムレータです.
+    uint64_t    m_Seed;         //!< シード値です.
+    uint64_t    m_TotalSize;    //!< 追加したデータの総サイズです.
+    uint8_t     m_Buffer[32];   //!< 1ストライプに満たないデータです.
+    uint32_t    m_BufferSize;   //!< m_Buffer の有効サイズです.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    /* NOTHING */
+};
+
 } // namespace asdx
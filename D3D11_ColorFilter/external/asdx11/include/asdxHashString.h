@@ -9,6 +9,8 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include <asdxHash.h>
+#include <asdxHashedName.h>
+#include <asdxStringPool.h>
 #include <string>
 
 
@@ -49,6 +51,20 @@ public:
     //-------------------------------------------------------------------------
     HashString(const char* value);
 
+    //-------------------------------------------------------------------------
+    //! @brief      引数付きコンストラクタです.
+    //!
+    //! @note       ハッシュ値は再計算せずにそのまま使用します.
+    //-------------------------------------------------------------------------
+    HashString(const HashedName& value);
+
+    //-------------------------------------------------------------------------
+    //! @brief      引数付きコンストラクタです.
+    //!
+    //! @param[in]      handle      StringPool に登録済みのハンドルです.
+    //-------------------------------------------------------------------------
+    explicit HashString(StringHandle handle);
+
     //-------------------------------------------------------------------------
     //! @brief      文字列を取得します.
     //-------------------------------------------------------------------------
@@ -57,7 +73,12 @@ public:
     //-------------------------------------------------------------------------
     //! @brief      std::stringを取得します.
     //-------------------------------------------------------------------------
-    const std::string& std_str() const;
+    std::string std_str() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      StringPool のハンドルを取得します.
+    //-------------------------------------------------------------------------
+    StringHandle handle() const;
 
     //-------------------------------------------------------------------------
     //! @brief      ハッシュ値を取得します.
@@ -94,6 +115,16 @@ public:
     //-------------------------------------------------------------------------
     bool operator >  (const HashString& value) const;
 
+    //-------------------------------------------------------------------------
+    //! @brief      ハッシュ名との等価比較演算子です.
+    //-------------------------------------------------------------------------
+    bool operator == (const HashedName& value) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ハッシュ名との非等価比較演算子です.
+    //-------------------------------------------------------------------------
+    bool operator != (const HashedName& value) const;
+
     //-------------------------------------------------------------------------
     //! @brief      代入演算子です.
     //-------------------------------------------------------------------------
@@ -103,8 +134,8 @@ private:
     //=========================================================================
     // private variables.
     //=========================================================================
-    std::string     m_String;
-    uint32_t        m_Hash;
+    StringHandle    m_Handle;   //!< StringPool のハンドルです.
+    uint32_t        m_Hash;     //!< ハッシュ値です.
 
     //=========================================================================
     // private methods.
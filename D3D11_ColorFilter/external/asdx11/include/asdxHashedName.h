@@ -0,0 +1,168 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxHashedName.h
+// Desc : Compile Time Hashed Name.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <cstddef>
+#include <asdxTypedef.h>
+
+
+namespace asdx {
+
+//-----------------------------------------------------------------------------
+//! @brief      FNV-1a ハッシュをコンパイル時に計算します.
+//!
+//! @param[in]      value       文字列です.
+//! @param[in]      count       文字数です.
+//! @return     asdx::Fnv1a(const char*) と同じハッシュ値を返却します.
+//! @note       char の符号拡張も実行時版と一致させています.
+//-----------------------------------------------------------------------------
+constexpr uint32_t ComputeFnv1a(const char* value, size_t count)
+{
+    uint32_t hash = 2166136261u;
+    for(size_t i=0; i<count; ++i)
+    { hash = (hash ^ static_cast<uint32_t>(value[i])) * 16777619u; }
+    return hash;
+}
+
+//-----------------------------------------------------------------------------
+//! @brief      ヌル終端文字列の FNV-1a ハッシュをコンパイル時に計算します.
+//!
+//! @param[in]      value       ヌル終端文字列です.
+//! @return     asdx::Fnv1a(const char*) と同じハッシュ値を返却します.
+//-----------------------------------------------------------------------------
+constexpr uint32_t ComputeFnv1a(const char* value)
+{
+    uint32_t hash = 2166136261u;
+    for(; *value != '\0'; ++value)
+    { hash = (hash ^ static_cast<uint32_t>(*value)) * 16777619u; }
+    return hash;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// HashedName class
+///////////////////////////////////////////////////////////////////////////////
+class HashedName
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    constexpr HashedName()
+    : m_Hash (2166136261u)
+    , m_pName("")
+    { /* DO_NOTHING */ }
+
+    //-------------------------------------------------------------------------
+    //! @brief      引数付きコンストラクタです.
+    //!
+    //! @param[in]      name        ヌル終端文字列です. 文字列は所有しないため寿命に注意してください.
+    //-------------------------------------------------------------------------
+    explicit constexpr HashedName(const char* name)
+    : m_Hash (ComputeFnv1a(name))
+    , m_pName(name)
+    { /* DO_NOTHING */ }
+
+    //-------------------------------------------------------------------------
+    //! @brief      引数付きコンストラクタです.
+    //!
+    //! @param[in]      name        文字列です. 文字列は所有しないため寿命に注意してください.
+    //! @param[in]      count       文字数です.
+    //-------------------------------------------------------------------------
+    constexpr HashedName(const char* name, size_t count)
+    : m_Hash (ComputeFnv1a(name, count))
+    , m_pName(name)
+    { /* DO_NOTHING */ }
+
+    //-------------------------------------------------------------------------
+    //! @brief      ハッシュ値を取得します.
+    //-------------------------------------------------------------------------
+    constexpr uint32_t GetHash() const
+    { return m_Hash; }
+
+    //-------------------------------------------------------------------------
+    //! @brief      元の文字列を取得します.
+    //-------------------------------------------------------------------------
+    constexpr const char* GetName() const
+    { return m_pName; }
+
+    //-------------------------------------------------------------------------
+    //! @brief      等価比較演算子です.
+    //-------------------------------------------------------------------------
+    constexpr bool operator == (const HashedName& value) const
+    { return m_Hash == value.m_Hash; }
+
+    //-------------------------------------------------------------------------
+    //! @brief      非等価比較演算子です.
+    //-------------------------------------------------------------------------
+    constexpr bool operator != (const HashedName& value) const
+    { return m_Hash != value.m_Hash; }
+
+    //-------------------------------------------------------------------------
+    //! @brief      operator < です.
+    //-------------------------------------------------------------------------
+    constexpr bool operator < (const HashedName& value) const
+    { return m_Hash < value.m_Hash; }
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    uint32_t        m_Hash;     //!< ハッシュ値です.
+    const char*     m_pName;    //!< 元の文字列です (非所有).
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    /* NOTHING */
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      名前とハッシュ値の対応を登録し, 衝突をチェックします.
+//!
+//! @param[in]      name        登録する名前です.
+//! @retval true    衝突はありません.
+//! @retval false   異なる名前が同じハッシュ値で登録済みです.
+//! @note       デバッグビルドでのみチェックを行い, リリースビルドでは何もしません.
+//-----------------------------------------------------------------------------
+#if ASDX_IS_DEBUG
+bool CheckHashedName(const HashedName& name);
+#else
+inline bool CheckHashedName(const HashedName&)
+{ return true; }
+#endif//ASDX_IS_DEBUG
+
+
+inline namespace literals {
+
+//-----------------------------------------------------------------------------
+//! @brief      文字列リテラルからハッシュ名を生成します.
+//!
+//! @note       "Diffuse"_hash のように記述するとハッシュ値はコンパイル時に確定します.
+//-----------------------------------------------------------------------------
+constexpr HashedName operator "" _hash(const char* name, size_t count)
+{ return HashedName(name, count); }
+
+} // namespace literals
+} // namespace asdx
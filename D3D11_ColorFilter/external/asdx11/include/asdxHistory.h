@@ -12,6 +12,7 @@
 #include <vector>
 #include <functional>
 #include <mutex>
+#include <asdxPoolAllocator.h>
 
 
 namespace asdx {
@@ -61,7 +62,7 @@ private:
 ///////////////////////////////////////////////////////////////////////////////
 // History class
 ///////////////////////////////////////////////////////////////////////////////
-class History : public IHistory
+class History : public IHistory, public PoolObject
 {
 public:
     History(Action redo, Action undo);
@@ -77,7 +78,7 @@ private:
 ///////////////////////////////////////////////////////////////////////////////
 // GroupHistory class
 ///////////////////////////////////////////////////////////////////////////////
-class GroupHistory : public IHistory
+class GroupHistory : public IHistory, public PoolObject
 {
 public:
     EventHandler UndoExecuted;
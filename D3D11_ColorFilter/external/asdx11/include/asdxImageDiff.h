@@ -0,0 +1,154 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxImageDiff.h
+// Desc : Image Comparison Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <asdxResTexture.h>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DecodedImage structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct DecodedImage
+{
+    uint32_t            Width;      //!< 横幅です.
+    uint32_t            Height;     //!< 縦幅です(ボリュームの場合は全スライス分の行数です).
+    std::vector<float>  Pixels;     //!< RGBA32F のピクセルデータです.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    DecodedImage()
+    : Width ( 0 )
+    , Height( 0 )
+    { /* DO_NOTHING */ }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ImageDiffDesc structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ImageDiffDesc
+{
+    uint32_t    ThreadCount;        //!< 使用するスレッド数です(0の場合はハードウェアスレッド数).
+    uint32_t    TileSize;           //!< スレッドに割り当てるタイルの1辺のピクセル数です.
+    uint32_t    WindowSize;         //!< SSIM を求めるウィンドウの1辺のピクセル数です.
+    uint32_t    WindowStride;       //!< SSIM ウィンドウの移動量です(WindowSize の約数).
+    float       DynamicRange;       //!< PSNR, SSIM で使用する値域です.
+    float       Threshold;          //!< 差分ありとみなす誤差の閾値です.
+    float       HeatmapScale;       //!< ヒートマップに書き込む際に誤差に乗算する値です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ImageDiffDesc()
+    : ThreadCount   ( 0 )
+    , TileSize      ( 64 )
+    , WindowSize    ( 8 )
+    , WindowStride  ( 4 )
+    , DynamicRange  ( 1.0f )
+    , Threshold     ( 0.0f )
+    , HeatmapScale  ( 10.0f )
+    { /* DO_NOTHING */ }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ImageDiffResult structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ImageDiffResult
+{
+    uint64_t    PixelCount;         //!< 比較したピクセル数です.
+    uint64_t    DiffPixelCount;     //!< 閾値を超える誤差を持つピクセル数です.
+    uint64_t    WindowCount;        //!< SSIM を求めたウィンドウ数です.
+    double      MSE     [4];        //!< チャンネル毎の平均二乗誤差です.
+    double      RMSE    [4];        //!< チャンネル毎の二乗平均平方根誤差です.
+    double      PSNR    [4];        //!< チャンネル毎の PSNR [dB] です. 一致する場合は無限大です.
+    double      SSIM    [4];        //!< チャンネル毎の平均 SSIM です.
+    double      MaxError[4];        //!< チャンネル毎の最大絶対誤差です.
+    double      RMSERGB;            //!< RGB の二乗平均平方根誤差です.
+    double      PSNRRGB;            //!< RGB の PSNR [dB] です.
+    double      SSIMRGB;            //!< RGB の平均 SSIM です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ImageDiffResult();
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      浮動小数点に展開可能なフォーマットかどうかチェックします.
+//!
+//! @param[in]      format      DXGI_FORMAT です.
+//! @retval true    展開可能です.
+//! @retval false   展開できません.
+//-------------------------------------------------------------------------------------------------
+bool IsDecodableFormat( uint32_t format );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      サブリソースを RGBA32F に展開します.
+//!
+//! @param[in]      subresource     サブリソースです.
+//! @param[in]      format          サブリソースの DXGI_FORMAT です.
+//! @param[out]     result          展開結果の格納先です.
+//! @param[in]      threadCount     使用するスレッド数です(0の場合はハードウェアスレッド数).
+//! @retval true    展開に成功.
+//! @retval false   展開に失敗.
+//! @note       SRGB フォーマットは格納値のまま展開し, リニア化は行いません.
+//!             存在しないチャンネルは G, B = 0, A = 1 として展開します.
+//-------------------------------------------------------------------------------------------------
+bool DecodeSubResource(
+    const SubResource&  subresource,
+    uint32_t            format,
+    DecodedImage&       result,
+    uint32_t            threadCount = 0 );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      展開済みの画像を比較します.
+//!
+//! @param[in]      lhs             比較する画像です.
+//! @param[in]      rhs             比較する画像です.
+//! @param[in]      desc            比較設定です.
+//! @param[out]     result          比較結果の格納先です.
+//! @param[out]     pHeatmap        誤差のヒートマップ(R8G8B8A8_UNORM)の格納先です. nullptr 可.
+//! @retval true    比較に成功.
+//! @retval false   比較に失敗.
+//! @note       生成したヒートマップは呼び出し側で ResTexture::Release() を呼び出してください.
+//-------------------------------------------------------------------------------------------------
+bool CompareImage(
+    const DecodedImage&     lhs,
+    const DecodedImage&     rhs,
+    const ImageDiffDesc&    desc,
+    ImageDiffResult&        result,
+    ResTexture*             pHeatmap = nullptr );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      テクスチャリソースを比較します.
+//!
+//! @param[in]      lhs             比較するテクスチャです.
+//! @param[in]      rhs             比較するテクスチャです.
+//! @param[in]      desc            比較設定です.
+//! @param[out]     result          全サブリソースを集計した比較結果の格納先です.
+//! @param[out]     pHeatmap        先頭サブリソースのヒートマップの格納先です. nullptr 可.
+//! @retval true    比較に成功.
+//! @retval false   比較に失敗.
+//! @note       フォーマットが異なっていても, サイズ, ミップ数, サーフェイス数が一致すれば比較できます.
+//-------------------------------------------------------------------------------------------------
+bool CompareResTexture(
+    const ResTexture&       lhs,
+    const ResTexture&       rhs,
+    const ImageDiffDesc&    desc,
+    ImageDiffResult&        result,
+    ResTexture*             pHeatmap = nullptr );
+
+} // namespace asdx
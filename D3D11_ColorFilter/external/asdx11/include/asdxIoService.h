@@ -0,0 +1,243 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxIoService.h
+// Desc : Asynchronous File I/O Service.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+// Forward Declarations.
+//-------------------------------------------------------------------------------------------------
+struct IoFileTask;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IoRequest structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  読み込み要求です. 完了するまで呼び出し元が保持する必要があります.
+struct IoRequest
+{
+    const char*     Path;           //!< ファイルパスです.
+    uint64_t        Offset;         //!< 読み込み開始位置です.
+    uint32_t        Size;           //!< 読み込むサイズです.
+    void*           pDst;           //!< 格納先です.
+    uint32_t        ReadSize;       //!< 実際に読み込んだサイズです. 完了時に設定されます.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IoBatch class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  まとめて投入した読み込み要求の完了を待つためのハンドルです.
+//! @note   IsDone() が true を返した後は, サービス側から参照されないため破棄できます.
+class IoBatch
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    friend class IoService;
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    IoBatch()
+    : m_Count     ( 0 )
+    , m_ErrorCount( 0 )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全ての要求が完了したかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool IsDone() const
+    { return m_Count.load( std::memory_order_acquire ) == 0; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要求したサイズを読み込めなかった要求の数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t GetErrorCount() const
+    { return m_ErrorCount.load( std::memory_order_acquire ); }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    std::atomic<uint32_t>   m_Count;        //!< 完了していないファイル数です.
+    std::atomic<uint32_t>   m_ErrorCount;   //!< 失敗した要求の数です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    IoBatch             ( const IoBatch& ) = delete;
+    IoBatch& operator = ( const IoBatch& ) = delete;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IoServiceDesc structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct IoServiceDesc
+{
+    uint32_t    ThreadCount;        //!< スレッドプールのスレッド数です. io_uring 使用時は1スレッドです.
+    uint32_t    QueueDepth;         //!< io_uring の同時発行数です.
+    uint32_t    MergeGap;           //!< この間隔以下で隣接する範囲を1回の読み込みにまとめます.
+    uint32_t    MaxMergeSize;       //!< まとめた読み込みの最大サイズです.
+    bool        EnableUring;        //!< 利用可能な場合は io_uring を使用するかどうか.
+
+    IoServiceDesc()
+    : ThreadCount   ( 4 )
+    , QueueDepth    ( 64 )
+    , MergeGap      ( 4 * 1024 )
+    , MaxMergeSize  ( 4 * 1024 * 1024 )
+    , EnableUring   ( true )
+    { /* DO_NOTHING */ }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IoStats structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct IoStats
+{
+    uint64_t    RequestCount;       //!< 要求数です.
+    uint64_t    ReadCount;          //!< まとめた後の実際の読み込み回数です.
+    uint64_t    OpenCount;          //!< ファイルを開いた回数です.
+    uint64_t    ReadBytes;          //!< 実際に読み込んだバイト数です.
+    uint64_t    RetryCount;         //!< 要求より短い読み込みの後に残りを読み直した回数です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IoService class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  読み込み要求をまとめて非同期に処理します.
+//! @note   投入時に要求をファイルごとにまとめ, ファイルは1バッチにつき1回だけ開きます.
+//!         同じファイルで隣接する範囲は1回の読み込みにまとめます.
+//!         Linux では io_uring を, それ以外ではスレッドプールでの位置指定読み込みを使用します.
+class IoService
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      シングルトンインスタンスを取得します.
+    //---------------------------------------------------------------------------------------------
+    static IoService& GetInstance();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      desc        構成設定です.
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool Init( const IoServiceDesc& desc = IoServiceDesc() );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      終了処理を行います. 投入済みの要求は全て完了させます.
+    //---------------------------------------------------------------------------------------------
+    void Term();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      読み込み要求をまとめて投入します.
+    //!
+    //! @param[in]      pRequests   読み込み要求です. 完了するまで保持する必要があります.
+    //! @param[in]      count       読み込み要求の数です.
+    //! @param[in]      pBatch      完了を通知するハンドルです. 完了するまで保持する必要があります.
+    //! @retval true    投入に成功.
+    //! @retval false   投入に失敗.
+    //! @note       未初期化の場合はその場で読み込みます.
+    //---------------------------------------------------------------------------------------------
+    bool Submit( IoRequest* pRequests, uint32_t count, IoBatch* pBatch );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全ての要求が完了するまで待機します.
+    //!
+    //! @param[in]      pBatch      待機するハンドルです.
+    //---------------------------------------------------------------------------------------------
+    void Wait( IoBatch* pBatch );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      io_uring を使用しているかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool IsUringEnabled() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      統計情報を取得します.
+    //---------------------------------------------------------------------------------------------
+    IoStats GetStats() const;
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    struct Uring;
+
+    IoServiceDesc                   m_Desc;             //!< 構成設定です.
+    std::vector<std::thread>        m_Threads;          //!< ワーカースレッドです.
+    std::mutex                      m_Lock;             //!< キューのロックです.
+    std::condition_variable         m_Cond;             //!< キューの条件変数です.
+    std::deque<IoFileTask*>         m_Queue;            //!< ファイルごとの読み込みタスクです.
+    std::mutex                      m_DoneLock;         //!< 完了待ち用のロックです.
+    std::condition_variable         m_DoneCond;         //!< 完了待ち用の条件変数です.
+    Uring*                          m_pUring;           //!< io_uring です.
+    bool                            m_Quit;             //!< 終了要求フラグです.
+    bool                            m_Init;             //!< 初期化済みフラグです.
+    std::atomic<uint64_t>           m_RequestCount;     //!< 要求数です.
+    std::atomic<uint64_t>           m_ReadCount;        //!< 読み込み回数です.
+    std::atomic<uint64_t>           m_OpenCount;        //!< ファイルを開いた回数です.
+    std::atomic<uint64_t>           m_ReadBytes;        //!< 読み込んだバイト数です.
+    std::atomic<uint64_t>           m_RetryCount;       //!< 残りを読み直した回数です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    IoService ();
+    ~IoService();
+    IoService             ( const IoService& ) = delete;
+    IoService& operator = ( const IoService& ) = delete;
+
+    void        WorkerMain      ();
+    void        UringMain       ();
+    IoFileTask* PopTask         ( bool wait );
+    void        ExecuteTask     ( IoFileTask* pTask );
+    void        CompleteTask    ( IoFileTask* pTask );
+};
+
+} // namespace asdx
@@ -0,0 +1,310 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxJobSystem.h
+// Desc : Work Stealing Job System.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+// Forward Declarations.
+//-------------------------------------------------------------------------------------------------
+struct Job;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// JobCounter class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  ジョブの完了を待つためのカウンターです.
+//! @note   ジョブの投入時に加算され, 完了時に減算されます. 実行中のジョブから RunChild() で投入した
+//!         子ジョブも同じカウンターに加算されるため, 待機は子ジョブの完了まで含みます.
+//!         例外を送出したジョブも完了として減算され, その数と最初の例外は Wait() 後に取得できます.
+class JobCounter
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    friend class JobSystem;
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    JobCounter()
+    : m_Count       ( 0 )
+    , m_ErrorCount  ( 0 )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全てのジョブが完了したかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool IsDone() const
+    { return m_Count.load( std::memory_order_acquire ) == 0; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      例外を送出して終了したジョブ数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t GetErrorCount() const
+    { return m_ErrorCount.load( std::memory_order_acquire ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      最初に送出された例外を取得します. IsDone() が true になってから呼び出してください.
+    //---------------------------------------------------------------------------------------------
+    std::exception_ptr GetError() const
+    { return m_Error; }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    std::atomic<int32_t>    m_Count;        //!< 完了していないジョブ数です.
+    std::atomic<uint32_t>   m_ErrorCount;   //!< 例外を送出したジョブ数です.
+    std::exception_ptr      m_Error;        //!< 最初に送出された例外です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    JobCounter             ( const JobCounter& ) = delete;
+    JobCounter& operator = ( const JobCounter& ) = delete;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// JobSystem class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  ワーカーごとの Chase-Lev デックによるワークスティーリング型のジョブシステムです.
+//! @note   Init() を呼び出したスレッドがメインスレッドとしてデックを1つ持ち, Wait() 中はジョブを実行します.
+//!         ワーカー以外のスレッドから投入したジョブは共有キューを経由します.
+class JobSystem
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    static const size_t     kJobDataSize  = 64;     //!< ジョブに格納できる関数オブジェクトの最大サイズです.
+    static const uint32_t   kDequeSize    = 4096;   //!< 1スレッドあたりのデックの容量です.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      シングルトンインスタンスを取得します.
+    //---------------------------------------------------------------------------------------------
+    static JobSystem& GetInstance();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      workerCount     ワーカースレッド数です. 0 の場合は論理コア数 - 1 とします.
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool Init( uint32_t workerCount = 0 );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      終了処理を行います. 未実行のジョブを全て実行してからワーカースレッドを終了します.
+    //---------------------------------------------------------------------------------------------
+    void Term();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化済みかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool IsInit() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ワーカースレッド数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t GetWorkerCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ジョブを投入します.
+    //!
+    //! @param[in]      pCounter    完了を通知するカウンターです. nullptr も指定できます.
+    //! @param[in]      func        実行する関数オブジェクトです. kJobDataSize 以下である必要があります.
+    //! @note       未初期化の場合はその場で実行します.
+    //!             関数オブジェクトが送出した例外はジョブシステム内で捕捉してログに出力し,
+    //!             カウンターに記録します. Wait() から再送出はされません.
+    //---------------------------------------------------------------------------------------------
+    template<typename Func>
+    void Run( JobCounter* pCounter, Func&& func )
+    {
+        using FuncType = typename std::decay<Func>::type;
+        static_assert( sizeof(FuncType) <= kJobDataSize, "Job function object is too large." );
+        static_assert( alignof(FuncType) <= 16, "Job function object is over aligned." );
+
+        auto pJob = AllocJob( pCounter );
+        new ( GetJobData( pJob ) ) FuncType( std::forward<Func>( func ) );
+        Submit( pJob, &InvokeJob<FuncType> );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      実行中のジョブの子ジョブを投入します.
+    //!
+    //! @param[in]      func        実行する関数オブジェクトです.
+    //! @note       子ジョブは親ジョブと同じカウンターに加算されます. ジョブの外から呼び出した場合は
+    //!             カウンターなしで Run() を呼び出した場合と同じです.
+    //---------------------------------------------------------------------------------------------
+    template<typename Func>
+    void RunChild( Func&& func )
+    { Run( GetCurrentCounter(), std::forward<Func>( func ) ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      カウンターが 0 になるまで, ジョブを実行しながら待機します.
+    //!
+    //! @param[in]      pCounter    待機するカウンターです.
+    //---------------------------------------------------------------------------------------------
+    void Wait( const JobCounter* pCounter );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      範囲を分割して並列に処理します.
+    //!
+    //! @param[in]      count       要素数です.
+    //! @param[in]      func        func( begin, end ) の形式で呼び出される関数オブジェクトです.
+    //! @param[in]      grainSize   1ジョブあたりの最小要素数です. 0 の場合はスレッド数から自動で決定します.
+    //! @note       全ての要素の処理が完了するまで, 呼び出しスレッドもジョブを実行しながら待機します.
+    //!             func が例外を送出した場合は, 全ての要素の処理が終わった後に最初の例外を再送出します.
+    //---------------------------------------------------------------------------------------------
+    template<typename Func>
+    void ParallelFor( uint32_t count, const Func& func, uint32_t grainSize = 0 )
+    {
+        if ( count == 0 )
+        { return; }
+
+        if ( grainSize == 0 )
+        { grainSize = GetAutoGrainSize( count ); }
+
+        if ( count <= grainSize || !IsInit() )
+        {
+            func( uint32_t( 0 ), count );
+            return;
+        }
+
+        JobCounter counter;
+        Run( &counter, [this, &func, count, grainSize]()
+        { SplitRange( func, 0, count, grainSize ); });
+        Wait( &counter );
+
+        auto error = counter.GetError();
+        if ( error )
+        { std::rethrow_exception( error ); }
+    }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // WorkDeque class
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief  Chase-Lev デックです. 所有スレッドのみが Push() / Pop() を, 他スレッドが Steal() を呼び出します.
+    class WorkDeque
+    {
+    public:
+        WorkDeque();
+        bool Push  ( Job* pJob );
+        Job* Pop   ();
+        Job* Steal ();
+
+    private:
+        std::atomic<int64_t>    m_Top;                  //!< 盗む側の位置です.
+        char                    m_Padding[64];          //!< 偽共有を防ぐためのパディングです.
+        std::atomic<int64_t>    m_Bottom;               //!< 所有スレッド側の位置です.
+        std::atomic<Job*>       m_Jobs[kDequeSize];     //!< ジョブです.
+    };
+
+    std::vector<std::thread>        m_Threads;          //!< ワーカースレッドです.
+    std::vector<WorkDeque*>         m_Deques;           //!< スレッドごとのデックです (0 はメインスレッド).
+    std::mutex                      m_QueueLock;        //!< 共有キューのロックです.
+    std::deque<Job*>                m_Queue;            //!< ワーカー以外のスレッドから投入されたジョブです.
+    std::mutex                      m_SleepLock;        //!< 待機用のロックです.
+    std::condition_variable         m_SleepCond;        //!< 待機用の条件変数です.
+    std::atomic<int32_t>            m_PendingCount;     //!< 取り出されていないジョブ数です.
+    std::atomic<int32_t>            m_SleepCount;       //!< 待機中のワーカー数です.
+    std::atomic<bool>               m_Quit;             //!< 終了要求フラグです.
+    std::atomic<bool>               m_Init;             //!< 初期化済みフラグです.
+    std::thread::id                 m_MainThreadId;     //!< Init() を呼び出したスレッドの ID です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    JobSystem ();
+    ~JobSystem();
+    JobSystem             ( const JobSystem& ) = delete;
+    JobSystem& operator = ( const JobSystem& ) = delete;
+
+    Job*        AllocJob            ( JobCounter* pCounter );
+    void*       GetJobData          ( Job* pJob );
+    void        Submit              ( Job* pJob, void (*pInvoke)( void* ) );
+    void        Execute             ( Job* pJob );
+    Job*        FindJob             ( int32_t index, uint32_t& seed );
+    Job*        PopQueue            ();
+    void        WorkerMain          ( uint32_t index );
+    int32_t     GetThreadIndex      () const;
+    JobCounter* GetCurrentCounter   () const;
+    uint32_t    GetAutoGrainSize    ( uint32_t count ) const;
+
+    template<typename FuncType>
+    static void InvokeJob( void* pData )
+    {
+        auto pFunc = static_cast<FuncType*>( pData );
+        try
+        { (*pFunc)(); }
+        catch( ... )
+        {
+            pFunc->~FuncType();
+            throw;
+        }
+        pFunc->~FuncType();
+    }
+
+    template<typename Func>
+    void SplitRange( const Func& func, uint32_t begin, uint32_t end, uint32_t grainSize )
+    {
+        // 後半を子ジョブとして他スレッドに盗ませ, 前半は自身で分割を続けます.
+        while( end - begin > grainSize )
+        {
+            auto mid = begin + ( end - begin ) / 2;
+            RunChild( [this, &func, mid, end, grainSize]()
+            { SplitRange( func, mid, end, grainSize ); });
+            end = mid;
+        }
+
+        func( begin, end );
+    }
+};
+
+} // namespace asdx
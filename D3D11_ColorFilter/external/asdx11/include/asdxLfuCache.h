@@ -8,15 +8,298 @@
 //-------------------------------------------------------------------------------------------------
 // Includes
 //-------------------------------------------------------------------------------------------------
-#include <map>
+#include <unordered_map>
+#include <functional>
+#include <tuple>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
 
 
 namespace asdx {
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LfuMap class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename TKey, typename TValue, typename THash = std::hash<TKey>>
+class LfuMap
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリがキャッシュから取り除かれる際に呼び出されるコールバックです.
+    //!
+    //! @note       コールバック内からキャッシュを操作してはいけません.
+    //---------------------------------------------------------------------------------------------
+    using EvictCallback = std::function<void(const TKey& key, TValue& value)>;
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //!
+    //! @param[in]      capacity    容量です. Put() で重みを省略した場合はエントリ数になります.
+    //---------------------------------------------------------------------------------------------
+    LfuMap(size_t capacity);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~LfuMap();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      追い出し時のコールバックを設定します.
+    //!
+    //! @param[in]      callback    コールバックです.
+    //---------------------------------------------------------------------------------------------
+    void SetEvictCallback(EvictCallback callback);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリを追加または更新します.
+    //!
+    //! @param[in]      key         キーです.
+    //! @param[in]      value       値です.
+    //! @param[in]      weight      重み(バイト数など)です.
+    //! @retval true    追加に成功.
+    //! @retval false   重みが容量を超える, またはピン留めされたエントリで容量が埋まっていて追加できません.
+    //! @note       容量を超える場合は最も参照頻度の低いエントリから追い出します.
+    //!             参照頻度が同じ場合は最も長く使用されていないエントリを追い出します.
+    //---------------------------------------------------------------------------------------------
+    bool Put(const TKey& key, const TValue& value, size_t weight = 1);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリを追加または更新します.
+    //---------------------------------------------------------------------------------------------
+    bool Put(const TKey& key, TValue&& value, size_t weight = 1);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      値を取得し, 参照頻度を加算します.
+    //!
+    //! @param[in]      key         キーです.
+    //! @return     値へのポインタを返却します. 見つからない場合は nullptr を返却します.
+    //! @note       ピン留めされていない値へのポインタは次の Put() で無効になる可能性があります.
+    //---------------------------------------------------------------------------------------------
+    TValue* Get(const TKey& key);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      参照頻度を変更せずに値を取得します.
+    //---------------------------------------------------------------------------------------------
+    const TValue* Peek(const TKey& key) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリが含まれているか判定します.
+    //---------------------------------------------------------------------------------------------
+    bool Contains(const TKey& key) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリをピン留めし, 追い出しの対象から外します.
+    //!
+    //! @param[in]      key         キーです.
+    //! @return     値へのポインタを返却します. 見つからない場合は nullptr を返却します.
+    //! @note       Pin() と Unpin() は同じ回数呼び出す必要があります.
+    //---------------------------------------------------------------------------------------------
+    TValue* Pin(const TKey& key);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリのピン留めを解除します.
+    //!
+    //! @note       ピン留め中も戻し先のバケットを保持しているため, 定数時間で戻します.
+    //---------------------------------------------------------------------------------------------
+    bool Unpin(const TKey& key);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリを削除します.
+    //!
+    //! @retval true    削除に成功.
+    //! @retval false   エントリが存在しないか, ピン留めされています.
+    //---------------------------------------------------------------------------------------------
+    bool Remove(const TKey& key);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ピン留めされたエントリも含めて全エントリを削除します.
+    //---------------------------------------------------------------------------------------------
+    void Clear();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      容量を設定します.
+    //!
+    //! @note       容量を超えている場合はその場で追い出します.
+    //---------------------------------------------------------------------------------------------
+    void SetCapacity(size_t capacity);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリ数に合わせてハッシュテーブルを予約します.
+    //---------------------------------------------------------------------------------------------
+    void Reserve(size_t count);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      参照頻度を半減させる間隔を設定します.
+    //!
+    //! @param[in]      period      Get() と Put() の呼び出し回数です.
+    //!                             0 の場合はエントリ数の 10 倍の回数ごとに半減します.
+    //---------------------------------------------------------------------------------------------
+    void SetAgingPeriod(uint64_t period);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      参照頻度の半減を有効にするかどうか設定します. デフォルトは有効です.
+    //---------------------------------------------------------------------------------------------
+    void EnableAging(bool enable);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全エントリの参照頻度を半減させます.
+    //!
+    //! @note       通常は SetAgingPeriod() で設定した間隔で自動的に呼び出されます.
+    //---------------------------------------------------------------------------------------------
+    void Age();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      参照頻度を取得します.
+    //!
+    //! @return     参照頻度を返却します. 見つからない場合は 0 を返却します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t GetFrequency(const TKey& key) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全エントリを走査します.
+    //!
+    //! @param[in]      func        void(const TKey&, const TValue&) の形式の関数です.
+    //! @note       順序は規定しません.
+    //---------------------------------------------------------------------------------------------
+    template<typename Func>
+    void ForEach(Func func) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      容量を取得します.
+    //---------------------------------------------------------------------------------------------
+    size_t GetCapacity() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      現在の重みの合計を取得します.
+    //---------------------------------------------------------------------------------------------
+    size_t GetWeight() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      現在のエントリ数を取得します.
+    //---------------------------------------------------------------------------------------------
+    size_t GetCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      Get() でヒットした回数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint64_t GetHitCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      Get() でヒットしなかった回数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint64_t GetMissCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      追い出したエントリ数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint64_t GetEvictCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      統計情報をリセットします.
+    //---------------------------------------------------------------------------------------------
+    void ResetStats();
+
+private:
+    struct Bucket;
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Node structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Node
+    {
+        TValue          Value;      //!< 値です.
+        size_t          Weight;     //!< 重みです.
+        uint32_t        Frequency;  //!< 参照頻度です.
+        uint32_t        PinCount;   //!< ピン留めの参照数です.
+        Node*           pPrev;      //!< バケット内で最近使用した側のノードです.
+        Node*           pNext;      //!< バケット内で使用していない側のノードです.
+        Bucket*         pBucket;    //!< 所属するバケットです. ピン留め中はリストから外し, 戻し先として保持します.
+        const TKey*     pKey;       //!< ハッシュテーブル内のキーです.
+
+        template<typename V>
+        Node(V&& value, size_t weight)
+        : Value     (std::forward<V>(value))
+        , Weight    (weight)
+        , Frequency (1)
+        , PinCount  (0)
+        , pPrev     (nullptr)
+        , pNext     (nullptr)
+        , pBucket   (nullptr)
+        , pKey      (nullptr)
+        { /* DO_NOTHING */ }
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Bucket structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Bucket
+    {
+        uint32_t    Frequency;      //!< 参照頻度です.
+        uint32_t    PinCount;       //!< 戻し先として保持しているピン留め中のノード数です.
+        Bucket*     pMerged;        //!< Age() で統合された場合の統合先です.
+        Bucket*     pPrev;          //!< 頻度の低い側のバケットです.
+        Bucket*     pNext;          //!< 頻度の高い側のバケットです.
+        Node*       pHead;          //!< 最近使用したノードです.
+        Node*       pTail;          //!< 最も長く使用されていないノードです.
+    };
+
+    using Table = std::unordered_map<TKey, Node, THash>;
+
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    size_t          m_Capacity;         //!< 容量です.
+    size_t          m_Weight;           //!< 重みの合計です.
+    Table           m_Table;            //!< ハッシュテーブルです. ノードのアドレスは再ハッシュでも変わりません.
+    Bucket*         m_pLowest;          //!< 最も頻度の低いバケットです.
+    Bucket*         m_pFreeBucket;      //!< 再利用するバケットのリストです.
+    EvictCallback   m_OnEvict;          //!< 追い出し時のコールバックです.
+    uint64_t        m_AgingPeriod;      //!< 参照頻度を半減させる間隔です.
+    uint64_t        m_AccessCount;      //!< 前回の半減からのアクセス数です.
+    bool            m_EnableAging;      //!< 参照頻度の半減が有効かどうか.
+    uint64_t        m_HitCount;         //!< ヒット数です.
+    uint64_t        m_MissCount;        //!< ミス数です.
+    uint64_t        m_EvictCount;       //!< 追い出し数です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    LfuMap              (const LfuMap&) = delete;
+    LfuMap& operator =  (const LfuMap&) = delete;
+
+    template<typename V>
+    bool PutInternal(const TKey& key, V&& value, size_t weight);
+
+    Bucket* AllocBucket     (uint32_t frequency, Bucket* pPrev, Bucket* pNext);
+    void    FreeBucket      (Bucket* pBucket);
+    void    LinkNode        (Bucket* pBucket, Node* pNode);
+    void    UnlinkNode      (Node* pNode);
+    void    Touch           (Node* pNode);
+    void    Relink          (Node* pNode);
+    Node*   FindVictim      (const Node* pKeep) const;
+    void    EvictTo         (size_t limit, const Node* pKeep);
+    void    CountAccess     ();
+};
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // LfuCache class
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-template<typename T>
+template<typename T, typename THash = std::hash<T>>
 class LfuCache
 {
     //=============================================================================================
@@ -83,8 +366,7 @@ private:
     //=============================================================================================
     // private variables.
     //=============================================================================================
-    size_t                 m_Capacity;
-    std::map<T, size_t>    m_Cache;
+    LfuMap<T, bool, THash>  m_Cache;
 
     //=============================================================================================
     // private methods.
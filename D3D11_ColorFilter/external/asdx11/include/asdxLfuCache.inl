@@ -9,109 +9,730 @@
 namespace asdx {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-// LfuCache class
+// LfuMap class
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 //-------------------------------------------------------------------------------------------------
 //      コンストラクタです.
 //-------------------------------------------------------------------------------------------------
-template<typename T> inline
-LfuCache<T>::LfuCache(size_t capacity)
-: m_Capacity(capacity)
-, m_Cache()
+template<typename TKey, typename TValue, typename THash> inline
+LfuMap<TKey, TValue, THash>::LfuMap(size_t capacity)
+: m_Capacity    (capacity)
+, m_Weight      (0)
+, m_Table       ()
+, m_pLowest     (nullptr)
+, m_pFreeBucket (nullptr)
+, m_OnEvict     ()
+, m_AgingPeriod (0)
+, m_AccessCount (0)
+, m_EnableAging (true)
+, m_HitCount    (0)
+, m_MissCount   (0)
+, m_EvictCount  (0)
 { /* DO_NOTHING */ }
 
 //-------------------------------------------------------------------------------------------------
 //      デストラクタです.
 //-------------------------------------------------------------------------------------------------
-template<typename T> inline
-LfuCache<T>::~LfuCache()
-{ Clear(); }
+template<typename TKey, typename TValue, typename THash> inline
+LfuMap<TKey, TValue, THash>::~LfuMap()
+{
+    Clear();
+
+    while( m_pFreeBucket != nullptr )
+    {
+        auto pNext = m_pFreeBucket->pNext;
+        delete m_pFreeBucket;
+        m_pFreeBucket = pNext;
+    }
+}
 
 //-------------------------------------------------------------------------------------------------
-//      要素を追加します.
+//      追い出し時のコールバックを設定します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LfuMap<TKey, TValue, THash>::SetEvictCallback(EvictCallback callback)
+{ m_OnEvict = std::move(callback); }
+
+//-------------------------------------------------------------------------------------------------
+//      エントリを追加または更新します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+bool LfuMap<TKey, TValue, THash>::Put(const TKey& key, const TValue& value, size_t weight)
+{ return PutInternal(key, value, weight); }
+
+//-------------------------------------------------------------------------------------------------
+//      エントリを追加または更新します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+bool LfuMap<TKey, TValue, THash>::Put(const TKey& key, TValue&& value, size_t weight)
+{ return PutInternal(key, std::move(value), weight); }
+
+//-------------------------------------------------------------------------------------------------
+//      エントリを追加または更新します.
 //-------------------------------------------------------------------------------------------------
-template<typename T> inline
-void LfuCache<T>::Add(const T& item)
+template<typename TKey, typename TValue, typename THash>
+template<typename V> inline
+bool LfuMap<TKey, TValue, THash>::PutInternal(const TKey& key, V&& value, size_t weight)
 {
-    if ( Contains(item) )
+    if ( weight > m_Capacity )
+    { return false; }
+
+    auto itr = m_Table.find(key);
+    if ( itr != m_Table.end() )
     {
-        m_Cache[item]++;
+        auto pNode = &itr->second;
+        if ( m_OnEvict )
+        { m_OnEvict(*pNode->pKey, pNode->Value); }
+
+        pNode->Value  = std::forward<V>(value);
+        m_Weight     -= pNode->Weight;
+        m_Weight     += weight;
+        pNode->Weight = weight;
+
+        Touch(pNode);
+        EvictTo(m_Capacity, pNode);
+        CountAccess();
+        return true;
     }
-    else if ( m_Cache.size() < m_Capacity )
+
+    EvictTo(m_Capacity - weight, nullptr);
+    if ( m_Weight + weight > m_Capacity )
+    { return false; }
+
+    auto result = m_Table.emplace(
+        std::piecewise_construct,
+        std::forward_as_tuple(key),
+        std::forward_as_tuple(std::forward<V>(value), weight));
+
+    auto pNode  = &result.first->second;
+    pNode->pKey = &result.first->first;
+    m_Weight   += weight;
+
+    // 頻度 1 のバケットは常に先頭にあるので走査は発生しない.
+    Relink(pNode);
+    CountAccess();
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      値を取得し, 参照頻度を加算します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+TValue* LfuMap<TKey, TValue, THash>::Get(const TKey& key)
+{
+    auto itr = m_Table.find(key);
+    if ( itr == m_Table.end() )
     {
-        m_Cache[item] = 1;
+        m_MissCount++;
+        CountAccess();
+        return nullptr;
     }
-    else
+
+    m_HitCount++;
+
+    auto pNode = &itr->second;
+    Touch(pNode);
+    CountAccess();
+
+    return &pNode->Value;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      参照頻度を変更せずに値を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+const TValue* LfuMap<TKey, TValue, THash>::Peek(const TKey& key) const
+{
+    auto itr = m_Table.find(key);
+    return ( itr != m_Table.cend() ) ? &itr->second.Value : nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      エントリが含まれているか判定します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+bool LfuMap<TKey, TValue, THash>::Contains(const TKey& key) const
+{ return m_Table.find(key) != m_Table.cend(); }
+
+//-------------------------------------------------------------------------------------------------
+//      エントリをピン留めします.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+TValue* LfuMap<TKey, TValue, THash>::Pin(const TKey& key)
+{
+    auto itr = m_Table.find(key);
+    if ( itr == m_Table.end() )
+    { return nullptr; }
+
+    // ピン留め中はバケットのリストから外し, 追い出しの走査対象にしない.
+    // バケット自体は戻し先として参照を残し, 空になっても解放しない.
+    auto pNode = &itr->second;
+    if ( pNode->PinCount == 0 )
     {
-        auto iter = m_Cache.begin();
-        auto mini = (*iter).second;
+        auto pBucket = pNode->pBucket;
+        pBucket->PinCount++;
+        UnlinkNode(pNode);
+        pNode->pBucket = pBucket;
+    }
+
+    pNode->PinCount++;
+    return &pNode->Value;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      エントリのピン留めを解除します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+bool LfuMap<TKey, TValue, THash>::Unpin(const TKey& key)
+{
+    auto itr = m_Table.find(key);
+    if ( itr == m_Table.end() || itr->second.PinCount == 0 )
+    { return false; }
+
+    auto pNode = &itr->second;
+    pNode->PinCount--;
+    if ( pNode->PinCount == 0 )
+    {
+        auto pBucket = pNode->pBucket;
+        pBucket->PinCount--;
+        LinkNode(pBucket, pNode);
+        EvictTo(m_Capacity, pNode);
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      エントリを削除します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+bool LfuMap<TKey, TValue, THash>::Remove(const TKey& key)
+{
+    auto itr = m_Table.find(key);
+    if ( itr == m_Table.end() || itr->second.PinCount != 0 )
+    { return false; }
+
+    auto pNode = &itr->second;
+    UnlinkNode(pNode);
+
+    if ( m_OnEvict )
+    { m_OnEvict(itr->first, pNode->Value); }
 
-        for(auto& it = m_Cache.begin(); it != m_Cache.end(); ++it )
+    m_Weight -= pNode->Weight;
+    m_Table.erase(itr);
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      全エントリを削除します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LfuMap<TKey, TValue, THash>::Clear()
+{
+    if ( m_OnEvict )
+    {
+        for( auto& itr : m_Table )
+        { m_OnEvict(itr.first, itr.second.Value); }
+    }
+
+    while( m_pLowest != nullptr )
+    {
+        auto pNext = m_pLowest->pNext;
+        m_pLowest->pNext = m_pFreeBucket;
+        m_pFreeBucket    = m_pLowest;
+        m_pLowest        = pNext;
+    }
+
+    m_Table.clear();
+    m_Weight      = 0;
+    m_AccessCount = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      容量を設定します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LfuMap<TKey, TValue, THash>::SetCapacity(size_t capacity)
+{
+    m_Capacity = capacity;
+    EvictTo(m_Capacity, nullptr);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ハッシュテーブルを予約します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LfuMap<TKey, TValue, THash>::Reserve(size_t count)
+{ m_Table.reserve(count); }
+
+//-------------------------------------------------------------------------------------------------
+//      参照頻度を半減させる間隔を設定します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LfuMap<TKey, TValue, THash>::SetAgingPeriod(uint64_t period)
+{ m_AgingPeriod = period; }
+
+//-------------------------------------------------------------------------------------------------
+//      参照頻度の半減を有効にするかどうか設定します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LfuMap<TKey, TValue, THash>::EnableAging(bool enable)
+{ m_EnableAging = enable; }
+
+//-------------------------------------------------------------------------------------------------
+//      全エントリの参照頻度を半減させます.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LfuMap<TKey, TValue, THash>::Age()
+{
+    m_AccessCount = 0;
+
+    // 半減は単調なので, 同じ頻度になるのは隣接するバケットだけ.
+    Bucket* pPrev = nullptr;
+    auto pBucket = m_pLowest;
+    while( pBucket != nullptr )
+    {
+        auto pNext     = pBucket->pNext;
+        auto frequency = ( pBucket->Frequency > 1 ) ? pBucket->Frequency / 2 : 1;
+
+        if ( pPrev != nullptr && pPrev->Frequency == frequency )
         {
-            if ((*it).second < mini )
+            // 元の頻度が高かった方を最近使用した側に繋ぎ, 先に追い出されないようにする.
+            // ピン留め中のノードだけを参照するバケットはリストが空になっている.
+            if ( pBucket->pHead != nullptr )
             {
-                mini = (*it).second;
-                iter = it;
+                for( auto pNode = pBucket->pHead; pNode != nullptr; pNode = pNode->pNext )
+                { pNode->pBucket = pPrev; }
+
+                if ( pPrev->pHead != nullptr )
+                {
+                    pBucket->pTail->pNext = pPrev->pHead;
+                    pPrev->pHead->pPrev   = pBucket->pTail;
+                }
+                else
+                { pPrev->pTail = pBucket->pTail; }
+
+                pPrev->pHead = pBucket->pHead;
             }
+
+            pPrev->PinCount += pBucket->PinCount;
+
+            pBucket->PinCount = 0;
+            pBucket->pHead    = nullptr;
+            pBucket->pTail    = nullptr;
+            FreeBucket(pBucket);
+
+            // 解放したバケットは Age() の間は再利用されないので, 統合先を残しておく.
+            pBucket->pMerged = pPrev;
+        }
+        else
+        {
+            pBucket->Frequency = frequency;
+            pPrev = pBucket;
         }
 
-        m_Cache.erase(iter);
-        m_Cache[item] = 1;
+        pBucket = pNext;
+    }
+
+    // ピン留め中のノードはバケットから辿れないため, 個別に戻し先を付け替える.
+    for( auto& itr : m_Table )
+    {
+        auto& node = itr.second;
+        node.Frequency = ( node.Frequency > 1 ) ? node.Frequency / 2 : 1;
+
+        if ( node.PinCount != 0 && node.pBucket->pMerged != nullptr )
+        { node.pBucket = node.pBucket->pMerged; }
     }
 }
 
 //-------------------------------------------------------------------------------------------------
-//      要素を削除します.
+//      参照頻度を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+uint32_t LfuMap<TKey, TValue, THash>::GetFrequency(const TKey& key) const
+{
+    auto itr = m_Table.find(key);
+    return ( itr != m_Table.cend() ) ? itr->second.Frequency : 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      全エントリを走査します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash>
+template<typename Func> inline
+void LfuMap<TKey, TValue, THash>::ForEach(Func func) const
+{
+    for( auto& itr : m_Table )
+    { func(itr.first, itr.second.Value); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      容量を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+size_t LfuMap<TKey, TValue, THash>::GetCapacity() const
+{ return m_Capacity; }
+
+//-------------------------------------------------------------------------------------------------
+//      現在の重みの合計を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+size_t LfuMap<TKey, TValue, THash>::GetWeight() const
+{ return m_Weight; }
+
+//-------------------------------------------------------------------------------------------------
+//      現在のエントリ数を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+size_t LfuMap<TKey, TValue, THash>::GetCount() const
+{ return m_Table.size(); }
+
+//-------------------------------------------------------------------------------------------------
+//      ヒット数を取得します.
 //-------------------------------------------------------------------------------------------------
-template<typename T> inline
-void LfuCache<T>::Remove(const T& item)
+template<typename TKey, typename TValue, typename THash> inline
+uint64_t LfuMap<TKey, TValue, THash>::GetHitCount() const
+{ return m_HitCount; }
+
+//-------------------------------------------------------------------------------------------------
+//      ミス数を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+uint64_t LfuMap<TKey, TValue, THash>::GetMissCount() const
+{ return m_MissCount; }
+
+//-------------------------------------------------------------------------------------------------
+//      追い出し数を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+uint64_t LfuMap<TKey, TValue, THash>::GetEvictCount() const
+{ return m_EvictCount; }
+
+//-------------------------------------------------------------------------------------------------
+//      統計情報をリセットします.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LfuMap<TKey, TValue, THash>::ResetStats()
+{
+    m_HitCount   = 0;
+    m_MissCount  = 0;
+    m_EvictCount = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      バケットを確保し, 指定位置に繋ぎます.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+typename LfuMap<TKey, TValue, THash>::Bucket*
+LfuMap<TKey, TValue, THash>::AllocBucket(uint32_t frequency, Bucket* pPrev, Bucket* pNext)
+{
+    Bucket* pBucket = m_pFreeBucket;
+    if ( pBucket != nullptr )
+    { m_pFreeBucket = pBucket->pNext; }
+    else
+    { pBucket = new Bucket; }
+
+    pBucket->Frequency = frequency;
+    pBucket->PinCount  = 0;
+    pBucket->pMerged   = nullptr;
+    pBucket->pPrev     = pPrev;
+    pBucket->pNext     = pNext;
+    pBucket->pHead     = nullptr;
+    pBucket->pTail     = nullptr;
+
+    if ( pPrev != nullptr )
+    { pPrev->pNext = pBucket; }
+    else
+    { m_pLowest = pBucket; }
+
+    if ( pNext != nullptr )
+    { pNext->pPrev = pBucket; }
+
+    return pBucket;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      空になったバケットを外して再利用リストに戻します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LfuMap<TKey, TValue, THash>::FreeBucket(Bucket* pBucket)
+{
+    if ( pBucket->pPrev != nullptr )
+    { pBucket->pPrev->pNext = pBucket->pNext; }
+    else
+    { m_pLowest = pBucket->pNext; }
+
+    if ( pBucket->pNext != nullptr )
+    { pBucket->pNext->pPrev = pBucket->pPrev; }
+
+    pBucket->pPrev = nullptr;
+    pBucket->pNext = m_pFreeBucket;
+    m_pFreeBucket  = pBucket;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ノードをバケットの先頭に繋ぎます.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LfuMap<TKey, TValue, THash>::LinkNode(Bucket* pBucket, Node* pNode)
 {
-    auto iter = m_Cache.find(item);
-    if (iter != m_Cache.end())
-    { m_Cache.erase(iter); }
+    pNode->pBucket = pBucket;
+
+    // ピン留め中のノードは戻し先として参照するだけにする.
+    if ( pNode->PinCount != 0 )
+    {
+        pBucket->PinCount++;
+        return;
+    }
+    pNode->pPrev   = nullptr;
+    pNode->pNext   = pBucket->pHead;
+
+    if ( pBucket->pHead != nullptr )
+    { pBucket->pHead->pPrev = pNode; }
+    else
+    { pBucket->pTail = pNode; }
+
+    pBucket->pHead = pNode;
 }
 
+//-------------------------------------------------------------------------------------------------
+//      ノードをバケットから外します. バケットが空になった場合は解放します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LfuMap<TKey, TValue, THash>::UnlinkNode(Node* pNode)
+{
+    auto pBucket = pNode->pBucket;
+    if ( pBucket == nullptr )
+    { return; }
+
+    // ピン留め中のノードはリストに繋がっていないので, 戻し先の参照だけを外す.
+    if ( pNode->PinCount != 0 )
+    {
+        pBucket->PinCount--;
+        pNode->pBucket = nullptr;
+
+        if ( pBucket->pHead == nullptr && pBucket->PinCount == 0 )
+        { FreeBucket(pBucket); }
+        return;
+    }
+
+    if ( pNode->pPrev != nullptr )
+    { pNode->pPrev->pNext = pNode->pNext; }
+    else
+    { pBucket->pHead = pNode->pNext; }
+
+    if ( pNode->pNext != nullptr )
+    { pNode->pNext->pPrev = pNode->pPrev; }
+    else
+    { pBucket->pTail = pNode->pPrev; }
+
+    pNode->pPrev   = nullptr;
+    pNode->pNext   = nullptr;
+    pNode->pBucket = nullptr;
+
+    if ( pBucket->pHead == nullptr && pBucket->PinCount == 0 )
+    { FreeBucket(pBucket); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      参照頻度を加算し, 次のバケットへ移動します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LfuMap<TKey, TValue, THash>::Touch(Node* pNode)
+{
+    if ( pNode->Frequency < UINT32_MAX )
+    { pNode->Frequency++; }
+
+    auto pBucket = pNode->pBucket;
+
+    // 頻度が飽和している場合はバケット内で先頭に移すだけ.
+    // 先頭以外のノードを外してもバケットは空にならない.
+    if ( pBucket->Frequency == pNode->Frequency )
+    {
+        if ( pNode->PinCount == 0 && pBucket->pHead != pNode )
+        {
+            UnlinkNode(pNode);
+            LinkNode(pBucket, pNode);
+        }
+        return;
+    }
+
+    auto pNext = pBucket->pNext;
+    if ( pNext == nullptr || pNext->Frequency != pNode->Frequency )
+    { pNext = AllocBucket(pNode->Frequency, pBucket, pNext); }
+
+    // 次のバケットを繋いでから外すので, 元のバケットが解放されても位置を失わない.
+    // ピン留め中のノードは戻し先だけを次のバケットへ移す.
+    UnlinkNode(pNode);
+    LinkNode(pNext, pNode);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ノードの頻度に対応するバケットへ繋ぎます.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LfuMap<TKey, TValue, THash>::Relink(Node* pNode)
+{
+    Bucket* pPrev   = nullptr;
+    Bucket* pBucket = m_pLowest;
+    while( pBucket != nullptr && pBucket->Frequency < pNode->Frequency )
+    {
+        pPrev   = pBucket;
+        pBucket = pBucket->pNext;
+    }
+
+    if ( pBucket == nullptr || pBucket->Frequency != pNode->Frequency )
+    { pBucket = AllocBucket(pNode->Frequency, pPrev, pBucket); }
+
+    LinkNode(pBucket, pNode);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      追い出すノードを探します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+typename LfuMap<TKey, TValue, THash>::Node*
+LfuMap<TKey, TValue, THash>::FindVictim(const Node* pKeep) const
+{
+    for( auto pBucket = m_pLowest; pBucket != nullptr; pBucket = pBucket->pNext )
+    {
+        auto pNode = pBucket->pTail;
+        if ( pNode != nullptr && pNode == pKeep )
+        { pNode = pNode->pPrev; }
+
+        if ( pNode != nullptr )
+        { return pNode; }
+    }
+
+    return nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      重みの合計が指定値以下になるまで追い出します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LfuMap<TKey, TValue, THash>::EvictTo(size_t limit, const Node* pKeep)
+{
+    while( m_Weight > limit )
+    {
+        auto pNode = FindVictim(pKeep);
+        if ( pNode == nullptr )
+        { break; }
+
+        UnlinkNode(pNode);
+
+        if ( m_OnEvict )
+        { m_OnEvict(*pNode->pKey, pNode->Value); }
+
+        m_Weight -= pNode->Weight;
+        m_EvictCount++;
+
+        // キーは消去対象のノード内を指すため, イテレータで消去する.
+        m_Table.erase(m_Table.find(*pNode->pKey));
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      アクセス数を数え, 一定回数ごとに参照頻度を半減させます.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LfuMap<TKey, TValue, THash>::CountAccess()
+{
+    if ( !m_EnableAging )
+    { return; }
+
+    m_AccessCount++;
+
+    auto period = m_AgingPeriod;
+    if ( period == 0 )
+    { period = ( m_Table.size() > 16 ) ? uint64_t(m_Table.size()) * 10 : 160; }
+
+    if ( m_AccessCount >= period )
+    { Age(); }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LfuCache class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+template<typename T, typename THash> inline
+LfuCache<T, THash>::LfuCache(size_t capacity)
+: m_Cache(capacity)
+{ m_Cache.Reserve(capacity); }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+template<typename T, typename THash> inline
+LfuCache<T, THash>::~LfuCache()
+{ Clear(); }
+
+//-------------------------------------------------------------------------------------------------
+//      要素を追加します.
+//-------------------------------------------------------------------------------------------------
+template<typename T, typename THash> inline
+void LfuCache<T, THash>::Add(const T& item)
+{
+    // 未登録の要素は Get() を経由せずに追加し, アクセス数とミス数を二重に数えない.
+    if ( m_Cache.Contains(item) )
+    { m_Cache.Get(item); }
+    else
+    { m_Cache.Put(item, true); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      要素を削除します.
+//-------------------------------------------------------------------------------------------------
+template<typename T, typename THash> inline
+void LfuCache<T, THash>::Remove(const T& item)
+{ m_Cache.Remove(item); }
+
 //-------------------------------------------------------------------------------------------------
 //      全要素を削除します.
 //-------------------------------------------------------------------------------------------------
-template<typename T> inline
-void LfuCache<T>::Clear()
-{ m_Cache.clear(); }
+template<typename T, typename THash> inline
+void LfuCache<T, THash>::Clear()
+{ m_Cache.Clear(); }
 
 //-------------------------------------------------------------------------------------------------
 //      要素が含まれているか判定します.
 //-------------------------------------------------------------------------------------------------
-template<typename T> inline
-bool LfuCache<T>::Contains(const T& item) const
-{ return m_Cache.find(item) != m_Cache.cend(); }
+template<typename T, typename THash> inline
+bool LfuCache<T, THash>::Contains(const T& item) const
+{ return m_Cache.Contains(item); }
 
 //-------------------------------------------------------------------------------------------------
 //      配列にコピーします.
 //-------------------------------------------------------------------------------------------------
-template<typename T> inline
-void LfuCache<T>::Copy(T* pArray, size_t offset) const
+template<typename T, typename THash> inline
+void LfuCache<T, THash>::Copy(T* pArray, size_t offset) const
 {
-    for( auto& itr = m_Cache.cbegin(); itr != m_Cache.cend(); ++itr )
+    m_Cache.ForEach([&](const T& item, const bool&)
     {
-        pArray[offset] = (*itr).first;
+        pArray[offset] = item;
         offset++;
-    }
+    });
 }
 
 //-------------------------------------------------------------------------------------------------
 //      最大収容可能数を取得します.
 //-------------------------------------------------------------------------------------------------
-template<typename T> inline
-size_t LfuCache<T>::GetCapacity() const
-{ return m_Capacity; }
+template<typename T, typename THash> inline
+size_t LfuCache<T, THash>::GetCapacity() const
+{ return m_Cache.GetCapacity(); }
 
 //-------------------------------------------------------------------------------------------------
 //      現在の収容数を取得します.
 //-------------------------------------------------------------------------------------------------
-template<typename T> inline
-size_t LfuCache<T>::GetCount() const
-{ return m_Cache.size(); }
+template<typename T, typename THash> inline
+size_t LfuCache<T, THash>::GetCount() const
+{ return m_Cache.GetCount(); }
 
 
 } // namespace asdx
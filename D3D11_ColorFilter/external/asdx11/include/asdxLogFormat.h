@@ -0,0 +1,78 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxLogFormat.h
+// Desc : Deferred Log Formatting.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <cstdarg>
+#include <cstddef>
+#include <string>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LOG_ARG_TYPE enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  パックした引数の種類です.
+//! @note   各引数は 1byte の種類の後に値が続きます.
+//!         数値は 8byte のリトルエンディアン, 文字列は 2byte の長さ, 本体, 終端文字の順に格納します.
+enum LOG_ARG_TYPE : uint8_t
+{
+    LOG_ARG_INT = 1,        //!< 整数です. 符号なし整数と文字も含みます.
+    LOG_ARG_DOUBLE,         //!< 浮動小数です.
+    LOG_ARG_POINTER,        //!< ポインタです.
+    LOG_ARG_STRING,         //!< マルチバイト文字列です. ワイド文字列は変換して格納します.
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      書式に従って可変長引数をパックします.
+//!
+//! @param[in]      format      printf 形式の書式です.
+//! @param[in]      args        可変長引数です.
+//! @param[out]     pBuffer     格納先です.
+//! @param[in]      bufferSize  格納先のサイズです.
+//! @return     格納したサイズを返却します.
+//! @note       文字列は後続の引数の分を残して切り詰め, 末尾を "..." に置き換えます.
+//!             それでも収まらない引数以降は格納しません.
+//-------------------------------------------------------------------------------------------------
+uint32_t PackLogArgs( const char* format, va_list args, uint8_t* pBuffer, uint32_t bufferSize );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      書式に従って可変長引数をパックします.
+//!
+//! @param[in]      format      wprintf 形式の書式です.
+//! @param[in]      args        可変長引数です.
+//! @param[out]     pBuffer     格納先です.
+//! @param[in]      bufferSize  格納先のサイズです.
+//! @return     格納したサイズを返却します.
+//-------------------------------------------------------------------------------------------------
+uint32_t PackLogArgs( const wchar_t* format, va_list args, uint8_t* pBuffer, uint32_t bufferSize );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      パックした引数を書式に従って文字列に変換し, 末尾に追加します.
+//!
+//! @param[in]      format      printf 形式の書式です. ワイド文字列の書式は ToLogString() で変換して渡します.
+//! @param[in]      pArgs       PackLogArgs() でパックした引数です.
+//! @param[in]      argSize     パックした引数のサイズです.
+//! @param[out]     result      追加先です.
+//! @note       引数が足りない変換指定はそのまま出力します.
+//-------------------------------------------------------------------------------------------------
+void FormatLogArgs( const char* format, const uint8_t* pArgs, uint32_t argSize, std::string& result );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ワイド文字列をログ出力用のマルチバイト文字列に変換します.
+//!
+//! @param[in]      value       変換するワイド文字列です.
+//! @param[in]      count       文字数です.
+//! @return     Windows では ANSI コードページ, それ以外では UTF-8 の文字列を返却します.
+//-------------------------------------------------------------------------------------------------
+std::string ToLogString( const wchar_t* value, size_t count );
+
+} // namespace asdx
@@ -0,0 +1,204 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxLogTrace.h
+// Desc : Binary Log Trace.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <asdxLogger.h>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LogTraceEvent structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct LogTraceEvent
+{
+    LogLevel        Level;          //!< ログレベルです.
+    uint32_t        ThreadId;       //!< 出力したスレッドの ID です.
+    uint64_t        Time;           //!< 出力した時刻です (UNIX 時間, ナノ秒).
+    uint32_t        FormatId;       //!< 書式 ID です.
+    const char*     pFormat;        //!< 書式です. ワイド文字列の書式はマルチバイト文字列に変換済みです.
+    const uint8_t*  pArgs;          //!< PackLogArgs() でパックした引数です.
+    uint32_t        ArgSize;        //!< パックした引数のサイズです.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LogTraceSink class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  ログを書式化せずにバイナリ形式でファイルに記録するシンクです.
+//! @note   ファイルはヘッダ (マジック 'ALTR', バージョン, 基準時刻) の後にレコードが続きます.
+//!         書式は初出時に書式 ID と共に 1 度だけ記録し, 各ログは前のログからの時刻差, スレッド ID,
+//!         レベル, 書式 ID, パックした引数だけを可変長整数で記録します.
+//!         tracetool で文字列に復元できます.
+class LogTraceSink : public ILogSink
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    LogTraceSink();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~LogTraceSink();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ファイルを開きます.
+    //!
+    //! @param[in]      path        ファイルパスです.
+    //! @retval true    オープンに成功.
+    //! @retval false   オープンに失敗.
+    //---------------------------------------------------------------------------------------------
+    bool Open( const char* path );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ファイルを閉じます. SystemLogger::RemoveSink() で削除してから呼び出してください.
+    //---------------------------------------------------------------------------------------------
+    void Close();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ログを記録します.
+    //---------------------------------------------------------------------------------------------
+    void OnLog( const LogRecord& record ) override;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      バッファに溜めたレコードをファイルに書き出します.
+    //---------------------------------------------------------------------------------------------
+    void OnFlush() override;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      書式化した文字列は必要としません.
+    //---------------------------------------------------------------------------------------------
+    bool RequireText() const override;
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    FILE*                                       m_pFile;        //!< ファイルです.
+    uint64_t                                    m_PrevTime;     //!< 直前のログの時刻です.
+    std::unordered_map<const void*, uint32_t>   m_FormatIds;    //!< 書式から書式 ID への対応表です.
+    std::vector<uint8_t>                        m_Buffer;       //!< 書き込みバッファです.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    LogTraceSink            ( const LogTraceSink& ) = delete;
+    LogTraceSink& operator =( const LogTraceSink& ) = delete;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LogTraceReader class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class LogTraceReader
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    LogTraceReader();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~LogTraceReader();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ファイルを開きます.
+    //!
+    //! @param[in]      path        ファイルパスです.
+    //! @retval true    オープンに成功.
+    //! @retval false   オープンに失敗.
+    //---------------------------------------------------------------------------------------------
+    bool Open( const char* path );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ファイルを閉じます.
+    //---------------------------------------------------------------------------------------------
+    void Close();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      次のログを読み込みます.
+    //!
+    //! @param[out]     result      読み込んだログです. 次に呼び出すまで有効です.
+    //! @retval true    読み込みに成功.
+    //! @retval false   終端に達したか, ファイルが壊れています.
+    //---------------------------------------------------------------------------------------------
+    bool Next( LogTraceEvent& result );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      レコードの途中で終わっていたか, 壊れていたかどうか.
+    //---------------------------------------------------------------------------------------------
+    bool IsBroken() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      これまでに読み込んだ書式の数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t GetFormatCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      書式を取得します.
+    //---------------------------------------------------------------------------------------------
+    const char* GetFormat( uint32_t id ) const;
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    FILE*                       m_pFile;        //!< ファイルです.
+    uint64_t                    m_PrevTime;     //!< 直前のログの時刻です.
+    bool                        m_Broken;       //!< 壊れていたかどうか.
+    std::vector<std::string>    m_Formats;      //!< 書式です.
+    std::vector<uint8_t>        m_Args;         //!< 引数の読み込みバッファです.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    LogTraceReader            ( const LogTraceReader& ) = delete;
+    LogTraceReader& operator =( const LogTraceReader& ) = delete;
+
+    bool ReadVarint( uint64_t& value );
+};
+
+} // namespace asdx
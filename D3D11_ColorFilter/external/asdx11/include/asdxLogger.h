@@ -9,6 +9,14 @@
 // Includes
 //-------------------------------------------------------------------------------------------------
 #include <cstdint>
+#include <cstdarg>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 
 namespace asdx {
@@ -35,6 +43,96 @@ enum class LogLevel : uint32_t
 };
 
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LogRecord structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  シンクに渡すログです.
+struct LogRecord
+{
+    LogLevel        Level;          //!< ログレベルです.
+    uint32_t        ThreadId;       //!< 出力したスレッドの ID です.
+    uint64_t        Time;           //!< 出力した時刻です (UNIX 時間, ナノ秒).
+    bool            Wide;           //!< 書式がワイド文字列かどうか.
+    const void*     pFormat;        //!< 書式です. Wide が true の場合は const wchar_t* です.
+    const uint8_t*  pArgs;          //!< PackLogArgs() でパックした引数です.
+    uint32_t        ArgSize;        //!< パックした引数のサイズです.
+    const char*     pText;          //!< 書式化した文字列です. RequireText() が true のシンクがない場合は nullptr です.
+    size_t          TextLength;     //!< 書式化した文字列の長さです.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ILogSink interface
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  ログの出力先です.
+//! @note   SystemLogger::Init() 後はロガースレッドから, それ以前は出力したスレッドから呼び出されます.
+//!         シンクの中でログを出力した場合, そのログは破棄されます.
+struct ILogSink
+{
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    virtual ~ILogSink()
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ログを出力します.
+    //!
+    //! @param[in]      record      出力するログです.
+    //---------------------------------------------------------------------------------------------
+    virtual void OnLog( const LogRecord& record ) = 0;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      まとめて出力した後に呼び出されます.
+    //---------------------------------------------------------------------------------------------
+    virtual void OnFlush()
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      書式化した文字列を必要とするかどうか.
+    //!
+    //! @note       必要とするシンクがない場合, ロガースレッドは書式化を省略します.
+    //---------------------------------------------------------------------------------------------
+    virtual bool RequireText() const
+    { return true; }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LogHistory structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  アプリ内表示用に保持しているログです.
+struct LogHistory
+{
+    uint64_t        Index;          //!< 通し番号です. 1 から始まります.
+    LogLevel        Level;          //!< ログレベルです.
+    uint32_t        ThreadId;       //!< 出力したスレッドの ID です.
+    uint64_t        Time;           //!< 出力した時刻です (UNIX 時間, ナノ秒).
+    std::string     Text;           //!< 書式化した文字列です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SystemLoggerDesc structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct SystemLoggerDesc
+{
+    uint32_t        QueueSize;      //!< キューのスロット数です. 2 のべき乗に切り上げます.
+    uint32_t        WaitTimeMsec;   //!< ロガースレッドがキューを確認する間隔です.
+    bool            EnableConsole;  //!< コンソールとデバッガに出力するかどうか.
+    std::string     FilePath;       //!< 出力するファイルパスです. 空の場合はファイルに出力しません.
+    uint32_t        HistoryCount;   //!< アプリ内表示用に保持するログ数です. 0 の場合は保持しません.
+
+    SystemLoggerDesc()
+    : QueueSize     ( 4096 )
+    , WaitTimeMsec  ( 10 )
+    , EnableConsole ( true )
+    , FilePath      ()
+    , HistoryCount  ( 512 )
+    { /* DO_NOTHING */ }
+};
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // ILogger interface
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -72,9 +170,23 @@ struct ILogger
 };
 
 
+//-------------------------------------------------------------------------------------------------
+// Forward Declarations.
+//-------------------------------------------------------------------------------------------------
+struct LogSlot;
+class  LogFileSink;
+class  LogHistorySink;
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // SystemLogger class
 ///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  システムロガーです.
+//! @note   Init() 後は, 出力したスレッドでは書式のポインタと引数をキューに格納するだけで戻ります.
+//!         書式化と出力はロガースレッドでまとめて行います. このため, 書式は文字列リテラルなど
+//!         ロガースレッドが処理するまで有効なものを渡す必要があります. 各マクロはこれを満たします.
+//!         キューが一杯の場合, 警告とエラーは空くまで待機し, それ以外は破棄して件数を記録します.
+//!         Init() 前および Term() 後は, 出力したスレッドでコンソールに出力します.
 class SystemLogger : public ILogger
 {
     //=============================================================================================
@@ -99,6 +211,59 @@ public:
     //---------------------------------------------------------------------------------------------
     static SystemLogger& GetInstance();
 
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化処理を行います. ロガースレッドを起動します.
+    //!
+    //! @param[in]      desc        構成設定です.
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool Init( const SystemLoggerDesc& desc = SystemLoggerDesc() );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      終了処理を行います. キューに残ったログを全て出力してからロガースレッドを終了します.
+    //!
+    //! @note       他のスレッドがログを出力しなくなってから呼び出してください.
+    //---------------------------------------------------------------------------------------------
+    void Term();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化済みかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool IsInit() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      呼び出し時点までに出力したログが, 全てのシンクに出力されるまで待機します.
+    //---------------------------------------------------------------------------------------------
+    void Flush();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      シンクを追加します.
+    //!
+    //! @param[in]      pSink       追加するシンクです. 削除するまで呼び出し側で保持する必要があります.
+    //---------------------------------------------------------------------------------------------
+    void AddSink( ILogSink* pSink );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      シンクを削除します. 戻った後はシンクが呼び出されることはありません.
+    //!
+    //! @param[in]      pSink       削除するシンクです.
+    //---------------------------------------------------------------------------------------------
+    void RemoveSink( ILogSink* pSink );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      アプリ内表示用に保持しているログを取得します.
+    //!
+    //! @param[out]     result      取得したログの追加先です. 古い順に追加します.
+    //! @param[in]      afterIndex  この通し番号より後のログのみを取得します.
+    //---------------------------------------------------------------------------------------------
+    void GetHistory( std::vector<LogHistory>& result, uint64_t afterIndex = 0 );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      キューが一杯のため破棄したログの数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint64_t GetDropCount() const;
+
     //---------------------------------------------------------------------------------------------
     //! @brief      ログを出力します.
     //!
@@ -145,34 +310,81 @@ private:
     //=============================================================================================
     // private variables.
     //=============================================================================================
-    static SystemLogger     s_Instance;     //!< シングルトンインスタンスです.
-    LogLevel                m_Filter;       //!< フィルターです.
+    static SystemLogger                          s_Instance;         //!< シングルトンインスタンスです.
+    LogLevel                                     m_Filter;           //!< フィルターです.
+    LogSlot*                                     m_pSlots;           //!< キューのスロットです.
+    uint32_t                                     m_SlotCount;        //!< スロット数です.
+    uint32_t                                     m_WaitTimeMsec;     //!< キューを確認する間隔です.
+    std::atomic<uint64_t>                        m_Head;             //!< 次に書き込む位置です.
+    std::atomic<uint64_t>                        m_Tail;             //!< 次に読み込む位置です.
+    std::atomic<uint64_t>                        m_DropCount;        //!< 未報告の破棄したログ数です.
+    std::atomic<uint64_t>                        m_DropTotal;        //!< 破棄したログの合計です.
+    std::atomic<bool>                            m_Running;          //!< ロガースレッドが動作中かどうか.
+    bool                                         m_Stop;             //!< 終了要求です.
+    std::thread                                  m_Thread;           //!< ロガースレッドです.
+    std::mutex                                   m_Mutex;            //!< 待機用のミューテックスです.
+    std::condition_variable                      m_WakeCond;         //!< ロガースレッドを起こす条件変数です.
+    std::condition_variable                      m_DoneCond;         //!< 出力の完了を通知する条件変数です.
+    std::mutex                                   m_SinkMutex;        //!< シンクを保護するミューテックスです.
+    ILogSink*                                    m_pConsoleSink;     //!< コンソールシンクです.
+    LogFileSink*                                 m_pFileSink;        //!< ファイルシンクです.
+    LogHistorySink*                              m_pHistorySink;     //!< アプリ内表示用のシンクです.
+    std::vector<ILogSink*>                       m_Sinks;            //!< 追加されたシンクです.
+    std::unordered_map<const void*, std::string> m_WideFormats;      //!< 変換済みのワイド文字列の書式です.
+    std::string                                  m_Text;             //!< 書式化用のバッファです.
 
     //=============================================================================================
     // private methods.
     //=============================================================================================
     SystemLogger();
+    ~SystemLogger();
     SystemLogger             (const SystemLogger&) = delete;
     SystemLogger& operator = (const SystemLogger&) = delete;
+
+    void Enqueue    ( LogLevel level, const void* pFormat, bool wide, va_list args );
+    void Run        ();
+    bool Drain      ();
+    void Dispatch   ( LogSlot& slot );
+    void FlushSinks ();
 };
 
 
 } // namespace asdx
 
 
+//-------------------------------------------------------------------------------------------------
+// Log Levels
+//-------------------------------------------------------------------------------------------------
+#define ASDX_LOG_LEVEL_VERBOSE      0       // LogLevel::Verbose
+#define ASDX_LOG_LEVEL_INFO         1       // LogLevel::Info
+#define ASDX_LOG_LEVEL_DEBUG        2       // LogLevel::Debug
+#define ASDX_LOG_LEVEL_WARNING      3       // LogLevel::Warning
+#define ASDX_LOG_LEVEL_ERROR        4       // LogLevel::Error
+#define ASDX_LOG_LEVEL_NONE         5       // 全て取り除きます.
+
+//-------------------------------------------------------------------------------------------------
+// コンパイル時の最小ログレベルです. これより低いレベルのマクロは ((void)0) に置き換わり,
+// 引数も評価されません. 例えば /D ASDX_LOG_MIN_LEVEL=3 で警告とエラーのみを残します.
+// DLOGA, DLOGW はこれに加えて DEBUG, _DEBUG が未定義の場合にも取り除かれます.
+//-------------------------------------------------------------------------------------------------
+#ifndef ASDX_LOG_MIN_LEVEL
+#define ASDX_LOG_MIN_LEVEL          ASDX_LOG_LEVEL_VERBOSE
+#endif//ASDX_LOG_MIN_LEVEL
+
+
 //-------------------------------------------------------------------------------------------------
 // Macros
 //-------------------------------------------------------------------------------------------------
 #ifndef DLOGA
-  #if defined(DEBUG) || defined(_DEBUG)
-    #define DLOGA( fmt, ... )      asdx::SystemLogger::GetInstance().LogA( asdx::LogLevel::Debug, "[File: %s, Line: %d] "fmt"\n", __FILE__, __LINE__, ##__VA_ARGS__ )
+  #if (defined(DEBUG) || defined(_DEBUG)) && (ASDX_LOG_MIN_LEVEL <= ASDX_LOG_LEVEL_DEBUG)
+    #define DLOGA( fmt, ... )      asdx::SystemLogger::GetInstance().LogA( asdx::LogLevel::Debug, "[File: %s, Line: %d] " fmt "\n", __FILE__, __LINE__, ##__VA_ARGS__ )
   #else
     #define DLOGA( fmt, ... )      ((void)0)
   #endif//defined(DEBUG) || defined(_DEBUG)
 #endif//DLOGA
 
 #ifndef DLOGW
-  #if defined(DEBUG) || defined(_DEBUG)
+  #if (defined(DEBUG) || defined(_DEBUG)) && (ASDX_LOG_MIN_LEVEL <= ASDX_LOG_LEVEL_DEBUG)
     #define DLOGW( fmt, ... )      asdx::SystemLogger::GetInstance().LogW( asdx::LogLevel::Debug, ASDX_WIDE("[File: %s, Line: %d] ") ASDX_WIDE(fmt) ASDX_WIDE("\n"), ASDX_WIDE(__FILE__), __LINE__, ##__VA_ARGS__ )
   #else
     #define DLOGW( fmt, ... )      ((void)0)
@@ -181,35 +393,67 @@ private:
 
 
 #ifndef VLOGA
-#define VLOGA( fmt, ... )      asdx::SystemLogger::GetInstance().LogA( asdx::LogLevel::Verbose, fmt "\n", ##__VA_ARGS__ )
+  #if ASDX_LOG_MIN_LEVEL <= ASDX_LOG_LEVEL_VERBOSE
+    #define VLOGA( fmt, ... )      asdx::SystemLogger::GetInstance().LogA( asdx::LogLevel::Verbose, fmt "\n", ##__VA_ARGS__ )
+  #else
+    #define VLOGA( fmt, ... )      ((void)0)
+  #endif
 #endif//VLOGA
 
 #ifndef VLOGW
-#define VLOGW( fmt, ... )      asdx::SystemLogger::GetInstance().LogW( asdx::LogLevel::Verbose, ASDX_WIDE(fmt) ASDX_WIDE("\n"), ##__VA_ARGS__ )
+  #if ASDX_LOG_MIN_LEVEL <= ASDX_LOG_LEVEL_VERBOSE
+    #define VLOGW( fmt, ... )      asdx::SystemLogger::GetInstance().LogW( asdx::LogLevel::Verbose, ASDX_WIDE(fmt) ASDX_WIDE("\n"), ##__VA_ARGS__ )
+  #else
+    #define VLOGW( fmt, ... )      ((void)0)
+  #endif
 #endif//VLOGW
 
 #ifndef ILOGA
-#define ILOGA( fmt, ... )      asdx::SystemLogger::GetInstance().LogA( asdx::LogLevel::Info, fmt "\n", ##__VA_ARGS__ )
+  #if ASDX_LOG_MIN_LEVEL <= ASDX_LOG_LEVEL_INFO
+    #define ILOGA( fmt, ... )      asdx::SystemLogger::GetInstance().LogA( asdx::LogLevel::Info, fmt "\n", ##__VA_ARGS__ )
+  #else
+    #define ILOGA( fmt, ... )      ((void)0)
+  #endif
 #endif//ILOGA
 
 #ifndef ILOGW
-#define ILOGW( fmt, ... )      asdx::SystemLogger::GetInstance().LogW( asdx::LogLevel::Info, ASDX_WIDE(fmt) ASDX_WIDE("\n"), ##__VA_ARGS__ );
+  #if ASDX_LOG_MIN_LEVEL <= ASDX_LOG_LEVEL_INFO
+    #define ILOGW( fmt, ... )      asdx::SystemLogger::GetInstance().LogW( asdx::LogLevel::Info, ASDX_WIDE(fmt) ASDX_WIDE("\n"), ##__VA_ARGS__ )
+  #else
+    #define ILOGW( fmt, ... )      ((void)0)
+  #endif
 #endif//ILOGW
 
 #ifndef WLOGA
-#define WLOGA( fmt, ... )       asdx::SystemLogger::GetInstance().LogA( asdx::LogLevel::Warning, fmt "\n", ##__VA_ARGS__ )
+  #if ASDX_LOG_MIN_LEVEL <= ASDX_LOG_LEVEL_WARNING
+    #define WLOGA( fmt, ... )      asdx::SystemLogger::GetInstance().LogA( asdx::LogLevel::Warning, fmt "\n", ##__VA_ARGS__ )
+  #else
+    #define WLOGA( fmt, ... )      ((void)0)
+  #endif
 #endif//WLOGA
 
 #ifndef WLOGW
-#define WLOGW( fmt, ... )       asdx::SystemLogger::GetInstance().LogW( asdx::LogLevel::Warning, ASDX_WIDE(fmt) ASDX_WIDE("\n"), ##__VA_ARGS__ )
+  #if ASDX_LOG_MIN_LEVEL <= ASDX_LOG_LEVEL_WARNING
+    #define WLOGW( fmt, ... )      asdx::SystemLogger::GetInstance().LogW( asdx::LogLevel::Warning, ASDX_WIDE(fmt) ASDX_WIDE("\n"), ##__VA_ARGS__ )
+  #else
+    #define WLOGW( fmt, ... )      ((void)0)
+  #endif
 #endif//WLOGW
 
 #ifndef ELOGA
-#define ELOGA( fmt, ... )      asdx::SystemLogger::GetInstance().LogA( asdx::LogLevel::Error, "[File: %s, Line: %d] " fmt "\n", __FILE__, __LINE__, ##__VA_ARGS__ )
+  #if ASDX_LOG_MIN_LEVEL <= ASDX_LOG_LEVEL_ERROR
+    #define ELOGA( fmt, ... )      asdx::SystemLogger::GetInstance().LogA( asdx::LogLevel::Error, "[File: %s, Line: %d] " fmt "\n", __FILE__, __LINE__, ##__VA_ARGS__ )
+  #else
+    #define ELOGA( fmt, ... )      ((void)0)
+  #endif
 #endif//ELOGA
 
 #ifndef ELOGW
-#define ELOGW( fmt, ... )      asdx::SystemLogger::GetInstance().LogW( asdx::LogLevel::Error, ASDX_WIDE("[File: %s, Line: %d] ") ASDX_WIDE(fmt) ASDX_WIDE("\n"), ASDX_WIDE(__FILE__), __LINE__, ##__VA_ARGS__ )
+  #if ASDX_LOG_MIN_LEVEL <= ASDX_LOG_LEVEL_ERROR
+    #define ELOGW( fmt, ... )      asdx::SystemLogger::GetInstance().LogW( asdx::LogLevel::Error, ASDX_WIDE("[File: %s, Line: %d] ") ASDX_WIDE(fmt) ASDX_WIDE("\n"), ASDX_WIDE(__FILE__), __LINE__, ##__VA_ARGS__ )
+  #else
+    #define ELOGW( fmt, ... )      ((void)0)
+  #endif
 #endif//ELOGW
 
 #if defined(UNICODE) || defined(_UNICODE)
@@ -9,7 +9,12 @@
 // Includes
 //-------------------------------------------------------------------------------------------------
 #include <list>
-#include <algorithm>
+#include <unordered_map>
+#include <functional>
+#include <tuple>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
 
 
 namespace asdx {
@@ -17,7 +22,7 @@ namespace asdx {
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // LruCache class
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-template<typename T>
+template<typename T, typename THash = std::hash<T>>
 class LruCache
 {
     //=============================================================================================
@@ -73,6 +78,8 @@ public:
 
     //---------------------------------------------------------------------------------------------
     //! @brief     配列にコピーします.
+    //!
+    //! @note       最も古い要素から順に格納します.
     //---------------------------------------------------------------------------------------------
     void Copy(T* pArray, size_t offset) const;
 
@@ -93,14 +100,14 @@ public:
     //---------------------------------------------------------------------------------------------
     //! @brief      先頭要素を取得します.
     //!
-    //! @return     先頭要素を返却します.
+    //! @return     最も長く使用されていない要素を返却します.
     //---------------------------------------------------------------------------------------------
     T GetFront() const;
 
     //---------------------------------------------------------------------------------------------
     //! @brief      末尾要素を取得します.
     //!
-    //! @return     末尾要素を取得します.
+    //! @return     最後に追加された要素を返却します.
     //---------------------------------------------------------------------------------------------
     T GetBack() const;
 
@@ -108,13 +115,237 @@ private:
     //=============================================================================================
     // private variables.
     //=============================================================================================
+    using List  = std::list<T>;
+    using Index = std::unordered_map<T, typename List::iterator, THash>;
+
     size_t          m_Capacity;     //!< 最大収容可能数.
-    std::list<T>    m_Cache;        //!< キャッシュです.
+    List            m_Cache;        //!< キャッシュです.
+    Index           m_Index;        //!< リストの位置を引くための索引です.
 
     //=============================================================================================
     // private methods.
     //=============================================================================================
+    LruCache                (const LruCache&) = delete;
+    LruCache& operator =    (const LruCache&) = delete;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LruMap class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename TKey, typename TValue, typename THash = std::hash<TKey>>
+class LruMap
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
     /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリがキャッシュから取り除かれる際に呼び出されるコールバックです.
+    //!
+    //! @note       コールバック内からキャッシュを操作してはいけません.
+    //---------------------------------------------------------------------------------------------
+    using EvictCallback = std::function<void(const TKey& key, TValue& value)>;
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //!
+    //! @param[in]      capacity    容量です. Put() で重みを省略した場合はエントリ数になります.
+    //---------------------------------------------------------------------------------------------
+    LruMap(size_t capacity);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~LruMap();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      追い出し時のコールバックを設定します.
+    //!
+    //! @param[in]      callback    コールバックです.
+    //---------------------------------------------------------------------------------------------
+    void SetEvictCallback(EvictCallback callback);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリを追加または更新します.
+    //!
+    //! @param[in]      key         キーです.
+    //! @param[in]      value       値です.
+    //! @param[in]      weight      重み(バイト数など)です.
+    //! @retval true    追加に成功.
+    //! @retval false   重みが容量を超える, またはピン留めされたエントリで容量が埋まっていて追加できません.
+    //! @note       容量を超える場合は最も長く使用されていないエントリから追い出します.
+    //!             更新時は古い値に対してコールバックを呼び出します.
+    //---------------------------------------------------------------------------------------------
+    bool Put(const TKey& key, const TValue& value, size_t weight = 1);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリを追加または更新します.
+    //---------------------------------------------------------------------------------------------
+    bool Put(const TKey& key, TValue&& value, size_t weight = 1);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      値を取得し, 最近使用したエントリとして扱います.
+    //!
+    //! @param[in]      key         キーです.
+    //! @return     値へのポインタを返却します. 見つからない場合は nullptr を返却します.
+    //! @note       ピン留めされていない値へのポインタは次の Put() で無効になる可能性があります.
+    //---------------------------------------------------------------------------------------------
+    TValue* Get(const TKey& key);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      使用順序を変更せずに値を取得します.
+    //!
+    //! @param[in]      key         キーです.
+    //! @return     値へのポインタを返却します. 見つからない場合は nullptr を返却します.
+    //---------------------------------------------------------------------------------------------
+    const TValue* Peek(const TKey& key) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリが含まれているか判定します.
+    //---------------------------------------------------------------------------------------------
+    bool Contains(const TKey& key) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリをピン留めし, 追い出しの対象から外します.
+    //!
+    //! @param[in]      key         キーです.
+    //! @return     値へのポインタを返却します. 見つからない場合は nullptr を返却します.
+    //! @note       Pin() と Unpin() は同じ回数呼び出す必要があります.
+    //---------------------------------------------------------------------------------------------
+    TValue* Pin(const TKey& key);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリのピン留めを解除します.
+    //!
+    //! @param[in]      key         キーです.
+    //! @retval true    解除に成功.
+    //! @retval false   エントリが存在しないか, ピン留めされていません.
+    //---------------------------------------------------------------------------------------------
+    bool Unpin(const TKey& key);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリを削除します.
+    //!
+    //! @param[in]      key         キーです.
+    //! @retval true    削除に成功.
+    //! @retval false   エントリが存在しないか, ピン留めされています.
+    //---------------------------------------------------------------------------------------------
+    bool Remove(const TKey& key);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ピン留めされたエントリも含めて全エントリを削除します.
+    //---------------------------------------------------------------------------------------------
+    void Clear();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      容量を設定します.
+    //!
+    //! @note       容量を超えている場合はその場で追い出します.
+    //---------------------------------------------------------------------------------------------
+    void SetCapacity(size_t capacity);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリ数に合わせてハッシュテーブルを予約します.
+    //---------------------------------------------------------------------------------------------
+    void Reserve(size_t count);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      容量を取得します.
+    //---------------------------------------------------------------------------------------------
+    size_t GetCapacity() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      現在の重みの合計を取得します.
+    //---------------------------------------------------------------------------------------------
+    size_t GetWeight() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      現在のエントリ数を取得します.
+    //---------------------------------------------------------------------------------------------
+    size_t GetCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      Get() でヒットした回数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint64_t GetHitCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      Get() でヒットしなかった回数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint64_t GetMissCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      追い出したエントリ数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint64_t GetEvictCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      統計情報をリセットします.
+    //---------------------------------------------------------------------------------------------
+    void ResetStats();
+
+private:
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Node structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Node
+    {
+        TValue          Value;      //!< 値です.
+        size_t          Weight;     //!< 重みです.
+        uint32_t        PinCount;   //!< ピン留めの参照数です.
+        Node*           pPrev;      //!< 最近使用した側のノードです.
+        Node*           pNext;      //!< 使用していない側のノードです.
+        const TKey*     pKey;       //!< ハッシュテーブル内のキーです.
+
+        template<typename V>
+        Node(V&& value, size_t weight)
+        : Value     (std::forward<V>(value))
+        , Weight    (weight)
+        , PinCount  (0)
+        , pPrev     (nullptr)
+        , pNext     (nullptr)
+        , pKey      (nullptr)
+        { /* DO_NOTHING */ }
+    };
+
+    using Table = std::unordered_map<TKey, Node, THash>;
+
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    size_t          m_Capacity;     //!< 容量です.
+    size_t          m_Weight;       //!< 重みの合計です.
+    Table           m_Table;        //!< ハッシュテーブルです. ノードのアドレスは再ハッシュでも変わりません.
+    Node*           m_pHead;        //!< 最近使用したノードです.
+    Node*           m_pTail;        //!< 最も長く使用されていないノードです.
+    EvictCallback   m_OnEvict;      //!< 追い出し時のコールバックです.
+    uint64_t        m_HitCount;     //!< ヒット数です.
+    uint64_t        m_MissCount;    //!< ミス数です.
+    uint64_t        m_EvictCount;   //!< 追い出し数です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    LruMap              (const LruMap&) = delete;
+    LruMap& operator =  (const LruMap&) = delete;
+
+    template<typename V>
+    bool PutInternal(const TKey& key, V&& value, size_t weight);
+
+    void LinkFront(Node* pNode);
+    void Unlink   (Node* pNode);
+    void EvictTo  (size_t limit, const Node* pKeep);
 };
 
 } // namespace asdx
@@ -15,69 +15,85 @@ namespace asdx {
 //-------------------------------------------------------------------------------------------------
 //      コンストラクタです.
 //-------------------------------------------------------------------------------------------------
-template<typename T> inline
-LruCache<T>::LruCache(size_t capacity)
-: m_Cache()
-, m_Capacity(capacity)
-{ /* DO_NOTHING */ }
+template<typename T, typename THash> inline
+LruCache<T, THash>::LruCache(size_t capacity)
+: m_Capacity(capacity)
+, m_Cache()
+, m_Index()
+{ m_Index.reserve(capacity); }
 
 //-------------------------------------------------------------------------------------------------
 //      デストラクタです.
 //-------------------------------------------------------------------------------------------------
-template<typename T> inline
-LruCache<T>::~LruCache()
+template<typename T, typename THash> inline
+LruCache<T, THash>::~LruCache()
 { Clear(); }
 
 //-------------------------------------------------------------------------------------------------
 //      要素を追加します.
 //-------------------------------------------------------------------------------------------------
-template<typename T> inline
-void LruCache<T>::Add(const T& item)
+template<typename T, typename THash> inline
+void LruCache<T, THash>::Add(const T& item)
 {
-    if ( Contains(item) )
-    {
-        m_Cache.remove(item);
-        m_Cache.push_back(item);
-    }
-    else if ( m_Cache.size() < m_Capacity )
+    auto itr = m_Index.find(item);
+    if ( itr != m_Index.end() )
     {
-        m_Cache.push_back(item);
+        // ノードを付け替えるだけなので確保は発生しない.
+        m_Cache.splice(m_Cache.end(), m_Cache, itr->second);
+        return;
     }
-    else
+
+    if ( m_Capacity == 0 )
+    { return; }
+
+    if ( m_Cache.size() >= m_Capacity )
     {
+        m_Index.erase(m_Cache.front());
         m_Cache.pop_front();
-        m_Cache.push_back(item);
     }
+
+    m_Cache.push_back(item);
+    m_Index.emplace(item, std::prev(m_Cache.end()));
 }
 
 //-------------------------------------------------------------------------------------------------
 //      要素を削除します.
 //-------------------------------------------------------------------------------------------------
-template<typename T> inline
-void LruCache<T>::Remove(const T& item)
-{ m_Cache.remove(item); }
+template<typename T, typename THash> inline
+void LruCache<T, THash>::Remove(const T& item)
+{
+    auto itr = m_Index.find(item);
+    if ( itr == m_Index.end() )
+    { return; }
+
+    m_Cache.erase(itr->second);
+    m_Index.erase(itr);
+}
 
 //-------------------------------------------------------------------------------------------------
 //      全要素を削除します.
 //-------------------------------------------------------------------------------------------------
-template<typename T> inline
-void LruCache<T>::Clear()
-{ m_Cache.clear(); }
+template<typename T, typename THash> inline
+void LruCache<T, THash>::Clear()
+{
+    m_Cache.clear();
+    m_Index.clear();
+}
 
 //-------------------------------------------------------------------------------------------------
 //      要素が含まれているか判定します.
 //-------------------------------------------------------------------------------------------------
-template<typename T> inline
-bool LruCache<T>::Contains(const T& item) const
-{ return std::find(m_Cache.cbegin(), m_Cache.cend(), item) != m_Cache.cend(); }
+template<typename T, typename THash> inline
+bool LruCache<T, THash>::Contains(const T& item) const
+{ return m_Index.find(item) != m_Index.cend(); }
 
 //-------------------------------------------------------------------------------------------------
 //      配列にコピーします.
 //-------------------------------------------------------------------------------------------------
-template<typename T> inline
-void LruCache<T>::Copy(T* pArray, size_t offset) const
+template<typename T, typename THash> inline
+void LruCache<T, THash>::Copy(T* pArray, size_t offset) const
 {
-    for( auto& itr = m_Cache.cbegin(); itr != m_Cache.cend(); itr++ )
+    for( auto itr = m_Cache.cbegin(); itr != m_Cache.cend(); itr++ )
     {
         pArray[offset] = *itr;
         offset++;
@@ -87,23 +103,377 @@ void LruCache<T>::Copy(T* pArray, size_t offset) const
 //-------------------------------------------------------------------------------------------------
 //      最大収容可能数を取得します.
 //-------------------------------------------------------------------------------------------------
-template<typename T> inline
-size_t LruCache<T>::GetCapacity() const
+template<typename T, typename THash> inline
+size_t LruCache<T, THash>::GetCapacity() const
 { return m_Capacity; }
 
 //-------------------------------------------------------------------------------------------------
 //      現在の収容数を取得します.
-//--------------------------------------------------------------------------------------------------
-template<typename T> inline
-size_t LruCache<T>::GetCount() const
+//-------------------------------------------------------------------------------------------------
+template<typename T, typename THash> inline
+size_t LruCache<T, THash>::GetCount() const
 { return m_Cache.size(); }
 
-template<typename T> inline
-T LruCache<T>::GetFront() const
-{ return *m_Cache.cend(); }
+//-------------------------------------------------------------------------------------------------
+//      先頭要素を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename T, typename THash> inline
+T LruCache<T, THash>::GetFront() const
+{ return m_Cache.front(); }
+
+//-------------------------------------------------------------------------------------------------
+//      末尾要素を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename T, typename THash> inline
+T LruCache<T, THash>::GetBack() const
+{ return m_Cache.back(); }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LruMap class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+LruMap<TKey, TValue, THash>::LruMap(size_t capacity)
+: m_Capacity    (capacity)
+, m_Weight      (0)
+, m_Table       ()
+, m_pHead       (nullptr)
+, m_pTail       (nullptr)
+, m_OnEvict     ()
+, m_HitCount    (0)
+, m_MissCount   (0)
+, m_EvictCount  (0)
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+LruMap<TKey, TValue, THash>::~LruMap()
+{ Clear(); }
+
+//-------------------------------------------------------------------------------------------------
+//      追い出し時のコールバックを設定します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LruMap<TKey, TValue, THash>::SetEvictCallback(EvictCallback callback)
+{ m_OnEvict = std::move(callback); }
+
+//-------------------------------------------------------------------------------------------------
+//      エントリを追加または更新します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+bool LruMap<TKey, TValue, THash>::Put(const TKey& key, const TValue& value, size_t weight)
+{ return PutInternal(key, value, weight); }
+
+//-------------------------------------------------------------------------------------------------
+//      エントリを追加または更新します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+bool LruMap<TKey, TValue, THash>::Put(const TKey& key, TValue&& value, size_t weight)
+{ return PutInternal(key, std::move(value), weight); }
+
+//-------------------------------------------------------------------------------------------------
+//      エントリを追加または更新します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash>
+template<typename V> inline
+bool LruMap<TKey, TValue, THash>::PutInternal(const TKey& key, V&& value, size_t weight)
+{
+    if ( weight > m_Capacity )
+    { return false; }
+
+    auto itr = m_Table.find(key);
+    if ( itr != m_Table.end() )
+    {
+        auto pNode = &itr->second;
+        if ( m_OnEvict )
+        { m_OnEvict(*pNode->pKey, pNode->Value); }
+
+        pNode->Value = std::forward<V>(value);
+        m_Weight    -= pNode->Weight;
+        m_Weight    += weight;
+        pNode->Weight = weight;
+
+        if ( pNode->PinCount == 0 )
+        {
+            Unlink(pNode);
+            LinkFront(pNode);
+        }
+
+        EvictTo(m_Capacity, pNode);
+        return true;
+    }
+
+    EvictTo(m_Capacity - weight, nullptr);
+    if ( m_Weight + weight > m_Capacity )
+    { return false; }
+
+    auto result = m_Table.emplace(
+        std::piecewise_construct,
+        std::forward_as_tuple(key),
+        std::forward_as_tuple(std::forward<V>(value), weight));
+
+    auto pNode  = &result.first->second;
+    pNode->pKey = &result.first->first;
+    m_Weight   += weight;
+    LinkFront(pNode);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      値を取得し, 最近使用したエントリとして扱います.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+TValue* LruMap<TKey, TValue, THash>::Get(const TKey& key)
+{
+    auto itr = m_Table.find(key);
+    if ( itr == m_Table.end() )
+    {
+        m_MissCount++;
+        return nullptr;
+    }
+
+    m_HitCount++;
+
+    auto pNode = &itr->second;
+    if ( pNode->PinCount == 0 && pNode != m_pHead )
+    {
+        Unlink(pNode);
+        LinkFront(pNode);
+    }
+
+    return &pNode->Value;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      使用順序を変更せずに値を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+const TValue* LruMap<TKey, TValue, THash>::Peek(const TKey& key) const
+{
+    auto itr = m_Table.find(key);
+    return ( itr != m_Table.cend() ) ? &itr->second.Value : nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      エントリが含まれているか判定します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+bool LruMap<TKey, TValue, THash>::Contains(const TKey& key) const
+{ return m_Table.find(key) != m_Table.cend(); }
+
+//-------------------------------------------------------------------------------------------------
+//      エントリをピン留めします.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+TValue* LruMap<TKey, TValue, THash>::Pin(const TKey& key)
+{
+    auto itr = m_Table.find(key);
+    if ( itr == m_Table.end() )
+    { return nullptr; }
+
+    // ピン留め中はリストから外し, 追い出しの走査対象にしない.
+    auto pNode = &itr->second;
+    if ( pNode->PinCount == 0 )
+    { Unlink(pNode); }
+
+    pNode->PinCount++;
+    return &pNode->Value;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      エントリのピン留めを解除します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+bool LruMap<TKey, TValue, THash>::Unpin(const TKey& key)
+{
+    auto itr = m_Table.find(key);
+    if ( itr == m_Table.end() || itr->second.PinCount == 0 )
+    { return false; }
+
+    auto pNode = &itr->second;
+    pNode->PinCount--;
+    if ( pNode->PinCount == 0 )
+    {
+        LinkFront(pNode);
+        EvictTo(m_Capacity, pNode);
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      エントリを削除します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+bool LruMap<TKey, TValue, THash>::Remove(const TKey& key)
+{
+    auto itr = m_Table.find(key);
+    if ( itr == m_Table.end() || itr->second.PinCount != 0 )
+    { return false; }
+
+    auto pNode = &itr->second;
+    Unlink(pNode);
+
+    if ( m_OnEvict )
+    { m_OnEvict(itr->first, pNode->Value); }
+
+    m_Weight -= pNode->Weight;
+    m_Table.erase(itr);
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      全エントリを削除します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LruMap<TKey, TValue, THash>::Clear()
+{
+    if ( m_OnEvict )
+    {
+        for( auto& itr : m_Table )
+        { m_OnEvict(itr.first, itr.second.Value); }
+    }
+
+    m_Table.clear();
+    m_Weight = 0;
+    m_pHead  = nullptr;
+    m_pTail  = nullptr;
+}
 
-template<typename T> inline
-T LruCache<T>::GetBack() const
-{ return *m_Cache.cbegin();}
+//-------------------------------------------------------------------------------------------------
+//      容量を設定します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LruMap<TKey, TValue, THash>::SetCapacity(size_t capacity)
+{
+    m_Capacity = capacity;
+    EvictTo(m_Capacity, nullptr);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ハッシュテーブルを予約します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LruMap<TKey, TValue, THash>::Reserve(size_t count)
+{ m_Table.reserve(count); }
+
+//-------------------------------------------------------------------------------------------------
+//      容量を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+size_t LruMap<TKey, TValue, THash>::GetCapacity() const
+{ return m_Capacity; }
+
+//-------------------------------------------------------------------------------------------------
+//      現在の重みの合計を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+size_t LruMap<TKey, TValue, THash>::GetWeight() const
+{ return m_Weight; }
+
+//-------------------------------------------------------------------------------------------------
+//      現在のエントリ数を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+size_t LruMap<TKey, TValue, THash>::GetCount() const
+{ return m_Table.size(); }
+
+//-------------------------------------------------------------------------------------------------
+//      ヒット数を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+uint64_t LruMap<TKey, TValue, THash>::GetHitCount() const
+{ return m_HitCount; }
+
+//-------------------------------------------------------------------------------------------------
+//      ミス数を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+uint64_t LruMap<TKey, TValue, THash>::GetMissCount() const
+{ return m_MissCount; }
+
+//-------------------------------------------------------------------------------------------------
+//      追い出し数を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+uint64_t LruMap<TKey, TValue, THash>::GetEvictCount() const
+{ return m_EvictCount; }
+
+//-------------------------------------------------------------------------------------------------
+//      統計情報をリセットします.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LruMap<TKey, TValue, THash>::ResetStats()
+{
+    m_HitCount   = 0;
+    m_MissCount  = 0;
+    m_EvictCount = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ノードをリストの先頭に繋ぎます.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LruMap<TKey, TValue, THash>::LinkFront(Node* pNode)
+{
+    pNode->pPrev = nullptr;
+    pNode->pNext = m_pHead;
+
+    if ( m_pHead != nullptr )
+    { m_pHead->pPrev = pNode; }
+    else
+    { m_pTail = pNode; }
+
+    m_pHead = pNode;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ノードをリストから外します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LruMap<TKey, TValue, THash>::Unlink(Node* pNode)
+{
+    if ( pNode->pPrev != nullptr )
+    { pNode->pPrev->pNext = pNode->pNext; }
+    else
+    { m_pHead = pNode->pNext; }
+
+    if ( pNode->pNext != nullptr )
+    { pNode->pNext->pPrev = pNode->pPrev; }
+    else
+    { m_pTail = pNode->pPrev; }
+
+    pNode->pPrev = nullptr;
+    pNode->pNext = nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      重みの合計が指定値以下になるまで追い出します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void LruMap<TKey, TValue, THash>::EvictTo(size_t limit, const Node* pKeep)
+{
+    while( m_Weight > limit && m_pTail != nullptr && m_pTail != pKeep )
+    {
+        auto pNode = m_pTail;
+        Unlink(pNode);
+
+        if ( m_OnEvict )
+        { m_OnEvict(*pNode->pKey, pNode->Value); }
+
+        m_Weight -= pNode->Weight;
+        m_EvictCount++;
+
+        // キーは消去対象のノード内を指すため, イテレータで消去する.
+        m_Table.erase(m_Table.find(*pNode->pKey));
+    }
+}
 
 } // namespace asdx
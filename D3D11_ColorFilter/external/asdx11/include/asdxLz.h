@@ -0,0 +1,50 @@
+//-------------------------------------------------------------------------------------------------
+// File : asdxLz.h
+// Desc : Fast LZ Codec.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <cstddef>
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      圧縮後の最大サイズを取得します.
+//!
+//! @param[in]      srcSize     入力サイズです.
+//! @return     圧縮後の最大サイズを返却します.
+//-------------------------------------------------------------------------------------------------
+size_t LzCompressBound( size_t srcSize );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      LZ4 ブロック形式で圧縮します.
+//!
+//! @param[in]      pSrc        入力データです.
+//! @param[in]      srcSize     入力サイズです.
+//! @param[out]     pDst        出力先です.
+//! @param[in]      dstCapacity 出力先のサイズです.
+//! @return     圧縮後のサイズを返却します. 出力先に収まらない場合は 0 を返却します.
+//! @note       出力先のサイズを LzCompressBound() 以上にすると必ず成功します.
+//-------------------------------------------------------------------------------------------------
+size_t LzCompress( const uint8_t* pSrc, size_t srcSize, uint8_t* pDst, size_t dstCapacity );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      LZ4 ブロック形式のデータを展開します.
+//!
+//! @param[in]      pSrc        圧縮データです.
+//! @param[in]      srcSize     圧縮データのサイズです.
+//! @param[out]     pDst        出力先です.
+//! @param[in]      dstSize     展開後のサイズです.
+//! @retval true    展開に成功.
+//! @retval false   データが破損している, または展開後のサイズが一致しない.
+//! @note       入力と出力の範囲外にはアクセスしないため, 破損したデータを渡しても安全です.
+//-------------------------------------------------------------------------------------------------
+bool LzDecompress( const uint8_t* pSrc, size_t srcSize, uint8_t* pDst, size_t dstSize );
+
+} // namespace asdx
@@ -0,0 +1,238 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxMemoryTracker.h
+// Desc : Tagged Memory Tracker.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+//-------------------------------------------------------------------------------------------------
+// ASDX_ENABLE_MEMORY_TRACKER を定義した場合のみ, 以下のマクロで確保と解放を記録します.
+// 未定義の場合はマクロが空になるため, 呼び出し側のオーバーヘッドはありません.
+//-------------------------------------------------------------------------------------------------
+#if defined(ASDX_ENABLE_MEMORY_TRACKER)
+    #define ASDX_TRACK_ALLOC( ptr, size, tag ) \
+        do { if ( asdx::MemoryTracker::IsEnabled() ) { asdx::MemoryTracker::GetInstance().OnAlloc( (ptr), (size), (tag), __FILE__, __LINE__ ); } } while( 0 )
+    #define ASDX_TRACK_FREE( ptr ) \
+        do { if ( asdx::MemoryTracker::IsEnabled() ) { asdx::MemoryTracker::GetInstance().OnFree( (ptr) ); } } while( 0 )
+    #define ASDX_TRACK_FAIL( size, tag ) \
+        do { if ( asdx::MemoryTracker::IsEnabled() ) { asdx::MemoryTracker::GetInstance().OnAllocFailed( (size), (tag), __FILE__, __LINE__ ); } } while( 0 )
+#else
+    #define ASDX_TRACK_ALLOC( ptr, size, tag )  ((void)0)
+    #define ASDX_TRACK_FREE( ptr )              ((void)0)
+    #define ASDX_TRACK_FAIL( size, tag )        ((void)0)
+#endif//defined(ASDX_ENABLE_MEMORY_TRACKER)
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// HEAP_TAG enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum HEAP_TAG
+{
+    HEAP_TAG_DEFAULT = 0,       //!< 未分類です.
+    HEAP_TAG_TEXTURE,           //!< テクスチャデータです.
+    HEAP_TAG_MESH,              //!< メッシュデータです.
+    HEAP_TAG_FONT,              //!< フォントデータです.
+    HEAP_TAG_SHADER,            //!< シェーダと定数バッファのデータです.
+    HEAP_TAG_GUI,               //!< GUI のデータです.
+    HEAP_TAG_TEMP,              //!< 一時バッファです.
+
+    HEAP_TAG_COUNT = 16,        //!< タグの最大数です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MemoryTagStats structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct MemoryTagStats
+{
+    size_t      LiveSize;       //!< 解放されていないメモリの合計サイズです.
+    size_t      PeakSize;       //!< LiveSize の最大値です.
+    uint64_t    LiveCount;      //!< 解放されていない確保の数です.
+    uint64_t    TotalCount;     //!< 累計の確保回数です.
+    uint64_t    FailCount;      //!< 確保に失敗した回数です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MemoryTracker class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  タグと呼び出し元ごとにメモリの確保状況を記録します.
+//! @note   記録は ASDX_TRACK_ALLOC / ASDX_TRACK_FREE / ASDX_TRACK_FAIL マクロから行います.
+//!         インスタンスは終了時の解放も記録できるよう破棄されません.
+class MemoryTracker
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    static const uint32_t kHistogramCount = 32;     //!< サイズ分布のビン数です (ビン i は 2^i 以上 2^(i+1) 未満).
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      シングルトンインスタンスを取得します.
+    //---------------------------------------------------------------------------------------------
+    static MemoryTracker& GetInstance();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      記録が有効かどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    static bool IsEnabled()
+    { return s_Enable.load( std::memory_order_relaxed ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      記録の有効/無効を設定します. デフォルトは有効です.
+    //---------------------------------------------------------------------------------------------
+    static void SetEnable( bool value );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      確保を記録します.
+    //!
+    //! @param[in]      ptr         確保したメモリです.
+    //! @param[in]      size        確保したサイズです.
+    //! @param[in]      tag         タグです.
+    //! @param[in]      file        呼び出し元のファイル名です. 文字列リテラルである必要があります.
+    //! @param[in]      line        呼び出し元の行番号です.
+    //---------------------------------------------------------------------------------------------
+    void OnAlloc( const void* ptr, size_t size, uint32_t tag, const char* file, int line );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      解放を記録します. 記録されていないポインタは無視します.
+    //!
+    //! @param[in]      ptr         解放するメモリです.
+    //---------------------------------------------------------------------------------------------
+    void OnFree( const void* ptr );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      確保の失敗を記録し, タグごとの使用状況をログに出力します.
+    //!
+    //! @param[in]      size        要求したサイズです.
+    //! @param[in]      tag         タグです.
+    //! @param[in]      file        呼び出し元のファイル名です. 文字列リテラルである必要があります.
+    //! @param[in]      line        呼び出し元の行番号です.
+    //---------------------------------------------------------------------------------------------
+    void OnAllocFailed( size_t size, uint32_t tag, const char* file, int line );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      タグごとの統計情報を取得します.
+    //---------------------------------------------------------------------------------------------
+    MemoryTagStats GetTagStats( uint32_t tag ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      記録内容を JSON 形式でファイルに出力します.
+    //!
+    //! @param[in]      path        出力ファイルパスです.
+    //! @retval true    出力に成功.
+    //! @retval false   出力に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool DumpJson( const char* path ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      解放されていないメモリを呼び出し元ごとにログへ出力します.
+    //!
+    //! @return     解放されていない確保の数を返却します.
+    //---------------------------------------------------------------------------------------------
+    uint64_t ReportLeaks() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      終了時に JSON の出力とリークレポートを行うよう設定します.
+    //!
+    //! @param[in]      path        JSON の出力ファイルパスです. nullptr の場合はリークレポートのみ行います.
+    //---------------------------------------------------------------------------------------------
+    void SetExitReport( const char* path );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全ての記録を破棄します.
+    //---------------------------------------------------------------------------------------------
+    void Reset();
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Callsite structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Callsite
+    {
+        const char* File;                           //!< ファイル名です.
+        int         Line;                           //!< 行番号です.
+        uint32_t    Tag;                            //!< タグです.
+        size_t      LiveSize;                       //!< 解放されていないメモリの合計サイズです.
+        uint64_t    LiveCount;                      //!< 解放されていない確保の数です.
+        uint64_t    TotalCount;                     //!< 累計の確保回数です.
+        uint64_t    Histogram[kHistogramCount];     //!< 確保サイズの分布です.
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // CallsiteKey structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct CallsiteKey
+    {
+        const char* File;           //!< ファイル名です.
+        int         Line;           //!< 行番号です.
+        uint32_t    Tag;            //!< タグです.
+
+        bool operator < ( const CallsiteKey& value ) const;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Record structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Record
+    {
+        size_t      Size;           //!< 確保したサイズです.
+        uint32_t    Callsite;       //!< 呼び出し元の番号です.
+    };
+
+    static std::atomic<bool>                    s_Enable;           //!< 記録が有効かどうか.
+    mutable std::mutex                          m_Lock;             //!< ロックです.
+    std::unordered_map<const void*, Record>     m_Records;          //!< 解放されていない確保です.
+    std::map<CallsiteKey, uint32_t>             m_CallsiteMap;      //!< 呼び出し元から番号への対応表です.
+    std::vector<Callsite>                       m_Callsites;        //!< 呼び出し元です.
+    MemoryTagStats                              m_TagStats[HEAP_TAG_COUNT]; //!< タグごとの統計情報です.
+    std::string                                 m_ExitPath;         //!< 終了時の JSON 出力先です.
+    bool                                        m_ExitReport;       //!< 終了時にレポートするかどうか.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    MemoryTracker ();
+    ~MemoryTracker() = delete;
+    MemoryTracker             ( const MemoryTracker& ) = delete;
+    MemoryTracker& operator = ( const MemoryTracker& ) = delete;
+
+    uint32_t    FindCallsite    ( const char* file, int line, uint32_t tag );
+    static void OnExit          ();
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      タグ名を取得します.
+//-------------------------------------------------------------------------------------------------
+const char* GetHeapTagName( uint32_t tag );
+
+} // namespace asdx
@@ -17,7 +17,7 @@ namespace asdx {
 // ParamHistory
 ///////////////////////////////////////////////////////////////////////////////
 template<typename T>
-class ParamHistory : public asdx::IHistory
+class ParamHistory : public asdx::IHistory, public asdx::PoolObject
 {
     //=========================================================================
     // list of friend classes and methods.
@@ -0,0 +1,342 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxPoolAllocator.h
+// Desc : Lock Free Fixed Size Pool Allocator.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <utility>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PoolStats structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct PoolStats
+{
+    size_t      BlockSize;      //!< ブロックサイズです.
+    uint32_t    SlabCount;      //!< 確保済みのスラブ数です.
+    uint64_t    Capacity;       //!< 確保済みのブロック数です.
+    uint64_t    InUse;          //!< プールから払い出されているブロック数です (スレッドキャッシュ分を含みます).
+    uint64_t    PeakInUse;      //!< InUse の最大値です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FixedPool class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  固定サイズブロックのプールです.
+//! @note   フリーリストはタグ付きインデックスの CAS で管理するため, Alloc() / Free() はロックフリーです.
+//!         スラブの追加時のみミューテックスを取得します.
+class FixedPool
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    FixedPool();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~FixedPool();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      blockSize       ブロックサイズです. 16 の倍数に切り上げられます.
+    //! @param[in]      slabSize        スラブサイズです. 2の累乗に切り上げられます.
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool Init( size_t blockSize, size_t slabSize = 64 * 1024 );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      終了処理を行います. 払い出し中のブロックも含めて全てのスラブを解放します.
+    //---------------------------------------------------------------------------------------------
+    void Term();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ブロックを確保します.
+    //!
+    //! @return     確保したブロックを返却します. 失敗した場合は nullptr を返却します.
+    //---------------------------------------------------------------------------------------------
+    void* Alloc();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ブロックを解放します.
+    //!
+    //! @param[in]      ptr         このプールから確保したブロックです.
+    //---------------------------------------------------------------------------------------------
+    void Free( void* ptr );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      複数のブロックを1回の CAS でまとめて確保します.
+    //!
+    //! @param[out]     ppBlocks    確保したブロックの格納先です.
+    //! @param[in]      count       確保する最大数です.
+    //! @return     確保できた数を返却します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t AllocBatch( void** ppBlocks, uint32_t count );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      複数のブロックを1回の CAS でまとめて解放します.
+    //!
+    //! @param[in]      ppBlocks    解放するブロックです.
+    //! @param[in]      count       ブロック数です.
+    //---------------------------------------------------------------------------------------------
+    void FreeBatch( void* const* ppBlocks, uint32_t count );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ブロックサイズを取得します.
+    //---------------------------------------------------------------------------------------------
+    size_t GetBlockSize() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      統計情報を取得します.
+    //---------------------------------------------------------------------------------------------
+    PoolStats GetStats() const;
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    static const uint32_t kMaxSlabCount = 1024;     //!< 最大スラブ数です.
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Slab structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Slab
+    {
+        uint32_t                Index;      //!< スラブ番号です.
+        std::atomic<uint32_t>*  pNext;      //!< ブロックごとの次リンク (インデックス + 1) です.
+        uint8_t*                pBlocks;    //!< ブロック領域の先頭です.
+    };
+
+    std::atomic<uint64_t>   m_Head;                     //!< フリーリストの先頭 (上位32bit:タグ, 下位32bit:インデックス + 1) です.
+    std::atomic<Slab*>      m_Slabs[kMaxSlabCount];     //!< スラブです.
+    std::atomic<uint32_t>   m_SlabCount;                //!< スラブ数です.
+    std::atomic<uint64_t>   m_InUse;                    //!< 払い出し中のブロック数です.
+    std::atomic<uint64_t>   m_PeakInUse;                //!< 払い出し中のブロック数の最大値です.
+    std::mutex              m_GrowLock;                 //!< スラブ追加を保護するロックです.
+    size_t                  m_BlockSize;                //!< ブロックサイズです.
+    size_t                  m_SlabSize;                 //!< スラブサイズです.
+    uint32_t                m_BlocksPerSlab;            //!< スラブあたりのブロック数です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    FixedPool             ( const FixedPool& ) = delete;
+    FixedPool& operator = ( const FixedPool& ) = delete;
+
+    bool                    Grow        ();
+    void                    Push        ( uint32_t first, uint32_t last );
+    std::atomic<uint32_t>&  GetNext     ( uint32_t index ) const;
+    void*                   GetBlock    ( uint32_t index ) const;
+    uint32_t                GetIndex    ( const void* ptr ) const;
+    void                    AddInUse    ( uint64_t count );
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PoolAllocator class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  サイズクラスごとの FixedPool にスレッドキャッシュを組み合わせた小さなオブジェクト用アロケータです.
+//! @note   kMaxSize を超える要求はグローバルの operator new に委譲します.
+class PoolAllocator
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    static const size_t     kMaxSize    = 256;  //!< プールで扱う最大サイズです.
+    static const uint32_t   kClassCount = 8;    //!< サイズクラス数です.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      シングルトンインスタンスを取得します.
+    //---------------------------------------------------------------------------------------------
+    static PoolAllocator& GetInstance();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      メモリを確保します.
+    //!
+    //! @param[in]      size        確保するサイズです.
+    //! @return     16byte アライメントのメモリを返却します. 失敗した場合は nullptr を返却します.
+    //---------------------------------------------------------------------------------------------
+    void* Alloc( size_t size );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      メモリを解放します.
+    //!
+    //! @param[in]      ptr         解放するメモリです.
+    //! @param[in]      size        確保時に指定したサイズです.
+    //---------------------------------------------------------------------------------------------
+    void Free( void* ptr, size_t size );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      呼び出しスレッドのキャッシュをプールに返却します.
+    //---------------------------------------------------------------------------------------------
+    void FlushThreadCache();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      サイズクラスの統計情報を取得します.
+    //!
+    //! @param[in]      classIndex      サイズクラス番号です.
+    //---------------------------------------------------------------------------------------------
+    PoolStats GetStats( uint32_t classIndex ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      kMaxSize を超えて operator new に委譲した回数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint64_t GetLargeAllocCount() const;
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    FixedPool               m_Pools[kClassCount];   //!< サイズクラスごとのプールです.
+    std::atomic<uint64_t>   m_LargeAllocCount;      //!< operator new に委譲した回数です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    PoolAllocator();
+    PoolAllocator             ( const PoolAllocator& ) = delete;
+    PoolAllocator& operator = ( const PoolAllocator& ) = delete;
+
+    static uint32_t GetClassIndex( size_t size );
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PoolObject class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  継承したクラスの new / delete を PoolAllocator 経由にします.
+//! @note   仮想デストラクタを持つ基底クラス経由で delete しても, 派生クラスのサイズで解放されます.
+class PoolObject
+{
+public:
+    static void* operator new( size_t size )
+    {
+        auto ptr = PoolAllocator::GetInstance().Alloc( size );
+        if ( ptr == nullptr )
+        { throw std::bad_alloc(); }
+        return ptr;
+    }
+
+    static void operator delete( void* ptr, size_t size )
+    { PoolAllocator::GetInstance().Free( ptr, size ); }
+
+    static void* operator new   [] ( size_t ) = delete;
+    static void  operator delete[] ( void* )  = delete;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ObjectPool class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  型ごとに専用の FixedPool を持つプールです.
+template<typename T>
+class ObjectPool
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    explicit ObjectPool( size_t slabSize = 64 * 1024 )
+    {
+        static_assert( alignof(T) <= 16, "ObjectPool supports up to 16 byte alignment." );
+        m_Pool.Init( sizeof(T), slabSize );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      オブジェクトを生成します.
+    //---------------------------------------------------------------------------------------------
+    template<typename... Args>
+    T* Create( Args&&... args )
+    {
+        auto ptr = m_Pool.Alloc();
+        if ( ptr == nullptr )
+        { return nullptr; }
+
+        return new ( ptr ) T( std::forward<Args>( args )... );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      オブジェクトを破棄します.
+    //---------------------------------------------------------------------------------------------
+    void Destroy( T* ptr )
+    {
+        if ( ptr == nullptr )
+        { return; }
+
+        ptr->~T();
+        m_Pool.Free( ptr );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      統計情報を取得します.
+    //---------------------------------------------------------------------------------------------
+    PoolStats GetStats() const
+    { return m_Pool.GetStats(); }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    FixedPool   m_Pool;     //!< ブロックプールです.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    ObjectPool             ( const ObjectPool& ) = delete;
+    ObjectPool& operator = ( const ObjectPool& ) = delete;
+};
+
+} // namespace asdx
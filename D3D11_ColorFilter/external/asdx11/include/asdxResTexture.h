@@ -9,6 +9,7 @@
 // Includes
 //-------------------------------------------------------------------------------------------------
 #include <cstdint>
+#include <asdxTlsfHeap.h>
 
 
 namespace asdx {
@@ -41,7 +42,7 @@ struct SubResource
     uint32_t     Height;         //!< 縦幅です.
     uint32_t     Pitch;          //!< 1行当たりのバイト数です.
     uint32_t     SlicePitch;     //!< 1スライス当たりのバイト数です(つまり，テクセルデータのバイト数).
-    uint8_t*     pPixels;        //!< テクセルデータです.
+    uint8_t*     pPixels;        //!< テクセルデータです. AllocAssetMemory() で確保します.
 
     //---------------------------------------------------------------------------------------------
     //! @brief      コンストラクタです.
@@ -58,7 +59,7 @@ struct SubResource
     //! @brief      解放処理を行います.
     //---------------------------------------------------------------------------------------------
     void Release()
-    { SafeDeleteArray( pPixels ); }
+    { SafeFreeAssetMemory( pPixels ); }
 
 };
 
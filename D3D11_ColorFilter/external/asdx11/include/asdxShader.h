@@ -15,6 +15,7 @@
 #include <d3dcompiler.h>
 #include <asdxRef.h>
 #include <asdxMath.h>
+#include <asdxHashedName.h>
 
 
 //-----------------------------------------------------------------------------
@@ -89,6 +90,14 @@ public:
     //-------------------------------------------------------------------------
     bool Contain(const char* name) const;
 
+    //-------------------------------------------------------------------------
+    //! @brief      指定されたハッシュ名のパラメータが含まれるかどうかチェックします.
+    //!
+    //! @retval true    指定された名前のパラメータが存在します.
+    //! @retval false   指定された名前のパラメータは存在しません.
+    //-------------------------------------------------------------------------
+    bool Contain(const HashedName& name) const;
+
     //-------------------------------------------------------------------------
     //! @brief      パラメータを設定します.
     //!
@@ -112,6 +121,29 @@ public:
     bool SetParam(const char* name, const T& value)
     { return SetParam(name, &value, sizeof(T)); }
 
+    //-------------------------------------------------------------------------
+    //! @brief      パラメータを設定します.
+    //!
+    //! @param[in]      name        ハッシュ名 ("Diffuse"_hash など).
+    //! @param[in]      ptr         書き込みデータ.
+    //! @param[in]      size        書き込みサイズ.
+    //! @retval true    設定に成功.
+    //! @retval false   設定に失敗.
+    //-------------------------------------------------------------------------
+    bool SetParam(const HashedName& name, const void* ptr, size_t size);
+
+    //-------------------------------------------------------------------------
+    //! @brief      パラメータを設定します.
+    //!
+    //! @param[in]      name        ハッシュ名 ("Diffuse"_hash など).
+    //! @param[in]      value       設定値.
+    //! @retval true    設定に成功.
+    //! @retval false   設定に失敗.
+    //-------------------------------------------------------------------------
+    template<typename T>
+    bool SetParam(const HashedName& name, const T& value)
+    { return SetParam(name, &value, sizeof(T)); }
+
     //-------------------------------------------------------------------------
     //! @brief      パラメータを取得します.
     //!
@@ -135,6 +167,29 @@ public:
     bool GetParam(const char* name, T& value) const
     { return GetParam(name, &value, sizeof(T)); }
 
+    //-------------------------------------------------------------------------
+    //! @brief      パラメータを取得します.
+    //!
+    //! @param[in]      name        ハッシュ名 ("Diffuse"_hash など).
+    //! @param[out]     ptr         書き込み先.
+    //! @param[in]      size        想定サイズ.
+    //! @retval true    取得に成功.
+    //! @retval false   取得に失敗.
+    //-------------------------------------------------------------------------
+    bool GetParam(const HashedName& name, void* ptr, size_t size) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      パラメータを取得します.
+    //!
+    //! @param[in]      name        ハッシュ名 ("Diffuse"_hash など).
+    //! @param[out]     value       格納先.
+    //! @retval true    取得に成功.
+    //! @retval false   取得に失敗.
+    //-------------------------------------------------------------------------
+    template<typename T>
+    bool GetParam(const HashedName& name, T& value) const
+    { return GetParam(name, &value, sizeof(T)); }
+
     //-------------------------------------------------------------------------
     //! @brief      サブリソースを更新します.
     //!
@@ -154,7 +209,7 @@ private:
     // private variables.
     //=========================================================================
     asdx::RefPtr<ID3D11Buffer>              m_CB;           //!< 定数バッファ.
-    std::map<std::string, BufferParam>      m_ParamMap;     //!< パラメータマップ.
+    std::map<uint32_t, BufferParam>         m_ParamMap;     //!< パラメータマップ (キーは名前のハッシュ値).
     std::vector<uint8_t>                    m_Memory;       //!< バッファメモリ.
 
     //=========================================================================
@@ -0,0 +1,251 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxShardedCache.h
+// Desc : Lock Striped Concurrent Cache Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxLruCache.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ShardedCache class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief      キーをハッシュで複数のシャードに振り分け, シャードごとにロックするスレッドセーフなキャッシュです.
+//!
+//! @details    各シャードは TPolicy (LruMap, LfuMap など) で追い出しを管理します.
+//!             読み取りは共有ロックで検索し, 使用順序の更新はロックが取れた場合だけ行います.
+//!             書き込み側のロック区間は O(1) で, 値の生成, 追い出しコールバック, 値の破棄はロック外で行います.
+//!             容量と重みはシャード数で等分し, 全体の重みはアトミックに集計します.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename TKey, typename TValue,
+         template<typename, typename, typename> class TPolicy = LruMap,
+         typename THash = std::hash<TKey>>
+class ShardedCache
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      共有される値のポインタです. 追い出された後も参照中は破棄されません.
+    //---------------------------------------------------------------------------------------------
+    using ValuePtr = std::shared_ptr<const TValue>;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリがキャッシュから取り除かれた後, ロック外で呼び出されるコールバックです.
+    //---------------------------------------------------------------------------------------------
+    using EvictCallback = std::function<void(const TKey& key, const ValuePtr& value)>;
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //!
+    //! @param[in]      capacity        全体の容量です. シャード数で等分します.
+    //! @param[in]      shardCount      シャード数です. 2の累乗に切り上げます.
+    //---------------------------------------------------------------------------------------------
+    ShardedCache(size_t capacity, uint32_t shardCount = 16);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~ShardedCache();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      追い出し時のコールバックを設定します.
+    //!
+    //! @note       他のスレッドからキャッシュを使用する前に設定してください.
+    //---------------------------------------------------------------------------------------------
+    void SetEvictCallback(EvictCallback callback);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリを追加または更新します.
+    //!
+    //! @param[in]      key         キーです.
+    //! @param[in]      value       値です.
+    //! @param[in]      weight      重みです. シャード当たりの容量を超える場合は追加できません.
+    //! @retval true    追加に成功.
+    //! @retval false   追加に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool Put(const TKey& key, TValue value, size_t weight = 1);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      値を取得します.
+    //!
+    //! @return     値を返却します. 見つからない場合は nullptr を返却します.
+    //! @note       書き込み中のシャードでは使用順序の更新を省略します.
+    //---------------------------------------------------------------------------------------------
+    ValuePtr Get(const TKey& key);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      値を取得し, 無い場合は生成して追加します.
+    //!
+    //! @param[in]      key         キーです.
+    //! @param[in]      func        bool(const TKey& key, TValue& value, size_t& weight) の形式の生成関数です.
+    //! @return     値を返却します. 生成に失敗した場合は nullptr を返却します.
+    //! @note       同じキーに対して同時に呼び出された場合も生成関数は1回だけ呼び出され,
+    //!             他のスレッドは生成の完了を待って同じ値を受け取ります.
+    //!             生成関数はロック外で呼び出します. TValue はデフォルト構築可能である必要があります.
+    //---------------------------------------------------------------------------------------------
+    template<typename Func>
+    ValuePtr GetOrCompute(const TKey& key, Func func);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリが含まれているか判定します.
+    //---------------------------------------------------------------------------------------------
+    bool Contains(const TKey& key) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリを削除します.
+    //---------------------------------------------------------------------------------------------
+    bool Remove(const TKey& key);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリをピン留めし, 追い出しの対象から外します.
+    //---------------------------------------------------------------------------------------------
+    bool Pin(const TKey& key);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリのピン留めを解除します.
+    //---------------------------------------------------------------------------------------------
+    bool Unpin(const TKey& key);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全エントリを削除します.
+    //---------------------------------------------------------------------------------------------
+    void Clear();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全体の容量を取得します.
+    //---------------------------------------------------------------------------------------------
+    size_t GetCapacity() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全シャードの重みの合計を取得します.
+    //---------------------------------------------------------------------------------------------
+    size_t GetWeight() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全シャードのエントリ数の合計を取得します.
+    //---------------------------------------------------------------------------------------------
+    size_t GetCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      シャード数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t GetShardCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      Get() と GetOrCompute() でヒットした回数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint64_t GetHitCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      Get() と GetOrCompute() でヒットしなかった回数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint64_t GetMissCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      生成関数を呼び出した回数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint64_t GetComputeCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      他のスレッドの生成完了を待った回数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint64_t GetWaitCount() const;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Pending structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Pending
+    {
+        std::mutex              Mutex;      //!< 完了通知用のミューテックスです.
+        std::condition_variable Cond;       //!< 完了通知です.
+        bool                    Done;       //!< 生成が完了したかどうか.
+        ValuePtr                Value;      //!< 生成した値です.
+
+        Pending()
+        : Done(false)
+        { /* DO_NOTHING */ }
+    };
+
+    using Policy     = TPolicy<TKey, ValuePtr, THash>;
+    using EvictList  = std::vector<std::pair<TKey, ValuePtr>>;
+    using PendingMap = std::unordered_map<TKey, std::shared_ptr<Pending>, THash>;
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Shard structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Shard
+    {
+        mutable std::shared_timed_mutex Lock;           //!< キャッシュを保護するロックです.
+        Policy                          Cache;          //!< 追い出しを管理するキャッシュです.
+        EvictList                       Evicted;        //!< ロック外で処理する追い出し済みエントリです.
+        std::mutex                      PendingLock;    //!< 生成中リストを保護するロックです.
+        PendingMap                      Pendings;       //!< 生成中のエントリです.
+        std::atomic<uint64_t>           HitCount;       //!< ヒット数です.
+        std::atomic<uint64_t>           MissCount;      //!< ミス数です.
+        std::atomic<uint64_t>           ComputeCount;   //!< 生成数です.
+        std::atomic<uint64_t>           WaitCount;      //!< 生成待ち数です.
+
+        Shard(size_t capacity)
+        : Cache         (capacity)
+        , HitCount      (0)
+        , MissCount     (0)
+        , ComputeCount  (0)
+        , WaitCount     (0)
+        { /* DO_NOTHING */ }
+    };
+
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    std::vector<std::unique_ptr<Shard>> m_Shards;       //!< シャードです. 偽共有を避けるため個別に確保します.
+    uint32_t                            m_ShardShift;   //!< シャード番号を求めるシフト量です.
+    size_t                              m_Capacity;     //!< 全体の容量です.
+    std::atomic<size_t>                 m_Weight;       //!< 全体の重みです.
+    EvictCallback                       m_OnEvict;      //!< 追い出し時のコールバックです.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    ShardedCache                (const ShardedCache&) = delete;
+    ShardedCache& operator =    (const ShardedCache&) = delete;
+
+    Shard& GetShard(const TKey& key) const;
+
+    template<typename Func>
+    void Mutate(Shard& shard, Func func);
+
+    void Complete(Shard& shard, const TKey& key, const std::shared_ptr<Pending>& pending, const ValuePtr& value);
+};
+
+} // namespace asdx
+
+
+//-------------------------------------------------------------------------------------------------
+// Inline Files.
+//-------------------------------------------------------------------------------------------------
+#include <asdxShardedCache.inl>
@@ -0,0 +1,410 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxShardedCache.inl
+// Desc : Lock Striped Concurrent Cache Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ShardedCache class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash> inline
+ShardedCache<TKey, TValue, TPolicy, THash>::ShardedCache(size_t capacity, uint32_t shardCount)
+: m_Shards      ()
+, m_ShardShift  (64)
+, m_Capacity    (capacity)
+, m_Weight      (0)
+, m_OnEvict     ()
+{
+    uint32_t count = 1;
+    while( count < shardCount && count < (1u << 16) )
+    {
+        count <<= 1;
+        m_ShardShift--;
+    }
+
+    auto shardCapacity = (capacity + count - 1) / count;
+
+    m_Shards.reserve(count);
+    for( uint32_t i=0; i<count; ++i )
+    {
+        m_Shards.emplace_back(new Shard(shardCapacity));
+
+        // 追い出したエントリはロック外でコールバックと破棄を行うため退避しておく.
+        auto pShard = m_Shards.back().get();
+        pShard->Cache.SetEvictCallback([pShard](const TKey& key, ValuePtr& value)
+        { pShard->Evicted.emplace_back(key, std::move(value)); });
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash> inline
+ShardedCache<TKey, TValue, TPolicy, THash>::~ShardedCache()
+{ Clear(); }
+
+//-------------------------------------------------------------------------------------------------
+//      追い出し時のコールバックを設定します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash> inline
+void ShardedCache<TKey, TValue, TPolicy, THash>::SetEvictCallback(EvictCallback callback)
+{ m_OnEvict = std::move(callback); }
+
+//-------------------------------------------------------------------------------------------------
+//      エントリを追加または更新します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash> inline
+bool ShardedCache<TKey, TValue, TPolicy, THash>::Put(const TKey& key, TValue value, size_t weight)
+{
+    // 値の構築はロック外で行う.
+    auto ptr = std::make_shared<const TValue>(std::move(value));
+
+    auto& shard  = GetShard(key);
+    auto  result = false;
+    Mutate(shard, [&]()
+    { result = shard.Cache.Put(key, std::move(ptr), weight); });
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      値を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash> inline
+typename ShardedCache<TKey, TValue, TPolicy, THash>::ValuePtr
+ShardedCache<TKey, TValue, TPolicy, THash>::Get(const TKey& key)
+{
+    auto& shard = GetShard(key);
+
+    ValuePtr result;
+    {
+        std::shared_lock<std::shared_timed_mutex> locker(shard.Lock);
+        auto pValue = shard.Cache.Peek(key);
+        if ( pValue != nullptr )
+        { result = *pValue; }
+    }
+
+    if ( !result )
+    {
+        shard.MissCount.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    shard.HitCount.fetch_add(1, std::memory_order_relaxed);
+
+    // 使用順序の更新は取りこぼしても正しさに影響しないので, 待たずに諦める.
+    std::unique_lock<std::shared_timed_mutex> locker(shard.Lock, std::try_to_lock);
+    if ( locker.owns_lock() )
+    { shard.Cache.Get(key); }
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      値を取得し, 無い場合は生成して追加します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash>
+template<typename Func> inline
+typename ShardedCache<TKey, TValue, TPolicy, THash>::ValuePtr
+ShardedCache<TKey, TValue, TPolicy, THash>::GetOrCompute(const TKey& key, Func func)
+{
+    auto value = Get(key);
+    if ( value )
+    { return value; }
+
+    auto& shard = GetShard(key);
+
+    std::shared_ptr<Pending> pending;
+    auto owner = false;
+    {
+        std::lock_guard<std::mutex> locker(shard.PendingLock);
+        auto itr = shard.Pendings.find(key);
+        if ( itr != shard.Pendings.end() )
+        {
+            pending = itr->second;
+        }
+        else
+        {
+            pending = std::make_shared<Pending>();
+            shard.Pendings.emplace(key, pending);
+            owner = true;
+        }
+    }
+
+    if ( !owner )
+    {
+        shard.WaitCount.fetch_add(1, std::memory_order_relaxed);
+
+        std::unique_lock<std::mutex> locker(pending->Mutex);
+        pending->Cond.wait(locker, [&]() { return pending->Done; });
+        return pending->Value;
+    }
+
+    // 最初の Get() から登録までの間に他のスレッドが生成を終えている可能性がある.
+    {
+        std::shared_lock<std::shared_timed_mutex> locker(shard.Lock);
+        auto pValue = shard.Cache.Peek(key);
+        if ( pValue != nullptr )
+        { value = *pValue; }
+    }
+
+    if ( !value )
+    {
+        shard.ComputeCount.fetch_add(1, std::memory_order_relaxed);
+
+        TValue result   = TValue();
+        size_t weight   = 1;
+        auto   computed = false;
+
+        try
+        { computed = func(key, result, weight); }
+        catch(...)
+        {
+            // 待機中のスレッドを解放してから例外を伝える.
+            Complete(shard, key, pending, nullptr);
+            throw;
+        }
+
+        if ( computed )
+        {
+            value = std::make_shared<const TValue>(std::move(result));
+            Mutate(shard, [&]()
+            { shard.Cache.Put(key, value, weight); });
+        }
+    }
+
+    Complete(shard, key, pending, value);
+    return value;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      エントリが含まれているか判定します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash> inline
+bool ShardedCache<TKey, TValue, TPolicy, THash>::Contains(const TKey& key) const
+{
+    auto& shard = GetShard(key);
+    std::shared_lock<std::shared_timed_mutex> locker(shard.Lock);
+    return shard.Cache.Contains(key);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      エントリを削除します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash> inline
+bool ShardedCache<TKey, TValue, TPolicy, THash>::Remove(const TKey& key)
+{
+    auto& shard  = GetShard(key);
+    auto  result = false;
+    Mutate(shard, [&]()
+    { result = shard.Cache.Remove(key); });
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      エントリをピン留めします.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash> inline
+bool ShardedCache<TKey, TValue, TPolicy, THash>::Pin(const TKey& key)
+{
+    auto& shard  = GetShard(key);
+    auto  result = false;
+    Mutate(shard, [&]()
+    { result = ( shard.Cache.Pin(key) != nullptr ); });
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      エントリのピン留めを解除します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash> inline
+bool ShardedCache<TKey, TValue, TPolicy, THash>::Unpin(const TKey& key)
+{
+    auto& shard  = GetShard(key);
+    auto  result = false;
+    Mutate(shard, [&]()
+    { result = shard.Cache.Unpin(key); });
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      全エントリを削除します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash> inline
+void ShardedCache<TKey, TValue, TPolicy, THash>::Clear()
+{
+    for( auto& shard : m_Shards )
+    {
+        auto pShard = shard.get();
+        Mutate(*pShard, [pShard]()
+        { pShard->Cache.Clear(); });
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      全体の容量を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash> inline
+size_t ShardedCache<TKey, TValue, TPolicy, THash>::GetCapacity() const
+{ return m_Capacity; }
+
+//-------------------------------------------------------------------------------------------------
+//      全シャードの重みの合計を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash> inline
+size_t ShardedCache<TKey, TValue, TPolicy, THash>::GetWeight() const
+{ return m_Weight.load(std::memory_order_relaxed); }
+
+//-------------------------------------------------------------------------------------------------
+//      全シャードのエントリ数の合計を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash> inline
+size_t ShardedCache<TKey, TValue, TPolicy, THash>::GetCount() const
+{
+    size_t count = 0;
+    for( auto& shard : m_Shards )
+    {
+        std::shared_lock<std::shared_timed_mutex> locker(shard->Lock);
+        count += shard->Cache.GetCount();
+    }
+    return count;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      シャード数を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash> inline
+uint32_t ShardedCache<TKey, TValue, TPolicy, THash>::GetShardCount() const
+{ return uint32_t(m_Shards.size()); }
+
+//-------------------------------------------------------------------------------------------------
+//      ヒット数を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash> inline
+uint64_t ShardedCache<TKey, TValue, TPolicy, THash>::GetHitCount() const
+{
+    uint64_t count = 0;
+    for( auto& shard : m_Shards )
+    { count += shard->HitCount.load(std::memory_order_relaxed); }
+    return count;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ミス数を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash> inline
+uint64_t ShardedCache<TKey, TValue, TPolicy, THash>::GetMissCount() const
+{
+    uint64_t count = 0;
+    for( auto& shard : m_Shards )
+    { count += shard->MissCount.load(std::memory_order_relaxed); }
+    return count;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      生成数を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash> inline
+uint64_t ShardedCache<TKey, TValue, TPolicy, THash>::GetComputeCount() const
+{
+    uint64_t count = 0;
+    for( auto& shard : m_Shards )
+    { count += shard->ComputeCount.load(std::memory_order_relaxed); }
+    return count;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      生成待ち数を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash> inline
+uint64_t ShardedCache<TKey, TValue, TPolicy, THash>::GetWaitCount() const
+{
+    uint64_t count = 0;
+    for( auto& shard : m_Shards )
+    { count += shard->WaitCount.load(std::memory_order_relaxed); }
+    return count;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      キーに対応するシャードを取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash> inline
+typename ShardedCache<TKey, TValue, TPolicy, THash>::Shard&
+ShardedCache<TKey, TValue, TPolicy, THash>::GetShard(const TKey& key) const
+{
+    if ( m_ShardShift >= 64 )
+    { return *m_Shards[0]; }
+
+    // std::hash は恒等写像の場合があるので, 上位ビットを使う前に攪拌する.
+    auto hash = uint64_t(THash()(key)) * 0x9e3779b97f4a7c15ull;
+    return *m_Shards[size_t(hash >> m_ShardShift)];
+}
+
+//-------------------------------------------------------------------------------------------------
+//      排他ロック下でシャードを更新し, 追い出したエントリをロック外で処理します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash>
+template<typename Func> inline
+void ShardedCache<TKey, TValue, TPolicy, THash>::Mutate(Shard& shard, Func func)
+{
+    EvictList evicted;
+    {
+        std::unique_lock<std::shared_timed_mutex> locker(shard.Lock);
+
+        auto before = shard.Cache.GetWeight();
+        func();
+        auto after  = shard.Cache.GetWeight();
+
+        // 符号なしの加算で減少も表現できる.
+        m_Weight.fetch_add(after - before, std::memory_order_relaxed);
+
+        evicted.swap(shard.Evicted);
+    }
+
+    if ( m_OnEvict )
+    {
+        for( auto& item : evicted )
+        { m_OnEvict(item.first, item.second); }
+    }
+
+    // 値の破棄はここ (ロック外) で行われる.
+}
+
+//-------------------------------------------------------------------------------------------------
+//      生成の完了を待機中のスレッドに通知します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, template<typename, typename, typename> class TPolicy, typename THash> inline
+void ShardedCache<TKey, TValue, TPolicy, THash>::Complete
+(
+    Shard&                          shard,
+    const TKey&                     key,
+    const std::shared_ptr<Pending>& pending,
+    const ValuePtr&                 value
+)
+{
+    {
+        std::lock_guard<std::mutex> locker(shard.PendingLock);
+        shard.Pendings.erase(key);
+    }
+
+    {
+        std::lock_guard<std::mutex> locker(pending->Mutex);
+        pending->Value = value;
+        pending->Done  = true;
+    }
+
+    pending->Cond.notify_all();
+}
+
+} // namespace asdx
@@ -0,0 +1,147 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxStringPool.h
+// Desc : String Intern Pool.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <atomic>
+#include <vector>
+#include <shared_mutex>
+#include <asdxHashedName.h>
+
+
+namespace asdx {
+
+//-----------------------------------------------------------------------------
+// Type definitions
+//-----------------------------------------------------------------------------
+using StringHandle = uint32_t;      //!< 登録文字列のハンドルです. 0 は空文字列です.
+
+
+///////////////////////////////////////////////////////////////////////////////
+// StringPool class
+///////////////////////////////////////////////////////////////////////////////
+class StringPool
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    static const StringHandle   kEmptyHandle = 0;   //!< 空文字列のハンドルです.
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      シングルトンインスタンスを取得します.
+    //-------------------------------------------------------------------------
+    static StringPool& GetInstance();
+
+    //-------------------------------------------------------------------------
+    //! @brief      文字列を登録します.
+    //!
+    //! @param[in]      value       ヌル終端文字列です.
+    //! @return     登録済みの場合は既存のハンドルを返却します.
+    //-------------------------------------------------------------------------
+    StringHandle Intern(const char* value);
+
+    //-------------------------------------------------------------------------
+    //! @brief      文字列を登録します.
+    //!
+    //! @param[in]      value       文字列です.
+    //! @param[in]      count       文字数です.
+    //! @return     登録済みの場合は既存のハンドルを返却します.
+    //-------------------------------------------------------------------------
+    StringHandle Intern(const char* value, size_t count);
+
+    //-------------------------------------------------------------------------
+    //! @brief      ハッシュ名を登録します. ハッシュ値は再計算しません.
+    //!
+    //! @param[in]      value       ハッシュ名です.
+    //! @return     登録済みの場合は既存のハンドルを返却します.
+    //-------------------------------------------------------------------------
+    StringHandle Intern(const HashedName& value);
+
+    //-------------------------------------------------------------------------
+    //! @brief      文字列を取得します.
+    //!
+    //! @param[in]      handle      ハンドルです.
+    //! @return     プールが破棄されるまで有効なヌル終端文字列を返却します.
+    //-------------------------------------------------------------------------
+    const char* GetString(StringHandle handle) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      文字数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetLength(StringHandle handle) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ハッシュ値を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetHash(StringHandle handle) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      登録されている文字列数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      文字列格納用に確保したメモリサイズを取得します.
+    //-------------------------------------------------------------------------
+    size_t GetMemorySize() const;
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    static const uint32_t   kPageSize       = 64 * 1024;    //!< 文字列ページのサイズです.
+    static const uint32_t   kBlockShift     = 12;           //!< エントリブロックのビット数です.
+    static const uint32_t   kBlockSize      = 1u << kBlockShift;
+    static const uint32_t   kMaxBlockCount  = 1024;         //!< 最大エントリブロック数です.
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Entry structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Entry
+    {
+        const char*     pString;    //!< 文字列です.
+        uint32_t        Length;     //!< 文字数です.
+        uint32_t        Hash;       //!< ハッシュ値です.
+    };
+
+    mutable std::shared_timed_mutex     m_Lock;                     //!< 登録処理を保護するロックです.
+    std::atomic<Entry*>                 m_Blocks[kMaxBlockCount];   //!< エントリブロックです.
+    std::atomic<uint32_t>               m_Count;                    //!< 登録数です.
+    std::vector<StringHandle>           m_Table;                    //!< ハッシュテーブルです (0 は空きスロット).
+    std::vector<char*>                  m_Pages;                    //!< 文字列ページです.
+    char*                               m_pCursor;                  //!< ページの書き込み位置です.
+    size_t                              m_Remain;                   //!< ページの残りサイズです.
+    size_t                              m_MemorySize;               //!< 確保したメモリサイズです.
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    StringPool();
+    ~StringPool();
+    StringPool             (const StringPool&) = delete;
+    StringPool& operator = (const StringPool&) = delete;
+
+    StringHandle Find      (const char* value, uint32_t count, uint32_t hash) const;
+    StringHandle Insert    (const char* value, uint32_t count, uint32_t hash);
+    const Entry& GetEntry  (StringHandle handle) const;
+    char*        Allocate  (size_t size);
+    void         Rehash    (size_t tableSize);
+};
+
+} // namespace asdx
@@ -0,0 +1,372 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxTinyLfuCache.h
+// Desc : Window TinyLFU Cache Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <algorithm>
+#include <unordered_map>
+#include <functional>
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FrequencySketch class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief      4bit カウンタの Count-Min Sketch でアクセス頻度を近似します.
+//!
+//! @details    1キーにつき4行のカウンタを加算し, 最小値を推定値とします.
+//!             加算回数がサンプル数に達すると全カウンタを半分にし, 古い頻度を減衰させます.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename TKey, typename THash = std::hash<TKey>>
+class FrequencySketch
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    static const uint32_t kMaxFrequency = 15;   //!< カウンタの最大値です.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    FrequencySketch();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      想定するエントリ数に合わせてカウンタを確保します.
+    //!
+    //! @param[in]      count       想定するエントリ数です.
+    //! @note       サイズが変わる場合はカウンタをクリアします.
+    //---------------------------------------------------------------------------------------------
+    void EnsureCapacity(size_t count);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      アクセスを記録します.
+    //---------------------------------------------------------------------------------------------
+    void Increment(const TKey& key);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      推定頻度を取得します.
+    //!
+    //! @return     0 ～ kMaxFrequency の推定頻度を返却します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t Estimate(const TKey& key) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全カウンタを半分にします.
+    //---------------------------------------------------------------------------------------------
+    void Reset();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全カウンタをクリアします.
+    //---------------------------------------------------------------------------------------------
+    void Clear();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      減衰を行う加算回数を取得します.
+    //---------------------------------------------------------------------------------------------
+    size_t GetSampleSize() const;
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    std::vector<uint64_t>   m_Table;        //!< 4bit カウンタを16個ずつ詰めたテーブルです.
+    size_t                  m_Mask;         //!< テーブルのインデックスマスクです.
+    size_t                  m_SampleSize;   //!< 減衰を行う加算回数です.
+    size_t                  m_Additions;    //!< 前回の減衰からの加算回数です.
+    THash                   m_Hash;         //!< ハッシュ関数です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    uint64_t Spread(const TKey& key) const;
+    size_t   GetIndex(uint64_t hash, uint32_t row, uint32_t& shift) const;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TinyLfuMap class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief      W-TinyLFU 方式のキャッシュです.
+//!
+//! @details    新しいエントリは小さな LRU のウィンドウに入ります. ウィンドウからあふれたエントリは
+//!             メイン領域の追い出し候補と FrequencySketch の推定頻度を比較し, 上回る場合だけ
+//!             メイン領域に入ります. メイン領域は仮領域と保護領域に分かれた Segmented LRU で,
+//!             仮領域で再びアクセスされたエントリが保護領域に昇格します.
+//!             一度だけアクセスされるエントリの走査で頻繁に使われるエントリが追い出されません.
+//!             インタフェースは LruMap, LfuMap と同じです.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename TKey, typename TValue, typename THash = std::hash<TKey>>
+class TinyLfuMap
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリがキャッシュから取り除かれる際に呼び出されるコールバックです.
+    //!
+    //! @note       コールバック内からキャッシュを操作してはいけません.
+    //---------------------------------------------------------------------------------------------
+    using EvictCallback = std::function<void(const TKey& key, TValue& value)>;
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //!
+    //! @param[in]      capacity    容量です. Put() で重みを省略した場合はエントリ数になります.
+    //! @note       容量の1%をウィンドウ, 残りの80%を保護領域に割り当てます.
+    //---------------------------------------------------------------------------------------------
+    TinyLfuMap(size_t capacity);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~TinyLfuMap();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      追い出し時のコールバックを設定します.
+    //!
+    //! @param[in]      callback    コールバックです.
+    //---------------------------------------------------------------------------------------------
+    void SetEvictCallback(EvictCallback callback);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリを追加または更新します.
+    //!
+    //! @param[in]      key         キーです.
+    //! @param[in]      value       値です.
+    //! @param[in]      weight      重み(バイト数など)です.
+    //! @retval true    追加に成功.
+    //! @retval false   重みが容量を超える, またはピン留めされたエントリで容量が埋まっていて追加できません.
+    //! @note       追加したエントリはウィンドウに入るため, 追加直後に追い出されることはありません.
+    //!             メイン領域に入れなかったエントリは追い出しとしてコールバックを呼び出します.
+    //---------------------------------------------------------------------------------------------
+    bool Put(const TKey& key, const TValue& value, size_t weight = 1);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリを追加または更新します.
+    //---------------------------------------------------------------------------------------------
+    bool Put(const TKey& key, TValue&& value, size_t weight = 1);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      値を取得し, アクセスを記録します.
+    //!
+    //! @param[in]      key         キーです.
+    //! @return     値へのポインタを返却します. 見つからない場合は nullptr を返却します.
+    //! @note       見つからない場合もアクセス頻度を記録します.
+    //---------------------------------------------------------------------------------------------
+    TValue* Get(const TKey& key);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      アクセスを記録せずに値を取得します.
+    //---------------------------------------------------------------------------------------------
+    const TValue* Peek(const TKey& key) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリが含まれているか判定します.
+    //---------------------------------------------------------------------------------------------
+    bool Contains(const TKey& key) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリをピン留めし, 追い出しの対象から外します.
+    //!
+    //! @note       Pin() と Unpin() は同じ回数呼び出す必要があります.
+    //---------------------------------------------------------------------------------------------
+    TValue* Pin(const TKey& key);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリのピン留めを解除します.
+    //---------------------------------------------------------------------------------------------
+    bool Unpin(const TKey& key);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリを削除します.
+    //!
+    //! @retval true    削除に成功.
+    //! @retval false   エントリが存在しないか, ピン留めされています.
+    //---------------------------------------------------------------------------------------------
+    bool Remove(const TKey& key);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ピン留めされたエントリも含めて全エントリを削除します.
+    //!
+    //! @note       アクセス頻度の記録は保持します.
+    //---------------------------------------------------------------------------------------------
+    void Clear();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      容量を設定します.
+    //---------------------------------------------------------------------------------------------
+    void SetCapacity(size_t capacity);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エントリ数に合わせてハッシュテーブルと頻度カウンタを予約します.
+    //---------------------------------------------------------------------------------------------
+    void Reserve(size_t count);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      推定アクセス頻度を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t GetFrequency(const TKey& key) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      容量を取得します.
+    //---------------------------------------------------------------------------------------------
+    size_t GetCapacity() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      現在の重みの合計を取得します.
+    //---------------------------------------------------------------------------------------------
+    size_t GetWeight() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      現在のエントリ数を取得します.
+    //---------------------------------------------------------------------------------------------
+    size_t GetCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      Get() でヒットした回数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint64_t GetHitCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      Get() でヒットしなかった回数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint64_t GetMissCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      追い出したエントリ数を取得します. 入場を拒否したエントリも含みます.
+    //---------------------------------------------------------------------------------------------
+    uint64_t GetEvictCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      メイン領域への入場を拒否した回数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint64_t GetRejectCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      統計情報をリセットします.
+    //---------------------------------------------------------------------------------------------
+    void ResetStats();
+
+private:
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // SEGMENT_TYPE enum
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    enum SEGMENT_TYPE
+    {
+        SEGMENT_WINDOW = 0,     //!< 入場前のウィンドウです.
+        SEGMENT_PROBATION,      //!< メイン領域の仮領域です.
+        SEGMENT_PROTECTED,      //!< メイン領域の保護領域です.
+        NUM_SEGMENT_TYPE,
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Node structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Node
+    {
+        TValue          Value;      //!< 値です.
+        size_t          Weight;     //!< 重みです.
+        uint32_t        PinCount;   //!< ピン留めの参照数です.
+        uint32_t        Segment;    //!< 所属する領域です.
+        Node*           pPrev;      //!< 最近使用した側のノードです.
+        Node*           pNext;      //!< 使用していない側のノードです.
+        const TKey*     pKey;       //!< ハッシュテーブル内のキーです.
+
+        template<typename V>
+        Node(V&& value, size_t weight)
+        : Value     (std::forward<V>(value))
+        , Weight    (weight)
+        , PinCount  (0)
+        , Segment   (SEGMENT_WINDOW)
+        , pPrev     (nullptr)
+        , pNext     (nullptr)
+        , pKey      (nullptr)
+        { /* DO_NOTHING */ }
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Segment structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Segment
+    {
+        Node*   pHead;      //!< 最近使用したノードです.
+        Node*   pTail;      //!< 最も長く使用されていないノードです.
+        size_t  Weight;     //!< リスト内のノードの重みの合計です.
+        size_t  Capacity;   //!< 目標とする重みです.
+    };
+
+    using Table = std::unordered_map<TKey, Node, THash>;
+
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    size_t                          m_Capacity;                     //!< 容量です.
+    size_t                          m_Weight;                       //!< ピン留め中も含めた重みの合計です.
+    size_t                          m_PinnedWeight;                 //!< ピン留め中のノードの重みの合計です.
+    Table                           m_Table;                        //!< ハッシュテーブルです.
+    Segment                         m_Segment[NUM_SEGMENT_TYPE];    //!< 領域ごとの LRU リストです.
+    FrequencySketch<TKey, THash>    m_Sketch;                       //!< アクセス頻度の推定器です.
+    EvictCallback                   m_OnEvict;                      //!< 追い出し時のコールバックです.
+    uint64_t                        m_HitCount;                     //!< ヒット数です.
+    uint64_t                        m_MissCount;                    //!< ミス数です.
+    uint64_t                        m_EvictCount;                   //!< 追い出し数です.
+    uint64_t                        m_RejectCount;                  //!< 入場拒否数です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    TinyLfuMap              (const TinyLfuMap&) = delete;
+    TinyLfuMap& operator =  (const TinyLfuMap&) = delete;
+
+    template<typename V>
+    bool PutInternal(const TKey& key, V&& value, size_t weight);
+
+    void LinkFront      (uint32_t segment, Node* pNode);
+    void Unlink         (Node* pNode);
+    void OnAccess       (Node* pNode);
+    void Evict          (Node* pNode);
+    void UpdateCapacity ();
+    void DemoteProtected(const Node* pKeep);
+    void Admit          (Node* pCandidate, size_t limit);
+    void EvictTo        (size_t limit, const Node* pKeep);
+};
+
+} // namespace asdx
+
+
+//-------------------------------------------------------------------------------------------------
+// Inline Files.
+//-------------------------------------------------------------------------------------------------
+#include <asdxTinyLfuCache.inl>
@@ -0,0 +1,707 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxTinyLfuCache.inl
+// Desc : Window TinyLFU Cache Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FrequencySketch class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename THash> inline
+FrequencySketch<TKey, THash>::FrequencySketch()
+: m_Table       ()
+, m_Mask        (0)
+, m_SampleSize  (0)
+, m_Additions   (0)
+, m_Hash        ()
+{ EnsureCapacity(0); }
+
+//-------------------------------------------------------------------------------------------------
+//      想定するエントリ数に合わせてカウンタを確保します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename THash> inline
+void FrequencySketch<TKey, THash>::EnsureCapacity(size_t count)
+{
+    // 1エントリ当たり1ワード (16カウンタ) を割り当てる. 縮小はしない.
+    size_t size = 16;
+    while( size < count && size < (size_t(1) << 24) )
+    { size <<= 1; }
+
+    if ( size <= m_Table.size() )
+    { return; }
+
+    m_Table.assign(size, 0);
+    m_Mask       = size - 1;
+    m_SampleSize = size * 10;
+    m_Additions  = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      アクセスを記録します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename THash> inline
+void FrequencySketch<TKey, THash>::Increment(const TKey& key)
+{
+    auto hash  = Spread(key);
+    auto added = false;
+
+    for( uint32_t row=0; row<4; ++row )
+    {
+        uint32_t shift = 0;
+        auto index = GetIndex(hash, row, shift);
+
+        if ( ((m_Table[index] >> shift) & 0xf) < kMaxFrequency )
+        {
+            m_Table[index] += uint64_t(1) << shift;
+            added = true;
+        }
+    }
+
+    if ( added && ++m_Additions >= m_SampleSize )
+    { Reset(); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      推定頻度を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename THash> inline
+uint32_t FrequencySketch<TKey, THash>::Estimate(const TKey& key) const
+{
+    auto hash   = Spread(key);
+    auto result = kMaxFrequency;
+
+    for( uint32_t row=0; row<4; ++row )
+    {
+        uint32_t shift = 0;
+        auto index = GetIndex(hash, row, shift);
+        auto count = uint32_t((m_Table[index] >> shift) & 0xf);
+        result = ( count < result ) ? count : result;
+    }
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      全カウンタを半分にします.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename THash> inline
+void FrequencySketch<TKey, THash>::Reset()
+{
+    // 各4bitの最下位ビットを隣のカウンタに漏らさないようにマスクする.
+    for( auto& word : m_Table )
+    { word = (word >> 1) & 0x7777777777777777ull; }
+
+    m_Additions /= 2;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      全カウンタをクリアします.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename THash> inline
+void FrequencySketch<TKey, THash>::Clear()
+{
+    std::fill(m_Table.begin(), m_Table.end(), 0);
+    m_Additions = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      減衰を行う加算回数を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename THash> inline
+size_t FrequencySketch<TKey, THash>::GetSampleSize() const
+{ return m_SampleSize; }
+
+//-------------------------------------------------------------------------------------------------
+//      ハッシュ値を攪拌します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename THash> inline
+uint64_t FrequencySketch<TKey, THash>::Spread(const TKey& key) const
+{
+    // std::hash は整数をそのまま返すことがあるため, 全ビットに拡散させる.
+    auto x = uint64_t(m_Hash(key));
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      行ごとのカウンタの位置を求めます.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename THash> inline
+size_t FrequencySketch<TKey, THash>::GetIndex(uint64_t hash, uint32_t row, uint32_t& shift) const
+{
+    static const uint64_t kSeeds[4] = {
+        0xc3a5c85c97cb3127ull,
+        0xb492b66fbe98f273ull,
+        0x9ae16a3b2f90404full,
+        0xcbf29ce484222325ull,
+    };
+
+    // 1ワードの16カウンタを4組に分け, 組の中の位置を行番号とする.
+    shift = (uint32_t(((hash & 3) << 2) + row)) << 2;
+
+    auto h = (hash + kSeeds[row]) * kSeeds[row];
+    h += h >> 32;
+    return size_t(h) & m_Mask;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TinyLfuMap class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+TinyLfuMap<TKey, TValue, THash>::TinyLfuMap(size_t capacity)
+: m_Capacity    (capacity)
+, m_Weight      (0)
+, m_PinnedWeight(0)
+, m_Table       ()
+, m_Sketch      ()
+, m_OnEvict     ()
+, m_HitCount    (0)
+, m_MissCount   (0)
+, m_EvictCount  (0)
+, m_RejectCount (0)
+{
+    for( auto i=0; i<NUM_SEGMENT_TYPE; ++i )
+    {
+        m_Segment[i].pHead    = nullptr;
+        m_Segment[i].pTail    = nullptr;
+        m_Segment[i].Weight   = 0;
+        m_Segment[i].Capacity = 0;
+    }
+
+    UpdateCapacity();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+TinyLfuMap<TKey, TValue, THash>::~TinyLfuMap()
+{ Clear(); }
+
+//-------------------------------------------------------------------------------------------------
+//      追い出し時のコールバックを設定します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void TinyLfuMap<TKey, TValue, THash>::SetEvictCallback(EvictCallback callback)
+{ m_OnEvict = std::move(callback); }
+
+//-------------------------------------------------------------------------------------------------
+//      エントリを追加または更新します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+bool TinyLfuMap<TKey, TValue, THash>::Put(const TKey& key, const TValue& value, size_t weight)
+{ return PutInternal(key, value, weight); }
+
+//-------------------------------------------------------------------------------------------------
+//      エントリを追加または更新します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+bool TinyLfuMap<TKey, TValue, THash>::Put(const TKey& key, TValue&& value, size_t weight)
+{ return PutInternal(key, std::move(value), weight); }
+
+//-------------------------------------------------------------------------------------------------
+//      エントリを追加または更新します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash>
+template<typename V> inline
+bool TinyLfuMap<TKey, TValue, THash>::PutInternal(const TKey& key, V&& value, size_t weight)
+{
+    if ( weight > m_Capacity )
+    { return false; }
+
+    auto itr = m_Table.find(key);
+    if ( itr != m_Table.end() )
+    {
+        m_Sketch.Increment(key);
+
+        auto pNode = &itr->second;
+        if ( m_OnEvict )
+        { m_OnEvict(*pNode->pKey, pNode->Value); }
+
+        pNode->Value = std::forward<V>(value);
+        m_Weight    -= pNode->Weight;
+        m_Weight    += weight;
+
+        if ( pNode->PinCount == 0 )
+        {
+            // 領域の重みを付け替えてからアクセスとして扱う.
+            Unlink(pNode);
+            pNode->Weight = weight;
+            LinkFront(pNode->Segment, pNode);
+            OnAccess(pNode);
+        }
+        else
+        {
+            m_PinnedWeight -= pNode->Weight;
+            m_PinnedWeight += weight;
+            pNode->Weight   = weight;
+        }
+
+        EvictTo(m_Capacity, pNode);
+        return true;
+    }
+
+    // ピン留めされていないエントリを全て追い出せば必ず入る場合だけ追加する.
+    if ( m_PinnedWeight + weight > m_Capacity )
+    { return false; }
+
+    m_Sketch.EnsureCapacity(m_Table.size() + 1);
+    m_Sketch.Increment(key);
+
+    auto result = m_Table.emplace(
+        std::piecewise_construct,
+        std::forward_as_tuple(key),
+        std::forward_as_tuple(std::forward<V>(value), weight));
+
+    auto pNode  = &result.first->second;
+    pNode->pKey = &result.first->first;
+    m_Weight   += weight;
+    LinkFront(SEGMENT_WINDOW, pNode);
+
+    EvictTo(m_Capacity, pNode);
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      値を取得し, アクセスを記録します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+TValue* TinyLfuMap<TKey, TValue, THash>::Get(const TKey& key)
+{
+    m_Sketch.Increment(key);
+
+    auto itr = m_Table.find(key);
+    if ( itr == m_Table.end() )
+    {
+        m_MissCount++;
+        return nullptr;
+    }
+
+    m_HitCount++;
+
+    auto pNode = &itr->second;
+    OnAccess(pNode);
+
+    return &pNode->Value;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      アクセスを記録せずに値を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+const TValue* TinyLfuMap<TKey, TValue, THash>::Peek(const TKey& key) const
+{
+    auto itr = m_Table.find(key);
+    return ( itr != m_Table.cend() ) ? &itr->second.Value : nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      エントリが含まれているか判定します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+bool TinyLfuMap<TKey, TValue, THash>::Contains(const TKey& key) const
+{ return m_Table.find(key) != m_Table.cend(); }
+
+//-------------------------------------------------------------------------------------------------
+//      エントリをピン留めします.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+TValue* TinyLfuMap<TKey, TValue, THash>::Pin(const TKey& key)
+{
+    auto itr = m_Table.find(key);
+    if ( itr == m_Table.end() )
+    { return nullptr; }
+
+    // ピン留め中はリストから外し, 領域の重みにも含めない.
+    auto pNode = &itr->second;
+    if ( pNode->PinCount == 0 )
+    {
+        Unlink(pNode);
+        m_PinnedWeight += pNode->Weight;
+    }
+
+    pNode->PinCount++;
+    return &pNode->Value;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      エントリのピン留めを解除します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+bool TinyLfuMap<TKey, TValue, THash>::Unpin(const TKey& key)
+{
+    auto itr = m_Table.find(key);
+    if ( itr == m_Table.end() || itr->second.PinCount == 0 )
+    { return false; }
+
+    auto pNode = &itr->second;
+    pNode->PinCount--;
+    if ( pNode->PinCount == 0 )
+    {
+        m_PinnedWeight -= pNode->Weight;
+        LinkFront(pNode->Segment, pNode);
+
+        if ( pNode->Segment == SEGMENT_PROTECTED )
+        { DemoteProtected(pNode); }
+
+        EvictTo(m_Capacity, pNode);
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      エントリを削除します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+bool TinyLfuMap<TKey, TValue, THash>::Remove(const TKey& key)
+{
+    auto itr = m_Table.find(key);
+    if ( itr == m_Table.end() || itr->second.PinCount != 0 )
+    { return false; }
+
+    auto pNode = &itr->second;
+    Unlink(pNode);
+
+    if ( m_OnEvict )
+    { m_OnEvict(itr->first, pNode->Value); }
+
+    m_Weight -= pNode->Weight;
+    m_Table.erase(itr);
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      全エントリを削除します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void TinyLfuMap<TKey, TValue, THash>::Clear()
+{
+    if ( m_OnEvict )
+    {
+        for( auto& itr : m_Table )
+        { m_OnEvict(itr.first, itr.second.Value); }
+    }
+
+    m_Table.clear();
+    m_Weight       = 0;
+    m_PinnedWeight = 0;
+
+    for( auto i=0; i<NUM_SEGMENT_TYPE; ++i )
+    {
+        m_Segment[i].pHead  = nullptr;
+        m_Segment[i].pTail  = nullptr;
+        m_Segment[i].Weight = 0;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      容量を設定します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void TinyLfuMap<TKey, TValue, THash>::SetCapacity(size_t capacity)
+{
+    m_Capacity = capacity;
+    UpdateCapacity();
+    DemoteProtected(nullptr);
+    EvictTo(m_Capacity, nullptr);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ハッシュテーブルと頻度カウンタを予約します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void TinyLfuMap<TKey, TValue, THash>::Reserve(size_t count)
+{
+    m_Table.reserve(count);
+    m_Sketch.EnsureCapacity(count);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      推定アクセス頻度を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+uint32_t TinyLfuMap<TKey, TValue, THash>::GetFrequency(const TKey& key) const
+{ return m_Sketch.Estimate(key); }
+
+//-------------------------------------------------------------------------------------------------
+//      容量を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+size_t TinyLfuMap<TKey, TValue, THash>::GetCapacity() const
+{ return m_Capacity; }
+
+//-------------------------------------------------------------------------------------------------
+//      現在の重みの合計を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+size_t TinyLfuMap<TKey, TValue, THash>::GetWeight() const
+{ return m_Weight; }
+
+//-------------------------------------------------------------------------------------------------
+//      現在のエントリ数を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+size_t TinyLfuMap<TKey, TValue, THash>::GetCount() const
+{ return m_Table.size(); }
+
+//-------------------------------------------------------------------------------------------------
+//      ヒット数を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+uint64_t TinyLfuMap<TKey, TValue, THash>::GetHitCount() const
+{ return m_HitCount; }
+
+//-------------------------------------------------------------------------------------------------
+//      ミス数を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+uint64_t TinyLfuMap<TKey, TValue, THash>::GetMissCount() const
+{ return m_MissCount; }
+
+//-------------------------------------------------------------------------------------------------
+//      追い出し数を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+uint64_t TinyLfuMap<TKey, TValue, THash>::GetEvictCount() const
+{ return m_EvictCount; }
+
+//-------------------------------------------------------------------------------------------------
+//      入場拒否数を取得します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+uint64_t TinyLfuMap<TKey, TValue, THash>::GetRejectCount() const
+{ return m_RejectCount; }
+
+//-------------------------------------------------------------------------------------------------
+//      統計情報をリセットします.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void TinyLfuMap<TKey, TValue, THash>::ResetStats()
+{
+    m_HitCount    = 0;
+    m_MissCount   = 0;
+    m_EvictCount  = 0;
+    m_RejectCount = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ノードを領域のリストの先頭に繋ぎます.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void TinyLfuMap<TKey, TValue, THash>::LinkFront(uint32_t segment, Node* pNode)
+{
+    auto& list = m_Segment[segment];
+
+    pNode->Segment = segment;
+    pNode->pPrev   = nullptr;
+    pNode->pNext   = list.pHead;
+
+    if ( list.pHead != nullptr )
+    { list.pHead->pPrev = pNode; }
+    else
+    { list.pTail = pNode; }
+
+    list.pHead   = pNode;
+    list.Weight += pNode->Weight;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ノードを領域のリストから外します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void TinyLfuMap<TKey, TValue, THash>::Unlink(Node* pNode)
+{
+    auto& list = m_Segment[pNode->Segment];
+
+    if ( pNode->pPrev != nullptr )
+    { pNode->pPrev->pNext = pNode->pNext; }
+    else
+    { list.pHead = pNode->pNext; }
+
+    if ( pNode->pNext != nullptr )
+    { pNode->pNext->pPrev = pNode->pPrev; }
+    else
+    { list.pTail = pNode->pPrev; }
+
+    pNode->pPrev  = nullptr;
+    pNode->pNext  = nullptr;
+    list.Weight  -= pNode->Weight;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      アクセスされたノードを移動します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void TinyLfuMap<TKey, TValue, THash>::OnAccess(Node* pNode)
+{
+    if ( pNode->PinCount != 0 )
+    { return; }
+
+    auto segment = pNode->Segment;
+    if ( segment == SEGMENT_PROTECTED && pNode == m_Segment[segment].pHead )
+    { return; }
+
+    Unlink(pNode);
+
+    if ( segment == SEGMENT_WINDOW )
+    {
+        LinkFront(SEGMENT_WINDOW, pNode);
+        return;
+    }
+
+    // 仮領域で再びアクセスされたノードは保護領域に昇格する.
+    LinkFront(SEGMENT_PROTECTED, pNode);
+    if ( segment == SEGMENT_PROBATION )
+    { DemoteProtected(pNode); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      リストから外したノードを追い出します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void TinyLfuMap<TKey, TValue, THash>::Evict(Node* pNode)
+{
+    if ( m_OnEvict )
+    { m_OnEvict(*pNode->pKey, pNode->Value); }
+
+    m_Weight -= pNode->Weight;
+    m_EvictCount++;
+
+    // キーは消去対象のノード内を指すため, イテレータで消去する.
+    m_Table.erase(m_Table.find(*pNode->pKey));
+}
+
+//-------------------------------------------------------------------------------------------------
+//      領域ごとの目標容量を更新します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void TinyLfuMap<TKey, TValue, THash>::UpdateCapacity()
+{
+    auto window = m_Capacity / 100;
+    if ( window == 0 && m_Capacity > 0 )
+    { window = 1; }
+
+    auto main = m_Capacity - window;
+
+    m_Segment[SEGMENT_WINDOW   ].Capacity = window;
+    m_Segment[SEGMENT_PROTECTED].Capacity = main * 80 / 100;
+    m_Segment[SEGMENT_PROBATION].Capacity = main - m_Segment[SEGMENT_PROTECTED].Capacity;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      保護領域からあふれたノードを仮領域に降格します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void TinyLfuMap<TKey, TValue, THash>::DemoteProtected(const Node* pKeep)
+{
+    auto& list = m_Segment[SEGMENT_PROTECTED];
+    while( list.Weight > list.Capacity && list.pTail != nullptr && list.pTail != pKeep )
+    {
+        auto pNode = list.pTail;
+        Unlink(pNode);
+        LinkFront(SEGMENT_PROBATION, pNode);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ウィンドウからあふれたノードをメイン領域に入れるか判定します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void TinyLfuMap<TKey, TValue, THash>::Admit(Node* pCandidate, size_t limit)
+{
+    auto pVictim = m_Segment[SEGMENT_PROBATION].pTail;
+    if ( pVictim == nullptr )
+    { pVictim = m_Segment[SEGMENT_PROTECTED].pTail; }
+
+    // 追い出し候補より頻繁に使われている場合だけ入れ替える.
+    if ( pVictim != nullptr
+      && m_Sketch.Estimate(*pCandidate->pKey) <= m_Sketch.Estimate(*pVictim->pKey) )
+    {
+        m_RejectCount++;
+        Evict(pCandidate);
+        return;
+    }
+
+    LinkFront(SEGMENT_PROBATION, pCandidate);
+
+    // 重みが大きい場合は複数の追い出し候補と入れ替わる.
+    while( m_Weight > limit )
+    {
+        pVictim = m_Segment[SEGMENT_PROBATION].pTail;
+        if ( pVictim == pCandidate )
+        { pVictim = m_Segment[SEGMENT_PROTECTED].pTail; }
+
+        if ( pVictim == nullptr )
+        { break; }
+
+        Unlink(pVictim);
+        Evict(pVictim);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      重みの合計が指定値以下になるまで追い出します.
+//-------------------------------------------------------------------------------------------------
+template<typename TKey, typename TValue, typename THash> inline
+void TinyLfuMap<TKey, TValue, THash>::EvictTo(size_t limit, const Node* pKeep)
+{
+    // ウィンドウからあふれたノードは, 空きがあればそのまま, 無ければ頻度で選別してメイン領域に移す.
+    auto& window = m_Segment[SEGMENT_WINDOW];
+    while( window.Weight > window.Capacity && window.pTail != nullptr && window.pTail != pKeep )
+    {
+        auto pNode = window.pTail;
+        Unlink(pNode);
+
+        if ( m_Weight <= limit )
+        { LinkFront(SEGMENT_PROBATION, pNode); }
+        else
+        { Admit(pNode, limit); }
+    }
+
+    // 残りは仮領域, 保護領域, ウィンドウの順に最も古いノードから追い出す.
+    static const uint32_t kOrder[NUM_SEGMENT_TYPE] = {
+        SEGMENT_PROBATION,
+        SEGMENT_PROTECTED,
+        SEGMENT_WINDOW,
+    };
+
+    while( m_Weight > limit )
+    {
+        Node* pVictim = nullptr;
+        for( auto segment : kOrder )
+        {
+            auto pTail = m_Segment[segment].pTail;
+            if ( pTail != nullptr && pTail != pKeep )
+            {
+                pVictim = pTail;
+                break;
+            }
+        }
+
+        if ( pVictim == nullptr )
+        { break; }
+
+        Unlink(pVictim);
+        Evict(pVictim);
+    }
+}
+
+} // namespace asdx
@@ -0,0 +1,284 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxTlsfHeap.h
+// Desc : Two-Level Segregated Fit Heap.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+#include <asdxMemoryTracker.h>
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      呼び出し元を記録してアセットデータ用のメモリを確保します.
+//-------------------------------------------------------------------------------------------------
+#define ASDX_ALLOC_ASSET( size, tag )   asdx::AllocAssetMemory( (size), (tag), __FILE__, __LINE__ )
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TlsfHeapDesc structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct TlsfHeapDesc
+{
+    size_t      PoolSize;       //!< 初期化時に確保するプールのサイズです.
+    size_t      GrowSize;       //!< 容量不足時に追加するプールのサイズです. 0 の場合はプールを追加しません.
+    size_t      MaxSize;        //!< プールの合計サイズの上限です. 0 の場合は上限を設けません.
+
+    TlsfHeapDesc()
+    : PoolSize  ( 64 * 1024 * 1024 )
+    , GrowSize  ( 0 )
+    , MaxSize   ( 0 )
+    { /* DO_NOTHING */ }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TlsfStats structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct TlsfStats
+{
+    uint32_t    PoolCount;          //!< プール数です.
+    size_t      PoolSize;           //!< プールの合計サイズです.
+    size_t      UsedSize;           //!< 払い出し中のブロックの合計サイズです.
+    size_t      PeakUsedSize;       //!< UsedSize の最大値です.
+    size_t      FreeSize;           //!< 空きブロックの合計サイズです.
+    size_t      LargestFreeSize;    //!< 最大の空きブロックのサイズです.
+    uint32_t    FreeBlockCount;     //!< 空きブロック数です.
+    uint32_t    AllocCount;         //!< 払い出し中のブロック数です.
+    uint64_t    FailCount;          //!< 確保に失敗した回数です.
+    float       Fragmentation;      //!< 断片化率 ( 1 - LargestFreeSize / FreeSize ) です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TlsfTagStats structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct TlsfTagStats
+{
+    size_t      UsedSize;           //!< 払い出し中のブロックの合計サイズです.
+    size_t      PeakUsedSize;       //!< UsedSize の最大値です.
+    uint32_t    AllocCount;         //!< 払い出し中のブロック数です.
+    uint64_t    TotalAllocCount;    //!< 累計の確保回数です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TlsfHeap class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  Two-Level Segregated Fit アルゴリズムによる汎用ヒープです.
+//! @note   Alloc() / Free() はビットマップ検索のみで完了する O(1) の処理です.
+//!         全ての公開メソッドは内部のミューテックスで保護されます.
+class TlsfHeap
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    static const size_t kAlignment   = 16;                  //!< 最小アライメントです.
+    static const size_t kMaxPoolSize = size_t(1) << 31;     //!< 1プールあたりの最大サイズです.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    TlsfHeap();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~TlsfHeap();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      desc        構成設定です.
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool Init( const TlsfHeapDesc& desc );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      終了処理を行います. 払い出し中のブロックも含めて全てのプールを解放します.
+    //---------------------------------------------------------------------------------------------
+    void Term();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      プールを追加します.
+    //!
+    //! @param[in]      size        プールのサイズです. kMaxPoolSize 以下である必要があります.
+    //! @retval true    追加に成功.
+    //! @retval false   追加に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool AddPool( size_t size );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全体が空きになっている追加プールを解放します.
+    //!
+    //! @return     解放したプール数を返却します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t Trim();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      メモリを確保します.
+    //!
+    //! @param[in]      size        確保するサイズです.
+    //! @param[in]      tag         集計用のタグです. HEAP_TAG_COUNT 未満である必要があります.
+    //! @param[in]      alignment   アライメントです. 2の累乗である必要があります.
+    //! @return     確保したメモリを返却します. 失敗した場合は nullptr を返却します.
+    //---------------------------------------------------------------------------------------------
+    void* Alloc( size_t size, uint32_t tag = HEAP_TAG_DEFAULT, size_t alignment = kAlignment );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      メモリを解放します.
+    //!
+    //! @param[in]      ptr         このヒープから確保したメモリです. nullptr の場合は何もしません.
+    //---------------------------------------------------------------------------------------------
+    void Free( void* ptr );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      指定ポインタがこのヒープのプール内を指すかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool Contains( const void* ptr ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      確保済みブロックの使用可能なサイズを取得します.
+    //---------------------------------------------------------------------------------------------
+    size_t GetBlockSize( const void* ptr ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      統計情報を取得します.
+    //---------------------------------------------------------------------------------------------
+    TlsfStats GetStats() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      タグごとの統計情報を取得します.
+    //!
+    //! @param[in]      tag         タグです.
+    //---------------------------------------------------------------------------------------------
+    TlsfTagStats GetTagStats( uint32_t tag ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全ブロックを走査して整合性を検証します. デバッグ用途です.
+    //!
+    //! @retval true    整合性に問題なし.
+    //! @retval false   ヒープの破壊を検出.
+    //---------------------------------------------------------------------------------------------
+    bool Validate() const;
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    static const uint32_t kSlIndexCountLog2 = 5;                                        //!< 第2レベルの分割数 (log2) です.
+    static const uint32_t kSlIndexCount     = 1u << kSlIndexCountLog2;                  //!< 第2レベルの分割数です.
+    static const uint32_t kFlIndexShift     = kSlIndexCountLog2 + 4;                    //!< 第1レベルの最小ビット位置です.
+    static const uint32_t kFlIndexMax       = 32;                                       //!< 第1レベルの最大ビット位置です.
+    static const uint32_t kFlIndexCount     = kFlIndexMax - kFlIndexShift + 1;          //!< 第1レベルの分割数です.
+
+    struct Block;
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Pool structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Pool
+    {
+        uint8_t*    pMemory;        //!< プールの先頭です.
+        size_t      Size;           //!< プールのサイズです.
+    };
+
+    mutable std::mutex  m_Lock;                                     //!< ロックです.
+    TlsfHeapDesc        m_Desc;                                     //!< 構成設定です.
+    std::vector<Pool>   m_Pools;                                    //!< プールです.
+    uint32_t            m_FlBitmap;                                 //!< 第1レベルのビットマップです.
+    uint32_t            m_SlBitmap  [kFlIndexCount];                //!< 第2レベルのビットマップです.
+    Block*              m_pFreeList [kFlIndexCount][kSlIndexCount]; //!< 空きブロックリストです.
+    size_t              m_PoolSize;                                 //!< プールの合計サイズです.
+    size_t              m_UsedSize;                                 //!< 払い出し中の合計サイズです.
+    size_t              m_PeakUsedSize;                             //!< 払い出し中の合計サイズの最大値です.
+    size_t              m_FreeSize;                                 //!< 空きブロックの合計サイズです.
+    uint32_t            m_FreeBlockCount;                           //!< 空きブロック数です.
+    uint32_t            m_AllocCount;                               //!< 払い出し中のブロック数です.
+    uint64_t            m_FailCount;                                //!< 確保に失敗した回数です.
+    TlsfTagStats        m_TagStats  [HEAP_TAG_COUNT];               //!< タグごとの統計情報です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    TlsfHeap             ( const TlsfHeap& ) = delete;
+    TlsfHeap& operator = ( const TlsfHeap& ) = delete;
+
+    bool    AddPoolNoLock       ( size_t size );
+    void*   AllocNoLock         ( size_t size, uint32_t tag, size_t alignment );
+    Block*  FindFreeBlock       ( size_t size );
+    void    InsertFreeBlock     ( Block* pBlock );
+    void    RemoveFreeBlock     ( Block* pBlock );
+    Block*  SplitBlock          ( Block* pBlock, size_t size );
+    Block*  MergeBlock          ( Block* pBlock );
+    bool    ContainsNoLock      ( const void* ptr ) const;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      アセットデータ用のヒープを設定します.
+//!
+//! @param[in]      pHeap       ResTexture, ResMesh, Font のデータに使用するヒープです.
+//!                             nullptr の場合はシステムから確保します.
+//! @note       確保したメモリは確保元のヒープを記録しているので, 確保済みのメモリがあってもヒープを切り替えられます.
+//!             ただし, 切り替え前のヒープも含めて, そこから確保したアセットデータが全て解放されるまで破棄しないでください.
+//-------------------------------------------------------------------------------------------------
+void SetAssetHeap( TlsfHeap* pHeap );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      アセットデータ用のヒープを取得します.
+//-------------------------------------------------------------------------------------------------
+TlsfHeap* GetAssetHeap();
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      アセットデータ用のメモリを確保します.
+//!
+//! @param[in]      size        確保するサイズです.
+//! @param[in]      tag         集計用のタグです.
+//! @param[in]      file        MemoryTracker に記録する呼び出し元のファイル名です.
+//! @param[in]      line        MemoryTracker に記録する呼び出し元の行番号です.
+//! @return     確保したメモリを返却します. 失敗した場合は nullptr を返却します.
+//! @note       ヒープが未設定または容量不足の場合はシステムから確保します.
+//!             先頭に確保元を記録したヘッダが付くため, 解放には必ず FreeAssetMemory() を使用してください.
+//!             通常は呼び出し元を記録する ASDX_ALLOC_ASSET マクロを使用してください.
+//-------------------------------------------------------------------------------------------------
+uint8_t* AllocAssetMemory( size_t size, uint32_t tag, const char* file = nullptr, int line = 0 );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      AllocAssetMemory() で確保したメモリを解放します.
+//!
+//! @param[in]      ptr         解放するメモリです. nullptr の場合は何もしません.
+//! @note       現在のヒープに関わらず, 確保したヒープへ解放します.
+//-------------------------------------------------------------------------------------------------
+void FreeAssetMemory( void* ptr );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      AllocAssetMemory() で確保したメモリを解放し, nullptr を設定します.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+void SafeFreeAssetMemory( T*& ptr )
+{
+    FreeAssetMemory( ptr );
+    ptr = nullptr;
+}
+
+} // namespace asdx
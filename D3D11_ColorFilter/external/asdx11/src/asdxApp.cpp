@@ -15,6 +15,10 @@
 #include <asdxMisc.h>
 #include <asdxRenderState.h>
 #include <asdxSound.h>
+#include <asdxJobSystem.h>
+#include <asdxAsyncLoader.h>
+#include <asdxIoService.h>
+#include <asdxDerivedDataCache.h>
 
 
 namespace /* anonymous */ {
@@ -246,6 +250,7 @@ Application::Application()
 , m_hIcon               ( nullptr )
 , m_hMenu               ( nullptr )
 , m_hAccel              ( nullptr )
+, m_CacheDesc           ()
 #if ASDX_IS_DEBUG
 , m_pD3D11Debug         ( nullptr )
 #endif//ASDX_IS_DEBUG
@@ -299,6 +304,7 @@ Application::Application( LPCWSTR title, UINT width, UINT height, HICON hIcon, H
 , m_hIcon               ( hIcon )
 , m_hMenu               ( hMenu )
 , m_hAccel              ( hAccel )
+, m_CacheDesc           ()
 #if ASDX_IS_DEBUG
 , m_pD3D11Debug         ( nullptr )
 #endif//ASDX_IS_DEBUG
@@ -364,6 +370,10 @@ FLOAT Application::GetFPS()
 //-----------------------------------------------------------------------------
 bool Application::InitApp()
 {
+    // ロガーの初期化. アプリ側で初期化済みの場合はその設定を使います.
+    if ( !SystemLogger::GetInstance().IsInit() && !SystemLogger::GetInstance().Init() )
+    { return false; }
+
     // COMライブラリの初期化.
     HRESULT hr = CoInitialize( nullptr );
     if ( FAILED(hr) )
@@ -412,6 +422,28 @@ bool Application::InitApp()
         return false;
     }
 
+    // ジョブシステムの初期化.
+    if ( !JobSystem::GetInstance().Init() )
+    {
+        ELOG( "Error : JobSystem::Init() Failed." );
+        return false;
+    }
+
+    // I/O サービスの初期化.
+    if ( !IoService::GetInstance().Init() )
+    {
+        ELOG( "Error : IoService::Init() Failed." );
+        return false;
+    }
+
+    // 派生データキャッシュの初期化. アプリ側で初期化済みの場合はその設定を使います.
+    // 使えない場合も変換するだけなので, 警告を出して続行します.
+    if ( m_CacheDesc.MaxSize > 0 && !DerivedDataCache::GetInstance().IsInit() )
+    {
+        if ( !DerivedDataCache::GetInstance().Init( m_CacheDesc ) )
+        { WLOGA( "Warning : DerivedDataCache::Init() Failed. dir = %s", m_CacheDesc.Dir.c_str() ); }
+    }
+
     // アプリケーション固有の初期化.
     if ( !OnInit() )
     {
@@ -442,9 +474,21 @@ void Application::TermApp()
         m_pDeviceContext->Flush();
     }
 
+    // 読み込み中のリソースを破棄.
+    AsyncLoader::GetInstance().Term();
+
     // アプリケーション固有の終了処理.
     OnTerm();
 
+    // I/O サービスの終了処理. 投入済みの読み込みはここで完了します.
+    IoService::GetInstance().Term();
+
+    // ジョブシステムの終了処理. 残ったジョブはここで実行されます.
+    JobSystem::GetInstance().Term();
+
+    // 派生データキャッシュの終了処理. 変換ジョブが全て終わった後に行います.
+    DerivedDataCache::GetInstance().Term();
+
     // Direct2Dの終了処理.
     TermD2D();
 
@@ -456,6 +500,9 @@ void Application::TermApp()
 
     // COMライブラリの終了処理.
     CoUninitialize();
+
+    // ロガーの終了処理. 残ったログはここで出力されます.
+    SystemLogger::GetInstance().Term();
 }
 
 //-----------------------------------------------------------------------------
@@ -1079,6 +1126,9 @@ void Application::MainLoop()
             frameEventArgs.ElapsedTime     = elapsedTime;
             frameEventArgs.IsStopDraw      = m_IsStopRendering;
 
+            // デコードが完了したリソースを予算時間内で生成.
+            AsyncLoader::GetInstance().Update();
+
             // フレーム遷移処理.
             OnFrameMove( frameEventArgs );
 
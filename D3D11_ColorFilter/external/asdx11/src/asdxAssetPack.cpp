@@ -0,0 +1,909 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxAssetPack.cpp
+// Desc : Asset Pack Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxAssetPack.h>
+#include <asdxHash.h>
+#include <asdxLz.h>
+#include <asdxJobSystem.h>
+#include <asdxLogger.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif//defined(_WIN32)
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const size_t     kCopyChunkSize   = 1024 * 1024;     // ファイル読み込みの単位です.
+static const uint64_t   kMaxStoredRatio  = 90;              // 展開後サイズに対する格納サイズの上限 [%] です.
+static const uint8_t    kZeroPadding[ asdx::ASSET_PACK_ALIGNMENT ] = {};
+
+static_assert( sizeof(asdx::AssetPackHeader) == 64, "AssetPackHeader size mismatch." );
+static_assert( sizeof(asdx::AssetPackEntry)  == 48, "AssetPackEntry size mismatch." );
+
+//-------------------------------------------------------------------------------------------------
+//      アライメントを揃えます.
+//-------------------------------------------------------------------------------------------------
+inline uint64_t AlignUp( uint64_t value, uint64_t alignment )
+{ return ( value + alignment - 1 ) & ~( alignment - 1 ); }
+
+//-------------------------------------------------------------------------------------------------
+//      ゼロ埋めします.
+//-------------------------------------------------------------------------------------------------
+bool WritePadding( FILE* pFile, uint64_t size )
+{
+    while ( size > 0 )
+    {
+        auto count = static_cast<size_t>( (std::min)( size, uint64_t( sizeof(kZeroPadding) ) ) );
+        if ( fwrite( kZeroPadding, 1, count, pFile ) != count )
+        { return false; }
+
+        size -= count;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      パスのハッシュ値を計算します.
+//-------------------------------------------------------------------------------------------------
+inline uint64_t HashAssetPath( const std::string& name )
+{ return asdx::XxHash64::Compute( name.size(), reinterpret_cast<const uint8_t*>( name.c_str() ) ); }
+
+//-------------------------------------------------------------------------------------------------
+//      ブロック数を求めます.
+//-------------------------------------------------------------------------------------------------
+inline uint64_t GetBlockCount( uint64_t size, uint32_t blockSize )
+{ return ( size + blockSize - 1 ) / blockSize; }
+
+//-------------------------------------------------------------------------------------------------
+//      マップした範囲の先読みを要求します.
+//-------------------------------------------------------------------------------------------------
+void PrefetchRange( const uint8_t* pData, uint64_t size )
+{
+    if ( size == 0 )
+    { return; }
+
+#if defined(_WIN32)
+    #if defined(_WIN32_WINNT_WIN8) && ( _WIN32_WINNT >= _WIN32_WINNT_WIN8 )
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = const_cast<uint8_t*>( pData );
+        range.NumberOfBytes  = static_cast<SIZE_T>( size );
+        PrefetchVirtualMemory( GetCurrentProcess(), 1, &range, 0 );
+    #endif
+#else
+    // madvise() はページ境界から指定する必要があります.
+    auto pageSize = static_cast<uintptr_t>( sysconf( _SC_PAGESIZE ) );
+    auto begin    = reinterpret_cast<uintptr_t>( pData ) & ~( pageSize - 1 );
+    auto end      = reinterpret_cast<uintptr_t>( pData ) + static_cast<uintptr_t>( size );
+    madvise( reinterpret_cast<void*>( begin ), size_t( end - begin ), MADV_WILLNEED );
+#endif
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+//      パック内のパスに正規化します.
+//-------------------------------------------------------------------------------------------------
+std::string NormalizeAssetPath( const char* path )
+{
+    std::string result;
+    if ( path == nullptr )
+    { return result; }
+
+    // 先頭の "./" と "/" を除きます.
+    for ( ;; )
+    {
+        if ( path[0] == '.' && ( path[1] == '/' || path[1] == '\\' ) )
+        { path += 2; }
+        else if ( path[0] == '/' || path[0] == '\\' )
+        { path++; }
+        else
+        { break; }
+    }
+
+    result.reserve( strlen( path ) );
+    for ( auto p = path; *p != '\0'; ++p )
+    {
+        auto c = *p;
+        if ( c == '\\' )
+        { c = '/'; }
+        else if ( 'A' <= c && c <= 'Z' )
+        { c = static_cast<char>( c - 'A' + 'a' ); }
+
+        // 連続する区切り文字は1つにまとめます.
+        if ( c == '/' && !result.empty() && result.back() == '/' )
+        { continue; }
+
+        result.push_back( c );
+    }
+
+    return result;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AssetPack class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+AssetPack::AssetPack()
+: m_pBase   ( nullptr )
+, m_Size    ( 0 )
+, m_pHeader ( nullptr )
+, m_pEntries( nullptr )
+, m_pNames  ( nullptr )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+AssetPack::~AssetPack()
+{ Close(); }
+
+//-------------------------------------------------------------------------------------------------
+//      パックファイルを開きます.
+//-------------------------------------------------------------------------------------------------
+bool AssetPack::Open( const char* path )
+{
+    if ( path == nullptr )
+    {
+        ELOGA( "Error : Invalid Argument." );
+        return false;
+    }
+
+    Close();
+
+    // ビューがファイルへの参照を保持するため, マッピング後はハンドルを閉じます.
+#if defined(_WIN32)
+    auto hFile = CreateFileA(
+        path,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr );
+    if ( hFile == INVALID_HANDLE_VALUE )
+    {
+        ELOGA( "Error : File Open Failed. path = %s", path );
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if ( !GetFileSizeEx( hFile, &fileSize ) || fileSize.QuadPart < LONGLONG( sizeof(AssetPackHeader) ) )
+    {
+        ELOGA( "Error : Invalid File Size. path = %s", path );
+        CloseHandle( hFile );
+        return false;
+    }
+
+    auto hMapping = CreateFileMappingA( hFile, nullptr, PAGE_READONLY, 0, 0, nullptr );
+    CloseHandle( hFile );
+    if ( hMapping == nullptr )
+    {
+        ELOGA( "Error : CreateFileMappingA() Failed. path = %s", path );
+        return false;
+    }
+
+    auto pView = MapViewOfFile( hMapping, FILE_MAP_READ, 0, 0, 0 );
+    CloseHandle( hMapping );
+    if ( pView == nullptr )
+    {
+        ELOGA( "Error : MapViewOfFile() Failed. path = %s", path );
+        return false;
+    }
+
+    m_pBase = static_cast<const uint8_t*>( pView );
+    m_Size  = static_cast<uint64_t>( fileSize.QuadPart );
+#else
+    auto fd = open( path, O_RDONLY | O_CLOEXEC );
+    if ( fd < 0 )
+    {
+        ELOGA( "Error : File Open Failed. path = %s", path );
+        return false;
+    }
+
+    struct stat st;
+    if ( fstat( fd, &st ) != 0 || st.st_size < off_t( sizeof(AssetPackHeader) ) )
+    {
+        ELOGA( "Error : Invalid File Size. path = %s", path );
+        close( fd );
+        return false;
+    }
+
+    auto pView = mmap( nullptr, size_t( st.st_size ), PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+    if ( pView == MAP_FAILED )
+    {
+        ELOGA( "Error : mmap() Failed. path = %s", path );
+        return false;
+    }
+
+    m_pBase = static_cast<const uint8_t*>( pView );
+    m_Size  = static_cast<uint64_t>( st.st_size );
+#endif
+
+    m_pHeader = reinterpret_cast<const AssetPackHeader*>( m_pBase );
+    if ( !Validate() )
+    {
+        ELOGA( "Error : Invalid Asset Pack. path = %s", path );
+        Close();
+        return false;
+    }
+
+    m_pEntries = reinterpret_cast<const AssetPackEntry*>( m_pBase + sizeof(AssetPackHeader) );
+    m_pNames   = reinterpret_cast<const char*>( m_pBase + m_pHeader->NameOffset );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      パックファイルを閉じます.
+//-------------------------------------------------------------------------------------------------
+void AssetPack::Close()
+{
+    if ( m_pBase != nullptr )
+    {
+    #if defined(_WIN32)
+        UnmapViewOfFile( m_pBase );
+    #else
+        munmap( const_cast<uint8_t*>( m_pBase ), size_t( m_Size ) );
+    #endif
+    }
+
+    m_pBase    = nullptr;
+    m_Size     = 0;
+    m_pHeader  = nullptr;
+    m_pEntries = nullptr;
+    m_pNames   = nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      開いているかどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool AssetPack::IsOpen() const
+{ return m_pBase != nullptr; }
+
+//-------------------------------------------------------------------------------------------------
+//      エントリ数を取得します.
+//-------------------------------------------------------------------------------------------------
+uint32_t AssetPack::GetEntryCount() const
+{ return ( m_pHeader != nullptr ) ? m_pHeader->EntryCount : 0; }
+
+//-------------------------------------------------------------------------------------------------
+//      エントリ名を取得します.
+//-------------------------------------------------------------------------------------------------
+const char* AssetPack::GetEntryName( uint32_t index ) const
+{
+    if ( index >= GetEntryCount() )
+    { return nullptr; }
+
+    return m_pNames + m_pEntries[index].NameOffset;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      エントリ番号を検索します.
+//-------------------------------------------------------------------------------------------------
+int32_t AssetPack::FindIndex( const char* path ) const
+{
+    if ( !IsOpen() || path == nullptr )
+    { return -1; }
+
+    auto name  = NormalizeAssetPath( path );
+    auto hash  = HashAssetPath( name );
+    auto pEnd  = m_pEntries + m_pHeader->EntryCount;
+    auto itr   = std::lower_bound( m_pEntries, pEnd, hash,
+        []( const AssetPackEntry& entry, uint64_t value ) { return entry.Hash < value; } );
+
+    // ハッシュ値が衝突している場合に備えて名前も比較します.
+    for ( ; itr != pEnd && itr->Hash == hash; ++itr )
+    {
+        if ( strcmp( m_pNames + itr->NameOffset, name.c_str() ) == 0 )
+        { return static_cast<int32_t>( itr - m_pEntries ); }
+    }
+
+    return -1;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      エントリを検索します.
+//-------------------------------------------------------------------------------------------------
+bool AssetPack::Find( const char* path, AssetView& result ) const
+{
+    auto index = FindIndex( path );
+    if ( index < 0 )
+    { return false; }
+
+    return GetEntry( static_cast<uint32_t>( index ), result );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      エントリを取得します.
+//-------------------------------------------------------------------------------------------------
+bool AssetPack::GetEntry( uint32_t index, AssetView& result ) const
+{
+    if ( index >= GetEntryCount() )
+    { return false; }
+
+    auto& entry = m_pEntries[index];
+    if ( entry.Flags & ASSET_PACK_FLAG_COMPRESSED )
+    { return false; }
+
+    result.pData = m_pBase + entry.Offset;
+    result.Size  = entry.Size;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      展開後のサイズを取得します.
+//-------------------------------------------------------------------------------------------------
+uint64_t AssetPack::GetSize( uint32_t index ) const
+{ return ( index < GetEntryCount() ) ? m_pEntries[index].Size : 0; }
+
+//-------------------------------------------------------------------------------------------------
+//      ファイル上のサイズを取得します.
+//-------------------------------------------------------------------------------------------------
+uint64_t AssetPack::GetStoredSize( uint32_t index ) const
+{ return ( index < GetEntryCount() ) ? m_pEntries[index].StoredSize : 0; }
+
+//-------------------------------------------------------------------------------------------------
+//      圧縮されているかどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool AssetPack::IsCompressed( uint32_t index ) const
+{ return ( index < GetEntryCount() ) && ( m_pEntries[index].Flags & ASSET_PACK_FLAG_COMPRESSED ) != 0; }
+
+//-------------------------------------------------------------------------------------------------
+//      エントリを読み込みます.
+//-------------------------------------------------------------------------------------------------
+bool AssetPack::Read( uint32_t index, void* pDst, uint64_t dstSize, bool parallel ) const
+{
+    if ( index >= GetEntryCount() || ( pDst == nullptr && dstSize > 0 ) )
+    {
+        ELOGA( "Error : Invalid Argument." );
+        return false;
+    }
+
+    auto& entry = m_pEntries[index];
+    if ( dstSize < entry.Size )
+    {
+        ELOGA( "Error : Buffer Too Small. name = %s", GetEntryName( index ) );
+        return false;
+    }
+
+    auto pSrc = m_pBase + entry.Offset;
+    auto pOut = static_cast<uint8_t*>( pDst );
+
+    if ( ( entry.Flags & ASSET_PACK_FLAG_COMPRESSED ) == 0 )
+    {
+        if ( entry.Size > 0 )
+        { memcpy( pOut, pSrc, static_cast<size_t>( entry.Size ) ); }
+        return true;
+    }
+
+    // ページフォルトで1ブロックずつ読み込むのを避けるため, 先にまとめて先読みを要求します.
+    PrefetchRange( pSrc, entry.StoredSize );
+
+    auto blockSize  = m_pHeader->BlockSize;
+    auto blockCount = static_cast<uint32_t>( GetBlockCount( entry.Size, blockSize ) );
+    auto pSizes     = reinterpret_cast<const uint32_t*>( pSrc );
+
+    // ブロックの位置を求めます. 格納サイズの合計がペイロードサイズと一致しない場合は破損しています.
+    std::vector<uint64_t> offsets( blockCount + 1 );
+    offsets[0] = uint64_t( blockCount ) * sizeof(uint32_t);
+    for ( uint32_t i = 0; i < blockCount; ++i )
+    { offsets[i + 1] = offsets[i] + ( pSizes[i] & ~ASSET_PACK_BLOCK_RAW ); }
+
+    if ( offsets[blockCount] != entry.StoredSize )
+    {
+        ELOGA( "Error : Invalid Block Table. name = %s", GetEntryName( index ) );
+        return false;
+    }
+
+    std::atomic<uint32_t> errorCount( 0 );
+    auto decode = [&]( uint32_t begin, uint32_t end )
+    {
+        for ( auto i = begin; i < end; ++i )
+        {
+            auto pBlock     = pSrc + offsets[i];
+            auto storedSize = static_cast<size_t>( offsets[i + 1] - offsets[i] );
+            auto rawSize    = static_cast<size_t>( (std::min)( uint64_t( blockSize ), entry.Size - uint64_t( i ) * blockSize ) );
+            auto pBlockDst  = pOut + size_t( i ) * blockSize;
+
+            bool ret;
+            if ( pSizes[i] & ASSET_PACK_BLOCK_RAW )
+            {
+                ret = ( storedSize == rawSize );
+                if ( ret )
+                { memcpy( pBlockDst, pBlock, rawSize ); }
+            }
+            else
+            { ret = LzDecompress( pBlock, storedSize, pBlockDst, rawSize ); }
+
+            if ( !ret )
+            { errorCount.fetch_add( 1, std::memory_order_relaxed ); }
+        }
+    };
+
+    if ( parallel && blockCount > 1 )
+    { JobSystem::GetInstance().ParallelFor( blockCount, decode, 1 ); }
+    else
+    { decode( 0, blockCount ); }
+
+    if ( errorCount.load() != 0 )
+    {
+        ELOGA( "Error : LzDecompress() Failed. name = %s", GetEntryName( index ) );
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ペイロードの CRC を検証します.
+//-------------------------------------------------------------------------------------------------
+bool AssetPack::Verify( uint32_t index ) const
+{
+    if ( index >= GetEntryCount() )
+    { return false; }
+
+    auto& entry = m_pEntries[index];
+    if ( ( entry.Flags & ASSET_PACK_FLAG_COMPRESSED ) == 0 )
+    { return Crc32C( static_cast<size_t>( entry.Size ), m_pBase + entry.Offset ).GetHash() == entry.Crc; }
+
+    std::vector<uint8_t> buffer( static_cast<size_t>( entry.Size ) );
+    if ( !Read( index, buffer.data(), buffer.size() ) )
+    { return false; }
+
+    return Crc32C( buffer.size(), buffer.data() ).GetHash() == entry.Crc;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      全エントリのペイロードの CRC を検証します.
+//-------------------------------------------------------------------------------------------------
+uint32_t AssetPack::VerifyAll() const
+{
+    uint32_t count = 0;
+    for ( uint32_t i = 0; i < GetEntryCount(); ++i )
+    {
+        if ( !Verify( i ) )
+        {
+            ELOGA( "Error : CRC Mismatch. name = %s", GetEntryName( i ) );
+            count++;
+        }
+    }
+
+    return count;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ヘッダと目次を検証します.
+//-------------------------------------------------------------------------------------------------
+bool AssetPack::Validate() const
+{
+    auto& header = *m_pHeader;
+    if ( header.Magic != ASSET_PACK_MAGIC || header.Version != ASSET_PACK_VERSION )
+    { return false; }
+
+    if ( header.FileSize != m_Size )
+    { return false; }
+
+    if ( header.Alignment == 0 || ( header.Alignment & ( header.Alignment - 1 ) ) != 0 )
+    { return false; }
+
+    if ( header.BlockSize < ASSET_PACK_MIN_BLOCK_SIZE || header.BlockSize > ASSET_PACK_MAX_BLOCK_SIZE )
+    { return false; }
+
+    // 目次がファイル内に収まっているかチェックします.
+    auto tocEnd = uint64_t( sizeof(AssetPackHeader) ) + uint64_t( header.EntryCount ) * sizeof(AssetPackEntry);
+    if ( tocEnd > m_Size
+      || header.NameOffset != tocEnd
+      || header.NameSize == 0
+      || header.NameSize > m_Size - tocEnd
+      || header.DataOffset < tocEnd + header.NameSize
+      || header.DataOffset > m_Size )
+    { return false; }
+
+    auto pToc = m_pBase + sizeof(AssetPackHeader);
+    auto crc  = Crc32C( static_cast<size_t>( header.NameSize + tocEnd - sizeof(AssetPackHeader) ), pToc ).GetHash();
+    if ( crc != header.TocCrc )
+    { return false; }
+
+    // 名前テーブルは終端文字で終わるため, 範囲内のオフセットは必ず終端します.
+    auto pNames = reinterpret_cast<const char*>( m_pBase + header.NameOffset );
+    if ( pNames[header.NameSize - 1] != '\0' )
+    { return false; }
+
+    auto pEntries = reinterpret_cast<const AssetPackEntry*>( pToc );
+    for ( uint32_t i = 0; i < header.EntryCount; ++i )
+    {
+        auto& entry = pEntries[i];
+        if ( entry.NameOffset >= header.NameSize )
+        { return false; }
+
+        if ( entry.Offset < header.DataOffset || entry.Offset > m_Size || entry.StoredSize > m_Size - entry.Offset )
+        { return false; }
+
+        if ( entry.Flags & ~ASSET_PACK_FLAG_COMPRESSED )
+        { return false; }
+
+        // 圧縮されている場合はブロックの格納サイズの配列が収まっている必要があります.
+        if ( entry.Flags & ASSET_PACK_FLAG_COMPRESSED )
+        {
+            auto blockCount = GetBlockCount( entry.Size, header.BlockSize );
+            if ( blockCount > UINT32_MAX || entry.StoredSize < blockCount * sizeof(uint32_t) )
+            { return false; }
+        }
+        else if ( entry.StoredSize != entry.Size )
+        { return false; }
+
+        if ( i > 0 && pEntries[i - 1].Hash > entry.Hash )
+        { return false; }
+    }
+
+    return true;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AssetPackWriter class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+AssetPackWriter::AssetPackWriter()
+: m_Compress    ( false )
+, m_BlockSize   ( ASSET_PACK_DEFAULT_BLOCK_SIZE )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+AssetPackWriter::~AssetPackWriter()
+{ Clear(); }
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルを登録します.
+//-------------------------------------------------------------------------------------------------
+bool AssetPackWriter::AddFile( const char* name, const char* srcPath )
+{
+    if ( name == nullptr || srcPath == nullptr || srcPath[0] == '\0' )
+    {
+        ELOGA( "Error : Invalid Argument." );
+        return false;
+    }
+
+    Source source;
+    source.Name = NormalizeAssetPath( name );
+    source.Hash = HashAssetPath( source.Name );
+    source.Path = srcPath;
+
+    if ( source.Name.empty() )
+    {
+        ELOGA( "Error : Invalid Name. name = %s", name );
+        return false;
+    }
+
+    m_Sources.push_back( std::move( source ) );
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      メモリ上のデータを登録します.
+//-------------------------------------------------------------------------------------------------
+bool AssetPackWriter::AddMemory( const char* name, const void* pData, size_t size )
+{
+    if ( name == nullptr || ( pData == nullptr && size > 0 ) )
+    {
+        ELOGA( "Error : Invalid Argument." );
+        return false;
+    }
+
+    Source source;
+    source.Name = NormalizeAssetPath( name );
+    source.Hash = HashAssetPath( source.Name );
+
+    if ( source.Name.empty() )
+    {
+        ELOGA( "Error : Invalid Name. name = %s", name );
+        return false;
+    }
+
+    auto pBytes = static_cast<const uint8_t*>( pData );
+    source.Data.assign( pBytes, pBytes + size );
+
+    m_Sources.push_back( std::move( source ) );
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      パックファイルを書き出します.
+//-------------------------------------------------------------------------------------------------
+bool AssetPackWriter::Write( const char* path )
+{
+    if ( path == nullptr )
+    {
+        ELOGA( "Error : Invalid Argument." );
+        return false;
+    }
+
+    // 読み込み側は二分探索するため, ハッシュ値順に並べます.
+    std::sort( m_Sources.begin(), m_Sources.end(),
+        []( const Source& lhs, const Source& rhs )
+        {
+            if ( lhs.Hash != rhs.Hash )
+            { return lhs.Hash < rhs.Hash; }
+            return lhs.Name < rhs.Name;
+        });
+
+    for ( size_t i = 1; i < m_Sources.size(); ++i )
+    {
+        if ( m_Sources[i - 1].Name == m_Sources[i].Name )
+        {
+            ELOGA( "Error : Duplicate Name. name = %s", m_Sources[i].Name.c_str() );
+            return false;
+        }
+    }
+
+    // 名前テーブルを構築します.
+    std::vector<AssetPackEntry> entries( m_Sources.size() );
+    std::vector<char>           names;
+    for ( size_t i = 0; i < m_Sources.size(); ++i )
+    {
+        memset( &entries[i], 0, sizeof(AssetPackEntry) );
+        entries[i].Hash       = m_Sources[i].Hash;
+        entries[i].NameOffset = static_cast<uint32_t>( names.size() );
+        names.insert( names.end(), m_Sources[i].Name.begin(), m_Sources[i].Name.end() );
+        names.push_back( '\0' );
+    }
+
+    // エントリが無い場合も名前テーブルは終端文字を1つ持ちます.
+    if ( names.empty() )
+    { names.push_back( '\0' ); }
+
+    if ( names.size() > UINT32_MAX )
+    {
+        ELOGA( "Error : Name Table Too Large." );
+        return false;
+    }
+
+    AssetPackHeader header = {};
+    header.Magic      = ASSET_PACK_MAGIC;
+    header.Version    = ASSET_PACK_VERSION;
+    header.EntryCount = static_cast<uint32_t>( entries.size() );
+    header.Alignment  = ASSET_PACK_ALIGNMENT;
+    header.BlockSize  = m_BlockSize;
+    header.NameOffset = sizeof(AssetPackHeader) + entries.size() * sizeof(AssetPackEntry);
+    header.NameSize   = names.size();
+    header.DataOffset = AlignUp( header.NameOffset + header.NameSize, ASSET_PACK_ALIGNMENT );
+
+    FILE* pFile = nullptr;
+    auto err = fopen_s( &pFile, path, "wb" );
+    if ( err != 0 || pFile == nullptr )
+    {
+        ELOGA( "Error : File Open Failed. path = %s", path );
+        return false;
+    }
+
+    // ペイロードを書き出した後で目次を埋めるため, 先に領域だけ確保します.
+    auto ret    = WritePadding( pFile, header.DataOffset );
+    auto offset = header.DataOffset;
+
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> packed;
+    for ( size_t i = 0; ret && i < m_Sources.size(); ++i )
+    {
+        auto& source = m_Sources[i];
+        auto& entry  = entries[i];
+
+        auto pData = &source.Data;
+        if ( !source.Path.empty() )
+        {
+            if ( !LoadSource( source, data ) )
+            {
+                ret = false;
+                break;
+            }
+
+            pData = &data;
+        }
+
+        entry.Size = pData->size();
+        entry.Crc  = Crc32C( pData->size(), pData->data() ).GetHash();
+
+        // 十分に縮み, かつ格納に必要なページ数が減る場合のみ圧縮して格納します.
+        auto pStored = pData;
+        if ( m_Compress && CompressBlocks( *pData, packed ) )
+        {
+            auto storedSize = uint64_t( packed.size() );
+            if ( storedSize * 100 <= entry.Size * kMaxStoredRatio
+              && AlignUp( storedSize, ASSET_PACK_ALIGNMENT ) < AlignUp( entry.Size, ASSET_PACK_ALIGNMENT ) )
+            {
+                pStored      = &packed;
+                entry.Flags |= ASSET_PACK_FLAG_COMPRESSED;
+            }
+        }
+
+        auto aligned = AlignUp( offset, ASSET_PACK_ALIGNMENT );
+        ret    = WritePadding( pFile, aligned - offset );
+        offset = aligned;
+
+        if ( ret && !pStored->empty() )
+        { ret = ( fwrite( pStored->data(), 1, pStored->size(), pFile ) == pStored->size() ); }
+
+        entry.Offset     = offset;
+        entry.StoredSize = pStored->size();
+        offset += entry.StoredSize;
+    }
+
+    if ( ret )
+    {
+        header.FileSize = offset;
+
+        Crc32C toc;
+        if ( !entries.empty() )
+        { toc.Update( entries.size() * sizeof(AssetPackEntry), reinterpret_cast<const uint8_t*>( entries.data() ) ); }
+        toc.Update( names.size(), reinterpret_cast<const uint8_t*>( names.data() ) );
+        header.TocCrc = toc.GetHash();
+
+        ret = ( fseek( pFile, 0, SEEK_SET ) == 0 )
+           && ( fwrite( &header, sizeof(header), 1, pFile ) == 1 )
+           && ( entries.empty() || fwrite( entries.data(), sizeof(AssetPackEntry), entries.size(), pFile ) == entries.size() )
+           && ( fwrite( names.data(), 1, names.size(), pFile ) == names.size() );
+    }
+
+    if ( fclose( pFile ) != 0 )
+    { ret = false; }
+
+    if ( !ret )
+    {
+        ELOGA( "Error : File Write Failed. path = %s", path );
+        remove( path );
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      圧縮を設定します.
+//-------------------------------------------------------------------------------------------------
+void AssetPackWriter::SetCompression( bool enable, uint32_t blockSize )
+{
+    m_Compress  = enable;
+    m_BlockSize = (std::max)( ASSET_PACK_MIN_BLOCK_SIZE, (std::min)( blockSize, ASSET_PACK_MAX_BLOCK_SIZE ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      登録済みのエントリ数を取得します.
+//-------------------------------------------------------------------------------------------------
+uint32_t AssetPackWriter::GetEntryCount() const
+{ return static_cast<uint32_t>( m_Sources.size() ); }
+
+//-------------------------------------------------------------------------------------------------
+//      登録を全て破棄します.
+//-------------------------------------------------------------------------------------------------
+void AssetPackWriter::Clear()
+{ m_Sources.clear(); }
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルを読み込みます.
+//-------------------------------------------------------------------------------------------------
+bool AssetPackWriter::LoadSource( const Source& source, std::vector<uint8_t>& data ) const
+{
+    data.clear();
+
+    FILE* pFile = nullptr;
+    auto err = fopen_s( &pFile, source.Path.c_str(), "rb" );
+    if ( err != 0 || pFile == nullptr )
+    {
+        ELOGA( "Error : File Open Failed. path = %s", source.Path.c_str() );
+        return false;
+    }
+
+    for ( ;; )
+    {
+        auto size = data.size();
+        data.resize( size + kCopyChunkSize );
+
+        auto count = fread( data.data() + size, 1, kCopyChunkSize, pFile );
+        data.resize( size + count );
+
+        if ( count < kCopyChunkSize )
+        { break; }
+    }
+
+    auto ret = ( ferror( pFile ) == 0 );
+    fclose( pFile );
+
+    if ( !ret )
+    {
+        ELOGA( "Error : File Read Failed. path = %s", source.Path.c_str() );
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ブロック単位で圧縮します.
+//-------------------------------------------------------------------------------------------------
+bool AssetPackWriter::CompressBlocks( const std::vector<uint8_t>& data, std::vector<uint8_t>& result ) const
+{
+    result.clear();
+    if ( data.empty() )
+    { return false; }
+
+    auto blockSize  = m_BlockSize;
+    auto blockCount = static_cast<uint32_t>( GetBlockCount( data.size(), blockSize ) );
+
+    // 縮まなかったブロックは空のままにして, 無圧縮で格納します.
+    std::vector<std::vector<uint8_t>> blocks( blockCount );
+    JobSystem::GetInstance().ParallelFor( blockCount, [&]( uint32_t begin, uint32_t end )
+    {
+        for ( auto i = begin; i < end; ++i )
+        {
+            auto pSrc    = data.data() + size_t( i ) * blockSize;
+            auto rawSize = (std::min)( size_t( blockSize ), data.size() - size_t( i ) * blockSize );
+            auto& block  = blocks[i];
+
+            block.resize( LzCompressBound( rawSize ) );
+            auto size = LzCompress( pSrc, rawSize, block.data(), block.size() );
+
+            if ( size == 0 || size >= rawSize )
+            { block.clear(); }
+            else
+            { block.resize( size ); }
+        }
+    }, 1 );
+
+    std::vector<uint32_t> sizes( blockCount );
+    result.resize( size_t( blockCount ) * sizeof(uint32_t) );
+
+    for ( uint32_t i = 0; i < blockCount; ++i )
+    {
+        auto& block = blocks[i];
+        if ( block.empty() )
+        {
+            auto pSrc    = data.data() + size_t( i ) * blockSize;
+            auto rawSize = (std::min)( size_t( blockSize ), data.size() - size_t( i ) * blockSize );
+            sizes[i] = static_cast<uint32_t>( rawSize ) | ASSET_PACK_BLOCK_RAW;
+            result.insert( result.end(), pSrc, pSrc + rawSize );
+        }
+        else
+        {
+            sizes[i] = static_cast<uint32_t>( block.size() );
+            result.insert( result.end(), block.begin(), block.end() );
+        }
+    }
+
+    memcpy( result.data(), sizes.data(), sizes.size() * sizeof(uint32_t) );
+    return true;
+}
+
+} // namespace asdx
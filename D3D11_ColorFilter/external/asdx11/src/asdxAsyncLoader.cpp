@@ -0,0 +1,289 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxAsyncLoader.cpp
+// Desc : Asynchronous Resource Loader.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxAsyncLoader.h>
+#include <asdxLogger.h>
+#include <chrono>
+#include <cassert>
+
+#if defined(_WIN32)
+#include <objbase.h>
+#endif//defined(_WIN32)
+
+
+namespace /* anonymous */ {
+
+#if defined(_WIN32)
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ComScope class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  WIC によるデコードのため, ワーカースレッドで COM を初期化します.
+class ComScope
+{
+public:
+    ComScope()
+    : m_Init( false )
+    {
+        // メインスレッドで実行された場合は RPC_E_CHANGED_MODE が返るため, 後始末は不要です.
+        auto hr = CoInitializeEx( nullptr, COINIT_MULTITHREADED );
+        m_Init = SUCCEEDED( hr );
+    }
+
+    ~ComScope()
+    {
+        if ( m_Init )
+        { CoUninitialize(); }
+    }
+
+private:
+    bool m_Init;
+};
+
+thread_local ComScope t_ComScope;
+#endif//defined(_WIN32)
+
+//-------------------------------------------------------------------------------------------------
+//      デコードを行うスレッドの準備をします.
+//-------------------------------------------------------------------------------------------------
+inline void PrepareDecodeThread()
+{
+#if defined(_WIN32)
+    // thread_local 変数は初回の使用時に初期化されます.
+    (void)&t_ComScope;
+#endif//defined(_WIN32)
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AsyncResource class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+AsyncResource::AsyncResource( const char* path )
+: m_RefCount( 0 )
+, m_State   ( LOAD_STATE_LOADING )
+, m_Path    ( ( path != nullptr ) ? path : "" )
+, m_Decoded ( false )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+AsyncResource::~AsyncResource()
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      参照カウントを増やします.
+//-------------------------------------------------------------------------------------------------
+void AsyncResource::AddRef()
+{ m_RefCount.fetch_add( 1, std::memory_order_relaxed ); }
+
+//-------------------------------------------------------------------------------------------------
+//      参照カウントを減らします.
+//-------------------------------------------------------------------------------------------------
+void AsyncResource::Release()
+{
+    if ( m_RefCount.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+    { delete this; }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      参照カウントを取得します.
+//-------------------------------------------------------------------------------------------------
+uint32_t AsyncResource::GetCount() const
+{ return m_RefCount.load( std::memory_order_relaxed ); }
+
+//-------------------------------------------------------------------------------------------------
+//      読み込み状態を取得します.
+//-------------------------------------------------------------------------------------------------
+LOAD_STATE AsyncResource::GetState() const
+{ return LOAD_STATE( m_State.load( std::memory_order_acquire ) ); }
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルパスを取得します.
+//-------------------------------------------------------------------------------------------------
+const std::string& AsyncResource::GetPath() const
+{ return m_Path; }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AsyncLoader class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+const double AsyncLoader::kDefaultFrameBudget = 2.0;
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+AsyncLoader::AsyncLoader()
+: m_PendingCount( 0 )
+, m_FrameBudget ( kDefaultFrameBudget )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+AsyncLoader::~AsyncLoader()
+{
+    // 終了時はジョブシステムが先に破棄されている可能性があるため, Term() は呼び出しません.
+    assert( m_PendingCount.load() == 0 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      シングルトンインスタンスを取得します.
+//-------------------------------------------------------------------------------------------------
+AsyncLoader& AsyncLoader::GetInstance()
+{
+    static AsyncLoader s_Instance;
+    return s_Instance;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      読み込みを要求します.
+//-------------------------------------------------------------------------------------------------
+bool AsyncLoader::Request( AsyncResource* pResource )
+{
+    if ( pResource == nullptr )
+    {
+        ELOGA( "Error : Invalid Argument." );
+        return false;
+    }
+
+    // 完了キューから取り出されるまでローダーが参照を保持します.
+    pResource->AddRef();
+    pResource->m_State.store( LOAD_STATE_LOADING, std::memory_order_release );
+    m_PendingCount.fetch_add( 1, std::memory_order_relaxed );
+
+    JobSystem::GetInstance().Run( &m_Counter, [this, pResource]()
+    {
+        PrepareDecodeThread();
+
+        // 例外で完了キューに積まれないと読み込み中のまま残るため, 失敗として扱います.
+        try
+        { pResource->m_Decoded = pResource->OnDecode(); }
+        catch( ... )
+        {
+            ELOGA( "Error : Exception Occurred In OnDecode(). path = %s", pResource->GetPath().c_str() );
+            pResource->m_Decoded = false;
+        }
+
+        std::lock_guard<std::mutex> locker( m_Lock );
+        m_Completed.push_back( pResource );
+    });
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      設定された予算時間内で GPU リソースを生成します.
+//-------------------------------------------------------------------------------------------------
+uint32_t AsyncLoader::Update()
+{ return Flush( m_FrameBudget ); }
+
+//-------------------------------------------------------------------------------------------------
+//      指定した予算時間内で GPU リソースを生成します.
+//-------------------------------------------------------------------------------------------------
+uint32_t AsyncLoader::Flush( double budgetMsec )
+{
+    auto start = std::chrono::steady_clock::now();
+    auto count = 0u;
+
+    while( auto pResource = PopCompleted() )
+    {
+        auto result = pResource->m_Decoded;
+
+        // 呼び出し元が既にハンドルを手放している場合は生成しません.
+        if ( result && pResource->GetCount() > 1 )
+        { result = pResource->OnCreate(); }
+
+        pResource->OnDiscard();
+        pResource->m_State.store( result ? LOAD_STATE_READY : LOAD_STATE_FAILED, std::memory_order_release );
+
+        if ( !result )
+        { WLOGA( "Warning : Async Load Failed. path = %s", pResource->GetPath().c_str() ); }
+
+        m_PendingCount.fetch_sub( 1, std::memory_order_relaxed );
+        pResource->Release();
+        count++;
+
+        if ( budgetMsec > 0.0 )
+        {
+            auto elapsed = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+            if ( elapsed >= budgetMsec )
+            { break; }
+        }
+    }
+
+    return count;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      全ての読み込みが完了するまで待機します.
+//-------------------------------------------------------------------------------------------------
+void AsyncLoader::WaitAll()
+{
+    JobSystem::GetInstance().Wait( &m_Counter );
+    Flush( 0.0 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      終了処理を行います.
+//-------------------------------------------------------------------------------------------------
+void AsyncLoader::Term()
+{
+    JobSystem::GetInstance().Wait( &m_Counter );
+
+    while( auto pResource = PopCompleted() )
+    {
+        pResource->OnDiscard();
+        pResource->m_State.store( LOAD_STATE_FAILED, std::memory_order_release );
+
+        m_PendingCount.fetch_sub( 1, std::memory_order_relaxed );
+        pResource->Release();
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      完了していない読み込みの数を取得します.
+//-------------------------------------------------------------------------------------------------
+uint32_t AsyncLoader::GetPendingCount() const
+{ return m_PendingCount.load( std::memory_order_relaxed ); }
+
+//-------------------------------------------------------------------------------------------------
+//      1フレームあたりの予算時間を設定します.
+//-------------------------------------------------------------------------------------------------
+void AsyncLoader::SetFrameBudget( double budgetMsec )
+{ m_FrameBudget = budgetMsec; }
+
+//-------------------------------------------------------------------------------------------------
+//      1フレームあたりの予算時間を取得します.
+//-------------------------------------------------------------------------------------------------
+double AsyncLoader::GetFrameBudget() const
+{ return m_FrameBudget; }
+
+//-------------------------------------------------------------------------------------------------
+//      デコードが完了したリソースを取り出します.
+//-------------------------------------------------------------------------------------------------
+AsyncResource* AsyncLoader::PopCompleted()
+{
+    std::lock_guard<std::mutex> locker( m_Lock );
+    if ( m_Completed.empty() )
+    { return nullptr; }
+
+    auto pResource = m_Completed.front();
+    m_Completed.pop_front();
+    return pResource;
+}
+
+} // namespace asdx
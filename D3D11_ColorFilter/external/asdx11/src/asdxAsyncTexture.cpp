@@ -0,0 +1,249 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxAsyncTexture.cpp
+// Desc : Asynchronous Texture Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxAsyncTexture.h>
+#include <asdxDerivedDataCache.h>
+#include <asdxLogger.h>
+#include <cctype>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const char*      kTextureConverter        = "ResTexture";
+static const uint32_t   kTextureConverterVersion = 1;   // ResTexture の読み込み結果が変わる修正をした場合は値を上げてください.
+
+//-------------------------------------------------------------------------------------------------
+//      小文字にした拡張子を取得します.
+//-------------------------------------------------------------------------------------------------
+std::string GetLowerExt( const std::string& path )
+{
+    auto dot = path.find_last_of( '.' );
+    if ( dot == std::string::npos || path.find_first_of( "/\\", dot ) != std::string::npos )
+    { return std::string(); }
+
+    auto result = path.substr( dot + 1 );
+    for ( auto& c : result )
+    { c = static_cast<char>( tolower( static_cast<unsigned char>( c ) ) ); }
+
+    return result;
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AsyncTexture2D class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+AsyncTexture2D::AsyncTexture2D
+(
+    ID3D11Device*           pDevice,
+    ID3D11DeviceContext*    pDeviceContext,
+    const AssetPack*        pPack,
+    const char*             path
+)
+: AsyncResource     ( path )
+, m_pDevice         ( pDevice )
+, m_pDeviceContext  ( pDeviceContext )
+, m_pPack           ( pPack )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+AsyncTexture2D::~AsyncTexture2D()
+{
+    m_Resource.Release();
+    m_Texture .Release();
+    m_Dummy   .Release();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      読み込みを開始します.
+//-------------------------------------------------------------------------------------------------
+bool AsyncTexture2D::Load
+(
+    ID3D11Device*               pDevice,
+    ID3D11DeviceContext*        pDeviceContext,
+    const char*                 path,
+    RefPtr<AsyncTexture2D>&     result
+)
+{ return Load( pDevice, pDeviceContext, nullptr, path, result ); }
+
+//-------------------------------------------------------------------------------------------------
+//      パックファイルから読み込みを開始します.
+//-------------------------------------------------------------------------------------------------
+bool AsyncTexture2D::Load
+(
+    ID3D11Device*               pDevice,
+    ID3D11DeviceContext*        pDeviceContext,
+    const AssetPack*            pPack,
+    const char*                 path,
+    RefPtr<AsyncTexture2D>&     result
+)
+{
+    if ( pDevice == nullptr || pDeviceContext == nullptr || path == nullptr )
+    {
+        ELOGA( "Error : Invalid Argument." );
+        return false;
+    }
+
+    RefPtr<AsyncTexture2D> texture( new AsyncTexture2D( pDevice, pDeviceContext, pPack, path ) );
+
+    // 読み込みが完了するまで表示するダミーテクスチャを生成します.
+    {
+        ResTexture dummy;
+        if ( !CreateDummyResTexture( dummy ) )
+        {
+            ELOGA( "Error : CreateDummyResTexture() Failed." );
+            return false;
+        }
+
+        auto ret = texture->m_Dummy.Create( pDevice, pDeviceContext, dummy );
+        dummy.Release();
+
+        if ( !ret )
+        {
+            ELOGA( "Error : Texture2D::Create() Failed." );
+            return false;
+        }
+    }
+
+    if ( !AsyncLoader::GetInstance().Request( texture.GetPtr() ) )
+    {
+        ELOGA( "Error : AsyncLoader::Request() Failed. path = %s", path );
+        return false;
+    }
+
+    result = texture;
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      テクスチャを取得します.
+//-------------------------------------------------------------------------------------------------
+const Texture2D& AsyncTexture2D::GetTexture() const
+{ return IsReady() ? m_Texture : m_Dummy; }
+
+//-------------------------------------------------------------------------------------------------
+//      シェーダリソースビューを取得します.
+//-------------------------------------------------------------------------------------------------
+ID3D11ShaderResourceView* const AsyncTexture2D::GetSRV() const
+{ return GetTexture().GetSRV(); }
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルを読み込んでデコードします.
+//-------------------------------------------------------------------------------------------------
+bool AsyncTexture2D::OnDecode()
+{
+    // DDS は元々そのまま転送できる配置のため, 派生データキャッシュは使用しません.
+    auto& cache    = DerivedDataCache::GetInstance();
+    auto  ext      = GetLowerExt( GetPath() );
+    auto  useCache = cache.IsInit() && ext != "dds";
+
+    if ( m_pPack == nullptr && !useCache )
+    { return m_Resource.LoadFromFileA( GetPath().c_str() ); }
+
+    // パックファイルはマップ済みのため, ファイルを開かずにその場でデコードします.
+    AssetView view;
+    std::vector<uint8_t> buffer;
+    if ( m_pPack != nullptr )
+    {
+        auto index = m_pPack->FindIndex( GetPath().c_str() );
+        if ( index < 0 )
+        {
+            ELOGA( "Error : AssetPack::FindIndex() Failed. path = %s", GetPath().c_str() );
+            return false;
+        }
+
+        if ( m_pPack->GetSize( index ) > UINT32_MAX )
+        {
+            ELOGA( "Error : Out of Range. path = %s", GetPath().c_str() );
+            return false;
+        }
+
+        // 圧縮されている場合は一時バッファに展開します.
+        if ( !m_pPack->GetEntry( index, view ) )
+        {
+            buffer.resize( static_cast<size_t>( m_pPack->GetSize( index ) ) );
+            if ( !m_pPack->Read( index, buffer.data(), buffer.size() ) )
+            {
+                ELOGA( "Error : AssetPack::Read() Failed. path = %s", GetPath().c_str() );
+                return false;
+            }
+
+            view.pData = buffer.data();
+            view.Size  = buffer.size();
+        }
+    }
+
+    // 元データの内容と拡張子からキーを作り, 変換済みのデータがあればデコードを省略します.
+    DerivedDataKey key;
+    if ( useCache )
+    {
+        DerivedDataKeyBuilder builder( kTextureConverter, kTextureConverterVersion );
+        builder.Add( ext.c_str() );
+
+        if ( m_pPack != nullptr )
+        { builder.Add( view.pData, static_cast<size_t>( view.Size ) ); }
+        else if ( !builder.AddFile( GetPath().c_str() ) )
+        { return false; }
+
+        key = builder.GetKey();
+
+        std::vector<uint8_t> blob;
+        if ( cache.Get( key, blob ) && DecodeResTexture( blob.data(), blob.size(), m_Resource ) )
+        { return true; }
+    }
+
+    auto ret = ( m_pPack != nullptr )
+        ? m_Resource.LoadFromMemory( view.pData, static_cast<uint32_t>( view.Size ) )
+        : m_Resource.LoadFromFileA( GetPath().c_str() );
+
+    if ( ret && useCache )
+    {
+        std::vector<uint8_t> blob;
+        if ( EncodeResTexture( m_Resource, blob ) )
+        { cache.Put( key, blob.data(), blob.size() ); }
+    }
+
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      テクスチャを生成します.
+//-------------------------------------------------------------------------------------------------
+bool AsyncTexture2D::OnCreate()
+{ return m_Texture.Create( m_pDevice.GetPtr(), m_pDeviceContext.GetPtr(), m_Resource ); }
+
+//-------------------------------------------------------------------------------------------------
+//      デコード結果を破棄します.
+//-------------------------------------------------------------------------------------------------
+void AsyncTexture2D::OnDiscard()
+{
+    // Release() は SurfaceCount を残すため, 二重解放しないよう初期状態に戻します.
+    m_Resource.Release();
+    m_Resource = ResTexture();
+
+    // GPU リソースの生成が終わればデバイスへの参照は不要です.
+    m_pDevice       .Reset();
+    m_pDeviceContext.Reset();
+    m_pPack = nullptr;
+}
+
+} // namespace asdx
@@ -0,0 +1,1036 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxDerivedDataCache.cpp
+// Desc : Local Derived Data Cache.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxDerivedDataCache.h>
+#include <asdxResTexture.h>
+#include <asdxLogger.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#if defined(_WIN32)
+    #include <Windows.h>
+    #include <fcntl.h>
+    #include <io.h>
+#else
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/stat.h>
+#endif//defined(_WIN32)
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const uint32_t   kCacheMagic         = 0x43444441;       // 'ADDC'
+static const uint32_t   kCacheVersion       = 1;
+static const uint32_t   kTextureMagic       = 0x58544444;       // 'DDTX'
+static const uint32_t   kTextureVersion     = 1;
+static const uint64_t   kTextureAlignment   = 16;               // サブリソースの配置境界です.
+static const uint64_t   kKeySeed[2]         = { 0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full };
+static const int64_t    kStaleTempSeconds   = 60 * 60;          // この時間より古い一時ファイルは削除します.
+static const char*      kEntryExt           = ".ddc";
+static const char*      kTempExt            = ".tmp";
+static const uint32_t   kCommitRetryCount   = 50;               // 置き換えを再試行する最大回数です.
+static const uint32_t   kCommitRetryWait    = 2;                // 再試行までの待機時間(ミリ秒)です.
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// CacheFileHeader structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct CacheFileHeader
+{
+    uint32_t    Magic;      //!< 'ADDC' です.
+    uint32_t    Version;    //!< ファイルバージョンです.
+    uint64_t    KeyHi;      //!< キーの上位 64bit です.
+    uint64_t    KeyLo;      //!< キーの下位 64bit です.
+    uint64_t    Size;       //!< データサイズです.
+    uint32_t    Crc;        //!< データの CRC-32C です.
+    uint32_t    Reserved;   //!< 予約領域です.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TextureBlobHeader structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct TextureBlobHeader
+{
+    uint32_t    Magic;              //!< 'DDTX' です.
+    uint32_t    Version;            //!< バージョンです.
+    uint32_t    Width;              //!< 横幅です.
+    uint32_t    Height;             //!< 縦幅です.
+    uint32_t    Depth;              //!< 奥行です.
+    uint32_t    Format;             //!< DXGI_FORMAT です.
+    uint32_t    MipMapCount;        //!< ミップマップ数です.
+    uint32_t    SurfaceCount;       //!< サーフェイス数です.
+    uint32_t    Option;             //!< オプションフラグです.
+    uint32_t    ResourceCount;      //!< サブリソース数です.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TextureBlobResource structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct TextureBlobResource
+{
+    uint32_t    Width;          //!< 横幅です.
+    uint32_t    Height;         //!< 縦幅です.
+    uint32_t    Pitch;          //!< 1行当たりのバイト数です.
+    uint32_t    SlicePitch;     //!< テクセルデータのバイト数です.
+    uint64_t    Offset;         //!< バイナリ先頭からのテクセルデータの位置です.
+};
+
+static_assert( sizeof(CacheFileHeader)     == 40, "CacheFileHeader size mismatch." );
+static_assert( sizeof(TextureBlobHeader)   == 40, "TextureBlobHeader size mismatch." );
+static_assert( sizeof(TextureBlobResource) == 24, "TextureBlobResource size mismatch." );
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FileInfo structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct FileInfo
+{
+    std::string     Name;       //!< ファイル名です.
+    uint64_t        Size;       //!< ファイルサイズです.
+    int64_t         Time;       //!< 更新日時 (UNIX 時間) です.
+};
+
+//-------------------------------------------------------------------------------------------------
+//      アライメントを揃えます.
+//-------------------------------------------------------------------------------------------------
+inline uint64_t AlignUp( uint64_t value, uint64_t alignment )
+{ return ( value + alignment - 1 ) & ~( alignment - 1 ); }
+
+//-------------------------------------------------------------------------------------------------
+//      文字列の末尾が一致するかどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+inline bool EndsWith( const std::string& value, const char* suffix )
+{
+    auto length = strlen( suffix );
+    return value.size() >= length && value.compare( value.size() - length, length, suffix ) == 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ディレクトリを作成します. 途中のディレクトリも作成します.
+//-------------------------------------------------------------------------------------------------
+bool CreateDirectories( const std::string& path )
+{
+    for ( size_t i = 1; i <= path.size(); ++i )
+    {
+        if ( i != path.size() && path[i] != '/' && path[i] != '\\' )
+        { continue; }
+
+        // ドライブ名の直後は作成しません.
+        if ( path[i - 1] == ':' )
+        { continue; }
+
+        auto dir = path.substr( 0, i );
+    #if defined(_WIN32)
+        if ( !CreateDirectoryA( dir.c_str(), nullptr ) && GetLastError() != ERROR_ALREADY_EXISTS )
+        { return false; }
+    #else
+        if ( mkdir( dir.c_str(), 0755 ) != 0 && errno != EEXIST )
+        { return false; }
+    #endif
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ディレクトリ直下のファイルを列挙します.
+//-------------------------------------------------------------------------------------------------
+bool EnumerateFiles( const std::string& dir, std::vector<FileInfo>& result )
+{
+#if defined(_WIN32)
+    WIN32_FIND_DATAA data;
+    auto hFind = FindFirstFileA( ( dir + "\\*" ).c_str(), &data );
+    if ( hFind == INVALID_HANDLE_VALUE )
+    { return false; }
+
+    do
+    {
+        if ( data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY )
+        { continue; }
+
+        // FILETIME は 1601/01/01 からの 100 ナノ秒単位です.
+        auto time = ( uint64_t( data.ftLastWriteTime.dwHighDateTime ) << 32 ) | data.ftLastWriteTime.dwLowDateTime;
+
+        FileInfo info;
+        info.Name = data.cFileName;
+        info.Size = ( uint64_t( data.nFileSizeHigh ) << 32 ) | data.nFileSizeLow;
+        info.Time = int64_t( time / 10000000ull ) - 11644473600ll;
+        result.push_back( info );
+    }
+    while ( FindNextFileA( hFind, &data ) );
+
+    FindClose( hFind );
+    return true;
+#else
+    auto pDir = opendir( dir.c_str() );
+    if ( pDir == nullptr )
+    { return false; }
+
+    for ( auto pEntry = readdir( pDir ); pEntry != nullptr; pEntry = readdir( pDir ) )
+    {
+        auto path = dir + "/" + pEntry->d_name;
+
+        struct stat st;
+        if ( stat( path.c_str(), &st ) != 0 || !S_ISREG( st.st_mode ) )
+        { continue; }
+
+        FileInfo info;
+        info.Name = pEntry->d_name;
+        info.Size = uint64_t( st.st_size );
+        info.Time = int64_t( st.st_mtime );
+        result.push_back( info );
+    }
+
+    closedir( pDir );
+    return true;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルの更新日時を現在時刻にします.
+//-------------------------------------------------------------------------------------------------
+void TouchFile( const std::string& path )
+{
+#if defined(_WIN32)
+    auto hFile = CreateFileA(
+        path.c_str(),
+        FILE_WRITE_ATTRIBUTES,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr );
+    if ( hFile == INVALID_HANDLE_VALUE )
+    { return; }
+
+    FILETIME now;
+    GetSystemTimeAsFileTime( &now );
+    SetFileTime( hFile, nullptr, nullptr, &now );
+    CloseHandle( hFile );
+#else
+    utimensat( AT_FDCWD, path.c_str(), nullptr, 0 );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルを置き換えます.
+//-------------------------------------------------------------------------------------------------
+bool CommitFile( const std::string& src, const std::string& dst )
+{
+#if defined(_WIN32)
+    // 他のスレッドやプロセスが削除共有無しで置き換え先を開いている間は失敗するため,
+    // 閉じられるのを待って一定回数まで再試行します.
+    for ( uint32_t i = 0; ; ++i )
+    {
+        if ( MoveFileExA( src.c_str(), dst.c_str(), MOVEFILE_REPLACE_EXISTING ) != FALSE )
+        { return true; }
+
+        auto err = GetLastError();
+        if ( ( err != ERROR_ACCESS_DENIED && err != ERROR_SHARING_VIOLATION ) || i + 1 >= kCommitRetryCount )
+        {
+            ELOGA( "Error : MoveFileExA() Failed. dst = %s, error = %lu", dst.c_str(), err );
+            return false;
+        }
+
+        Sleep( kCommitRetryWait );
+    }
+#else
+    return rename( src.c_str(), dst.c_str() ) == 0;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      キャッシュファイルを読み込み用に開きます.
+//-------------------------------------------------------------------------------------------------
+FILE* OpenCacheFile( const std::string& path )
+{
+#if defined(_WIN32)
+    // 読み込み中でも CommitFile() で置き換えられるよう, 削除共有を許可して開きます.
+    auto hFile = CreateFileA(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr );
+    if ( hFile == INVALID_HANDLE_VALUE )
+    { return nullptr; }
+
+    auto fd = _open_osfhandle( reinterpret_cast<intptr_t>( hFile ), _O_RDONLY | _O_BINARY );
+    if ( fd == -1 )
+    {
+        CloseHandle( hFile );
+        return nullptr;
+    }
+
+    // 以降は fd と FILE がハンドルを所有します.
+    auto pFile = _fdopen( fd, "rb" );
+    if ( pFile == nullptr )
+    { _close( fd ); }
+
+    return pFile;
+#else
+    FILE* pFile = nullptr;
+    auto err = fopen_s( &pFile, path.c_str(), "rb" );
+    if ( err != 0 )
+    { return nullptr; }
+
+    return pFile;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      開いているファイルのサイズを取得します.
+//-------------------------------------------------------------------------------------------------
+bool GetOpenFileSize( FILE* pFile, uint64_t& size )
+{
+#if defined(_WIN32)
+    LARGE_INTEGER value;
+    auto hFile = reinterpret_cast<HANDLE>( _get_osfhandle( _fileno( pFile ) ) );
+    if ( hFile == INVALID_HANDLE_VALUE || !GetFileSizeEx( hFile, &value ) )
+    { return false; }
+
+    size = uint64_t( value.QuadPart );
+    return true;
+#else
+    struct stat st;
+    if ( fstat( fileno( pFile ), &st ) != 0 )
+    { return false; }
+
+    size = uint64_t( st.st_size );
+    return true;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      プロセス ID を取得します.
+//-------------------------------------------------------------------------------------------------
+inline uint32_t GetProcessIdentifier()
+{
+#if defined(_WIN32)
+    return uint32_t( GetCurrentProcessId() );
+#else
+    return uint32_t( getpid() );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      16進数の1文字を数値に変換します.
+//-------------------------------------------------------------------------------------------------
+inline int HexToInt( char c )
+{
+    if ( '0' <= c && c <= '9' ) { return c - '0'; }
+    if ( 'a' <= c && c <= 'f' ) { return c - 'a' + 10; }
+    if ( 'A' <= c && c <= 'F' ) { return c - 'A' + 10; }
+    return -1;
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DerivedDataKey structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      16進数文字列に変換します.
+//-------------------------------------------------------------------------------------------------
+std::string DerivedDataKey::ToString() const
+{
+    char text[33];
+    snprintf( text, sizeof(text), "%016llx%016llx",
+        static_cast<unsigned long long>( Hi ),
+        static_cast<unsigned long long>( Lo ) );
+    return std::string( text );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      16進数文字列から変換します.
+//-------------------------------------------------------------------------------------------------
+bool DerivedDataKey::FromString( const char* text, DerivedDataKey& result )
+{
+    if ( text == nullptr )
+    { return false; }
+
+    uint64_t value[2] = {};
+    for ( auto i = 0; i < 32; ++i )
+    {
+        auto digit = HexToInt( text[i] );
+        if ( digit < 0 )
+        { return false; }
+
+        value[i / 16] = ( value[i / 16] << 4 ) | uint64_t( digit );
+    }
+
+    if ( text[32] != '\0' )
+    { return false; }
+
+    result.Hi = value[0];
+    result.Lo = value[1];
+    return true;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DerivedDataKeyBuilder class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+DerivedDataKeyBuilder::DerivedDataKeyBuilder( const char* converter, uint32_t version )
+{
+    m_Hash[0].Reset( kKeySeed[0] );
+    m_Hash[1].Reset( kKeySeed[1] );
+
+    Add( converter );
+    AddValue( version );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      データを追加します.
+//-------------------------------------------------------------------------------------------------
+DerivedDataKeyBuilder& DerivedDataKeyBuilder::Add( const void* pData, size_t size )
+{
+    // 長さを先に入れて, 連結位置の違う入力を区別します.
+    auto length = uint64_t( size );
+    Update( &length, sizeof(length) );
+    Update( pData, size );
+    return *this;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      文字列を追加します.
+//-------------------------------------------------------------------------------------------------
+DerivedDataKeyBuilder& DerivedDataKeyBuilder::Add( const char* text )
+{
+    if ( text == nullptr )
+    { text = ""; }
+
+    return Add( text, strlen( text ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルの内容を追加します.
+//-------------------------------------------------------------------------------------------------
+bool DerivedDataKeyBuilder::AddFile( const char* path )
+{
+    FILE* pFile = nullptr;
+    auto err = fopen_s( &pFile, path, "rb" );
+    if ( err != 0 || pFile == nullptr )
+    {
+        ELOGA( "Error : File Open Failed. path = %s", path );
+        return false;
+    }
+
+    std::vector<uint8_t> data;
+    uint8_t chunk[64 * 1024];
+    for ( ;; )
+    {
+        auto count = fread( chunk, 1, sizeof(chunk), pFile );
+        if ( count == 0 )
+        { break; }
+
+        data.insert( data.end(), chunk, chunk + count );
+    }
+
+    auto ret = ( ferror( pFile ) == 0 );
+    fclose( pFile );
+
+    if ( !ret )
+    {
+        ELOGA( "Error : File Read Failed. path = %s", path );
+        return false;
+    }
+
+    Add( data.data(), data.size() );
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      キーを取得します.
+//-------------------------------------------------------------------------------------------------
+DerivedDataKey DerivedDataKeyBuilder::GetKey() const
+{
+    DerivedDataKey result;
+    result.Hi = m_Hash[0].GetHash();
+    result.Lo = m_Hash[1].GetHash();
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ハッシュを更新します.
+//-------------------------------------------------------------------------------------------------
+void DerivedDataKeyBuilder::Update( const void* pData, size_t size )
+{
+    if ( pData == nullptr || size == 0 )
+    { return; }
+
+    auto pBytes = static_cast<const uint8_t*>( pData );
+    m_Hash[0].Update( size, pBytes );
+    m_Hash[1].Update( size, pBytes );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DerivedDataCache class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      シングルトンインスタンスを取得します.
+//-------------------------------------------------------------------------------------------------
+DerivedDataCache& DerivedDataCache::GetInstance()
+{
+    static DerivedDataCache s_Instance;
+    return s_Instance;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+DerivedDataCache::DerivedDataCache()
+: m_Init        ( false )
+, m_TempCounter ( 0 )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+DerivedDataCache::~DerivedDataCache()
+{ Term(); }
+
+//-------------------------------------------------------------------------------------------------
+//      初期化処理を行います.
+//-------------------------------------------------------------------------------------------------
+bool DerivedDataCache::Init( const DerivedDataCacheDesc& desc )
+{
+    std::lock_guard<std::mutex> locker( m_Mutex );
+
+    if ( m_Init )
+    {
+        ELOGA( "Error : DerivedDataCache is already initialized." );
+        return false;
+    }
+
+    if ( desc.Dir.empty() || desc.MaxSize == 0 || desc.TrimPercent == 0 || desc.TrimPercent > 100 )
+    {
+        ELOGA( "Error : Invalid Argument." );
+        return false;
+    }
+
+    m_Desc = desc;
+    while ( m_Desc.Dir.size() > 1 && ( m_Desc.Dir.back() == '/' || m_Desc.Dir.back() == '\\' ) )
+    { m_Desc.Dir.pop_back(); }
+
+    if ( !CreateDirectories( m_Desc.Dir ) )
+    {
+        ELOGA( "Error : Create Directory Failed. path = %s", m_Desc.Dir.c_str() );
+        return false;
+    }
+
+    m_List.clear();
+    m_Map .clear();
+    m_Stats = DerivedDataCacheStats();
+
+    if ( !Scan() )
+    {
+        ELOGA( "Error : Scan Directory Failed. path = %s", m_Desc.Dir.c_str() );
+        m_List.clear();
+        m_Map .clear();
+        return false;
+    }
+
+    // 前回より上限を小さくした場合に備えて, ここでも削除します.
+    Trim();
+
+    m_Init = true;
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      終了処理を行います.
+//-------------------------------------------------------------------------------------------------
+void DerivedDataCache::Term()
+{
+    std::lock_guard<std::mutex> locker( m_Mutex );
+
+    m_List.clear();
+    m_Map .clear();
+    m_Stats = DerivedDataCacheStats();
+    m_Init  = false;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      初期化済みかどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool DerivedDataCache::IsInit() const
+{
+    std::lock_guard<std::mutex> locker( m_Mutex );
+    return m_Init;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      データを取得します.
+//-------------------------------------------------------------------------------------------------
+bool DerivedDataCache::Get( const DerivedDataKey& key, std::vector<uint8_t>& result )
+{
+    std::string path;
+    {
+        std::lock_guard<std::mutex> locker( m_Mutex );
+        if ( !m_Init )
+        { return false; }
+
+        path = GetFilePath( key );
+    }
+
+    // 他のプロセスが書き込んだエントリも参照できるよう, 索引に無くてもファイルを開いてみます.
+    auto pFile = OpenCacheFile( path );
+    if ( pFile == nullptr )
+    {
+        std::lock_guard<std::mutex> locker( m_Mutex );
+        m_Stats.MissCount++;
+        Erase( key, false );
+        return false;
+    }
+
+    // サイズはファイルの値なので, 確保する前に実際のファイルサイズと照合します.
+    CacheFileHeader header;
+    uint64_t        fileSize = 0;
+    auto valid = GetOpenFileSize( pFile, fileSize )
+              && fileSize >= sizeof(header)
+              && ( fread( &header, sizeof(header), 1, pFile ) == 1 )
+              && header.Magic   == kCacheMagic
+              && header.Version == kCacheVersion
+              && header.KeyHi   == key.Hi
+              && header.KeyLo   == key.Lo
+              && header.Size    == fileSize - sizeof(header)
+              && header.Size    <= SIZE_MAX;
+
+    if ( valid )
+    {
+        result.resize( static_cast<size_t>( header.Size ) );
+        valid = ( result.empty() || fread( result.data(), 1, result.size(), pFile ) == result.size() )
+             && ( fgetc( pFile ) == EOF )
+             && ( Crc32C( result.size(), result.data() ).GetHash() == header.Crc );
+    }
+
+    fclose( pFile );
+
+    if ( !valid )
+    {
+        WLOGA( "Warning : Corrupted Derived Data. path = %s", path.c_str() );
+        result.clear();
+
+        std::lock_guard<std::mutex> locker( m_Mutex );
+        m_Stats.MissCount++;
+        m_Stats.CorruptCount++;
+        Erase( key, true );
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> locker( m_Mutex );
+        m_Stats.HitCount++;
+        m_Stats.ReadBytes += result.size();
+        Touch( key, sizeof(header) + result.size() );
+    }
+
+    // 次回の Init() でも参照順を復元できるよう, 更新日時に記録します.
+    TouchFile( path );
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      データを格納します.
+//-------------------------------------------------------------------------------------------------
+bool DerivedDataCache::Put( const DerivedDataKey& key, const void* pData, size_t size )
+{
+    if ( pData == nullptr && size > 0 )
+    {
+        ELOGA( "Error : Invalid Argument." );
+        return false;
+    }
+
+    std::string path;
+    {
+        std::lock_guard<std::mutex> locker( m_Mutex );
+        if ( !m_Init )
+        { return false; }
+
+        // 単体で上限を超えるデータは格納しません.
+        if ( sizeof(CacheFileHeader) + size > m_Desc.MaxSize )
+        {
+            WLOGA( "Warning : Derived Data Too Large. size = %zu", size );
+            return false;
+        }
+
+        path = GetFilePath( key );
+    }
+
+    CacheFileHeader header = {};
+    header.Magic    = kCacheMagic;
+    header.Version  = kCacheVersion;
+    header.KeyHi    = key.Hi;
+    header.KeyLo    = key.Lo;
+    header.Size     = size;
+    header.Crc      = Crc32C( size, static_cast<const uint8_t*>( pData ) ).GetHash();
+
+    // 一時ファイルに書き出してから置き換え, 書き込み途中のファイルが読まれないようにします.
+    char suffix[64];
+    snprintf( suffix, sizeof(suffix), ".%u-%u%s",
+        GetProcessIdentifier(),
+        m_TempCounter.fetch_add( 1, std::memory_order_relaxed ),
+        kTempExt );
+    auto temp = path + suffix;
+
+    FILE* pFile = nullptr;
+    auto err = fopen_s( &pFile, temp.c_str(), "wb" );
+    if ( err != 0 || pFile == nullptr )
+    {
+        ELOGA( "Error : File Open Failed. path = %s", temp.c_str() );
+        return false;
+    }
+
+    auto ret = ( fwrite( &header, sizeof(header), 1, pFile ) == 1 )
+            && ( size == 0 || fwrite( pData, 1, size, pFile ) == size );
+    ret = ( fclose( pFile ) == 0 ) && ret;
+
+    if ( !ret || !CommitFile( temp, path ) )
+    {
+        ELOGA( "Error : File Write Failed. path = %s", path.c_str() );
+        remove( temp.c_str() );
+        return false;
+    }
+
+    std::lock_guard<std::mutex> locker( m_Mutex );
+    if ( !m_Init )
+    { return true; }
+
+    m_Stats.WriteCount++;
+    m_Stats.WriteBytes += size;
+    Touch( key, sizeof(header) + size );
+    Trim();
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      データを削除します.
+//-------------------------------------------------------------------------------------------------
+void DerivedDataCache::Remove( const DerivedDataKey& key )
+{
+    std::lock_guard<std::mutex> locker( m_Mutex );
+    if ( !m_Init )
+    { return; }
+
+    Erase( key, true );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      全てのデータを削除します.
+//-------------------------------------------------------------------------------------------------
+void DerivedDataCache::Clear()
+{
+    std::lock_guard<std::mutex> locker( m_Mutex );
+    if ( !m_Init )
+    { return; }
+
+    for ( auto& entry : m_List )
+    { remove( GetFilePath( entry.Key ).c_str() ); }
+
+    m_List.clear();
+    m_Map .clear();
+    m_Stats.EntryCount = 0;
+    m_Stats.TotalSize  = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      統計情報を取得します.
+//-------------------------------------------------------------------------------------------------
+DerivedDataCacheStats DerivedDataCache::GetStats() const
+{
+    std::lock_guard<std::mutex> locker( m_Mutex );
+    return m_Stats;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      統計情報のカウンタをリセットします.
+//-------------------------------------------------------------------------------------------------
+void DerivedDataCache::ResetStats()
+{
+    std::lock_guard<std::mutex> locker( m_Mutex );
+
+    DerivedDataCacheStats stats;
+    stats.EntryCount = m_Stats.EntryCount;
+    stats.TotalSize  = m_Stats.TotalSize;
+    m_Stats = stats;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      キャッシュファイルのパスを取得します.
+//-------------------------------------------------------------------------------------------------
+std::string DerivedDataCache::GetFilePath( const DerivedDataKey& key ) const
+{ return m_Desc.Dir + "/" + key.ToString() + kEntryExt; }
+
+//-------------------------------------------------------------------------------------------------
+//      ディレクトリを走査して索引を作成します.
+//-------------------------------------------------------------------------------------------------
+bool DerivedDataCache::Scan()
+{
+    std::vector<FileInfo> files;
+    if ( !EnumerateFiles( m_Desc.Dir, files ) )
+    { return false; }
+
+    auto now = int64_t( time( nullptr ) );
+
+    // 更新日時の古い順に並べ, 先頭に積んでいくことで最後に参照したものが先頭になるようにします.
+    std::sort( files.begin(), files.end(), []( const FileInfo& lhs, const FileInfo& rhs )
+    { return lhs.Time < rhs.Time; });
+
+    for ( auto& file : files )
+    {
+        auto path = m_Desc.Dir + "/" + file.Name;
+
+        // 書き込み中に終了したプロセスの一時ファイルを削除します.
+        if ( EndsWith( file.Name, kTempExt ) )
+        {
+            if ( now - file.Time > kStaleTempSeconds )
+            { remove( path.c_str() ); }
+            continue;
+        }
+
+        if ( !EndsWith( file.Name, kEntryExt ) )
+        { continue; }
+
+        DerivedDataKey key;
+        auto name = file.Name.substr( 0, file.Name.size() - strlen( kEntryExt ) );
+        if ( !DerivedDataKey::FromString( name.c_str(), key ) )
+        { continue; }
+
+        Touch( key, file.Size );
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      エントリを最後に参照したものとして登録します.
+//-------------------------------------------------------------------------------------------------
+void DerivedDataCache::Touch( const DerivedDataKey& key, uint64_t size )
+{
+    auto itr = m_Map.find( key );
+    if ( itr != m_Map.end() )
+    {
+        m_Stats.TotalSize -= itr->second->Size;
+        itr->second->Size  = size;
+        m_List.splice( m_List.begin(), m_List, itr->second );
+    }
+    else
+    {
+        Entry entry;
+        entry.Key  = key;
+        entry.Size = size;
+        m_List.push_front( entry );
+        m_Map[key] = m_List.begin();
+        m_Stats.EntryCount++;
+    }
+
+    m_Stats.TotalSize += size;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      エントリを索引から削除します.
+//-------------------------------------------------------------------------------------------------
+void DerivedDataCache::Erase( const DerivedDataKey& key, bool deleteFile )
+{
+    auto itr = m_Map.find( key );
+    if ( itr != m_Map.end() )
+    {
+        m_Stats.TotalSize -= itr->second->Size;
+        m_Stats.EntryCount--;
+        m_List.erase( itr->second );
+        m_Map .erase( itr );
+    }
+
+    if ( deleteFile )
+    { remove( GetFilePath( key ).c_str() ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      合計サイズが上限を超えている場合に, 参照の古いエントリから削除します.
+//-------------------------------------------------------------------------------------------------
+void DerivedDataCache::Trim()
+{
+    if ( m_Stats.TotalSize <= m_Desc.MaxSize )
+    { return; }
+
+    // 毎回の書き込みで削除が走らないよう, 上限より少し下まで減らします.
+    auto target = m_Desc.MaxSize / 100 * m_Desc.TrimPercent;
+    while ( !m_List.empty() && m_Stats.TotalSize > target )
+    {
+        auto key = m_List.back().Key;
+        Erase( key, true );
+        m_Stats.EvictCount++;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+//      テクスチャリソースをバイナリに変換します.
+//-------------------------------------------------------------------------------------------------
+bool EncodeResTexture( const ResTexture& texture, std::vector<uint8_t>& result )
+{
+    auto mipCount      = ( texture.MipMapCount > 0 ) ? texture.MipMapCount : 1;
+    auto resourceCount = uint64_t( texture.SurfaceCount ) * mipCount;
+
+    if ( texture.pResources == nullptr || resourceCount == 0 || resourceCount > UINT32_MAX )
+    {
+        ELOGA( "Error : Invalid Argument." );
+        return false;
+    }
+
+    TextureBlobHeader header = {};
+    header.Magic          = kTextureMagic;
+    header.Version        = kTextureVersion;
+    header.Width          = texture.Width;
+    header.Height         = texture.Height;
+    header.Depth          = texture.Depth;
+    header.Format         = texture.Format;
+    header.MipMapCount    = texture.MipMapCount;
+    header.SurfaceCount   = texture.SurfaceCount;
+    header.Option         = texture.Option;
+    header.ResourceCount  = uint32_t( resourceCount );
+
+    std::vector<TextureBlobResource> resources( static_cast<size_t>( resourceCount ) );
+
+    auto offset = AlignUp( sizeof(header) + sizeof(TextureBlobResource) * resourceCount, kTextureAlignment );
+    for ( size_t i = 0; i < resources.size(); ++i )
+    {
+        auto& src = texture.pResources[i];
+        if ( src.pPixels == nullptr && src.SlicePitch > 0 )
+        {
+            ELOGA( "Error : Invalid Argument." );
+            return false;
+        }
+
+        resources[i].Width      = src.Width;
+        resources[i].Height     = src.Height;
+        resources[i].Pitch      = src.Pitch;
+        resources[i].SlicePitch = src.SlicePitch;
+        resources[i].Offset     = offset;
+
+        offset = AlignUp( offset + src.SlicePitch, kTextureAlignment );
+    }
+
+    result.assign( static_cast<size_t>( offset ), 0 );
+    memcpy( result.data(), &header, sizeof(header) );
+    memcpy( result.data() + sizeof(header), resources.data(), sizeof(TextureBlobResource) * resources.size() );
+
+    for ( size_t i = 0; i < resources.size(); ++i )
+    {
+        if ( resources[i].SlicePitch > 0 )
+        {
+            memcpy(
+                result.data() + resources[i].Offset,
+                texture.pResources[i].pPixels,
+                resources[i].SlicePitch );
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      バイナリからテクスチャリソースを生成します.
+//-------------------------------------------------------------------------------------------------
+bool DecodeResTexture( const uint8_t* pData, size_t size, ResTexture& result )
+{
+    if ( pData == nullptr || size < sizeof(TextureBlobHeader) )
+    {
+        ELOGA( "Error : Invalid Argument." );
+        return false;
+    }
+
+    TextureBlobHeader header;
+    memcpy( &header, pData, sizeof(header) );
+
+    auto mipCount = ( header.MipMapCount > 0 ) ? header.MipMapCount : 1;
+    if ( header.Magic   != kTextureMagic
+      || header.Version != kTextureVersion
+      || header.ResourceCount == 0
+      || uint64_t( header.SurfaceCount ) * mipCount != header.ResourceCount
+      || sizeof(header) + sizeof(TextureBlobResource) * uint64_t( header.ResourceCount ) > size )
+    {
+        ELOGA( "Error : Invalid Texture Blob." );
+        return false;
+    }
+
+    std::vector<TextureBlobResource> resources( header.ResourceCount );
+    memcpy( resources.data(), pData + sizeof(header), sizeof(TextureBlobResource) * resources.size() );
+
+    for ( auto& resource : resources )
+    {
+        if ( resource.Offset > size || resource.SlicePitch > size - resource.Offset )
+        {
+            ELOGA( "Error : Invalid Texture Blob." );
+            return false;
+        }
+    }
+
+    ResTexture texture;
+    texture.Width        = header.Width;
+    texture.Height       = header.Height;
+    texture.Depth        = header.Depth;
+    texture.Format       = header.Format;
+    texture.MipMapCount  = header.MipMapCount;
+    texture.SurfaceCount = header.SurfaceCount;
+    texture.Option       = header.Option;
+    texture.pResources   = new (std::nothrow) SubResource[ header.ResourceCount ];
+    if ( texture.pResources == nullptr )
+    {
+        ELOGA( "Error : Out of Memory." );
+        return false;
+    }
+
+    for ( size_t i = 0; i < resources.size(); ++i )
+    {
+        auto& dst = texture.pResources[i];
+        dst.Width       = resources[i].Width;
+        dst.Height      = resources[i].Height;
+        dst.Pitch       = resources[i].Pitch;
+        dst.SlicePitch  = resources[i].SlicePitch;
+
+        if ( dst.SlicePitch == 0 )
+        { continue; }
+
+        dst.pPixels = ASDX_ALLOC_ASSET( dst.SlicePitch, HEAP_TAG_TEXTURE );
+        if ( dst.pPixels == nullptr )
+        {
+            ELOGA( "Error : Out of Memory." );
+            texture.Release();
+            return false;
+        }
+
+        memcpy( dst.pPixels, pData + resources[i].Offset, dst.SlicePitch );
+    }
+
+    result = texture;
+    return true;
+}
+
+} // namespace asdx
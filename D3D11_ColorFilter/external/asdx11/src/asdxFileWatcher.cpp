@@ -7,15 +7,174 @@
 //-----------------------------------------------------------------------------
 // Includes
 //-----------------------------------------------------------------------------
+#include <algorithm>
+#include <chrono>
+#include <mutex>
 #include <vector>
 #include <string>
-#include <Windows.h>
+#include <unordered_map>
 #include <asdxFileWatcher.h>
 #include <asdxLogger.h>
 
+#if defined(_WIN32)
+    #include <Windows.h>
+#else
+    #include <cerrno>
+    #include <climits>
+    #include <cstring>
+    #include <dirent.h>
+    #include <poll.h>
+    #include <unistd.h>
+    #include <sys/inotify.h>
+    #include <sys/stat.h>
+#endif//defined(_WIN32)
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////
+// FileUpdateQueue class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief  監視スレッドから受け取った通知をパスごとにまとめ, 一定時間経過したものをまとめて通知します.
+class FileUpdateQueue
+{
+public:
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    FileUpdateQueue(const char* directoryPath, IFileUpdateListener* pListener, uint32_t debounceMsec)
+    : m_DirectoryPath   (directoryPath)
+    , m_pListener       (pListener)
+    , m_Debounce        (debounceMsec)
+    , m_Order           (0)
+    { /* DO_NOTHING */ }
+
+    //-------------------------------------------------------------------------
+    //! @brief      通知を追加します.
+    //-------------------------------------------------------------------------
+    void Push(uint32_t actionType, const std::string& path)
+    {
+        // 名前変更は, 変更前のパスの削除と変更後のパスの追加として扱います.
+        if (actionType == FILE_UPDATE_RENAMED_OLD_NAME)
+        { actionType = FILE_UPDATE_REMOVED; }
+        else if (actionType == FILE_UPDATE_RENAMED_NEW_NAME)
+        { actionType = FILE_UPDATE_ADDED; }
+
+        std::lock_guard<std::mutex> locker(m_Mutex);
+
+        auto now = Clock::now();
+        auto itr = m_Pending.find(path);
+        if (itr == m_Pending.end())
+        {
+            Pending pending;
+            pending.ActionType  = actionType;
+            pending.Order       = m_Order++;
+            pending.Time        = now;
+            m_Pending[path] = pending;
+            return;
+        }
+
+        auto& pending = itr->second;
+        auto  prev    = pending.ActionType;
+
+        if (prev == FILE_UPDATE_ADDED && actionType == FILE_UPDATE_REMOVED)
+        {
+            // 監視中に作成されて削除されたものは通知しません.
+            m_Pending.erase(itr);
+            return;
+        }
+
+        if (prev == FILE_UPDATE_ADDED)
+        { actionType = FILE_UPDATE_ADDED; }
+        else if (actionType == FILE_UPDATE_ADDED)
+        { actionType = FILE_UPDATE_MODIFIED; }
+
+        pending.ActionType  = actionType;
+        pending.Time        = now;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      最後の通知から一定時間経過したものをまとめて通知します.
+    //-------------------------------------------------------------------------
+    void Flush()
+    {
+        // リスナーを同時に呼び出さないよう, 通知全体をロックします.
+        std::lock_guard<std::mutex> dispatchLocker(m_DispatchMutex);
+
+        std::vector<Ready> ready;
+        {
+            std::lock_guard<std::mutex> locker(m_Mutex);
+            if (m_Pending.empty())
+            { return; }
+
+            auto now = Clock::now();
+            for(auto itr = m_Pending.begin(); itr != m_Pending.end(); )
+            {
+                if (now - itr->second.Time < m_Debounce)
+                {
+                    ++itr;
+                    continue;
+                }
+
+                Ready item;
+                item.ActionType = itr->second.ActionType;
+                item.Order      = itr->second.Order;
+                item.Path       = itr->first;
+                ready.push_back(item);
+
+                itr = m_Pending.erase(itr);
+            }
+        }
+
+        if (ready.empty())
+        { return; }
+
+        // 最初に通知を受け取った順に並べます.
+        std::sort(ready.begin(), ready.end(), [](const Ready& lhs, const Ready& rhs)
+        { return lhs.Order < rhs.Order; });
+
+        std::vector<FileUpdateEvent> events(ready.size());
+        for(size_t i=0; i<ready.size(); ++i)
+        {
+            events[i].ActionType   = ready[i].ActionType;
+            events[i].RelativePath = ready[i].Path.c_str();
+        }
+
+        m_pListener->OnUpdateBatch(m_DirectoryPath.c_str(), events.data(), uint32_t(events.size()));
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Pending
+    {
+        uint32_t            ActionType;     //!< 集約した更新の種類です.
+        uint64_t            Order;          //!< 最初に通知を受け取った順番です.
+        Clock::time_point   Time;           //!< 最後に通知を受け取った時刻です.
+    };
+
+    struct Ready
+    {
+        uint32_t            ActionType;     //!< 更新の種類です.
+        uint64_t            Order;          //!< 最初に通知を受け取った順番です.
+        std::string         Path;           //!< 相対パスです.
+    };
+
+    std::string                                 m_DirectoryPath;    //!< 監視対象ディレクトリです.
+    IFileUpdateListener*                        m_pListener;        //!< 変更通知先です.
+    std::chrono::milliseconds                   m_Debounce;         //!< 通知をまとめる時間です.
+    uint64_t                                    m_Order;            //!< 次に割り当てる順番です.
+    std::mutex                                  m_Mutex;            //!< m_Pending を保護するミューテックスです.
+    std::mutex                                  m_DispatchMutex;    //!< 通知を直列化するミューテックスです.
+    std::unordered_map<std::string, Pending>    m_Pending;          //!< 通知待ちのパスです.
+};
+
+} // namespace asdx
+
 
 namespace {
 
+#if defined(_WIN32)
 //-----------------------------------------------------------------------------
 //      マルチバイト文字列に変換します.
 //-----------------------------------------------------------------------------
@@ -40,9 +199,10 @@ struct Worker
     HANDLE                      hEvent          = nullptr;
     HANDLE                      hDir            = nullptr;
     uint32_t                    WaitTimeMsec    = 0;
+    bool                        Manual          = false;
     std::vector<uint8_t>        Buffer          = {};
     std::string                 DirectoryPath   = {};
-    asdx::IFileUpdateListener*  pListener       = nullptr;
+    asdx::FileUpdateQueue*      pQueue          = nullptr;
     std::atomic<bool>*          pFinish         = nullptr;
 
     Worker()
@@ -51,7 +211,7 @@ struct Worker
     ~Worker()
     { /* DO_NOTHING */ }
 
-    bool Prepare(const asdx::FileWatcher::Desc& desc, std::atomic<bool>* pFlags)
+    bool Prepare(const asdx::FileWatcher::Desc& desc, std::atomic<bool>* pFlags, asdx::FileUpdateQueue* pUpdateQueue)
     {
         hDir = CreateFileA(
             desc.DirectoryPath,
@@ -79,9 +239,10 @@ struct Worker
         }
 
         pFinish         = pFlags;
+        pQueue          = pUpdateQueue;
         DirectoryPath   = desc.DirectoryPath;
-        pListener       = desc.pListener;
         WaitTimeMsec    = desc.WaitTimeMsec;
+        Manual          = desc.ManualDispatch;
         Buffer.resize(desc.BufferSize);
 
         return true;
@@ -130,6 +291,10 @@ struct Worker
                 {
                     break;
                 }
+
+                // まとめる時間が経過したものを通知.
+                if (!Manual)
+                { pQueue->Flush(); }
             }
 
             // 終了フラグが立っていたら終了.
@@ -157,28 +322,23 @@ struct Worker
             if (retSize != 0)
             {
                 auto pInfos = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(pBuf);
-                size_t offset = 0;
 
                 for (;;)
                 {
-                    // ファイル名取得.
-                    auto path = ToStringA(pInfos->FileName);
-
-                    // 末尾にカンマが来ることがあるので，それを取り除く.
-                    auto pos = path.find_last_of(',');
-                    if (pos != std::string::npos && pos == path.size() - 1)
-                    { path = path.substr(0, pos); }
+                    // ファイル名取得. FileName は null 終端されていないため, 長さを指定して変換する.
+                    auto path = ToStringA(std::wstring(pInfos->FileName, pInfos->FileNameLength / sizeof(WCHAR)));
 
                     // 強制的に開いて閉じる.
                     // これでたま～にファイルがオープンできない問題を解決できる.
                     {
-                        auto handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+                        auto fullPath = DirectoryPath + "\\" + path;
+                        auto handle = CreateFileA(fullPath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
                         if (handle != INVALID_HANDLE_VALUE)
                         { CloseHandle(handle); }
                     }
 
-                    // 通知.
-                    pListener->OnUpdate(pInfos->Action, DirectoryPath.c_str(), path.c_str());
+                    // キューに追加.
+                    pQueue->Push(pInfos->Action, path);
 
                     // 次のエントリがなければ終了.
                     if (pInfos->NextEntryOffset == 0)
@@ -188,6 +348,14 @@ struct Worker
                     pInfos = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(reinterpret_cast<uint8_t*>(pInfos) + pInfos->NextEntryOffset);
                 }
             }
+            else
+            {
+                WLOGA("Warning : FileWatcher Buffer Overflow. Some notifications are lost. path = %s", DirectoryPath.c_str());
+            }
+
+            // まとめる時間が経過したものを通知.
+            if (!Manual)
+            { pQueue->Flush(); }
         }
 
         CloseHandle(hEvent);
@@ -196,11 +364,246 @@ struct Worker
         hEvent      = nullptr;
         hDir        = nullptr;
         pFinish     = nullptr;
-        pListener   = nullptr;
+        pQueue      = nullptr;
+        Buffer.clear();
+        Buffer.shrink_to_fit();
+    }
+};
+
+#else
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kWatchMask =
+    IN_CREATE       |   // 作成.
+    IN_DELETE       |   // 削除.
+    IN_MODIFY       |   // 書き込み.
+    IN_ATTRIB       |   // 属性の変更.
+    IN_CLOSE_WRITE  |   // 書き込みモードで開いたファイルを閉じた.
+    IN_MOVED_FROM   |   // 名前変更前.
+    IN_MOVED_TO     |   // 名前変更後.
+    IN_DELETE_SELF  |   // 監視ディレクトリ自体の削除.
+    IN_ONLYDIR      |
+    IN_DONT_FOLLOW;
+
+///////////////////////////////////////////////////////////////////////////////
+// Worker structure
+///////////////////////////////////////////////////////////////////////////////
+//! @brief  inotify はディレクトリ単位の監視のため, サブディレクトリごとに監視を追加します.
+struct Worker
+{
+    int                                     Fd              = -1;
+    uint32_t                                WaitTimeMsec    = 0;
+    bool                                    Manual          = false;
+    std::vector<uint8_t>                    Buffer          = {};
+    std::string                             DirectoryPath   = {};
+    std::unordered_map<int, std::string>    Dirs            = {};   //!< 監視記述子から相対パスへの対応表.
+    asdx::FileUpdateQueue*                  pQueue          = nullptr;
+    std::atomic<bool>*                      pFinish         = nullptr;
+
+    Worker()
+    { /* DO_NOTHING */ }
+
+    ~Worker()
+    { /* DO_NOTHING */ }
+
+    bool Prepare(const asdx::FileWatcher::Desc& desc, std::atomic<bool>* pFlags, asdx::FileUpdateQueue* pUpdateQueue)
+    {
+        Fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (Fd < 0)
+        {
+            ELOGA("Error : inotify_init1() Failed. errno = %d", errno);
+            return false;
+        }
+
+        pFinish         = pFlags;
+        pQueue          = pUpdateQueue;
+        DirectoryPath   = desc.DirectoryPath;
+        WaitTimeMsec    = desc.WaitTimeMsec;
+        Manual          = desc.ManualDispatch;
+
+        while (DirectoryPath.size() > 1 && DirectoryPath.back() == '/')
+        { DirectoryPath.pop_back(); }
+
+        // 1イベント分は必ず読み込めるようにする.
+        Buffer.resize((std::max)(desc.BufferSize, sizeof(inotify_event) + NAME_MAX + 1));
+
+        if (!AddWatch(std::string(), false))
+        {
+            close(Fd);
+            Fd = -1;
+            Dirs.clear();
+            return false;
+        }
+
+        return true;
+    }
+
+    std::string GetFullPath(const std::string& relativePath) const
+    { return relativePath.empty() ? DirectoryPath : DirectoryPath + "/" + relativePath; }
+
+    std::string Combine(const std::string& dir, const char* name) const
+    { return dir.empty() ? std::string(name) : dir + "/" + name; }
+
+    bool AddWatch(const std::string& relativePath, bool notify)
+    {
+        auto path = GetFullPath(relativePath);
+        auto wd = inotify_add_watch(Fd, path.c_str(), kWatchMask);
+        if (wd < 0)
+        {
+            ELOGA("Error : inotify_add_watch() Failed. path = %s, errno = %d", path.c_str(), errno);
+            return false;
+        }
+
+        Dirs[wd] = relativePath;
+
+        // 監視を追加するまでの間に作成されたものは通知されないため, 走査して補う.
+        auto pDir = opendir(path.c_str());
+        if (pDir == nullptr)
+        { return true; }
+
+        for(auto pEntry = readdir(pDir); pEntry != nullptr; pEntry = readdir(pDir))
+        {
+            if (strcmp(pEntry->d_name, ".") == 0 || strcmp(pEntry->d_name, "..") == 0)
+            { continue; }
+
+            auto child = Combine(relativePath, pEntry->d_name);
+
+            struct stat st;
+            if (lstat(GetFullPath(child).c_str(), &st) != 0)
+            { continue; }
+
+            if (notify)
+            { pQueue->Push(asdx::FILE_UPDATE_ADDED, child); }
+
+            // シンボリックリンクはたどらない.
+            if (S_ISDIR(st.st_mode))
+            { AddWatch(child, notify); }
+        }
+
+        closedir(pDir);
+        return true;
+    }
+
+    void RemoveWatch(const std::string& relativePath)
+    {
+        auto prefix = relativePath + "/";
+        for(auto itr = Dirs.begin(); itr != Dirs.end(); )
+        {
+            if (itr->second == relativePath || itr->second.compare(0, prefix.size(), prefix) == 0)
+            {
+                inotify_rm_watch(Fd, itr->first);
+                itr = Dirs.erase(itr);
+            }
+            else
+            { ++itr; }
+        }
+    }
+
+    void OnEvent(const inotify_event* pEvent)
+    {
+        if (pEvent->mask & IN_Q_OVERFLOW)
+        {
+            WLOGA("Warning : FileWatcher Queue Overflow. Some notifications are lost. path = %s", DirectoryPath.c_str());
+            return;
+        }
+
+        auto itr = Dirs.find(pEvent->wd);
+        if (itr == Dirs.end())
+        { return; }
+
+        // 監視が外れたディレクトリは対応表から削除する.
+        if (pEvent->mask & (IN_IGNORED | IN_DELETE_SELF))
+        {
+            if (pEvent->mask & IN_IGNORED)
+            { Dirs.erase(itr); }
+            return;
+        }
+
+        if (pEvent->len == 0)
+        { return; }
+
+        auto path  = Combine(itr->second, pEvent->name);
+        auto isDir = (pEvent->mask & IN_ISDIR) != 0;
+
+        if (pEvent->mask & IN_CREATE)
+        {
+            pQueue->Push(asdx::FILE_UPDATE_ADDED, path);
+            if (isDir)
+            { AddWatch(path, true); }
+        }
+        else if (pEvent->mask & IN_DELETE)
+        { pQueue->Push(asdx::FILE_UPDATE_REMOVED, path); }
+        else if (pEvent->mask & IN_MOVED_FROM)
+        {
+            pQueue->Push(asdx::FILE_UPDATE_RENAMED_OLD_NAME, path);
+            if (isDir)
+            { RemoveWatch(path); }
+        }
+        else if (pEvent->mask & IN_MOVED_TO)
+        {
+            // エディタの保存 (一時ファイルを書き込んで既存のファイルへ名前変更) は, Windows では
+            // 削除と変更後の名前の順に届き MODIFIED にまとめられるため, 同じ順で積んで結果を揃えます.
+            if (!isDir)
+            { pQueue->Push(asdx::FILE_UPDATE_REMOVED, path); }
+
+            pQueue->Push(asdx::FILE_UPDATE_RENAMED_NEW_NAME, path);
+            if (isDir)
+            { AddWatch(path, true); }
+        }
+        else if (pEvent->mask & (IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE))
+        { pQueue->Push(asdx::FILE_UPDATE_MODIFIED, path); }
+    }
+
+    void operator()()
+    {
+        // 終了フラグが立つまでループ.
+        while (!pFinish->load())
+        {
+            pollfd fds = {};
+            fds.fd     = Fd;
+            fds.events = POLLIN;
+
+            auto ret = poll(&fds, 1, int(WaitTimeMsec));
+            if (ret < 0 && errno != EINTR)
+            {
+                ELOGA("Error : poll() Failed. errno = %d", errno);
+                break;
+            }
+
+            if (ret > 0 && (fds.revents & POLLIN))
+            {
+                for (;;)
+                {
+                    auto size = read(Fd, Buffer.data(), Buffer.size());
+                    if (size <= 0)
+                    { break; }
+
+                    for(ssize_t offset = 0; offset < size; )
+                    {
+                        auto pEvent = reinterpret_cast<const inotify_event*>(Buffer.data() + offset);
+                        OnEvent(pEvent);
+                        offset += sizeof(inotify_event) + pEvent->len;
+                    }
+                }
+            }
+
+            // まとめる時間が経過したものを通知.
+            if (!Manual)
+            { pQueue->Flush(); }
+        }
+
+        close(Fd);
+
+        Fd          = -1;
+        pFinish     = nullptr;
+        pQueue      = nullptr;
+        Dirs.clear();
         Buffer.clear();
         Buffer.shrink_to_fit();
     }
 };
+#endif//defined(_WIN32)
 
 } // namespace
 
@@ -230,13 +633,27 @@ bool FileWatcher::Init(const Desc& desc)
     // 念のために終了させる.
     Term();
 
+    if (desc.DirectoryPath == nullptr || desc.pListener == nullptr)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
+
     // 終了フラグを下す.
     m_Finish = false;
+    m_Manual = desc.ManualDispatch;
+
+    // 通知をまとめるキューを生成.
+    m_pQueue = new FileUpdateQueue(desc.DirectoryPath, desc.pListener, desc.DebounceMsec);
 
     // ワーカーを初期化.
     Worker worker;
-    if (!worker.Prepare(desc, &m_Finish))
-    { return false; }
+    if (!worker.Prepare(desc, &m_Finish, m_pQueue))
+    {
+        delete m_pQueue;
+        m_pQueue = nullptr;
+        return false;
+    }
 
     // 監視スレッド起動.
     m_pThread = new std::thread(worker);
@@ -269,6 +686,21 @@ void FileWatcher::Term()
     // スレッド破棄.
     delete m_pThread;
     m_pThread = nullptr;
+
+    // 通知していない更新は破棄.
+    delete m_pQueue;
+    m_pQueue = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+//      まとめた更新を通知します.
+//-----------------------------------------------------------------------------
+void FileWatcher::Dispatch()
+{
+    if (!m_Manual || m_pQueue == nullptr)
+    { return; }
+
+    m_pQueue->Flush();
 }
 
 } // namespace asdx
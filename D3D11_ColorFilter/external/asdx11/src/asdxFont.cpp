@@ -14,6 +14,7 @@
 #include <asdxLogger.h>
 #include <asdxMisc.h>
 #include <asdxRenderState.h>
+#include <asdxTlsfHeap.h>
 #include <vector>
 
 
@@ -235,7 +236,7 @@ bool Font::Init
         size_t textureSize = fileHeader.TextureHeader.Stride * fileHeader.TextureHeader.Rows;
 
         // テクセルのメモリを確保.
-        uint8_t* pPixels = new uint8_t [ textureSize ];
+        uint8_t* pPixels = ASDX_ALLOC_ASSET( textureSize, HEAP_TAG_FONT );
 
         // NULLチェック.
         if ( pPixels == nullptr )
@@ -283,7 +284,7 @@ bool Font::Init
 
             fclose( pFile );
 
-            delete [] pPixels;
+            FreeAssetMemory( pPixels );
             pPixels = nullptr;
 
             return false;
@@ -313,7 +314,7 @@ bool Font::Init
                 // テクスチャ解放.
                 pTexture->Release();
 
-                delete [] pPixels;
+                FreeAssetMemory( pPixels );
                 pPixels = nullptr;
 
                 // エラーログ出力.
@@ -330,7 +331,7 @@ bool Font::Init
             //SetDebugObjectName( m_pSRV.GetPtr(), "asdx::Font::m_pSRV" );
         }
 
-        delete [] pPixels;
+        FreeAssetMemory( pPixels );
         pPixels = nullptr;
 
     }
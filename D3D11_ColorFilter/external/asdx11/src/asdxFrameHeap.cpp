@@ -8,23 +8,48 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include <new>
+#include <cassert>
+#include <cstring>
 #include <asdxFrameHeap.h>
 #include <asdxLogger.h>
+#include <asdxMemoryTracker.h>
 
 
 namespace asdx {
 
+namespace /* anonymous */ {
+
+//-----------------------------------------------------------------------------
+//      アライメントを調整します.
+//-----------------------------------------------------------------------------
+inline uintptr_t AlignUp(uintptr_t value, size_t alignment)
+{ return (value + alignment - 1) & ~(uintptr_t(alignment) - 1); }
+
+//-----------------------------------------------------------------------------
+//      2の累乗かどうかチェックします.
+//-----------------------------------------------------------------------------
+inline bool IsPow2(size_t value)
+{ return value != 0 && (value & (value - 1)) == 0; }
+
+} // namespace /* anonymous */
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // FrameHeap class
 ///////////////////////////////////////////////////////////////////////////////
+const size_t FrameHeap::kDefaultAlignment;
 
 //-----------------------------------------------------------------------------
 //      コンストラクタです.
 //-----------------------------------------------------------------------------
 FrameHeap::FrameHeap()
-: m_Size    (0)
-, m_pBuffer (nullptr)
-, m_Offset  (0)
+: m_Size            (0)
+, m_pFrames         (nullptr)
+, m_FrameCount      (0)
+, m_FrameIndex      (0)
+, m_FrameNumber     (0)
+, m_HighWaterMark   (0)
+, m_OverflowCount   (0)
 { /* DO_NOTHING */ }
 
 //-----------------------------------------------------------------------------
@@ -36,19 +61,48 @@ FrameHeap::~FrameHeap()
 //-----------------------------------------------------------------------------
 //      初期化処理を行います.
 //-----------------------------------------------------------------------------
-bool FrameHeap::Init(size_t size)
+bool FrameHeap::Init(size_t size, uint32_t frameCount)
 {
     Term();
 
-    m_pBuffer = new(std::nothrow) uint8_t[size];
-    if (m_pBuffer == nullptr)
+    if (size == 0 || frameCount == 0)
+    {
+        ELOG("Error : Invalid Argument.");
+        return false;
+    }
+
+    m_pFrames = new(std::nothrow) Frame[frameCount];
+    if (m_pFrames == nullptr)
     {
         ELOG("Error : Out of memory.");
         return false;
     }
 
-    m_Size   = size;
-    m_Offset = 0;
+    m_FrameCount = frameCount;
+
+    for(auto i=0u; i<frameCount; ++i)
+    {
+        auto& frame = m_pFrames[i];
+        frame.Offset.store(0, std::memory_order_relaxed);
+        frame.pOverflow    = nullptr;
+        frame.OverflowUsed = 0;
+
+        frame.pBuffer = new(std::nothrow) uint8_t[size];
+        if (frame.pBuffer == nullptr)
+        {
+            ASDX_TRACK_FAIL(size, HEAP_TAG_TEMP);
+            ELOG("Error : Out of memory.");
+            Term();
+            return false;
+        }
+        ASDX_TRACK_ALLOC(frame.pBuffer, size, HEAP_TAG_TEMP);
+    }
+
+    m_Size          = size;
+    m_FrameIndex    = 0;
+    m_FrameNumber   = 0;
+    m_HighWaterMark = 0;
+    m_OverflowCount.store(0, std::memory_order_relaxed);
 
     return true;
 }
@@ -58,32 +112,98 @@ bool FrameHeap::Init(size_t size)
 //-----------------------------------------------------------------------------
 void FrameHeap::Term()
 {
-    if (m_pBuffer != nullptr)
+    if (m_pFrames != nullptr)
     {
-        delete[] m_pBuffer;
-        m_pBuffer = nullptr;
+        for(auto i=0u; i<m_FrameCount; ++i)
+        {
+            ResetFrame(m_pFrames[i]);
+            ASDX_TRACK_FREE(m_pFrames[i].pBuffer);
+            delete[] m_pFrames[i].pBuffer;
+        }
+
+        delete[] m_pFrames;
+        m_pFrames = nullptr;
     }
 
-    m_Size   = 0;
-    m_Offset = 0;
+    m_Size          = 0;
+    m_FrameCount    = 0;
+    m_FrameIndex    = 0;
+    m_HighWaterMark = 0;
 }
 
 //-----------------------------------------------------------------------------
-//      バッファ先頭にオフセットをリセットします.
+//      現在のフレームのバッファ先頭にオフセットをリセットします.
 //-----------------------------------------------------------------------------
 void FrameHeap::Reset()
-{ m_Offset = 0; }
+{
+    if (m_pFrames == nullptr)
+    { return; }
+
+    auto& frame = m_pFrames[m_FrameIndex];
+    auto used = GetUsedSize(frame);
+    if (used > m_HighWaterMark)
+    { m_HighWaterMark = used; }
+
+    ResetFrame(frame);
+    m_FrameNumber++;
+}
+
+//-----------------------------------------------------------------------------
+//      次のフレームに進みます.
+//-----------------------------------------------------------------------------
+void FrameHeap::NextFrame()
+{
+    if (m_pFrames == nullptr)
+    { return; }
+
+    auto used = GetUsedSize(m_pFrames[m_FrameIndex]);
+    if (used > m_HighWaterMark)
+    { m_HighWaterMark = used; }
+
+    m_FrameIndex = (m_FrameIndex + 1) % m_FrameCount;
+    ResetFrame(m_pFrames[m_FrameIndex]);
+    m_FrameNumber++;
+}
 
 //-----------------------------------------------------------------------------
 //      メモリ確保を行います.
 //-----------------------------------------------------------------------------
-void* FrameHeap::Alloc(size_t size)
+void* FrameHeap::Alloc(size_t size, size_t alignment)
 {
-    if (GetRestSize() < size)
+    assert(IsPow2(alignment));
+    if (m_pFrames == nullptr || !IsPow2(alignment))
     { return nullptr; }
 
-    auto ptr = m_pBuffer + m_Offset;
-    m_Offset += size;
+    auto& frame = m_pFrames[m_FrameIndex];
+    auto  base  = reinterpret_cast<uintptr_t>(frame.pBuffer);
+
+    // ロックを取らずにオフセットを進めます.
+    auto offset = frame.Offset.load(std::memory_order_relaxed);
+    for(;;)
+    {
+        auto head = AlignUp(base + offset, alignment) - base;
+        if (head > m_Size || m_Size - head < size)
+        { return AllocOverflow(frame, size, alignment); }
+
+        if (frame.Offset.compare_exchange_weak(offset, head + size, std::memory_order_relaxed))
+        { return frame.pBuffer + head; }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      文字列を複製します.
+//-----------------------------------------------------------------------------
+const char* FrameHeap::CopyString(const char* value)
+{
+    if (value == nullptr)
+    { return nullptr; }
+
+    auto size = strlen(value) + 1;
+    auto ptr  = static_cast<char*>(Alloc(size, 1));
+    if (ptr == nullptr)
+    { return nullptr; }
+
+    memcpy(ptr, value, size);
     return ptr;
 }
 
@@ -97,6 +217,219 @@ size_t FrameHeap::GetSize() const
 //      利用可能なメモリサイズを取得します.
 //-----------------------------------------------------------------------------
 size_t FrameHeap::GetRestSize() const
-{ return m_Size - m_Offset; }
+{
+    if (m_pFrames == nullptr)
+    { return 0; }
+
+    return m_Size - m_pFrames[m_FrameIndex].Offset.load(std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+//      フレーム数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t FrameHeap::GetFrameCount() const
+{ return m_FrameCount; }
+
+//-----------------------------------------------------------------------------
+//      フレームが切り替わった回数を取得します.
+//-----------------------------------------------------------------------------
+uint64_t FrameHeap::GetFrameNumber() const
+{ return m_FrameNumber; }
+
+//-----------------------------------------------------------------------------
+//      1フレームで使用したメモリサイズの最大値を取得します.
+//-----------------------------------------------------------------------------
+size_t FrameHeap::GetHighWaterMark() const
+{
+    if (m_pFrames == nullptr)
+    { return m_HighWaterMark; }
+
+    auto used = GetUsedSize(m_pFrames[m_FrameIndex]);
+    return (used > m_HighWaterMark) ? used : m_HighWaterMark;
+}
+
+//-----------------------------------------------------------------------------
+//      オーバーフローブロックを確保した回数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t FrameHeap::GetOverflowCount() const
+{ return m_OverflowCount.load(std::memory_order_relaxed); }
+
+//-----------------------------------------------------------------------------
+//      オーバーフローブロックからメモリを確保します.
+//-----------------------------------------------------------------------------
+void* FrameHeap::AllocOverflow(Frame& frame, size_t size, size_t alignment)
+{
+    std::lock_guard<std::mutex> locker(m_OverflowLock);
+
+    auto pBlock = frame.pOverflow;
+    if (pBlock != nullptr)
+    {
+        auto base = reinterpret_cast<uintptr_t>(pBlock->pBuffer);
+        auto head = AlignUp(base + pBlock->Offset, alignment) - base;
+        if (head <= pBlock->Size && pBlock->Size - head >= size)
+        {
+            frame.OverflowUsed += head + size - pBlock->Offset;
+            pBlock->Offset      = head + size;
+            return pBlock->pBuffer + head;
+        }
+    }
+
+    // 通常のバッファと同じサイズのブロックを連結します.
+    auto blockSize = (size + alignment > m_Size) ? size + alignment : m_Size;
+
+    pBlock = new(std::nothrow) OverflowBlock();
+    if (pBlock == nullptr)
+    {
+        ELOG("Error : Out of memory.");
+        return nullptr;
+    }
+
+    pBlock->pBuffer = new(std::nothrow) uint8_t[blockSize];
+    if (pBlock->pBuffer == nullptr)
+    {
+        ASDX_TRACK_FAIL(blockSize, HEAP_TAG_TEMP);
+        ELOG("Error : Out of memory.");
+        delete pBlock;
+        return nullptr;
+    }
+    ASDX_TRACK_ALLOC(pBlock->pBuffer, blockSize, HEAP_TAG_TEMP);
+
+    m_OverflowCount.fetch_add(1, std::memory_order_relaxed);
+
+    auto base = reinterpret_cast<uintptr_t>(pBlock->pBuffer);
+    auto head = AlignUp(base, alignment) - base;
+
+    pBlock->Size    = blockSize;
+    pBlock->Offset  = head + size;
+    pBlock->pNext   = frame.pOverflow;
+    frame.pOverflow = pBlock;
+
+    frame.OverflowUsed += head + size;
+    return pBlock->pBuffer + head;
+}
+
+//-----------------------------------------------------------------------------
+//      フレームのバッファをリセットし, オーバーフローブロックを解放します.
+//-----------------------------------------------------------------------------
+void FrameHeap::ResetFrame(Frame& frame)
+{
+    auto pBlock = frame.pOverflow;
+    while(pBlock != nullptr)
+    {
+        auto pNext = pBlock->pNext;
+        ASDX_TRACK_FREE(pBlock->pBuffer);
+        delete[] pBlock->pBuffer;
+        delete pBlock;
+        pBlock = pNext;
+    }
+
+    frame.pOverflow    = nullptr;
+    frame.OverflowUsed = 0;
+    frame.Offset.store(0, std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+//      フレームの使用量を取得します.
+//-----------------------------------------------------------------------------
+size_t FrameHeap::GetUsedSize(const Frame& frame) const
+{ return frame.Offset.load(std::memory_order_relaxed) + frame.OverflowUsed; }
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FrameArena class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+FrameArena::FrameArena()
+: m_pHeap       (nullptr)
+, m_ChunkSize   (0)
+, m_pCursor     (nullptr)
+, m_pEnd        (nullptr)
+, m_FrameNumber (0)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+FrameArena::~FrameArena()
+{ Term(); }
+
+//-----------------------------------------------------------------------------
+//      初期化処理を行います.
+//-----------------------------------------------------------------------------
+bool FrameArena::Init(FrameHeap* pHeap, size_t chunkSize)
+{
+    if (pHeap == nullptr || chunkSize == 0)
+    {
+        ELOG("Error : Invalid Argument.");
+        return false;
+    }
+
+    m_pHeap       = pHeap;
+    m_ChunkSize   = chunkSize;
+    m_pCursor     = nullptr;
+    m_pEnd        = nullptr;
+    m_FrameNumber = pHeap->GetFrameNumber();
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      終了処理を行います.
+//-----------------------------------------------------------------------------
+void FrameArena::Term()
+{
+    m_pHeap     = nullptr;
+    m_ChunkSize = 0;
+    m_pCursor   = nullptr;
+    m_pEnd      = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+//      メモリを確保します.
+//-----------------------------------------------------------------------------
+void* FrameArena::Alloc(size_t size, size_t alignment)
+{
+    assert(IsPow2(alignment));
+    if (m_pHeap == nullptr || !IsPow2(alignment))
+    { return nullptr; }
+
+    // フレームが切り替わったらチャンクは再利用されているので破棄します.
+    if (m_FrameNumber != m_pHeap->GetFrameNumber())
+    {
+        m_pCursor     = nullptr;
+        m_pEnd        = nullptr;
+        m_FrameNumber = m_pHeap->GetFrameNumber();
+    }
+
+    if (m_pCursor != nullptr)
+    {
+        auto cursor = reinterpret_cast<uintptr_t>(m_pCursor);
+        auto end    = reinterpret_cast<uintptr_t>(m_pEnd);
+        auto head   = AlignUp(cursor, alignment);
+        if (head <= end && end - head >= size)
+        {
+            m_pCursor = m_pCursor + (head - cursor) + size;
+            return m_pCursor - size;
+        }
+    }
+
+    // チャンクの半分を超える要求はチャンクを無駄にしないよう直接確保します.
+    if (size + alignment > m_ChunkSize / 2)
+    { return m_pHeap->Alloc(size, alignment); }
+
+    auto pChunk = static_cast<uint8_t*>(m_pHeap->Alloc(m_ChunkSize, 64));
+    if (pChunk == nullptr)
+    { return nullptr; }
+
+    auto cursor = reinterpret_cast<uintptr_t>(pChunk);
+    auto head   = AlignUp(cursor, alignment);
+
+    m_pCursor = pChunk + (head - cursor) + size;
+    m_pEnd    = pChunk + m_ChunkSize;
+    return m_pCursor - size;
+}
 
-} // namespace asdx
\ No newline at end of file
+} // namespace asdx
@@ -14,7 +14,9 @@
 #include <imgui.h>
 #include <imgui_internal.h>
 #include <asdxMisc.h>
+#include <asdxMemoryTracker.h>
 #include <codecvt>
+#include <cstdlib>
 
 
 namespace {
@@ -598,6 +600,30 @@ void SetClipboardText(void*, const char* text)
     CloseClipboard();
 }
 
+#if defined(ASDX_ENABLE_MEMORY_TRACKER)
+//-----------------------------------------------------------------------------
+//      ImGui のメモリを確保します.
+//-----------------------------------------------------------------------------
+void* GuiAlloc(size_t size, void*)
+{
+    auto ptr = malloc(size);
+    if (ptr == nullptr)
+    { ASDX_TRACK_FAIL(size, asdx::HEAP_TAG_GUI); }
+    else
+    { ASDX_TRACK_ALLOC(ptr, size, asdx::HEAP_TAG_GUI); }
+    return ptr;
+}
+
+//-----------------------------------------------------------------------------
+//      ImGui のメモリを解放します.
+//-----------------------------------------------------------------------------
+void GuiFree(void* ptr, void*)
+{
+    ASDX_TRACK_FREE(ptr);
+    free(ptr);
+}
+#endif//defined(ASDX_ENABLE_MEMORY_TRACKER)
+
 } // namespace
 
 
@@ -643,6 +669,10 @@ bool GuiMgr::Init
     m_pContext = pContext;
     m_LastTime = std::chrono::system_clock::now();
 
+#if defined(ASDX_ENABLE_MEMORY_TRACKER)
+    ImGui::SetAllocatorFunctions(GuiAlloc, GuiFree);
+#endif
+
     ImGui::CreateContext();
 
     auto& io = ImGui::GetIO();
@@ -9,6 +9,36 @@
 //-------------------------------------------------------------------------------------------------
 #include <asdxHash.h>
 #include <cstring>
+#include <cwchar>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    #define ASDX_CRC32C_X86     1
+    #include <nmmintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#elif defined(_M_ARM64) || defined(__aarch64__)
+    #define ASDX_CRC32C_ARM     1
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <arm_acle.h>
+        #if defined(__linux__)
+            #include <sys/auxv.h>
+            #include <asm/hwcap.h>
+        #endif
+    #endif
+#endif
+
+#if defined(_MSC_VER)
+    #define ASDX_TARGET_CRC32C
+#elif defined(ASDX_CRC32C_X86)
+    #define ASDX_TARGET_CRC32C  __attribute__((target("sse4.2")))
+#elif defined(ASDX_CRC32C_ARM)
+    #define ASDX_TARGET_CRC32C  __attribute__((target("+crc")))
+#endif
 
 
 namespace /* anonymous */ {
@@ -16,76 +46,250 @@ namespace /* anonymous */ {
 //-------------------------------------------------------------------------------------------------
 // Constant Values.
 //-------------------------------------------------------------------------------------------------
-const uint32_t CRC_TABLE[ 256 ] = {
-    0x00000000, 0x77073096, 0xee0e612c, 0x990951ba,
-    0x076dc419, 0x706af48f, 0xe963a535, 0x9e6495a3,
-    0x0edb8832, 0x79dcb8a4, 0xe0d5e91e, 0x97d2d988,
-    0x09b64c2b, 0x7eb17cbd, 0xe7b82d07, 0x90bf1d91,
-    0x1db71064, 0x6ab020f2, 0xf3b97148, 0x84be41de,
-    0x1adad47d, 0x6ddde4eb, 0xf4d4b551, 0x83d385c7,
-    0x136c9856, 0x646ba8c0, 0xfd62f97a, 0x8a65c9ec,
-    0x14015c4f, 0x63066cd9, 0xfa0f3d63, 0x8d080df5,
-    0x3b6e20c8, 0x4c69105e, 0xd56041e4, 0xa2677172,
-    0x3c03e4d1, 0x4b04d447, 0xd20d85fd, 0xa50ab56b,
-    0x35b5a8fa, 0x42b2986c, 0xdbbbc9d6, 0xacbcf940,
-    0x32d86ce3, 0x45df5c75, 0xdcd60dcf, 0xabd13d59,
-    0x26d930ac, 0x51de003a, 0xc8d75180, 0xbfd06116,
-    0x21b4f4b5, 0x56b3c423, 0xcfba9599, 0xb8bda50f,
-    0x2802b89e, 0x5f058808, 0xc60cd9b2, 0xb10be924,
-    0x2f6f7c87, 0x58684c11, 0xc1611dab, 0xb6662d3d,
-    0x76dc4190, 0x01db7106, 0x98d220bc, 0xefd5102a,
-    0x71b18589, 0x06b6b51f, 0x9fbfe4a5, 0xe8b8d433,
-    0x7807c9a2, 0x0f00f934, 0x9609a88e, 0xe10e9818,
-    0x7f6a0dbb, 0x086d3d2d, 0x91646c97, 0xe6635c01,
-    0x6b6b51f4, 0x1c6c6162, 0x856530d8, 0xf262004e,
-    0x6c0695ed, 0x1b01a57b, 0x8208f4c1, 0xf50fc457,
-    0x65b0d9c6, 0x12b7e950, 0x8bbeb8ea, 0xfcb9887c,
-    0x62dd1ddf, 0x15da2d49, 0x8cd37cf3, 0xfbd44c65,
-    0x4db26158, 0x3ab551ce, 0xa3bc0074, 0xd4bb30e2,
-    0x4adfa541, 0x3dd895d7, 0xa4d1c46d, 0xd3d6f4fb,
-    0x4369e96a, 0x346ed9fc, 0xad678846, 0xda60b8d0,
-    0x44042d73, 0x33031de5, 0xaa0a4c5f, 0xdd0d7cc9,
-    0x5005713c, 0x270241aa, 0xbe0b1010, 0xc90c2086,
-    0x5768b525, 0x206f85b3, 0xb966d409, 0xce61e49f,
-    0x5edef90e, 0x29d9c998, 0xb0d09822, 0xc7d7a8b4,
-    0x59b33d17, 0x2eb40d81, 0xb7bd5c3b, 0xc0ba6cad,
-    0xedb88320, 0x9abfb3b6, 0x03b6e20c, 0x74b1d29a,
-    0xead54739, 0x9dd277af, 0x04db2615, 0x73dc1683,
-    0xe3630b12, 0x94643b84, 0x0d6d6a3e, 0x7a6a5aa8,
-    0xe40ecf0b, 0x9309ff9d, 0x0a00ae27, 0x7d079eb1,
-    0xf00f9344, 0x8708a3d2, 0x1e01f268, 0x6906c2fe,
-    0xf762575d, 0x806567cb, 0x196c3671, 0x6e6b06e7,
-    0xfed41b76, 0x89d32be0, 0x10da7a5a, 0x67dd4acc,
-    0xf9b9df6f, 0x8ebeeff9, 0x17b7be43, 0x60b08ed5,
-    0xd6d6a3e8, 0xa1d1937e, 0x38d8c2c4, 0x4fdff252,
-    0xd1bb67f1, 0xa6bc5767, 0x3fb506dd, 0x48b2364b,
-    0xd80d2bda, 0xaf0a1b4c, 0x36034af6, 0x41047a60,
-    0xdf60efc3, 0xa867df55, 0x316e8eef, 0x4669be79,
-    0xcb61b38c, 0xbc66831a, 0x256fd2a0, 0x5268e236,
-    0xcc0c7795, 0xbb0b4703, 0x220216b9, 0x5505262f,
-    0xc5ba3bbe, 0xb2bd0b28, 0x2bb45a92, 0x5cb36a04,
-    0xc2d7ffa7, 0xb5d0cf31, 0x2cd99e8b, 0x5bdeae1d,
-    0x9b64c2b0, 0xec63f226, 0x756aa39c, 0x026d930a,
-    0x9c0906a9, 0xeb0e363f, 0x72076785, 0x05005713,
-    0x95bf4a82, 0xe2b87a14, 0x7bb12bae, 0x0cb61b38,
-    0x92d28e9b, 0xe5d5be0d, 0x7cdcefb7, 0x0bdbdf21,
-    0x86d3d2d4, 0xf1d4e242, 0x68ddb3f8, 0x1fda836e,
-    0x81be16cd, 0xf6b9265b, 0x6fb077e1, 0x18b74777,
-    0x88085ae6, 0xff0f6a70, 0x66063bca, 0x11010b5c,
-    0x8f659eff, 0xf862ae69, 0x616bffd3, 0x166ccf45,
-    0xa00ae278, 0xd70dd2ee, 0x4e048354, 0x3903b3c2,
-    0xa7672661, 0xd06016f7, 0x4969474d, 0x3e6e77db,
-    0xaed16a4a, 0xd9d65adc, 0x40df0b66, 0x37d83bf0,
-    0xa9bcae53, 0xdebb9ec5, 0x47b2cf7f, 0x30b5ffe9,
-    0xbdbdf21c, 0xcabac28a, 0x53b39330, 0x24b4a3a6,
-    0xbad03605, 0xcdd70693, 0x54de5729, 0x23d967bf,
-    0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94,
-    0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d,
-};
+const uint32_t CRC32_POLY   = 0xEDB88320;   // CRC32 (ISO-HDLC) の反転多項式.
+const uint32_t CRC32C_POLY  = 0x82F63B78;   // CRC32C (Castagnoli) の反転多項式.
 
 const uint32_t FNV_OFFSET_BASIS_32   = 2166136261;
 const uint32_t FNV_PRIME_32          = 16777619;
 
+const uint64_t XXH_PRIME64_1 = 11400714785074694791ull;
+const uint64_t XXH_PRIME64_2 = 14029467366897019727ull;
+const uint64_t XXH_PRIME64_3 = 1609587929392839161ull;
+const uint64_t XXH_PRIME64_4 = 9650029242287828579ull;
+const uint64_t XXH_PRIME64_5 = 2870177450012600261ull;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// CrcTable structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct CrcTable
+{
+    uint32_t    Slice[16][256];     //!< slicing-by-16 用のテーブルです. Slice[0] が通常のテーブルです.
+
+    explicit CrcTable( uint32_t poly )
+    {
+        for( uint32_t i=0; i<256; ++i )
+        {
+            auto c = i;
+            for( auto j=0; j<8; ++j )
+            { c = ( c & 1 ) ? ( poly ^ ( c >> 1 ) ) : ( c >> 1 ); }
+            Slice[0][i] = c;
+        }
+
+        // Slice[k][i] は i の後ろに k バイトの 0 が続く場合の値.
+        for( uint32_t k=1; k<16; ++k )
+        {
+            for( uint32_t i=0; i<256; ++i )
+            {
+                auto c = Slice[k - 1][i];
+                Slice[k][i] = Slice[0][c & 0xFF] ^ ( c >> 8 );
+            }
+        }
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+//      CRC32 のテーブルを取得します.
+//-------------------------------------------------------------------------------------------------
+const CrcTable& GetCrc32Table()
+{
+    static const CrcTable table( CRC32_POLY );
+    return table;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      CRC32C のテーブルを取得します.
+//-------------------------------------------------------------------------------------------------
+const CrcTable& GetCrc32CTable()
+{
+    static const CrcTable table( CRC32C_POLY );
+    return table;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      リトルエンディアンで32bit値を読み込みます.
+//-------------------------------------------------------------------------------------------------
+inline uint32_t Read32( const uint8_t* p )
+{
+    uint32_t result;
+    memcpy( &result, p, sizeof(result) );
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      リトルエンディアンで64bit値を読み込みます.
+//-------------------------------------------------------------------------------------------------
+inline uint64_t Read64( const uint8_t* p )
+{
+    uint64_t result;
+    memcpy( &result, p, sizeof(result) );
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      slicing-by-16 で CRC を更新します.
+//-------------------------------------------------------------------------------------------------
+uint32_t UpdateCrcTable( const CrcTable& table, uint32_t crc, const uint8_t* pBuffer, size_t size )
+{
+    const auto& t = table.Slice;
+
+    // 16 バイトごとに 16 個のテーブルを引き, 依存関係を 1 バイト単位から 16 バイト単位にする.
+    // 対象プラットフォームは全てリトルエンディアン.
+    while( size >= 16 )
+    {
+        auto a = Read32( pBuffer +  0 ) ^ crc;
+        auto b = Read32( pBuffer +  4 );
+        auto c = Read32( pBuffer +  8 );
+        auto d = Read32( pBuffer + 12 );
+
+        crc = t[15][ a        & 0xFF] ^ t[14][(a >>  8) & 0xFF] ^ t[13][(a >> 16) & 0xFF] ^ t[12][a >> 24]
+            ^ t[11][ b        & 0xFF] ^ t[10][(b >>  8) & 0xFF] ^ t[ 9][(b >> 16) & 0xFF] ^ t[ 8][b >> 24]
+            ^ t[ 7][ c        & 0xFF] ^ t[ 6][(c >>  8) & 0xFF] ^ t[ 5][(c >> 16) & 0xFF] ^ t[ 4][c >> 24]
+            ^ t[ 3][ d        & 0xFF] ^ t[ 2][(d >>  8) & 0xFF] ^ t[ 1][(d >> 16) & 0xFF] ^ t[ 0][d >> 24];
+
+        pBuffer += 16;
+        size    -= 16;
+    }
+
+    while( size > 0 )
+    {
+        crc = t[0][( crc ^ *pBuffer ) & 0xFF] ^ ( crc >> 8 );
+        pBuffer++;
+        size--;
+    }
+
+    return crc;
+}
+
+#if defined(ASDX_CRC32C_X86) || defined(ASDX_CRC32C_ARM)
+//-------------------------------------------------------------------------------------------------
+//      CRC32 命令で CRC32C を更新します.
+//-------------------------------------------------------------------------------------------------
+ASDX_TARGET_CRC32C
+uint32_t UpdateCrc32CHardware( uint32_t crc, const uint8_t* pBuffer, size_t size )
+{
+#if defined(ASDX_CRC32C_X86)
+    #if defined(_M_X64) || defined(__x86_64__)
+        uint64_t crc64 = crc;
+        while( size >= 8 )
+        {
+            crc64 = _mm_crc32_u64( crc64, Read64( pBuffer ) );
+            pBuffer += 8;
+            size    -= 8;
+        }
+        crc = uint32_t( crc64 );
+    #else
+        while( size >= 4 )
+        {
+            crc = _mm_crc32_u32( crc, Read32( pBuffer ) );
+            pBuffer += 4;
+            size    -= 4;
+        }
+    #endif
+
+    while( size > 0 )
+    {
+        crc = _mm_crc32_u8( crc, *pBuffer );
+        pBuffer++;
+        size--;
+    }
+#else
+    while( size >= 8 )
+    {
+        crc = __crc32cd( crc, Read64( pBuffer ) );
+        pBuffer += 8;
+        size    -= 8;
+    }
+
+    while( size > 0 )
+    {
+        crc = __crc32cb( crc, *pBuffer );
+        pBuffer++;
+        size--;
+    }
+#endif
+
+    return crc;
+}
+#endif
+
+//-------------------------------------------------------------------------------------------------
+//      CPU が CRC32 命令に対応しているかどうか判定します.
+//-------------------------------------------------------------------------------------------------
+bool DetectCrc32CHardware()
+{
+#if defined(ASDX_CRC32C_X86)
+    // CPUID.1:ECX の bit 20 が SSE4.2.
+    #if defined(_MSC_VER)
+        int info[4] = {};
+        __cpuid( info, 1 );
+        return ( info[2] & ( 1 << 20 ) ) != 0;
+    #else
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if ( !__get_cpuid( 1, &eax, &ebx, &ecx, &edx ) )
+        { return false; }
+        return ( ecx & bit_SSE4_2 ) != 0;
+    #endif
+#elif defined(ASDX_CRC32C_ARM)
+    #if defined(__linux__) && !defined(_MSC_VER)
+        return ( getauxval( AT_HWCAP ) & HWCAP_CRC32 ) != 0;
+    #else
+        // Windows on ARM と Apple Silicon は常に対応している.
+        return true;
+    #endif
+#else
+    return false;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      CRC32 命令が使用可能かどうかを取得します.
+//-------------------------------------------------------------------------------------------------
+bool IsCrc32CHardwareEnabled()
+{
+    static const bool enabled = DetectCrc32CHardware();
+    return enabled;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      CRC32C を更新します.
+//-------------------------------------------------------------------------------------------------
+uint32_t UpdateCrc32C( uint32_t crc, const uint8_t* pBuffer, size_t size )
+{
+#if defined(ASDX_CRC32C_X86) || defined(ASDX_CRC32C_ARM)
+    if ( IsCrc32CHardwareEnabled() )
+    { return UpdateCrc32CHardware( crc, pBuffer, size ); }
+#endif
+    return UpdateCrcTable( GetCrc32CTable(), crc, pBuffer, size );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      64bit の左回転です.
+//-------------------------------------------------------------------------------------------------
+inline uint64_t Rotl64( uint64_t x, int r )
+{ return ( x << r ) | ( x >> ( 64 - r ) ); }
+
+//-------------------------------------------------------------------------------------------------
+//      xxHash64 のストライプを処理します.
+//-------------------------------------------------------------------------------------------------
+inline uint64_t XxhRound( uint64_t acc, uint64_t input )
+{
+    acc += input * XXH_PRIME64_2;
+    acc  = Rotl64( acc, 31 );
+    acc *= XXH_PRIME64_1;
+    return acc;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      xxHash64 のアキュムレータを合成します.
+//-------------------------------------------------------------------------------------------------
+inline uint64_t XxhMergeRound( uint64_t acc, uint64_t value )
+{
+    acc ^= XxhRound( 0, value );
+    acc  = acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+    return acc;
+}
+
 } // namespace /* anonymous */
 
 
@@ -106,32 +310,28 @@ Crc32::Crc32()
 //      引数付きコンストラクタです.
 //-------------------------------------------------------------------------------------------------
 Crc32::Crc32( const uint32_t size, const uint8_t* pBuffer )
-{
-    uint32_t c = 0xFFFFFFFF;
-    for( uint32_t i=0; i<size; ++i )
-    { c = CRC_TABLE[ ( c ^ pBuffer[ i ] ) & 0xFF ] ^ ( c >> 8 ); }
-    m_Hash = c ^ 0xFFFFFFFF;
-}
+: m_Hash( 0 )
+{ Update( size, pBuffer ); }
 
 //-------------------------------------------------------------------------------------------------
 //      引数付きコンストラクタです.
 //-------------------------------------------------------------------------------------------------
 Crc32::Crc32( const char* pBuffer )
-{
-    uint32_t c = 0xFFFFFFFF;
-    for( uint32_t i=0; i<strlen(pBuffer); ++i )
-    { c = CRC_TABLE[ ( c ^ pBuffer[ i ] ) & 0xFF ] ^ ( c >> 8 ); }
-    m_Hash = c ^ 0xFFFFFFFF;
-}
+: m_Hash( 0 )
+{ Update( strlen( pBuffer ), reinterpret_cast<const uint8_t*>( pBuffer ) ); }
 
 //-------------------------------------------------------------------------------------------------
 //      引数付きコンストラクタです.
 //-------------------------------------------------------------------------------------------------
 Crc32::Crc32( const wchar_t* pBuffer )
 {
+    // 従来の値と一致させるため, 各文字の下位 8bit のみを使用する.
+    const auto& table = GetCrc32Table().Slice[0];
+    const auto  count = wcslen( pBuffer );
+
     uint32_t c = 0xFFFFFFFF;
-    for( uint32_t i=0; i<wcslen(pBuffer); ++i )
-    { c = CRC_TABLE[ ( c ^ pBuffer[ i ] ) & 0xFF ] ^ ( c >> 8 ); }
+    for( size_t i=0; i<count; ++i )
+    { c = table[ ( c ^ pBuffer[ i ] ) & 0xFF ] ^ ( c >> 8 ); }
     m_Hash = c ^ 0xFFFFFFFF;
 }
 
@@ -149,6 +349,16 @@ Crc32::Crc32( const Crc32& value )
 : m_Hash( value.m_Hash )
 { /* DO_NOTHING */  }
 
+//-------------------------------------------------------------------------------------------------
+//      データを追加してハッシュキーを更新します.
+//-------------------------------------------------------------------------------------------------
+Crc32& Crc32::Update( const size_t size, const uint8_t* pBuffer )
+{
+    // 確定済みの値を反転すると途中の状態に戻る.
+    m_Hash = UpdateCrcTable( GetCrc32Table(), m_Hash ^ 0xFFFFFFFF, pBuffer, size ) ^ 0xFFFFFFFF;
+    return (*this);
+}
+
 //-------------------------------------------------------------------------------------------------
 //      ハッシュキーを返却します.
 //-------------------------------------------------------------------------------------------------
@@ -189,6 +399,78 @@ Crc32& Crc32::operator = ( const Crc32& value )
 }
 
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Crc32C class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+Crc32C::Crc32C()
+: m_Hash( 0 )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      引数付きコンストラクタです.
+//-------------------------------------------------------------------------------------------------
+Crc32C::Crc32C( const size_t size, const uint8_t* pBuffer )
+: m_Hash( 0 )
+{ Update( size, pBuffer ); }
+
+//-------------------------------------------------------------------------------------------------
+//      引数付きコンストラクタです.
+//-------------------------------------------------------------------------------------------------
+Crc32C::Crc32C( const char* pBuffer )
+: m_Hash( 0 )
+{ Update( strlen( pBuffer ), reinterpret_cast<const uint8_t*>( pBuffer ) ); }
+
+//-------------------------------------------------------------------------------------------------
+//      引数付きコンストラクタです.
+//-------------------------------------------------------------------------------------------------
+Crc32C::Crc32C( const uint32_t value )
+: m_Hash( value )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      データを追加してハッシュキーを更新します.
+//-------------------------------------------------------------------------------------------------
+Crc32C& Crc32C::Update( const size_t size, const uint8_t* pBuffer )
+{
+    m_Hash = UpdateCrc32C( m_Hash ^ 0xFFFFFFFF, pBuffer, size ) ^ 0xFFFFFFFF;
+    return (*this);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ハッシュキーを返却します.
+//-------------------------------------------------------------------------------------------------
+uint32_t Crc32C::GetHash() const
+{ return m_Hash; }
+
+//-------------------------------------------------------------------------------------------------
+//      等価比較演算子です.
+//-------------------------------------------------------------------------------------------------
+bool Crc32C::operator == ( const Crc32C& value ) const
+{ return ( m_Hash == value.m_Hash ); }
+
+//-------------------------------------------------------------------------------------------------
+//      非等価比較演算子です.
+//-------------------------------------------------------------------------------------------------
+bool Crc32C::operator != ( const Crc32C& value ) const
+{ return ( m_Hash != value.m_Hash ); }
+
+//-------------------------------------------------------------------------------------------------
+//      CRC32 命令を使用しているかどうかを取得します.
+//-------------------------------------------------------------------------------------------------
+bool Crc32C::IsHardwareEnabled()
+{
+#if defined(ASDX_CRC32C_X86) || defined(ASDX_CRC32C_ARM)
+    return IsCrc32CHardwareEnabled();
+#else
+    return false;
+#endif
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Fnv1 class
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -215,8 +497,10 @@ Fnv1::Fnv1( const uint32_t size, const uint8_t* pBuffer )
 //-------------------------------------------------------------------------------------------------
 Fnv1::Fnv1( const char* pBuffer )
 {
+    const auto count = strlen( pBuffer );
+
     m_Hash = FNV_OFFSET_BASIS_32;
-    for( uint32_t i=0; i<strlen(pBuffer); ++i )
+    for( size_t i=0; i<count; ++i )
     { m_Hash = (FNV_PRIME_32 * m_Hash) ^ pBuffer[ i ]; }
 }
 
@@ -225,8 +509,10 @@ Fnv1::Fnv1( const char* pBuffer )
 //-------------------------------------------------------------------------------------------------
 Fnv1::Fnv1( const wchar_t* pBuffer )
 {
+    const auto count = wcslen( pBuffer );
+
     m_Hash = FNV_OFFSET_BASIS_32;
-    for( uint32_t i=0; i<wcslen(pBuffer); ++i )
+    for( size_t i=0; i<count; ++i )
     { m_Hash = (FNV_PRIME_32 * m_Hash) ^ pBuffer[ i ]; }
 }
 
@@ -310,8 +596,10 @@ Fnv1a::Fnv1a( const uint32_t size, const uint8_t* pBuffer )
 //-------------------------------------------------------------------------------------------------
 Fnv1a::Fnv1a( const char* pBuffer )
 {
+    const auto count = strlen( pBuffer );
+
     m_Hash = FNV_OFFSET_BASIS_32;
-    for( uint32_t i=0; i<strlen(pBuffer); ++i )
+    for( size_t i=0; i<count; ++i )
     { m_Hash = ( m_Hash ^ pBuffer[i] ) * FNV_PRIME_32; }
 }
 
@@ -320,8 +608,10 @@ Fnv1a::Fnv1a( const char* pBuffer )
 //-------------------------------------------------------------------------------------------------
 Fnv1a::Fnv1a( const wchar_t* pBuffer )
 {
+    const auto count = wcslen( pBuffer );
+
     m_Hash = FNV_OFFSET_BASIS_32;
-    for( uint32_t i=0; i<wcslen(pBuffer); ++i )
+    for( size_t i=0; i<count; ++i )
     { m_Hash = ( m_Hash ^ pBuffer[i] ) * FNV_PRIME_32; }
 }
 
@@ -379,4 +669,160 @@ Fnv1a& Fnv1a::operator = ( const Fnv1a& value )
 }
 
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// XxHash64 class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+XxHash64::XxHash64( const uint64_t seed )
+{ Reset( seed ); }
+
+//-------------------------------------------------------------------------------------------------
+//      引数付きコンストラクタです.
+//-------------------------------------------------------------------------------------------------
+XxHash64::XxHash64( const size_t size, const uint8_t* pBuffer, const uint64_t seed )
+{
+    Reset( seed );
+    Update( size, pBuffer );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      状態を初期化します.
+//-------------------------------------------------------------------------------------------------
+void XxHash64::Reset( const uint64_t seed )
+{
+    m_Acc[0]     = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+    m_Acc[1]     = seed + XXH_PRIME64_2;
+    m_Acc[2]     = seed;
+    m_Acc[3]     = seed - XXH_PRIME64_1;
+    m_Seed       = seed;
+    m_TotalSize  = 0;
+    m_BufferSize = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      データを追加します.
+//-------------------------------------------------------------------------------------------------
+XxHash64& XxHash64::Update( const size_t size, const uint8_t* pBuffer )
+{
+    auto pCur = pBuffer;
+    auto pEnd = pBuffer + size;
+
+    m_TotalSize += size;
+
+    // 前回の端数と合わせて 1 ストライプに満たない場合は溜めておく.
+    if ( m_BufferSize + size < 32 )
+    {
+        if ( size > 0 )
+        { memcpy( m_Buffer + m_BufferSize, pCur, size ); }
+        m_BufferSize += uint32_t( size );
+        return (*this);
+    }
+
+    if ( m_BufferSize > 0 )
+    {
+        auto fill = 32 - m_BufferSize;
+        memcpy( m_Buffer + m_BufferSize, pCur, fill );
+        pCur += fill;
+
+        m_Acc[0] = XxhRound( m_Acc[0], Read64( m_Buffer +  0 ) );
+        m_Acc[1] = XxhRound( m_Acc[1], Read64( m_Buffer +  8 ) );
+        m_Acc[2] = XxhRound( m_Acc[2], Read64( m_Buffer + 16 ) );
+        m_Acc[3] = XxhRound( m_Acc[3], Read64( m_Buffer + 24 ) );
+        m_BufferSize = 0;
+    }
+
+    auto v1 = m_Acc[0];
+    auto v2 = m_Acc[1];
+    auto v3 = m_Acc[2];
+    auto v4 = m_Acc[3];
+
+    while( pEnd - pCur >= 32 )
+    {
+        v1 = XxhRound( v1, Read64( pCur +  0 ) );
+        v2 = XxhRound( v2, Read64( pCur +  8 ) );
+        v3 = XxhRound( v3, Read64( pCur + 16 ) );
+        v4 = XxhRound( v4, Read64( pCur + 24 ) );
+        pCur += 32;
+    }
+
+    m_Acc[0] = v1;
+    m_Acc[1] = v2;
+    m_Acc[2] = v3;
+    m_Acc[3] = v4;
+
+    if ( pCur < pEnd )
+    {
+        m_BufferSize = uint32_t( pEnd - pCur );
+        memcpy( m_Buffer, pCur, m_BufferSize );
+    }
+
+    return (*this);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ハッシュキーを取得します.
+//-------------------------------------------------------------------------------------------------
+uint64_t XxHash64::GetHash() const
+{
+    uint64_t h;
+
+    if ( m_TotalSize >= 32 )
+    {
+        h = Rotl64( m_Acc[0], 1 ) + Rotl64( m_Acc[1], 7 ) + Rotl64( m_Acc[2], 12 ) + Rotl64( m_Acc[3], 18 );
+        h = XxhMergeRound( h, m_Acc[0] );
+        h = XxhMergeRound( h, m_Acc[1] );
+        h = XxhMergeRound( h, m_Acc[2] );
+        h = XxhMergeRound( h, m_Acc[3] );
+    }
+    else
+    { h = m_Seed + XXH_PRIME64_5; }
+
+    h += m_TotalSize;
+
+    auto pCur = m_Buffer;
+    auto pEnd = m_Buffer + m_BufferSize;
+
+    while( pEnd - pCur >= 8 )
+    {
+        h ^= XxhRound( 0, Read64( pCur ) );
+        h  = Rotl64( h, 27 ) * XXH_PRIME64_1 + XXH_PRIME64_4;
+        pCur += 8;
+    }
+
+    if ( pEnd - pCur >= 4 )
+    {
+        h ^= uint64_t( Read32( pCur ) ) * XXH_PRIME64_1;
+        h  = Rotl64( h, 23 ) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        pCur += 4;
+    }
+
+    while( pCur < pEnd )
+    {
+        h ^= ( *pCur ) * XXH_PRIME64_5;
+        h  = Rotl64( h, 11 ) * XXH_PRIME64_1;
+        pCur++;
+    }
+
+    h ^= h >> 33;
+    h *= XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ハッシュキーを一括で計算します.
+//-------------------------------------------------------------------------------------------------
+uint64_t XxHash64::Compute( const size_t size, const uint8_t* pBuffer, const uint64_t seed )
+{
+    XxHash64 hash( seed );
+    hash.Update( size, pBuffer );
+    return hash.GetHash();
+}
+
+
 } // namespace asdx
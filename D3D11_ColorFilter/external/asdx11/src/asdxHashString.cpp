@@ -20,35 +20,58 @@ namespace asdx {
 //      コンストラクタです.
 //-----------------------------------------------------------------------------
 HashString::HashString()
-: m_String()
-, m_Hash  (0)
+: m_Handle(StringPool::kEmptyHandle)
+, m_Hash  (ComputeFnv1a("", 0))
 { /* DO_NOTHING */ }
 
 //-----------------------------------------------------------------------------
 //      引数付きコンストラクタです.
 //-----------------------------------------------------------------------------
 HashString::HashString(const char* value)
-: m_String(value)
-{ m_Hash = asdx::Fnv1a(value).GetHash(); }
+: m_Handle(StringPool::GetInstance().Intern(value))
+{ m_Hash = StringPool::GetInstance().GetHash(m_Handle); }
 
 //-----------------------------------------------------------------------------
 //      引数付きコンストラクタです.
 //-----------------------------------------------------------------------------
 HashString::HashString(const std::string& value)
-: m_String(value)
-{ m_Hash = asdx::Fnv1a(value.c_str()).GetHash(); }
+: m_Handle(StringPool::GetInstance().Intern(value.c_str(), value.size()))
+{ m_Hash = StringPool::GetInstance().GetHash(m_Handle); }
+
+//-----------------------------------------------------------------------------
+//      引数付きコンストラクタです.
+//-----------------------------------------------------------------------------
+HashString::HashString(const HashedName& value)
+: m_Handle(StringPool::GetInstance().Intern(value))
+{ m_Hash = StringPool::GetInstance().GetHash(m_Handle); }
+
+//-----------------------------------------------------------------------------
+//      引数付きコンストラクタです.
+//-----------------------------------------------------------------------------
+HashString::HashString(StringHandle handle)
+: m_Handle(handle)
+{ m_Hash = StringPool::GetInstance().GetHash(m_Handle); }
 
 //-----------------------------------------------------------------------------
 //      文字列を取得します.
 //-----------------------------------------------------------------------------
 const char* HashString::c_str() const
-{ return m_String.c_str(); }
+{ return StringPool::GetInstance().GetString(m_Handle); }
 
 //-----------------------------------------------------------------------------
 //      std::stringを取得します.
 //-----------------------------------------------------------------------------
-const std::string& HashString::std_str() const
-{ return m_String; }
+std::string HashString::std_str() const
+{
+    auto& pool = StringPool::GetInstance();
+    return std::string(pool.GetString(m_Handle), pool.GetLength(m_Handle));
+}
+
+//-----------------------------------------------------------------------------
+//      StringPool のハンドルを取得します.
+//-----------------------------------------------------------------------------
+StringHandle HashString::handle() const
+{ return m_Handle; }
 
 //-----------------------------------------------------------------------------
 //      ハッシュ値を取得します.
@@ -60,45 +83,63 @@ uint32_t HashString::hash() const
 //      文字列が空かどうかチェックします.
 //-----------------------------------------------------------------------------
 bool HashString::empty() const
-{ return m_String.empty() || m_String == ""; }
+{ return m_Handle == StringPool::kEmptyHandle; }
 
 //-----------------------------------------------------------------------------
 //      文字数を取得します.
 //-----------------------------------------------------------------------------
 size_t HashString::size() const
-{ return m_String.size(); }
+{ return StringPool::GetInstance().GetLength(m_Handle); }
 
 //-----------------------------------------------------------------------------
 //      operator == です.
 //-----------------------------------------------------------------------------
 bool HashString::operator == (const HashString& value) const
-{ return m_Hash == value.m_Hash; }
+{ return m_Handle == value.m_Handle; }
 
 //-----------------------------------------------------------------------------
 //      operator != です.
 //-----------------------------------------------------------------------------
 bool HashString::operator != (const HashString& value) const
-{ return m_Hash != value.m_Hash; }
+{ return m_Handle != value.m_Handle; }
 
 //-----------------------------------------------------------------------------
 //      operator < です.
 //-----------------------------------------------------------------------------
 bool HashString::operator < (const HashString& value) const
-{ return m_Hash < value.m_Hash; }
+{
+    // ハッシュが衝突しても順序が破綻しないようハンドルで決着させます.
+    if (m_Hash != value.m_Hash)
+    { return m_Hash < value.m_Hash; }
+
+    return m_Handle < value.m_Handle;
+}
 
 //-----------------------------------------------------------------------------
 //      operator > です.
 //-----------------------------------------------------------------------------
 bool HashString::operator > (const HashString& value) const
-{ return m_Hash > value.m_Hash; }
+{ return value < *this; }
+
+//-----------------------------------------------------------------------------
+//      operator == です.
+//-----------------------------------------------------------------------------
+bool HashString::operator == (const HashedName& value) const
+{ return m_Hash == value.GetHash(); }
+
+//-----------------------------------------------------------------------------
+//      operator != です.
+//-----------------------------------------------------------------------------
+bool HashString::operator != (const HashedName& value) const
+{ return m_Hash != value.GetHash(); }
 
 //-----------------------------------------------------------------------------
 //      operator = です.
 //-----------------------------------------------------------------------------
 HashString& HashString::operator = (const HashString& value)
 {
-    m_String = value.m_String;
-    m_Hash = asdx::Fnv1a(value.c_str()).GetHash();
+    m_Handle = value.m_Handle;
+    m_Hash   = value.m_Hash;
     return *this;
 }
 
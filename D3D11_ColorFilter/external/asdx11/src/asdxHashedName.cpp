@@ -0,0 +1,51 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxHashedName.cpp
+// Desc : Compile Time Hashed Name.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <asdxHashedName.h>
+
+#if ASDX_IS_DEBUG
+#include <asdxLogger.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#endif//ASDX_IS_DEBUG
+
+
+namespace asdx {
+
+#if ASDX_IS_DEBUG
+
+//-----------------------------------------------------------------------------
+//      名前とハッシュ値の対応を登録し, 衝突をチェックします.
+//-----------------------------------------------------------------------------
+bool CheckHashedName(const HashedName& name)
+{
+    static std::mutex                                   s_Mutex;
+    static std::unordered_map<uint32_t, std::string>    s_Registry;
+
+    std::lock_guard<std::mutex> locker(s_Mutex);
+
+    auto itr = s_Registry.find(name.GetHash());
+    if (itr == s_Registry.end())
+    {
+        s_Registry.emplace(name.GetHash(), name.GetName());
+        return true;
+    }
+
+    if (itr->second == name.GetName())
+    { return true; }
+
+    ELOGA("Error : Hash Collision. hash = 0x%08x, name = %s, registered = %s",
+        name.GetHash(), name.GetName(), itr->second.c_str());
+    return false;
+}
+
+#endif//ASDX_IS_DEBUG
+
+} // namespace asdx
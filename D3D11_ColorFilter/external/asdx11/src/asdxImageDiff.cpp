@@ -0,0 +1,1299 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxImageDiff.cpp
+// Desc : Image Comparison Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxImageDiff.h>
+#include <asdxLogger.h>
+#include <dxgiformat.h>
+#include <emmintrin.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <thread>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const uint32_t   DECODE_ROWS_PER_TASK    = 32;   // 展開時に1タスクで処理する行数.
+static const uint32_t   BC_BLOCK_DIM            = 4;    // BCブロックの1辺のピクセル数.
+static const uint32_t   MOMENT_COUNT            = 5;    // SSIM の統計量の数(a, b, aa, bb, ab).
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FormatInfo structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct FormatInfo
+{
+    uint32_t    Size;       // ピクセル, またはブロック当たりのバイト数.
+    bool        IsBlock;    // BC圧縮フォーマットかどうか.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Accumulator structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct Accumulator
+{
+    double      SumSq   [4];    // 二乗誤差の総和.
+    double      MaxError[4];    // 最大絶対誤差.
+    double      SSIMSum [4];    // SSIM の総和.
+    uint64_t    DiffCount;      // 閾値を超えたピクセル数.
+    uint64_t    WindowCount;    // SSIM ウィンドウ数.
+    uint8_t     Padding[64];    // フォルスシェアリング回避用.
+
+    Accumulator()
+    { memset( this, 0, sizeof(Accumulator) ); }
+
+    void Merge( const Accumulator& value )
+    {
+        for( auto i=0; i<4; ++i )
+        {
+            SumSq   [i] += value.SumSq[i];
+            SSIMSum [i] += value.SSIMSum[i];
+            MaxError[i]  = std::max( MaxError[i], value.MaxError[i] );
+        }
+        DiffCount   += value.DiffCount;
+        WindowCount += value.WindowCount;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Totals structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct Totals
+{
+    Accumulator Acc;            // 集計値.
+    uint64_t    PixelCount;     // ピクセル数.
+
+    Totals()
+    : PixelCount( 0 )
+    { /* DO_NOTHING */ }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//      使用するスレッド数を決定します.
+//-------------------------------------------------------------------------------------------------
+inline uint32_t ResolveThreadCount( uint32_t threadCount, uint32_t taskCount )
+{
+    if ( threadCount == 0 )
+    { threadCount = std::max( std::thread::hardware_concurrency(), 1u ); }
+
+    return std::max( std::min( threadCount, taskCount ), 1u );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      タスクを複数スレッドで処理します.
+//-------------------------------------------------------------------------------------------------
+template<typename Func>
+void ParallelFor( uint32_t taskCount, uint32_t threadCount, const Func& func )
+{
+    if ( taskCount == 0 )
+    { return; }
+
+    if ( threadCount <= 1 )
+    {
+        for( auto i=0u; i<taskCount; ++i )
+        { func( i, 0 ); }
+        return;
+    }
+
+    // タイル毎の処理量に偏りがあるため, 固定分割ではなく取り出し式にする.
+    std::atomic<uint32_t> next( 0 );
+    auto worker = [&]( uint32_t threadIndex )
+    {
+        for(;;)
+        {
+            auto index = next.fetch_add( 1 );
+            if ( index >= taskCount )
+            { break; }
+
+            func( index, threadIndex );
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve( threadCount - 1 );
+    for( auto i=1u; i<threadCount; ++i )
+    { workers.emplace_back( worker, i ); }
+
+    worker( 0 );
+
+    for( auto& itr : workers )
+    { itr.join(); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      フォーマット情報を取得します.
+//-------------------------------------------------------------------------------------------------
+bool GetFormatInfo( uint32_t format, FormatInfo& info )
+{
+    info.IsBlock = false;
+
+    switch( format )
+    {
+    case DXGI_FORMAT_R32G32B32A32_FLOAT:
+        { info.Size = 16; }
+        break;
+
+    case DXGI_FORMAT_R32G32B32_FLOAT:
+        { info.Size = 12; }
+        break;
+
+    case DXGI_FORMAT_R16G16B16A16_FLOAT:
+    case DXGI_FORMAT_R16G16B16A16_UNORM:
+    case DXGI_FORMAT_R16G16B16A16_SNORM:
+    case DXGI_FORMAT_R32G32_FLOAT:
+        { info.Size = 8; }
+        break;
+
+    case DXGI_FORMAT_R10G10B10A2_UNORM:
+    case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+    case DXGI_FORMAT_R11G11B10_FLOAT:
+    case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DXGI_FORMAT_R8G8B8A8_SNORM:
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8X8_UNORM:
+    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+    case DXGI_FORMAT_R16G16_FLOAT:
+    case DXGI_FORMAT_R16G16_UNORM:
+    case DXGI_FORMAT_R32_FLOAT:
+        { info.Size = 4; }
+        break;
+
+    case DXGI_FORMAT_R8G8_UNORM:
+    case DXGI_FORMAT_R16_FLOAT:
+    case DXGI_FORMAT_R16_UNORM:
+    case DXGI_FORMAT_B5G6R5_UNORM:
+    case DXGI_FORMAT_B5G5R5A1_UNORM:
+    case DXGI_FORMAT_B4G4R4A4_UNORM:
+        { info.Size = 2; }
+        break;
+
+    case DXGI_FORMAT_R8_UNORM:
+    case DXGI_FORMAT_A8_UNORM:
+        { info.Size = 1; }
+        break;
+
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC4_UNORM:
+    case DXGI_FORMAT_BC4_SNORM:
+        {
+            info.Size    = 8;
+            info.IsBlock = true;
+        }
+        break;
+
+    case DXGI_FORMAT_BC2_UNORM:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC5_SNORM:
+        {
+            info.Size    = 16;
+            info.IsBlock = true;
+        }
+        break;
+
+    default:
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      16bit値を読み取ります.
+//-------------------------------------------------------------------------------------------------
+inline uint16_t Load16( const uint8_t* pSrc )
+{
+    uint16_t result;
+    memcpy( &result, pSrc, sizeof(result) );
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      32bit値を読み取ります.
+//-------------------------------------------------------------------------------------------------
+inline uint32_t Load32( const uint8_t* pSrc )
+{
+    uint32_t result;
+    memcpy( &result, pSrc, sizeof(result) );
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ビット列を浮動小数点数として解釈します.
+//-------------------------------------------------------------------------------------------------
+inline float AsFloat( uint32_t bits )
+{
+    float result;
+    memcpy( &result, &bits, sizeof(result) );
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      半精度浮動小数点数を単精度浮動小数点数に変換します.
+//-------------------------------------------------------------------------------------------------
+inline float HalfToFloat( uint16_t value )
+{
+    // asdx::F16Tofloat() は Inf/NaN を有限値として扱うため, 比較用に独自に変換する.
+    uint32_t sign = uint32_t( value & 0x8000 ) << 16;
+    uint32_t exp  = ( value >> 10 ) & 0x1f;
+    uint32_t mant = value & 0x3ff;
+
+    if ( exp == 0x1f )
+    { return AsFloat( sign | 0x7f800000 | ( mant << 13 ) ); }
+
+    if ( exp == 0 )
+    {
+        auto result = std::ldexp( float( mant ), -24 );
+        return ( sign != 0 ) ? -result : result;
+    }
+
+    return AsFloat( sign | ( ( exp + 112 ) << 23 ) | ( mant << 13 ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      符号なし小浮動小数点数(指数部5bit)を単精度浮動小数点数に変換します.
+//-------------------------------------------------------------------------------------------------
+inline float SmallFloatToFloat( uint32_t value, uint32_t mantBits )
+{
+    uint32_t exp  = value >> mantBits;
+    uint32_t mant = value & ( ( 1u << mantBits ) - 1 );
+
+    if ( exp == 0x1f )
+    { return AsFloat( 0x7f800000 | ( mant << ( 23 - mantBits ) ) ); }
+
+    if ( exp == 0 )
+    { return std::ldexp( float( mant ), -14 - int( mantBits ) ); }
+
+    return AsFloat( ( ( exp + 112 ) << 23 ) | ( mant << ( 23 - mantBits ) ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      UNORM値を浮動小数点数に変換します.
+//-------------------------------------------------------------------------------------------------
+inline float Unorm( uint32_t value, uint32_t bits )
+{ return float( value ) / float( ( 1u << bits ) - 1 ); }
+
+//-------------------------------------------------------------------------------------------------
+//      SNORM値を浮動小数点数に変換します.
+//-------------------------------------------------------------------------------------------------
+inline float Snorm( int32_t value, uint32_t bits )
+{ return std::max( float( value ) / float( ( 1 << ( bits - 1 ) ) - 1 ), -1.0f ); }
+
+//-------------------------------------------------------------------------------------------------
+//      RGBAを設定します.
+//-------------------------------------------------------------------------------------------------
+inline void SetRGBA( float* pDst, float r, float g, float b, float a )
+{
+    pDst[0] = r;
+    pDst[1] = g;
+    pDst[2] = b;
+    pDst[3] = a;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      8bit x 4 を浮動小数点数に変換します.
+//-------------------------------------------------------------------------------------------------
+inline __m128 Unorm8x4( const uint8_t* pSrc )
+{
+    auto zero = _mm_setzero_si128();
+    auto v    = _mm_cvtsi32_si128( int( Load32( pSrc ) ) );
+    v = _mm_unpacklo_epi8 ( v, zero );
+    v = _mm_unpacklo_epi16( v, zero );
+    return _mm_div_ps( _mm_cvtepi32_ps( v ), _mm_set1_ps( 255.0f ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      非圧縮フォーマットの1行を展開します.
+//-------------------------------------------------------------------------------------------------
+void DecodeRow( uint32_t format, const uint8_t* pSrc, uint32_t width, float* pDst )
+{
+    switch( format )
+    {
+    case DXGI_FORMAT_R32G32B32A32_FLOAT:
+        { memcpy( pDst, pSrc, size_t( width ) * 16 ); }
+        break;
+
+    case DXGI_FORMAT_R32G32B32_FLOAT:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 12, pDst += 4 )
+            {
+                memcpy( pDst, pSrc, 12 );
+                pDst[3] = 1.0f;
+            }
+        }
+        break;
+
+    case DXGI_FORMAT_R32G32_FLOAT:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 8, pDst += 4 )
+            {
+                memcpy( pDst, pSrc, 8 );
+                pDst[2] = 0.0f;
+                pDst[3] = 1.0f;
+            }
+        }
+        break;
+
+    case DXGI_FORMAT_R32_FLOAT:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 4, pDst += 4 )
+            { SetRGBA( pDst, AsFloat( Load32( pSrc ) ), 0.0f, 0.0f, 1.0f ); }
+        }
+        break;
+
+    case DXGI_FORMAT_R16G16B16A16_FLOAT:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 8, pDst += 4 )
+            {
+                SetRGBA( pDst,
+                    HalfToFloat( Load16( pSrc + 0 ) ),
+                    HalfToFloat( Load16( pSrc + 2 ) ),
+                    HalfToFloat( Load16( pSrc + 4 ) ),
+                    HalfToFloat( Load16( pSrc + 6 ) ) );
+            }
+        }
+        break;
+
+    case DXGI_FORMAT_R16G16_FLOAT:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 4, pDst += 4 )
+            {
+                SetRGBA( pDst,
+                    HalfToFloat( Load16( pSrc + 0 ) ),
+                    HalfToFloat( Load16( pSrc + 2 ) ),
+                    0.0f,
+                    1.0f );
+            }
+        }
+        break;
+
+    case DXGI_FORMAT_R16_FLOAT:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 2, pDst += 4 )
+            { SetRGBA( pDst, HalfToFloat( Load16( pSrc ) ), 0.0f, 0.0f, 1.0f ); }
+        }
+        break;
+
+    case DXGI_FORMAT_R16G16B16A16_UNORM:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 8, pDst += 4 )
+            {
+                SetRGBA( pDst,
+                    Unorm( Load16( pSrc + 0 ), 16 ),
+                    Unorm( Load16( pSrc + 2 ), 16 ),
+                    Unorm( Load16( pSrc + 4 ), 16 ),
+                    Unorm( Load16( pSrc + 6 ), 16 ) );
+            }
+        }
+        break;
+
+    case DXGI_FORMAT_R16G16B16A16_SNORM:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 8, pDst += 4 )
+            {
+                SetRGBA( pDst,
+                    Snorm( int16_t( Load16( pSrc + 0 ) ), 16 ),
+                    Snorm( int16_t( Load16( pSrc + 2 ) ), 16 ),
+                    Snorm( int16_t( Load16( pSrc + 4 ) ), 16 ),
+                    Snorm( int16_t( Load16( pSrc + 6 ) ), 16 ) );
+            }
+        }
+        break;
+
+    case DXGI_FORMAT_R16G16_UNORM:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 4, pDst += 4 )
+            {
+                SetRGBA( pDst,
+                    Unorm( Load16( pSrc + 0 ), 16 ),
+                    Unorm( Load16( pSrc + 2 ), 16 ),
+                    0.0f,
+                    1.0f );
+            }
+        }
+        break;
+
+    case DXGI_FORMAT_R16_UNORM:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 2, pDst += 4 )
+            { SetRGBA( pDst, Unorm( Load16( pSrc ), 16 ), 0.0f, 0.0f, 1.0f ); }
+        }
+        break;
+
+    case DXGI_FORMAT_R10G10B10A2_UNORM:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 4, pDst += 4 )
+            {
+                auto v = Load32( pSrc );
+                SetRGBA( pDst,
+                    Unorm( ( v >>  0 ) & 0x3ff, 10 ),
+                    Unorm( ( v >> 10 ) & 0x3ff, 10 ),
+                    Unorm( ( v >> 20 ) & 0x3ff, 10 ),
+                    Unorm( ( v >> 30 ) & 0x3,   2 ) );
+            }
+        }
+        break;
+
+    case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 4, pDst += 4 )
+            {
+                auto v = Load32( pSrc );
+                SetRGBA( pDst,
+                    ( float( ( v >>  0 ) & 0x3ff ) - 384.0f ) / 510.0f,
+                    ( float( ( v >> 10 ) & 0x3ff ) - 384.0f ) / 510.0f,
+                    ( float( ( v >> 20 ) & 0x3ff ) - 384.0f ) / 510.0f,
+                    Unorm( ( v >> 30 ) & 0x3, 2 ) );
+            }
+        }
+        break;
+
+    case DXGI_FORMAT_R11G11B10_FLOAT:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 4, pDst += 4 )
+            {
+                auto v = Load32( pSrc );
+                SetRGBA( pDst,
+                    SmallFloatToFloat( ( v >>  0 ) & 0x7ff, 6 ),
+                    SmallFloatToFloat( ( v >> 11 ) & 0x7ff, 6 ),
+                    SmallFloatToFloat( ( v >> 22 ) & 0x3ff, 5 ),
+                    1.0f );
+            }
+        }
+        break;
+
+    case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 4, pDst += 4 )
+            {
+                auto v     = Load32( pSrc );
+                auto scale = std::ldexp( 1.0f, int( v >> 27 ) - 24 );
+                SetRGBA( pDst,
+                    float( ( v >>  0 ) & 0x1ff ) * scale,
+                    float( ( v >>  9 ) & 0x1ff ) * scale,
+                    float( ( v >> 18 ) & 0x1ff ) * scale,
+                    1.0f );
+            }
+        }
+        break;
+
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 4, pDst += 4 )
+            { _mm_storeu_ps( pDst, Unorm8x4( pSrc ) ); }
+        }
+        break;
+
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 4, pDst += 4 )
+            {
+                auto v = Unorm8x4( pSrc );
+                _mm_storeu_ps( pDst, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 3, 0, 1, 2 ) ) );
+            }
+        }
+        break;
+
+    case DXGI_FORMAT_B8G8R8X8_UNORM:
+    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 4, pDst += 4 )
+            {
+                auto v = Unorm8x4( pSrc );
+                _mm_storeu_ps( pDst, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 3, 0, 1, 2 ) ) );
+                pDst[3] = 1.0f;
+            }
+        }
+        break;
+
+    case DXGI_FORMAT_R8G8B8A8_SNORM:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 4, pDst += 4 )
+            {
+                SetRGBA( pDst,
+                    Snorm( int8_t( pSrc[0] ), 8 ),
+                    Snorm( int8_t( pSrc[1] ), 8 ),
+                    Snorm( int8_t( pSrc[2] ), 8 ),
+                    Snorm( int8_t( pSrc[3] ), 8 ) );
+            }
+        }
+        break;
+
+    case DXGI_FORMAT_R8G8_UNORM:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 2, pDst += 4 )
+            { SetRGBA( pDst, Unorm( pSrc[0], 8 ), Unorm( pSrc[1], 8 ), 0.0f, 1.0f ); }
+        }
+        break;
+
+    case DXGI_FORMAT_R8_UNORM:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 1, pDst += 4 )
+            { SetRGBA( pDst, Unorm( pSrc[0], 8 ), 0.0f, 0.0f, 1.0f ); }
+        }
+        break;
+
+    case DXGI_FORMAT_A8_UNORM:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 1, pDst += 4 )
+            { SetRGBA( pDst, 0.0f, 0.0f, 0.0f, Unorm( pSrc[0], 8 ) ); }
+        }
+        break;
+
+    case DXGI_FORMAT_B5G6R5_UNORM:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 2, pDst += 4 )
+            {
+                auto v = Load16( pSrc );
+                SetRGBA( pDst,
+                    Unorm( ( v >> 11 ) & 0x1f, 5 ),
+                    Unorm( ( v >>  5 ) & 0x3f, 6 ),
+                    Unorm( ( v >>  0 ) & 0x1f, 5 ),
+                    1.0f );
+            }
+        }
+        break;
+
+    case DXGI_FORMAT_B5G5R5A1_UNORM:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 2, pDst += 4 )
+            {
+                auto v = Load16( pSrc );
+                SetRGBA( pDst,
+                    Unorm( ( v >> 10 ) & 0x1f, 5 ),
+                    Unorm( ( v >>  5 ) & 0x1f, 5 ),
+                    Unorm( ( v >>  0 ) & 0x1f, 5 ),
+                    Unorm( ( v >> 15 ) & 0x1,  1 ) );
+            }
+        }
+        break;
+
+    case DXGI_FORMAT_B4G4R4A4_UNORM:
+        {
+            for( auto x=0u; x<width; ++x, pSrc += 2, pDst += 4 )
+            {
+                auto v = Load16( pSrc );
+                SetRGBA( pDst,
+                    Unorm( ( v >>  8 ) & 0xf, 4 ),
+                    Unorm( ( v >>  4 ) & 0xf, 4 ),
+                    Unorm( ( v >>  0 ) & 0xf, 4 ),
+                    Unorm( ( v >> 12 ) & 0xf, 4 ) );
+            }
+        }
+        break;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      BC1形式のカラーブロックを展開します.
+//-------------------------------------------------------------------------------------------------
+void DecodeBC1Color( const uint8_t* pBlock, bool allowTransparent, float* pTexels )
+{
+    auto c0 = Load16( pBlock + 0 );
+    auto c1 = Load16( pBlock + 2 );
+    auto indices = Load32( pBlock + 4 );
+
+    float palette[4][4];
+    SetRGBA( palette[0],
+        Unorm( ( c0 >> 11 ) & 0x1f, 5 ),
+        Unorm( ( c0 >>  5 ) & 0x3f, 6 ),
+        Unorm( ( c0 >>  0 ) & 0x1f, 5 ),
+        1.0f );
+    SetRGBA( palette[1],
+        Unorm( ( c1 >> 11 ) & 0x1f, 5 ),
+        Unorm( ( c1 >>  5 ) & 0x3f, 6 ),
+        Unorm( ( c1 >>  0 ) & 0x1f, 5 ),
+        1.0f );
+
+    // BC2, BC3 のカラーブロックは常に4色モードで解釈する.
+    if ( c0 > c1 || !allowTransparent )
+    {
+        for( auto i=0; i<3; ++i )
+        {
+            palette[2][i] = ( 2.0f * palette[0][i] + palette[1][i] ) / 3.0f;
+            palette[3][i] = ( palette[0][i] + 2.0f * palette[1][i] ) / 3.0f;
+        }
+        palette[2][3] = 1.0f;
+        palette[3][3] = 1.0f;
+    }
+    else
+    {
+        for( auto i=0; i<3; ++i )
+        { palette[2][i] = ( palette[0][i] + palette[1][i] ) * 0.5f; }
+        palette[2][3] = 1.0f;
+        SetRGBA( palette[3], 0.0f, 0.0f, 0.0f, 0.0f );
+    }
+
+    for( auto i=0; i<16; ++i )
+    { memcpy( pTexels + i * 4, palette[ ( indices >> ( i * 2 ) ) & 0x3 ], sizeof(float) * 4 ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      BC4形式の1チャンネルブロックを展開します.
+//-------------------------------------------------------------------------------------------------
+void DecodeBC4Channel( const uint8_t* pBlock, bool isSigned, float* pTexels, uint32_t channel )
+{
+    float palette[8];
+    bool  sixValues;
+
+    if ( isSigned )
+    {
+        auto r0 = int8_t( pBlock[0] );
+        auto r1 = int8_t( pBlock[1] );
+        palette[0] = Snorm( r0, 8 );
+        palette[1] = Snorm( r1, 8 );
+        sixValues  = ( r0 > r1 );
+    }
+    else
+    {
+        palette[0] = Unorm( pBlock[0], 8 );
+        palette[1] = Unorm( pBlock[1], 8 );
+        sixValues  = ( pBlock[0] > pBlock[1] );
+    }
+
+    if ( sixValues )
+    {
+        for( auto i=1; i<7; ++i )
+        { palette[i + 1] = ( palette[0] * float( 7 - i ) + palette[1] * float( i ) ) / 7.0f; }
+    }
+    else
+    {
+        for( auto i=1; i<5; ++i )
+        { palette[i + 1] = ( palette[0] * float( 5 - i ) + palette[1] * float( i ) ) / 5.0f; }
+        palette[6] = ( isSigned ) ? -1.0f : 0.0f;
+        palette[7] = 1.0f;
+    }
+
+    uint64_t indices = 0;
+    for( auto i=0; i<6; ++i )
+    { indices |= uint64_t( pBlock[2 + i] ) << ( i * 8 ); }
+
+    for( auto i=0; i<16; ++i )
+    { pTexels[i * 4 + channel] = palette[ ( indices >> ( i * 3 ) ) & 0x7 ]; }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      BC圧縮ブロックを 4x4 の RGBA32F に展開します.
+//-------------------------------------------------------------------------------------------------
+void DecodeBlock( uint32_t format, const uint8_t* pBlock, float* pTexels )
+{
+    switch( format )
+    {
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+        { DecodeBC1Color( pBlock, true, pTexels ); }
+        break;
+
+    case DXGI_FORMAT_BC2_UNORM:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+        {
+            DecodeBC1Color( pBlock + 8, false, pTexels );
+            for( auto i=0; i<16; ++i )
+            { pTexels[i * 4 + 3] = Unorm( ( pBlock[i / 2] >> ( ( i & 0x1 ) * 4 ) ) & 0xf, 4 ); }
+        }
+        break;
+
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+        {
+            DecodeBC1Color( pBlock + 8, false, pTexels );
+            DecodeBC4Channel( pBlock, false, pTexels, 3 );
+        }
+        break;
+
+    case DXGI_FORMAT_BC4_UNORM:
+    case DXGI_FORMAT_BC4_SNORM:
+        {
+            for( auto i=0; i<16; ++i )
+            { SetRGBA( pTexels + i * 4, 0.0f, 0.0f, 0.0f, 1.0f ); }
+            DecodeBC4Channel( pBlock, ( format == DXGI_FORMAT_BC4_SNORM ), pTexels, 0 );
+        }
+        break;
+
+    case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC5_SNORM:
+        {
+            for( auto i=0; i<16; ++i )
+            { SetRGBA( pTexels + i * 4, 0.0f, 0.0f, 0.0f, 1.0f ); }
+            DecodeBC4Channel( pBlock + 0, ( format == DXGI_FORMAT_BC5_SNORM ), pTexels, 0 );
+            DecodeBC4Channel( pBlock + 8, ( format == DXGI_FORMAT_BC5_SNORM ), pTexels, 1 );
+        }
+        break;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      誤差をヒートマップの色に変換します.
+//-------------------------------------------------------------------------------------------------
+inline void HeatmapColor( float value, uint8_t* pDst )
+{
+    // 黒 -> 青 -> 緑 -> 黄 -> 赤.
+    static const float kRamp[5][3] = {
+        { 0.0f, 0.0f, 0.0f },
+        { 0.0f, 0.0f, 1.0f },
+        { 0.0f, 1.0f, 0.0f },
+        { 1.0f, 1.0f, 0.0f },
+        { 1.0f, 0.0f, 0.0f },
+    };
+
+    // NaN は最大誤差として扱う.
+    auto t = ( value == value ) ? std::min( std::max( value, 0.0f ), 1.0f ) * 4.0f : 4.0f;
+    auto i = std::min( uint32_t( t ), 3u );
+    auto f = t - float( i );
+
+    for( auto c=0; c<3; ++c )
+    {
+        auto v = kRamp[i][c] + ( kRamp[i + 1][c] - kRamp[i][c] ) * f;
+        pDst[c] = uint8_t( v * 255.0f + 0.5f );
+    }
+    pDst[3] = 255;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ヒートマップ用のリソースを生成します.
+//-------------------------------------------------------------------------------------------------
+bool CreateHeatmap( uint32_t width, uint32_t height, asdx::ResTexture& result )
+{
+    auto pResource = new (std::nothrow) asdx::SubResource[1];
+    if ( pResource == nullptr )
+    {
+        ELOGA( "Error : Out of Memory." );
+        return false;
+    }
+
+    pResource->Width      = width;
+    pResource->Height     = height;
+    pResource->Pitch      = width * 4;
+    pResource->SlicePitch = width * height * 4;
+    pResource->pPixels    = ASDX_ALLOC_ASSET( pResource->SlicePitch, asdx::HEAP_TAG_TEXTURE );
+    if ( pResource->pPixels == nullptr )
+    {
+        ELOGA( "Error : Out of Memory." );
+        delete [] pResource;
+        return false;
+    }
+
+    result.Width        = width;
+    result.Height       = height;
+    result.Depth        = 1;
+    result.Format       = DXGI_FORMAT_R8G8B8A8_UNORM;
+    result.MipMapCount  = 1;
+    result.SurfaceCount = 1;
+    result.Option       = 0;
+    result.pResources   = pResource;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      展開済みの画像を比較し, 集計値に加算します.
+//-------------------------------------------------------------------------------------------------
+bool Accumulate
+(
+    const asdx::DecodedImage&   lhs,
+    const asdx::DecodedImage&   rhs,
+    const asdx::ImageDiffDesc&  desc,
+    Totals&                     totals,
+    asdx::ResTexture*           pHeatmap
+)
+{
+    if ( lhs.Width  != rhs.Width  || lhs.Height != rhs.Height
+      || lhs.Width  == 0          || lhs.Height == 0
+      || lhs.Pixels.size() < size_t( lhs.Width ) * lhs.Height * 4
+      || rhs.Pixels.size() < size_t( rhs.Width ) * rhs.Height * 4 )
+    {
+        ELOGA( "Error : Image Size Mismatch. lhs = %u x %u, rhs = %u x %u",
+            lhs.Width, lhs.Height, rhs.Width, rhs.Height );
+        return false;
+    }
+
+    auto windowSize   = ( desc.WindowSize   > 0 ) ? desc.WindowSize   : 8;
+    auto windowStride = ( desc.WindowStride > 0 ) ? desc.WindowStride : windowSize;
+    if ( windowSize % windowStride != 0 )
+    {
+        ELOGA( "Error : WindowStride must divide WindowSize. size = %u, stride = %u",
+            windowSize, windowStride );
+        return false;
+    }
+
+    auto width  = lhs.Width;
+    auto height = lhs.Height;
+
+    // 画像がウィンドウより小さい場合は画像全体を1つのウィンドウとする.
+    if ( windowSize > width || windowSize > height )
+    {
+        windowSize   = std::min( width, height );
+        windowStride = windowSize;
+    }
+
+    // セルがタイルを跨がないようにタイルサイズをストライドの倍数に揃える.
+    auto tileSize = std::max( desc.TileSize, windowStride );
+    tileSize = ( tileSize + windowStride - 1 ) / windowStride * windowStride;
+
+    uint8_t* pHeat = nullptr;
+    if ( pHeatmap != nullptr )
+    {
+        if ( !CreateHeatmap( width, height, *pHeatmap ) )
+        { return false; }
+
+        pHeat = pHeatmap->pResources[0].pPixels;
+    }
+
+    auto tilesX = ( width  + tileSize - 1 ) / tileSize;
+    auto tilesY = ( height + tileSize - 1 ) / tileSize;
+    auto cellsX = width  / windowStride;
+    auto cellsY = height / windowStride;
+
+    // ストライド x ストライドのセル毎に SSIM の統計量を求めておき, ウィンドウはセルの和で求める.
+    std::vector<float> cells( size_t( cellsX ) * cellsY * MOMENT_COUNT * 4, 0.0f );
+
+    auto threadCount = ResolveThreadCount( desc.ThreadCount, tilesX * tilesY );
+    std::vector<Accumulator> accumulators( threadCount );
+
+    auto pLhs    = lhs.Pixels.data();
+    auto pRhs    = rhs.Pixels.data();
+    auto pCells  = cells.data();
+    auto absMask = _mm_castsi128_ps( _mm_set1_epi32( 0x7fffffff ) );
+    auto thresh  = _mm_set1_ps( desc.Threshold );
+    auto scale   = desc.HeatmapScale;
+
+    // 1パス目 : タイル単位で二乗誤差, 最大誤差, ヒートマップ, セルの統計量を求める.
+    ParallelFor( tilesX * tilesY, threadCount, [&]( uint32_t index, uint32_t threadIndex )
+    {
+        auto& acc = accumulators[threadIndex];
+
+        auto x0 = ( index % tilesX ) * tileSize;
+        auto y0 = ( index / tilesX ) * tileSize;
+        auto x1 = std::min( x0 + tileSize, width );
+        auto y1 = std::min( y0 + tileSize, height );
+
+        auto maxError = _mm_setzero_ps();
+        uint64_t diffCount = 0;
+
+        for( auto y=y0; y<y1; ++y )
+        {
+            auto offset = ( size_t( y ) * width + x0 ) * 4;
+            auto pA = pLhs + offset;
+            auto pB = pRhs + offset;
+            auto pH = ( pHeat != nullptr ) ? pHeat + offset : nullptr;
+
+            auto sumSq = _mm_setzero_ps();
+            for( auto x=x0; x<x1; ++x, pA += 4, pB += 4 )
+            {
+                auto d  = _mm_sub_ps( _mm_loadu_ps( pA ), _mm_loadu_ps( pB ) );
+                auto ad = _mm_and_ps( d, absMask );
+                sumSq    = _mm_add_ps( sumSq, _mm_mul_ps( d, d ) );
+                maxError = _mm_max_ps( maxError, ad );
+
+                if ( _mm_movemask_ps( _mm_cmpgt_ps( ad, thresh ) ) != 0 )
+                { diffCount++; }
+
+                if ( pH != nullptr )
+                {
+                    float e[4];
+                    _mm_storeu_ps( e, ad );
+                    HeatmapColor( std::max( std::max( e[0], e[1] ), e[2] ) * scale, pH );
+                    pH += 4;
+                }
+            }
+
+            // 行単位で倍精度に移して桁落ちを抑える.
+            float rowSq[4];
+            _mm_storeu_ps( rowSq, sumSq );
+            for( auto c=0; c<4; ++c )
+            { acc.SumSq[c] += rowSq[c]; }
+        }
+
+        float e[4];
+        _mm_storeu_ps( e, maxError );
+        for( auto c=0; c<4; ++c )
+        { acc.MaxError[c] = std::max( acc.MaxError[c], double( e[c] ) ); }
+        acc.DiffCount += diffCount;
+
+        // セルの統計量. タイルはストライドの倍数に揃えているので, 各セルは1つのタイルにのみ属する.
+        auto cy1 = std::min( y1 / windowStride, cellsY );
+        auto cx0 = x0 / windowStride;
+        auto cx1 = std::min( x1 / windowStride, cellsX );
+        for( auto cy=y0 / windowStride; cy<cy1; ++cy )
+        {
+            for( auto cx=cx0; cx<cx1; ++cx )
+            {
+                auto sa  = _mm_setzero_ps();
+                auto sb  = _mm_setzero_ps();
+                auto saa = _mm_setzero_ps();
+                auto sbb = _mm_setzero_ps();
+                auto sab = _mm_setzero_ps();
+
+                for( auto j=0u; j<windowStride; ++j )
+                {
+                    auto offset = ( size_t( cy * windowStride + j ) * width + cx * windowStride ) * 4;
+                    auto pA = pLhs + offset;
+                    auto pB = pRhs + offset;
+                    for( auto i=0u; i<windowStride; ++i, pA += 4, pB += 4 )
+                    {
+                        auto a = _mm_loadu_ps( pA );
+                        auto b = _mm_loadu_ps( pB );
+                        sa  = _mm_add_ps( sa,  a );
+                        sb  = _mm_add_ps( sb,  b );
+                        saa = _mm_add_ps( saa, _mm_mul_ps( a, a ) );
+                        sbb = _mm_add_ps( sbb, _mm_mul_ps( b, b ) );
+                        sab = _mm_add_ps( sab, _mm_mul_ps( a, b ) );
+                    }
+                }
+
+                auto pCell = pCells + ( size_t( cy ) * cellsX + cx ) * MOMENT_COUNT * 4;
+                _mm_storeu_ps( pCell +  0, sa  );
+                _mm_storeu_ps( pCell +  4, sb  );
+                _mm_storeu_ps( pCell +  8, saa );
+                _mm_storeu_ps( pCell + 12, sbb );
+                _mm_storeu_ps( pCell + 16, sab );
+            }
+        }
+    });
+
+    // 2パス目 : ウィンドウ毎の SSIM を求める.
+    auto cellsPerWindow = windowSize / windowStride;
+    auto windowsX = cellsX - cellsPerWindow + 1;
+    auto windowsY = cellsY - cellsPerWindow + 1;
+
+    auto range = desc.DynamicRange;
+    auto c1    = _mm_set1_ps( ( 0.01f * range ) * ( 0.01f * range ) );
+    auto c2    = _mm_set1_ps( ( 0.03f * range ) * ( 0.03f * range ) );
+    auto norm  = _mm_set1_ps( 1.0f / float( windowSize * windowSize ) );
+    auto two   = _mm_set1_ps( 2.0f );
+
+    ParallelFor( windowsY, threadCount, [&]( uint32_t wy, uint32_t threadIndex )
+    {
+        auto& acc = accumulators[threadIndex];
+
+        double ssimSum[4] = {};
+        for( auto wx=0u; wx<windowsX; ++wx )
+        {
+            __m128 m[MOMENT_COUNT];
+            for( auto k=0u; k<MOMENT_COUNT; ++k )
+            { m[k] = _mm_setzero_ps(); }
+
+            for( auto j=0u; j<cellsPerWindow; ++j )
+            {
+                auto pCell = pCells + ( size_t( wy + j ) * cellsX + wx ) * MOMENT_COUNT * 4;
+                for( auto i=0u; i<cellsPerWindow; ++i, pCell += MOMENT_COUNT * 4 )
+                {
+                    for( auto k=0u; k<MOMENT_COUNT; ++k )
+                    { m[k] = _mm_add_ps( m[k], _mm_loadu_ps( pCell + k * 4 ) ); }
+                }
+            }
+
+            auto muA  = _mm_mul_ps( m[0], norm );
+            auto muB  = _mm_mul_ps( m[1], norm );
+            auto muAA = _mm_mul_ps( muA, muA );
+            auto muBB = _mm_mul_ps( muB, muB );
+            auto muAB = _mm_mul_ps( muA, muB );
+            auto varA = _mm_sub_ps( _mm_mul_ps( m[2], norm ), muAA );
+            auto varB = _mm_sub_ps( _mm_mul_ps( m[3], norm ), muBB );
+            auto cov  = _mm_sub_ps( _mm_mul_ps( m[4], norm ), muAB );
+
+            auto num = _mm_mul_ps(
+                _mm_add_ps( _mm_mul_ps( two, muAB ), c1 ),
+                _mm_add_ps( _mm_mul_ps( two, cov  ), c2 ) );
+            auto den = _mm_mul_ps(
+                _mm_add_ps( _mm_add_ps( muAA, muBB ), c1 ),
+                _mm_add_ps( _mm_add_ps( varA, varB ), c2 ) );
+
+            float ssim[4];
+            _mm_storeu_ps( ssim, _mm_div_ps( num, den ) );
+            for( auto c=0; c<4; ++c )
+            { ssimSum[c] += ssim[c]; }
+        }
+
+        for( auto c=0; c<4; ++c )
+        { acc.SSIMSum[c] += ssimSum[c]; }
+        acc.WindowCount += windowsX;
+    });
+
+    for( auto& itr : accumulators )
+    { totals.Acc.Merge( itr ); }
+
+    totals.PixelCount += uint64_t( width ) * height;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      二乗誤差から PSNR を求めます.
+//-------------------------------------------------------------------------------------------------
+inline double ComputePSNR( double mse, double range )
+{
+    if ( mse <= 0.0 )
+    { return std::numeric_limits<double>::infinity(); }
+
+    return 10.0 * std::log10( range * range / mse );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      集計値から比較結果を求めます.
+//-------------------------------------------------------------------------------------------------
+void Resolve( const Totals& totals, const asdx::ImageDiffDesc& desc, asdx::ImageDiffResult& result )
+{
+    auto& acc = totals.Acc;
+    auto pixelCount  = double( std::max( totals.PixelCount, uint64_t( 1 ) ) );
+    auto windowCount = double( std::max( acc.WindowCount,   uint64_t( 1 ) ) );
+
+    result.PixelCount     = totals.PixelCount;
+    result.DiffPixelCount = acc.DiffCount;
+    result.WindowCount    = acc.WindowCount;
+
+    for( auto c=0; c<4; ++c )
+    {
+        result.MSE     [c] = acc.SumSq[c] / pixelCount;
+        result.RMSE    [c] = std::sqrt( result.MSE[c] );
+        result.PSNR    [c] = ComputePSNR( result.MSE[c], desc.DynamicRange );
+        result.SSIM    [c] = acc.SSIMSum[c] / windowCount;
+        result.MaxError[c] = acc.MaxError[c];
+    }
+
+    auto mseRGB = ( result.MSE[0] + result.MSE[1] + result.MSE[2] ) / 3.0;
+    result.RMSERGB = std::sqrt( mseRGB );
+    result.PSNRRGB = ComputePSNR( mseRGB, desc.DynamicRange );
+    result.SSIMRGB = ( result.SSIM[0] + result.SSIM[1] + result.SSIM[2] ) / 3.0;
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ImageDiffResult structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+ImageDiffResult::ImageDiffResult()
+: PixelCount    ( 0 )
+, DiffPixelCount( 0 )
+, WindowCount   ( 0 )
+, RMSERGB       ( 0.0 )
+, PSNRRGB       ( 0.0 )
+, SSIMRGB       ( 0.0 )
+{
+    for( auto i=0; i<4; ++i )
+    {
+        MSE     [i] = 0.0;
+        RMSE    [i] = 0.0;
+        PSNR    [i] = 0.0;
+        SSIM    [i] = 0.0;
+        MaxError[i] = 0.0;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      浮動小数点に展開可能なフォーマットかどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool IsDecodableFormat( uint32_t format )
+{
+    FormatInfo info;
+    return GetFormatInfo( format, info );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      サブリソースを RGBA32F に展開します.
+//-------------------------------------------------------------------------------------------------
+bool DecodeSubResource
+(
+    const SubResource&  subresource,
+    uint32_t            format,
+    DecodedImage&       result,
+    uint32_t            threadCount
+)
+{
+    FormatInfo info;
+    if ( !GetFormatInfo( format, info ) )
+    {
+        ELOGA( "Error : Unsupported Format. format = %u", format );
+        return false;
+    }
+
+    if ( subresource.pPixels == nullptr || subresource.Pitch == 0 || subresource.Width == 0 )
+    {
+        ELOGA( "Error : Invalid Argument." );
+        return false;
+    }
+
+    auto width = subresource.Width;
+    auto rows  = subresource.SlicePitch / subresource.Pitch;
+
+    if ( info.IsBlock )
+    {
+        auto blocksX = ( width + BC_BLOCK_DIM - 1 ) / BC_BLOCK_DIM;
+        if ( subresource.Pitch < blocksX * info.Size )
+        {
+            ELOGA( "Error : Invalid Pitch. pitch = %u", subresource.Pitch );
+            return false;
+        }
+
+        // 2Dテクスチャは端数ブロックを除いた縦幅, ボリュームはブロック行すべてを展開する.
+        auto height = ( rows == ( subresource.Height + BC_BLOCK_DIM - 1 ) / BC_BLOCK_DIM )
+                    ? subresource.Height
+                    : rows * BC_BLOCK_DIM;
+
+        result.Width  = width;
+        result.Height = height;
+        result.Pixels.resize( size_t( width ) * height * 4 );
+
+        auto pDst = result.Pixels.data();
+        ParallelFor( rows, ResolveThreadCount( threadCount, rows ),
+            [&]( uint32_t by, uint32_t )
+        {
+            auto pBlock = subresource.pPixels + size_t( by ) * subresource.Pitch;
+            auto y0     = by * BC_BLOCK_DIM;
+            auto h      = std::min( BC_BLOCK_DIM, height - y0 );
+
+            float texels[16 * 4];
+            for( auto bx=0u; bx<blocksX; ++bx, pBlock += info.Size )
+            {
+                DecodeBlock( format, pBlock, texels );
+
+                auto x0 = bx * BC_BLOCK_DIM;
+                auto w  = std::min( BC_BLOCK_DIM, width - x0 );
+                for( auto j=0u; j<h; ++j )
+                {
+                    memcpy( pDst + ( size_t( y0 + j ) * width + x0 ) * 4,
+                            texels + j * BC_BLOCK_DIM * 4,
+                            sizeof(float) * 4 * w );
+                }
+            }
+        });
+
+        return true;
+    }
+
+    if ( subresource.Pitch < width * info.Size )
+    {
+        ELOGA( "Error : Invalid Pitch. pitch = %u", subresource.Pitch );
+        return false;
+    }
+
+    result.Width  = width;
+    result.Height = rows;
+    result.Pixels.resize( size_t( width ) * rows * 4 );
+
+    auto pDst  = result.Pixels.data();
+    auto tasks = ( rows + DECODE_ROWS_PER_TASK - 1 ) / DECODE_ROWS_PER_TASK;
+    ParallelFor( tasks, ResolveThreadCount( threadCount, tasks ),
+        [&]( uint32_t index, uint32_t )
+    {
+        auto y0 = index * DECODE_ROWS_PER_TASK;
+        auto y1 = std::min( y0 + DECODE_ROWS_PER_TASK, rows );
+        for( auto y=y0; y<y1; ++y )
+        {
+            DecodeRow(
+                format,
+                subresource.pPixels + size_t( y ) * subresource.Pitch,
+                width,
+                pDst + size_t( y ) * width * 4 );
+        }
+    });
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      展開済みの画像を比較します.
+//-------------------------------------------------------------------------------------------------
+bool CompareImage
+(
+    const DecodedImage&     lhs,
+    const DecodedImage&     rhs,
+    const ImageDiffDesc&    desc,
+    ImageDiffResult&        result,
+    ResTexture*             pHeatmap
+)
+{
+    Totals totals;
+    if ( !Accumulate( lhs, rhs, desc, totals, pHeatmap ) )
+    { return false; }
+
+    Resolve( totals, desc, result );
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      テクスチャリソースを比較します.
+//-------------------------------------------------------------------------------------------------
+bool CompareResTexture
+(
+    const ResTexture&       lhs,
+    const ResTexture&       rhs,
+    const ImageDiffDesc&    desc,
+    ImageDiffResult&        result,
+    ResTexture*             pHeatmap
+)
+{
+    if ( lhs.pResources == nullptr || rhs.pResources == nullptr )
+    {
+        ELOGA( "Error : Invalid Argument." );
+        return false;
+    }
+
+    if ( lhs.Width        != rhs.Width
+      || lhs.Height       != rhs.Height
+      || lhs.Depth        != rhs.Depth
+      || lhs.MipMapCount  != rhs.MipMapCount
+      || lhs.SurfaceCount != rhs.SurfaceCount )
+    {
+        ELOGA( "Error : Texture Layout Mismatch." );
+        return false;
+    }
+
+    auto mipCount     = ( lhs.MipMapCount  > 0 ) ? lhs.MipMapCount  : 1;
+    auto surfaceCount = ( lhs.SurfaceCount > 0 ) ? lhs.SurfaceCount : 1;
+
+    Totals       totals;
+    DecodedImage imageL;
+    DecodedImage imageR;
+
+    for( auto i=0u; i<mipCount * surfaceCount; ++i )
+    {
+        if ( !DecodeSubResource( lhs.pResources[i], lhs.Format, imageL, desc.ThreadCount )
+          || !DecodeSubResource( rhs.pResources[i], rhs.Format, imageR, desc.ThreadCount ) )
+        {
+            if ( pHeatmap != nullptr && i > 0 )
+            { pHeatmap->Release(); }
+            return false;
+        }
+
+        if ( !Accumulate( imageL, imageR, desc, totals, ( i == 0 ) ? pHeatmap : nullptr ) )
+        {
+            if ( pHeatmap != nullptr && i > 0 )
+            { pHeatmap->Release(); }
+            return false;
+        }
+    }
+
+    Resolve( totals, desc, result );
+    return true;
+}
+
+} // namespace asdx
@@ -8,6 +8,7 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include <asdxIncludeExpansion.h>
+#include <asdxMemoryTracker.h>
 #include <cstdio>
 #include <fstream>
 #include <locale>
@@ -93,11 +94,13 @@ bool IncludeExpansion::LoadFile(const char* filename, std::string& result)
 
     auto size = end_pos - cur_pos;
     auto pBuffer = new char[size + 1];
+    ASDX_TRACK_ALLOC(pBuffer, size + 1, HEAP_TAG_SHADER);
     fread(pBuffer, size, 1, pFile);
     pBuffer[size] = '\0';
     fclose(pFile);
 
     result = pBuffer;
+    ASDX_TRACK_FREE(pBuffer);
     delete[] pBuffer;
 
     return true;
@@ -0,0 +1,861 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxIoService.cpp
+// Desc : Asynchronous File I/O Service.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxIoService.h>
+#include <asdxTlsfHeap.h>
+#include <asdxLogger.h>
+#include <algorithm>
+#include <cstring>
+#include <cassert>
+
+#if defined(_WIN32)
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif//defined(_WIN32)
+
+#if defined(__linux__) && defined(__has_include)
+    #if __has_include(<linux/io_uring.h>)
+        #define ASDX_IO_URING_SUPPORTED
+        #include <linux/io_uring.h>
+        #include <sys/mman.h>
+        #include <sys/syscall.h>
+        #include <sys/uio.h>
+    #endif
+#endif//defined(__linux__) && defined(__has_include)
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IoSpan structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  隣接する要求をまとめた1回分の読み込みです.
+struct IoSpan
+{
+    IoFileTask*     pTask;          //!< 所属するタスクです.
+    uint64_t        Offset;         //!< 読み込み開始位置です.
+    uint32_t        Size;           //!< 読み込むサイズです.
+    uint32_t        ReadSize;       //!< 読み込んだサイズです.
+    uint8_t*        pStaging;       //!< 複数の要求をまとめた場合の一時バッファです.
+    uint32_t        First;          //!< 先頭の要求番号です.
+    uint32_t        Count;          //!< 要求数です.
+#if defined(ASDX_IO_URING_SUPPORTED)
+    struct iovec    Vec;            //!< io_uring に渡すバッファです.
+#endif
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IoFileTask structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  1ファイル分の読み込みタスクです.
+struct IoFileTask
+{
+    std::string                 Path;       //!< ファイルパスです.
+    std::vector<IoRequest*>     Requests;   //!< オフセット順に並べた要求です.
+    std::vector<IoSpan>         Spans;      //!< まとめた読み込みです.
+    IoBatch*                    pBatch;     //!< 完了を通知するハンドルです.
+    intptr_t                    File;       //!< ファイルハンドルです.
+    uint32_t                    Next;       //!< 次に発行する読み込み番号です.
+    uint32_t                    Remain;     //!< 完了していない読み込み数です.
+};
+
+} // namespace asdx
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const intptr_t   kInvalidFile = -1;          // 無効なファイルハンドルです.
+static const uint32_t   kMaxReadChunk = 1u << 30;   // 1回の読み込みの最大サイズです.
+
+//-------------------------------------------------------------------------------------------------
+//      読み込み用にファイルを開きます.
+//-------------------------------------------------------------------------------------------------
+intptr_t OpenFile( const char* path )
+{
+#if defined(_WIN32)
+    auto hFile = CreateFileA(
+        path,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr );
+    if ( hFile == INVALID_HANDLE_VALUE )
+    { return kInvalidFile; }
+
+    return reinterpret_cast<intptr_t>( hFile );
+#else
+    auto fd = open( path, O_RDONLY | O_CLOEXEC );
+    if ( fd < 0 )
+    { return kInvalidFile; }
+
+    return intptr_t( fd );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルを閉じます.
+//-------------------------------------------------------------------------------------------------
+void CloseFile( intptr_t file )
+{
+    if ( file == kInvalidFile )
+    { return; }
+
+#if defined(_WIN32)
+    CloseHandle( reinterpret_cast<HANDLE>( file ) );
+#else
+    close( int( file ) );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      位置を指定して読み込みます. ファイルポインタは変更しません.
+//-------------------------------------------------------------------------------------------------
+uint32_t ReadAt( intptr_t file, uint64_t offset, void* pDst, uint32_t size, uint32_t& retryCount )
+{
+    auto pBuf = static_cast<uint8_t*>( pDst );
+    auto done = 0u;
+
+    while( done < size )
+    {
+        auto chunk = (std::min)( size - done, kMaxReadChunk );
+
+    #if defined(_WIN32)
+        OVERLAPPED ov = {};
+        ov.Offset     = DWORD( ( offset + done ) & 0xffffffff );
+        ov.OffsetHigh = DWORD( ( offset + done ) >> 32 );
+
+        DWORD readSize = 0;
+        if ( !ReadFile( reinterpret_cast<HANDLE>( file ), pBuf + done, chunk, &readSize, &ov ) || readSize == 0 )
+        { break; }
+    #else
+        auto readSize = pread( int( file ), pBuf + done, chunk, off_t( offset + done ) );
+        if ( readSize < 0 && errno == EINTR )
+        { continue; }
+        if ( readSize <= 0 )
+        { break; }
+    #endif
+
+        done += uint32_t( readSize );
+
+        // 要求より短い場合は残りを読み直します. ファイル終端では次の読み込みが 0 を返して終了します.
+        if ( uint32_t( readSize ) < chunk && done < size )
+        { retryCount++; }
+    }
+
+    return done;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      まとめた読み込みの結果を各要求に分配します.
+//-------------------------------------------------------------------------------------------------
+void FinishSpan( asdx::IoSpan& span )
+{
+    auto& requests = span.pTask->Requests;
+
+    if ( span.pStaging == nullptr )
+    {
+        requests[span.First]->ReadSize = span.ReadSize;
+        return;
+    }
+
+    for( auto i=span.First; i<span.First + span.Count; ++i )
+    {
+        auto pRequest = requests[i];
+        auto begin    = pRequest->Offset - span.Offset;
+        auto size     = 0u;
+        if ( span.ReadSize > begin )
+        { size = uint32_t( (std::min<uint64_t>)( pRequest->Size, span.ReadSize - begin ) ); }
+
+        if ( size > 0 )
+        { memcpy( pRequest->pDst, span.pStaging + begin, size ); }
+
+        pRequest->ReadSize = size;
+    }
+
+    asdx::SafeFreeAssetMemory( span.pStaging );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      要求をまとめて読み込みを構築します.
+//-------------------------------------------------------------------------------------------------
+void BuildSpans( asdx::IoFileTask* pTask, uint32_t mergeGap, uint32_t maxMergeSize )
+{
+    auto& requests = pTask->Requests;
+    auto  count    = uint32_t( requests.size() );
+
+    auto addSpan = [pTask]( uint64_t offset, uint64_t end, uint32_t first, uint32_t count, bool staging )
+    {
+        asdx::IoSpan span = {};
+        span.pTask    = pTask;
+        span.Offset   = offset;
+        span.Size     = uint32_t( end - offset );
+        span.First    = first;
+        span.Count    = count;
+        span.pStaging = ( staging ) ? ASDX_ALLOC_ASSET( span.Size, asdx::HEAP_TAG_TEMP ) : nullptr;
+        pTask->Spans.push_back( span );
+        return !staging || span.pStaging != nullptr;
+    };
+
+    auto first = 0u;
+    while( first < count )
+    {
+        auto begin = requests[first]->Offset;
+        auto end   = begin + requests[first]->Size;
+        auto last  = first + 1;
+
+        while( last < count )
+        {
+            auto pRequest = requests[last];
+            auto nextEnd  = (std::max)( end, pRequest->Offset + pRequest->Size );
+            if ( pRequest->Offset > end + mergeGap || nextEnd - begin > maxMergeSize )
+            { break; }
+
+            end = nextEnd;
+            last++;
+        }
+
+        if ( last - first == 1 )
+        {
+            addSpan( begin, end, first, 1, false );
+        }
+        else if ( !addSpan( begin, end, first, last - first, true ) )
+        {
+            // 一時バッファが確保できない場合はまとめずに読み込みます.
+            pTask->Spans.pop_back();
+            for( auto i=first; i<last; ++i )
+            { addSpan( requests[i]->Offset, requests[i]->Offset + requests[i]->Size, i, 1, false ); }
+        }
+
+        first = last;
+    }
+
+#if defined(ASDX_IO_URING_SUPPORTED)
+    for( auto& span : pTask->Spans )
+    {
+        span.Vec.iov_base = ( span.pStaging != nullptr ) ? span.pStaging : requests[span.First]->pDst;
+        span.Vec.iov_len  = span.Size;
+    }
+#endif//defined(ASDX_IO_URING_SUPPORTED)
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+#if defined(ASDX_IO_URING_SUPPORTED)
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IoService::Uring structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  io_uring のリングです. liburing を使わずにシステムコールを直接呼び出します.
+struct IoService::Uring
+{
+    int             Fd;             //!< リングのファイルディスクリプタです.
+    uint32_t        Entries;        //!< 投入キューの容量です.
+    uint32_t        Unsubmitted;    //!< 未投入の要素数です.
+    void*           pSqPtr;         //!< 投入キューのマッピングです.
+    size_t          SqSize;         //!< 投入キューのマッピングサイズです.
+    void*           pCqPtr;         //!< 完了キューのマッピングです.
+    size_t          CqSize;         //!< 完了キューのマッピングサイズです.
+    io_uring_sqe*   pSqes;          //!< 投入要素です.
+    size_t          SqesSize;       //!< 投入要素のマッピングサイズです.
+    uint32_t*       pSqHead;        //!< 投入キューの先頭です.
+    uint32_t*       pSqTail;        //!< 投入キューの末尾です.
+    uint32_t*       pSqMask;        //!< 投入キューのマスクです.
+    uint32_t*       pSqArray;       //!< 投入キューの配列です.
+    uint32_t*       pCqHead;        //!< 完了キューの先頭です.
+    uint32_t*       pCqTail;        //!< 完了キューの末尾です.
+    uint32_t*       pCqMask;        //!< 完了キューのマスクです.
+    io_uring_cqe*   pCqes;          //!< 完了要素です.
+
+    //---------------------------------------------------------------------------------------------
+    //      リングを生成します.
+    //---------------------------------------------------------------------------------------------
+    bool Init( uint32_t entries )
+    {
+        io_uring_params params = {};
+        Fd = int( syscall( __NR_io_uring_setup, entries, &params ) );
+        if ( Fd < 0 )
+        { return false; }
+
+        Entries     = params.sq_entries;
+        Unsubmitted = 0;
+        SqSize      = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        CqSize      = params.cq_off.cqes  + params.cq_entries * sizeof(io_uring_cqe);
+        SqesSize    = params.sq_entries * sizeof(io_uring_sqe);
+
+        auto singleMap = ( params.features & IORING_FEAT_SINGLE_MMAP ) != 0;
+        if ( singleMap )
+        { SqSize = CqSize = (std::max)( SqSize, CqSize ); }
+
+        pSqPtr = mmap( nullptr, SqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, Fd, IORING_OFF_SQ_RING );
+        pCqPtr = ( singleMap ) ? pSqPtr : mmap( nullptr, CqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, Fd, IORING_OFF_CQ_RING );
+        pSqes  = static_cast<io_uring_sqe*>( mmap( nullptr, SqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, Fd, IORING_OFF_SQES ) );
+
+        if ( pSqPtr == MAP_FAILED || pCqPtr == MAP_FAILED || pSqes == MAP_FAILED )
+        {
+            Term();
+            return false;
+        }
+
+        auto pSq = static_cast<uint8_t*>( pSqPtr );
+        auto pCq = static_cast<uint8_t*>( pCqPtr );
+        pSqHead  = reinterpret_cast<uint32_t*>( pSq + params.sq_off.head );
+        pSqTail  = reinterpret_cast<uint32_t*>( pSq + params.sq_off.tail );
+        pSqMask  = reinterpret_cast<uint32_t*>( pSq + params.sq_off.ring_mask );
+        pSqArray = reinterpret_cast<uint32_t*>( pSq + params.sq_off.array );
+        pCqHead  = reinterpret_cast<uint32_t*>( pCq + params.cq_off.head );
+        pCqTail  = reinterpret_cast<uint32_t*>( pCq + params.cq_off.tail );
+        pCqMask  = reinterpret_cast<uint32_t*>( pCq + params.cq_off.ring_mask );
+        pCqes    = reinterpret_cast<io_uring_cqe*>( pCq + params.cq_off.cqes );
+
+        // コンテナ等で制限されている場合に備えて, NOP が完了することを確認します.
+        auto pSqe = GetSqe();
+        pSqe->opcode = IORING_OP_NOP;
+        if ( Enter( 1 ) < 0 )
+        {
+            Term();
+            return false;
+        }
+
+        io_uring_cqe cqe;
+        if ( !PeekCqe( cqe ) || cqe.res < 0 )
+        {
+            Term();
+            return false;
+        }
+
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //      リングを破棄します.
+    //---------------------------------------------------------------------------------------------
+    void Term()
+    {
+        if ( pSqes != nullptr && pSqes != MAP_FAILED )
+        { munmap( pSqes, SqesSize ); }
+        if ( pCqPtr != nullptr && pCqPtr != MAP_FAILED && pCqPtr != pSqPtr )
+        { munmap( pCqPtr, CqSize ); }
+        if ( pSqPtr != nullptr && pSqPtr != MAP_FAILED )
+        { munmap( pSqPtr, SqSize ); }
+        if ( Fd >= 0 )
+        { close( Fd ); }
+
+        pSqes  = nullptr;
+        pCqPtr = nullptr;
+        pSqPtr = nullptr;
+        Fd     = -1;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //      投入要素を取得します. 呼び出し側で空きがあることを保証します.
+    //---------------------------------------------------------------------------------------------
+    io_uring_sqe* GetSqe()
+    {
+        auto tail = *pSqTail;
+        auto head = __atomic_load_n( pSqHead, __ATOMIC_ACQUIRE );
+        if ( tail - head >= Entries )
+        { return nullptr; }
+
+        auto index = tail & *pSqMask;
+        auto pSqe  = &pSqes[index];
+        memset( pSqe, 0, sizeof(io_uring_sqe) );
+
+        pSqArray[index] = index;
+        __atomic_store_n( pSqTail, tail + 1, __ATOMIC_RELEASE );
+        Unsubmitted++;
+        return pSqe;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //      未投入の要素を投入し, 指定数の完了を待機します.
+    //---------------------------------------------------------------------------------------------
+    int Enter( uint32_t minComplete )
+    {
+        for( ;; )
+        {
+            auto flags = ( minComplete > 0 ) ? IORING_ENTER_GETEVENTS : 0u;
+            auto ret   = int( syscall( __NR_io_uring_enter, Fd, Unsubmitted, minComplete, flags, nullptr, 0 ) );
+            if ( ret >= 0 )
+            {
+                Unsubmitted -= (std::min)( Unsubmitted, uint32_t( ret ) );
+                return ret;
+            }
+
+            if ( errno != EINTR && errno != EAGAIN && errno != EBUSY )
+            { return -errno; }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //      完了要素を取り出します.
+    //---------------------------------------------------------------------------------------------
+    bool PeekCqe( io_uring_cqe& result )
+    {
+        auto head = *pCqHead;
+        auto tail = __atomic_load_n( pCqTail, __ATOMIC_ACQUIRE );
+        if ( head == tail )
+        { return false; }
+
+        result = pCqes[ head & *pCqMask ];
+        __atomic_store_n( pCqHead, head + 1, __ATOMIC_RELEASE );
+        return true;
+    }
+};
+#else
+struct IoService::Uring
+{ /* NOT SUPPORTED */ };
+#endif//defined(ASDX_IO_URING_SUPPORTED)
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IoService class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+IoService::IoService()
+: m_pUring      ( nullptr )
+, m_Quit        ( false )
+, m_Init        ( false )
+, m_RequestCount( 0 )
+, m_ReadCount   ( 0 )
+, m_OpenCount   ( 0 )
+, m_ReadBytes   ( 0 )
+, m_RetryCount  ( 0 )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+IoService::~IoService()
+{ Term(); }
+
+//-------------------------------------------------------------------------------------------------
+//      シングルトンインスタンスを取得します.
+//-------------------------------------------------------------------------------------------------
+IoService& IoService::GetInstance()
+{
+    static IoService s_Instance;
+    return s_Instance;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      初期化処理を行います.
+//-------------------------------------------------------------------------------------------------
+bool IoService::Init( const IoServiceDesc& desc )
+{
+    {
+        std::lock_guard<std::mutex> locker( m_Lock );
+        if ( m_Init )
+        { return true; }
+    }
+
+    m_Desc = desc;
+    if ( m_Desc.ThreadCount == 0 )
+    { m_Desc.ThreadCount = 1; }
+    if ( m_Desc.QueueDepth == 0 )
+    { m_Desc.QueueDepth = 1; }
+
+#if defined(ASDX_IO_URING_SUPPORTED)
+    if ( m_Desc.EnableUring )
+    {
+        auto pUring = new Uring();
+        memset( pUring, 0, sizeof(Uring) );
+        pUring->Fd = -1;
+
+        if ( pUring->Init( m_Desc.QueueDepth ) )
+        { m_pUring = pUring; }
+        else
+        {
+            ILOGA( "Info : io_uring is not available. Fallback to thread pool." );
+            delete pUring;
+        }
+    }
+#endif//defined(ASDX_IO_URING_SUPPORTED)
+
+    m_Quit = false;
+    m_Init = true;
+
+    try
+    {
+        if ( m_pUring != nullptr )
+        { m_Threads.emplace_back( &IoService::UringMain, this ); }
+        else
+        {
+            for( auto i=0u; i<m_Desc.ThreadCount; ++i )
+            { m_Threads.emplace_back( &IoService::WorkerMain, this ); }
+        }
+    }
+    catch( std::system_error& e )
+    {
+        ELOGA( "Error : Thread Create Failed. msg = %s", e.what() );
+        Term();
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      終了処理を行います.
+//-------------------------------------------------------------------------------------------------
+void IoService::Term()
+{
+    {
+        std::lock_guard<std::mutex> locker( m_Lock );
+        if ( !m_Init )
+        { return; }
+
+        // 以降の投入はその場で実行します. スレッドはキューが空になってから終了します.
+        m_Init = false;
+        m_Quit = true;
+    }
+    m_Cond.notify_all();
+
+    for( auto& thread : m_Threads )
+    {
+        if ( thread.joinable() )
+        { thread.join(); }
+    }
+    m_Threads.clear();
+
+#if defined(ASDX_IO_URING_SUPPORTED)
+    if ( m_pUring != nullptr )
+    {
+        m_pUring->Term();
+        delete m_pUring;
+        m_pUring = nullptr;
+    }
+#endif//defined(ASDX_IO_URING_SUPPORTED)
+
+    m_Quit = false;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      読み込み要求をまとめて投入します.
+//-------------------------------------------------------------------------------------------------
+bool IoService::Submit( IoRequest* pRequests, uint32_t count, IoBatch* pBatch )
+{
+    if ( pRequests == nullptr || count == 0 || pBatch == nullptr )
+    {
+        ELOGA( "Error : Invalid Argument." );
+        return false;
+    }
+
+    std::vector<IoRequest*> sorted;
+    sorted.reserve( count );
+    for( auto i=0u; i<count; ++i )
+    {
+        if ( pRequests[i].Path == nullptr || ( pRequests[i].pDst == nullptr && pRequests[i].Size > 0 ) )
+        {
+            ELOGA( "Error : Invalid Request. index = %u", i );
+            return false;
+        }
+
+        pRequests[i].ReadSize = 0;
+        sorted.push_back( &pRequests[i] );
+    }
+
+    // ファイルごとにまとめ, オフセット順に並べます.
+    std::sort( sorted.begin(), sorted.end(), []( const IoRequest* a, const IoRequest* b )
+    {
+        auto cmp = strcmp( a->Path, b->Path );
+        return ( cmp != 0 ) ? ( cmp < 0 ) : ( a->Offset < b->Offset );
+    });
+
+    std::vector<IoFileTask*> tasks;
+    for( auto first=0u; first<count; )
+    {
+        auto last = first + 1;
+        while( last < count && strcmp( sorted[first]->Path, sorted[last]->Path ) == 0 )
+        { last++; }
+
+        auto pTask = new IoFileTask();
+        pTask->Path     = sorted[first]->Path;
+        pTask->Requests.assign( sorted.begin() + first, sorted.begin() + last );
+        pTask->pBatch   = pBatch;
+        pTask->File     = kInvalidFile;
+        pTask->Next     = 0;
+        pTask->Remain   = 0;
+        BuildSpans( pTask, m_Desc.MergeGap, m_Desc.MaxMergeSize );
+        tasks.push_back( pTask );
+
+        first = last;
+    }
+
+    m_RequestCount.fetch_add( count, std::memory_order_relaxed );
+    pBatch->m_ErrorCount.store( 0, std::memory_order_relaxed );
+    pBatch->m_Count.fetch_add( uint32_t( tasks.size() ), std::memory_order_release );
+
+    {
+        std::unique_lock<std::mutex> locker( m_Lock );
+        if ( m_Init )
+        {
+            for( auto pTask : tasks )
+            { m_Queue.push_back( pTask ); }
+
+            locker.unlock();
+            m_Cond.notify_all();
+            return true;
+        }
+    }
+
+    // 未初期化の場合はその場で読み込みます.
+    for( auto pTask : tasks )
+    { ExecuteTask( pTask ); }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      全ての要求が完了するまで待機します.
+//-------------------------------------------------------------------------------------------------
+void IoService::Wait( IoBatch* pBatch )
+{
+    if ( pBatch == nullptr )
+    { return; }
+
+    std::unique_lock<std::mutex> locker( m_DoneLock );
+    m_DoneCond.wait( locker, [pBatch]() { return pBatch->IsDone(); } );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      io_uring を使用しているかどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool IoService::IsUringEnabled() const
+{ return m_pUring != nullptr; }
+
+//-------------------------------------------------------------------------------------------------
+//      統計情報を取得します.
+//-------------------------------------------------------------------------------------------------
+IoStats IoService::GetStats() const
+{
+    IoStats result;
+    result.RequestCount = m_RequestCount.load( std::memory_order_relaxed );
+    result.ReadCount    = m_ReadCount   .load( std::memory_order_relaxed );
+    result.OpenCount    = m_OpenCount   .load( std::memory_order_relaxed );
+    result.ReadBytes    = m_ReadBytes   .load( std::memory_order_relaxed );
+    result.RetryCount   = m_RetryCount  .load( std::memory_order_relaxed );
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      スレッドプールのワーカーのメイン処理です.
+//-------------------------------------------------------------------------------------------------
+void IoService::WorkerMain()
+{
+    while( auto pTask = PopTask( true ) )
+    { ExecuteTask( pTask ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      io_uring のメイン処理です.
+//-------------------------------------------------------------------------------------------------
+void IoService::UringMain()
+{
+#if defined(ASDX_IO_URING_SUPPORTED)
+    std::deque<IoFileTask*> active;     // 発行していない読み込みが残っているタスクです.
+    auto inflight = 0u;
+
+    for( ;; )
+    {
+        // 新しいタスクを受け取り, ファイルを開きます.
+        while( active.size() < m_pUring->Entries )
+        {
+            auto pTask = PopTask( inflight == 0 && active.empty() );
+            if ( pTask == nullptr )
+            { break; }
+
+            pTask->File = OpenFile( pTask->Path.c_str() );
+            m_OpenCount.fetch_add( 1, std::memory_order_relaxed );
+
+            if ( pTask->File == kInvalidFile )
+            {
+                WLOGA( "Warning : File Open Failed. path = %s", pTask->Path.c_str() );
+                CompleteTask( pTask );
+                continue;
+            }
+
+            pTask->Remain = uint32_t( pTask->Spans.size() );
+            active.push_back( pTask );
+        }
+
+        if ( inflight == 0 && active.empty() )
+        {
+            std::lock_guard<std::mutex> locker( m_Lock );
+            if ( m_Quit && m_Queue.empty() )
+            { break; }
+            continue;
+        }
+
+        // 空きがある分だけ読み込みを発行します.
+        while( inflight < m_pUring->Entries && !active.empty() )
+        {
+            auto pTask = active.front();
+            auto& span = pTask->Spans[pTask->Next++];
+
+            auto pSqe = m_pUring->GetSqe();
+            assert( pSqe != nullptr );
+            pSqe->opcode    = IORING_OP_READV;
+            pSqe->fd        = int( pTask->File );
+            pSqe->addr      = uint64_t( uintptr_t( &span.Vec ) );
+            pSqe->len       = 1;
+            pSqe->off       = span.Offset;
+            pSqe->user_data = uint64_t( uintptr_t( &span ) );
+
+            m_ReadCount.fetch_add( 1, std::memory_order_relaxed );
+            inflight++;
+
+            if ( pTask->Next == pTask->Spans.size() )
+            { active.pop_front(); }
+        }
+
+        auto ret = m_pUring->Enter( 1 );
+        if ( ret < 0 )
+        {
+            ELOGA( "Error : io_uring_enter() Failed. errcode = %d", -ret );
+            std::this_thread::yield();
+            continue;
+        }
+
+        io_uring_cqe cqe;
+        while( m_pUring->PeekCqe( cqe ) )
+        {
+            auto& span = *reinterpret_cast<IoSpan*>( uintptr_t( cqe.user_data ) );
+
+            if ( cqe.res > 0 )
+            {
+                span.ReadSize += uint32_t( cqe.res );
+                m_ReadBytes.fetch_add( uint32_t( cqe.res ), std::memory_order_relaxed );
+
+                // 読み込みが足りない場合は残りを再発行します.
+                if ( span.ReadSize < span.Size )
+                {
+                    span.Vec.iov_base = static_cast<uint8_t*>( span.Vec.iov_base ) + cqe.res;
+                    span.Vec.iov_len  = span.Size - span.ReadSize;
+
+                    auto pSqe = m_pUring->GetSqe();
+                    assert( pSqe != nullptr );
+                    pSqe->opcode    = IORING_OP_READV;
+                    pSqe->fd        = int( span.pTask->File );
+                    pSqe->addr      = uint64_t( uintptr_t( &span.Vec ) );
+                    pSqe->len       = 1;
+                    pSqe->off       = span.Offset + span.ReadSize;
+                    pSqe->user_data = cqe.user_data;
+
+                    m_RetryCount.fetch_add( 1, std::memory_order_relaxed );
+                    continue;
+                }
+            }
+
+            inflight--;
+
+            auto pTask = span.pTask;
+            FinishSpan( span );
+
+            if ( --pTask->Remain == 0 )
+            { CompleteTask( pTask ); }
+        }
+    }
+#endif//defined(ASDX_IO_URING_SUPPORTED)
+}
+
+//-------------------------------------------------------------------------------------------------
+//      キューからタスクを取り出します.
+//-------------------------------------------------------------------------------------------------
+IoFileTask* IoService::PopTask( bool wait )
+{
+    std::unique_lock<std::mutex> locker( m_Lock );
+    if ( wait )
+    { m_Cond.wait( locker, [this]() { return !m_Queue.empty() || m_Quit; } ); }
+
+    if ( m_Queue.empty() )
+    { return nullptr; }
+
+    auto pTask = m_Queue.front();
+    m_Queue.pop_front();
+    return pTask;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      タスクを呼び出しスレッドで実行します.
+//-------------------------------------------------------------------------------------------------
+void IoService::ExecuteTask( IoFileTask* pTask )
+{
+    pTask->File = OpenFile( pTask->Path.c_str() );
+    m_OpenCount.fetch_add( 1, std::memory_order_relaxed );
+
+    if ( pTask->File == kInvalidFile )
+    {
+        WLOGA( "Warning : File Open Failed. path = %s", pTask->Path.c_str() );
+        CompleteTask( pTask );
+        return;
+    }
+
+    for( auto& span : pTask->Spans )
+    {
+        auto pDst = ( span.pStaging != nullptr ) ? span.pStaging : pTask->Requests[span.First]->pDst;
+        auto retryCount = 0u;
+        span.ReadSize = ReadAt( pTask->File, span.Offset, pDst, span.Size, retryCount );
+
+        m_ReadCount.fetch_add( 1, std::memory_order_relaxed );
+        m_ReadBytes.fetch_add( span.ReadSize, std::memory_order_relaxed );
+        m_RetryCount.fetch_add( retryCount, std::memory_order_relaxed );
+
+        FinishSpan( span );
+    }
+
+    CompleteTask( pTask );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      タスクを完了させます.
+//-------------------------------------------------------------------------------------------------
+void IoService::CompleteTask( IoFileTask* pTask )
+{
+    CloseFile( pTask->File );
+
+    // ファイルを開けなかった場合などは一時バッファが残っています.
+    for( auto& span : pTask->Spans )
+    { SafeFreeAssetMemory( span.pStaging ); }
+
+    auto errorCount = 0u;
+    for( auto pRequest : pTask->Requests )
+    {
+        if ( pRequest->ReadSize != pRequest->Size )
+        { errorCount++; }
+    }
+
+    auto pBatch = pTask->pBatch;
+    delete pTask;
+
+    if ( errorCount > 0 )
+    { pBatch->m_ErrorCount.fetch_add( errorCount, std::memory_order_relaxed ); }
+
+    // カウンターを減らした後はバッチが破棄されている可能性があるため, 参照しません.
+    pBatch->m_Count.fetch_sub( 1, std::memory_order_acq_rel );
+
+    {
+        std::lock_guard<std::mutex> locker( m_DoneLock );
+    }
+    m_DoneCond.notify_all();
+}
+
+} // namespace asdx
@@ -0,0 +1,507 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxJobSystem.cpp
+// Desc : Work Stealing Job System.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxJobSystem.h>
+#include <asdxPoolAllocator.h>
+#include <asdxLogger.h>
+#include <cassert>
+#include <exception>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const uint32_t   kSpinCount       = 64;      // 待機に入るまでにジョブを探す回数です.
+static const uint32_t   kTasksPerThread  = 8;       // 自動分割で1スレッドあたりに割り当てる目安のジョブ数です.
+
+//-------------------------------------------------------------------------------------------------
+// Thread Local Variables.
+//-------------------------------------------------------------------------------------------------
+thread_local int32_t            t_WorkerIndex    = -1;         // ワーカーのデック番号です.
+thread_local asdx::JobCounter*  t_pCurrentCounter = nullptr;   // 実行中のジョブのカウンターです.
+
+//-------------------------------------------------------------------------------------------------
+//      乱数を生成します.
+//-------------------------------------------------------------------------------------------------
+inline uint32_t NextRandom( uint32_t& state )
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Job structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct Job : public PoolObject
+{
+    void        (*pInvoke)( void* );                        //!< 関数オブジェクトの呼び出し関数です.
+    JobCounter* pCounter;                                   //!< 完了を通知するカウンターです.
+    alignas(16) uint8_t Data[JobSystem::kJobDataSize];      //!< 関数オブジェクトの格納先です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// JobSystem::WorkDeque class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+JobSystem::WorkDeque::WorkDeque()
+: m_Top     ( 0 )
+, m_Bottom  ( 0 )
+{
+    for( auto i=0u; i<kDequeSize; ++i )
+    { m_Jobs[i].store( nullptr, std::memory_order_relaxed ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      所有スレッドが末尾にジョブを追加します.
+//-------------------------------------------------------------------------------------------------
+bool JobSystem::WorkDeque::Push( Job* pJob )
+{
+    auto b = m_Bottom.load( std::memory_order_relaxed );
+    auto t = m_Top   .load( std::memory_order_acquire );
+
+    if ( b - t >= int64_t( kDequeSize ) )
+    { return false; }
+
+    m_Jobs[ b & ( kDequeSize - 1 ) ].store( pJob, std::memory_order_relaxed );
+    m_Bottom.store( b + 1, std::memory_order_release );
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      所有スレッドが末尾からジョブを取り出します.
+//-------------------------------------------------------------------------------------------------
+Job* JobSystem::WorkDeque::Pop()
+{
+    auto b = m_Bottom.load( std::memory_order_relaxed ) - 1;
+    m_Bottom.store( b, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    auto t = m_Top.load( std::memory_order_relaxed );
+
+    if ( t > b )
+    {
+        // 空でした.
+        m_Bottom.store( b + 1, std::memory_order_relaxed );
+        return nullptr;
+    }
+
+    auto pJob = m_Jobs[ b & ( kDequeSize - 1 ) ].load( std::memory_order_relaxed );
+    if ( t == b )
+    {
+        // 最後の1つは Steal() と競合するため CAS で取り合います.
+        if ( !m_Top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+        { pJob = nullptr; }
+
+        m_Bottom.store( b + 1, std::memory_order_relaxed );
+    }
+
+    return pJob;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      他スレッドが先頭からジョブを盗みます.
+//-------------------------------------------------------------------------------------------------
+Job* JobSystem::WorkDeque::Steal()
+{
+    auto t = m_Top.load( std::memory_order_acquire );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    auto b = m_Bottom.load( std::memory_order_acquire );
+
+    if ( t >= b )
+    { return nullptr; }
+
+    auto pJob = m_Jobs[ t & ( kDequeSize - 1 ) ].load( std::memory_order_relaxed );
+    if ( !m_Top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+    { return nullptr; }
+
+    return pJob;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// JobSystem class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+const size_t   JobSystem::kJobDataSize;
+const uint32_t JobSystem::kDequeSize;
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+JobSystem::JobSystem()
+: m_PendingCount( 0 )
+, m_SleepCount  ( 0 )
+, m_Quit        ( false )
+, m_Init        ( false )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+JobSystem::~JobSystem()
+{ Term(); }
+
+//-------------------------------------------------------------------------------------------------
+//      シングルトンインスタンスを取得します.
+//-------------------------------------------------------------------------------------------------
+JobSystem& JobSystem::GetInstance()
+{
+    static JobSystem s_Instance;
+    return s_Instance;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      初期化処理を行います.
+//-------------------------------------------------------------------------------------------------
+bool JobSystem::Init( uint32_t workerCount )
+{
+    if ( m_Init.load( std::memory_order_acquire ) )
+    { return true; }
+
+    if ( workerCount == 0 )
+    {
+        auto count = std::thread::hardware_concurrency();
+        workerCount = ( count > 1 ) ? count - 1 : 1;
+    }
+
+    m_MainThreadId = std::this_thread::get_id();
+    m_Quit.store( false, std::memory_order_relaxed );
+    m_PendingCount.store( 0, std::memory_order_relaxed );
+    m_SleepCount  .store( 0, std::memory_order_relaxed );
+
+    // デック 0 はメインスレッド用です.
+    m_Deques.resize( workerCount + 1 );
+    for( auto& pDeque : m_Deques )
+    { pDeque = new WorkDeque(); }
+
+    m_Init.store( true, std::memory_order_release );
+
+    try
+    {
+        m_Threads.reserve( workerCount );
+        for( auto i=1u; i<=workerCount; ++i )
+        { m_Threads.emplace_back( &JobSystem::WorkerMain, this, i ); }
+    }
+    catch( std::system_error& e )
+    {
+        ELOGA( "Error : Thread Create Failed. msg = %s", e.what() );
+        Term();
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      終了処理を行います.
+//-------------------------------------------------------------------------------------------------
+void JobSystem::Term()
+{
+    if ( !m_Init.load( std::memory_order_acquire ) )
+    { return; }
+
+    {
+        std::lock_guard<std::mutex> locker( m_SleepLock );
+        m_Quit.store( true, std::memory_order_seq_cst );
+    }
+    m_SleepCond.notify_all();
+
+    for( auto& thread : m_Threads )
+    {
+        if ( thread.joinable() )
+        { thread.join(); }
+    }
+    m_Threads.clear();
+
+    // 以降の投入はその場で実行されるようにしてから, 残ったジョブを実行します.
+    m_Init.store( false, std::memory_order_release );
+
+    for( auto pDeque : m_Deques )
+    {
+        while( auto pJob = pDeque->Steal() )
+        { Execute( pJob ); }
+    }
+
+    while( auto pJob = PopQueue() )
+    { Execute( pJob ); }
+
+    for( auto& pDeque : m_Deques )
+    { delete pDeque; }
+    m_Deques.clear();
+
+    m_PendingCount.store( 0, std::memory_order_relaxed );
+    m_Quit.store( false, std::memory_order_relaxed );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      初期化済みかどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool JobSystem::IsInit() const
+{ return m_Init.load( std::memory_order_acquire ); }
+
+//-------------------------------------------------------------------------------------------------
+//      ワーカースレッド数を取得します.
+//-------------------------------------------------------------------------------------------------
+uint32_t JobSystem::GetWorkerCount() const
+{ return uint32_t( m_Threads.size() ); }
+
+//-------------------------------------------------------------------------------------------------
+//      カウンターが 0 になるまでジョブを実行しながら待機します.
+//-------------------------------------------------------------------------------------------------
+void JobSystem::Wait( const JobCounter* pCounter )
+{
+    if ( pCounter == nullptr )
+    { return; }
+
+    auto index = GetThreadIndex();
+    auto seed  = uint32_t( reinterpret_cast<uintptr_t>( pCounter ) ) | 1u;
+
+    while( !pCounter->IsDone() )
+    {
+        auto pJob = FindJob( index, seed );
+        if ( pJob != nullptr )
+        { Execute( pJob ); }
+        else
+        { std::this_thread::yield(); }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ジョブを生成します.
+//-------------------------------------------------------------------------------------------------
+Job* JobSystem::AllocJob( JobCounter* pCounter )
+{
+    auto pJob = new Job();
+    pJob->pInvoke  = nullptr;
+    pJob->pCounter = pCounter;
+
+    if ( pCounter != nullptr )
+    { pCounter->m_Count.fetch_add( 1, std::memory_order_relaxed ); }
+
+    return pJob;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      関数オブジェクトの格納先を取得します.
+//-------------------------------------------------------------------------------------------------
+void* JobSystem::GetJobData( Job* pJob )
+{ return pJob->Data; }
+
+//-------------------------------------------------------------------------------------------------
+//      ジョブを投入します.
+//-------------------------------------------------------------------------------------------------
+void JobSystem::Submit( Job* pJob, void (*pInvoke)( void* ) )
+{
+    pJob->pInvoke = pInvoke;
+
+    if ( !m_Init.load( std::memory_order_acquire ) )
+    {
+        Execute( pJob );
+        return;
+    }
+
+    m_PendingCount.fetch_add( 1, std::memory_order_seq_cst );
+
+    auto index = GetThreadIndex();
+    if ( index >= 0 )
+    {
+        if ( !m_Deques[index]->Push( pJob ) )
+        {
+            // デックが一杯の場合はその場で実行します.
+            m_PendingCount.fetch_sub( 1, std::memory_order_relaxed );
+            Execute( pJob );
+            return;
+        }
+    }
+    else
+    {
+        std::lock_guard<std::mutex> locker( m_QueueLock );
+        m_Queue.push_back( pJob );
+    }
+
+    if ( m_SleepCount.load( std::memory_order_seq_cst ) > 0 )
+    {
+        std::lock_guard<std::mutex> locker( m_SleepLock );
+        m_SleepCond.notify_one();
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ジョブを実行します.
+//-------------------------------------------------------------------------------------------------
+void JobSystem::Execute( Job* pJob )
+{
+    auto pPrev = t_pCurrentCounter;
+    t_pCurrentCounter = pJob->pCounter;
+
+    // 例外をワーカーまで伝播させるとカウンターが減算されず Wait() が終わらないため, ここで捕捉します.
+    std::exception_ptr error;
+    try
+    {
+        pJob->pInvoke( pJob->Data );
+    }
+    catch( std::exception& e )
+    {
+        ELOGA( "Error : Job Threw Exception. msg = %s", e.what() );
+        error = std::current_exception();
+    }
+    catch( ... )
+    {
+        ELOGA( "Error : Job Threw Unknown Exception." );
+        error = std::current_exception();
+    }
+
+    t_pCurrentCounter = pPrev;
+
+    // 子ジョブは実行中に加算済みなので, ここで 0 になれば子ジョブも完了しています.
+    auto pCounter = pJob->pCounter;
+    delete pJob;
+
+    if ( pCounter != nullptr )
+    {
+        // 最初の例外だけを保持します. 書き込みはカウンターの減算で待機側に公開されます.
+        if ( error && pCounter->m_ErrorCount.fetch_add( 1, std::memory_order_relaxed ) == 0 )
+        { pCounter->m_Error = error; }
+
+        pCounter->m_Count.fetch_sub( 1, std::memory_order_acq_rel );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      実行するジョブを探します.
+//-------------------------------------------------------------------------------------------------
+Job* JobSystem::FindJob( int32_t index, uint32_t& seed )
+{
+    Job* pJob = nullptr;
+
+    // 自身のデック, 共有キュー, 他スレッドのデックの順に探します.
+    if ( index >= 0 )
+    { pJob = m_Deques[index]->Pop(); }
+
+    if ( pJob == nullptr )
+    { pJob = PopQueue(); }
+
+    if ( pJob == nullptr )
+    {
+        auto count = uint32_t( m_Deques.size() );
+        auto start = NextRandom( seed ) % count;
+        for( auto i=0u; i<count && pJob == nullptr; ++i )
+        {
+            auto victim = ( start + i ) % count;
+            if ( int32_t( victim ) != index )
+            { pJob = m_Deques[victim]->Steal(); }
+        }
+    }
+
+    if ( pJob != nullptr )
+    { m_PendingCount.fetch_sub( 1, std::memory_order_relaxed ); }
+
+    return pJob;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      共有キューからジョブを取り出します.
+//-------------------------------------------------------------------------------------------------
+Job* JobSystem::PopQueue()
+{
+    std::lock_guard<std::mutex> locker( m_QueueLock );
+    if ( m_Queue.empty() )
+    { return nullptr; }
+
+    auto pJob = m_Queue.front();
+    m_Queue.pop_front();
+    return pJob;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ワーカースレッドのメイン処理です.
+//-------------------------------------------------------------------------------------------------
+void JobSystem::WorkerMain( uint32_t index )
+{
+    t_WorkerIndex = int32_t( index );
+
+    auto seed = index * 0x9e3779b9u + 1u;
+    auto spin = 0u;
+
+    for( ;; )
+    {
+        auto pJob = FindJob( int32_t( index ), seed );
+        if ( pJob != nullptr )
+        {
+            Execute( pJob );
+            spin = 0;
+            continue;
+        }
+
+        if ( m_Quit.load( std::memory_order_acquire ) )
+        { break; }
+
+        if ( ++spin < kSpinCount )
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // 投入側は m_PendingCount を加算してから m_SleepCount を確認するため, 通知を取りこぼしません.
+        std::unique_lock<std::mutex> locker( m_SleepLock );
+        m_SleepCount.fetch_add( 1, std::memory_order_seq_cst );
+        m_SleepCond.wait( locker, [this]()
+        {
+            return m_PendingCount.load( std::memory_order_seq_cst ) > 0
+                || m_Quit.load( std::memory_order_relaxed );
+        });
+        m_SleepCount.fetch_sub( 1, std::memory_order_relaxed );
+        spin = 0;
+    }
+
+    t_WorkerIndex = -1;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      呼び出しスレッドのデック番号を取得します.
+//-------------------------------------------------------------------------------------------------
+int32_t JobSystem::GetThreadIndex() const
+{
+    if ( t_WorkerIndex >= 0 )
+    { return t_WorkerIndex; }
+
+    if ( std::this_thread::get_id() == m_MainThreadId )
+    { return 0; }
+
+    return -1;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      実行中のジョブのカウンターを取得します.
+//-------------------------------------------------------------------------------------------------
+JobCounter* JobSystem::GetCurrentCounter() const
+{ return t_pCurrentCounter; }
+
+//-------------------------------------------------------------------------------------------------
+//      自動分割の要素数を求めます.
+//-------------------------------------------------------------------------------------------------
+uint32_t JobSystem::GetAutoGrainSize( uint32_t count ) const
+{
+    auto threadCount = GetWorkerCount() + 1;
+    auto grainSize   = count / ( threadCount * kTasksPerThread );
+    return ( grainSize > 0 ) ? grainSize : 1;
+}
+
+} // namespace asdx
@@ -0,0 +1,821 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxLogFormat.cpp
+// Desc : Deferred Log Formatting.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxLogFormat.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cwchar>
+
+#if defined(_WIN32)
+    #include <Windows.h>
+#endif//defined(_WIN32)
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const uint32_t   kScalarArgSize      = 1 + sizeof(uint64_t);             // 数値 1 つのパック後のサイズです.
+static const uint32_t   kStringHeaderSize   = 1 + sizeof(uint16_t) + 1;         // 文字列の種類, 長さ, 終端文字のサイズです.
+static const uint32_t   kStringReserveSize  = kStringHeaderSize + 32;           // 後続の文字列 1 つに残すサイズです.
+static const char       kTruncatedMark[]    = "...";                            // 切り詰めた文字列の末尾に付けます.
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LENGTH_TYPE enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum LENGTH_TYPE
+{
+    LENGTH_NONE = 0,
+    LENGTH_HH,          // hh
+    LENGTH_H,           // h
+    LENGTH_L,           // l
+    LENGTH_LL,          // ll
+    LENGTH_J,           // j
+    LENGTH_Z,           // z, I
+    LENGTH_T,           // t
+    LENGTH_LONG_DOUBLE, // L
+    LENGTH_I64,         // I64
+    LENGTH_I32,         // I32
+    LENGTH_W,           // w
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// CONVERSION_TYPE enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum CONVERSION_TYPE
+{
+    CONVERSION_UNKNOWN = 0,
+    CONVERSION_SIGNED,
+    CONVERSION_UNSIGNED,
+    CONVERSION_CHAR,
+    CONVERSION_STRING,
+    CONVERSION_DOUBLE,
+    CONVERSION_POINTER,
+    CONVERSION_COUNT,
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FormatSpec structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct FormatSpec
+{
+    char        Flags[8];           //!< フラグです.
+    int         Width;              //!< 最小幅です. 指定がない場合は -1 です.
+    int         Precision;          //!< 精度です. 指定がない場合は -1 です.
+    bool        WidthStar;          //!< 最小幅を引数で指定するかどうか.
+    bool        PrecisionStar;      //!< 精度を引数で指定するかどうか.
+    uint32_t    Length;             //!< 長さ修飾子です.
+    uint32_t    Conversion;         //!< 変換指定子です. 書式の終端に達した場合は 0 です.
+};
+
+//-------------------------------------------------------------------------------------------------
+//      変換指定を解析します. p は '%' の次の文字を指します.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+const T* ParseSpec( const T* p, FormatSpec& spec )
+{
+    memset( spec.Flags, 0, sizeof(spec.Flags) );
+    spec.Width          = -1;
+    spec.Precision      = -1;
+    spec.WidthStar      = false;
+    spec.PrecisionStar  = false;
+    spec.Length         = LENGTH_NONE;
+    spec.Conversion     = 0;
+
+    // フラグ.
+    size_t count = 0;
+    while ( *p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0' || *p == '\'' )
+    {
+        if ( count + 1 < sizeof(spec.Flags) )
+        { spec.Flags[count++] = char( *p ); }
+        ++p;
+    }
+
+    // 最小幅.
+    if ( *p == '*' )
+    {
+        spec.WidthStar = true;
+        ++p;
+    }
+    else if ( '0' <= *p && *p <= '9' )
+    {
+        spec.Width = 0;
+        while ( '0' <= *p && *p <= '9' )
+        { spec.Width = spec.Width * 10 + int( *p++ - '0' ); }
+    }
+
+    // 精度.
+    if ( *p == '.' )
+    {
+        ++p;
+        spec.Precision = 0;
+        if ( *p == '*' )
+        {
+            spec.PrecisionStar = true;
+            ++p;
+        }
+        else
+        {
+            while ( '0' <= *p && *p <= '9' )
+            { spec.Precision = spec.Precision * 10 + int( *p++ - '0' ); }
+        }
+    }
+
+    // 長さ修飾子.
+    switch( *p )
+    {
+    case 'h':
+        ++p;
+        if ( *p == 'h' ) { spec.Length = LENGTH_HH; ++p; }
+        else             { spec.Length = LENGTH_H; }
+        break;
+
+    case 'l':
+        ++p;
+        if ( *p == 'l' ) { spec.Length = LENGTH_LL; ++p; }
+        else             { spec.Length = LENGTH_L; }
+        break;
+
+    case 'q': spec.Length = LENGTH_LL;          ++p; break;
+    case 'j': spec.Length = LENGTH_J;           ++p; break;
+    case 'z': spec.Length = LENGTH_Z;           ++p; break;
+    case 't': spec.Length = LENGTH_T;           ++p; break;
+    case 'L': spec.Length = LENGTH_LONG_DOUBLE; ++p; break;
+    case 'w': spec.Length = LENGTH_W;           ++p; break;
+
+    case 'I':
+        ++p;
+        if ( p[0] == '6' && p[1] == '4' )      { spec.Length = LENGTH_I64; p += 2; }
+        else if ( p[0] == '3' && p[1] == '2' ) { spec.Length = LENGTH_I32; p += 2; }
+        else                                   { spec.Length = LENGTH_Z; }
+        break;
+
+    default:
+        break;
+    }
+
+    if ( *p == 0 )
+    { return p; }
+
+    spec.Conversion = uint32_t( *p++ );
+    return p;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      変換指定子の種類を取得します.
+//-------------------------------------------------------------------------------------------------
+CONVERSION_TYPE GetConversionType( uint32_t conversion )
+{
+    switch( conversion )
+    {
+    case 'd': case 'i':
+        return CONVERSION_SIGNED;
+
+    case 'o': case 'u': case 'x': case 'X':
+        return CONVERSION_UNSIGNED;
+
+    case 'c': case 'C':
+        return CONVERSION_CHAR;
+
+    case 's': case 'S':
+        return CONVERSION_STRING;
+
+    case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+        return CONVERSION_DOUBLE;
+
+    case 'p':
+        return CONVERSION_POINTER;
+
+    case 'n':
+        return CONVERSION_COUNT;
+
+    default:
+        return CONVERSION_UNKNOWN;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      文字および文字列の引数がワイド文字かどうかを判定します.
+//-------------------------------------------------------------------------------------------------
+bool IsWideArg( bool wideFormat, const FormatSpec& spec )
+{
+    if ( spec.Length == LENGTH_L || spec.Length == LENGTH_W )
+    { return true; }
+
+    if ( spec.Length == LENGTH_H )
+    { return false; }
+
+    auto upper = ( spec.Conversion == 'C' || spec.Conversion == 'S' );
+
+#if defined(_WIN32)
+    // MSVC では %s, %c は書式と同じ文字幅, %S, %C は逆の文字幅になります.
+    return wideFormat != upper;
+#else
+    // C 標準では %S, %C は %ls, %lc と同じです.
+    (void)wideFormat;
+    return upper;
+#endif//defined(_WIN32)
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ArgWriter class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ArgWriter
+{
+public:
+    ArgWriter( uint8_t* pBuffer, uint32_t size )
+    : m_pBuffer ( pBuffer )
+    , m_Size    ( size )
+    , m_Offset  ( 0 )
+    { /* DO_NOTHING */ }
+
+    bool Write( uint8_t type, uint64_t bits )
+    {
+        if ( m_Offset + kScalarArgSize > m_Size )
+        { return false; }
+
+        m_pBuffer[m_Offset] = type;
+        memcpy( m_pBuffer + m_Offset + 1, &bits, sizeof(bits) );
+        m_Offset += 1 + sizeof(bits);
+        return true;
+    }
+
+    bool WriteString( const char* value, size_t length, uint32_t reserve )
+    {
+        if ( m_Offset + kStringHeaderSize > m_Size )
+        { return false; }
+
+        // 後続の引数が格納できるよう, reserve 分を残して切り詰めます.
+        auto rest = m_Size - m_Offset - kStringHeaderSize;
+        rest = ( rest > reserve ) ? rest - reserve : 0;
+
+        auto size = uint16_t( (std::min)( (std::min)( length, size_t( rest ) ), size_t( UINT16_MAX ) ) );
+        auto pDst = m_pBuffer + m_Offset + 1 + sizeof(size);
+
+        m_pBuffer[m_Offset] = asdx::LOG_ARG_STRING;
+        memcpy( m_pBuffer + m_Offset + 1, &size, sizeof(size) );
+        memcpy( pDst, value, size );
+        pDst[size] = 0;
+
+        // 切り詰めたことが分かるよう, 末尾を置き換えます.
+        const auto markLength = sizeof(kTruncatedMark) - 1;
+        if ( size < length && size >= markLength )
+        { memcpy( pDst + size - markLength, kTruncatedMark, markLength ); }
+
+        m_Offset += uint32_t( kStringHeaderSize + size );
+        return true;
+    }
+
+    uint32_t GetSize() const
+    { return m_Offset; }
+
+    uint32_t GetRest() const
+    { return m_Size - m_Offset; }
+
+private:
+    uint8_t*    m_pBuffer;
+    uint32_t    m_Size;
+    uint32_t    m_Offset;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ArgReader class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ArgReader
+{
+public:
+    ArgReader( const uint8_t* pArgs, uint32_t size )
+    : m_pArgs   ( pArgs )
+    , m_Size    ( size )
+    , m_Offset  ( 0 )
+    { /* DO_NOTHING */ }
+
+    uint8_t Peek() const
+    { return ( m_Offset < m_Size ) ? m_pArgs[m_Offset] : 0; }
+
+    bool Read( uint8_t type, uint64_t& bits )
+    {
+        if ( Peek() != type || m_Offset + 1 + sizeof(bits) > m_Size )
+        { return false; }
+
+        memcpy( &bits, m_pArgs + m_Offset + 1, sizeof(bits) );
+        m_Offset += 1 + sizeof(bits);
+        return true;
+    }
+
+    bool ReadString( const char*& value )
+    {
+        uint16_t size = 0;
+        if ( Peek() != asdx::LOG_ARG_STRING || m_Offset + 1 + sizeof(size) > m_Size )
+        { return false; }
+
+        memcpy( &size, m_pArgs + m_Offset + 1, sizeof(size) );
+        if ( m_Offset + 1 + sizeof(size) + size + 1 > m_Size )
+        { return false; }
+
+        value = reinterpret_cast<const char*>( m_pArgs + m_Offset + 1 + sizeof(size) );
+        if ( value[size] != 0 )
+        { return false; }
+
+        m_Offset += uint32_t( 1 + sizeof(size) + size + 1 );
+        return true;
+    }
+
+private:
+    const uint8_t*  m_pArgs;
+    uint32_t        m_Size;
+    uint32_t        m_Offset;
+};
+
+//-------------------------------------------------------------------------------------------------
+//      後続の引数を格納するために残すサイズを求めます. p は現在の変換指定の次の文字を指します.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+uint32_t GetReserveSize( const T* p )
+{
+    uint32_t size = 0;
+
+    while ( *p != 0 )
+    {
+        if ( *p++ != '%' )
+        { continue; }
+
+        FormatSpec spec;
+        p = ParseSpec( p, spec );
+
+        if ( spec.Conversion == 0 )
+        { break; }
+
+        if ( spec.Conversion == '%' )
+        { continue; }
+
+        if ( spec.WidthStar )
+        { size += kScalarArgSize; }
+
+        if ( spec.PrecisionStar )
+        { size += kScalarArgSize; }
+
+        switch( GetConversionType( spec.Conversion ) )
+        {
+        case CONVERSION_STRING:
+            size += kStringReserveSize;
+            break;
+
+        case CONVERSION_COUNT:
+            break;
+
+        case CONVERSION_UNKNOWN:
+            // 以降の引数はパックしないため, 残す必要はありません.
+            return size;
+
+        default:
+            // ワイド文字も変換後は 4byte 以内なので, 数値と同じサイズで足ります.
+            size += kScalarArgSize;
+            break;
+        }
+    }
+
+    return size;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      文字列の引数を書き込みます. 収まらない場合は後続の引数の分を残して切り詰めます.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+bool WriteStringArg( ArgWriter& writer, const char* value, size_t length, const T* pNext )
+{
+    auto reserve = ( kStringHeaderSize + length > writer.GetRest() ) ? GetReserveSize( pNext ) : 0;
+    return writer.WriteString( value, length, reserve );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      可変長引数をパックします.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+uint32_t PackArgs( const T* format, va_list args, uint8_t* pBuffer, uint32_t bufferSize )
+{
+    const auto wideFormat = ( sizeof(T) != sizeof(char) );
+
+    ArgWriter writer( pBuffer, bufferSize );
+    if ( format == nullptr )
+    { return 0; }
+
+    for( auto p = format; *p != 0; )
+    {
+        if ( *p++ != '%' )
+        { continue; }
+
+        FormatSpec spec;
+        p = ParseSpec( p, spec );
+
+        if ( spec.Conversion == 0 )
+        { break; }
+
+        if ( spec.Conversion == '%' )
+        { continue; }
+
+        if ( spec.WidthStar && !writer.Write( asdx::LOG_ARG_INT, uint64_t( int64_t( va_arg( args, int ) ) ) ) )
+        { break; }
+
+        // 文字列は精度までしか読まないため, 引数で指定された精度も保持しておきます.
+        auto precision = spec.Precision;
+        if ( spec.PrecisionStar )
+        {
+            precision = va_arg( args, int );
+            if ( !writer.Write( asdx::LOG_ARG_INT, uint64_t( int64_t( precision ) ) ) )
+            { break; }
+        }
+
+        auto result = true;
+        switch( GetConversionType( spec.Conversion ) )
+        {
+        case CONVERSION_SIGNED:
+            {
+                int64_t value = 0;
+                switch( spec.Length )
+                {
+                case LENGTH_HH:     value = static_cast<signed char>( va_arg( args, int ) ); break;
+                case LENGTH_H:      value = static_cast<short>( va_arg( args, int ) ); break;
+                case LENGTH_L:      value = va_arg( args, long ); break;
+                case LENGTH_LL:
+                case LENGTH_I64:    value = va_arg( args, long long ); break;
+                case LENGTH_J:      value = va_arg( args, intmax_t ); break;
+                case LENGTH_Z:
+                case LENGTH_T:      value = va_arg( args, ptrdiff_t ); break;
+                default:            value = va_arg( args, int ); break;
+                }
+                result = writer.Write( asdx::LOG_ARG_INT, uint64_t( value ) );
+            }
+            break;
+
+        case CONVERSION_UNSIGNED:
+            {
+                uint64_t value = 0;
+                switch( spec.Length )
+                {
+                case LENGTH_HH:     value = static_cast<unsigned char>( va_arg( args, int ) ); break;
+                case LENGTH_H:      value = static_cast<unsigned short>( va_arg( args, int ) ); break;
+                case LENGTH_L:      value = va_arg( args, unsigned long ); break;
+                case LENGTH_LL:
+                case LENGTH_I64:    value = va_arg( args, unsigned long long ); break;
+                case LENGTH_J:      value = va_arg( args, uintmax_t ); break;
+                case LENGTH_Z:
+                case LENGTH_T:      value = va_arg( args, size_t ); break;
+                default:            value = va_arg( args, unsigned int ); break;
+                }
+                result = writer.Write( asdx::LOG_ARG_INT, value );
+            }
+            break;
+
+        case CONVERSION_CHAR:
+            {
+                if ( IsWideArg( wideFormat, spec ) )
+                {
+                #if defined(_WIN32)
+                    auto value = static_cast<wchar_t>( va_arg( args, int ) );
+                #else
+                    auto value = static_cast<wchar_t>( va_arg( args, wint_t ) );
+                #endif
+                    auto text = asdx::ToLogString( &value, 1 );
+                    result = WriteStringArg( writer, text.c_str(), text.size(), p );
+                }
+                else
+                {
+                    result = writer.Write( asdx::LOG_ARG_INT, uint64_t( int64_t( va_arg( args, int ) ) ) );
+                }
+            }
+            break;
+
+        case CONVERSION_STRING:
+            {
+                // 精度の指定がある場合は終端文字が無くてもよいため, 精度を超えて読みません.
+                if ( IsWideArg( wideFormat, spec ) )
+                {
+                    auto value = va_arg( args, const wchar_t* );
+                    if ( value == nullptr )
+                    { result = WriteStringArg( writer, "(null)", 6, p ); }
+                    else
+                    {
+                        auto count = ( precision >= 0 ) ? wcsnlen( value, size_t( precision ) ) : wcslen( value );
+                        auto text  = asdx::ToLogString( value, count );
+                        result = WriteStringArg( writer, text.c_str(), text.size(), p );
+                    }
+                }
+                else
+                {
+                    auto value = va_arg( args, const char* );
+                    if ( value == nullptr )
+                    { value = "(null)"; }
+
+                    auto count = ( precision >= 0 ) ? strnlen( value, size_t( precision ) ) : strlen( value );
+                    result = WriteStringArg( writer, value, count, p );
+                }
+            }
+            break;
+
+        case CONVERSION_DOUBLE:
+            {
+                double value = ( spec.Length == LENGTH_LONG_DOUBLE )
+                    ? static_cast<double>( va_arg( args, long double ) )
+                    : va_arg( args, double );
+
+                uint64_t bits;
+                memcpy( &bits, &value, sizeof(bits) );
+                result = writer.Write( asdx::LOG_ARG_DOUBLE, bits );
+            }
+            break;
+
+        case CONVERSION_POINTER:
+            result = writer.Write( asdx::LOG_ARG_POINTER, uint64_t( reinterpret_cast<uintptr_t>( va_arg( args, void* ) ) ) );
+            break;
+
+        case CONVERSION_COUNT:
+            // 書き込み先は保持できないため, 読み飛ばします.
+            (void)va_arg( args, void* );
+            break;
+
+        default:
+            // 以降の引数の型が分からないため, ここで終了します.
+            result = false;
+            break;
+        }
+
+        if ( !result )
+        { break; }
+    }
+
+    return writer.GetSize();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      書式化した文字列を末尾に追加します.
+//-------------------------------------------------------------------------------------------------
+void AppendFormat( std::string& result, const char* format, ... )
+{
+    char buffer[256];
+
+    va_list args;
+    va_start( args, format );
+
+    va_list copy;
+    va_copy( copy, args );
+    auto count = vsnprintf( buffer, sizeof(buffer), format, copy );
+    va_end( copy );
+
+    if ( 0 <= count && count < int( sizeof(buffer) ) )
+    { result.append( buffer, size_t( count ) ); }
+    else if ( count > 0 )
+    {
+        auto offset = result.size();
+        result.resize( offset + size_t( count ) + 1 );
+        vsnprintf( &result[offset], size_t( count ) + 1, format, args );
+        result.resize( offset + size_t( count ) );
+    }
+
+    va_end( args );
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+//      書式に従って可変長引数をパックします.
+//-------------------------------------------------------------------------------------------------
+uint32_t PackLogArgs( const char* format, va_list args, uint8_t* pBuffer, uint32_t bufferSize )
+{ return PackArgs( format, args, pBuffer, bufferSize ); }
+
+//-------------------------------------------------------------------------------------------------
+//      書式に従って可変長引数をパックします.
+//-------------------------------------------------------------------------------------------------
+uint32_t PackLogArgs( const wchar_t* format, va_list args, uint8_t* pBuffer, uint32_t bufferSize )
+{ return PackArgs( format, args, pBuffer, bufferSize ); }
+
+//-------------------------------------------------------------------------------------------------
+//      パックした引数を書式に従って文字列に変換します.
+//-------------------------------------------------------------------------------------------------
+void FormatLogArgs( const char* format, const uint8_t* pArgs, uint32_t argSize, std::string& result )
+{
+    if ( format == nullptr )
+    { return; }
+
+    ArgReader reader( pArgs, argSize );
+
+    for( auto p = format; *p != 0; )
+    {
+        // 変換指定以外はそのまま出力.
+        auto pText = p;
+        while ( *p != 0 && *p != '%' )
+        { ++p; }
+        result.append( pText, p );
+
+        if ( *p == 0 )
+        { break; }
+
+        auto pSpec = p++;
+
+        FormatSpec spec;
+        p = ParseSpec( p, spec );
+
+        if ( spec.Conversion == 0 )
+        {
+            result.append( pSpec );
+            break;
+        }
+
+        if ( spec.Conversion == '%' )
+        {
+            result.push_back( '%' );
+            continue;
+        }
+
+        // 引数で指定された最小幅と精度を解決します.
+        auto     resolved = true;
+        uint64_t bits     = 0;
+        std::string flags = spec.Flags;
+
+        if ( spec.WidthStar )
+        {
+            resolved = reader.Read( LOG_ARG_INT, bits );
+            spec.Width = int( int64_t( bits ) );
+            if ( spec.Width < 0 )
+            {
+                flags.push_back( '-' );
+                spec.Width = -spec.Width;
+            }
+        }
+
+        if ( spec.PrecisionStar && resolved )
+        {
+            resolved = reader.Read( LOG_ARG_INT, bits );
+            spec.Precision = int( int64_t( bits ) );
+        }
+
+        if ( !resolved )
+        {
+            result.append( pSpec, p );
+            continue;
+        }
+
+        // 長さ修飾子を取り除いた変換指定を組み立てます.
+        char width[16]     = "";
+        char precision[16] = "";
+        char prefix[64];
+
+        if ( spec.Width >= 0 )
+        { snprintf( width, sizeof(width), "%d", spec.Width ); }
+
+        if ( spec.Precision >= 0 )
+        { snprintf( precision, sizeof(precision), ".%d", spec.Precision ); }
+
+        snprintf( prefix, sizeof(prefix), "%%%s%s%s", flags.c_str(), width, precision );
+
+        std::string convert = prefix;
+        const char* value   = nullptr;
+
+        switch( GetConversionType( spec.Conversion ) )
+        {
+        case CONVERSION_SIGNED:
+            if ( ( resolved = reader.Read( LOG_ARG_INT, bits ) ) )
+            {
+                convert += "lld";
+                AppendFormat( result, convert.c_str(), static_cast<long long>( bits ) );
+            }
+            break;
+
+        case CONVERSION_UNSIGNED:
+            if ( ( resolved = reader.Read( LOG_ARG_INT, bits ) ) )
+            {
+                convert += "ll";
+                convert.push_back( char( spec.Conversion ) );
+                AppendFormat( result, convert.c_str(), static_cast<unsigned long long>( bits ) );
+            }
+            break;
+
+        case CONVERSION_CHAR:
+            if ( reader.Peek() == LOG_ARG_STRING )
+            {
+                // ワイド文字はマルチバイト文字列に変換して格納しています.
+                if ( ( resolved = reader.ReadString( value ) ) )
+                {
+                    snprintf( prefix, sizeof(prefix), "%%%s%ss", flags.c_str(), width );
+                    convert = prefix;
+                    AppendFormat( result, convert.c_str(), value );
+                }
+            }
+            else if ( ( resolved = reader.Read( LOG_ARG_INT, bits ) ) )
+            {
+                convert += "c";
+                AppendFormat( result, convert.c_str(), static_cast<int>( bits ) );
+            }
+            break;
+
+        case CONVERSION_STRING:
+            if ( ( resolved = reader.ReadString( value ) ) )
+            {
+                convert += "s";
+                AppendFormat( result, convert.c_str(), value );
+            }
+            break;
+
+        case CONVERSION_DOUBLE:
+            if ( ( resolved = reader.Read( LOG_ARG_DOUBLE, bits ) ) )
+            {
+                double number;
+                memcpy( &number, &bits, sizeof(number) );
+                convert.push_back( char( spec.Conversion ) );
+                AppendFormat( result, convert.c_str(), number );
+            }
+            break;
+
+        case CONVERSION_POINTER:
+            if ( ( resolved = reader.Read( LOG_ARG_POINTER, bits ) ) )
+            {
+                convert += "p";
+                AppendFormat( result, convert.c_str(), reinterpret_cast<void*>( uintptr_t( bits ) ) );
+            }
+            break;
+
+        case CONVERSION_COUNT:
+            break;
+
+        default:
+            resolved = false;
+            break;
+        }
+
+        // 引数が足りない場合は変換指定をそのまま出力.
+        if ( !resolved )
+        { result.append( pSpec, p ); }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ワイド文字列をログ出力用のマルチバイト文字列に変換します.
+//-------------------------------------------------------------------------------------------------
+std::string ToLogString( const wchar_t* value, size_t count )
+{
+    std::string result;
+    if ( value == nullptr || count == 0 )
+    { return result; }
+
+#if defined(_WIN32)
+    auto length = WideCharToMultiByte( CP_ACP, 0, value, int( count ), nullptr, 0, nullptr, nullptr );
+    if ( length <= 0 )
+    { return result; }
+
+    result.resize( size_t( length ) );
+    WideCharToMultiByte( CP_ACP, 0, value, int( count ), &result[0], length, nullptr, nullptr );
+#else
+    result.reserve( count );
+    for( size_t i = 0; i < count; ++i )
+    {
+        auto code = uint32_t( value[i] );
+
+        // UTF-16 のサロゲートペアを結合します.
+        if ( 0xD800 <= code && code <= 0xDBFF && i + 1 < count )
+        {
+            auto low = uint32_t( value[i + 1] );
+            if ( 0xDC00 <= low && low <= 0xDFFF )
+            {
+                code = 0x10000 + ( ( code - 0xD800 ) << 10 ) + ( low - 0xDC00 );
+                ++i;
+            }
+        }
+
+        if ( code < 0x80 )
+        { result.push_back( char( code ) ); }
+        else if ( code < 0x800 )
+        {
+            result.push_back( char( 0xC0 | ( code >> 6 ) ) );
+            result.push_back( char( 0x80 | ( code & 0x3F ) ) );
+        }
+        else if ( code < 0x10000 )
+        {
+            result.push_back( char( 0xE0 | ( code >> 12 ) ) );
+            result.push_back( char( 0x80 | ( ( code >> 6 ) & 0x3F ) ) );
+            result.push_back( char( 0x80 | ( code & 0x3F ) ) );
+        }
+        else
+        {
+            result.push_back( char( 0xF0 | ( code >> 18 ) ) );
+            result.push_back( char( 0x80 | ( ( code >> 12 ) & 0x3F ) ) );
+            result.push_back( char( 0x80 | ( ( code >> 6 ) & 0x3F ) ) );
+            result.push_back( char( 0x80 | ( code & 0x3F ) ) );
+        }
+    }
+#endif//defined(_WIN32)
+
+    return result;
+}
+
+} // namespace asdx
@@ -0,0 +1,386 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxLogTrace.cpp
+// Desc : Binary Log Trace.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxLogTrace.h>
+#include <asdxLogFormat.h>
+#include <chrono>
+#include <cstring>
+#include <cwchar>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const uint32_t   kTraceMagic         = 0x52544C41;       // 'ALTR'
+static const uint32_t   kTraceVersion       = 1;
+static const uint8_t    kRecordFormat       = 1;                // 書式の定義です.
+static const uint8_t    kRecordEvent        = 2;                // ログです.
+static const size_t     kFlushThreshold     = 64 * 1024;        // バッファがこれを超えたら書き出します.
+static const uint64_t   kMaxFormatLength    = 64 * 1024;        // 読み込む書式の最大長です.
+static const uint64_t   kMaxArgSize         = 64 * 1024;        // 読み込む引数の最大サイズです.
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TraceHeader structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct TraceHeader
+{
+    uint32_t    Magic;          //!< マジックです.
+    uint32_t    Version;        //!< バージョンです.
+    uint64_t    BaseTime;       //!< 最初のログの時刻差の基準です (UNIX 時間, ナノ秒).
+};
+
+//-------------------------------------------------------------------------------------------------
+//      可変長整数を追加します.
+//-------------------------------------------------------------------------------------------------
+void PutVarint( std::vector<uint8_t>& buffer, uint64_t value )
+{
+    while ( value >= 0x80 )
+    {
+        buffer.push_back( uint8_t( value | 0x80 ) );
+        value >>= 7;
+    }
+    buffer.push_back( uint8_t( value ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      符号付き整数を ZigZag 符号化します.
+//-------------------------------------------------------------------------------------------------
+inline uint64_t EncodeZigZag( int64_t value )
+{ return ( uint64_t( value ) << 1 ) ^ uint64_t( value >> 63 ); }
+
+//-------------------------------------------------------------------------------------------------
+//      ZigZag 符号化を復号します.
+//-------------------------------------------------------------------------------------------------
+inline int64_t DecodeZigZag( uint64_t value )
+{ return int64_t( value >> 1 ) ^ -int64_t( value & 1 ); }
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LogTraceSink class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+LogTraceSink::LogTraceSink()
+: m_pFile   ( nullptr )
+, m_PrevTime( 0 )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+LogTraceSink::~LogTraceSink()
+{ Close(); }
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルを開きます.
+//-------------------------------------------------------------------------------------------------
+bool LogTraceSink::Open( const char* path )
+{
+    Close();
+
+    if ( fopen_s( &m_pFile, path, "wb" ) != 0 )
+    {
+        ELOGA( "Error : File Open Failed. path = %s", path );
+        m_pFile = nullptr;
+        return false;
+    }
+
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+
+    TraceHeader header;
+    header.Magic    = kTraceMagic;
+    header.Version  = kTraceVersion;
+    header.BaseTime = uint64_t( std::chrono::duration_cast<std::chrono::nanoseconds>( now ).count() );
+
+    if ( fwrite( &header, sizeof(header), 1, m_pFile ) != 1 )
+    {
+        ELOGA( "Error : File Write Failed. path = %s", path );
+        fclose( m_pFile );
+        m_pFile = nullptr;
+        return false;
+    }
+
+    m_PrevTime = header.BaseTime;
+    m_FormatIds.clear();
+    m_Buffer.clear();
+    m_Buffer.reserve( kFlushThreshold + 1024 );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルを閉じます.
+//-------------------------------------------------------------------------------------------------
+void LogTraceSink::Close()
+{
+    if ( m_pFile == nullptr )
+    { return; }
+
+    OnFlush();
+    fclose( m_pFile );
+
+    m_pFile = nullptr;
+    m_FormatIds.clear();
+    m_Buffer.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ログを記録します.
+//-------------------------------------------------------------------------------------------------
+void LogTraceSink::OnLog( const LogRecord& record )
+{
+    if ( m_pFile == nullptr )
+    { return; }
+
+    // 初出の書式を記録.
+    auto itr = m_FormatIds.find( record.pFormat );
+    if ( itr == m_FormatIds.end() )
+    {
+        std::string format;
+        if ( record.Wide )
+        {
+            auto value = static_cast<const wchar_t*>( record.pFormat );
+            format = ToLogString( value, wcslen( value ) );
+        }
+        else
+        {
+            format = static_cast<const char*>( record.pFormat );
+        }
+
+        auto id = uint32_t( m_FormatIds.size() );
+        itr = m_FormatIds.emplace( record.pFormat, id ).first;
+
+        m_Buffer.push_back( kRecordFormat );
+        PutVarint( m_Buffer, id );
+        PutVarint( m_Buffer, format.size() );
+        m_Buffer.insert( m_Buffer.end(), format.begin(), format.end() );
+    }
+
+    // ログを記録. 時刻はスレッド間で前後することがあるため, 符号付きの差分で記録します.
+    m_Buffer.push_back( kRecordEvent );
+    m_Buffer.push_back( uint8_t( record.Level ) );
+    PutVarint( m_Buffer, EncodeZigZag( int64_t( record.Time - m_PrevTime ) ) );
+    PutVarint( m_Buffer, record.ThreadId );
+    PutVarint( m_Buffer, itr->second );
+    PutVarint( m_Buffer, record.ArgSize );
+    m_Buffer.insert( m_Buffer.end(), record.pArgs, record.pArgs + record.ArgSize );
+
+    m_PrevTime = record.Time;
+
+    if ( m_Buffer.size() >= kFlushThreshold )
+    { OnFlush(); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      バッファに溜めたレコードを書き出します.
+//-------------------------------------------------------------------------------------------------
+void LogTraceSink::OnFlush()
+{
+    if ( m_pFile == nullptr || m_Buffer.empty() )
+    { return; }
+
+    fwrite( m_Buffer.data(), 1, m_Buffer.size(), m_pFile );
+    fflush( m_pFile );
+    m_Buffer.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      書式化した文字列を必要とするかどうか.
+//-------------------------------------------------------------------------------------------------
+bool LogTraceSink::RequireText() const
+{ return false; }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LogTraceReader class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+LogTraceReader::LogTraceReader()
+: m_pFile   ( nullptr )
+, m_PrevTime( 0 )
+, m_Broken  ( false )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+LogTraceReader::~LogTraceReader()
+{ Close(); }
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルを開きます.
+//-------------------------------------------------------------------------------------------------
+bool LogTraceReader::Open( const char* path )
+{
+    Close();
+
+    if ( fopen_s( &m_pFile, path, "rb" ) != 0 )
+    {
+        ELOGA( "Error : File Open Failed. path = %s", path );
+        m_pFile = nullptr;
+        return false;
+    }
+
+    TraceHeader header;
+    if ( fread( &header, sizeof(header), 1, m_pFile ) != 1
+      || header.Magic   != kTraceMagic
+      || header.Version != kTraceVersion )
+    {
+        ELOGA( "Error : Invalid Trace File. path = %s", path );
+        Close();
+        return false;
+    }
+
+    m_PrevTime = header.BaseTime;
+    m_Broken   = false;
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルを閉じます.
+//-------------------------------------------------------------------------------------------------
+void LogTraceReader::Close()
+{
+    if ( m_pFile != nullptr )
+    {
+        fclose( m_pFile );
+        m_pFile = nullptr;
+    }
+
+    m_Formats.clear();
+    m_Args.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      次のログを読み込みます.
+//-------------------------------------------------------------------------------------------------
+bool LogTraceReader::Next( LogTraceEvent& result )
+{
+    if ( m_pFile == nullptr || m_Broken )
+    { return false; }
+
+    for(;;)
+    {
+        auto type = fgetc( m_pFile );
+        if ( type == EOF )
+        { return false; }
+
+        if ( type == kRecordFormat )
+        {
+            uint64_t id     = 0;
+            uint64_t length = 0;
+            if ( !ReadVarint( id ) || !ReadVarint( length ) || id != m_Formats.size() || length > kMaxFormatLength )
+            {
+                m_Broken = true;
+                return false;
+            }
+
+            std::string format( size_t( length ), '\0' );
+            if ( length > 0 && fread( &format[0], size_t( length ), 1, m_pFile ) != 1 )
+            {
+                m_Broken = true;
+                return false;
+            }
+
+            m_Formats.push_back( format );
+            continue;
+        }
+
+        if ( type != kRecordEvent )
+        {
+            m_Broken = true;
+            return false;
+        }
+
+        auto     level    = fgetc( m_pFile );
+        uint64_t delta    = 0;
+        uint64_t threadId = 0;
+        uint64_t formatId = 0;
+        uint64_t argSize  = 0;
+        if ( level == EOF
+          || !ReadVarint( delta )
+          || !ReadVarint( threadId )
+          || !ReadVarint( formatId )
+          || !ReadVarint( argSize )
+          || formatId >= m_Formats.size()
+          || argSize > kMaxArgSize )
+        {
+            m_Broken = true;
+            return false;
+        }
+
+        m_Args.resize( size_t( argSize ) );
+        if ( argSize > 0 && fread( m_Args.data(), size_t( argSize ), 1, m_pFile ) != 1 )
+        {
+            m_Broken = true;
+            return false;
+        }
+
+        m_PrevTime += uint64_t( DecodeZigZag( delta ) );
+
+        result.Level    = LogLevel( level );
+        result.ThreadId = uint32_t( threadId );
+        result.Time     = m_PrevTime;
+        result.FormatId = uint32_t( formatId );
+        result.pFormat  = m_Formats[size_t( formatId )].c_str();
+        result.pArgs    = m_Args.data();
+        result.ArgSize  = uint32_t( argSize );
+        return true;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      壊れていたかどうか.
+//-------------------------------------------------------------------------------------------------
+bool LogTraceReader::IsBroken() const
+{ return m_Broken; }
+
+//-------------------------------------------------------------------------------------------------
+//      書式の数を取得します.
+//-------------------------------------------------------------------------------------------------
+uint32_t LogTraceReader::GetFormatCount() const
+{ return uint32_t( m_Formats.size() ); }
+
+//-------------------------------------------------------------------------------------------------
+//      書式を取得します.
+//-------------------------------------------------------------------------------------------------
+const char* LogTraceReader::GetFormat( uint32_t id ) const
+{ return ( id < m_Formats.size() ) ? m_Formats[id].c_str() : nullptr; }
+
+//-------------------------------------------------------------------------------------------------
+//      可変長整数を読み込みます.
+//-------------------------------------------------------------------------------------------------
+bool LogTraceReader::ReadVarint( uint64_t& value )
+{
+    value = 0;
+    for( uint32_t shift = 0; shift < 64; shift += 7 )
+    {
+        auto c = fgetc( m_pFile );
+        if ( c == EOF )
+        { return false; }
+
+        value |= uint64_t( c & 0x7F ) << shift;
+        if ( ( c & 0x80 ) == 0 )
+        { return true; }
+    }
+    return false;
+}
+
+} // namespace asdx
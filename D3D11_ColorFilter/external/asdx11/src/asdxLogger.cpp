@@ -9,12 +9,106 @@
 //-------------------------------------------------------------------------------------------------
 #include <cstdio>
 #include <cstdarg>
-#include <Windows.h>
+#include <cstring>
+#include <chrono>
+#include <ctime>
+#include <cwchar>
 #include <asdxLogger.h>
+#include <asdxLogFormat.h>
+
+#if defined(_WIN32)
+    #include <Windows.h>
+#else
+    #include <unistd.h>
+    #include <sys/syscall.h>
+#endif//defined(_WIN32)
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const uint32_t   kLogSlotSize    = 512;      // 1スロットのサイズです.
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LogSlotHeader structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct LogSlotHeader
+{
+    uint64_t        Time;           //!< 出力した時刻です.
+    const void*     pFormat;        //!< 書式です.
+    uint32_t        ThreadId;       //!< 出力したスレッドの ID です.
+    uint16_t        ArgSize;        //!< パックした引数のサイズです.
+    uint8_t         Level;          //!< ログレベルです.
+    uint8_t         Wide;           //!< 書式がワイド文字列かどうか.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LogSlot structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief  キューのスロットです. 書き込み完了を Sequence で通知します.
+struct LogSlot
+{
+    static const uint32_t kArgCapacity = kLogSlotSize - sizeof(std::atomic<uint64_t>) - sizeof(LogSlotHeader);
+
+    std::atomic<uint64_t>   Sequence;                   //!< シーケンス番号です.
+    LogSlotHeader           Header;                     //!< ヘッダです.
+    uint8_t                 Args[kArgCapacity];         //!< パックした引数です.
+};
+
+} // namespace asdx
 
 
 namespace /* anonymous */ {
 
+static_assert( uint32_t( asdx::LogLevel::Verbose ) == ASDX_LOG_LEVEL_VERBOSE, "Log level mismatch." );
+static_assert( uint32_t( asdx::LogLevel::Info    ) == ASDX_LOG_LEVEL_INFO,    "Log level mismatch." );
+static_assert( uint32_t( asdx::LogLevel::Debug   ) == ASDX_LOG_LEVEL_DEBUG,   "Log level mismatch." );
+static_assert( uint32_t( asdx::LogLevel::Warning ) == ASDX_LOG_LEVEL_WARNING, "Log level mismatch." );
+static_assert( uint32_t( asdx::LogLevel::Error   ) == ASDX_LOG_LEVEL_ERROR,   "Log level mismatch." );
+
+//-------------------------------------------------------------------------------------------------
+// Global Variables.
+//-------------------------------------------------------------------------------------------------
+thread_local bool   t_InsideLogger = false;     // ロガースレッドまたはシンクの中かどうか.
+
+//-------------------------------------------------------------------------------------------------
+//      スレッド ID を取得します.
+//-------------------------------------------------------------------------------------------------
+uint32_t GetLogThreadId()
+{
+#if defined(_WIN32)
+    return uint32_t( GetCurrentThreadId() );
+#else
+    static thread_local uint32_t id = uint32_t( syscall( SYS_gettid ) );
+    return id;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      現在時刻を取得します.
+//-------------------------------------------------------------------------------------------------
+uint64_t GetLogTime()
+{
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    return uint64_t( std::chrono::duration_cast<std::chrono::nanoseconds>( now ).count() );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      可変長引数をパックします.
+//-------------------------------------------------------------------------------------------------
+uint32_t PackValues( uint8_t* pBuffer, uint32_t bufferSize, const char* format, ... )
+{
+    va_list args;
+    va_start( args, format );
+    auto size = asdx::PackLogArgs( format, args, pBuffer, bufferSize );
+    va_end( args );
+    return size;
+}
+
+#if defined(_WIN32)
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // ConsoleColor class
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -93,11 +187,170 @@ private:
     /* NOTHING */
 };
 
+#endif//defined(_WIN32)
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ConsoleSink class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ConsoleSink : public asdx::ILogSink
+{
+public:
+    void OnLog( const asdx::LogRecord& record ) override
+    {
+    #if defined(_WIN32)
+        ConsoleColor color;
+
+        // カラーを設定.
+        color.Bind( record.Level );
+
+        fwrite( record.pText, 1, record.TextLength, stdout );
+        fflush( stdout );
+
+        // カラー設定解除.
+        color.Unbind();
+
+        OutputDebugStringA( record.pText );
+    #else
+        static const char* kColors[] = {
+            "\x1b[37;1m",   // Verbose
+            "\x1b[32;1m",   // Info
+            "\x1b[34;1m",   // Debug
+            "\x1b[33;1m",   // Warning
+            "\x1b[31;1m",   // Error
+        };
+        static const bool kTerminal = ( isatty( fileno( stdout ) ) != 0 );
+
+        auto index = uint32_t( record.Level );
+        if ( kTerminal && index < sizeof(kColors) / sizeof(kColors[0]) )
+        {
+            fputs( kColors[index], stdout );
+            fwrite( record.pText, 1, record.TextLength, stdout );
+            fputs( "\x1b[0m", stdout );
+        }
+        else
+        {
+            fwrite( record.pText, 1, record.TextLength, stdout );
+        }
+    #endif
+    }
+
+    void OnFlush() override
+    { fflush( stdout ); }
+};
+
+//-------------------------------------------------------------------------------------------------
+// Global Variables.
+//-------------------------------------------------------------------------------------------------
+ConsoleSink     g_ConsoleSink;
+
 }// namespace /* anonymous */
 
 
 namespace asdx {
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LogFileSink class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class LogFileSink : public ILogSink
+{
+public:
+    LogFileSink()
+    : m_pFile( nullptr )
+    { /* DO_NOTHING */ }
+
+    ~LogFileSink()
+    {
+        if ( m_pFile != nullptr )
+        { fclose( m_pFile ); }
+    }
+
+    bool Open( const char* path )
+    {
+    #if defined(_WIN32)
+        if ( fopen_s( &m_pFile, path, "wb" ) != 0 )
+        { m_pFile = nullptr; }
+    #else
+        m_pFile = fopen( path, "wb" );
+    #endif
+        return ( m_pFile != nullptr );
+    }
+
+    void OnLog( const LogRecord& record ) override
+    {
+        static const char* kLevels[] = { "V", "I", "D", "W", "E" };
+
+        auto sec  = time_t( record.Time / 1000000000ull );
+        auto msec = uint32_t( ( record.Time / 1000000ull ) % 1000 );
+
+        tm local = {};
+    #if defined(_WIN32)
+        localtime_s( &local, &sec );
+    #else
+        localtime_r( &sec, &local );
+    #endif
+
+        auto index = uint32_t( record.Level );
+        fprintf( m_pFile, "%02d:%02d:%02d.%03u [%s][%5u] ",
+            local.tm_hour,
+            local.tm_min,
+            local.tm_sec,
+            msec,
+            ( index < 5 ) ? kLevels[index] : "?",
+            record.ThreadId );
+
+        fwrite( record.pText, 1, record.TextLength, m_pFile );
+    }
+
+    void OnFlush() override
+    { fflush( m_pFile ); }
+
+private:
+    FILE*   m_pFile;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LogHistorySink class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class LogHistorySink : public ILogSink
+{
+public:
+    explicit LogHistorySink( uint32_t count )
+    : m_Entries ( count )
+    , m_Count   ( 0 )
+    { /* DO_NOTHING */ }
+
+    void OnLog( const LogRecord& record ) override
+    {
+        std::lock_guard<std::mutex> locker( m_Mutex );
+
+        auto& entry = m_Entries[m_Count % m_Entries.size()];
+        m_Count++;
+
+        entry.Index     = m_Count;
+        entry.Level     = record.Level;
+        entry.ThreadId  = record.ThreadId;
+        entry.Time      = record.Time;
+        entry.Text.assign( record.pText, record.TextLength );
+    }
+
+    void GetHistory( std::vector<LogHistory>& result, uint64_t afterIndex )
+    {
+        std::lock_guard<std::mutex> locker( m_Mutex );
+
+        auto begin = ( m_Count > m_Entries.size() ) ? m_Count - m_Entries.size() : 0;
+        if ( begin < afterIndex )
+        { begin = afterIndex; }
+
+        for( auto i = begin; i < m_Count; ++i )
+        { result.push_back( m_Entries[i % m_Entries.size()] ); }
+    }
+
+private:
+    std::mutex                  m_Mutex;
+    std::vector<LogHistory>     m_Entries;
+    uint64_t                    m_Count;
+};
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // SystemLogger class
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -107,9 +360,32 @@ SystemLogger SystemLogger::s_Instance;
 //      コンストラクタです
 //-------------------------------------------------------------------------------------------------
 SystemLogger::SystemLogger()
-: m_Filter( LogLevel::Verbose )
+: m_Filter      ( LogLevel::Verbose )
+, m_pSlots      ( nullptr )
+, m_SlotCount   ( 0 )
+, m_WaitTimeMsec( 0 )
+, m_Head        ( 0 )
+, m_Tail        ( 0 )
+, m_DropCount   ( 0 )
+, m_DropTotal   ( 0 )
+, m_Running     ( false )
+, m_Stop        ( false )
+, m_pConsoleSink( &g_ConsoleSink )
+, m_pFileSink   ( nullptr )
+, m_pHistorySink( nullptr )
 { /* DO_NOTHING */ }
 
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+SystemLogger::~SystemLogger()
+{
+    Term();
+
+    delete[] m_pSlots;
+    m_pSlots = nullptr;
+}
+
 //-------------------------------------------------------------------------------------------------
 //      インスタンスを取得します.
 //-------------------------------------------------------------------------------------------------
@@ -117,65 +393,213 @@ SystemLogger& SystemLogger::GetInstance()
 { return s_Instance; }
 
 //-------------------------------------------------------------------------------------------------
-//      ログを出力します.
+//      初期化処理を行います.
 //-------------------------------------------------------------------------------------------------
-void SystemLogger::LogA( const LogLevel level, const char* format, ... )
+bool SystemLogger::Init( const SystemLoggerDesc& desc )
 {
-    if ( level >= m_Filter )
-    {
-        ConsoleColor color;
+    // 念のために終了させる.
+    Term();
 
-        // カラーを設定.
-        color.Bind( level );
+    // シンクを準備.
+    {
+        std::lock_guard<std::mutex> locker( m_SinkMutex );
 
-        // ログ出力.
+        if ( !desc.FilePath.empty() )
         {
-            char msg[ 2048 ] = "\0";
-            va_list arg;
+            m_pFileSink = new LogFileSink();
+            if ( !m_pFileSink->Open( desc.FilePath.c_str() ) )
+            {
+                fprintf( stderr, "Error : Log File Open Failed. path = %s\n", desc.FilePath.c_str() );
+                delete m_pFileSink;
+                m_pFileSink = nullptr;
+                return false;
+            }
+        }
 
-            va_start( arg, format );
-            vsprintf_s( msg, format, arg );
-            va_end( arg );
+        if ( desc.HistoryCount > 0 )
+        { m_pHistorySink = new LogHistorySink( desc.HistoryCount ); }
 
-            printf_s( "%s", msg );
+        m_pConsoleSink = ( desc.EnableConsole ) ? &g_ConsoleSink : nullptr;
+    }
+
+    // スロット数を 2 のべき乗に切り上げ.
+    uint32_t count = 2;
+    while ( count < desc.QueueSize && count < ( 1u << 24 ) )
+    { count <<= 1; }
 
-            OutputDebugStringA( msg );
+    // Term() の後に出力しようとしたスレッドが触れる可能性があるため, スロットは再利用します.
+    if ( m_SlotCount != count )
+    {
+        delete[] m_pSlots;
+        m_pSlots    = new LogSlot[count];
+        m_SlotCount = count;
+    }
+
+    for( uint32_t i = 0; i < count; ++i )
+    { m_pSlots[i].Sequence.store( i, std::memory_order_relaxed ); }
+
+    m_Head.store( 0, std::memory_order_relaxed );
+    m_Tail.store( 0, std::memory_order_relaxed );
+    m_DropCount.store( 0, std::memory_order_relaxed );
+    m_DropTotal.store( 0, std::memory_order_relaxed );
+
+    m_WaitTimeMsec = ( desc.WaitTimeMsec > 0 ) ? desc.WaitTimeMsec : 1;
+    m_Stop         = false;
+
+    // ロガースレッド起動.
+    m_Running.store( true, std::memory_order_release );
+    m_Thread = std::thread( &SystemLogger::Run, this );
+
+    // 正常終了.
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      終了処理を行います.
+//-------------------------------------------------------------------------------------------------
+void SystemLogger::Term()
+{
+    if ( m_Thread.joinable() )
+    {
+        // 終了フラグを立てる.
+        {
+            std::lock_guard<std::mutex> locker( m_Mutex );
+            m_Stop = true;
         }
+        m_WakeCond.notify_all();
 
-        // カラー設定解除.
-        color.Unbind();
+        // 残ったログはロガースレッドが全て出力します.
+        m_Thread.join();
+
+        m_Running.store( false, std::memory_order_release );
+
+        // 終了フラグが立った後にキューに格納されたものを出力.
+        Drain();
+
+        // Flush() の待機を解除.
+        {
+            std::lock_guard<std::mutex> locker( m_Mutex );
+            m_DoneCond.notify_all();
+        }
     }
+
+    // コンソールのみに戻す.
+    std::lock_guard<std::mutex> locker( m_SinkMutex );
+
+    delete m_pFileSink;
+    m_pFileSink = nullptr;
+
+    delete m_pHistorySink;
+    m_pHistorySink = nullptr;
+
+    m_pConsoleSink = &g_ConsoleSink;
+    m_WideFormats.clear();
 }
 
+//-------------------------------------------------------------------------------------------------
+//      初期化済みかどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool SystemLogger::IsInit() const
+{ return m_Running.load( std::memory_order_acquire ); }
 
 //-------------------------------------------------------------------------------------------------
-//      ログを出力します.
+//      出力したログが全て処理されるまで待機します.
 //-------------------------------------------------------------------------------------------------
-void SystemLogger::LogW( const LogLevel level, const wchar_t* format, ... )
+void SystemLogger::Flush()
 {
-    if ( level >= m_Filter )
+    if ( t_InsideLogger )
+    { return; }
+
+    if ( !m_Running.load( std::memory_order_acquire ) )
     {
-        ConsoleColor color;
+        std::lock_guard<std::mutex> locker( m_SinkMutex );
+        FlushSinks();
+        return;
+    }
 
-        // カラーを設定.
-        color.Bind( level );
+    auto target = m_Head.load( std::memory_order_acquire );
 
-        // ログ出力.
-        {
-            wchar_t msg[ 2048 ] = L"\0";
-            va_list arg;
+    std::unique_lock<std::mutex> locker( m_Mutex );
+    m_WakeCond.notify_one();
+    m_DoneCond.wait( locker, [&]()
+    {
+        return m_Tail.load( std::memory_order_acquire ) >= target
+            || !m_Running.load( std::memory_order_acquire );
+    });
+}
 
-            va_start( arg, format );
-            vswprintf_s( msg, format, arg );
-            va_end( arg );
+//-------------------------------------------------------------------------------------------------
+//      シンクを追加します.
+//-------------------------------------------------------------------------------------------------
+void SystemLogger::AddSink( ILogSink* pSink )
+{
+    if ( pSink == nullptr )
+    { return; }
 
-            wprintf_s( L"%s", msg );
+    std::lock_guard<std::mutex> locker( m_SinkMutex );
+    m_Sinks.push_back( pSink );
+}
 
-            OutputDebugStringW( msg );
+//-------------------------------------------------------------------------------------------------
+//      シンクを削除します.
+//-------------------------------------------------------------------------------------------------
+void SystemLogger::RemoveSink( ILogSink* pSink )
+{
+    std::lock_guard<std::mutex> locker( m_SinkMutex );
+
+    for( auto itr = m_Sinks.begin(); itr != m_Sinks.end(); ++itr )
+    {
+        if ( *itr == pSink )
+        {
+            m_Sinks.erase( itr );
+            break;
         }
+    }
+}
 
-        // カラー設定解除.
-        color.Unbind();
+//-------------------------------------------------------------------------------------------------
+//      アプリ内表示用に保持しているログを取得します.
+//-------------------------------------------------------------------------------------------------
+void SystemLogger::GetHistory( std::vector<LogHistory>& result, uint64_t afterIndex )
+{
+    std::lock_guard<std::mutex> locker( m_SinkMutex );
+
+    if ( m_pHistorySink != nullptr )
+    { m_pHistorySink->GetHistory( result, afterIndex ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      破棄したログの数を取得します.
+//-------------------------------------------------------------------------------------------------
+uint64_t SystemLogger::GetDropCount() const
+{ return m_DropTotal.load( std::memory_order_relaxed ) + m_DropCount.load( std::memory_order_relaxed ); }
+
+//-------------------------------------------------------------------------------------------------
+//      ログを出力します.
+//-------------------------------------------------------------------------------------------------
+void SystemLogger::LogA( const LogLevel level, const char* format, ... )
+{
+    if ( level >= m_Filter )
+    {
+        va_list arg;
+        va_start( arg, format );
+        Enqueue( level, format, false, arg );
+        va_end( arg );
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+//      ログを出力します.
+//-------------------------------------------------------------------------------------------------
+void SystemLogger::LogW( const LogLevel level, const wchar_t* format, ... )
+{
+    if ( level >= m_Filter )
+    {
+        va_list arg;
+        va_start( arg, format );
+        Enqueue( level, format, true, arg );
+        va_end( arg );
     }
 }
 
@@ -191,4 +615,242 @@ void SystemLogger::SetFilter( const LogLevel filter )
 LogLevel SystemLogger::GetFilter()
 { return m_Filter; }
 
+//-------------------------------------------------------------------------------------------------
+//      ログをキューに格納します.
+//-------------------------------------------------------------------------------------------------
+void SystemLogger::Enqueue( LogLevel level, const void* pFormat, bool wide, va_list args )
+{
+    // シンクの中から出力したものは, 再帰やデッドロックを避けるため破棄します.
+    if ( t_InsideLogger )
+    { return; }
+
+    LogSlotHeader header;
+    header.Time     = GetLogTime();
+    header.pFormat  = pFormat;
+    header.ThreadId = GetLogThreadId();
+    header.ArgSize  = 0;
+    header.Level    = uint8_t( level );
+    header.Wide     = uint8_t( wide ? 1 : 0 );
+
+    // 初期化前は出力したスレッドで処理します.
+    if ( !m_Running.load( std::memory_order_acquire ) )
+    {
+        LogSlot slot;
+        slot.Header = header;
+        slot.Header.ArgSize = uint16_t( wide
+            ? PackLogArgs( static_cast<const wchar_t*>( pFormat ), args, slot.Args, LogSlot::kArgCapacity )
+            : PackLogArgs( static_cast<const char*>( pFormat ), args, slot.Args, LogSlot::kArgCapacity ) );
+
+        std::lock_guard<std::mutex> locker( m_SinkMutex );
+        t_InsideLogger = true;
+        Dispatch( slot );
+        FlushSinks();
+        t_InsideLogger = false;
+        return;
+    }
+
+    // スロットを確保.
+    auto     mask = uint64_t( m_SlotCount - 1 );
+    auto     pos  = m_Head.load( std::memory_order_relaxed );
+    LogSlot* pSlot = nullptr;
+    for(;;)
+    {
+        pSlot = &m_pSlots[pos & mask];
+        auto seq  = pSlot->Sequence.load( std::memory_order_acquire );
+        auto diff = int64_t( seq - pos );
+        if ( diff == 0 )
+        {
+            if ( m_Head.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+            { break; }
+        }
+        else if ( diff < 0 )
+        {
+            // キューが一杯.
+            if ( level < LogLevel::Warning )
+            {
+                m_DropCount.fetch_add( 1, std::memory_order_relaxed );
+                m_WakeCond.notify_one();
+                return;
+            }
+
+            m_WakeCond.notify_one();
+            std::this_thread::yield();
+            pos = m_Head.load( std::memory_order_relaxed );
+        }
+        else
+        {
+            pos = m_Head.load( std::memory_order_relaxed );
+        }
+    }
+
+    // 書式化はロガースレッドで行うため, ここでは引数をパックするだけです.
+    pSlot->Header = header;
+    pSlot->Header.ArgSize = uint16_t( wide
+        ? PackLogArgs( static_cast<const wchar_t*>( pFormat ), args, pSlot->Args, LogSlot::kArgCapacity )
+        : PackLogArgs( static_cast<const char*>( pFormat ), args, pSlot->Args, LogSlot::kArgCapacity ) );
+
+    pSlot->Sequence.store( pos + 1, std::memory_order_release );
+
+    // エラーは即座に, それ以外はキューが半分埋まったら起こします.
+    if ( level >= LogLevel::Error || pos - m_Tail.load( std::memory_order_relaxed ) >= m_SlotCount / 2 )
+    { m_WakeCond.notify_one(); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ロガースレッドの処理です.
+//-------------------------------------------------------------------------------------------------
+void SystemLogger::Run()
+{
+    t_InsideLogger = true;
+
+    for(;;)
+    {
+        auto processed = Drain();
+
+        std::unique_lock<std::mutex> locker( m_Mutex );
+        m_DoneCond.notify_all();
+
+        if ( m_Stop )
+        {
+            // 確保済みで書き込み中のスロットがなくなるまで処理します.
+            if ( m_Head.load( std::memory_order_acquire ) == m_Tail.load( std::memory_order_acquire ) )
+            { break; }
+
+            locker.unlock();
+            std::this_thread::yield();
+            continue;
+        }
+
+        if ( !processed )
+        { m_WakeCond.wait_for( locker, std::chrono::milliseconds( m_WaitTimeMsec ) ); }
+    }
+
+    t_InsideLogger = false;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      キューに格納されたログを全て出力します.
+//-------------------------------------------------------------------------------------------------
+bool SystemLogger::Drain()
+{
+    if ( m_pSlots == nullptr )
+    { return false; }
+
+    auto inside = t_InsideLogger;
+    t_InsideLogger = true;
+
+    std::lock_guard<std::mutex> locker( m_SinkMutex );
+
+    auto mask  = uint64_t( m_SlotCount - 1 );
+    auto count = 0u;
+    for(;;)
+    {
+        auto  tail = m_Tail.load( std::memory_order_relaxed );
+        auto& slot = m_pSlots[tail & mask];
+        if ( slot.Sequence.load( std::memory_order_acquire ) != tail + 1 )
+        { break; }
+
+        Dispatch( slot );
+
+        slot.Sequence.store( tail + mask + 1, std::memory_order_release );
+        m_Tail.store( tail + 1, std::memory_order_release );
+        count++;
+    }
+
+    // 破棄したログの数を報告.
+    auto dropped = m_DropCount.exchange( 0, std::memory_order_relaxed );
+    if ( dropped > 0 )
+    {
+        static const char* kFormat = "Warning : %llu log messages were dropped.\n";
+
+        LogSlot slot;
+        slot.Header.Time        = GetLogTime();
+        slot.Header.pFormat     = kFormat;
+        slot.Header.ThreadId    = GetLogThreadId();
+        slot.Header.Level       = uint8_t( LogLevel::Warning );
+        slot.Header.Wide        = 0;
+        slot.Header.ArgSize     = uint16_t( PackValues( slot.Args, LogSlot::kArgCapacity, kFormat, static_cast<unsigned long long>( dropped ) ) );
+        Dispatch( slot );
+
+        m_DropTotal.fetch_add( dropped, std::memory_order_relaxed );
+        count++;
+    }
+
+    if ( count > 0 )
+    { FlushSinks(); }
+
+    t_InsideLogger = inside;
+    return ( count > 0 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      書式化してシンクに出力します.
+//-------------------------------------------------------------------------------------------------
+void SystemLogger::Dispatch( LogSlot& slot )
+{
+    auto& header = slot.Header;
+
+    // 文字列を必要とするシンクがなければ書式化を省略します.
+    auto requireText = ( m_pConsoleSink != nullptr || m_pFileSink != nullptr || m_pHistorySink != nullptr );
+    for( auto& pSink : m_Sinks )
+    { requireText |= pSink->RequireText(); }
+
+    // 書式化.
+    m_Text.clear();
+    if ( !requireText )
+    { /* DO_NOTHING */ }
+    else if ( header.Wide )
+    {
+        auto itr = m_WideFormats.find( header.pFormat );
+        if ( itr == m_WideFormats.end() )
+        {
+            auto format = static_cast<const wchar_t*>( header.pFormat );
+            itr = m_WideFormats.emplace( header.pFormat, ToLogString( format, wcslen( format ) ) ).first;
+        }
+        FormatLogArgs( itr->second.c_str(), slot.Args, header.ArgSize, m_Text );
+    }
+    else
+    {
+        FormatLogArgs( static_cast<const char*>( header.pFormat ), slot.Args, header.ArgSize, m_Text );
+    }
+
+    LogRecord record;
+    record.Level        = LogLevel( header.Level );
+    record.ThreadId     = header.ThreadId;
+    record.Time         = header.Time;
+    record.Wide         = ( header.Wide != 0 );
+    record.pFormat      = header.pFormat;
+    record.pArgs        = slot.Args;
+    record.ArgSize      = header.ArgSize;
+    record.pText        = ( requireText ) ? m_Text.c_str() : nullptr;
+    record.TextLength   = m_Text.size();
+
+    if ( m_pConsoleSink != nullptr )
+    { m_pConsoleSink->OnLog( record ); }
+
+    if ( m_pFileSink != nullptr )
+    { m_pFileSink->OnLog( record ); }
+
+    if ( m_pHistorySink != nullptr )
+    { m_pHistorySink->OnLog( record ); }
+
+    for( auto& pSink : m_Sinks )
+    { pSink->OnLog( record ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      シンクをフラッシュします.
+//-------------------------------------------------------------------------------------------------
+void SystemLogger::FlushSinks()
+{
+    if ( m_pConsoleSink != nullptr )
+    { m_pConsoleSink->OnFlush(); }
+
+    if ( m_pFileSink != nullptr )
+    { m_pFileSink->OnFlush(); }
+
+    for( auto& pSink : m_Sinks )
+    { pSink->OnFlush(); }
+}
+
 } // namespace asdx
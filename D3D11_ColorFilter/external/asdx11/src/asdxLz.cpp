@@ -0,0 +1,372 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxLz.cpp
+// Desc : Fast LZ Codec.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxLz.h>
+#include <cstring>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const size_t     kMinMatch       = 4;            // 最小一致長です.
+static const size_t     kLastLiterals   = 5;            // 末尾でリテラルとして残すバイト数です.
+static const size_t     kMatchFindLimit = 12;           // 末尾からこの範囲では一致を探しません.
+static const size_t     kMaxDistance    = 65535;        // 最大参照距離です.
+static const size_t     kMaxInputSize   = 0x7E000000;   // 最大入力サイズです.
+static const uint32_t   kHashLog        = 14;           // ハッシュテーブルのビット数です.
+static const uint32_t   kSkipTrigger    = 6;            // 一致が見つからない場合に探索間隔を広げる速さです.
+static const uint32_t   kRunMask        = 15;           // トークンに格納できる長さの最大値です.
+static const size_t     kWildCopyLength = 16;           // 展開時に固定長でコピーするバイト数です.
+
+//-------------------------------------------------------------------------------------------------
+//      4バイト読み込みます.
+//-------------------------------------------------------------------------------------------------
+inline uint32_t Read32( const uint8_t* p )
+{
+    uint32_t value;
+    memcpy( &value, p, sizeof(value) );
+    return value;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      8バイト読み込みます.
+//-------------------------------------------------------------------------------------------------
+inline uint64_t Read64( const uint8_t* p )
+{
+    uint64_t value;
+    memcpy( &value, p, sizeof(value) );
+    return value;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      4バイトのハッシュ値を計算します.
+//-------------------------------------------------------------------------------------------------
+inline uint32_t HashSequence( uint32_t value )
+{ return ( value * 2654435761u ) >> ( 32 - kHashLog ); }
+
+//-------------------------------------------------------------------------------------------------
+//      一致するバイト数を数えます.
+//-------------------------------------------------------------------------------------------------
+inline size_t CountMatch( const uint8_t* pIn, const uint8_t* pMatch, const uint8_t* pLimit )
+{
+    auto pStart = pIn;
+
+    // 8バイト単位で比較し, 最初に異なるバイトを下位から探します (リトルエンディアン前提).
+    while ( pIn + 8 <= pLimit )
+    {
+        auto diff = Read64( pIn ) ^ Read64( pMatch );
+        if ( diff != 0 )
+        {
+            while ( ( diff & 0xFF ) == 0 )
+            {
+                diff >>= 8;
+                pIn++;
+            }
+            return size_t( pIn - pStart );
+        }
+
+        pIn    += 8;
+        pMatch += 8;
+    }
+
+    while ( pIn < pLimit && *pIn == *pMatch )
+    {
+        pIn++;
+        pMatch++;
+    }
+
+    return size_t( pIn - pStart );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      トークンに収まらない長さを書き出します.
+//-------------------------------------------------------------------------------------------------
+inline uint8_t* WriteLength( uint8_t* pOut, size_t length )
+{
+    while ( length >= 255 )
+    {
+        *pOut++ = 255;
+        length -= 255;
+    }
+
+    *pOut++ = static_cast<uint8_t>( length );
+    return pOut;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      トークンに収まらない長さを読み込みます.
+//-------------------------------------------------------------------------------------------------
+inline bool ReadLength( const uint8_t*& pIn, const uint8_t* pEnd, size_t& length )
+{
+    uint8_t value;
+    do
+    {
+        if ( pIn >= pEnd )
+        { return false; }
+
+        value   = *pIn++;
+        length += value;
+
+        if ( length > kMaxInputSize )
+        { return false; }
+    }
+    while ( value == 255 );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      1シーケンスの最大出力サイズを求めます.
+//-------------------------------------------------------------------------------------------------
+inline size_t GetSequenceBound( size_t literalLength, size_t matchLength )
+{ return 1 + literalLength / 255 + 1 + literalLength + 2 + matchLength / 255 + 1; }
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+//      圧縮後の最大サイズを取得します.
+//-------------------------------------------------------------------------------------------------
+size_t LzCompressBound( size_t srcSize )
+{ return srcSize + srcSize / 255 + 16; }
+
+//-------------------------------------------------------------------------------------------------
+//      LZ4 ブロック形式で圧縮します.
+//-------------------------------------------------------------------------------------------------
+size_t LzCompress( const uint8_t* pSrc, size_t srcSize, uint8_t* pDst, size_t dstCapacity )
+{
+    if ( ( pSrc == nullptr && srcSize > 0 ) || pDst == nullptr || srcSize > kMaxInputSize )
+    { return 0; }
+
+    auto pIn     = pSrc;
+    auto pAnchor = pSrc;
+    auto pInEnd  = pSrc + srcSize;
+    auto pOut    = pDst;
+    auto pOutEnd = pDst + dstCapacity;
+
+    // 短い入力は全てリテラルとして出力します.
+    if ( srcSize > kMatchFindLimit )
+    {
+        std::vector<uint32_t> table( size_t( 1 ) << kHashLog, 0 );
+
+        auto pFindLimit  = pInEnd - kMatchFindLimit;
+        auto pMatchLimit = pInEnd - kLastLiterals;
+
+        table[ HashSequence( Read32( pIn ) ) ] = 0;
+        pIn++;
+
+        for ( ;; )
+        {
+            // 一致を探します. 見つからない間は探索間隔を徐々に広げます.
+            const uint8_t* pMatch = nullptr;
+            uint32_t attempts = 1u << kSkipTrigger;
+            while ( pIn < pFindLimit )
+            {
+                auto hash = HashSequence( Read32( pIn ) );
+                auto pRef = pSrc + table[hash];
+                table[hash] = uint32_t( pIn - pSrc );
+
+                if ( pRef < pIn && size_t( pIn - pRef ) <= kMaxDistance && Read32( pRef ) == Read32( pIn ) )
+                {
+                    pMatch = pRef;
+                    break;
+                }
+
+                pIn += attempts++ >> kSkipTrigger;
+            }
+
+            if ( pMatch == nullptr )
+            { break; }
+
+            // 直前のリテラルと一致する分だけ後方に伸ばします.
+            while ( pIn > pAnchor && pMatch > pSrc && pIn[-1] == pMatch[-1] )
+            {
+                pIn--;
+                pMatch--;
+            }
+
+            auto literalLength = size_t( pIn - pAnchor );
+            auto matchLength   = kMinMatch + CountMatch( pIn + kMinMatch, pMatch + kMinMatch, pMatchLimit );
+
+            if ( size_t( pOutEnd - pOut ) < GetSequenceBound( literalLength, matchLength ) )
+            { return 0; }
+
+            auto pToken = pOut++;
+            if ( literalLength >= kRunMask )
+            {
+                *pToken = uint8_t( kRunMask << 4 );
+                pOut = WriteLength( pOut, literalLength - kRunMask );
+            }
+            else
+            { *pToken = uint8_t( literalLength << 4 ); }
+
+            memcpy( pOut, pAnchor, literalLength );
+            pOut += literalLength;
+
+            auto offset = size_t( pIn - pMatch );
+            *pOut++ = uint8_t( offset & 0xFF );
+            *pOut++ = uint8_t( offset >> 8 );
+
+            auto length = matchLength - kMinMatch;
+            if ( length >= kRunMask )
+            {
+                *pToken |= uint8_t( kRunMask );
+                pOut = WriteLength( pOut, length - kRunMask );
+            }
+            else
+            { *pToken |= uint8_t( length ); }
+
+            pIn    += matchLength;
+            pAnchor = pIn;
+
+            if ( pIn >= pFindLimit )
+            { break; }
+
+            // 一致の末尾付近も登録しておくと, 続く一致を見つけやすくなります.
+            auto pPrev = pIn - 2;
+            table[ HashSequence( Read32( pPrev ) ) ] = uint32_t( pPrev - pSrc );
+        }
+    }
+
+    // 残りは最後のシーケンスとしてリテラルのみ出力します.
+    auto literalLength = size_t( pInEnd - pAnchor );
+    if ( size_t( pOutEnd - pOut ) < 1 + literalLength / 255 + 1 + literalLength )
+    { return 0; }
+
+    if ( literalLength >= kRunMask )
+    {
+        *pOut++ = uint8_t( kRunMask << 4 );
+        pOut = WriteLength( pOut, literalLength - kRunMask );
+    }
+    else
+    { *pOut++ = uint8_t( literalLength << 4 ); }
+
+    if ( literalLength > 0 )
+    {
+        memcpy( pOut, pAnchor, literalLength );
+        pOut += literalLength;
+    }
+
+    return size_t( pOut - pDst );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      LZ4 ブロック形式のデータを展開します.
+//-------------------------------------------------------------------------------------------------
+bool LzDecompress( const uint8_t* pSrc, size_t srcSize, uint8_t* pDst, size_t dstSize )
+{
+    if ( pSrc == nullptr || srcSize == 0 || ( pDst == nullptr && dstSize > 0 ) )
+    { return false; }
+
+    auto pIn     = pSrc;
+    auto pInEnd  = pSrc + srcSize;
+    auto pOut    = pDst;
+    auto pOutEnd = pDst + dstSize;
+
+    for ( ;; )
+    {
+        auto token = *pIn++;
+
+        size_t literalLength = token >> 4;
+        if ( literalLength == kRunMask && !ReadLength( pIn, pInEnd, literalLength ) )
+        { return false; }
+
+        if ( literalLength > size_t( pInEnd - pIn ) || literalLength > size_t( pOutEnd - pOut ) )
+        { return false; }
+
+        // 短いリテラルは固定長でコピーします. はみ出した分は後続の出力で上書きされます.
+        if ( literalLength <= kWildCopyLength
+          && size_t( pInEnd  - pIn  ) >= kWildCopyLength
+          && size_t( pOutEnd - pOut ) >= kWildCopyLength )
+        { memcpy( pOut, pIn, kWildCopyLength ); }
+        else if ( literalLength > 0 )
+        { memcpy( pOut, pIn, literalLength ); }
+
+        pIn  += literalLength;
+        pOut += literalLength;
+
+        // 最後のシーケンスはリテラルのみです.
+        if ( pIn == pInEnd )
+        { break; }
+
+        if ( pInEnd - pIn < 2 )
+        { return false; }
+
+        auto offset = size_t( pIn[0] ) | ( size_t( pIn[1] ) << 8 );
+        pIn += 2;
+
+        if ( offset == 0 || offset > size_t( pOut - pDst ) )
+        { return false; }
+
+        size_t matchLength = token & kRunMask;
+        if ( matchLength == kRunMask && !ReadLength( pIn, pInEnd, matchLength ) )
+        { return false; }
+
+        matchLength += kMinMatch;
+        if ( matchLength > size_t( pOutEnd - pOut ) )
+        { return false; }
+
+        // 参照元と出力先が重なる場合は, 重ならない単位でコピーします.
+        auto pMatch = pOut - offset;
+        auto space  = size_t( pOutEnd - pOut );
+        if ( offset >= kWildCopyLength && space >= matchLength + kWildCopyLength )
+        {
+            // 固定長単位で切り上げてコピーします. 出力先の末尾に余裕があることは確認済みです.
+            memcpy( pOut, pMatch, kWildCopyLength );
+            for ( auto i = kWildCopyLength; i < matchLength; i += kWildCopyLength )
+            { memcpy( pOut + i, pMatch + i, kWildCopyLength ); }
+        }
+        else if ( offset >= 8 && space >= matchLength + 8 )
+        {
+            for ( size_t i = 0; i < matchLength; i += 8 )
+            { memcpy( pOut + i, pMatch + i, 8 ); }
+        }
+        else if ( space >= matchLength + kWildCopyLength )
+        {
+            // 参照距離の倍数だけ離れた位置は同じ値になるので, 8バイト以上離れた位置から8バイト単位でコピーします.
+            auto step = offset * ( ( 8 + offset - 1 ) / offset );
+            for ( size_t i = 0; i < step; ++i )
+            { pOut[i] = pMatch[i]; }
+            for ( auto i = step; i < matchLength; i += 8 )
+            { memcpy( pOut + i, pOut + i - step, 8 ); }
+        }
+        else if ( offset >= matchLength )
+        { memcpy( pOut, pMatch, matchLength ); }
+        else if ( offset == 1 )
+        { memset( pOut, *pMatch, matchLength ); }
+        else if ( offset >= 8 )
+        {
+            size_t i = 0;
+            for ( ; i + 8 <= matchLength; i += 8 )
+            { memcpy( pOut + i, pMatch + i, 8 ); }
+            for ( ; i < matchLength; ++i )
+            { pOut[i] = pMatch[i]; }
+        }
+        else
+        {
+            for ( size_t i = 0; i < matchLength; ++i )
+            { pOut[i] = pMatch[i]; }
+        }
+
+        pOut += matchLength;
+
+        // 一致の後には必ず次のシーケンスが続きます.
+        if ( pIn >= pInEnd )
+        { return false; }
+    }
+
+    return pOut == pOutEnd;
+}
+
+} // namespace asdx
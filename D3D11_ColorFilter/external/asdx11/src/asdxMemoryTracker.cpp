@@ -0,0 +1,441 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxMemoryTracker.cpp
+// Desc : Tagged Memory Tracker.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMemoryTracker.h>
+#include <asdxLogger.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const char* kTagNames[] = {
+    "Default",
+    "Texture",
+    "Mesh",
+    "Font",
+    "Shader",
+    "GUI",
+    "Temp",
+};
+static_assert( sizeof(kTagNames) / sizeof(kTagNames[0]) == asdx::HEAP_TAG_TEMP + 1, "Tag name count mismatch." );
+
+//-------------------------------------------------------------------------------------------------
+//      サイズ分布のビン番号を求めます.
+//-------------------------------------------------------------------------------------------------
+inline uint32_t GetHistogramIndex( size_t size )
+{
+    uint32_t index = 0;
+    while( size > 1 && index + 1 < asdx::MemoryTracker::kHistogramCount )
+    {
+        size >>= 1;
+        index++;
+    }
+    return index;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      JSON 文字列としてエスケープして出力します.
+//-------------------------------------------------------------------------------------------------
+void WriteJsonString( FILE* pFile, const char* value )
+{
+    fputc( '"', pFile );
+    for( auto p = value; *p != '\0'; ++p )
+    {
+        switch( *p )
+        {
+        case '"':  fputs( "\\\"", pFile ); break;
+        case '\\': fputs( "\\\\", pFile ); break;
+        default:
+            if ( static_cast<unsigned char>( *p ) < 0x20 )
+            { fprintf( pFile, "\\u%04x", *p ); }
+            else
+            { fputc( *p, pFile ); }
+            break;
+        }
+    }
+    fputc( '"', pFile );
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MemoryTracker class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+const uint32_t MemoryTracker::kHistogramCount;
+std::atomic<bool> MemoryTracker::s_Enable( true );
+
+//-------------------------------------------------------------------------------------------------
+//      呼び出し元の大小を比較します.
+//-------------------------------------------------------------------------------------------------
+bool MemoryTracker::CallsiteKey::operator < ( const CallsiteKey& value ) const
+{
+    if ( Line != value.Line )
+    { return Line < value.Line; }
+
+    if ( Tag != value.Tag )
+    { return Tag < value.Tag; }
+
+    // 同じファイルでも翻訳単位ごとに __FILE__ のアドレスが異なるため内容で比較します.
+    return strcmp( File, value.File ) < 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+MemoryTracker::MemoryTracker()
+: m_ExitReport( false )
+{
+    for( auto i=0u; i<HEAP_TAG_COUNT; ++i )
+    { m_TagStats[i] = MemoryTagStats(); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      シングルトンインスタンスを取得します.
+//-------------------------------------------------------------------------------------------------
+MemoryTracker& MemoryTracker::GetInstance()
+{
+    // 静的オブジェクトの破棄中に行われる解放も記録できるよう破棄しません.
+    static MemoryTracker* s_pInstance = new MemoryTracker();
+    return *s_pInstance;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      記録の有効/無効を設定します.
+//-------------------------------------------------------------------------------------------------
+void MemoryTracker::SetEnable( bool value )
+{ s_Enable.store( value, std::memory_order_relaxed ); }
+
+//-------------------------------------------------------------------------------------------------
+//      確保を記録します.
+//-------------------------------------------------------------------------------------------------
+void MemoryTracker::OnAlloc( const void* ptr, size_t size, uint32_t tag, const char* file, int line )
+{
+    if ( ptr == nullptr )
+    { return; }
+
+    if ( tag >= HEAP_TAG_COUNT )
+    { tag = HEAP_TAG_DEFAULT; }
+
+    std::lock_guard<std::mutex> locker( m_Lock );
+
+    auto index = FindCallsite( file, line, tag );
+
+    // 記録済みのアドレスは解放の記録漏れなので古い記録を差し替えます.
+    auto itr = m_Records.find( ptr );
+    if ( itr != m_Records.end() )
+    {
+        auto& prev = m_Callsites[ itr->second.Callsite ];
+        prev.LiveSize  -= itr->second.Size;
+        prev.LiveCount --;
+
+        auto& stats = m_TagStats[ prev.Tag ];
+        stats.LiveSize  -= itr->second.Size;
+        stats.LiveCount --;
+    }
+
+    Record record;
+    record.Size     = size;
+    record.Callsite = index;
+    m_Records[ptr]  = record;
+
+    auto& callsite = m_Callsites[index];
+    callsite.LiveSize  += size;
+    callsite.LiveCount ++;
+    callsite.TotalCount++;
+    callsite.Histogram[ GetHistogramIndex( size ) ]++;
+
+    auto& stats = m_TagStats[tag];
+    stats.LiveSize  += size;
+    stats.LiveCount ++;
+    stats.TotalCount++;
+    if ( stats.LiveSize > stats.PeakSize )
+    { stats.PeakSize = stats.LiveSize; }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      解放を記録します.
+//-------------------------------------------------------------------------------------------------
+void MemoryTracker::OnFree( const void* ptr )
+{
+    if ( ptr == nullptr )
+    { return; }
+
+    std::lock_guard<std::mutex> locker( m_Lock );
+
+    auto itr = m_Records.find( ptr );
+    if ( itr == m_Records.end() )
+    { return; }
+
+    auto& callsite = m_Callsites[ itr->second.Callsite ];
+    callsite.LiveSize  -= itr->second.Size;
+    callsite.LiveCount --;
+
+    auto& stats = m_TagStats[ callsite.Tag ];
+    stats.LiveSize  -= itr->second.Size;
+    stats.LiveCount --;
+
+    m_Records.erase( itr );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      確保の失敗を記録します.
+//-------------------------------------------------------------------------------------------------
+void MemoryTracker::OnAllocFailed( size_t size, uint32_t tag, const char* file, int line )
+{
+    if ( tag >= HEAP_TAG_COUNT )
+    { tag = HEAP_TAG_DEFAULT; }
+
+    MemoryTagStats stats[HEAP_TAG_COUNT];
+    {
+        std::lock_guard<std::mutex> locker( m_Lock );
+        m_TagStats[tag].FailCount++;
+
+        for( auto i=0u; i<HEAP_TAG_COUNT; ++i )
+        { stats[i] = m_TagStats[i]; }
+    }
+
+    ELOGA( "Error : Out of Memory. tag = %s, size = %zu, file = %s, line = %d",
+        GetHeapTagName( tag ), size, file, line );
+
+    for( auto i=0u; i<HEAP_TAG_COUNT; ++i )
+    {
+        if ( stats[i].TotalCount == 0 )
+        { continue; }
+
+        ILOGA( "    %-8s live = %zu bytes (%llu allocs), peak = %zu bytes",
+            GetHeapTagName( i ), stats[i].LiveSize, (unsigned long long)stats[i].LiveCount, stats[i].PeakSize );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      タグごとの統計情報を取得します.
+//-------------------------------------------------------------------------------------------------
+MemoryTagStats MemoryTracker::GetTagStats( uint32_t tag ) const
+{
+    if ( tag >= HEAP_TAG_COUNT )
+    { return MemoryTagStats(); }
+
+    std::lock_guard<std::mutex> locker( m_Lock );
+    return m_TagStats[tag];
+}
+
+//-------------------------------------------------------------------------------------------------
+//      記録内容を JSON 形式でファイルに出力します.
+//-------------------------------------------------------------------------------------------------
+bool MemoryTracker::DumpJson( const char* path ) const
+{
+    if ( path == nullptr )
+    {
+        ELOGA( "Error : Invalid Argument." );
+        return false;
+    }
+
+    FILE* pFile = nullptr;
+    auto err = fopen_s( &pFile, path, "w" );
+    if ( err != 0 || pFile == nullptr )
+    {
+        ELOGA( "Error : File Open Failed. path = %s", path );
+        return false;
+    }
+
+    std::lock_guard<std::mutex> locker( m_Lock );
+
+    fprintf( pFile, "{\n  \"tags\": [\n" );
+    auto first = true;
+    for( auto i=0u; i<HEAP_TAG_COUNT; ++i )
+    {
+        auto& stats = m_TagStats[i];
+        if ( stats.TotalCount == 0 && stats.FailCount == 0 )
+        { continue; }
+
+        fprintf( pFile, "%s    { \"name\": ", first ? "" : ",\n" );
+        WriteJsonString( pFile, GetHeapTagName( i ) );
+        fprintf( pFile, ", \"live_bytes\": %zu, \"peak_bytes\": %zu, \"live_count\": %llu, \"total_count\": %llu, \"fail_count\": %llu }",
+            stats.LiveSize,
+            stats.PeakSize,
+            (unsigned long long)stats.LiveCount,
+            (unsigned long long)stats.TotalCount,
+            (unsigned long long)stats.FailCount );
+        first = false;
+    }
+
+    fprintf( pFile, "\n  ],\n  \"callsites\": [\n" );
+    first = true;
+    for( size_t i=0; i<m_Callsites.size(); ++i )
+    {
+        auto& callsite = m_Callsites[i];
+
+        fprintf( pFile, "%s    { \"file\": ", first ? "" : ",\n" );
+        WriteJsonString( pFile, callsite.File );
+        fprintf( pFile, ", \"line\": %d, \"tag\": ", callsite.Line );
+        WriteJsonString( pFile, GetHeapTagName( callsite.Tag ) );
+        fprintf( pFile, ", \"live_bytes\": %zu, \"live_count\": %llu, \"total_count\": %llu, \"histogram\": [",
+            callsite.LiveSize,
+            (unsigned long long)callsite.LiveCount,
+            (unsigned long long)callsite.TotalCount );
+
+        // 末尾の 0 は省略します.
+        auto last = kHistogramCount;
+        while( last > 0 && callsite.Histogram[last - 1] == 0 )
+        { last--; }
+
+        for( auto j=0u; j<last; ++j )
+        { fprintf( pFile, "%s%llu", ( j == 0 ) ? "" : ", ", (unsigned long long)callsite.Histogram[j] ); }
+
+        fprintf( pFile, "] }" );
+        first = false;
+    }
+
+    fprintf( pFile, "\n  ]\n}\n" );
+    fclose( pFile );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      解放されていないメモリを呼び出し元ごとにログへ出力します.
+//-------------------------------------------------------------------------------------------------
+uint64_t MemoryTracker::ReportLeaks() const
+{
+    std::vector<Callsite> leaks;
+    {
+        std::lock_guard<std::mutex> locker( m_Lock );
+        for( auto& callsite : m_Callsites )
+        {
+            if ( callsite.LiveCount > 0 )
+            { leaks.push_back( callsite ); }
+        }
+    }
+
+    if ( leaks.empty() )
+    {
+        ILOGA( "Info : No Memory Leaks." );
+        return 0;
+    }
+
+    // サイズの大きい順に出力します.
+    std::sort( leaks.begin(), leaks.end(), []( const Callsite& lhs, const Callsite& rhs )
+    { return lhs.LiveSize > rhs.LiveSize; } );
+
+    uint64_t count = 0;
+    size_t   size  = 0;
+    for( auto& leak : leaks )
+    {
+        count += leak.LiveCount;
+        size  += leak.LiveSize;
+    }
+
+    WLOGA( "Warning : Memory Leaks Detected. count = %llu, size = %zu bytes", (unsigned long long)count, size );
+    for( auto& leak : leaks )
+    {
+        WLOGA( "    %s(%d) : tag = %s, count = %llu, size = %zu bytes",
+            leak.File, leak.Line, GetHeapTagName( leak.Tag ), (unsigned long long)leak.LiveCount, leak.LiveSize );
+    }
+
+    return count;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      終了時にレポートするよう設定します.
+//-------------------------------------------------------------------------------------------------
+void MemoryTracker::SetExitReport( const char* path )
+{
+    std::lock_guard<std::mutex> locker( m_Lock );
+
+    m_ExitPath = ( path != nullptr ) ? path : "";
+
+    if ( !m_ExitReport )
+    {
+        m_ExitReport = true;
+        std::atexit( &MemoryTracker::OnExit );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      全ての記録を破棄します.
+//-------------------------------------------------------------------------------------------------
+void MemoryTracker::Reset()
+{
+    std::lock_guard<std::mutex> locker( m_Lock );
+
+    m_Records.clear();
+    m_CallsiteMap.clear();
+    m_Callsites.clear();
+
+    for( auto i=0u; i<HEAP_TAG_COUNT; ++i )
+    { m_TagStats[i] = MemoryTagStats(); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      呼び出し元の番号を取得します. ロック取得済みの状態で呼び出します.
+//-------------------------------------------------------------------------------------------------
+uint32_t MemoryTracker::FindCallsite( const char* file, int line, uint32_t tag )
+{
+    CallsiteKey key;
+    key.File = ( file != nullptr ) ? file : "unknown";
+    key.Line = line;
+    key.Tag  = tag;
+
+    auto itr = m_CallsiteMap.find( key );
+    if ( itr != m_CallsiteMap.end() )
+    { return itr->second; }
+
+    Callsite callsite = {};
+    callsite.File = key.File;
+    callsite.Line = line;
+    callsite.Tag  = tag;
+
+    auto index = uint32_t( m_Callsites.size() );
+    m_Callsites.push_back( callsite );
+    m_CallsiteMap[key] = index;
+
+    return index;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      終了時の処理です.
+//-------------------------------------------------------------------------------------------------
+void MemoryTracker::OnExit()
+{
+    auto& instance = GetInstance();
+
+    std::string path;
+    {
+        std::lock_guard<std::mutex> locker( instance.m_Lock );
+        path = instance.m_ExitPath;
+    }
+
+    if ( !path.empty() )
+    { instance.DumpJson( path.c_str() ); }
+
+    instance.ReportLeaks();
+}
+
+
+//-------------------------------------------------------------------------------------------------
+//      タグ名を取得します.
+//-------------------------------------------------------------------------------------------------
+const char* GetHeapTagName( uint32_t tag )
+{
+    if ( tag < sizeof(kTagNames) / sizeof(kTagNames[0]) )
+    { return kTagNames[tag]; }
+
+    return "Unknown";
+}
+
+} // namespace asdx
@@ -0,0 +1,508 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxPoolAllocator.cpp
+// Desc : Lock Free Fixed Size Pool Allocator.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxPoolAllocator.h>
+#include <asdxLogger.h>
+#include <cassert>
+#include <cstdlib>
+
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const size_t     kBlockAlignment = 16;       // ブロックのアライメントです.
+static const uint32_t   kCacheSize      = 64;       // スレッドキャッシュの1クラスあたりの最大数です.
+static const uint32_t   kBatchSize      = 32;       // スレッドキャッシュとプール間で移動する数です.
+static const size_t     kClassSizes[asdx::PoolAllocator::kClassCount] = {
+    16, 32, 48, 64, 96, 128, 192, 256
+};
+
+//-------------------------------------------------------------------------------------------------
+//      アライメントを指定してメモリを確保します.
+//-------------------------------------------------------------------------------------------------
+void* AlignedAlloc( size_t size, size_t alignment )
+{
+#if defined(_MSC_VER)
+    return _aligned_malloc( size, alignment );
+#else
+    void* ptr = nullptr;
+    if ( posix_memalign( &ptr, alignment, size ) != 0 )
+    { return nullptr; }
+    return ptr;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      AlignedAlloc() で確保したメモリを解放します.
+//-------------------------------------------------------------------------------------------------
+void AlignedFree( void* ptr )
+{
+#if defined(_MSC_VER)
+    _aligned_free( ptr );
+#else
+    free( ptr );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      2の累乗に切り上げます.
+//-------------------------------------------------------------------------------------------------
+size_t RoundUpPow2( size_t value )
+{
+    size_t result = 1;
+    while( result < value )
+    { result <<= 1; }
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      タグ付きの先頭値を生成します.
+//-------------------------------------------------------------------------------------------------
+inline uint64_t MakeHead( uint64_t prev, uint32_t link )
+{ return ( ( ( prev >> 32 ) + 1 ) << 32 ) | link; }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ThreadCache structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ThreadCache
+{
+    void*       Blocks[asdx::PoolAllocator::kClassCount][kCacheSize];   //!< キャッシュしているブロックです.
+    uint32_t    Count [asdx::PoolAllocator::kClassCount];               //!< キャッシュしている数です.
+
+    ThreadCache()
+    {
+        for( auto i=0u; i<asdx::PoolAllocator::kClassCount; ++i )
+        { Count[i] = 0; }
+    }
+
+    ~ThreadCache()
+    { asdx::PoolAllocator::GetInstance().FlushThreadCache(); }
+};
+
+thread_local ThreadCache t_Cache;
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FixedPool class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+const uint32_t FixedPool::kMaxSlabCount;
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+FixedPool::FixedPool()
+: m_Head            ( 0 )
+, m_SlabCount       ( 0 )
+, m_InUse           ( 0 )
+, m_PeakInUse       ( 0 )
+, m_BlockSize       ( 0 )
+, m_SlabSize        ( 0 )
+, m_BlocksPerSlab   ( 0 )
+{
+    for( auto i=0u; i<kMaxSlabCount; ++i )
+    { m_Slabs[i].store( nullptr, std::memory_order_relaxed ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+FixedPool::~FixedPool()
+{ Term(); }
+
+//-------------------------------------------------------------------------------------------------
+//      初期化処理を行います.
+//-------------------------------------------------------------------------------------------------
+bool FixedPool::Init( size_t blockSize, size_t slabSize )
+{
+    Term();
+
+    if ( blockSize == 0 )
+    {
+        ELOGA( "Error : Invalid Argument." );
+        return false;
+    }
+
+    m_BlockSize = ( blockSize + kBlockAlignment - 1 ) & ~( kBlockAlignment - 1 );
+    m_SlabSize  = RoundUpPow2( slabSize );
+
+    // ヘッダとリンク配列を除いた領域にブロックを詰めます. 少なすぎる場合はスラブを大きくします.
+    for(;;)
+    {
+        auto header = ( sizeof(Slab) + kBlockAlignment - 1 ) & ~( kBlockAlignment - 1 );
+        auto count  = ( m_SlabSize - header - kBlockAlignment ) / ( m_BlockSize + sizeof(uint32_t) );
+        if ( count >= 8 )
+        {
+            m_BlocksPerSlab = uint32_t( count );
+            break;
+        }
+
+        m_SlabSize <<= 1;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      終了処理を行います.
+//-------------------------------------------------------------------------------------------------
+void FixedPool::Term()
+{
+    auto count = m_SlabCount.load( std::memory_order_acquire );
+    for( auto i=0u; i<count; ++i )
+    {
+        auto pSlab = m_Slabs[i].exchange( nullptr, std::memory_order_relaxed );
+        if ( pSlab != nullptr )
+        {
+            pSlab->~Slab();
+            AlignedFree( pSlab );
+        }
+    }
+
+    m_Head     .store( 0, std::memory_order_relaxed );
+    m_SlabCount.store( 0, std::memory_order_relaxed );
+    m_InUse    .store( 0, std::memory_order_relaxed );
+    m_PeakInUse.store( 0, std::memory_order_relaxed );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ブロックを確保します.
+//-------------------------------------------------------------------------------------------------
+void* FixedPool::Alloc()
+{
+    void* ptr = nullptr;
+    return ( AllocBatch( &ptr, 1 ) == 1 ) ? ptr : nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ブロックを解放します.
+//-------------------------------------------------------------------------------------------------
+void FixedPool::Free( void* ptr )
+{
+    if ( ptr == nullptr )
+    { return; }
+
+    FreeBatch( &ptr, 1 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      複数のブロックをまとめて確保します.
+//-------------------------------------------------------------------------------------------------
+uint32_t FixedPool::AllocBatch( void** ppBlocks, uint32_t count )
+{
+    if ( m_BlockSize == 0 || count == 0 )
+    { return 0; }
+
+    for(;;)
+    {
+        auto head = m_Head.load( std::memory_order_acquire );
+        auto link = uint32_t( head );
+        if ( link == 0 )
+        {
+            if ( !Grow() )
+            { return 0; }
+            continue;
+        }
+
+        // 先頭から count 個たどります. 途中で他スレッドが操作した場合はタグが変わり CAS が失敗します.
+        uint32_t taken = 0;
+        auto     next  = link;
+        while( next != 0 && taken < count )
+        {
+            ppBlocks[taken++] = GetBlock( next - 1 );
+            next = GetNext( next - 1 ).load( std::memory_order_relaxed );
+        }
+
+        if ( m_Head.compare_exchange_weak( head, MakeHead( head, next ), std::memory_order_acq_rel ) )
+        {
+            AddInUse( taken );
+            return taken;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      複数のブロックをまとめて解放します.
+//-------------------------------------------------------------------------------------------------
+void FixedPool::FreeBatch( void* const* ppBlocks, uint32_t count )
+{
+    if ( count == 0 )
+    { return; }
+
+    // 渡されたブロックを1本のリストにつないでから先頭に積みます.
+    auto first = GetIndex( ppBlocks[0] );
+    auto prev  = first;
+    for( auto i=1u; i<count; ++i )
+    {
+        auto index = GetIndex( ppBlocks[i] );
+        GetNext( prev ).store( index + 1, std::memory_order_relaxed );
+        prev = index;
+    }
+
+    Push( first, prev );
+    m_InUse.fetch_sub( count, std::memory_order_relaxed );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ブロックサイズを取得します.
+//-------------------------------------------------------------------------------------------------
+size_t FixedPool::GetBlockSize() const
+{ return m_BlockSize; }
+
+//-------------------------------------------------------------------------------------------------
+//      統計情報を取得します.
+//-------------------------------------------------------------------------------------------------
+PoolStats FixedPool::GetStats() const
+{
+    PoolStats result = {};
+    result.BlockSize = m_BlockSize;
+    result.SlabCount = m_SlabCount.load( std::memory_order_acquire );
+    result.Capacity  = uint64_t( result.SlabCount ) * m_BlocksPerSlab;
+    result.InUse     = m_InUse    .load( std::memory_order_relaxed );
+    result.PeakInUse = m_PeakInUse.load( std::memory_order_relaxed );
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      スラブを追加します.
+//-------------------------------------------------------------------------------------------------
+bool FixedPool::Grow()
+{
+    std::lock_guard<std::mutex> locker( m_GrowLock );
+
+    // ロック待ちの間に他スレッドが追加済み, または解放されたブロックがある.
+    if ( uint32_t( m_Head.load( std::memory_order_acquire ) ) != 0 )
+    { return true; }
+
+    auto slabIndex = m_SlabCount.load( std::memory_order_relaxed );
+    if ( slabIndex >= kMaxSlabCount )
+    {
+        ELOGA( "Error : FixedPool Overflow. block size = %zu", m_BlockSize );
+        return false;
+    }
+
+    // スラブは自身のサイズでアライメントし, ブロックのアドレスからヘッダを逆引きできるようにします.
+    auto pMemory = static_cast<uint8_t*>( AlignedAlloc( m_SlabSize, m_SlabSize ) );
+    if ( pMemory == nullptr )
+    {
+        ELOGA( "Error : Out of memory." );
+        return false;
+    }
+
+    auto header = ( sizeof(Slab) + kBlockAlignment - 1 ) & ~( kBlockAlignment - 1 );
+    auto links  = ( sizeof(uint32_t) * m_BlocksPerSlab + kBlockAlignment - 1 ) & ~( kBlockAlignment - 1 );
+
+    auto pSlab = new ( pMemory ) Slab();
+    pSlab->Index   = slabIndex;
+    pSlab->pNext   = reinterpret_cast<std::atomic<uint32_t>*>( pMemory + header );
+    pSlab->pBlocks = pMemory + header + links;
+
+    auto base = slabIndex * m_BlocksPerSlab;
+    for( auto i=0u; i<m_BlocksPerSlab; ++i )
+    {
+        auto link = ( i + 1 < m_BlocksPerSlab ) ? base + i + 2 : 0;
+        new ( &pSlab->pNext[i] ) std::atomic<uint32_t>( link );
+    }
+
+    m_Slabs[slabIndex].store( pSlab, std::memory_order_release );
+    m_SlabCount.store( slabIndex + 1, std::memory_order_release );
+
+    Push( base, base + m_BlocksPerSlab - 1 );
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      first から last までつながったリストをフリーリストの先頭に積みます.
+//-------------------------------------------------------------------------------------------------
+void FixedPool::Push( uint32_t first, uint32_t last )
+{
+    auto head = m_Head.load( std::memory_order_relaxed );
+    for(;;)
+    {
+        GetNext( last ).store( uint32_t( head ), std::memory_order_relaxed );
+        if ( m_Head.compare_exchange_weak( head, MakeHead( head, first + 1 ), std::memory_order_acq_rel ) )
+        { return; }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      次リンクを取得します.
+//-------------------------------------------------------------------------------------------------
+std::atomic<uint32_t>& FixedPool::GetNext( uint32_t index ) const
+{
+    auto pSlab = m_Slabs[index / m_BlocksPerSlab].load( std::memory_order_acquire );
+    return pSlab->pNext[index % m_BlocksPerSlab];
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ブロックのアドレスを取得します.
+//-------------------------------------------------------------------------------------------------
+void* FixedPool::GetBlock( uint32_t index ) const
+{
+    auto pSlab = m_Slabs[index / m_BlocksPerSlab].load( std::memory_order_acquire );
+    return pSlab->pBlocks + size_t( index % m_BlocksPerSlab ) * m_BlockSize;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ブロックのアドレスからインデックスを取得します.
+//-------------------------------------------------------------------------------------------------
+uint32_t FixedPool::GetIndex( const void* ptr ) const
+{
+    auto address = reinterpret_cast<uintptr_t>( ptr );
+    auto pSlab   = reinterpret_cast<const Slab*>( address & ~uintptr_t( m_SlabSize - 1 ) );
+    auto offset  = address - reinterpret_cast<uintptr_t>( pSlab->pBlocks );
+    assert( offset % m_BlockSize == 0 );
+    return pSlab->Index * m_BlocksPerSlab + uint32_t( offset / m_BlockSize );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      払い出し数を加算し, 最大値を更新します.
+//-------------------------------------------------------------------------------------------------
+void FixedPool::AddInUse( uint64_t count )
+{
+    auto value = m_InUse.fetch_add( count, std::memory_order_relaxed ) + count;
+    auto peak  = m_PeakInUse.load( std::memory_order_relaxed );
+    while( value > peak && !m_PeakInUse.compare_exchange_weak( peak, value, std::memory_order_relaxed ) )
+    { /* DO_NOTHING */ }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PoolAllocator class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+const size_t   PoolAllocator::kMaxSize;
+const uint32_t PoolAllocator::kClassCount;
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+PoolAllocator::PoolAllocator()
+: m_LargeAllocCount( 0 )
+{
+    for( auto i=0u; i<kClassCount; ++i )
+    { m_Pools[i].Init( kClassSizes[i] ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      シングルトンインスタンスを取得します.
+//-------------------------------------------------------------------------------------------------
+PoolAllocator& PoolAllocator::GetInstance()
+{
+    // 静的オブジェクトの破棄順に関わらず解放できるよう, インスタンスは破棄しません.
+    static PoolAllocator* s_pInstance = new PoolAllocator();
+    return *s_pInstance;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      メモリを確保します.
+//-------------------------------------------------------------------------------------------------
+void* PoolAllocator::Alloc( size_t size )
+{
+    if ( size > kMaxSize )
+    {
+        m_LargeAllocCount.fetch_add( 1, std::memory_order_relaxed );
+        return ::operator new( size, std::nothrow );
+    }
+
+    auto  index = GetClassIndex( size );
+    auto& cache = t_Cache;
+    auto& count = cache.Count[index];
+
+    if ( count == 0 )
+    { count = m_Pools[index].AllocBatch( cache.Blocks[index], kBatchSize ); }
+
+    if ( count == 0 )
+    { return nullptr; }
+
+    return cache.Blocks[index][--count];
+}
+
+//-------------------------------------------------------------------------------------------------
+//      メモリを解放します.
+//-------------------------------------------------------------------------------------------------
+void PoolAllocator::Free( void* ptr, size_t size )
+{
+    if ( ptr == nullptr )
+    { return; }
+
+    if ( size > kMaxSize )
+    {
+        ::operator delete( ptr );
+        return;
+    }
+
+    auto  index = GetClassIndex( size );
+    auto& cache = t_Cache;
+    auto& count = cache.Count[index];
+
+    // キャッシュが一杯なら古い側の半分をプールに返却します.
+    if ( count == kCacheSize )
+    {
+        m_Pools[index].FreeBatch( cache.Blocks[index], kBatchSize );
+        for( auto i=kBatchSize; i<kCacheSize; ++i )
+        { cache.Blocks[index][i - kBatchSize] = cache.Blocks[index][i]; }
+        count -= kBatchSize;
+    }
+
+    cache.Blocks[index][count++] = ptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      呼び出しスレッドのキャッシュをプールに返却します.
+//-------------------------------------------------------------------------------------------------
+void PoolAllocator::FlushThreadCache()
+{
+    auto& cache = t_Cache;
+    for( auto i=0u; i<kClassCount; ++i )
+    {
+        m_Pools[i].FreeBatch( cache.Blocks[i], cache.Count[i] );
+        cache.Count[i] = 0;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      サイズクラスの統計情報を取得します.
+//-------------------------------------------------------------------------------------------------
+PoolStats PoolAllocator::GetStats( uint32_t classIndex ) const
+{
+    if ( classIndex >= kClassCount )
+    { return PoolStats(); }
+
+    return m_Pools[classIndex].GetStats();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      operator new に委譲した回数を取得します.
+//-------------------------------------------------------------------------------------------------
+uint64_t PoolAllocator::GetLargeAllocCount() const
+{ return m_LargeAllocCount.load( std::memory_order_relaxed ); }
+
+//-------------------------------------------------------------------------------------------------
+//      サイズクラス番号を取得します.
+//-------------------------------------------------------------------------------------------------
+uint32_t PoolAllocator::GetClassIndex( size_t size )
+{
+    // 16byte 単位のサイズからクラス番号を引くテーブルです.
+    static const uint8_t kTable[kMaxSize / 16 + 1] = {
+        0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7
+    };
+    return kTable[( size + 15 ) / 16];
+}
+
+} // namespace asdx
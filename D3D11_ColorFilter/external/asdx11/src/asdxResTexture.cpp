@@ -401,12 +401,9 @@ static WICConvert g_WICCustomConvert[] = {
 #endif
 
 //-------------------------------------------------------------------------------------------------
-static IWICImagingFactory* GetWIC()
+static IWICImagingFactory* CreateWIC()
 {
-    static IWICImagingFactory* s_Factory = nullptr;
-
-    if ( s_Factory )
-        return s_Factory;
+    IWICImagingFactory* pFactory = nullptr;
 
   #if(_WIN32_WINNT >= _WIN32_WINNT_WIN8) || defined(_WIN7_PLATFORM_UPDATE)
     HRESULT hr = CoCreateInstance(
@@ -414,7 +411,7 @@ static IWICImagingFactory* GetWIC()
         nullptr,
         CLSCTX_INPROC_SERVER,
         __uuidof(IWICImagingFactory2),
-        (LPVOID*)&s_Factory
+        (LPVOID*)&pFactory
         );
 
     if ( SUCCEEDED(hr) )
@@ -429,12 +426,12 @@ static IWICImagingFactory* GetWIC()
             nullptr,
             CLSCTX_INPROC_SERVER,
             __uuidof(IWICImagingFactory),
-            (LPVOID*)&s_Factory
+            (LPVOID*)&pFactory
             );
 
         if ( FAILED(hr) )
         {
-            s_Factory = nullptr;
+            pFactory = nullptr;
             return nullptr;
         }
     }
@@ -444,16 +441,24 @@ static IWICImagingFactory* GetWIC()
         nullptr,
         CLSCTX_INPROC_SERVER,
         __uuidof(IWICImagingFactory),
-        (LPVOID*)&s_Factory
+        (LPVOID*)&pFactory
         );
 
     if ( FAILED(hr) )
     {
-        s_Factory = nullptr;
+        pFactory = nullptr;
         return nullptr;
     }
   #endif
 
+    return pFactory;
+}
+
+//-------------------------------------------------------------------------------------------------
+static IWICImagingFactory* GetWIC()
+{
+    // ワーカースレッドからも呼び出されるため, 関数内 static 変数で一度だけ生成します.
+    static IWICImagingFactory* s_Factory = CreateWIC();
     return s_Factory;
 }
 
@@ -1009,7 +1014,7 @@ bool CreateDummyResTexture( asdx::ResTexture& resTexture )
     if ( !resTexture.pResources )
     { return false; }
 
-    resTexture.pResources[0].pPixels = new (std::nothrow) uint8_t [ 4096 ];
+    resTexture.pResources[0].pPixels = ASDX_ALLOC_ASSET( 4096, HEAP_TAG_TEXTURE );
     if ( !resTexture.pResources[0].pPixels )
     {
         SafeDeleteArray( resTexture.pResources );
@@ -1214,7 +1219,7 @@ bool CreateResTextureFromWICFileW( const wchar_t* filename, asdx::ResTexture& re
     size_t imageSize = rowPitch * height;
 
     // ピクセルデータのメモリを確保.
-    uint8_t* pPixels = new (std::nothrow) uint8_t [ imageSize ];
+    uint8_t* pPixels = ASDX_ALLOC_ASSET( imageSize, HEAP_TAG_TEXTURE );
     if ( !pPixels )
     { return false; }
 
@@ -1226,7 +1231,7 @@ bool CreateResTextureFromWICFileW( const wchar_t* filename, asdx::ResTexture& re
         hr = frame->CopyPixels( 0, uint32_t( rowPitch ), uint32_t( imageSize ), pPixels );
         if ( FAILED( hr ) )
         {
-            SafeDeleteArray( pPixels );
+            SafeFreeAssetMemory( pPixels );
             return false;
         }
     }
@@ -1239,14 +1244,14 @@ bool CreateResTextureFromWICFileW( const wchar_t* filename, asdx::ResTexture& re
         hr = pWIC->CreateBitmapScaler( scaler.GetAddressOf() );
         if ( FAILED( hr ) )
         {
-            SafeDeleteArray( pPixels );
+            SafeFreeAssetMemory( pPixels );
             return false;
         }
 
         hr = scaler->Initialize( frame.Get(), width, height, WICBitmapInterpolationModeFant );
         if ( FAILED( hr ) )
         {
-            SafeDeleteArray( pPixels );
+            SafeFreeAssetMemory( pPixels );
             return false;
         }
 
@@ -1254,7 +1259,7 @@ bool CreateResTextureFromWICFileW( const wchar_t* filename, asdx::ResTexture& re
         hr = scaler->GetPixelFormat( &pfScalar );
         if ( FAILED( hr ) )
         {
-            SafeDeleteArray( pPixels );
+            SafeFreeAssetMemory( pPixels );
             return false;
         }
 
@@ -1263,7 +1268,7 @@ bool CreateResTextureFromWICFileW( const wchar_t* filename, asdx::ResTexture& re
             hr = scaler->CopyPixels( 0, uint32_t( rowPitch ), uint32_t( imageSize ), pPixels );
             if ( FAILED( hr ) )
             {
-                SafeDeleteArray( pPixels );
+                SafeFreeAssetMemory( pPixels );
                 return false;
             }
         }
@@ -1273,21 +1278,21 @@ bool CreateResTextureFromWICFileW( const wchar_t* filename, asdx::ResTexture& re
             hr =  pWIC->CreateFormatConverter( conv.GetAddressOf() );
             if ( FAILED( hr ) )
             {
-                SafeDeleteArray( pPixels );
+                SafeFreeAssetMemory( pPixels );
                 return false;
             }
 
             hr = conv->Initialize( scaler.Get(), convertGUID, WICBitmapDitherTypeErrorDiffusion, 0, 0, WICBitmapPaletteTypeCustom );
             if ( FAILED( hr ) )
             {
-                SafeDeleteArray( pPixels );
+                SafeFreeAssetMemory( pPixels );
                 return false;
             }
 
             hr = conv->CopyPixels( 0, uint32_t( rowPitch ), uint32_t( imageSize ), pPixels );
             if ( FAILED( hr ) )
             {
-                SafeDeleteArray( pPixels );
+                SafeFreeAssetMemory( pPixels );
                 return false;
             }
         }
@@ -1301,21 +1306,21 @@ bool CreateResTextureFromWICFileW( const wchar_t* filename, asdx::ResTexture& re
         hr = pWIC->CreateFormatConverter( conv.GetAddressOf() );
         if ( FAILED( hr ) )
         {
-            SafeDeleteArray( pPixels );
+            SafeFreeAssetMemory( pPixels );
             return false;
         }
 
         hr = conv->Initialize( frame.Get(), convertGUID, WICBitmapDitherTypeErrorDiffusion, 0, 0, WICBitmapPaletteTypeCustom );
         if ( FAILED( hr ) )
         {
-            SafeDeleteArray( pPixels );
+            SafeFreeAssetMemory( pPixels );
             return false;
         }
 
         hr = conv->CopyPixels( 0, uint32_t( rowPitch ), uint32_t( imageSize ), pPixels );
         if ( FAILED( hr ) )
         {
-            SafeDeleteArray( pPixels );
+            SafeFreeAssetMemory( pPixels );
             return false;
         }
     }
@@ -1324,7 +1329,7 @@ bool CreateResTextureFromWICFileW( const wchar_t* filename, asdx::ResTexture& re
     asdx::SubResource* pRes = new (std::nothrow) asdx::SubResource();
     if ( !pRes )
     {
-        SafeDeleteArray( pPixels );
+        SafeFreeAssetMemory( pPixels );
         return false;
     }
 
@@ -1547,7 +1552,7 @@ bool CreateResTextureFromWICMemory( const uint8_t* pBinary, const uint32_t buffe
     size_t imageSize = rowPitch * height;
 
     // ピクセルデータのメモリを確保.
-    uint8_t* pPixels = new (std::nothrow) uint8_t [ imageSize ];
+    uint8_t* pPixels = ASDX_ALLOC_ASSET( imageSize, HEAP_TAG_TEXTURE );
     if ( !pPixels )
     { return false; }
 
@@ -1559,7 +1564,7 @@ bool CreateResTextureFromWICMemory( const uint8_t* pBinary, const uint32_t buffe
         hr = frame->CopyPixels( 0, uint32_t( rowPitch ), uint32_t( imageSize ), pPixels );
         if ( FAILED( hr ) )
         {
-            SafeDeleteArray( pPixels );
+            SafeFreeAssetMemory( pPixels );
             return false;
         }
     }
@@ -1572,14 +1577,14 @@ bool CreateResTextureFromWICMemory( const uint8_t* pBinary, const uint32_t buffe
         hr = pWIC->CreateBitmapScaler( scaler.GetAddressOf() );
         if ( FAILED( hr ) )
         {
-            SafeDeleteArray( pPixels );
+            SafeFreeAssetMemory( pPixels );
             return false;
         }
 
         hr = scaler->Initialize( frame.Get(), width, height, WICBitmapInterpolationModeFant );
         if ( FAILED( hr ) )
         {
-            SafeDeleteArray( pPixels );
+            SafeFreeAssetMemory( pPixels );
             return false;
         }
 
@@ -1587,7 +1592,7 @@ bool CreateResTextureFromWICMemory( const uint8_t* pBinary, const uint32_t buffe
         hr = scaler->GetPixelFormat( &pfScalar );
         if ( FAILED( hr ) )
         {
-            SafeDeleteArray( pPixels );
+            SafeFreeAssetMemory( pPixels );
             return false;
         }
 
@@ -1596,7 +1601,7 @@ bool CreateResTextureFromWICMemory( const uint8_t* pBinary, const uint32_t buffe
             hr = scaler->CopyPixels( 0, uint32_t( rowPitch ), uint32_t( imageSize ), pPixels );
             if ( FAILED( hr ) )
             {
-                SafeDeleteArray( pPixels );
+                SafeFreeAssetMemory( pPixels );
                 return false;
             }
         }
@@ -1606,21 +1611,21 @@ bool CreateResTextureFromWICMemory( const uint8_t* pBinary, const uint32_t buffe
             hr =  pWIC->CreateFormatConverter( conv.GetAddressOf() );
             if ( FAILED( hr ) )
             {
-                SafeDeleteArray( pPixels );
+                SafeFreeAssetMemory( pPixels );
                 return false;
             }
 
             hr = conv->Initialize( scaler.Get(), convertGUID, WICBitmapDitherTypeErrorDiffusion, 0, 0, WICBitmapPaletteTypeCustom );
             if ( FAILED( hr ) )
             {
-                SafeDeleteArray( pPixels );
+                SafeFreeAssetMemory( pPixels );
                 return false;
             }
 
             hr = conv->CopyPixels( 0, uint32_t( rowPitch ), uint32_t( imageSize ), pPixels );
             if ( FAILED( hr ) )
             {
-                SafeDeleteArray( pPixels );
+                SafeFreeAssetMemory( pPixels );
                 return false;
             }
         }
@@ -1633,21 +1638,21 @@ bool CreateResTextureFromWICMemory( const uint8_t* pBinary, const uint32_t buffe
         hr = pWIC->CreateFormatConverter( conv.GetAddressOf() );
         if ( FAILED( hr ) )
         {
-            SafeDeleteArray( pPixels );
+            SafeFreeAssetMemory( pPixels );
             return false;
         }
 
         hr = conv->Initialize( frame.Get(), convertGUID, WICBitmapDitherTypeErrorDiffusion, 0, 0, WICBitmapPaletteTypeCustom );
         if ( FAILED( hr ) )
         {
-            SafeDeleteArray( pPixels );
+            SafeFreeAssetMemory( pPixels );
             return false;
         }
 
         hr = conv->CopyPixels( 0, uint32_t( rowPitch ), uint32_t( imageSize ), pPixels );
         if ( FAILED( hr ) )
         {
-            SafeDeleteArray( pPixels );
+            SafeFreeAssetMemory( pPixels );
             return false;
         }
     }
@@ -1656,7 +1661,7 @@ bool CreateResTextureFromWICMemory( const uint8_t* pBinary, const uint32_t buffe
     asdx::SubResource* pRes = new (std::nothrow) asdx::SubResource();
     if ( !pRes )
     {
-        SafeDeleteArray( pPixels );
+        SafeFreeAssetMemory( pPixels );
         return false;
     }
 
@@ -2106,7 +2111,7 @@ bool CreateResTextureFromDDSFileW( const wchar_t* filename, asdx::ResTexture& re
     size_t pixelSize = end - curr;
 
     // ピクセルデータのメモリを確保.
-    unsigned char* pPixelData = new unsigned char [pixelSize];
+    unsigned char* pPixelData = ASDX_ALLOC_ASSET( pixelSize, HEAP_TAG_TEMP );
 
     // NULLチェック.
     if ( pPixelData == nullptr )
@@ -2223,14 +2228,17 @@ bool CreateResTextureFromDDSFileW( const wchar_t* filename, asdx::ResTexture& re
             resTexture.pResources[ idx ].Height     = uint32_t( h );
             resTexture.pResources[ idx ].Pitch      = uint32_t( rowBytes );
             resTexture.pResources[ idx ].SlicePitch = uint32_t( numBytes );
-            resTexture.pResources[ idx ].pPixels    = new uint8_t [ numBytes ];
+            resTexture.pResources[ idx ].pPixels    = ASDX_ALLOC_ASSET( numBytes, HEAP_TAG_TEXTURE );
 
             // NULLチェック.
-            if ( resTexture.pResources[ i ].pPixels == nullptr )
+            if ( resTexture.pResources[ idx ].pPixels == nullptr )
             {
                 // エラーログ出力.
                 ELOG( "Error : Memory Allocate Failed." );
 
+                // 読み込みバッファを解放.
+                FreeAssetMemory( pPixelData );
+
                 // 異常終了.
                 return false;
             }
@@ -2257,7 +2265,7 @@ bool CreateResTextureFromDDSFileW( const wchar_t* filename, asdx::ResTexture& re
     }
 
     // 不要になったメモリを解放.
-    delete [] pPixelData;
+    FreeAssetMemory( pPixelData );
     pPixelData = nullptr;
 
     // 正常終了.
@@ -2682,7 +2690,7 @@ bool CreateResTextureFromDDSMemory( const uint8_t* pBinary, const uint32_t buffe
     size_t pixelSize = bufferSize - offset;
 
     // ピクセルデータのメモリを確保.
-    unsigned char* pPixelData = new unsigned char [pixelSize];
+    unsigned char* pPixelData = ASDX_ALLOC_ASSET( pixelSize, HEAP_TAG_TEMP );
 
     // NULLチェック.
     if ( pPixelData == nullptr )
@@ -2787,7 +2795,37 @@ bool CreateResTextureFromDDSMemory( const uint8_t* pBinary, const uint32_t buffe
             resTexture.pResources[ idx ].Height     = uint32_t( h );
             resTexture.pResources[ idx ].Pitch      = uint32_t( rowBytes );
             resTexture.pResources[ idx ].SlicePitch = uint32_t( numBytes );
-            resTexture.pResources[ idx ].pPixels    = pPixelData + byteOffset;
+            // 範囲チェック.
+            if ( byteOffset + numBytes > pixelSize )
+            {
+                // エラーログ出力.
+                ELOG( "Error : Out of Range." );
+
+                // 読み込みバッファを解放.
+                FreeAssetMemory( pPixelData );
+
+                // 異常終了.
+                return false;
+            }
+
+            // 各サブリソースは FreeAssetMemory() で個別に解放されるため, 読み込みバッファを共有せずにコピーする.
+            resTexture.pResources[ idx ].pPixels    = ASDX_ALLOC_ASSET( numBytes, HEAP_TAG_TEXTURE );
+
+            // NULLチェック.
+            if ( resTexture.pResources[ idx ].pPixels == nullptr )
+            {
+                // エラーログ出力.
+                ELOG( "Error : Memory Allocate Failed." );
+
+                // 読み込みバッファを解放.
+                FreeAssetMemory( pPixelData );
+
+                // 異常終了.
+                return false;
+            }
+
+            // ピクセルデータをコピー.
+            memcpy( resTexture.pResources[ idx ].pPixels, pPixelData + byteOffset, numBytes );
 
             // オフセットをカウントアップ.
             byteOffset += numBytes;
@@ -2808,6 +2846,10 @@ bool CreateResTextureFromDDSMemory( const uint8_t* pBinary, const uint32_t buffe
         if ( d == 0 ) { d = 1; }
     }
 
+    // 不要になったメモリを解放.
+    FreeAssetMemory( pPixelData );
+    pPixelData = nullptr;
+
     // 正常終了.
     return true;
 }
@@ -2925,7 +2967,7 @@ bool CreateResTextureFromTGAFileW(const wchar_t* filename, asdx::ResTexture& res
 
     // ピクセルサイズを決定してメモリを確保.
     auto size = header.Width * header.Height * bpp;
-    auto pPixels = new (std::nothrow) uint8_t [ size ];
+    auto pPixels = ASDX_ALLOC_ASSET( size, HEAP_TAG_TEXTURE );
     if ( pPixels == nullptr )
     {
         ELOG( "Error : Out Of Memory." );
@@ -2941,11 +2983,11 @@ bool CreateResTextureFromTGAFileW(const wchar_t* filename, asdx::ResTexture& res
         uint32_t colorMapSize = header.ColorMapEntry * ( header.ColorMapEntrySize >> 3 );
 
         // メモリを確保.
-        pColorMap = new (std::nothrow) uint8_t [ colorMapSize ];
+        pColorMap = ASDX_ALLOC_ASSET( colorMapSize, HEAP_TAG_TEMP );
         if ( pColorMap == nullptr )
         {
             ELOG( "Error : Out Of Memory." );
-            delete[] pPixels;
+            FreeAssetMemory( pPixels );
             pPixels = nullptr;
             fclose( pFile );
             return false;
@@ -3037,7 +3079,7 @@ bool CreateResTextureFromTGAFileW(const wchar_t* filename, asdx::ResTexture& res
     // 不要なメモリを解放.
     if (pColorMap != nullptr)
     {
-        delete[] pColorMap;
+        FreeAssetMemory( pColorMap );
         pColorMap = nullptr;
     }
 
@@ -9,6 +9,7 @@
 //-----------------------------------------------------------------------------
 #include <asdxShader.h>
 #include <asdxLogger.h>
+#include <asdxMemoryTracker.h>
 
 
 namespace asdx {
@@ -54,7 +55,9 @@ bool ShaderCBV::Init
 
     auto size = buf_desc.Size;
 
+    ASDX_TRACK_FREE(m_Memory.data());
     m_Memory.resize(size);
+    ASDX_TRACK_ALLOC(m_Memory.data(), size, HEAP_TAG_SHADER);
 
     D3D11_BUFFER_DESC cb_desc = {};
     cb_desc.Usage           = D3D11_USAGE_DEFAULT;
@@ -84,8 +87,11 @@ bool ShaderCBV::Init
         param.Offset = var_desc.StartOffset;
         param.Size   = var_desc.Size;
 
-        if (!Contain(var_desc.Name))
-        { m_ParamMap[var_desc.Name] = param; }
+        HashedName name(var_desc.Name);
+        CheckHashedName(name);
+
+        if (!Contain(name))
+        { m_ParamMap[name.GetHash()] = param; }
 
         auto head = m_Memory.data();
         memcpy(head + var_desc.StartOffset, var_desc.DefaultValue, var_desc.Size);
@@ -101,6 +107,8 @@ void ShaderCBV::Term()
 {
     m_CB.Reset();
 
+    ASDX_TRACK_FREE(m_Memory.data());
+
     m_ParamMap.clear();
     m_Memory  .clear();
 }
@@ -109,11 +117,20 @@ void ShaderCBV::Term()
 //      パラメータを設定します.
 //-----------------------------------------------------------------------------
 bool ShaderCBV::SetParam(const char* name, const void* ptr, size_t size)
+{ return SetParam(HashedName(name), ptr, size); }
+
+//-----------------------------------------------------------------------------
+//      パラメータを設定します.
+//-----------------------------------------------------------------------------
+bool ShaderCBV::SetParam(const HashedName& name, const void* ptr, size_t size)
 {
-    if (!Contain(name))
+    CheckHashedName(name);
+
+    auto itr = m_ParamMap.find(name.GetHash());
+    if (itr == m_ParamMap.end())
     { return false; }
 
-    auto param = m_ParamMap[name];
+    const auto& param = itr->second;
     if (param.Size != size)
     { return false; }
 
@@ -126,11 +143,20 @@ bool ShaderCBV::SetParam(const char* name, const void* ptr, size_t size)
 //      パラメータを取得します.
 //-----------------------------------------------------------------------------
 bool ShaderCBV::GetParam(const char* name, void* ptr, size_t size) const
+{ return GetParam(HashedName(name), ptr, size); }
+
+//-----------------------------------------------------------------------------
+//      パラメータを取得します.
+//-----------------------------------------------------------------------------
+bool ShaderCBV::GetParam(const HashedName& name, void* ptr, size_t size) const
 {
-    if (!Contain(name))
+    CheckHashedName(name);
+
+    auto itr = m_ParamMap.find(name.GetHash());
+    if (itr == m_ParamMap.end())
     { return false; }
 
-    auto param = m_ParamMap.at(name);
+    const auto& param = itr->second;
     if (param.Size != size)
     { return false; }
 
@@ -143,7 +169,13 @@ bool ShaderCBV::GetParam(const char* name, void* ptr, size_t size) const
 //      指定されたパラメータ名が含まれるかチェックします.
 //-----------------------------------------------------------------------------
 bool ShaderCBV::Contain(const char* name) const
-{ return m_ParamMap.find(name) != m_ParamMap.end(); }
+{ return Contain(HashedName(name)); }
+
+//-----------------------------------------------------------------------------
+//      指定されたハッシュ名が含まれるかチェックします.
+//-----------------------------------------------------------------------------
+bool ShaderCBV::Contain(const HashedName& name) const
+{ return m_ParamMap.find(name.GetHash()) != m_ParamMap.end(); }
 
 //-----------------------------------------------------------------------------
 //      サブリソースを更新します.
@@ -0,0 +1,304 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxStringPool.cpp
+// Desc : String Intern Pool.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <asdxStringPool.h>
+#include <asdxLogger.h>
+#include <cassert>
+#include <cstring>
+#include <mutex>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////
+// StringPool class
+///////////////////////////////////////////////////////////////////////////////
+const StringHandle StringPool::kEmptyHandle;
+
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+StringPool::StringPool()
+: m_Count     (1)
+, m_pCursor   (nullptr)
+, m_Remain    (0)
+, m_MemorySize(0)
+{
+    for(auto i=0u; i<kMaxBlockCount; ++i)
+    { m_Blocks[i].store(nullptr, std::memory_order_relaxed); }
+
+    // ハンドル 0 は空文字列として予約しておきます.
+    auto pBlock = new Entry[kBlockSize];
+    pBlock[0].pString = "";
+    pBlock[0].Length  = 0;
+    pBlock[0].Hash    = ComputeFnv1a("", 0);
+    m_Blocks[0].store(pBlock, std::memory_order_release);
+
+    m_Table.resize(1024, kEmptyHandle);
+}
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+StringPool::~StringPool()
+{
+    for(auto i=0u; i<kMaxBlockCount; ++i)
+    {
+        delete[] m_Blocks[i].load(std::memory_order_relaxed);
+        m_Blocks[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    for(auto& page : m_Pages)
+    { delete[] page; }
+
+    m_Pages.clear();
+    m_Table.clear();
+}
+
+//-----------------------------------------------------------------------------
+//      シングルトンインスタンスを取得します.
+//-----------------------------------------------------------------------------
+StringPool& StringPool::GetInstance()
+{
+    // 静的な HashString から初期化順に依存せず使えるよう関数内で生成します.
+    static StringPool s_Instance;
+    return s_Instance;
+}
+
+//-----------------------------------------------------------------------------
+//      文字列を登録します.
+//-----------------------------------------------------------------------------
+StringHandle StringPool::Intern(const char* value)
+{
+    if (value == nullptr)
+    { return kEmptyHandle; }
+
+    return Intern(value, strlen(value));
+}
+
+//-----------------------------------------------------------------------------
+//      文字列を登録します.
+//-----------------------------------------------------------------------------
+StringHandle StringPool::Intern(const char* value, size_t count)
+{
+    if (value == nullptr || count == 0)
+    { return kEmptyHandle; }
+
+    auto length = static_cast<uint32_t>(count);
+    auto hash   = ComputeFnv1a(value, count);
+
+    {
+        std::shared_lock<std::shared_timed_mutex> locker(m_Lock);
+        auto handle = Find(value, length, hash);
+        if (handle != kEmptyHandle)
+        { return handle; }
+    }
+
+    std::lock_guard<std::shared_timed_mutex> locker(m_Lock);
+
+    // ロックを取り直す間に他スレッドが登録している可能性があります.
+    auto handle = Find(value, length, hash);
+    if (handle != kEmptyHandle)
+    { return handle; }
+
+    return Insert(value, length, hash);
+}
+
+//-----------------------------------------------------------------------------
+//      ハッシュ名を登録します.
+//-----------------------------------------------------------------------------
+StringHandle StringPool::Intern(const HashedName& value)
+{
+    auto name = value.GetName();
+    if (name == nullptr || name[0] == '\0')
+    { return kEmptyHandle; }
+
+    auto length = static_cast<uint32_t>(strlen(name));
+    auto hash   = value.GetHash();
+
+    {
+        std::shared_lock<std::shared_timed_mutex> locker(m_Lock);
+        auto handle = Find(name, length, hash);
+        if (handle != kEmptyHandle)
+        { return handle; }
+    }
+
+    std::lock_guard<std::shared_timed_mutex> locker(m_Lock);
+
+    auto handle = Find(name, length, hash);
+    if (handle != kEmptyHandle)
+    { return handle; }
+
+    return Insert(name, length, hash);
+}
+
+//-----------------------------------------------------------------------------
+//      文字列を取得します.
+//-----------------------------------------------------------------------------
+const char* StringPool::GetString(StringHandle handle) const
+{ return GetEntry(handle).pString; }
+
+//-----------------------------------------------------------------------------
+//      文字数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t StringPool::GetLength(StringHandle handle) const
+{ return GetEntry(handle).Length; }
+
+//-----------------------------------------------------------------------------
+//      ハッシュ値を取得します.
+//-----------------------------------------------------------------------------
+uint32_t StringPool::GetHash(StringHandle handle) const
+{ return GetEntry(handle).Hash; }
+
+//-----------------------------------------------------------------------------
+//      登録されている文字列数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t StringPool::GetCount() const
+{ return m_Count.load(std::memory_order_acquire); }
+
+//-----------------------------------------------------------------------------
+//      文字列格納用に確保したメモリサイズを取得します.
+//-----------------------------------------------------------------------------
+size_t StringPool::GetMemorySize() const
+{
+    std::shared_lock<std::shared_timed_mutex> locker(m_Lock);
+    return m_MemorySize;
+}
+
+//-----------------------------------------------------------------------------
+//      登録済みの文字列を検索します.
+//-----------------------------------------------------------------------------
+StringHandle StringPool::Find(const char* value, uint32_t count, uint32_t hash) const
+{
+    auto mask  = m_Table.size() - 1;
+    auto index = hash & mask;
+
+    for(;;)
+    {
+        auto handle = m_Table[index];
+        if (handle == kEmptyHandle)
+        { return kEmptyHandle; }
+
+        const auto& entry = GetEntry(handle);
+        if (entry.Hash   == hash
+         && entry.Length == count
+         && memcmp(entry.pString, value, count) == 0)
+        { return handle; }
+
+        index = (index + 1) & mask;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      文字列を追加します. 排他ロックを取得した状態で呼び出します.
+//-----------------------------------------------------------------------------
+StringHandle StringPool::Insert(const char* value, uint32_t count, uint32_t hash)
+{
+    auto handle = m_Count.load(std::memory_order_relaxed);
+    auto block  = handle >> kBlockShift;
+    if (block >= kMaxBlockCount)
+    {
+        ELOGA("Error : StringPool Overflow. count = %u", handle);
+        return kEmptyHandle;
+    }
+
+    auto pBlock = m_Blocks[block].load(std::memory_order_relaxed);
+    if (pBlock == nullptr)
+    {
+        pBlock = new Entry[kBlockSize];
+        m_Blocks[block].store(pBlock, std::memory_order_release);
+    }
+
+    auto pString = Allocate(count + 1);
+    memcpy(pString, value, count);
+    pString[count] = '\0';
+
+    auto& entry = pBlock[handle & (kBlockSize - 1)];
+    entry.pString = pString;
+    entry.Length  = count;
+    entry.Hash    = hash;
+
+    m_Count.store(handle + 1, std::memory_order_release);
+
+    // 負荷率が 50% を超えたらテーブルを拡張します.
+    if ((handle + 1) * 2 > m_Table.size())
+    { Rehash(m_Table.size() * 2); }
+
+    auto mask  = m_Table.size() - 1;
+    auto index = hash & mask;
+    while(m_Table[index] != kEmptyHandle)
+    { index = (index + 1) & mask; }
+
+    m_Table[index] = handle;
+    return handle;
+}
+
+//-----------------------------------------------------------------------------
+//      エントリを取得します.
+//-----------------------------------------------------------------------------
+const StringPool::Entry& StringPool::GetEntry(StringHandle handle) const
+{
+    assert(handle < m_Count.load(std::memory_order_acquire));
+    auto pBlock = m_Blocks[handle >> kBlockShift].load(std::memory_order_acquire);
+    return pBlock[handle & (kBlockSize - 1)];
+}
+
+//-----------------------------------------------------------------------------
+//      文字列用のメモリを確保します.
+//-----------------------------------------------------------------------------
+char* StringPool::Allocate(size_t size)
+{
+    // ページの 1/4 を超える文字列は専用ページに格納します.
+    if (size > kPageSize / 4)
+    {
+        auto pPage = new char[size];
+        m_Pages.push_back(pPage);
+        m_MemorySize += size;
+        return pPage;
+    }
+
+    if (size > m_Remain)
+    {
+        m_pCursor = new char[kPageSize];
+        m_Remain  = kPageSize;
+        m_Pages.push_back(m_pCursor);
+        m_MemorySize += kPageSize;
+    }
+
+    auto ptr = m_pCursor;
+    m_pCursor += size;
+    m_Remain  -= size;
+    return ptr;
+}
+
+//-----------------------------------------------------------------------------
+//      ハッシュテーブルを再構築します.
+//-----------------------------------------------------------------------------
+void StringPool::Rehash(size_t tableSize)
+{
+    std::vector<StringHandle> table(tableSize, kEmptyHandle);
+    auto mask = tableSize - 1;
+
+    for(auto handle : m_Table)
+    {
+        if (handle == kEmptyHandle)
+        { continue; }
+
+        auto index = GetEntry(handle).Hash & mask;
+        while(table[index] != kEmptyHandle)
+        { index = (index + 1) & mask; }
+
+        table[index] = handle;
+    }
+
+    m_Table.swap(table);
+}
+
+} // namespace asdx
@@ -0,0 +1,902 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxTlsfHeap.cpp
+// Desc : Two-Level Segregated Fit Heap.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxTlsfHeap.h>
+#include <asdxLogger.h>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+#if defined(_MSC_VER)
+#include <malloc.h>
+#include <intrin.h>
+#endif
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const size_t kBlockHeaderSize = 16;      // ブロックヘッダのサイズです.
+static const size_t kMinBlockSize    = 16;      // 空きリストのリンクを格納できる最小のブロックサイズです.
+static const uint32_t kAssetMagic    = 0x54455341;  // アセットメモリのヘッダを示す値です ('ASET').
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AssetHeader structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AllocAssetMemory() で確保したメモリの直前に置き, 解放先のヒープを記録します.
+struct AssetHeader
+{
+    asdx::TlsfHeap*     pOwner;     // 確保したヒープです. nullptr の場合はシステムから確保しています.
+    uint32_t            Magic;      // kAssetMagic です. 解放時に 0 にします.
+    uint32_t            Padding[ ( sizeof(void*) == 8 ) ? 1 : 2 ];
+};
+static_assert( sizeof(AssetHeader) == asdx::TlsfHeap::kAlignment, "AssetHeader Size Not Matched." );
+
+//-------------------------------------------------------------------------------------------------
+// Global Variables.
+//-------------------------------------------------------------------------------------------------
+std::atomic<asdx::TlsfHeap*> g_pAssetHeap( nullptr );
+
+//-------------------------------------------------------------------------------------------------
+//      アライメントを指定してメモリを確保します.
+//-------------------------------------------------------------------------------------------------
+void* AlignedAlloc( size_t size, size_t alignment )
+{
+#if defined(_MSC_VER)
+    return _aligned_malloc( size, alignment );
+#else
+    void* ptr = nullptr;
+    if ( posix_memalign( &ptr, alignment, size ) != 0 )
+    { return nullptr; }
+    return ptr;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      AlignedAlloc() で確保したメモリを解放します.
+//-------------------------------------------------------------------------------------------------
+void AlignedFree( void* ptr )
+{
+#if defined(_MSC_VER)
+    _aligned_free( ptr );
+#else
+    free( ptr );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      最上位のセットビットの位置を求めます.
+//-------------------------------------------------------------------------------------------------
+inline uint32_t Fls( uint32_t value )
+{
+    assert( value != 0 );
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse( &index, value );
+    return uint32_t( index );
+#else
+    return 31 - uint32_t( __builtin_clz( value ) );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      最下位のセットビットの位置を求めます.
+//-------------------------------------------------------------------------------------------------
+inline uint32_t Ffs( uint32_t value )
+{
+    assert( value != 0 );
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward( &index, value );
+    return uint32_t( index );
+#else
+    return uint32_t( __builtin_ctz( value ) );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      指定アライメントに切り上げます.
+//-------------------------------------------------------------------------------------------------
+inline size_t AlignUp( size_t value, size_t alignment )
+{ return ( value + alignment - 1 ) & ~( alignment - 1 ); }
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TlsfHeap::Block structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//! @note   ヘッダの直後がブロックの先頭です. 空きブロックの場合は先頭に空きリストのリンクを格納します.
+struct TlsfHeap::Block
+{
+    Block*      pPrevPhys;      //!< 物理的に直前のブロックです. プールの先頭の場合は nullptr です.
+    uint32_t    Size;           //!< ヘッダを除いたブロックサイズです.
+    uint16_t    Free;           //!< 空きブロックの場合は 1 です.
+    uint16_t    Tag;            //!< 集計用のタグです.
+
+    static_assert( sizeof(void*) * 2 <= kMinBlockSize, "Free list links must fit in the minimum block." );
+
+    uint8_t* GetPayload()
+    { return reinterpret_cast<uint8_t*>( this ) + kBlockHeaderSize; }
+
+    Block* GetNextPhys()
+    { return reinterpret_cast<Block*>( GetPayload() + Size ); }
+
+    Block*& NextFree()
+    { return reinterpret_cast<Block**>( GetPayload() )[0]; }
+
+    Block*& PrevFree()
+    { return reinterpret_cast<Block**>( GetPayload() )[1]; }
+
+    static Block* FromPayload( const void* ptr )
+    { return reinterpret_cast<Block*>( const_cast<uint8_t*>( static_cast<const uint8_t*>( ptr ) ) - kBlockHeaderSize ); }
+};
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+//      挿入先のリスト番号を求めます.
+//-------------------------------------------------------------------------------------------------
+inline void MappingInsert( size_t size, uint32_t slCountLog2, uint32_t flShift, uint32_t& fl, uint32_t& sl )
+{
+    if ( size < ( size_t(1) << flShift ) )
+    {
+        fl = 0;
+        sl = uint32_t( size ) >> ( flShift - slCountLog2 );
+    }
+    else
+    {
+        auto f = Fls( uint32_t( size ) );
+        sl = ( uint32_t( size ) >> ( f - slCountLog2 ) ) ^ ( 1u << slCountLog2 );
+        fl = f - ( flShift - 1 );
+    }
+}
+
+} // namespace /* anonymous */
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TlsfHeap class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+const size_t TlsfHeap::kAlignment;
+const size_t TlsfHeap::kMaxPoolSize;
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+TlsfHeap::TlsfHeap()
+: m_FlBitmap        ( 0 )
+, m_PoolSize        ( 0 )
+, m_UsedSize        ( 0 )
+, m_PeakUsedSize    ( 0 )
+, m_FreeSize        ( 0 )
+, m_FreeBlockCount  ( 0 )
+, m_AllocCount      ( 0 )
+, m_FailCount       ( 0 )
+{
+    for( auto i=0u; i<kFlIndexCount; ++i )
+    {
+        m_SlBitmap[i] = 0;
+        for( auto j=0u; j<kSlIndexCount; ++j )
+        { m_pFreeList[i][j] = nullptr; }
+    }
+
+    for( auto i=0u; i<HEAP_TAG_COUNT; ++i )
+    { m_TagStats[i] = TlsfTagStats(); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+TlsfHeap::~TlsfHeap()
+{ Term(); }
+
+//-------------------------------------------------------------------------------------------------
+//      初期化処理を行います.
+//-------------------------------------------------------------------------------------------------
+bool TlsfHeap::Init( const TlsfHeapDesc& desc )
+{
+    Term();
+
+    std::lock_guard<std::mutex> locker( m_Lock );
+
+    if ( desc.MaxSize != 0 && desc.PoolSize > desc.MaxSize )
+    {
+        ELOGA( "Error : Invalid Argument. PoolSize = %zu, MaxSize = %zu", desc.PoolSize, desc.MaxSize );
+        return false;
+    }
+
+    m_Desc = desc;
+
+    if ( !AddPoolNoLock( desc.PoolSize ) )
+    {
+        ELOGA( "Error : TlsfHeap::AddPool() Failed." );
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      終了処理を行います.
+//-------------------------------------------------------------------------------------------------
+void TlsfHeap::Term()
+{
+    std::lock_guard<std::mutex> locker( m_Lock );
+
+    for( size_t i=0; i<m_Pools.size(); ++i )
+    { AlignedFree( m_Pools[i].pMemory ); }
+    m_Pools.clear();
+
+    m_FlBitmap = 0;
+    for( auto i=0u; i<kFlIndexCount; ++i )
+    {
+        m_SlBitmap[i] = 0;
+        for( auto j=0u; j<kSlIndexCount; ++j )
+        { m_pFreeList[i][j] = nullptr; }
+    }
+
+    for( auto i=0u; i<HEAP_TAG_COUNT; ++i )
+    { m_TagStats[i] = TlsfTagStats(); }
+
+    m_PoolSize       = 0;
+    m_UsedSize       = 0;
+    m_PeakUsedSize   = 0;
+    m_FreeSize       = 0;
+    m_FreeBlockCount = 0;
+    m_AllocCount     = 0;
+    m_FailCount      = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      プールを追加します.
+//-------------------------------------------------------------------------------------------------
+bool TlsfHeap::AddPool( size_t size )
+{
+    std::lock_guard<std::mutex> locker( m_Lock );
+    return AddPoolNoLock( size );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      全体が空きになっている追加プールを解放します.
+//-------------------------------------------------------------------------------------------------
+uint32_t TlsfHeap::Trim()
+{
+    std::lock_guard<std::mutex> locker( m_Lock );
+
+    uint32_t count = 0;
+
+    // 初期化時のプールは保持する.
+    for( size_t i=m_Pools.size(); i > 1; --i )
+    {
+        auto& pool   = m_Pools[i - 1];
+        auto  pBlock = reinterpret_cast<Block*>( pool.pMemory );
+
+        if ( !pBlock->Free || pBlock->Size != pool.Size - kBlockHeaderSize * 2 )
+        { continue; }
+
+        RemoveFreeBlock( pBlock );
+        AlignedFree( pool.pMemory );
+        m_PoolSize -= pool.Size;
+        m_Pools.erase( m_Pools.begin() + ( i - 1 ) );
+        count++;
+    }
+
+    return count;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      メモリを確保します.
+//-------------------------------------------------------------------------------------------------
+void* TlsfHeap::Alloc( size_t size, uint32_t tag, size_t alignment )
+{
+    assert( tag < HEAP_TAG_COUNT );
+    assert( ( alignment & ( alignment - 1 ) ) == 0 );
+
+    if ( tag >= HEAP_TAG_COUNT )
+    { tag = HEAP_TAG_DEFAULT; }
+
+    if ( alignment < kAlignment )
+    { alignment = kAlignment; }
+
+    std::lock_guard<std::mutex> locker( m_Lock );
+
+    if ( size > kMaxPoolSize || alignment > kMaxPoolSize )
+    {
+        m_FailCount++;
+        return nullptr;
+    }
+
+    auto ptr = AllocNoLock( size, tag, alignment );
+
+    // 容量不足の場合はプールを追加して再試行.
+    if ( ptr == nullptr && m_Desc.GrowSize > 0 )
+    {
+        auto required = AlignUp( size, kAlignment ) + alignment + kBlockHeaderSize * 4 + kMinBlockSize;
+        auto poolSize = ( m_Desc.GrowSize > required ) ? m_Desc.GrowSize : required;
+
+        if ( poolSize <= kMaxPoolSize
+          && ( m_Desc.MaxSize == 0 || m_PoolSize + poolSize <= m_Desc.MaxSize )
+          && AddPoolNoLock( poolSize ) )
+        { ptr = AllocNoLock( size, tag, alignment ); }
+    }
+
+    if ( ptr == nullptr )
+    { m_FailCount++; }
+
+    return ptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      メモリを解放します.
+//-------------------------------------------------------------------------------------------------
+void TlsfHeap::Free( void* ptr )
+{
+    if ( ptr == nullptr )
+    { return; }
+
+    std::lock_guard<std::mutex> locker( m_Lock );
+
+    assert( ContainsNoLock( ptr ) );
+
+    auto pBlock = Block::FromPayload( ptr );
+    assert( !pBlock->Free );
+
+    auto& tagStats = m_TagStats[pBlock->Tag];
+    tagStats.UsedSize -= pBlock->Size;
+    tagStats.AllocCount--;
+
+    m_UsedSize -= pBlock->Size;
+    m_AllocCount--;
+
+    pBlock->Free = 1;
+    pBlock->Tag  = HEAP_TAG_DEFAULT;
+
+    InsertFreeBlock( MergeBlock( pBlock ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      指定ポインタがこのヒープのプール内を指すかどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool TlsfHeap::Contains( const void* ptr ) const
+{
+    std::lock_guard<std::mutex> locker( m_Lock );
+    return ContainsNoLock( ptr );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      確保済みブロックの使用可能なサイズを取得します.
+//-------------------------------------------------------------------------------------------------
+size_t TlsfHeap::GetBlockSize( const void* ptr ) const
+{
+    if ( ptr == nullptr )
+    { return 0; }
+
+    return Block::FromPayload( ptr )->Size;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      統計情報を取得します.
+//-------------------------------------------------------------------------------------------------
+TlsfStats TlsfHeap::GetStats() const
+{
+    std::lock_guard<std::mutex> locker( m_Lock );
+
+    TlsfStats result;
+    result.PoolCount        = uint32_t( m_Pools.size() );
+    result.PoolSize         = m_PoolSize;
+    result.UsedSize         = m_UsedSize;
+    result.PeakUsedSize     = m_PeakUsedSize;
+    result.FreeSize         = m_FreeSize;
+    result.LargestFreeSize  = 0;
+    result.FreeBlockCount   = m_FreeBlockCount;
+    result.AllocCount       = m_AllocCount;
+    result.FailCount        = m_FailCount;
+    result.Fragmentation    = 0.0f;
+
+    // 最大の空きブロックは最上位の空でないリストに含まれる.
+    if ( m_FlBitmap != 0 )
+    {
+        auto fl = Fls( m_FlBitmap );
+        auto sl = Fls( m_SlBitmap[fl] );
+        for( auto pBlock = m_pFreeList[fl][sl]; pBlock != nullptr; pBlock = pBlock->NextFree() )
+        {
+            if ( pBlock->Size > result.LargestFreeSize )
+            { result.LargestFreeSize = pBlock->Size; }
+        }
+    }
+
+    if ( m_FreeSize > 0 )
+    { result.Fragmentation = 1.0f - float( double( result.LargestFreeSize ) / double( m_FreeSize ) ); }
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      タグごとの統計情報を取得します.
+//-------------------------------------------------------------------------------------------------
+TlsfTagStats TlsfHeap::GetTagStats( uint32_t tag ) const
+{
+    if ( tag >= HEAP_TAG_COUNT )
+    { return TlsfTagStats(); }
+
+    std::lock_guard<std::mutex> locker( m_Lock );
+    return m_TagStats[tag];
+}
+
+//-------------------------------------------------------------------------------------------------
+//      全ブロックを走査して整合性を検証します.
+//-------------------------------------------------------------------------------------------------
+bool TlsfHeap::Validate() const
+{
+    std::lock_guard<std::mutex> locker( m_Lock );
+
+    size_t   usedSize  = 0;
+    size_t   freeSize  = 0;
+    uint32_t freeCount = 0;
+    uint32_t usedCount = 0;
+
+    // 物理的な並びを検証.
+    for( size_t i=0; i<m_Pools.size(); ++i )
+    {
+        auto pBlock = reinterpret_cast<Block*>( m_Pools[i].pMemory );
+        auto pEnd   = reinterpret_cast<Block*>( m_Pools[i].pMemory + m_Pools[i].Size - kBlockHeaderSize );
+        Block* pPrev = nullptr;
+
+        while( pBlock != pEnd )
+        {
+            if ( pBlock->pPrevPhys != pPrev
+              || pBlock->Size < kMinBlockSize
+              || reinterpret_cast<uint8_t*>( pBlock->GetNextPhys() ) > reinterpret_cast<uint8_t*>( pEnd ) )
+            {
+                ELOGA( "Error : Broken Block. pool = %zu", i );
+                return false;
+            }
+
+            if ( pBlock->Free )
+            {
+                // 隣接する空きブロックは必ず結合されている.
+                if ( pPrev != nullptr && pPrev->Free )
+                {
+                    ELOGA( "Error : Adjacent Free Blocks. pool = %zu", i );
+                    return false;
+                }
+                freeSize += pBlock->Size;
+                freeCount++;
+            }
+            else
+            {
+                usedSize += pBlock->Size;
+                usedCount++;
+            }
+
+            pPrev  = pBlock;
+            pBlock = pBlock->GetNextPhys();
+        }
+
+        if ( pEnd->pPrevPhys != pPrev || pEnd->Size != 0 || pEnd->Free )
+        {
+            ELOGA( "Error : Broken Sentinel. pool = %zu", i );
+            return false;
+        }
+    }
+
+    // 空きリストとビットマップを検証.
+    uint32_t listCount = 0;
+    for( auto i=0u; i<kFlIndexCount; ++i )
+    {
+        if ( ( ( m_FlBitmap >> i ) & 0x1 ) != ( m_SlBitmap[i] != 0 ? 1u : 0u ) )
+        {
+            ELOGA( "Error : Broken First Level Bitmap. fl = %u", i );
+            return false;
+        }
+
+        for( auto j=0u; j<kSlIndexCount; ++j )
+        {
+            auto pHead = m_pFreeList[i][j];
+            if ( ( ( m_SlBitmap[i] >> j ) & 0x1 ) != ( pHead != nullptr ? 1u : 0u ) )
+            {
+                ELOGA( "Error : Broken Second Level Bitmap. fl = %u, sl = %u", i, j );
+                return false;
+            }
+
+            for( auto pBlock = pHead; pBlock != nullptr; pBlock = pBlock->NextFree() )
+            {
+                uint32_t fl, sl;
+                MappingInsert( pBlock->Size, kSlIndexCountLog2, kFlIndexShift, fl, sl );
+                if ( !pBlock->Free || fl != i || sl != j )
+                {
+                    ELOGA( "Error : Broken Free List. fl = %u, sl = %u", i, j );
+                    return false;
+                }
+                listCount++;
+            }
+        }
+    }
+
+    if ( usedSize  != m_UsedSize
+      || usedCount != m_AllocCount
+      || freeSize  != m_FreeSize
+      || freeCount != m_FreeBlockCount
+      || listCount != m_FreeBlockCount )
+    {
+        ELOGA( "Error : Statistics Mismatch." );
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ロック取得済みの状態でプールを追加します.
+//-------------------------------------------------------------------------------------------------
+bool TlsfHeap::AddPoolNoLock( size_t size )
+{
+    size &= ~( kAlignment - 1 );
+
+    if ( size < kBlockHeaderSize * 2 + kMinBlockSize || size > kMaxPoolSize )
+    {
+        ELOGA( "Error : Invalid Pool Size. size = %zu", size );
+        return false;
+    }
+
+    auto pMemory = static_cast<uint8_t*>( AlignedAlloc( size, kAlignment ) );
+    if ( pMemory == nullptr )
+    {
+        ELOGA( "Error : Out of Memory. size = %zu", size );
+        return false;
+    }
+
+    try
+    {
+        Pool pool;
+        pool.pMemory = pMemory;
+        pool.Size    = size;
+        m_Pools.push_back( pool );
+    }
+    catch( std::bad_alloc& )
+    {
+        AlignedFree( pMemory );
+        ELOGA( "Error : Out of Memory." );
+        return false;
+    }
+
+    // プール全体を1つの空きブロックと終端の番兵で構成する.
+    auto pBlock = reinterpret_cast<Block*>( pMemory );
+    pBlock->pPrevPhys = nullptr;
+    pBlock->Size      = uint32_t( size - kBlockHeaderSize * 2 );
+    pBlock->Free      = 1;
+    pBlock->Tag       = HEAP_TAG_DEFAULT;
+
+    auto pSentinel = pBlock->GetNextPhys();
+    pSentinel->pPrevPhys = pBlock;
+    pSentinel->Size      = 0;
+    pSentinel->Free      = 0;
+    pSentinel->Tag       = HEAP_TAG_DEFAULT;
+
+    InsertFreeBlock( pBlock );
+    m_PoolSize += size;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ロック取得済みの状態でメモリを確保します.
+//-------------------------------------------------------------------------------------------------
+void* TlsfHeap::AllocNoLock( size_t size, uint32_t tag, size_t alignment )
+{
+    auto adjustSize = AlignUp( ( size < kMinBlockSize ) ? kMinBlockSize : size, kAlignment );
+
+    Block* pBlock = nullptr;
+
+    if ( alignment <= kAlignment )
+    {
+        pBlock = FindFreeBlock( adjustSize );
+        if ( pBlock == nullptr )
+        { return nullptr; }
+
+        RemoveFreeBlock( pBlock );
+    }
+    else
+    {
+        // 先頭の余りを空きブロックとして切り出せるだけの余裕を持って検索する.
+        auto gapMin = kBlockHeaderSize + kMinBlockSize;
+
+        pBlock = FindFreeBlock( adjustSize + alignment + gapMin );
+        if ( pBlock == nullptr )
+        { return nullptr; }
+
+        RemoveFreeBlock( pBlock );
+
+        auto payload = reinterpret_cast<uintptr_t>( pBlock->GetPayload() );
+        auto aligned = AlignUp( payload, alignment );
+        if ( aligned != payload && aligned - payload < gapMin )
+        { aligned = AlignUp( payload + gapMin, alignment ); }
+
+        auto gap = aligned - payload;
+        if ( gap > 0 )
+        {
+            auto pNext = reinterpret_cast<Block*>( aligned - kBlockHeaderSize );
+            pNext->pPrevPhys = pBlock;
+            pNext->Size      = uint32_t( pBlock->Size - gap );
+            pNext->Free      = 1;
+            pNext->Tag       = HEAP_TAG_DEFAULT;
+            pNext->GetNextPhys()->pPrevPhys = pNext;
+
+            pBlock->Size = uint32_t( gap - kBlockHeaderSize );
+            InsertFreeBlock( pBlock );
+
+            pBlock = pNext;
+        }
+    }
+
+    assert( pBlock->Size >= adjustSize );
+
+    SplitBlock( pBlock, adjustSize );
+
+    pBlock->Free = 0;
+    pBlock->Tag  = uint16_t( tag );
+
+    m_UsedSize += pBlock->Size;
+    m_AllocCount++;
+    if ( m_UsedSize > m_PeakUsedSize )
+    { m_PeakUsedSize = m_UsedSize; }
+
+    auto& tagStats = m_TagStats[tag];
+    tagStats.UsedSize += pBlock->Size;
+    tagStats.AllocCount++;
+    tagStats.TotalAllocCount++;
+    if ( tagStats.UsedSize > tagStats.PeakUsedSize )
+    { tagStats.PeakUsedSize = tagStats.UsedSize; }
+
+    return pBlock->GetPayload();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      指定サイズ以上が保証される空きブロックを検索します.
+//-------------------------------------------------------------------------------------------------
+TlsfHeap::Block* TlsfHeap::FindFreeBlock( size_t size )
+{
+    // リスト内の全ブロックが要求を満たすよう, 次の区間の先頭に切り上げる.
+    if ( size >= ( size_t(1) << kFlIndexShift ) )
+    { size += ( size_t(1) << ( Fls( uint32_t( size ) ) - kSlIndexCountLog2 ) ) - 1; }
+
+    uint32_t fl, sl;
+    MappingInsert( size, kSlIndexCountLog2, kFlIndexShift, fl, sl );
+    if ( fl >= kFlIndexCount )
+    { return nullptr; }
+
+    auto slMap = m_SlBitmap[fl] & ( ~0u << sl );
+    if ( slMap == 0 )
+    {
+        auto flMap = ( fl + 1 < 32 ) ? ( m_FlBitmap & ( ~0u << ( fl + 1 ) ) ) : 0u;
+        if ( flMap == 0 )
+        { return nullptr; }
+
+        fl    = Ffs( flMap );
+        slMap = m_SlBitmap[fl];
+    }
+
+    sl = Ffs( slMap );
+    return m_pFreeList[fl][sl];
+}
+
+//-------------------------------------------------------------------------------------------------
+//      空きリストにブロックを追加します.
+//-------------------------------------------------------------------------------------------------
+void TlsfHeap::InsertFreeBlock( Block* pBlock )
+{
+    uint32_t fl, sl;
+    MappingInsert( pBlock->Size, kSlIndexCountLog2, kFlIndexShift, fl, sl );
+
+    auto pHead = m_pFreeList[fl][sl];
+    pBlock->Free       = 1;
+    pBlock->NextFree() = pHead;
+    pBlock->PrevFree() = nullptr;
+    if ( pHead != nullptr )
+    { pHead->PrevFree() = pBlock; }
+
+    m_pFreeList[fl][sl] = pBlock;
+    m_FlBitmap     |= ( 1u << fl );
+    m_SlBitmap[fl] |= ( 1u << sl );
+
+    m_FreeSize += pBlock->Size;
+    m_FreeBlockCount++;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      空きリストからブロックを取り除きます.
+//-------------------------------------------------------------------------------------------------
+void TlsfHeap::RemoveFreeBlock( Block* pBlock )
+{
+    uint32_t fl, sl;
+    MappingInsert( pBlock->Size, kSlIndexCountLog2, kFlIndexShift, fl, sl );
+
+    auto pNext = pBlock->NextFree();
+    auto pPrev = pBlock->PrevFree();
+
+    if ( pNext != nullptr )
+    { pNext->PrevFree() = pPrev; }
+
+    if ( pPrev != nullptr )
+    { pPrev->NextFree() = pNext; }
+    else
+    {
+        m_pFreeList[fl][sl] = pNext;
+        if ( pNext == nullptr )
+        {
+            m_SlBitmap[fl] &= ~( 1u << sl );
+            if ( m_SlBitmap[fl] == 0 )
+            { m_FlBitmap &= ~( 1u << fl ); }
+        }
+    }
+
+    pBlock->Free = 0;
+
+    m_FreeSize -= pBlock->Size;
+    m_FreeBlockCount--;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ブロックの後方の余りを空きブロックとして切り出します.
+//-------------------------------------------------------------------------------------------------
+TlsfHeap::Block* TlsfHeap::SplitBlock( Block* pBlock, size_t size )
+{
+    if ( pBlock->Size < size + kBlockHeaderSize + kMinBlockSize )
+    { return nullptr; }
+
+    auto pRest = reinterpret_cast<Block*>( pBlock->GetPayload() + size );
+    pRest->pPrevPhys = pBlock;
+    pRest->Size      = uint32_t( pBlock->Size - size - kBlockHeaderSize );
+    pRest->Tag       = HEAP_TAG_DEFAULT;
+    pRest->GetNextPhys()->pPrevPhys = pRest;
+
+    pBlock->Size = uint32_t( size );
+
+    InsertFreeBlock( pRest );
+    return pRest;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      物理的に隣接する空きブロックと結合します.
+//-------------------------------------------------------------------------------------------------
+TlsfHeap::Block* TlsfHeap::MergeBlock( Block* pBlock )
+{
+    auto pPrev = pBlock->pPrevPhys;
+    if ( pPrev != nullptr && pPrev->Free )
+    {
+        RemoveFreeBlock( pPrev );
+        pPrev->Size += uint32_t( kBlockHeaderSize + pBlock->Size );
+        pPrev->GetNextPhys()->pPrevPhys = pPrev;
+        pBlock = pPrev;
+    }
+
+    auto pNext = pBlock->GetNextPhys();
+    if ( pNext->Free )
+    {
+        RemoveFreeBlock( pNext );
+        pBlock->Size += uint32_t( kBlockHeaderSize + pNext->Size );
+        pBlock->GetNextPhys()->pPrevPhys = pBlock;
+    }
+
+    return pBlock;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ロック取得済みの状態でポインタがプール内を指すかどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool TlsfHeap::ContainsNoLock( const void* ptr ) const
+{
+    auto p = static_cast<const uint8_t*>( ptr );
+    for( size_t i=0; i<m_Pools.size(); ++i )
+    {
+        if ( m_Pools[i].pMemory <= p && p < m_Pools[i].pMemory + m_Pools[i].Size )
+        { return true; }
+    }
+
+    return false;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+//      アセットデータ用のヒープを設定します.
+//-------------------------------------------------------------------------------------------------
+void SetAssetHeap( TlsfHeap* pHeap )
+{ g_pAssetHeap.store( pHeap, std::memory_order_release ); }
+
+//-------------------------------------------------------------------------------------------------
+//      アセットデータ用のヒープを取得します.
+//-------------------------------------------------------------------------------------------------
+TlsfHeap* GetAssetHeap()
+{ return g_pAssetHeap.load( std::memory_order_acquire ); }
+
+//-------------------------------------------------------------------------------------------------
+//      アセットデータ用のメモリを確保します.
+//-------------------------------------------------------------------------------------------------
+uint8_t* AllocAssetMemory( size_t size, uint32_t tag, const char* file, int line )
+{
+    uint8_t* ptr = nullptr;
+
+    // 解放時に現在のヒープではなく確保したヒープへ戻せるよう, 先頭にヘッダを付けます.
+    if ( size <= SIZE_MAX - sizeof(AssetHeader) )
+    {
+        auto total   = size + sizeof(AssetHeader);
+        auto pHeap   = GetAssetHeap();
+        auto pHeader = ( pHeap != nullptr ) ? static_cast<AssetHeader*>( pHeap->Alloc( total, tag ) ) : nullptr;
+
+        if ( pHeader == nullptr )
+        {
+            pHeap   = nullptr;
+            pHeader = static_cast<AssetHeader*>( AlignedAlloc( total, TlsfHeap::kAlignment ) );
+        }
+
+        if ( pHeader != nullptr )
+        {
+            pHeader->pOwner = pHeap;
+            pHeader->Magic  = kAssetMagic;
+            ptr = reinterpret_cast<uint8_t*>( pHeader + 1 );
+        }
+    }
+
+#if defined(ASDX_ENABLE_MEMORY_TRACKER)
+    if ( MemoryTracker::IsEnabled() )
+    {
+        if ( file == nullptr )
+        {
+            file = __FILE__;
+            line = __LINE__;
+        }
+
+        if ( ptr != nullptr )
+        { MemoryTracker::GetInstance().OnAlloc( ptr, size, tag, file, line ); }
+        else
+        { MemoryTracker::GetInstance().OnAllocFailed( size, tag, file, line ); }
+    }
+#else
+    (void)file;
+    (void)line;
+#endif
+
+    return ptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      AllocAssetMemory() で確保したメモリを解放します.
+//-------------------------------------------------------------------------------------------------
+void FreeAssetMemory( void* ptr )
+{
+    if ( ptr == nullptr )
+    { return; }
+
+    auto pHeader = static_cast<AssetHeader*>( ptr ) - 1;
+    if ( pHeader->Magic != kAssetMagic )
+    {
+        ELOG( "Error : Not Allocated by AllocAssetMemory(), or Already Freed. ptr = %p", ptr );
+        assert( false );
+        return;
+    }
+
+    ASDX_TRACK_FREE( ptr );
+
+    pHeader->Magic = 0;
+
+    auto pOwner = pHeader->pOwner;
+    if ( pOwner != nullptr )
+    { pOwner->Free( pHeader ); }
+    else
+    { AlignedFree( pHeader ); }
+}
+
+} // namespace asdx
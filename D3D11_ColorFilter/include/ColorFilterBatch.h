@@ -0,0 +1,71 @@
+﻿//-----------------------------------------------------------------------------
+// File : ColorFilterBatch.h
+// Desc : Color Filter Batch Mode.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <ColorLut.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// BatchDesc structure
+///////////////////////////////////////////////////////////////////////////////
+struct BatchDesc
+{
+    std::string     InputDir;       //!< 入力ディレクトリです.
+    std::string     OutputDir;      //!< 出力ディレクトリです.
+    std::string     Filter;         //!< フィルタチェインです(例 "sepia:0.85,hue:30").
+    uint32_t        ThreadCount;    //!< 使用スレッド数です(0の場合はハードウェアスレッド数).
+    uint32_t        LutSize;        //!< 3D LUTのサイズです(0の場合は非線形な処理を含むときのみ33で焼き込み).
+    std::string     LutPath;        //!< 焼き込んだ3D LUTの保存先です(空の場合は保存しません).
+    std::string     ReferenceDir;   //!< 比較するリファレンス画像のディレクトリです(空の場合は比較しません).
+    float           MinPSNR;        //!< 比較を合格とする RGB の PSNR [dB] の下限です.
+
+    BatchDesc()
+    : Filter        ("sepia:0.85")
+    , ThreadCount   (0)
+    , LutSize       (0)
+    , MinPSNR       (40.0f)
+    { /* DO_NOTHING */ }
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      フィルタチェイン文字列からカラーチェインを生成します.
+//!
+//! @param[in]      chain       カンマ区切りのフィルタ名と引数(名前:値).
+//! @param[out]     result      左から順に適用するカラーチェイン.
+//! @retval true    生成に成功.
+//! @retval false   不明なフィルタ名が含まれていた.
+//! @note       行列は brightness, saturation, contrast, hue, sepia, grayscale, negaposi, swaprb,
+//!             非線形な処理は gamma, scurve が使えます.
+//-----------------------------------------------------------------------------
+bool ParseFilterChain(const char* chain, ColorChain& result);
+
+//-----------------------------------------------------------------------------
+//! @brief      コマンドライン引数からバッチ設定を解析します.
+//!
+//! @param[in]      argc        引数の数.
+//! @param[in]      argv        引数.
+//! @param[out]     desc        バッチ設定.
+//! @retval true    解析に成功.
+//! @retval false   解析に失敗.
+//! @note       -batch <inDir> <outDir> [-filter <chain>] [-threads <N>] [-lut <N>] [-savelut <path>]
+//!             [-reference <refDir>] [-minpsnr <dB>] の形式です.
+//-----------------------------------------------------------------------------
+bool ParseBatchArgs(int argc, char** argv, BatchDesc& desc);
+
+//-----------------------------------------------------------------------------
+//! @brief      ウィンドウやデバイスを生成せずにディレクトリ内の画像を一括変換します.
+//!
+//! @param[in]      desc        バッチ設定.
+//! @return     プロセスの終了コードを返却します.
+//! @note       ReferenceDir を指定した場合は <refDir>\<name>.dds と比較し, PSNR が MinPSNR 未満の
+//!             画像は失敗として <outDir>\<name>_diff.dds にヒートマップを保存します.
+//-----------------------------------------------------------------------------
+int RunColorFilterBatch(const BatchDesc& desc);
@@ -0,0 +1,87 @@
+﻿//-----------------------------------------------------------------------------
+// File : ColorFilterCPU.h
+// Desc : Color Filter (CPU Reference).
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <asdxMath.h>
+#include <asdxResTexture.h>
+#include <ColorLut.h>
+
+
+//-----------------------------------------------------------------------------
+//! @brief      CPU版カラーフィルタがサポートするフォーマットかどうかチェックします.
+//!
+//! @param[in]      format      DXGIフォーマット.
+//! @retval true    R8G8B8A8_UNORM, R16G16B16A16_FLOAT, R32G32B32A32_FLOAT のいずれか.
+//! @retval false   非サポートフォーマット.
+//-----------------------------------------------------------------------------
+bool IsColorFilterSupported(uint32_t format);
+
+//-----------------------------------------------------------------------------
+//! @brief      カラー変換行列をCPUで適用します.
+//!
+//! @param[in]      matrix          カラー変換行列(ColorFilterCS.hlslと同じ行ベクトル規約).
+//! @param[in]      format          DXGIフォーマット.
+//! @param[in,out]  subResource     適用対象のサブリソース.
+//! @param[in]      threadCount     使用するスレッド数(0の場合はハードウェアスレッド数).
+//! @retval true    適用に成功.
+//! @retval false   適用に失敗.
+//! @note       ColorFilterCS.hlslの mul(ColorMatrix, Input[id]) と同じ演算順序で計算し,
+//!             UNORMへの書き戻しは最近接偶数丸めで行います.
+//-----------------------------------------------------------------------------
+bool ApplyColorMatrix(
+    const asdx::Matrix&     matrix,
+    uint32_t                format,
+    asdx::SubResource&      subResource,
+    uint32_t                threadCount = 0);
+
+//-----------------------------------------------------------------------------
+//! @brief      リソーステクスチャの全サブリソースにカラー変換行列を適用します.
+//!
+//! @param[in]      matrix          カラー変換行列.
+//! @param[in,out]  texture         適用対象のリソーステクスチャ.
+//! @param[in]      threadCount     使用するスレッド数(0の場合はハードウェアスレッド数).
+//! @retval true    適用に成功.
+//! @retval false   適用に失敗.
+//-----------------------------------------------------------------------------
+bool ApplyColorMatrix(
+    const asdx::Matrix&     matrix,
+    asdx::ResTexture&       texture,
+    uint32_t                threadCount = 0);
+
+//-----------------------------------------------------------------------------
+//! @brief      3D LUTをCPUで適用します.
+//!
+//! @param[in]      lut             BakeColorLut() で生成した3D LUT.
+//! @param[in]      format          DXGIフォーマット.
+//! @param[in,out]  subResource     適用対象のサブリソース.
+//! @param[in]      threadCount     使用するスレッド数(0の場合はハードウェアスレッド数).
+//! @retval true    適用に成功.
+//! @retval false   適用に失敗.
+//! @note       RGBをテトラへドラル補間で変換します. アルファは変更しません.
+//-----------------------------------------------------------------------------
+bool ApplyColorLut(
+    const ColorLut&         lut,
+    uint32_t                format,
+    asdx::SubResource&      subResource,
+    uint32_t                threadCount = 0);
+
+//-----------------------------------------------------------------------------
+//! @brief      リソーステクスチャの全サブリソースに3D LUTを適用します.
+//!
+//! @param[in]      lut             3D LUT.
+//! @param[in,out]  texture         適用対象のリソーステクスチャ.
+//! @param[in]      threadCount     使用するスレッド数(0の場合はハードウェアスレッド数).
+//! @retval true    適用に成功.
+//! @retval false   適用に失敗.
+//-----------------------------------------------------------------------------
+bool ApplyColorLut(
+    const ColorLut&         lut,
+    asdx::ResTexture&       texture,
+    uint32_t                threadCount = 0);
@@ -0,0 +1,189 @@
+﻿//-----------------------------------------------------------------------------
+// File : ColorLut.h
+// Desc : Color Lookup Table.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <functional>
+#include <asdxMath.h>
+#include <asdxResTexture.h>
+#include <asdxTarget.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ColorChain class
+///////////////////////////////////////////////////////////////////////////////
+class ColorChain
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    typedef std::function<void(float* rgba)> Function;
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    ColorChain();
+
+    //-------------------------------------------------------------------------
+    //! @brief      カラー変換行列を追加します.
+    //!
+    //! @param[in]      matrix      カラー変換行列.
+    //! @note       直前の処理も行列の場合は1つの行列に合成されます.
+    //-------------------------------------------------------------------------
+    void AddMatrix(const asdx::Matrix& matrix);
+
+    //-------------------------------------------------------------------------
+    //! @brief      RGB各チャンネルに適用するカーブを追加します.
+    //!
+    //! @param[in]      curve       入力値を受け取り出力値を返す関数.
+    //-------------------------------------------------------------------------
+    void AddCurve(const std::function<float(float)>& curve);
+
+    //-------------------------------------------------------------------------
+    //! @brief      任意の変換処理を追加します.
+    //!
+    //! @param[in]      function    RGBAを書き換える関数.
+    //-------------------------------------------------------------------------
+    void AddFunction(const Function& function);
+
+    //-------------------------------------------------------------------------
+    //! @brief      ガンマカーブを追加します.
+    //!
+    //! @param[in]      gamma       ガンマ値(出力は x^(1/gamma) になります).
+    //-------------------------------------------------------------------------
+    void AddGamma(float gamma);
+
+    //-------------------------------------------------------------------------
+    //! @brief      Sカーブを追加します.
+    //!
+    //! @param[in]      strength    強さ(0で無効, 1でsmoothstep).
+    //-------------------------------------------------------------------------
+    void AddSCurve(float strength);
+
+    //-------------------------------------------------------------------------
+    //! @brief      チェインを評価します.
+    //!
+    //! @param[in,out]  rgba        変換する色.
+    //-------------------------------------------------------------------------
+    void Evaluate(float* rgba) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      行列だけで表現できるかどうかチェックします.
+    //!
+    //! @retval true    GetMatrix() で得られる行列1つで表現できます.
+    //! @retval false   非線形な処理が含まれています.
+    //-------------------------------------------------------------------------
+    bool IsLinear() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      合成済みのカラー変換行列を取得します.
+    //!
+    //! @return     IsLinear() が true の場合に有効な行列を返却します.
+    //-------------------------------------------------------------------------
+    asdx::Matrix GetMatrix() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      処理をすべて削除します.
+    //-------------------------------------------------------------------------
+    void Clear();
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Step structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Step
+    {
+        bool            IsMatrix;   //!< 行列かどうか.
+        asdx::Matrix    Matrix;     //!< カラー変換行列.
+        Function        Func;       //!< 非線形な変換処理.
+    };
+
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    std::vector<Step>   m_Steps;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    /* NOTHING */
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ColorLut structure
+///////////////////////////////////////////////////////////////////////////////
+struct ColorLut
+{
+    uint32_t            Size;       //!< 1辺当たりのサンプル数です.
+    std::vector<float>  Texels;     //!< RGBA32F のテクセルデータです(R, G, B の順に連続).
+
+    ColorLut()
+    : Size(0)
+    { /* DO_NOTHING */ }
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      カラーチェインを3D LUTに焼き込みます.
+//!
+//! @param[in]      chain           焼き込むカラーチェイン.
+//! @param[in]      size            1辺当たりのサンプル数(2以上, 一般的には17, 33, 65).
+//! @param[out]     result          生成した3D LUT.
+//! @param[in]      threadCount     使用するスレッド数(0の場合はハードウェアスレッド数).
+//! @retval true    焼き込みに成功.
+//! @retval false   焼き込みに失敗.
+//! @note       入力の定義域は [0, 1] で, アルファは 1 として評価します.
+//-----------------------------------------------------------------------------
+bool BakeColorLut(
+    const ColorChain&   chain,
+    uint32_t            size,
+    ColorLut&           result,
+    uint32_t            threadCount = 0);
+
+//-----------------------------------------------------------------------------
+//! @brief      3D LUTからボリュームテクスチャのリソースを生成します.
+//!
+//! @param[in]      lut             3D LUT.
+//! @param[in]      format          R16G16B16A16_FLOAT または R32G32B32A32_FLOAT.
+//! @param[out]     result          生成したリソーステクスチャ(Depth = Size).
+//! @retval true    生成に成功.
+//! @retval false   生成に失敗.
+//! @note       SaveToDDSFileA() でボリュームDDSとして保存できます.
+//-----------------------------------------------------------------------------
+bool CreateResTextureFromColorLut(
+    const ColorLut&     lut,
+    uint32_t            format,
+    asdx::ResTexture&   result);
+
+//-----------------------------------------------------------------------------
+//! @brief      3D LUTを ColorTarget3D に転送します.
+//!
+//! @param[in]      pDevice         デバイス.
+//! @param[in]      pContext        デバイスコンテキスト.
+//! @param[in]      lut             3D LUT.
+//! @param[out]     target          生成するターゲット(R16G16B16A16_FLOAT).
+//! @retval true    転送に成功.
+//! @retval false   転送に失敗.
+//-----------------------------------------------------------------------------
+bool CreateColorTarget3DFromColorLut(
+    ID3D11Device*           pDevice,
+    ID3D11DeviceContext*    pContext,
+    const ColorLut&         lut,
+    asdx::ColorTarget3D&    target);
@@ -0,0 +1,23 @@
+﻿//-----------------------------------------------------------------------------
+// File : DdsWriter.h
+// Desc : DDS File Writer.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <asdxResTexture.h>
+
+
+//-----------------------------------------------------------------------------
+//! @brief      リソーステクスチャをDDSファイルに保存します.
+//!
+//! @param[in]      filename        出力ファイルパス.
+//! @param[in]      texture         保存するリソーステクスチャ.
+//! @retval true    保存に成功.
+//! @retval false   保存に失敗.
+//! @note       DX10拡張ヘッダ付きで出力します. Depth が 2以上の場合はボリュームテクスチャとして出力します.
+//-----------------------------------------------------------------------------
+bool SaveToDDSFileA(const char* filename, const asdx::ResTexture& texture);
@@ -0,0 +1,106 @@
+﻿//-----------------------------------------------------------------------------
+// File : HalfFloat.h
+// Desc : Half Precision Float Conversion.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <cstring>
+
+
+//-----------------------------------------------------------------------------
+// NOTE : asdx::floatToF16() / asdx::F16Tofloat() は Inf, NaN を扱わず,
+//        オーバーフロー時に 0x7FFF を返すため, GPUの変換結果と一致させる用途に
+//        IEEE 754 準拠の変換をここで用意しています.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+//! @brief      半精度浮動小数を単精度浮動小数に変換します.
+//-----------------------------------------------------------------------------
+inline float HalfToFloat(uint16_t value)
+{
+    uint32_t sign = uint32_t(value & 0x8000) << 16;
+    uint32_t exp  = (value >> 10) & 0x1f;
+    uint32_t mant = value & 0x3ff;
+    uint32_t bits = 0;
+
+    if (exp == 0x1f)
+    {
+        // Inf, NaN.
+        bits = sign | 0x7f800000 | (mant << 13);
+    }
+    else if (exp != 0)
+    {
+        // 正規化数.
+        bits = sign | ((exp + 112) << 23) | (mant << 13);
+    }
+    else if (mant != 0)
+    {
+        // 非正規化数.
+        exp = 113;
+        while ((mant & 0x400) == 0)
+        {
+            mant <<= 1;
+            exp--;
+        }
+        mant &= 0x3ff;
+        bits = sign | (exp << 23) | (mant << 13);
+    }
+    else
+    {
+        // ゼロ.
+        bits = sign;
+    }
+
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//! @brief      単精度浮動小数を半精度浮動小数に変換します(最近接偶数丸め).
+//-----------------------------------------------------------------------------
+inline uint16_t FloatToHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t abs  = bits & 0x7fffffff;
+
+    // Inf, NaN.
+    if (abs >= 0x7f800000)
+    { return uint16_t(sign | 0x7c00 | ((abs > 0x7f800000) ? 0x200 : 0)); }
+
+    // オーバーフローは Inf にします.
+    if (abs >= 0x477ff000)
+    { return uint16_t(sign | 0x7c00); }
+
+    // 非正規化数またはゼロ.
+    if (abs < 0x38800000)
+    {
+        if (abs < 0x33000000)
+        { return uint16_t(sign); }
+
+        uint32_t exp   = abs >> 23;
+        uint32_t mant  = (abs & 0x7fffff) | 0x800000;
+        uint32_t shift = 126 - exp;
+        uint32_t half  = mant >> shift;
+        uint32_t rest  = mant & ((1u << shift) - 1);
+        uint32_t mid   = 1u << (shift - 1);
+        if (rest > mid || (rest == mid && (half & 1)))
+        { half++; }
+        return uint16_t(sign | half);
+    }
+
+    // 正規化数.
+    uint32_t half = ((abs - 0x38000000) >> 13);
+    uint32_t rest = abs & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+    { half++; }
+    return uint16_t(sign | half);
+}
@@ -0,0 +1,351 @@
+﻿//-----------------------------------------------------------------------------
+// File : ColorFilterBatch.cpp
+// Desc : Color Filter Batch Mode.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <Windows.h>
+#include <ColorFilterBatch.h>
+#include <ColorFilterCPU.h>
+#include <ColorMatrix.h>
+#include <DdsWriter.h>
+#include <asdxImageDiff.h>
+#include <asdxLogger.h>
+#include <asdxMisc.h>
+#include <asdxResTexture.h>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <list>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      入力対象の拡張子かどうかチェックします.
+//-----------------------------------------------------------------------------
+bool IsImageFile(const std::string& path)
+{
+    static const char* kExts[] = {
+        "tga", "dds", "bmp", "png", "jpg", "jpeg", "tif", "tiff"
+    };
+
+    auto ext = asdx::GetExtA(path.c_str());
+    for(auto& item : kExts)
+    {
+        if (ext == item)
+        { return true; }
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//      フィルタ名と引数からカラーチェインに処理を追加します.
+//-----------------------------------------------------------------------------
+bool AddFilter(const std::string& name, const char* arg, ColorChain& chain)
+{
+    auto hasArg = (arg != nullptr);
+    auto value  = (hasArg) ? float(atof(arg)) : 0.0f;
+
+    if (name == "brightness")
+    { chain.AddMatrix(CreateBrightnessMatrix(hasArg ? value : 1.0f)); }
+    else if (name == "saturation")
+    { chain.AddMatrix(CreateSaturationMatrix(hasArg ? value : 1.0f)); }
+    else if (name == "contrast")
+    { chain.AddMatrix(CreateContrastMatrix(hasArg ? value : 1.0f)); }
+    else if (name == "hue")
+    { chain.AddMatrix(CreateHueMatrix(value)); }
+    else if (name == "sepia")
+    { chain.AddMatrix(CreateSepiaMatrix(hasArg ? value : 1.0f)); }
+    else if (name == "grayscale")
+    { chain.AddMatrix(CreateGrayScaleMatrix(hasArg ? value : 1.0f)); }
+    else if (name == "negaposi")
+    { chain.AddMatrix(CreateNegaposiMatrix()); }
+    else if (name == "swaprb")
+    { chain.AddMatrix(CreateSwapRandG()); }
+    else if (name == "gamma")
+    { chain.AddGamma(hasArg ? value : 2.2f); }
+    else if (name == "scurve")
+    { chain.AddSCurve(hasArg ? value : 1.0f); }
+    else
+    { return false; }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      リファレンス画像と比較します.
+//-----------------------------------------------------------------------------
+bool CompareWithReference
+(
+    const BatchDesc&        desc,
+    const std::string&      name,
+    const asdx::ResTexture& result
+)
+{
+    auto path = desc.ReferenceDir + "\\" + name + ".dds";
+
+    asdx::ResTexture reference;
+    if (!reference.LoadFromFileA(path.c_str()))
+    {
+        ELOGA("Error : Reference Load Failed. path = %s", path.c_str());
+        return false;
+    }
+
+    asdx::ImageDiffDesc diffDesc;
+    diffDesc.ThreadCount = desc.ThreadCount;
+
+    asdx::ImageDiffResult diff;
+    asdx::ResTexture      heatmap;
+    auto ret = asdx::CompareResTexture(result, reference, diffDesc, diff, &heatmap);
+    reference.Release();
+
+    if (!ret)
+    {
+        ELOGA("Error : CompareResTexture() Failed. path = %s", path.c_str());
+        return false;
+    }
+
+    ILOGA("Info : Compare %s : RMSE = %.6f, PSNR = %.3f dB, SSIM = %.6f, diff pixels = %llu",
+        name.c_str(), diff.RMSERGB, diff.PSNRRGB, diff.SSIMRGB, diff.DiffPixelCount);
+
+    if (diff.PSNRRGB >= desc.MinPSNR)
+    {
+        heatmap.Release();
+        return true;
+    }
+
+    auto output = desc.OutputDir + "\\" + name + "_diff.dds";
+    if (!SaveToDDSFileA(output.c_str(), heatmap))
+    { ELOGA("Error : SaveToDDSFileA() Failed. path = %s", output.c_str()); }
+
+    ELOGA("Error : Reference Mismatch. name = %s, PSNR = %.3f dB < %.3f dB", name.c_str(), diff.PSNRRGB, desc.MinPSNR);
+    heatmap.Release();
+    return false;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      フィルタチェイン文字列からカラーチェインを生成します.
+//-----------------------------------------------------------------------------
+bool ParseFilterChain(const char* chain, ColorChain& result)
+{
+    result.Clear();
+
+    if (chain == nullptr)
+    { return true; }
+
+    std::string items = chain;
+    size_t head = 0;
+    while (head <= items.size())
+    {
+        auto tail = items.find(',', head);
+        if (tail == std::string::npos)
+        { tail = items.size(); }
+
+        auto item = items.substr(head, tail - head);
+        head = tail + 1;
+
+        if (item.empty())
+        { continue; }
+
+        std::string name = item;
+        std::string arg;
+        auto pos = item.find(':');
+        if (pos != std::string::npos)
+        {
+            name = item.substr(0, pos);
+            arg  = item.substr(pos + 1);
+        }
+
+        if (!AddFilter(name, (pos != std::string::npos) ? arg.c_str() : nullptr, result))
+        {
+            ELOGA("Error : Unknown Filter. name = %s", name.c_str());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      コマンドライン引数からバッチ設定を解析します.
+//-----------------------------------------------------------------------------
+bool ParseBatchArgs(int argc, char** argv, BatchDesc& desc)
+{
+    if (argc < 4 || strcmp(argv[1], "-batch") != 0)
+    {
+        ELOGA("Error : Usage : -batch <inDir> <outDir> [-filter <chain>] [-threads <N>] [-lut <N>] [-savelut <path>] [-reference <refDir>] [-minpsnr <dB>]");
+        return false;
+    }
+
+    desc.InputDir  = argv[2];
+    desc.OutputDir = argv[3];
+
+    for(auto i=4; i<argc; ++i)
+    {
+        if (strcmp(argv[i], "-filter") == 0 && i + 1 < argc)
+        { desc.Filter = argv[++i]; }
+        else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+        { desc.ThreadCount = uint32_t(atoi(argv[++i])); }
+        else if (strcmp(argv[i], "-lut") == 0 && i + 1 < argc)
+        { desc.LutSize = uint32_t(atoi(argv[++i])); }
+        else if (strcmp(argv[i], "-savelut") == 0 && i + 1 < argc)
+        { desc.LutPath = argv[++i]; }
+        else if (strcmp(argv[i], "-reference") == 0 && i + 1 < argc)
+        { desc.ReferenceDir = argv[++i]; }
+        else if (strcmp(argv[i], "-minpsnr") == 0 && i + 1 < argc)
+        { desc.MinPSNR = float(atof(argv[++i])); }
+        else
+        {
+            ELOGA("Error : Unknown Option. option = %s", argv[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      ディレクトリ内の画像を一括変換します.
+//-----------------------------------------------------------------------------
+int RunColorFilterBatch(const BatchDesc& desc)
+{
+    ColorChain chain;
+    if (!ParseFilterChain(desc.Filter.c_str(), chain))
+    { return -1; }
+
+    // 非線形な処理を含む場合, または明示的に指定された場合は3D LUTに焼き込む.
+    auto lutSize = desc.LutSize;
+    if (lutSize == 0 && !chain.IsLinear())
+    { lutSize = 33; }
+
+    auto matrix = chain.GetMatrix();
+
+    ColorLut lut;
+    if (lutSize > 0)
+    {
+        if (!BakeColorLut(chain, lutSize, lut, desc.ThreadCount))
+        { return -1; }
+
+        if (!desc.LutPath.empty())
+        {
+            asdx::ResTexture res;
+            if (!CreateResTextureFromColorLut(lut, DXGI_FORMAT_R16G16B16A16_FLOAT, res)
+             || !SaveToDDSFileA(desc.LutPath.c_str(), res))
+            {
+                ELOGA("Error : Save LUT Failed. path = %s", desc.LutPath.c_str());
+                res.Release();
+                return -1;
+            }
+            res.Release();
+        }
+    }
+
+    if (!asdx::IsExistFolderPathA(desc.InputDir.c_str()))
+    {
+        ELOGA("Error : Input Directory Not Found. path = %s", desc.InputDir.c_str());
+        return -1;
+    }
+
+    if (!asdx::IsExistFolderPathA(desc.OutputDir.c_str()))
+    {
+        if (!CreateDirectoryA(desc.OutputDir.c_str(), nullptr))
+        {
+            ELOGA("Error : CreateDirectoryA() Failed. path = %s", desc.OutputDir.c_str());
+            return -1;
+        }
+    }
+
+    std::list<std::string> files;
+    if (!asdx::SearchFilesA(desc.InputDir.c_str(), "", files))
+    {
+        ELOGA("Error : File Not Found. path = %s", desc.InputDir.c_str());
+        return -1;
+    }
+
+    // WICローダー用.
+    auto hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    if (FAILED(hr))
+    {
+        ELOGA("Error : CoInitializeEx() Failed. errcode = 0x%x", hr);
+        return -1;
+    }
+
+    uint32_t succeeded = 0;
+    uint32_t failed    = 0;
+    double   totalMsec = 0.0;
+
+    for(auto& path : files)
+    {
+        if (!IsImageFile(path))
+        { continue; }
+
+        asdx::ResTexture res;
+        if (!res.LoadFromFileA(path.c_str()))
+        {
+            ELOGA("Error : Texture Load Failed. path = %s", path.c_str());
+            failed++;
+            continue;
+        }
+
+        if (!IsColorFilterSupported(res.Format))
+        {
+            WLOGA("Warning : Unsupported Format. Skipped. path = %s, format = %u", path.c_str(), res.Format);
+            res.Release();
+            failed++;
+            continue;
+        }
+
+        auto begin = std::chrono::high_resolution_clock::now();
+        auto ret   = (lutSize > 0)
+                   ? ApplyColorLut(lut, res, desc.ThreadCount)
+                   : ApplyColorMatrix(matrix, res, desc.ThreadCount);
+        auto end   = std::chrono::high_resolution_clock::now();
+
+        if (!ret)
+        {
+            ELOGA("Error : Apply Color Filter Failed. path = %s", path.c_str());
+            res.Release();
+            failed++;
+            continue;
+        }
+
+        auto msec = std::chrono::duration<double, std::milli>(end - begin).count();
+        totalMsec += msec;
+
+        auto name = asdx::GetPathWithoutExtA(asdx::RemoveDirectoryPathA(path.c_str()).c_str());
+        auto output = desc.OutputDir + "\\" + name + ".dds";
+        if (!SaveToDDSFileA(output.c_str(), res))
+        {
+            ELOGA("Error : SaveToDDSFileA() Failed. path = %s", output.c_str());
+            res.Release();
+            failed++;
+            continue;
+        }
+
+        ILOGA("Info : %s -> %s (%u x %u, %.3f msec)", path.c_str(), output.c_str(), res.Width, res.Height, msec);
+
+        if (!desc.ReferenceDir.empty() && !CompareWithReference(desc, name, res))
+        {
+            res.Release();
+            failed++;
+            continue;
+        }
+
+        res.Release();
+        succeeded++;
+    }
+
+    CoUninitialize();
+
+    ILOGA("Info : Batch Finished. succeeded = %u, failed = %u, filter time = %.3f msec", succeeded, failed, totalMsec);
+
+    return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,464 @@
+﻿//-----------------------------------------------------------------------------
+// File : ColorFilterCPU.cpp
+// Desc : Color Filter (CPU Reference).
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <ColorFilterCPU.h>
+#include <HalfFloat.h>
+#include <asdxLogger.h>
+#include <dxgiformat.h>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define COLOR_FILTER_ENABLE_SSE     (1)
+#include <emmintrin.h>
+#else
+#define COLOR_FILTER_ENABLE_SSE     (0)
+#endif
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kMinRowsPerThread = 16;   // スレッド当たりの最小行数.
+
+///////////////////////////////////////////////////////////////////////////////
+// UnormTable structure
+///////////////////////////////////////////////////////////////////////////////
+struct UnormTable
+{
+    float Value[256];
+
+    UnormTable()
+    {
+        for(auto i=0; i<256; ++i)
+        { Value[i] = float(i) / 255.0f; }
+    }
+};
+
+//-----------------------------------------------------------------------------
+//      UNORM8 のデコードテーブルを取得します.
+//-----------------------------------------------------------------------------
+const UnormTable& GetUnormTable()
+{
+    static const UnormTable s_Table;
+    return s_Table;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MatrixOp structure
+///////////////////////////////////////////////////////////////////////////////
+struct MatrixOp
+{
+    float   M[4][4];    //!< カラー変換行列.
+
+    //-------------------------------------------------------------------------
+    //      1ピクセルを変換します.
+    //-------------------------------------------------------------------------
+    inline void operator()(const float* pIn, float* pOut) const
+    {
+    #if COLOR_FILTER_ENABLE_SSE
+        auto v = _mm_mul_ps(_mm_set1_ps(pIn[0]), _mm_loadu_ps(M[0]));
+        v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(pIn[1]), _mm_loadu_ps(M[1])));
+        v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(pIn[2]), _mm_loadu_ps(M[2])));
+        v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(pIn[3]), _mm_loadu_ps(M[3])));
+        _mm_storeu_ps(pOut, v);
+    #else
+        for(auto j=0; j<4; ++j)
+        {
+            pOut[j] = pIn[0] * M[0][j]
+                    + pIn[1] * M[1][j]
+                    + pIn[2] * M[2][j]
+                    + pIn[3] * M[3][j];
+        }
+    #endif
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// LutOp structure
+///////////////////////////////////////////////////////////////////////////////
+struct LutOp
+{
+    const float*    pTexels;    //!< RGBA32F のLUTデータ.
+    uint32_t        Size;       //!< 1辺当たりのサンプル数.
+
+    //-------------------------------------------------------------------------
+    //      1ピクセルを変換します(テトラへドラル補間, アルファは素通し).
+    //-------------------------------------------------------------------------
+    inline void operator()(const float* pIn, float* pOut) const
+    {
+        auto limit = float(Size - 1);
+
+        float f[3];
+        uint32_t i[3];
+        for(auto c=0; c<3; ++c)
+        {
+            auto v = std::min(std::max(pIn[c], 0.0f), 1.0f) * limit;
+            i[c] = std::min(uint32_t(v), Size - 2);
+            f[c] = v - float(i[c]);
+        }
+
+        const size_t dx = 4;
+        const size_t dy = size_t(Size) * 4;
+        const size_t dz = size_t(Size) * Size * 4;
+        auto base = pTexels + (i[2] * dz + i[1] * dy + i[0] * dx);
+
+        // 4頂点と重みを選択.
+        size_t o1, o2;
+        float  w0, w1, w2, w3;
+        auto fx = f[0];
+        auto fy = f[1];
+        auto fz = f[2];
+        if (fx >= fy)
+        {
+            if (fy >= fz)
+            { o1 = dx;      o2 = dx + dy; w0 = 1.0f - fx; w1 = fx - fy; w2 = fy - fz; w3 = fz; }
+            else if (fx >= fz)
+            { o1 = dx;      o2 = dx + dz; w0 = 1.0f - fx; w1 = fx - fz; w2 = fz - fy; w3 = fy; }
+            else
+            { o1 = dz;      o2 = dx + dz; w0 = 1.0f - fz; w1 = fz - fx; w2 = fx - fy; w3 = fy; }
+        }
+        else
+        {
+            if (fz >= fy)
+            { o1 = dz;      o2 = dy + dz; w0 = 1.0f - fz; w1 = fz - fy; w2 = fy - fx; w3 = fx; }
+            else if (fz >= fx)
+            { o1 = dy;      o2 = dy + dz; w0 = 1.0f - fy; w1 = fy - fz; w2 = fz - fx; w3 = fx; }
+            else
+            { o1 = dy;      o2 = dx + dy; w0 = 1.0f - fy; w1 = fy - fx; w2 = fx - fz; w3 = fz; }
+        }
+        auto o3 = dx + dy + dz;
+
+    #if COLOR_FILTER_ENABLE_SSE
+        auto v = _mm_mul_ps(_mm_set1_ps(w0), _mm_loadu_ps(base));
+        v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(w1), _mm_loadu_ps(base + o1)));
+        v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(w2), _mm_loadu_ps(base + o2)));
+        v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(w3), _mm_loadu_ps(base + o3)));
+        auto a = pIn[3];
+        _mm_storeu_ps(pOut, v);
+        pOut[3] = a;
+    #else
+        auto a = pIn[3];
+        for(auto c=0; c<3; ++c)
+        {
+            pOut[c] = w0 * base[c]
+                    + w1 * base[o1 + c]
+                    + w2 * base[o2 + c]
+                    + w3 * base[o3 + c];
+        }
+        pOut[3] = a;
+    #endif
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// RowKernel structure
+///////////////////////////////////////////////////////////////////////////////
+template<typename Op>
+struct RowKernel
+{
+    const Op&   Transform;  //!< ピクセル変換処理.
+    uint32_t    Format;     //!< DXGIフォーマット.
+    uint32_t    Width;      //!< 1行当たりのピクセル数.
+    uint32_t    Pitch;      //!< 1行当たりのバイト数.
+    uint8_t*    pPixels;    //!< ピクセルデータ.
+
+    //-------------------------------------------------------------------------
+    //      指定範囲の行を処理します.
+    //-------------------------------------------------------------------------
+    void Run(uint32_t begin, uint32_t end) const
+    {
+        for(auto y=begin; y<end; ++y)
+        {
+            auto pRow = pPixels + size_t(y) * Pitch;
+            switch(Format)
+            {
+            case DXGI_FORMAT_R8G8B8A8_UNORM:
+                RunUnorm8(pRow);
+                break;
+
+            case DXGI_FORMAT_R16G16B16A16_FLOAT:
+                RunFloat16(pRow);
+                break;
+
+            case DXGI_FORMAT_R32G32B32A32_FLOAT:
+                RunFloat32(reinterpret_cast<float*>(pRow));
+                break;
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //      R8G8B8A8_UNORM の行を処理します.
+    //-------------------------------------------------------------------------
+    void RunUnorm8(uint8_t* pRow) const
+    {
+        auto& table = GetUnormTable();
+
+    #if COLOR_FILTER_ENABLE_SSE
+        auto zero  = _mm_setzero_ps();
+        auto one   = _mm_set1_ps(1.0f);
+        auto scale = _mm_set1_ps(255.0f);
+    #endif
+
+        for(uint32_t x=0; x<Width; ++x)
+        {
+            auto p = pRow + x * 4;
+            float in[4] = {
+                table.Value[p[0]],
+                table.Value[p[1]],
+                table.Value[p[2]],
+                table.Value[p[3]]
+            };
+            float out[4];
+            Transform(in, out);
+
+        #if COLOR_FILTER_ENABLE_SSE
+            // saturate して最近接偶数丸めで 8bit に戻す.
+            auto v   = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(out), zero), one);
+            auto i32 = _mm_cvtps_epi32(_mm_mul_ps(v, scale));
+            auto i16 = _mm_packs_epi32(i32, i32);
+            auto i8  = _mm_packus_epi16(i16, i16);
+            auto packed = uint32_t(_mm_cvtsi128_si32(i8));
+            memcpy(p, &packed, sizeof(packed));
+        #else
+            for(auto j=0; j<4; ++j)
+            {
+                auto s = std::min(std::max(out[j], 0.0f), 1.0f) * 255.0f;
+                p[j] = uint8_t(std::nearbyint(s));
+            }
+        #endif
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //      R16G16B16A16_FLOAT の行を処理します.
+    //-------------------------------------------------------------------------
+    void RunFloat16(uint8_t* pRow) const
+    {
+        auto pTexel = reinterpret_cast<uint16_t*>(pRow);
+        for(uint32_t x=0; x<Width; ++x)
+        {
+            auto p = pTexel + x * 4;
+            float in[4] = {
+                HalfToFloat(p[0]),
+                HalfToFloat(p[1]),
+                HalfToFloat(p[2]),
+                HalfToFloat(p[3])
+            };
+            float out[4];
+            Transform(in, out);
+
+            for(auto j=0; j<4; ++j)
+            { p[j] = FloatToHalf(out[j]); }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //      R32G32B32A32_FLOAT の行を処理します.
+    //-------------------------------------------------------------------------
+    void RunFloat32(float* pRow) const
+    {
+        for(uint32_t x=0; x<Width; ++x)
+        {
+            auto p = pRow + x * 4;
+            float out[4];
+            Transform(p, out);
+            memcpy(p, out, sizeof(out));
+        }
+    }
+};
+
+//-----------------------------------------------------------------------------
+//      1ピクセル当たりのバイト数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t GetTexelSize(uint32_t format)
+{
+    switch(format)
+    {
+    case DXGI_FORMAT_R8G8B8A8_UNORM:        return 4;
+    case DXGI_FORMAT_R16G16B16A16_FLOAT:    return 8;
+    case DXGI_FORMAT_R32G32B32A32_FLOAT:    return 16;
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//      行単位でバンドに分割してピクセル変換処理を並列実行します.
+//-----------------------------------------------------------------------------
+template<typename Op>
+bool Dispatch
+(
+    const Op&               op,
+    uint32_t                format,
+    asdx::SubResource&      subResource,
+    uint32_t                threadCount
+)
+{
+    auto texelSize = GetTexelSize(format);
+    if (texelSize == 0)
+    {
+        ELOGA("Error : Unsupported Format. format = %u", format);
+        return false;
+    }
+
+    if (subResource.pPixels == nullptr
+     || subResource.Pitch < subResource.Width * texelSize)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
+
+    RowKernel<Op> kernel = {
+        op,
+        format,
+        subResource.Width,
+        subResource.Pitch,
+        subResource.pPixels
+    };
+
+    // ボリュームテクスチャの場合も考慮して, SlicePitchから総行数を求める.
+    auto rowCount = subResource.SlicePitch / subResource.Pitch;
+    if (rowCount == 0)
+    { return true; }
+
+    if (threadCount == 0)
+    { threadCount = std::max(std::thread::hardware_concurrency(), 1u); }
+
+    threadCount = std::min(threadCount, std::max(rowCount / kMinRowsPerThread, 1u));
+
+    if (threadCount == 1)
+    {
+        kernel.Run(0, rowCount);
+        return true;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount - 1);
+
+    auto rowsPerThread = (rowCount + threadCount - 1) / threadCount;
+    for(auto i=1u; i<threadCount; ++i)
+    {
+        auto begin = std::min(rowsPerThread * i, rowCount);
+        auto end   = std::min(begin + rowsPerThread, rowCount);
+        workers.emplace_back([&kernel, begin, end]() { kernel.Run(begin, end); });
+    }
+
+    // 呼び出しスレッドも先頭バンドを処理する.
+    kernel.Run(0, std::min(rowsPerThread, rowCount));
+
+    for(auto& worker : workers)
+    { worker.join(); }
+
+    return true;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      CPU版カラーフィルタがサポートするフォーマットかどうかチェックします.
+//-----------------------------------------------------------------------------
+bool IsColorFilterSupported(uint32_t format)
+{ return GetTexelSize(format) != 0; }
+
+//-----------------------------------------------------------------------------
+//      カラー変換行列をCPUで適用します.
+//-----------------------------------------------------------------------------
+bool ApplyColorMatrix
+(
+    const asdx::Matrix&     matrix,
+    uint32_t                format,
+    asdx::SubResource&      subResource,
+    uint32_t                threadCount
+)
+{
+    MatrixOp op;
+    memcpy(op.M, matrix.m, sizeof(op.M));
+    return Dispatch(op, format, subResource, threadCount);
+}
+
+//-----------------------------------------------------------------------------
+//      リソーステクスチャの全サブリソースにカラー変換行列を適用します.
+//-----------------------------------------------------------------------------
+bool ApplyColorMatrix
+(
+    const asdx::Matrix&     matrix,
+    asdx::ResTexture&       texture,
+    uint32_t                threadCount
+)
+{
+    if (texture.pResources == nullptr)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
+
+    auto count = std::max(texture.MipMapCount, 1u) * std::max(texture.SurfaceCount, 1u);
+    for(auto i=0u; i<count; ++i)
+    {
+        if (!ApplyColorMatrix(matrix, texture.Format, texture.pResources[i], threadCount))
+        { return false; }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      3D LUTをCPUで適用します.
+//-----------------------------------------------------------------------------
+bool ApplyColorLut
+(
+    const ColorLut&         lut,
+    uint32_t                format,
+    asdx::SubResource&      subResource,
+    uint32_t                threadCount
+)
+{
+    if (lut.Size < 2 || lut.Texels.size() != size_t(lut.Size) * lut.Size * lut.Size * 4)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
+
+    LutOp op = { lut.Texels.data(), lut.Size };
+    return Dispatch(op, format, subResource, threadCount);
+}
+
+//-----------------------------------------------------------------------------
+//      リソーステクスチャの全サブリソースに3D LUTを適用します.
+//-----------------------------------------------------------------------------
+bool ApplyColorLut
+(
+    const ColorLut&         lut,
+    asdx::ResTexture&       texture,
+    uint32_t                threadCount
+)
+{
+    if (texture.pResources == nullptr)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
+
+    auto count = std::max(texture.MipMapCount, 1u) * std::max(texture.SurfaceCount, 1u);
+    for(auto i=0u; i<count; ++i)
+    {
+        if (!ApplyColorLut(lut, texture.Format, texture.pResources[i], threadCount))
+        { return false; }
+    }
+
+    return true;
+}
@@ -0,0 +1,346 @@
+﻿//-----------------------------------------------------------------------------
+// File : ColorLut.cpp
+// Desc : Color Lookup Table.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <ColorLut.h>
+#include <HalfFloat.h>
+#include <asdxLogger.h>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <new>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      行ベクトル規約でカラー変換行列を適用します.
+//-----------------------------------------------------------------------------
+inline void TransformColor(const asdx::Matrix& matrix, float* rgba)
+{
+    float result[4];
+    for(auto j=0; j<4; ++j)
+    {
+        result[j] = rgba[0] * matrix.m[0][j]
+                  + rgba[1] * matrix.m[1][j]
+                  + rgba[2] * matrix.m[2][j]
+                  + rgba[3] * matrix.m[3][j];
+    }
+    memcpy(rgba, result, sizeof(result));
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ColorChain class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+ColorChain::ColorChain()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      カラー変換行列を追加します.
+//-----------------------------------------------------------------------------
+void ColorChain::AddMatrix(const asdx::Matrix& matrix)
+{
+    // 連続する行列は1つにまとめる.
+    if (!m_Steps.empty() && m_Steps.back().IsMatrix)
+    {
+        m_Steps.back().Matrix = m_Steps.back().Matrix * matrix;
+        return;
+    }
+
+    Step step;
+    step.IsMatrix = true;
+    step.Matrix   = matrix;
+    m_Steps.push_back(step);
+}
+
+//-----------------------------------------------------------------------------
+//      RGB各チャンネルに適用するカーブを追加します.
+//-----------------------------------------------------------------------------
+void ColorChain::AddCurve(const std::function<float(float)>& curve)
+{
+    AddFunction([curve](float* rgba)
+    {
+        rgba[0] = curve(rgba[0]);
+        rgba[1] = curve(rgba[1]);
+        rgba[2] = curve(rgba[2]);
+    });
+}
+
+//-----------------------------------------------------------------------------
+//      任意の変換処理を追加します.
+//-----------------------------------------------------------------------------
+void ColorChain::AddFunction(const Function& function)
+{
+    Step step;
+    step.IsMatrix = false;
+    step.Matrix.Identity();
+    step.Func     = function;
+    m_Steps.push_back(step);
+}
+
+//-----------------------------------------------------------------------------
+//      ガンマカーブを追加します.
+//-----------------------------------------------------------------------------
+void ColorChain::AddGamma(float gamma)
+{
+    auto exponent = (gamma > 0.0f) ? 1.0f / gamma : 1.0f;
+    AddCurve([exponent](float value)
+    { return std::pow(std::max(value, 0.0f), exponent); });
+}
+
+//-----------------------------------------------------------------------------
+//      Sカーブを追加します.
+//-----------------------------------------------------------------------------
+void ColorChain::AddSCurve(float strength)
+{
+    AddCurve([strength](float value)
+    {
+        auto x = std::min(std::max(value, 0.0f), 1.0f);
+        auto s = x * x * (3.0f - 2.0f * x);
+        return value + (s - x) * strength;
+    });
+}
+
+//-----------------------------------------------------------------------------
+//      チェインを評価します.
+//-----------------------------------------------------------------------------
+void ColorChain::Evaluate(float* rgba) const
+{
+    for(auto& step : m_Steps)
+    {
+        if (step.IsMatrix)
+        { TransformColor(step.Matrix, rgba); }
+        else
+        { step.Func(rgba); }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      行列だけで表現できるかどうかチェックします.
+//-----------------------------------------------------------------------------
+bool ColorChain::IsLinear() const
+{
+    for(auto& step : m_Steps)
+    {
+        if (!step.IsMatrix)
+        { return false; }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      合成済みのカラー変換行列を取得します.
+//-----------------------------------------------------------------------------
+asdx::Matrix ColorChain::GetMatrix() const
+{
+    asdx::Matrix result;
+    result.Identity();
+
+    for(auto& step : m_Steps)
+    {
+        if (step.IsMatrix)
+        { result = result * step.Matrix; }
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      処理をすべて削除します.
+//-----------------------------------------------------------------------------
+void ColorChain::Clear()
+{ m_Steps.clear(); }
+
+
+//-----------------------------------------------------------------------------
+//      カラーチェインを3D LUTに焼き込みます.
+//-----------------------------------------------------------------------------
+bool BakeColorLut
+(
+    const ColorChain&   chain,
+    uint32_t            size,
+    ColorLut&           result,
+    uint32_t            threadCount
+)
+{
+    if (size < 2)
+    {
+        ELOGA("Error : Invalid Argument. size = %u", size);
+        return false;
+    }
+
+    result.Size = size;
+    result.Texels.resize(size_t(size) * size * size * 4);
+
+    auto scale = 1.0f / float(size - 1);
+    auto pTexels = result.Texels.data();
+
+    // Bスライス単位で評価.
+    auto bake = [&](uint32_t begin, uint32_t end)
+    {
+        for(auto b=begin; b<end; ++b)
+        {
+            for(auto g=0u; g<size; ++g)
+            {
+                for(auto r=0u; r<size; ++r)
+                {
+                    auto p = pTexels + ((size_t(b) * size + g) * size + r) * 4;
+                    p[0] = float(r) * scale;
+                    p[1] = float(g) * scale;
+                    p[2] = float(b) * scale;
+                    p[3] = 1.0f;
+                    chain.Evaluate(p);
+                }
+            }
+        }
+    };
+
+    if (threadCount == 0)
+    { threadCount = std::max(std::thread::hardware_concurrency(), 1u); }
+
+    threadCount = std::min(threadCount, size);
+
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount);
+
+    auto slicesPerThread = (size + threadCount - 1) / threadCount;
+    for(auto i=1u; i<threadCount; ++i)
+    {
+        auto begin = std::min(slicesPerThread * i, size);
+        auto end   = std::min(begin + slicesPerThread, size);
+        workers.emplace_back(bake, begin, end);
+    }
+
+    bake(0, std::min(slicesPerThread, size));
+
+    for(auto& worker : workers)
+    { worker.join(); }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      3D LUTからボリュームテクスチャのリソースを生成します.
+//-----------------------------------------------------------------------------
+bool CreateResTextureFromColorLut
+(
+    const ColorLut&     lut,
+    uint32_t            format,
+    asdx::ResTexture&   result
+)
+{
+    uint32_t texelSize = 0;
+    switch(format)
+    {
+    case DXGI_FORMAT_R16G16B16A16_FLOAT: texelSize = 8;  break;
+    case DXGI_FORMAT_R32G32B32A32_FLOAT: texelSize = 16; break;
+    }
+
+    if (texelSize == 0 || lut.Size < 2)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
+
+    auto count = size_t(lut.Size) * lut.Size * lut.Size;
+
+    auto pResource = new (std::nothrow) asdx::SubResource[1];
+    if (pResource == nullptr)
+    {
+        ELOGA("Error : Out of Memory.");
+        return false;
+    }
+
+    pResource->Width      = lut.Size;
+    pResource->Height     = lut.Size;
+    pResource->Pitch      = lut.Size * texelSize;
+    pResource->SlicePitch = uint32_t(count * texelSize);
+    pResource->pPixels    = ASDX_ALLOC_ASSET(pResource->SlicePitch, asdx::HEAP_TAG_TEXTURE);
+    if (pResource->pPixels == nullptr)
+    {
+        ELOGA("Error : Out of Memory.");
+        delete [] pResource;
+        return false;
+    }
+
+    if (format == DXGI_FORMAT_R32G32B32A32_FLOAT)
+    { memcpy(pResource->pPixels, lut.Texels.data(), pResource->SlicePitch); }
+    else
+    {
+        auto pDst = reinterpret_cast<uint16_t*>(pResource->pPixels);
+        for(size_t i=0; i<count * 4; ++i)
+        { pDst[i] = FloatToHalf(lut.Texels[i]); }
+    }
+
+    result.Width        = lut.Size;
+    result.Height       = lut.Size;
+    result.Depth        = lut.Size;
+    result.Format       = format;
+    result.MipMapCount  = 1;
+    result.SurfaceCount = 1;
+    result.Option       = 0;
+    result.pResources   = pResource;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      3D LUTを ColorTarget3D に転送します.
+//-----------------------------------------------------------------------------
+bool CreateColorTarget3DFromColorLut
+(
+    ID3D11Device*           pDevice,
+    ID3D11DeviceContext*    pContext,
+    const ColorLut&         lut,
+    asdx::ColorTarget3D&    target
+)
+{
+    if (pDevice == nullptr || pContext == nullptr)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
+
+    asdx::ResTexture res;
+    if (!CreateResTextureFromColorLut(lut, DXGI_FORMAT_R16G16B16A16_FLOAT, res))
+    { return false; }
+
+    asdx::TargetDesc3D desc;
+    desc.Width      = lut.Size;
+    desc.Height     = lut.Size;
+    desc.Depth      = lut.Size;
+    desc.MipLevels  = 1;
+    desc.Format     = DXGI_FORMAT_R16G16B16A16_FLOAT;
+
+    if (!target.Create(pDevice, desc))
+    {
+        ELOGA("Error : ColorTarget3D::Create() Failed.");
+        res.Release();
+        return false;
+    }
+
+    auto& sub = res.pResources[0];
+    pContext->UpdateSubresource(
+        target.GetResource(),
+        0,
+        nullptr,
+        sub.pPixels,
+        sub.Pitch,
+        sub.Pitch * sub.Height);
+
+    res.Release();
+    return true;
+}
@@ -0,0 +1,169 @@
+﻿//-----------------------------------------------------------------------------
+// File : DdsWriter.cpp
+// Desc : DDS File Writer.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <DdsWriter.h>
+#include <asdxLogger.h>
+#include <cstdio>
+#include <cstring>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t DDS_MAGIC                 = 0x20534444;  // "DDS "
+static const uint32_t DDSD_CAPS                 = 0x00000001;
+static const uint32_t DDSD_HEIGHT               = 0x00000002;
+static const uint32_t DDSD_WIDTH                = 0x00000004;
+static const uint32_t DDSD_PITCH                = 0x00000008;
+static const uint32_t DDSD_PIXELFORMAT          = 0x00001000;
+static const uint32_t DDSD_MIPMAPCOUNT          = 0x00020000;
+static const uint32_t DDSD_DEPTH                = 0x00800000;
+static const uint32_t DDPF_FOURCC               = 0x00000004;
+static const uint32_t DDSCAPS_COMPLEX           = 0x00000008;
+static const uint32_t DDSCAPS_TEXTURE           = 0x00001000;
+static const uint32_t DDSCAPS_MIPMAP            = 0x00400000;
+static const uint32_t DDSCAPS2_VOLUME           = 0x00200000;
+static const uint32_t FOURCC_DX10               = 0x30315844;  // "DX10"
+static const uint32_t DIMENSION_TEXTURE2D       = 3;
+static const uint32_t DIMENSION_TEXTURE3D       = 4;
+
+///////////////////////////////////////////////////////////////////////////////
+// DDSPixelFormat structure
+///////////////////////////////////////////////////////////////////////////////
+struct DDSPixelFormat
+{
+    uint32_t    Size;
+    uint32_t    Flags;
+    uint32_t    FourCC;
+    uint32_t    RGBBitCount;
+    uint32_t    RBitMask;
+    uint32_t    GBitMask;
+    uint32_t    BBitMask;
+    uint32_t    ABitMask;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// DDSHeader structure
+///////////////////////////////////////////////////////////////////////////////
+struct DDSHeader
+{
+    uint32_t        Size;
+    uint32_t        Flags;
+    uint32_t        Height;
+    uint32_t        Width;
+    uint32_t        PitchOrLinearSize;
+    uint32_t        Depth;
+    uint32_t        MipMapCount;
+    uint32_t        Reserved1[11];
+    DDSPixelFormat  PixelFormat;
+    uint32_t        Caps;
+    uint32_t        Caps2;
+    uint32_t        Caps3;
+    uint32_t        Caps4;
+    uint32_t        Reserved2;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// DDSHeaderDX10 structure
+///////////////////////////////////////////////////////////////////////////////
+struct DDSHeaderDX10
+{
+    uint32_t    Format;
+    uint32_t    Dimension;
+    uint32_t    MiscFlag;
+    uint32_t    ArraySize;
+    uint32_t    MiscFlags2;
+};
+
+static_assert(sizeof(DDSHeader)     == 124, "DDSHeader Size Mismatch.");
+static_assert(sizeof(DDSHeaderDX10) == 20,  "DDSHeaderDX10 Size Mismatch.");
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      リソーステクスチャをDDSファイルに保存します.
+//-----------------------------------------------------------------------------
+bool SaveToDDSFileA(const char* filename, const asdx::ResTexture& texture)
+{
+    if (filename == nullptr || texture.pResources == nullptr)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
+
+    auto isVolume     = (texture.Depth > 1);
+    auto mipMapCount  = (texture.MipMapCount  > 0) ? texture.MipMapCount  : 1;
+    auto surfaceCount = (texture.SurfaceCount > 0) ? texture.SurfaceCount : 1;
+
+    DDSHeader header = {};
+    header.Size                 = sizeof(DDSHeader);
+    header.Flags                = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_PITCH;
+    header.Height               = texture.Height;
+    header.Width                = texture.Width;
+    header.PitchOrLinearSize    = texture.pResources[0].Pitch;
+    header.Depth                = (isVolume) ? texture.Depth : 0;
+    header.MipMapCount          = mipMapCount;
+    header.PixelFormat.Size     = sizeof(DDSPixelFormat);
+    header.PixelFormat.Flags    = DDPF_FOURCC;
+    header.PixelFormat.FourCC   = FOURCC_DX10;
+    header.Caps                 = DDSCAPS_TEXTURE;
+
+    if (mipMapCount > 1)
+    {
+        header.Flags |= DDSD_MIPMAPCOUNT;
+        header.Caps  |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+    }
+
+    if (isVolume)
+    {
+        header.Flags |= DDSD_DEPTH;
+        header.Caps  |= DDSCAPS_COMPLEX;
+        header.Caps2 |= DDSCAPS2_VOLUME;
+    }
+
+    DDSHeaderDX10 ext = {};
+    ext.Format      = texture.Format;
+    ext.Dimension   = (isVolume) ? DIMENSION_TEXTURE3D : DIMENSION_TEXTURE2D;
+    ext.ArraySize   = (isVolume) ? 1 : surfaceCount;
+
+    FILE* pFile = nullptr;
+    auto err = fopen_s(&pFile, filename, "wb");
+    if (err != 0 || pFile == nullptr)
+    {
+        ELOGA("Error : File Open Failed. filename = %s", filename);
+        return false;
+    }
+
+    auto magic = DDS_MAGIC;
+    fwrite(&magic,  sizeof(magic),  1, pFile);
+    fwrite(&header, sizeof(header), 1, pFile);
+    fwrite(&ext,    sizeof(ext),    1, pFile);
+
+    // サーフェイス毎にミップレベル順で並んでいる前提.
+    auto count = mipMapCount * surfaceCount;
+    for(auto i=0u; i<count; ++i)
+    {
+        auto& res = texture.pResources[i];
+        if (res.pPixels == nullptr)
+        { continue; }
+
+        if (fwrite(res.pPixels, res.SlicePitch, 1, pFile) != 1)
+        {
+            ELOGA("Error : File Write Failed. filename = %s", filename);
+            fclose(pFile);
+            return false;
+        }
+    }
+
+    fclose(pFile);
+    return true;
+}
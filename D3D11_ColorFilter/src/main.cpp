@@ -8,6 +8,8 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include <App.h>
+#include <ColorFilterBatch.h>
+#include <cstring>
 
 
 //-----------------------------------------------------------------------------
@@ -15,6 +17,16 @@
 //-----------------------------------------------------------------------------
 int main(int argc, char** argv)
 {
+    // バッチモード(ウィンドウ, デバイスを生成せずにCPUで処理).
+    if (argc >= 2 && strcmp(argv[1], "-batch") == 0)
+    {
+        BatchDesc desc;
+        if (!ParseBatchArgs(argc, argv, desc))
+        { return -1; }
+
+        return RunColorFilterBatch(desc);
+    }
+
     App().Run();
 
     return 0;
@@ -0,0 +1,69 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchCache.h
+// Desc : Derived Data Cache Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __BENCH_CACHE_H__
+#define __BENCH_CACHE_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BenchDesc structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BenchDesc
+{
+    std::string Dir;            //!< キャッシュのディレクトリです. 開始時に中身を削除します.
+    uint32_t    Threads;        //!< 負荷試験のスレッド数です.
+    uint32_t    Operations;     //!< 負荷試験で1スレッドあたりに行う操作の数です.
+    uint32_t    Seed;           //!< 乱数シードです.
+
+    BenchDesc()
+    : Dir           ( "ddc_bench_cache" )
+    , Threads       ( 4 )
+    , Operations    ( 2000 )
+    , Seed          ( 0x12345678 )
+    { /* DO_NOTHING */ }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Random class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class Random
+{
+public:
+    explicit Random( uint32_t seed )
+    : m_State( ( seed != 0 ) ? seed : 0x9e3779b9 )
+    { /* DO_NOTHING */ }
+
+    uint32_t Next()
+    {
+        m_State ^= m_State << 13;
+        m_State ^= m_State >> 17;
+        m_State ^= m_State << 5;
+        return m_State;
+    }
+
+private:
+    uint32_t m_State;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      asdx::DerivedDataCache を検証し, 負荷試験を行います.
+//!
+//! @param[in]      desc        計測設定です.
+//! @retval true    全ての検証に成功.
+//! @retval false   検証に失敗.
+//-------------------------------------------------------------------------------------------------
+bool RunCache( const BenchDesc& desc );
+
+
+#endif//__BENCH_CACHE_H__
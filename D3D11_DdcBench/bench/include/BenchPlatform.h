@@ -0,0 +1,48 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchPlatform.h
+// Desc : Platform Compatibility Layer for Derived Data Cache Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __BENCH_PLATFORM_H__
+#define __BENCH_PLATFORM_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdio>
+#include <cstdint>
+#include <cerrno>
+
+
+//-------------------------------------------------------------------------------------------------
+// ベンチマークは asdx ライブラリをリンクしないため, キャッシュのログ出力をここで受け取ります.
+// このヘッダはコンパイラオプションで強制インクルード (/FI, -include) して使用します.
+// 破損したエントリを意図的に作るため, 破損時の警告は出力しません.
+//-------------------------------------------------------------------------------------------------
+#define DLOGA( fmt, ... )   ((void)0)
+#define ILOGA( fmt, ... )   fprintf( stderr, fmt "\n", ##__VA_ARGS__ )
+#define WLOGA( fmt, ... )   ((void)0)
+#define ELOGA( fmt, ... )   fprintf( stderr, "[File: %s, Line: %d] " fmt "\n", __FILE__, __LINE__, ##__VA_ARGS__ )
+#define ELOG                ELOGA
+
+
+#if !defined(_WIN32)
+//-------------------------------------------------------------------------------------------------
+//      Win32 CRT の fopen_s() 互換関数です.
+//-------------------------------------------------------------------------------------------------
+inline int fopen_s( FILE** ppFile, const char* path, const char* mode )
+{
+    *ppFile = fopen( path, mode );
+    return ( *ppFile != nullptr ) ? 0 : errno;
+}
+#endif//!defined(_WIN32)
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      高分解能タイマーの現在値を秒単位で取得します.
+//-------------------------------------------------------------------------------------------------
+double GetBenchTime();
+
+
+#endif//__BENCH_PLATFORM_H__
@@ -0,0 +1,489 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchCache.cpp
+// Desc : Derived Data Cache Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchPlatform.h>
+#include <BenchCache.h>
+#include <asdxDerivedDataCache.h>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <thread>
+#include <vector>
+
+
+//-------------------------------------------------------------------------------------------------
+// Macros
+//-------------------------------------------------------------------------------------------------
+#define BENCH_EXPECT( cond )                                                            \
+    if ( !( cond ) )                                                                    \
+    {                                                                                   \
+        fprintf( stderr, "    failed : %s (line %d)\n", #cond, __LINE__ );              \
+        return false;                                                                   \
+    }
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const uint32_t   kHeaderSize     = 40;               // キャッシュファイルのヘッダサイズです.
+static const uint32_t   kSizeOffset     = 24;               // ヘッダ内のデータサイズの位置です.
+static const uint32_t   kEntryCount     = 64;               // 基本の検証で格納するエントリ数です.
+static const uint32_t   kTrimEntrySize  = 4096;             // 削除の検証で格納するデータサイズです.
+static const uint32_t   kTrimCapacity   = 16;               // 削除の検証で上限に収まるエントリ数です.
+static const uint32_t   kStressKeys     = 256;              // 負荷試験のキーの数です.
+
+//-------------------------------------------------------------------------------------------------
+//      番号からキーを生成します.
+//-------------------------------------------------------------------------------------------------
+asdx::DerivedDataKey MakeKey( uint32_t index )
+{ return asdx::DerivedDataKeyBuilder( "ddc_bench", 1 ).AddValue( index ).GetKey(); }
+
+//-------------------------------------------------------------------------------------------------
+//      キャッシュファイルのパスを取得します.
+//-------------------------------------------------------------------------------------------------
+std::string GetPath( const BenchDesc& desc, const asdx::DerivedDataKey& key )
+{ return desc.Dir + "/" + key.ToString() + ".ddc"; }
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルが存在するかどうかを判定します.
+//-------------------------------------------------------------------------------------------------
+bool FileExists( const std::string& path )
+{
+    auto pFile = fopen( path.c_str(), "rb" );
+    if ( pFile == nullptr )
+    { return false; }
+
+    fclose( pFile );
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ランダムなデータを生成します.
+//-------------------------------------------------------------------------------------------------
+std::vector<uint8_t> MakeData( Random& random, size_t size )
+{
+    std::vector<uint8_t> result( size );
+    for( auto& value : result )
+    { value = uint8_t( random.Next() >> 24 ); }
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      例外を破損の見逃しとして扱い, データを取得します.
+//-------------------------------------------------------------------------------------------------
+bool SafeGet( const asdx::DerivedDataKey& key, std::vector<uint8_t>& result, bool& thrown )
+{
+    thrown = false;
+    try
+    { return asdx::DerivedDataCache::GetInstance().Get( key, result ); }
+    catch( std::exception& e )
+    {
+        fprintf( stderr, "    exception : %s\n", e.what() );
+        thrown = true;
+        return false;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      キャッシュを初期化します.
+//-------------------------------------------------------------------------------------------------
+bool InitCache( const BenchDesc& desc, uint64_t maxSize, uint32_t trimPercent )
+{
+    asdx::DerivedDataCacheDesc cacheDesc;
+    cacheDesc.Dir         = desc.Dir;
+    cacheDesc.MaxSize     = maxSize;
+    cacheDesc.TrimPercent = trimPercent;
+
+    auto& cache = asdx::DerivedDataCache::GetInstance();
+    cache.Term();
+    return cache.Init( cacheDesc );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      格納, 取得, 置き換え, 削除を確認します.
+//-------------------------------------------------------------------------------------------------
+bool CheckPutGet( const BenchDesc& desc, Random& random )
+{
+    auto& cache = asdx::DerivedDataCache::GetInstance();
+    BENCH_EXPECT( InitCache( desc, 1024ull * 1024 * 1024, 90 ) );
+    cache.Clear();
+    cache.ResetStats();
+
+    // 先頭は空のデータです.
+    std::vector<std::vector<uint8_t>> data;
+    uint64_t totalSize = 0;
+    for( auto i=0u; i<kEntryCount; ++i )
+    {
+        data.push_back( MakeData( random, ( i == 0 ) ? 0 : random.Next() % 65536 ) );
+        BENCH_EXPECT( cache.Put( MakeKey( i ), data[i].data(), data[i].size() ) );
+        totalSize += kHeaderSize + data[i].size();
+    }
+
+    auto stats = cache.GetStats();
+    BENCH_EXPECT( stats.WriteCount == kEntryCount );
+    BENCH_EXPECT( stats.EntryCount == kEntryCount );
+    BENCH_EXPECT( stats.TotalSize  == totalSize );
+
+    std::vector<uint8_t> result;
+    for( auto i=0u; i<kEntryCount; ++i )
+    {
+        BENCH_EXPECT( cache.Get( MakeKey( i ), result ) );
+        BENCH_EXPECT( result == data[i] );
+    }
+
+    BENCH_EXPECT( !cache.Get( MakeKey( kEntryCount ), result ) );
+
+    stats = cache.GetStats();
+    BENCH_EXPECT( stats.HitCount  == kEntryCount );
+    BENCH_EXPECT( stats.MissCount == 1 );
+
+    // 同じキーで格納すると置き換わり, エントリ数は変わりません.
+    auto other = MakeData( random, 1000 );
+    BENCH_EXPECT( cache.Put( MakeKey( 1 ), other.data(), other.size() ) );
+    BENCH_EXPECT( cache.Get( MakeKey( 1 ), result ) );
+    BENCH_EXPECT( result == other );
+    BENCH_EXPECT( cache.GetStats().EntryCount == kEntryCount );
+
+    // 削除するとファイルも無くなります.
+    cache.Remove( MakeKey( 2 ) );
+    BENCH_EXPECT( !cache.Get( MakeKey( 2 ), result ) );
+    BENCH_EXPECT( !FileExists( GetPath( desc, MakeKey( 2 ) ) ) );
+    BENCH_EXPECT( cache.GetStats().EntryCount == kEntryCount - 1 );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      上限を超えた場合に最も長く参照されていないエントリから削除されることを確認します.
+//-------------------------------------------------------------------------------------------------
+bool CheckTrim( const BenchDesc& desc, Random& random )
+{
+    auto& cache   = asdx::DerivedDataCache::GetInstance();
+    auto  maxSize = uint64_t( kTrimCapacity ) * ( kHeaderSize + kTrimEntrySize );
+    BENCH_EXPECT( InitCache( desc, maxSize, 75 ) );
+    cache.Clear();
+    cache.ResetStats();
+
+    std::vector<uint8_t> result;
+    std::vector<std::vector<uint8_t>> data;
+    for( auto i=0u; i<kTrimCapacity * 2; ++i )
+    {
+        data.push_back( MakeData( random, kTrimEntrySize ) );
+        BENCH_EXPECT( cache.Put( MakeKey( i ), data[i].data(), data[i].size() ) );
+        BENCH_EXPECT( cache.GetStats().TotalSize <= maxSize );
+
+        // 先頭のエントリは毎回参照して削除されないようにします.
+        BENCH_EXPECT( cache.Get( MakeKey( 0 ), result ) );
+        BENCH_EXPECT( result == data[0] );
+    }
+
+    auto stats = cache.GetStats();
+    BENCH_EXPECT( stats.EvictCount > 0 );
+    BENCH_EXPECT( stats.EntryCount + stats.EvictCount == kTrimCapacity * 2 );
+
+    // 参照していない古いエントリはファイルごと削除され, 新しいエントリは残ります.
+    BENCH_EXPECT( !FileExists( GetPath( desc, MakeKey( 1 ) ) ) );
+    BENCH_EXPECT( !cache.Get( MakeKey( 1 ), result ) );
+
+    auto last = kTrimCapacity * 2 - 1;
+    BENCH_EXPECT( cache.Get( MakeKey( last ), result ) );
+    BENCH_EXPECT( result == data[last] );
+
+    // 単体で上限を超えるデータは格納しません.
+    std::vector<uint8_t> large( static_cast<size_t>( maxSize ) );
+    BENCH_EXPECT( !cache.Put( MakeKey( 1000 ), large.data(), large.size() ) );
+    BENCH_EXPECT( cache.GetStats().TotalSize <= maxSize );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      再初期化で既存のファイルから索引が復元されることを確認します.
+//-------------------------------------------------------------------------------------------------
+bool CheckReinit( const BenchDesc& desc, Random& random )
+{
+    auto& cache = asdx::DerivedDataCache::GetInstance();
+    BENCH_EXPECT( InitCache( desc, 1024ull * 1024 * 1024, 90 ) );
+    cache.Clear();
+
+    std::vector<std::vector<uint8_t>> data;
+    for( auto i=0u; i<kEntryCount; ++i )
+    {
+        data.push_back( MakeData( random, 1 + random.Next() % 16384 ) );
+        BENCH_EXPECT( cache.Put( MakeKey( i ), data[i].data(), data[i].size() ) );
+    }
+
+    auto before = cache.GetStats();
+
+    // 書き込み途中で終了したプロセスの一時ファイルは索引に含まれません.
+    auto temp = GetPath( desc, MakeKey( kEntryCount ) ) + ".1-1.tmp";
+    auto pFile = fopen( temp.c_str(), "wb" );
+    BENCH_EXPECT( pFile != nullptr );
+    fputs( "partial", pFile );
+    fclose( pFile );
+
+    BENCH_EXPECT( InitCache( desc, 1024ull * 1024 * 1024, 90 ) );
+
+    auto after = cache.GetStats();
+    BENCH_EXPECT( after.EntryCount == before.EntryCount );
+    BENCH_EXPECT( after.TotalSize  == before.TotalSize );
+
+    std::vector<uint8_t> result;
+    for( auto i=0u; i<kEntryCount; ++i )
+    {
+        BENCH_EXPECT( cache.Get( MakeKey( i ), result ) );
+        BENCH_EXPECT( result == data[i] );
+    }
+    remove( temp.c_str() );
+
+    // 上限を小さくして初期化すると, その場で上限内に削除されます.
+    auto maxSize = before.TotalSize / 2;
+    BENCH_EXPECT( InitCache( desc, maxSize, 90 ) );
+    BENCH_EXPECT( cache.GetStats().TotalSize <= maxSize );
+    BENCH_EXPECT( cache.GetStats().EntryCount < kEntryCount );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルの一部を書き換えます.
+//-------------------------------------------------------------------------------------------------
+bool PatchFile( const std::string& path, long offset, const void* pData, size_t size )
+{
+    auto pFile = fopen( path.c_str(), "r+b" );
+    if ( pFile == nullptr )
+    { return false; }
+
+    auto ret = ( fseek( pFile, offset, SEEK_SET ) == 0 )
+            && ( fwrite( pData, 1, size, pFile ) == size );
+    fclose( pFile );
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルの先頭から指定サイズを読み込みます.
+//-------------------------------------------------------------------------------------------------
+bool ReadFile( const std::string& path, size_t size, std::vector<uint8_t>& result )
+{
+    auto pFile = fopen( path.c_str(), "rb" );
+    if ( pFile == nullptr )
+    { return false; }
+
+    result.resize( size );
+    auto ret = ( fread( result.data(), 1, size, pFile ) == size );
+    fclose( pFile );
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルを書き出します.
+//-------------------------------------------------------------------------------------------------
+bool WriteFile( const std::string& path, const std::vector<uint8_t>& data )
+{
+    auto pFile = fopen( path.c_str(), "wb" );
+    if ( pFile == nullptr )
+    { return false; }
+
+    auto ret = ( fwrite( data.data(), 1, data.size(), pFile ) == data.size() );
+    fclose( pFile );
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      破損したファイルが失敗として扱われ, 削除されることを確認します.
+//-------------------------------------------------------------------------------------------------
+bool CheckCorrupt( const BenchDesc& desc, Random& random )
+{
+    auto& cache = asdx::DerivedDataCache::GetInstance();
+    BENCH_EXPECT( InitCache( desc, 1024ull * 1024 * 1024, 90 ) );
+    cache.Clear();
+    cache.ResetStats();
+
+    static const uint32_t kCaseCount = 5;
+
+    // 最後のエントリは別のキーのファイルとして複製するため, 破損させません.
+    std::vector<std::vector<uint8_t>> data;
+    for( auto i=0u; i<=kCaseCount; ++i )
+    {
+        data.push_back( MakeData( random, 1000 ) );
+        BENCH_EXPECT( cache.Put( MakeKey( i ), data[i].data(), data[i].size() ) );
+    }
+
+    // 本体の 1byte を書き換えます (CRC 不一致).
+    uint8_t flip = data[0][500] ^ 0xFF;
+    BENCH_EXPECT( PatchFile( GetPath( desc, MakeKey( 0 ) ), kHeaderSize + 500, &flip, 1 ) );
+
+    // データサイズを巨大な値にします. 確保する前に失敗する必要があります.
+    uint64_t hugeSize = 0x7FFFFFFFFFFFFFFFull;
+    BENCH_EXPECT( PatchFile( GetPath( desc, MakeKey( 1 ) ), kSizeOffset, &hugeSize, sizeof(hugeSize) ) );
+
+    // データサイズを実際より小さくします.
+    uint64_t shortSize = data[2].size() - 1;
+    BENCH_EXPECT( PatchFile( GetPath( desc, MakeKey( 2 ) ), kSizeOffset, &shortSize, sizeof(shortSize) ) );
+
+    // 書き込み途中で途切れたファイルです.
+    std::vector<uint8_t> file;
+    BENCH_EXPECT( ReadFile( GetPath( desc, MakeKey( 3 ) ), kHeaderSize + data[3].size() / 2, file ) );
+    BENCH_EXPECT( WriteFile( GetPath( desc, MakeKey( 3 ) ), file ) );
+
+    // 別のキーのファイルです. 内容は正しいため, ヘッダのキーでしか検出できません.
+    BENCH_EXPECT( ReadFile( GetPath( desc, MakeKey( kCaseCount ) ), kHeaderSize + data[kCaseCount].size(), file ) );
+    BENCH_EXPECT( WriteFile( GetPath( desc, MakeKey( 4 ) ), file ) );
+
+    std::vector<uint8_t> result;
+    for( auto i=0u; i<kCaseCount; ++i )
+    {
+        bool thrown;
+        BENCH_EXPECT( !SafeGet( MakeKey( i ), result, thrown ) );
+        BENCH_EXPECT( !thrown );
+        BENCH_EXPECT( result.empty() );
+        BENCH_EXPECT( !FileExists( GetPath( desc, MakeKey( i ) ) ) );
+    }
+
+    auto stats = cache.GetStats();
+    BENCH_EXPECT( stats.CorruptCount == kCaseCount );
+    BENCH_EXPECT( stats.MissCount    == kCaseCount );
+    BENCH_EXPECT( stats.EntryCount   == 1 );
+    BENCH_EXPECT( stats.TotalSize    == kHeaderSize + data[kCaseCount].size() );
+
+    // 削除された後は通常どおり格納できます.
+    BENCH_EXPECT( cache.Put( MakeKey( 1 ), data[1].data(), data[1].size() ) );
+    BENCH_EXPECT( cache.Get( MakeKey( 1 ), result ) );
+    BENCH_EXPECT( result == data[1] );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      負荷試験のデータを生成します. 先頭にキーと世代を埋め込み, 取得時に検証できるようにします.
+//-------------------------------------------------------------------------------------------------
+void MakeStressData( uint32_t key, uint32_t version, std::vector<uint8_t>& result )
+{
+    Random random( key * 2654435761u + version );
+    result.resize( 12 + random.Next() % 32768 );
+
+    auto size = uint32_t( result.size() );
+    memcpy( &result[0], &key,     sizeof(key) );
+    memcpy( &result[4], &version, sizeof(version) );
+    memcpy( &result[8], &size,    sizeof(size) );
+
+    for( size_t i=12; i<result.size(); ++i )
+    { result[i] = uint8_t( random.Next() >> 24 ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      複数スレッドから格納と取得を行います. 上限は全キーの半分程度にして削除も発生させます.
+//-------------------------------------------------------------------------------------------------
+bool CheckStress( const BenchDesc& desc, char* stats, size_t statsSize )
+{
+    auto& cache = asdx::DerivedDataCache::GetInstance();
+    BENCH_EXPECT( InitCache( desc, uint64_t( kStressKeys ) * 16384 / 2, 90 ) );
+    cache.Clear();
+    cache.ResetStats();
+
+    std::atomic<uint32_t> failed( 0 );
+    std::vector<std::thread> threads;
+    auto start = GetBenchTime();
+
+    for( auto t=0u; t<desc.Threads; ++t )
+    {
+        threads.emplace_back( [&, t]()
+        {
+            Random random( desc.Seed + t * 7919 );
+            std::vector<uint8_t> data;
+            std::vector<uint8_t> result;
+
+            for( auto i=0u; i<desc.Operations; ++i )
+            {
+                auto key = random.Next() % kStressKeys;
+
+                // 1/4 は格納, 残りは取得です. 取得できた場合は埋め込んだ値で内容を検証します.
+                if ( random.Next() % 4 == 0 )
+                {
+                    MakeStressData( key, random.Next() % 4, data );
+                    if ( !cache.Put( MakeKey( key ), data.data(), data.size() ) )
+                    { failed++; }
+                }
+                else if ( cache.Get( MakeKey( key ), result ) )
+                {
+                    uint32_t version = 0;
+                    if ( result.size() >= 12 )
+                    { memcpy( &version, &result[4], sizeof(version) ); }
+
+                    MakeStressData( key, version, data );
+                    if ( result != data )
+                    { failed++; }
+                }
+            }
+        });
+    }
+
+    for( auto& thread : threads )
+    { thread.join(); }
+
+    auto totalSec = GetBenchTime() - start;
+    auto diff     = cache.GetStats();
+
+    BENCH_EXPECT( failed.load() == 0 );
+    BENCH_EXPECT( diff.CorruptCount == 0 );
+    BENCH_EXPECT( diff.TotalSize <= uint64_t( kStressKeys ) * 16384 / 2 );
+
+    snprintf( stats, statsSize, "%llu puts, %llu hits, %llu misses, %llu evicted, %.0f ops/s, %.1f MB/s",
+        (unsigned long long)diff.WriteCount,
+        (unsigned long long)diff.HitCount,
+        (unsigned long long)diff.MissCount,
+        (unsigned long long)diff.EvictCount,
+        double( desc.Threads ) * double( desc.Operations ) / totalSec,
+        double( diff.ReadBytes + diff.WriteBytes ) / ( 1024.0 * 1024.0 ) / totalSec );
+
+    return true;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      asdx::DerivedDataCache を検証します.
+//-------------------------------------------------------------------------------------------------
+bool RunCache( const BenchDesc& desc )
+{
+    auto ret = true;
+
+    printf( "derived data cache, dir %s, %u threads x %u operations\n",
+        desc.Dir.c_str(), desc.Threads, desc.Operations );
+    printf( "  %-10s %-6s %s\n", "check", "result", "stats" );
+    fflush( stdout );
+
+    auto report = [&]( const char* name, bool result, const char* stats )
+    {
+        printf( "  %-10s %-6s %s\n", name, result ? "ok" : "FAILED", stats );
+        fflush( stdout );
+        ret = ret && result;
+    };
+
+    Random random( desc.Seed );
+
+    report( "put/get", CheckPutGet ( desc, random ), "" );
+    report( "trim",    CheckTrim   ( desc, random ), "" );
+    report( "reinit",  CheckReinit ( desc, random ), "" );
+    report( "corrupt", CheckCorrupt( desc, random ), "" );
+
+    char stats[256] = {};
+    report( "stress", CheckStress( desc, stats, sizeof(stats) ), stats );
+
+    // 次回の実行に残さないよう, 作成したファイルを削除します.
+    auto& cache = asdx::DerivedDataCache::GetInstance();
+    if ( cache.IsInit() )
+    { cache.Clear(); }
+    cache.Term();
+
+    return ret;
+}
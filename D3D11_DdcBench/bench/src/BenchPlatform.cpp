@@ -0,0 +1,21 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchPlatform.cpp
+// Desc : Platform Compatibility Layer for Derived Data Cache Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchPlatform.h>
+#include <chrono>
+
+
+//-------------------------------------------------------------------------------------------------
+//      高分解能タイマーの現在値を秒単位で取得します.
+//-------------------------------------------------------------------------------------------------
+double GetBenchTime()
+{
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double>( now ).count();
+}
@@ -0,0 +1,77 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : main.cpp
+// Desc : Derived Data Cache Benchmark Main Entry Point.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchPlatform.h>
+#include <BenchCache.h>
+#include <cstdlib>
+#include <cstring>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+//      使用方法を表示します.
+//-------------------------------------------------------------------------------------------------
+void PrintUsage()
+{
+    printf( "Usage : ddc_bench [options]\n" );
+    printf( "  -dir <dir>           cache directory, emptied on start (default: ddc_bench_cache)\n" );
+    printf( "  -threads <N>         threads of the stress check (default: 4)\n" );
+    printf( "  -ops <N>             operations per thread of the stress check (default: 2000)\n" );
+    printf( "  -seed <N>            random seed (default: 305419896)\n" );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      コマンドライン引数を解析します.
+//-------------------------------------------------------------------------------------------------
+bool ParseArgs( int argc, char** argv, BenchDesc& desc )
+{
+    for( auto i=1; i<argc; ++i )
+    {
+        auto hasNext = ( i + 1 < argc );
+
+        if ( strcmp( argv[i], "-dir" ) == 0 && hasNext )
+        { desc.Dir = argv[++i]; }
+        else if ( strcmp( argv[i], "-threads" ) == 0 && hasNext )
+        { desc.Threads = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else if ( strcmp( argv[i], "-ops" ) == 0 && hasNext )
+        { desc.Operations = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else if ( strcmp( argv[i], "-seed" ) == 0 && hasNext )
+        { desc.Seed = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else
+        {
+            fprintf( stderr, "Error : Unknown Option. option = %s\n", argv[i] );
+            PrintUsage();
+            return false;
+        }
+    }
+
+    if ( desc.Threads == 0 )
+    {
+        fprintf( stderr, "Error : Invalid Thread Count. threads = %u\n", desc.Threads );
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-------------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+    BenchDesc desc;
+    if ( !ParseArgs( argc, argv, desc ) )
+    { return 1; }
+
+    return RunCache( desc ) ? 0 : 1;
+}
@@ -630,6 +630,7 @@ bool ResDDS::Load( const char16* filename )
     if ( format == DDS_FORMAT_UNKNOWN )
     {
         ELOG( "Error : Unsupported Format." );
+        fclose( pFile );
         return false;
     }
 
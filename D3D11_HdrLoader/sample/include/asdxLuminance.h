@@ -0,0 +1,179 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxLuminance.h
+// Desc : Luminance Histogram and Auto Exposure.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_LUMINANCE_H__
+#define __ASDX_LUMINANCE_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxTypedef.h>
+#include <asdxResHDR.h>
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const u32 LUMINANCE_HISTOGRAM_BINS   = 256;      //!< ヒストグラムのビン数です.
+static const f32 LUMINANCE_MIN_LOG2         = -16.0f;   //!< ヒストグラムが扱う最小の log2 輝度です.
+static const f32 LUMINANCE_MAX_LOG2         = 16.0f;    //!< ヒストグラムが扱う最大の log2 輝度です.
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TONEMAP_TYPE enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum TONEMAP_TYPE
+{
+    TONEMAP_REINHARD = 0,       //!< Reinhard ( x / (1 + x) ) です.
+    TONEMAP_ACES_FITTED,        //!< ACES RRT + ODT のフィッティング近似です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LuminanceStats structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct LuminanceStats
+{
+    u32     PixelCount;                             //!< 集計したピクセル数です.
+    u32     BlackCount;                             //!< ヒストグラム範囲未満(ほぼ黒)のピクセル数です.
+    f32     MinLuminance;                           //!< 最小輝度です.
+    f32     MaxLuminance;                           //!< 最大輝度です.
+    f32     AverageLuminance;                       //!< 算術平均輝度です.
+    f32     LogAverageLuminance;                    //!< 対数平均(幾何平均)輝度です. 黒ピクセルは除外します.
+    u32     Histogram[ LUMINANCE_HISTOGRAM_BINS ];  //!< log2 輝度のヒストグラムです.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    LuminanceStats();
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AutoExposureDesc structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct AutoExposureDesc
+{
+    f32     LowPercent;         //!< 平均から除外する暗部の割合です [0, 1].
+    f32     HighPercent;        //!< 平均に含める明部の上限の割合です [0, 1].
+    f32     Key;                //!< キー値です. 0 以下の場合は平均輝度から自動で求めます.
+    f32     MinExposure;        //!< 露光値の下限です.
+    f32     MaxExposure;        //!< 露光値の上限です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    AutoExposureDesc()
+    : LowPercent    ( 0.5f )
+    , HighPercent   ( 0.95f )
+    , Key           ( 0.18f )
+    , MinExposure   ( 1.0f / 65536.0f )
+    , MaxExposure   ( 65536.0f )
+    { /* DO_NOTHING */ }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      RGBE画像の輝度統計を並列に計算します.
+//!
+//! @param[in]      image           HDR画像です.
+//! @param[out]     result          輝度統計の格納先です.
+//! @param[in]      threadCount     使用するスレッド数です(0の場合はハードウェアスレッド数).
+//! @retval true    計算に成功.
+//! @retval false   計算に失敗.
+//! @note       輝度は Rec.709 の係数で求めます. ファイルに記録された値をそのまま集計するため
+//!             EXPOSURE ヘッダによる補正は行いません.
+//-------------------------------------------------------------------------------------------------
+bool ComputeLuminanceStats( const ResHDR& image, LuminanceStats& result, u32 threadCount = 0 );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      浮動小数点画像の輝度統計を並列に計算します.
+//!
+//! @param[in]      pPixels         ピクセルデータです.
+//! @param[in]      width           横幅です.
+//! @param[in]      height          縦幅です.
+//! @param[in]      components      1ピクセル当たりの要素数です(3 = RGB, 4 = RGBA).
+//! @param[out]     result          輝度統計の格納先です.
+//! @param[in]      threadCount     使用するスレッド数です(0の場合はハードウェアスレッド数).
+//! @retval true    計算に成功.
+//! @retval false   計算に失敗.
+//-------------------------------------------------------------------------------------------------
+bool ComputeLuminanceStats(
+    const f32*      pPixels,
+    u32             width,
+    u32             height,
+    u32             components,
+    LuminanceStats& result,
+    u32             threadCount = 0 );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ヒストグラムから指定パーセンタイルの輝度を求めます.
+//!
+//! @param[in]      stats           輝度統計です.
+//! @param[in]      percent         パーセンタイルです [0, 1].
+//! @return     指定パーセンタイルの輝度を返却します.
+//-------------------------------------------------------------------------------------------------
+f32 ComputePercentileLuminance( const LuminanceStats& stats, f32 percent );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      自動露光値を求めます.
+//!
+//! @param[in]      stats           輝度統計です.
+//! @param[in]      desc            自動露光の設定です.
+//! @return     ピクセル値に乗算する露光値を返却します.
+//! @note       [LowPercent, HighPercent] の範囲のヒストグラムから対数平均輝度を求め,
+//!             Key / 平均輝度 を露光値とします.
+//-------------------------------------------------------------------------------------------------
+f32 ComputeAutoExposure( const LuminanceStats& stats, const AutoExposureDesc& desc );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      RGBE画像をトーンマップして RGBA8 (sRGB) に変換します.
+//!
+//! @param[in]      image           HDR画像です.
+//! @param[in]      exposure        露光値です.
+//! @param[in]      type            トーンマップの種類です.
+//! @param[out]     pResult         出力先です(横幅 x 縦幅 x 4 バイト).
+//! @param[in]      threadCount     使用するスレッド数です(0の場合はハードウェアスレッド数).
+//! @retval true    変換に成功.
+//! @retval false   変換に失敗.
+//-------------------------------------------------------------------------------------------------
+bool TonemapToRGBA8(
+    const ResHDR&   image,
+    f32             exposure,
+    TONEMAP_TYPE    type,
+    u8*             pResult,
+    u32             threadCount = 0 );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      浮動小数点画像をトーンマップして RGBA8 (sRGB) に変換します.
+//!
+//! @param[in]      pPixels         ピクセルデータです.
+//! @param[in]      width           横幅です.
+//! @param[in]      height          縦幅です.
+//! @param[in]      components      1ピクセル当たりの要素数です(3 = RGB, 4 = RGBA).
+//! @param[in]      exposure        露光値です.
+//! @param[in]      type            トーンマップの種類です.
+//! @param[out]     pResult         出力先です(横幅 x 縦幅 x 4 バイト).
+//! @param[in]      threadCount     使用するスレッド数です(0の場合はハードウェアスレッド数).
+//! @retval true    変換に成功.
+//! @retval false   変換に失敗.
+//-------------------------------------------------------------------------------------------------
+bool TonemapToRGBA8(
+    const f32*      pPixels,
+    u32             width,
+    u32             height,
+    u32             components,
+    f32             exposure,
+    TONEMAP_TYPE    type,
+    u8*             pResult,
+    u32             threadCount = 0 );
+
+} // namespace asdx
+
+
+#endif//__ASDX_LUMINANCE_H__
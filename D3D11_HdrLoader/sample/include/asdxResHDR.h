@@ -95,6 +95,13 @@ public:
     //---------------------------------------------------------------------------------------------
     const f32 GetExposure() const;
 
+    //---------------------------------------------------------------------------------------------
+    //! @brief      K}l擾܂.
+    //!
+    //! @return     K}lԋp܂.
+    //---------------------------------------------------------------------------------------------
+    const f32 GetGamma() const;
+
     //---------------------------------------------------------------------------------------------
     //! @brief      sNZf[^擾܂.
     //!
@@ -0,0 +1,715 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxLuminance.cpp
+// Desc : Luminance Histogram and Auto Exposure.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxLuminance.h>
+#include <asdxLogger.h>
+#include <emmintrin.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const f32 LUMA_R         = 0.2126f;      // Rec.709 輝度係数(R).
+static const f32 LUMA_G         = 0.7152f;      // Rec.709 輝度係数(G).
+static const f32 LUMA_B         = 0.0722f;      // Rec.709 輝度係数(B).
+static const u32 MIN_ROWS       = 8;            // スレッド当たりの最小行数.
+static const u32 SRGB_LUT_SIZE  = 4096;         // sRGBエンコードテーブルのサイズ.
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Accumulator structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct Accumulator
+{
+    u32     Histogram[ asdx::LUMINANCE_HISTOGRAM_BINS ];
+    u32     PixelCount;
+    u32     BlackCount;
+    f32     MinLuminance;
+    f32     MaxLuminance;
+    f64     Sum;
+    f64     LogSum;
+    u8      Padding[64];    // 隣接スレッドとのフォルスシェアリング回避.
+
+    Accumulator()
+    : PixelCount    ( 0 )
+    , BlackCount    ( 0 )
+    , MinLuminance  ( FLT_MAX )
+    , MaxLuminance  ( 0.0f )
+    , Sum           ( 0.0 )
+    , LogSum        ( 0.0 )
+    { memset( Histogram, 0, sizeof(Histogram) ); }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SrgbTable structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct SrgbTable
+{
+    u8  Value[ SRGB_LUT_SIZE ];
+
+    SrgbTable()
+    {
+        for( u32 i=0; i<SRGB_LUT_SIZE; ++i )
+        {
+            auto x = f32(i) / f32(SRGB_LUT_SIZE - 1);
+            auto s = ( x <= 0.0031308f ) ? x * 12.92f : 1.055f * powf( x, 1.0f / 2.4f ) - 0.055f;
+            Value[i] = u8( s * 255.0f + 0.5f );
+        }
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+//      sRGBエンコードテーブルを取得します.
+//-------------------------------------------------------------------------------------------------
+const SrgbTable& GetSrgbTable()
+{
+    static const SrgbTable s_Table;
+    return s_Table;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      log2 を近似計算します.
+//-------------------------------------------------------------------------------------------------
+inline __m128 Log2( __m128 x )
+{
+    // x = m * 2^e, m は [sqrt(1/2), sqrt(2)) に正規化.
+    auto bits = _mm_castps_si128( x );
+    auto e    = _mm_sub_epi32( _mm_srli_epi32( bits, 23 ), _mm_set1_epi32( 127 ) );
+    auto m    = _mm_castsi128_ps( _mm_or_si128(
+        _mm_and_si128( bits, _mm_set1_epi32( 0x007FFFFF ) ),
+        _mm_set1_epi32( 0x3F800000 ) ) );
+
+    auto over = _mm_cmpgt_ps( m, _mm_set1_ps( 1.41421356f ) );
+    m = _mm_or_ps( _mm_andnot_ps( over, m ), _mm_and_ps( over, _mm_mul_ps( m, _mm_set1_ps( 0.5f ) ) ) );
+    e = _mm_sub_epi32( e, _mm_castps_si128( over ) );   // over は -1 なので減算で +1.
+
+    // ln(m) = 2 * atanh(s), s = (m - 1) / (m + 1).
+    auto one = _mm_set1_ps( 1.0f );
+    auto s   = _mm_div_ps( _mm_sub_ps( m, one ), _mm_add_ps( m, one ) );
+    auto s2  = _mm_mul_ps( s, s );
+    auto p   = _mm_add_ps( _mm_set1_ps( 1.0f / 7.0f ), _mm_mul_ps( s2, _mm_set1_ps( 1.0f / 9.0f ) ) );
+    p = _mm_add_ps( _mm_set1_ps( 1.0f / 5.0f ), _mm_mul_ps( s2, p ) );
+    p = _mm_add_ps( _mm_set1_ps( 1.0f / 3.0f ), _mm_mul_ps( s2, p ) );
+    p = _mm_add_ps( one, _mm_mul_ps( s2, p ) );
+
+    // 2 / ln(2).
+    auto ln2 = _mm_mul_ps( _mm_mul_ps( s, p ), _mm_set1_ps( 2.88539008f ) );
+    return _mm_add_ps( _mm_cvtepi32_ps( e ), ln2 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      水平方向の合計を求めます.
+//-------------------------------------------------------------------------------------------------
+inline f32 HorizontalSum( __m128 v )
+{
+    auto t = _mm_add_ps( v, _mm_movehl_ps( v, v ) );
+    t = _mm_add_ss( t, _mm_shuffle_ps( t, t, 1 ) );
+    return _mm_cvtss_f32( t );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      水平方向の最小値を求めます.
+//-------------------------------------------------------------------------------------------------
+inline f32 HorizontalMin( __m128 v )
+{
+    auto t = _mm_min_ps( v, _mm_movehl_ps( v, v ) );
+    t = _mm_min_ss( t, _mm_shuffle_ps( t, t, 1 ) );
+    return _mm_cvtss_f32( t );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      水平方向の最大値を求めます.
+//-------------------------------------------------------------------------------------------------
+inline f32 HorizontalMax( __m128 v )
+{
+    auto t = _mm_max_ps( v, _mm_movehl_ps( v, v ) );
+    t = _mm_max_ss( t, _mm_shuffle_ps( t, t, 1 ) );
+    return _mm_cvtss_f32( t );
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// RowSource structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct RowSource
+{
+    const u8*   pRGBE;          //!< RGBEピクセル(nullptrの場合は浮動小数点).
+    const f32*  pFloat;         //!< 浮動小数点ピクセル.
+    u32         Width;          //!< 横幅.
+    u32         Components;     //!< 浮動小数点ピクセルの要素数.
+    f32         DeGamma;        //!< RGBEのガンマ補正指数(1.0の場合は補正なし).
+
+    //---------------------------------------------------------------------------------------------
+    //      4ピクセルを SoA 形式で取得します.
+    //---------------------------------------------------------------------------------------------
+    inline void Load4( u32 y, u32 x, __m128& r, __m128& g, __m128& b ) const
+    {
+        if ( pRGBE != nullptr && DeGamma == 1.0f )
+        {
+            auto src  = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pRGBE + ( size_t(y) * Width + x ) * 4 ) );
+            auto zero = _mm_setzero_si128();
+            auto lo   = _mm_unpacklo_epi8( src, zero );
+            auto hi   = _mm_unpackhi_epi8( src, zero );
+            auto p0   = _mm_cvtepi32_ps( _mm_unpacklo_epi16( lo, zero ) );
+            auto p1   = _mm_cvtepi32_ps( _mm_unpackhi_epi16( lo, zero ) );
+            auto p2   = _mm_cvtepi32_ps( _mm_unpacklo_epi16( hi, zero ) );
+            auto p3   = _mm_cvtepi32_ps( _mm_unpackhi_epi16( hi, zero ) );
+            _MM_TRANSPOSE4_PS( p0, p1, p2, p3 );
+
+            // 2^(e - 136) を指数部の直接構築で求める. e <= 9 は表現できないので 0 とする.
+            auto e     = _mm_cvttps_epi32( p3 );
+            auto bits  = _mm_slli_epi32( _mm_sub_epi32( e, _mm_set1_epi32( 9 ) ), 23 );
+            auto valid = _mm_cmpgt_epi32( e, _mm_set1_epi32( 9 ) );
+            auto scale = _mm_castsi128_ps( _mm_and_si128( bits, valid ) );
+
+            r = _mm_mul_ps( p0, scale );
+            g = _mm_mul_ps( p1, scale );
+            b = _mm_mul_ps( p2, scale );
+        }
+        else
+        {
+            f32 rgb[3][4];
+            for( auto i=0; i<4; ++i )
+            { Load1( y, x + i, rgb[0][i], rgb[1][i], rgb[2][i] ); }
+
+            r = _mm_loadu_ps( rgb[0] );
+            g = _mm_loadu_ps( rgb[1] );
+            b = _mm_loadu_ps( rgb[2] );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //      1ピクセルを取得します.
+    //---------------------------------------------------------------------------------------------
+    inline void Load1( u32 y, u32 x, f32& r, f32& g, f32& b ) const
+    {
+        auto idx = size_t(y) * Width + x;
+        if ( pRGBE != nullptr )
+        {
+            auto p = pRGBE + idx * 4;
+            if ( p[3] == 0 )
+            {
+                r = g = b = 0.0f;
+                return;
+            }
+
+            auto val = ldexpf( 1.0f, s32(p[3]) - s32(128 + 8) );
+            r = p[0] * val;
+            g = p[1] * val;
+            b = p[2] * val;
+
+            if ( DeGamma != 1.0f )
+            {
+                r = powf( r, DeGamma );
+                g = powf( g, DeGamma );
+                b = powf( b, DeGamma );
+            }
+        }
+        else
+        {
+            auto p = pFloat + idx * Components;
+            r = p[0];
+            g = p[1];
+            b = p[2];
+        }
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+//      行単位でバンドに分割して並列実行します.
+//-------------------------------------------------------------------------------------------------
+template<typename Func>
+u32 ParallelRows( u32 height, u32 threadCount, Func func )
+{
+    if ( threadCount == 0 )
+    { threadCount = std::max( std::thread::hardware_concurrency(), 1u ); }
+
+    threadCount = std::min( threadCount, std::max( height / MIN_ROWS, 1u ) );
+
+    auto rowsPerThread = ( height + threadCount - 1 ) / threadCount;
+
+    std::vector<std::thread> workers;
+    workers.reserve( threadCount );
+
+    for( u32 i=1; i<threadCount; ++i )
+    {
+        auto begin = std::min( rowsPerThread * i, height );
+        auto end   = std::min( begin + rowsPerThread, height );
+        workers.emplace_back( func, begin, end, i );
+    }
+
+    func( 0, std::min( rowsPerThread, height ), 0 );
+
+    for( auto& worker : workers )
+    { worker.join(); }
+
+    return threadCount;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      輝度統計を計算します.
+//-------------------------------------------------------------------------------------------------
+bool ComputeStats( const RowSource& source, u32 height, asdx::LuminanceStats& result, u32 threadCount )
+{
+    if ( threadCount == 0 )
+    { threadCount = std::max( std::thread::hardware_concurrency(), 1u ); }
+
+    // スレッド毎に独立したヒストグラムへ書き込み, 結合時まで共有しない.
+    std::vector<Accumulator> locals( threadCount );
+
+    const auto binScale = f32(asdx::LUMINANCE_HISTOGRAM_BINS) / ( asdx::LUMINANCE_MAX_LOG2 - asdx::LUMINANCE_MIN_LOG2 );
+    const auto minLum   = exp2f( asdx::LUMINANCE_MIN_LOG2 );
+    const auto width    = source.Width;
+
+    auto used = ParallelRows( height, threadCount, [&]( u32 begin, u32 end, u32 index )
+    {
+        auto& acc = locals[ index ];
+
+        auto vLumaR    = _mm_set1_ps( LUMA_R );
+        auto vLumaG    = _mm_set1_ps( LUMA_G );
+        auto vLumaB    = _mm_set1_ps( LUMA_B );
+        auto vMinLum   = _mm_set1_ps( minLum );
+        auto vMinLog   = _mm_set1_ps( asdx::LUMINANCE_MIN_LOG2 );
+        auto vBinScale = _mm_set1_ps( binScale );
+        auto vMaxBin   = _mm_set1_ps( f32(asdx::LUMINANCE_HISTOGRAM_BINS - 1) );
+        auto vMin      = _mm_set1_ps( FLT_MAX );
+        auto vMax      = _mm_setzero_ps();
+
+        for( auto y=begin; y<end; ++y )
+        {
+            auto vSum    = _mm_setzero_ps();
+            auto vLogSum = _mm_setzero_ps();
+
+            u32 x = 0;
+            for( ; x + 4 <= width; x += 4 )
+            {
+                __m128 r, g, b;
+                source.Load4( y, x, r, g, b );
+
+                auto lum = _mm_add_ps( _mm_add_ps( _mm_mul_ps( r, vLumaR ), _mm_mul_ps( g, vLumaG ) ), _mm_mul_ps( b, vLumaB ) );
+                lum = _mm_max_ps( lum, _mm_setzero_ps() );
+
+                vMin = _mm_min_ps( vMin, lum );
+                vMax = _mm_max_ps( vMax, lum );
+                vSum = _mm_add_ps( vSum, lum );
+
+                auto lit  = _mm_cmpge_ps( lum, vMinLum );
+                auto log2 = Log2( _mm_max_ps( lum, vMinLum ) );
+                vLogSum   = _mm_add_ps( vLogSum, _mm_and_ps( log2, lit ) );
+
+                auto bin = _mm_mul_ps( _mm_sub_ps( log2, vMinLog ), vBinScale );
+                bin = _mm_min_ps( _mm_max_ps( bin, _mm_setzero_ps() ), vMaxBin );
+
+                alignas(16) s32 bins[4];
+                alignas(16) s32 lits[4];
+                _mm_store_si128( reinterpret_cast<__m128i*>( bins ), _mm_cvttps_epi32( bin ) );
+                _mm_store_si128( reinterpret_cast<__m128i*>( lits ), _mm_castps_si128( lit ) );
+
+                for( auto i=0; i<4; ++i )
+                {
+                    if ( lits[i] )
+                    { acc.Histogram[ bins[i] ]++; }
+                    else
+                    { acc.BlackCount++; }
+                }
+            }
+
+            auto sum    = f64( HorizontalSum( vSum ) );
+            auto logSum = f64( HorizontalSum( vLogSum ) );
+
+            // 端数.
+            for( ; x < width; ++x )
+            {
+                f32 r, g, b;
+                source.Load1( y, x, r, g, b );
+
+                auto lum = std::max( r * LUMA_R + g * LUMA_G + b * LUMA_B, 0.0f );
+                acc.MinLuminance = std::min( acc.MinLuminance, lum );
+                acc.MaxLuminance = std::max( acc.MaxLuminance, lum );
+                sum += lum;
+
+                if ( lum < minLum )
+                {
+                    acc.BlackCount++;
+                    continue;
+                }
+
+                auto log2 = log2f( lum );
+                logSum += log2;
+
+                auto bin = std::min( ( log2 - asdx::LUMINANCE_MIN_LOG2 ) * binScale, f32(asdx::LUMINANCE_HISTOGRAM_BINS - 1) );
+                acc.Histogram[ u32(bin) ]++;
+            }
+
+            acc.Sum    += sum;
+            acc.LogSum += logSum;
+        }
+
+        acc.PixelCount  += ( end - begin ) * width;
+        acc.MinLuminance = std::min( acc.MinLuminance, HorizontalMin( vMin ) );
+        acc.MaxLuminance = std::max( acc.MaxLuminance, HorizontalMax( vMax ) );
+    });
+
+    // 全スレッド終了後に結合.
+    Accumulator total;
+    for( u32 i=0; i<used; ++i )
+    {
+        auto& acc = locals[i];
+        for( u32 j=0; j<asdx::LUMINANCE_HISTOGRAM_BINS; ++j )
+        { total.Histogram[j] += acc.Histogram[j]; }
+
+        total.PixelCount  += acc.PixelCount;
+        total.BlackCount  += acc.BlackCount;
+        total.MinLuminance = std::min( total.MinLuminance, acc.MinLuminance );
+        total.MaxLuminance = std::max( total.MaxLuminance, acc.MaxLuminance );
+        total.Sum         += acc.Sum;
+        total.LogSum      += acc.LogSum;
+    }
+
+    result.PixelCount   = total.PixelCount;
+    result.BlackCount   = total.BlackCount;
+    result.MinLuminance = ( total.PixelCount > 0 ) ? total.MinLuminance : 0.0f;
+    result.MaxLuminance = total.MaxLuminance;
+
+    result.AverageLuminance = ( total.PixelCount > 0 )
+        ? f32( total.Sum / f64(total.PixelCount) )
+        : 0.0f;
+
+    auto litCount = total.PixelCount - total.BlackCount;
+    result.LogAverageLuminance = ( litCount > 0 )
+        ? exp2f( f32( total.LogSum / f64(litCount) ) )
+        : 0.0f;
+
+    memcpy( result.Histogram, total.Histogram, sizeof(result.Histogram) );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      トーンマップを実行します.
+//-------------------------------------------------------------------------------------------------
+bool Tonemap
+(
+    const RowSource&    source,
+    u32                 height,
+    f32                 exposure,
+    asdx::TONEMAP_TYPE  type,
+    u8*                 pResult,
+    u32                 threadCount
+)
+{
+    auto& table = GetSrgbTable();
+    const auto width = source.Width;
+
+    ParallelRows( height, threadCount, [&]( u32 begin, u32 end, u32 )
+    {
+        auto vExposure = _mm_set1_ps( exposure );
+        auto vZero     = _mm_setzero_ps();
+        auto vOne      = _mm_set1_ps( 1.0f );
+        auto vScale    = _mm_set1_ps( f32(SRGB_LUT_SIZE - 1) );
+        auto vHalf     = _mm_set1_ps( 0.5f );
+
+        // RRT + ODT のフィッティング近似 (Stephen Hill).
+        auto RRTAndODTFit = [&]( __m128 v )
+        {
+            auto a = _mm_sub_ps( _mm_mul_ps( v, _mm_add_ps( v, _mm_set1_ps( 0.0245786f ) ) ), _mm_set1_ps( 0.000090537f ) );
+            auto b = _mm_add_ps( _mm_mul_ps( v, _mm_add_ps( _mm_mul_ps( _mm_set1_ps( 0.983729f ), v ), _mm_set1_ps( 0.4329510f ) ) ), _mm_set1_ps( 0.238081f ) );
+            return _mm_div_ps( a, b );
+        };
+
+        auto Mul3 = []( __m128 r, __m128 g, __m128 b, f32 m0, f32 m1, f32 m2 )
+        {
+            return _mm_add_ps( _mm_add_ps( _mm_mul_ps( r, _mm_set1_ps( m0 ) ), _mm_mul_ps( g, _mm_set1_ps( m1 ) ) ), _mm_mul_ps( b, _mm_set1_ps( m2 ) ) );
+        };
+
+        for( auto y=begin; y<end; ++y )
+        {
+            auto pDst = pResult + size_t(y) * width * 4;
+
+            for( u32 x=0; x<width; x += 4 )
+            {
+                __m128 r, g, b;
+                auto count = std::min( width - x, 4u );
+                if ( count == 4 )
+                { source.Load4( y, x, r, g, b ); }
+                else
+                {
+                    f32 rgb[3][4] = {};
+                    for( u32 i=0; i<count; ++i )
+                    { source.Load1( y, x + i, rgb[0][i], rgb[1][i], rgb[2][i] ); }
+                    r = _mm_loadu_ps( rgb[0] );
+                    g = _mm_loadu_ps( rgb[1] );
+                    b = _mm_loadu_ps( rgb[2] );
+                }
+
+                r = _mm_mul_ps( r, vExposure );
+                g = _mm_mul_ps( g, vExposure );
+                b = _mm_mul_ps( b, vExposure );
+
+                if ( type == asdx::TONEMAP_ACES_FITTED )
+                {
+                    auto ir = Mul3( r, g, b, 0.59719f, 0.35458f, 0.04823f );
+                    auto ig = Mul3( r, g, b, 0.07600f, 0.90834f, 0.01566f );
+                    auto ib = Mul3( r, g, b, 0.02840f, 0.13383f, 0.83777f );
+
+                    ir = RRTAndODTFit( ir );
+                    ig = RRTAndODTFit( ig );
+                    ib = RRTAndODTFit( ib );
+
+                    r = Mul3( ir, ig, ib,  1.60475f, -0.53108f, -0.07367f );
+                    g = Mul3( ir, ig, ib, -0.10208f,  1.10813f, -0.00605f );
+                    b = Mul3( ir, ig, ib, -0.00327f, -0.07276f,  1.07602f );
+                }
+                else
+                {
+                    r = _mm_div_ps( r, _mm_add_ps( vOne, r ) );
+                    g = _mm_div_ps( g, _mm_add_ps( vOne, g ) );
+                    b = _mm_div_ps( b, _mm_add_ps( vOne, b ) );
+                }
+
+                // saturate して sRGB テーブルのインデックスに変換.
+                alignas(16) s32 idx[3][4];
+                _mm_store_si128( reinterpret_cast<__m128i*>( idx[0] ), _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( _mm_min_ps( _mm_max_ps( r, vZero ), vOne ), vScale ), vHalf ) ) );
+                _mm_store_si128( reinterpret_cast<__m128i*>( idx[1] ), _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( _mm_min_ps( _mm_max_ps( g, vZero ), vOne ), vScale ), vHalf ) ) );
+                _mm_store_si128( reinterpret_cast<__m128i*>( idx[2] ), _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( _mm_min_ps( _mm_max_ps( b, vZero ), vOne ), vScale ), vHalf ) ) );
+
+                for( u32 i=0; i<count; ++i )
+                {
+                    auto p = pDst + ( x + i ) * 4;
+                    p[0] = table.Value[ idx[0][i] ];
+                    p[1] = table.Value[ idx[1][i] ];
+                    p[2] = table.Value[ idx[2][i] ];
+                    p[3] = 255;
+                }
+            }
+        }
+    });
+
+    return true;
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LuminanceStats structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+LuminanceStats::LuminanceStats()
+: PixelCount            ( 0 )
+, BlackCount            ( 0 )
+, MinLuminance          ( 0.0f )
+, MaxLuminance          ( 0.0f )
+, AverageLuminance      ( 0.0f )
+, LogAverageLuminance   ( 0.0f )
+{ memset( Histogram, 0, sizeof(Histogram) ); }
+
+//-------------------------------------------------------------------------------------------------
+//      RGBE画像の輝度統計を並列に計算します.
+//-------------------------------------------------------------------------------------------------
+bool ComputeLuminanceStats( const ResHDR& image, LuminanceStats& result, u32 threadCount )
+{
+    if ( image.GetPixels() == nullptr || image.GetWidth() == 0 || image.GetHeight() == 0 )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    RowSource source = {};
+    source.pRGBE   = image.GetPixels();
+    source.Width   = image.GetWidth();
+    source.DeGamma = 1.0f / image.GetGamma();
+
+    return ComputeStats( source, image.GetHeight(), result, threadCount );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      浮動小数点画像の輝度統計を並列に計算します.
+//-------------------------------------------------------------------------------------------------
+bool ComputeLuminanceStats
+(
+    const f32*      pPixels,
+    u32             width,
+    u32             height,
+    u32             components,
+    LuminanceStats& result,
+    u32             threadCount
+)
+{
+    if ( pPixels == nullptr || width == 0 || height == 0 || components < 3 )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    RowSource source = {};
+    source.pFloat     = pPixels;
+    source.Width      = width;
+    source.Components = components;
+    source.DeGamma    = 1.0f;
+
+    return ComputeStats( source, height, result, threadCount );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ヒストグラムから指定パーセンタイルの輝度を求めます.
+//-------------------------------------------------------------------------------------------------
+f32 ComputePercentileLuminance( const LuminanceStats& stats, f32 percent )
+{
+    if ( stats.PixelCount == 0 )
+    { return 0.0f; }
+
+    percent = std::min( std::max( percent, 0.0f ), 1.0f );
+
+    // 黒ピクセルはヒストグラムの下に積まれているとみなす.
+    auto target = f64(percent) * f64(stats.PixelCount);
+    auto accum  = f64(stats.BlackCount);
+    if ( target <= accum )
+    { return 0.0f; }
+
+    const auto binWidth = ( LUMINANCE_MAX_LOG2 - LUMINANCE_MIN_LOG2 ) / f32(LUMINANCE_HISTOGRAM_BINS);
+
+    for( u32 i=0; i<LUMINANCE_HISTOGRAM_BINS; ++i )
+    {
+        auto count = f64(stats.Histogram[i]);
+        if ( accum + count >= target && count > 0.0 )
+        {
+            // ビン内は線形補間.
+            auto t = f32( ( target - accum ) / count );
+            return exp2f( LUMINANCE_MIN_LOG2 + ( f32(i) + t ) * binWidth );
+        }
+        accum += count;
+    }
+
+    return stats.MaxLuminance;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      自動露光値を求めます.
+//-------------------------------------------------------------------------------------------------
+f32 ComputeAutoExposure( const LuminanceStats& stats, const AutoExposureDesc& desc )
+{
+    if ( stats.PixelCount == 0 )
+    { return 1.0f; }
+
+    const auto binWidth = ( LUMINANCE_MAX_LOG2 - LUMINANCE_MIN_LOG2 ) / f32(LUMINANCE_HISTOGRAM_BINS);
+
+    auto low  = f64(std::min( desc.LowPercent, desc.HighPercent )) * f64(stats.PixelCount);
+    auto high = f64(std::max( desc.LowPercent, desc.HighPercent )) * f64(stats.PixelCount);
+
+    // 黒ピクセル分は範囲から除く.
+    low  = std::max( low  - f64(stats.BlackCount), 0.0 );
+    high = std::max( high - f64(stats.BlackCount), 0.0 );
+
+    f64 sum    = 0.0;
+    f64 weight = 0.0;
+    for( u32 i=0; i<LUMINANCE_HISTOGRAM_BINS; ++i )
+    {
+        auto count = f64(stats.Histogram[i]);
+
+        // [low, high] に含まれる分だけ数える.
+        auto sub = std::min( count, low );
+        count -= sub;
+        low   -= sub;
+        high  -= sub;
+
+        auto take = std::min( count, high );
+        high -= take;
+
+        auto center = LUMINANCE_MIN_LOG2 + ( f32(i) + 0.5f ) * binWidth;
+        sum    += take * center;
+        weight += take;
+
+        if ( high <= 0.0 )
+        { break; }
+    }
+
+    auto average = ( weight > 0.0 ) ? exp2f( f32( sum / weight ) ) : stats.LogAverageLuminance;
+    if ( average <= 0.0f )
+    { return 1.0f; }
+
+    // キー値が指定されていない場合は Krawczyk らの推定式で求める.
+    auto key = desc.Key;
+    if ( key <= 0.0f )
+    { key = 1.03f - 2.0f / ( 2.0f + log10f( average + 1.0f ) ); }
+
+    auto exposure = key / average;
+    return std::min( std::max( exposure, desc.MinExposure ), desc.MaxExposure );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      RGBE画像をトーンマップして RGBA8 (sRGB) に変換します.
+//-------------------------------------------------------------------------------------------------
+bool TonemapToRGBA8
+(
+    const ResHDR&   image,
+    f32             exposure,
+    TONEMAP_TYPE    type,
+    u8*             pResult,
+    u32             threadCount
+)
+{
+    if ( image.GetPixels() == nullptr || pResult == nullptr )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    RowSource source = {};
+    source.pRGBE   = image.GetPixels();
+    source.Width   = image.GetWidth();
+    source.DeGamma = 1.0f / image.GetGamma();
+
+    return Tonemap( source, image.GetHeight(), exposure, type, pResult, threadCount );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      浮動小数点画像をトーンマップして RGBA8 (sRGB) に変換します.
+//-------------------------------------------------------------------------------------------------
+bool TonemapToRGBA8
+(
+    const f32*      pPixels,
+    u32             width,
+    u32             height,
+    u32             components,
+    f32             exposure,
+    TONEMAP_TYPE    type,
+    u8*             pResult,
+    u32             threadCount
+)
+{
+    if ( pPixels == nullptr || pResult == nullptr || components < 3 )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    RowSource source = {};
+    source.pFloat     = pPixels;
+    source.Width      = width;
+    source.Components = components;
+    source.DeGamma    = 1.0f;
+
+    return Tonemap( source, height, exposure, type, pResult, threadCount );
+}
+
+} // namespace asdx
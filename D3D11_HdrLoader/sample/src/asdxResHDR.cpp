@@ -50,12 +50,12 @@ enum SCANLINE_TYPE
 //-------------------------------------------------------------------------------------------------
 void RemoveEndline( char* pBuf )
 {
-    for( auto i = strlen(pBuf) -1; 0 <= i; i-- )
+    for( auto i = strlen(pBuf); 0 < i; i-- )
     {
-        if ( pBuf[ i ] != '\r' && pBuf[ i ] != '\n')
+        if ( pBuf[ i - 1 ] != '\r' && pBuf[ i - 1 ] != '\n')
             break;
 
-        pBuf[ i ] = '\0';
+        pBuf[ i - 1 ] = '\0';
     }
 }
 
@@ -473,6 +473,12 @@ const u32 ResHDR::GetHeight() const
 const f32 ResHDR::GetExposure() const
 { return m_Exposure; }
 
+//-------------------------------------------------------------------------------------------------
+//      K}l擾܂.
+//-------------------------------------------------------------------------------------------------
+const f32 ResHDR::GetGamma() const
+{ return m_Gamma; }
+
 //-------------------------------------------------------------------------------------------------
 //      RGBE`̃sNZf[^擾܂.
 //-------------------------------------------------------------------------------------------------
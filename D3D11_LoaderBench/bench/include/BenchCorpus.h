@@ -0,0 +1,89 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchCorpus.h
+// Desc : Synthetic Image Corpus Generator.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __BENCH_CORPUS_H__
+#define __BENCH_CORPUS_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LOADER_TYPE enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum LOADER_TYPE
+{
+    LOADER_TGA = 0,     //!< asdx::ResTGA です.
+    LOADER_BMP,         //!< asdx::ResBMP です.
+    LOADER_HDR,         //!< asdx::ResHDR です.
+    LOADER_DDS,         //!< asdx::ResDDS です.
+    NUM_LOADER_TYPE
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// CorpusFile structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct CorpusFile
+{
+    LOADER_TYPE     Loader;         //!< 読み込みに使用するローダーです.
+    std::string     Group;          //!< 集計に使用するフォーマット名です (例 : "tga_rle_24").
+    std::string     Path;           //!< ファイルパスです.
+    uint32_t        Width;          //!< 横幅です.
+    uint32_t        Height;         //!< 縦幅です.
+    uint64_t        FileSize;       //!< ファイルサイズです.
+    uint64_t        PixelCount;     //!< ミップマップを含めた総ピクセル数です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// CorpusDesc structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct CorpusDesc
+{
+    std::string             OutputDir;      //!< 出力先ディレクトリです.
+    std::vector<uint32_t>   Sizes;          //!< 生成する画像の1辺のサイズです.
+    uint32_t                Seed;           //!< 乱数シードです.
+    uint32_t                LoaderMask;     //!< 生成するローダーのビットマスクです (1 << LOADER_TYPE).
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    CorpusDesc()
+    : OutputDir ( "bench_corpus" )
+    , Seed      ( 0x12345678 )
+    , LoaderMask( ( 1u << NUM_LOADER_TYPE ) - 1 )
+    {
+        Sizes.push_back( 64 );
+        Sizes.push_back( 256 );
+        Sizes.push_back( 1024 );
+    }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ローダー名を取得します.
+//-------------------------------------------------------------------------------------------------
+const char* GetLoaderName( LOADER_TYPE type );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      合成画像のコーパスを生成します.
+//!
+//! @param[in]      desc        生成設定です.
+//! @param[out]     files       生成したファイルの格納先です.
+//! @retval true    生成に成功.
+//! @retval false   生成に失敗.
+//! @note       同じシードとサイズからは常に同一のバイト列が生成されます.
+//!             全てのローダーのビット深度, 無圧縮と RLE, インデックスカラーとフルカラーを網羅します.
+//-------------------------------------------------------------------------------------------------
+bool GenerateCorpus( const CorpusDesc& desc, std::vector<CorpusFile>& files );
+
+
+#endif//__BENCH_CORPUS_H__
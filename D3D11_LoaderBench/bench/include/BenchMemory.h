@@ -0,0 +1,42 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchMemory.h
+// Desc : Heap Allocation Tracker.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __BENCH_MEMORY_H__
+#define __BENCH_MEMORY_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// HeapStats structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct HeapStats
+{
+    uint64_t    AllocCount;     //!< operator new の呼び出し回数です.
+    uint64_t    AllocBytes;     //!< 確保したバイト数の累計です.
+    uint64_t    CurrentBytes;   //!< 現在確保されているバイト数です.
+    uint64_t    PeakBytes;      //!< 確保されていたバイト数の最大値です.
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ヒープ統計を取得します.
+//!
+//! @note       グローバルな operator new / delete を置き換えて集計しているため,
+//!             malloc() を直接呼び出す確保は含まれません.
+//-------------------------------------------------------------------------------------------------
+HeapStats GetHeapStats();
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ピーク値を現在の確保量にリセットします.
+//-------------------------------------------------------------------------------------------------
+void ResetHeapPeak();
+
+
+#endif//__BENCH_MEMORY_H__
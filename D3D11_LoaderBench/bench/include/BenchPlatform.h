@@ -0,0 +1,97 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchPlatform.h
+// Desc : Platform Compatibility Layer for Loader Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __BENCH_PLATFORM_H__
+#define __BENCH_PLATFORM_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+
+#if !defined(WIN32) && !defined(_WIN32)
+//-------------------------------------------------------------------------------------------------
+// Windows 以外の環境でローダーをビルドするための定義です.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef ASDX_ALIGN
+#define ASDX_ALIGN( alignment )    __attribute__( ( aligned( alignment ) ) )
+#endif//ASDX_ALIGN
+
+#ifndef _countof
+#define _countof( x )       ( sizeof( x ) / sizeof( x[0] ) )
+#endif//_countof
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ワイド文字列のファイル名でファイルを開きます.
+//!
+//! @param[out]     ppFile      ファイルポインタの格納先です.
+//! @param[in]      filename    ファイル名です.
+//! @param[in]      mode        オープンモードです.
+//! @return     成功した場合は 0 を返却します.
+//-------------------------------------------------------------------------------------------------
+int _wfopen_s( FILE** ppFile, const wchar_t* filename, const wchar_t* mode );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      sscanf_s() 互換の書式付き入力です.
+//!
+//! @note       %s, %c, %[ の直後に渡されるバッファサイズを解釈して sscanf() に変換します.
+//!             受け取れる引数は 8 個までです.
+//-------------------------------------------------------------------------------------------------
+int sscanf_s( const char* buffer, const char* format, ... );
+
+#endif//!defined(WIN32) && !defined(_WIN32)
+
+
+//-------------------------------------------------------------------------------------------------
+// ベンチマークは asdx ライブラリをリンクしないため, ローダーのログ出力をここで受け取ります.
+// このヘッダはコンパイラオプションで強制インクルード (/FI, -include) して使用します.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ログを標準エラー出力に書き出します.
+//-------------------------------------------------------------------------------------------------
+void BenchLogA( const char* format, ... );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ワイド文字列のログを標準エラー出力に書き出します.
+//!
+//! @note       Visual C++ と同様に %s をワイド文字列として扱います.
+//-------------------------------------------------------------------------------------------------
+void BenchLogW( const wchar_t* format, ... );
+
+#define BENCH_WIDE2( x )    L ## x
+#define BENCH_WIDE( x )     BENCH_WIDE2( x )
+
+#define DLOGA( fmt, ... )   ((void)0)
+#define DLOGW( fmt, ... )   ((void)0)
+#define ILOGA( fmt, ... )   BenchLogA( fmt "\n", ##__VA_ARGS__ )
+#define ILOGW( fmt, ... )   BenchLogW( BENCH_WIDE( fmt ) L"\n", ##__VA_ARGS__ )
+#define ELOGA( fmt, ... )   BenchLogA( "[File: %s, Line: %d] " fmt "\n", __FILE__, __LINE__, ##__VA_ARGS__ )
+#define ELOGW( fmt, ... )   BenchLogW( L"[File: %s, Line: %d] " BENCH_WIDE( fmt ) L"\n", BENCH_WIDE( __FILE__ ), __LINE__, ##__VA_ARGS__ )
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      高分解能タイマーの現在値を秒単位で取得します.
+//-------------------------------------------------------------------------------------------------
+double GetBenchTime();
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      プロセスのピーク常駐メモリサイズをバイト単位で取得します.
+//-------------------------------------------------------------------------------------------------
+uint64_t GetPeakRSS();
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ディレクトリを作成します. 既に存在する場合も成功とします.
+//-------------------------------------------------------------------------------------------------
+bool CreateBenchDirectory( const char* path );
+
+
+#endif//__BENCH_PLATFORM_H__
@@ -0,0 +1,85 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchReport.h
+// Desc : Benchmark Result Report.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __BENCH_REPORT_H__
+#define __BENCH_REPORT_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchCorpus.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BenchResult structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BenchResult
+{
+    std::string     Group;              //!< フォーマット名です.
+    LOADER_TYPE     Loader;             //!< ローダーです.
+    uint32_t        Size;               //!< 画像の1辺のサイズです.
+    uint64_t        FileSize;           //!< ファイルサイズです.
+    uint64_t        PixelCount;         //!< 1回の読み込みで展開されるピクセル数です.
+    uint64_t        Iterations;         //!< 計測した読み込み回数です.
+    double          Seconds;            //!< 計測にかかった時間です.
+    double          MBPerSec;           //!< ファイルサイズ基準のスループット [MB/s] です.
+    double          MPixelsPerSec;      //!< 1秒当たりに展開したピクセル数 [Mpixel/s] です.
+    double          MsecPerLoad;        //!< 1回の読み込みにかかった時間 [msec] です.
+    double          AllocsPerLoad;      //!< 1回の読み込み当たりの operator new 呼び出し回数です.
+    uint64_t        PeakHeapBytes;      //!< 1回の読み込み中に確保されていたヒープの最大量です.
+    uint64_t        PeakRSS;            //!< 計測直後のプロセスのピーク常駐メモリサイズです.
+    double          BaselineMBPerSec;   //!< 比較対象の MB/s です (比較対象が無い場合は 0).
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BaselineEntry structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BaselineEntry
+{
+    std::string     Group;              //!< フォーマット名です.
+    uint32_t        Size;               //!< 画像の1辺のサイズです.
+    double          MBPerSec;           //!< スループット [MB/s] です.
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      結果を表形式で標準出力に書き出します.
+//-------------------------------------------------------------------------------------------------
+void PrintReport( const std::vector<BenchResult>& results );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      結果を JSON ファイルに書き出します.
+//!
+//! @param[in]      path        出力ファイルパスです.
+//! @param[in]      desc        コーパスの生成設定です.
+//! @param[in]      results     計測結果です.
+//! @retval true    書き出しに成功.
+//! @retval false   書き出しに失敗.
+//! @note       結果は1行に1件ずつ出力し, LoadBaseline() で読み戻せる形式にします.
+//-------------------------------------------------------------------------------------------------
+bool WriteReportJson( const char* path, const CorpusDesc& desc, const std::vector<BenchResult>& results );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      WriteReportJson() で出力した JSON ファイルを比較対象として読み込みます.
+//!
+//! @param[in]      path        入力ファイルパスです.
+//! @param[out]     entries     読み込んだ結果の格納先です.
+//! @retval true    読み込みに成功.
+//! @retval false   読み込みに失敗.
+//-------------------------------------------------------------------------------------------------
+bool LoadBaseline( const char* path, std::vector<BaselineEntry>& entries );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      比較対象の値を結果に設定します.
+//-------------------------------------------------------------------------------------------------
+void ApplyBaseline( const std::vector<BaselineEntry>& entries, std::vector<BenchResult>& results );
+
+
+#endif//__BENCH_REPORT_H__
@@ -0,0 +1,863 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchCorpus.cpp
+// Desc : Synthetic Image Corpus Generator.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchCorpus.h>
+#include <BenchPlatform.h>
+#include <fstream>
+#include <cstdio>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const uint32_t DDSD_CAPS             = 0x00000001;
+static const uint32_t DDSD_HEIGHT           = 0x00000002;
+static const uint32_t DDSD_WIDTH            = 0x00000004;
+static const uint32_t DDSD_PITCH            = 0x00000008;
+static const uint32_t DDSD_PIXELFORMAT      = 0x00001000;
+static const uint32_t DDSD_MIPMAPCOUNT      = 0x00020000;
+static const uint32_t DDSD_LINEARSIZE       = 0x00080000;
+static const uint32_t DDPF_ALPHAPIXELS      = 0x00000001;
+static const uint32_t DDPF_ALPHA            = 0x00000002;
+static const uint32_t DDPF_FOURCC           = 0x00000004;
+static const uint32_t DDPF_RGB              = 0x00000040;
+static const uint32_t DDPF_LUMINANCE        = 0x00020000;
+static const uint32_t DDSCAPS_COMPLEX       = 0x00000008;
+static const uint32_t DDSCAPS_TEXTURE       = 0x00001000;
+static const uint32_t DDSCAPS_MIPMAP        = 0x00400000;
+static const uint32_t DXGI_RGBA32_FLOAT     = 2;
+static const uint32_t DXGI_RGBA16_FLOAT     = 10;
+static const uint32_t DXGI_BC7_UNORM        = 98;
+static const uint32_t DIMENSION_TEXTURE2D   = 3;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Random class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class Random
+{
+public:
+    explicit Random( uint32_t seed )
+    : m_State( ( seed != 0 ) ? seed : 0x9e3779b9 )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      xorshift32 で次の乱数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t Next()
+    {
+        m_State ^= m_State << 13;
+        m_State ^= m_State >> 17;
+        m_State ^= m_State << 5;
+        return m_State;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      [lo, hi] の範囲の乱数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t Range( uint32_t lo, uint32_t hi )
+    { return lo + Next() % ( hi - lo + 1 ); }
+
+private:
+    uint32_t    m_State;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SourceImage structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct SourceImage
+{
+    uint32_t                Width;
+    uint32_t                Height;
+    std::vector<uint8_t>    Index;          // ピクセル毎のパレット番号.
+    uint8_t                 Palette[256][4];// RGBA.
+};
+
+//-------------------------------------------------------------------------------------------------
+//      元画像を生成します.
+//-------------------------------------------------------------------------------------------------
+void CreateSourceImage( uint32_t width, uint32_t height, Random& random, SourceImage& result )
+{
+    result.Width  = width;
+    result.Height = height;
+    result.Index.resize( width * height );
+
+    for( auto i=0; i<256; ++i )
+    {
+        auto value = random.Next();
+        result.Palette[i][0] = uint8_t( value >>  0 );
+        result.Palette[i][1] = uint8_t( value >>  8 );
+        result.Palette[i][2] = uint8_t( value >> 16 );
+        result.Palette[i][3] = uint8_t( value >> 24 );
+    }
+
+    // 実画像に近い RLE 効率となるよう, 単発ノイズと同色の連続を半々に混ぜる.
+    size_t pos   = 0;
+    size_t count = result.Index.size();
+    while( pos < count )
+    {
+        auto run   = ( random.Next() & 1 ) ? 1u : random.Range( 2, 48 );
+        auto value = uint8_t( random.Next() );
+        for( uint32_t i=0; i<run && pos < count; ++i, ++pos )
+        { result.Index[pos] = value; }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      バイト列に書き込みます.
+//-------------------------------------------------------------------------------------------------
+inline void Put8( std::vector<uint8_t>& data, uint32_t value )
+{ data.push_back( uint8_t( value ) ); }
+
+inline void Put16( std::vector<uint8_t>& data, uint32_t value )
+{
+    data.push_back( uint8_t( value ) );
+    data.push_back( uint8_t( value >> 8 ) );
+}
+
+inline void Put32( std::vector<uint8_t>& data, uint32_t value )
+{
+    data.push_back( uint8_t( value ) );
+    data.push_back( uint8_t( value >> 8 ) );
+    data.push_back( uint8_t( value >> 16 ) );
+    data.push_back( uint8_t( value >> 24 ) );
+}
+
+inline void Set32( std::vector<uint8_t>& data, size_t offset, uint32_t value )
+{
+    data[offset + 0] = uint8_t( value );
+    data[offset + 1] = uint8_t( value >> 8 );
+    data[offset + 2] = uint8_t( value >> 16 );
+    data[offset + 3] = uint8_t( value >> 24 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルに書き出します.
+//-------------------------------------------------------------------------------------------------
+bool WriteBinary( const std::string& path, const std::vector<uint8_t>& data )
+{
+    std::ofstream stream( path.c_str(), std::ios::binary | std::ios::trunc );
+    if ( !stream.is_open() )
+    {
+        ELOGA( "Error : File Open Failed. path = %s", path.c_str() );
+        return false;
+    }
+
+    stream.write( reinterpret_cast<const char*>( data.data() ), data.size() );
+    return stream.good();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ピクセルの輝度を求めます.
+//-------------------------------------------------------------------------------------------------
+inline uint8_t GetGray( const SourceImage& image, size_t index )
+{
+    auto& c = image.Palette[ image.Index[index] ];
+    return uint8_t( ( c[0] * 77 + c[1] * 150 + c[2] * 29 ) >> 8 );
+}
+
+
+//=================================================================================================
+// TGA
+//=================================================================================================
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TgaVariant structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct TgaVariant
+{
+    const char* Name;
+    uint8_t     Format;         // TGA_FORMAT_TYPE.
+    uint8_t     BitPerPixel;
+};
+
+static const TgaVariant kTgaVariants[] = {
+    { "tga_index8_raw",  1,  8 },
+    { "tga_index8_rle",  9,  8 },
+    { "tga_rgb16_raw",   2, 16 },
+    { "tga_rgb16_rle",  10, 16 },
+    { "tga_rgb24_raw",   2, 24 },
+    { "tga_rgb24_rle",  10, 24 },
+    { "tga_rgba32_raw",  2, 32 },
+    { "tga_rgba32_rle", 10, 32 },
+    { "tga_gray8_raw",   3,  8 },
+    { "tga_gray8_rle",  11,  8 },
+    { "tga_gray16_raw",  3, 16 },
+    { "tga_gray16_rle", 11, 16 },
+};
+
+//-------------------------------------------------------------------------------------------------
+//      TGA の1ピクセル分のバイト列を求めます.
+//-------------------------------------------------------------------------------------------------
+void GetTgaPixel( const SourceImage& image, const TgaVariant& variant, size_t index, uint8_t* pResult )
+{
+    auto& c = image.Palette[ image.Index[index] ];
+    auto isGray  = ( variant.Format == 3 || variant.Format == 11 );
+    auto isIndex = ( variant.Format == 1 || variant.Format == 9 );
+
+    if ( isIndex )
+    {
+        pResult[0] = image.Index[index];
+    }
+    else if ( isGray )
+    {
+        pResult[0] = GetGray( image, index );
+        pResult[1] = c[3];
+    }
+    else if ( variant.BitPerPixel == 16 )
+    {
+        auto value = uint32_t( ( c[0] >> 3 ) << 10 ) | ( ( c[1] >> 3 ) << 5 ) | ( c[2] >> 3 ) | 0x8000;
+        pResult[0] = uint8_t( value );
+        pResult[1] = uint8_t( value >> 8 );
+    }
+    else
+    {
+        pResult[0] = c[2];
+        pResult[1] = c[1];
+        pResult[2] = c[0];
+        pResult[3] = c[3];
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      TGA ファイルを生成します.
+//-------------------------------------------------------------------------------------------------
+void BuildTga( const SourceImage& image, const TgaVariant& variant, std::vector<uint8_t>& data )
+{
+    auto isIndex     = ( variant.Format == 1 || variant.Format == 9 );
+    auto isRLE       = ( variant.Format >= 9 );
+    auto bytePerPixel = uint32_t( variant.BitPerPixel / 8 );
+
+    // ヘッダ.
+    Put8 ( data, 0 );                           // IdFieldLength
+    Put8 ( data, isIndex ? 1 : 0 );             // HasColorMap
+    Put8 ( data, variant.Format );              // Format
+    Put16( data, 0 );                           // ColorMapEntry
+    Put16( data, isIndex ? 256 : 0 );           // ColorMapLength
+    Put8 ( data, isIndex ? 24 : 0 );            // ColorMapEntrySize
+    Put16( data, 0 );                           // OffsetX
+    Put16( data, 0 );                           // OffsetY
+    Put16( data, image.Width );                 // Width
+    Put16( data, image.Height );                // Height
+    Put8 ( data, variant.BitPerPixel );         // BitPerPixel
+    Put8 ( data, ( variant.BitPerPixel == 32 || ( variant.BitPerPixel == 16 && variant.Format != 3 && variant.Format != 11 ) ) ? 0x08 : 0x00 );
+
+    // カラーマップ (BGR).
+    if ( isIndex )
+    {
+        for( auto i=0; i<256; ++i )
+        {
+            Put8( data, image.Palette[i][2] );
+            Put8( data, image.Palette[i][1] );
+            Put8( data, image.Palette[i][0] );
+        }
+    }
+
+    // ピクセルデータ.
+    auto count = size_t( image.Width ) * image.Height;
+    if ( !isRLE )
+    {
+        uint8_t pixel[4];
+        for( size_t i=0; i<count; ++i )
+        {
+            GetTgaPixel( image, variant, i, pixel );
+            data.insert( data.end(), pixel, pixel + bytePerPixel );
+        }
+    }
+    else
+    {
+        std::vector<uint8_t> pixels( count * bytePerPixel );
+        for( size_t i=0; i<count; ++i )
+        { GetTgaPixel( image, variant, i, &pixels[ i * bytePerPixel ] ); }
+
+        auto equal = [&]( size_t a, size_t b )
+        { return memcmp( &pixels[ a * bytePerPixel ], &pixels[ b * bytePerPixel ], bytePerPixel ) == 0; };
+
+        size_t pos = 0;
+        while( pos < count )
+        {
+            size_t run = 1;
+            while( pos + run < count && run < 128 && equal( pos, pos + run ) )
+            { run++; }
+
+            if ( run >= 2 )
+            {
+                Put8( data, 0x80 | uint32_t( run - 1 ) );
+                data.insert( data.end(), &pixels[ pos * bytePerPixel ], &pixels[ pos * bytePerPixel ] + bytePerPixel );
+                pos += run;
+                continue;
+            }
+
+            // 次に同色が連続する位置までを生パケットにする.
+            size_t raw = 1;
+            while( pos + raw < count && raw < 128 && !( pos + raw + 1 < count && equal( pos + raw, pos + raw + 1 ) ) )
+            { raw++; }
+
+            Put8( data, uint32_t( raw - 1 ) );
+            data.insert( data.end(), &pixels[ pos * bytePerPixel ], &pixels[ ( pos + raw ) * bytePerPixel ] );
+            pos += raw;
+        }
+    }
+
+    // TGA 2.0 フッター.
+    Put32( data, 0 );
+    Put32( data, 0 );
+    static const char kTag[18] = "TRUEVISION-XFILE.";
+    data.insert( data.end(), kTag, kTag + sizeof(kTag) );
+}
+
+
+//=================================================================================================
+// BMP
+//=================================================================================================
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BmpVariant structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BmpVariant
+{
+    const char* Name;
+    uint16_t    BitCount;
+    uint32_t    Compression;    // BMP_COMPRESSION_TYPE.
+};
+
+static const BmpVariant kBmpVariants[] = {
+    { "bmp_index1_raw",  1, 0 },
+    { "bmp_index4_raw",  4, 0 },
+    { "bmp_index4_rle",  4, 2 },
+    { "bmp_index8_raw",  8, 0 },
+    { "bmp_index8_rle",  8, 1 },
+    { "bmp_rgb24_raw",  24, 0 },
+    { "bmp_rgba32_raw", 32, 0 },
+};
+
+//-------------------------------------------------------------------------------------------------
+//      BMP の RLE8 / RLE4 で1行分を圧縮します.
+//-------------------------------------------------------------------------------------------------
+void EncodeBmpRow( const uint8_t* pRow, uint32_t width, bool rle4, std::vector<uint8_t>& data )
+{
+    uint32_t pos = 0;
+    while( pos < width )
+    {
+        uint32_t run = 1;
+        while( pos + run < width && run < 255 && pRow[ pos + run ] == pRow[ pos ] )
+        { run++; }
+
+        if ( run >= 2 )
+        {
+            Put8( data, run );
+            Put8( data, rle4 ? ( ( pRow[pos] << 4 ) | pRow[pos] ) : pRow[pos] );
+            pos += run;
+            continue;
+        }
+
+        uint32_t raw = 1;
+        while( pos + raw < width && raw < 255 && !( pos + raw + 1 < width && pRow[ pos + raw ] == pRow[ pos + raw + 1 ] ) )
+        { raw++; }
+
+        if ( raw < 3 )
+        {
+            // 絶対モードは3ピクセル以上なので, 短い場合は長さ1の連続として書き出す.
+            for( uint32_t i=0; i<raw; ++i )
+            {
+                Put8( data, 1 );
+                Put8( data, rle4 ? ( pRow[ pos + i ] << 4 ) : pRow[ pos + i ] );
+            }
+            pos += raw;
+            continue;
+        }
+
+        Put8( data, 0 );
+        Put8( data, raw );
+        uint32_t bytes = 0;
+        if ( rle4 )
+        {
+            for( uint32_t i=0; i<raw; i+=2, ++bytes )
+            {
+                auto hi = pRow[ pos + i ];
+                auto lo = ( i + 1 < raw ) ? pRow[ pos + i + 1 ] : 0;
+                Put8( data, ( hi << 4 ) | lo );
+            }
+        }
+        else
+        {
+            for( uint32_t i=0; i<raw; ++i, ++bytes )
+            { Put8( data, pRow[ pos + i ] ); }
+        }
+
+        // ワード境界に揃える.
+        if ( bytes & 1 )
+        { Put8( data, 0 ); }
+
+        pos += raw;
+    }
+
+    // 行末.
+    Put8( data, 0 );
+    Put8( data, 0 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      BMP ファイルを生成します.
+//-------------------------------------------------------------------------------------------------
+void BuildBmp( const SourceImage& image, const BmpVariant& variant, std::vector<uint8_t>& data )
+{
+    auto paletteCount = ( variant.BitCount <= 8 ) ? ( 1u << variant.BitCount ) : 0u;
+    auto offBits      = 14u + 40u + paletteCount * 4u;
+
+    // BMP_FILE_HEADER
+    Put16( data, 0x4D42 );      // 'BM'
+    Put32( data, 0 );           // Size (後で設定)
+    Put16( data, 0 );
+    Put16( data, 0 );
+    Put32( data, offBits );
+
+    // BMP_INFO_HEADER
+    Put32( data, 40 );
+    Put32( data, image.Width );
+    Put32( data, image.Height );
+    Put16( data, 1 );
+    Put16( data, variant.BitCount );
+    Put32( data, variant.Compression );
+    Put32( data, 0 );           // SizeImage (後で設定)
+    Put32( data, 2835 );
+    Put32( data, 2835 );
+    Put32( data, 0 );
+    Put32( data, 0 );
+
+    // パレット (BGRX).
+    for( uint32_t i=0; i<paletteCount; ++i )
+    {
+        Put8( data, image.Palette[i][2] );
+        Put8( data, image.Palette[i][1] );
+        Put8( data, image.Palette[i][0] );
+        Put8( data, 0 );
+    }
+
+    auto mask = uint8_t( ( paletteCount > 0 ) ? paletteCount - 1 : 0xff );
+    std::vector<uint8_t> row( image.Width );
+
+    for( uint32_t y=0; y<image.Height; ++y )
+    {
+        auto pIndex = &image.Index[ size_t( y ) * image.Width ];
+        for( uint32_t x=0; x<image.Width; ++x )
+        { row[x] = pIndex[x] & mask; }
+
+        if ( variant.Compression != 0 )
+        {
+            EncodeBmpRow( row.data(), image.Width, ( variant.Compression == 2 ), data );
+            continue;
+        }
+
+        auto start = data.size();
+        switch( variant.BitCount )
+        {
+        case 1:
+            for( uint32_t x=0; x<image.Width; x+=8 )
+            {
+                uint32_t value = 0;
+                for( uint32_t i=0; i<8 && x + i < image.Width; ++i )
+                { value |= ( row[ x + i ] & 1 ) << ( 7 - i ); }
+                Put8( data, value );
+            }
+            break;
+
+        case 4:
+            for( uint32_t x=0; x<image.Width; x+=2 )
+            { Put8( data, ( row[x] << 4 ) | ( ( x + 1 < image.Width ) ? row[ x + 1 ] : 0 ) ); }
+            break;
+
+        case 8:
+            data.insert( data.end(), row.begin(), row.end() );
+            break;
+
+        case 24:
+        case 32:
+            for( uint32_t x=0; x<image.Width; ++x )
+            {
+                auto& c = image.Palette[ pIndex[x] ];
+                Put8( data, c[2] );
+                Put8( data, c[1] );
+                Put8( data, c[0] );
+                if ( variant.BitCount == 32 )
+                { Put8( data, c[3] ); }
+            }
+            break;
+        }
+
+        // 行を4バイト境界に揃える.
+        while( ( data.size() - start ) & 3 )
+        { Put8( data, 0 ); }
+    }
+
+    if ( variant.Compression != 0 )
+    {
+        // ビットマップの終端.
+        Put8( data, 0 );
+        Put8( data, 1 );
+    }
+
+    Set32( data, 2, uint32_t( data.size() ) );
+    Set32( data, 14 + 20, uint32_t( data.size() - offBits ) );
+}
+
+
+//=================================================================================================
+// HDR
+//=================================================================================================
+
+//-------------------------------------------------------------------------------------------------
+//      Radiance HDR の新形式 RLE で1成分の1行分を圧縮します.
+//-------------------------------------------------------------------------------------------------
+void EncodeHdrComponent( const uint8_t* pValues, uint32_t count, std::vector<uint8_t>& data )
+{
+    uint32_t pos = 0;
+    while( pos < count )
+    {
+        uint32_t run = 1;
+        while( pos + run < count && run < 127 && pValues[ pos + run ] == pValues[ pos ] )
+        { run++; }
+
+        if ( run >= 3 )
+        {
+            Put8( data, 128 + run );
+            Put8( data, pValues[ pos ] );
+            pos += run;
+            continue;
+        }
+
+        uint32_t raw = 1;
+        while( pos + raw < count && raw < 128 )
+        {
+            if ( pos + raw + 2 < count
+              && pValues[ pos + raw ] == pValues[ pos + raw + 1 ]
+              && pValues[ pos + raw ] == pValues[ pos + raw + 2 ] )
+            { break; }
+            raw++;
+        }
+
+        Put8( data, raw );
+        data.insert( data.end(), pValues + pos, pValues + pos + raw );
+        pos += raw;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      HDR ファイルを生成します.
+//-------------------------------------------------------------------------------------------------
+void BuildHdr( const SourceImage& image, bool rle, std::vector<uint8_t>& data )
+{
+    char header[128];
+    auto length = snprintf( header, sizeof(header),
+        "#?RADIANCE\n# synthetic corpus\nFORMAT=32-bit_rle_rgbe\n\n-Y %u +X %u\n",
+        image.Height, image.Width );
+    data.insert( data.end(), header, header + length );
+
+    // パレットを RGBE に変換 (仮数部は 128 以上なので旧形式の RLE マーカー (1,1,1) とは衝突しない).
+    uint8_t rgbe[256][4];
+    for( auto i=0; i<256; ++i )
+    {
+        rgbe[i][0] = uint8_t( 128 | ( image.Palette[i][0] >> 1 ) );
+        rgbe[i][1] = uint8_t( 128 | ( image.Palette[i][1] >> 1 ) );
+        rgbe[i][2] = uint8_t( 128 | ( image.Palette[i][2] >> 1 ) );
+        rgbe[i][3] = uint8_t( 120 + ( image.Palette[i][3] & 15 ) );
+    }
+
+    std::vector<uint8_t> component( image.Width );
+    for( uint32_t y=0; y<image.Height; ++y )
+    {
+        auto pIndex = &image.Index[ size_t( y ) * image.Width ];
+
+        if ( !rle )
+        {
+            for( uint32_t x=0; x<image.Width; ++x )
+            { data.insert( data.end(), rgbe[ pIndex[x] ], rgbe[ pIndex[x] ] + 4 ); }
+            continue;
+        }
+
+        Put8( data, 2 );
+        Put8( data, 2 );
+        Put8( data, image.Width >> 8 );
+        Put8( data, image.Width & 0xff );
+
+        for( auto c=0; c<4; ++c )
+        {
+            for( uint32_t x=0; x<image.Width; ++x )
+            { component[x] = rgbe[ pIndex[x] ][c]; }
+
+            EncodeHdrComponent( component.data(), image.Width, data );
+        }
+    }
+}
+
+
+//=================================================================================================
+// DDS
+//=================================================================================================
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DdsVariant structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct DdsVariant
+{
+    const char* Name;
+    uint32_t    Flags;          // DDPF_XXX.
+    uint32_t    FourCC;
+    uint32_t    Bpp;            // 非圧縮の場合のビット数. BC の場合はブロックのバイト数.
+    uint32_t    Mask[4];
+    uint32_t    DXGIFormat;     // FourCC が DX10 の場合のみ有効.
+};
+
+#define BENCH_FOURCC( a, b, c, d )  ( uint32_t(a) | ( uint32_t(b) << 8 ) | ( uint32_t(c) << 16 ) | ( uint32_t(d) << 24 ) )
+
+static const DdsVariant kDdsVariants[] = {
+    { "dds_rgba8",      DDPF_RGB | DDPF_ALPHAPIXELS,        0, 32, { 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000 }, 0 },
+    { "dds_bgra8",      DDPF_RGB | DDPF_ALPHAPIXELS,        0, 32, { 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000 }, 0 },
+    { "dds_bgr8",       DDPF_RGB,                           0, 24, { 0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000 }, 0 },
+    { "dds_b5g6r5",     DDPF_RGB,                           0, 16, { 0x0000f800, 0x000007e0, 0x0000001f, 0x00000000 }, 0 },
+    { "dds_b5g5r5a1",   DDPF_RGB | DDPF_ALPHAPIXELS,        0, 16, { 0x00007c00, 0x000003e0, 0x0000001f, 0x00008000 }, 0 },
+    { "dds_b4g4r4a4",   DDPF_RGB | DDPF_ALPHAPIXELS,        0, 16, { 0x00000f00, 0x000000f0, 0x0000000f, 0x0000f000 }, 0 },
+    { "dds_l8",         DDPF_LUMINANCE,                     0,  8, { 0x000000ff, 0x00000000, 0x00000000, 0x00000000 }, 0 },
+    { "dds_l16",        DDPF_LUMINANCE,                     0, 16, { 0x0000ffff, 0x00000000, 0x00000000, 0x00000000 }, 0 },
+    { "dds_a8l8",       DDPF_LUMINANCE | DDPF_ALPHAPIXELS,  0, 16, { 0x000000ff, 0x00000000, 0x00000000, 0x0000ff00 }, 0 },
+    { "dds_a8",         DDPF_ALPHA,                         0,  8, { 0x00000000, 0x00000000, 0x00000000, 0x000000ff }, 0 },
+    { "dds_bc1",        DDPF_FOURCC, BENCH_FOURCC('D','X','T','1'),  8, { 0, 0, 0, 0 }, 0 },
+    { "dds_bc3",        DDPF_FOURCC, BENCH_FOURCC('D','X','T','5'), 16, { 0, 0, 0, 0 }, 0 },
+    { "dds_bc4",        DDPF_FOURCC, BENCH_FOURCC('A','T','I','1'),  8, { 0, 0, 0, 0 }, 0 },
+    { "dds_bc5",        DDPF_FOURCC, BENCH_FOURCC('A','T','I','2'), 16, { 0, 0, 0, 0 }, 0 },
+    { "dds_dx10_rgba16f", DDPF_FOURCC, BENCH_FOURCC('D','X','1','0'),  64, { 0, 0, 0, 0 }, DXGI_RGBA16_FLOAT },
+    { "dds_dx10_rgba32f", DDPF_FOURCC, BENCH_FOURCC('D','X','1','0'), 128, { 0, 0, 0, 0 }, DXGI_RGBA32_FLOAT },
+    { "dds_dx10_bc7",     DDPF_FOURCC, BENCH_FOURCC('D','X','1','0'),  16, { 0, 0, 0, 0 }, DXGI_BC7_UNORM },
+};
+
+//-------------------------------------------------------------------------------------------------
+//      ブロック圧縮フォーマットかどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+inline bool IsBlockCompressed( const DdsVariant& variant )
+{
+    if ( ( variant.Flags & DDPF_FOURCC ) == 0 )
+    { return false; }
+
+    return ( variant.DXGIFormat == 0 || variant.DXGIFormat == DXGI_BC7_UNORM );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      DDS ファイルを生成します.
+//-------------------------------------------------------------------------------------------------
+void BuildDds( uint32_t width, uint32_t height, const DdsVariant& variant, Random& random, std::vector<uint8_t>& data, uint64_t& pixelCount )
+{
+    auto isBC = IsBlockCompressed( variant );
+
+    uint32_t mipCount = 1;
+    while( ( width >> mipCount ) > 0 || ( height >> mipCount ) > 0 )
+    { mipCount++; }
+
+    auto topSize = isBC
+        ? ( ( width + 3 ) / 4 ) * ( ( height + 3 ) / 4 ) * variant.Bpp
+        : ( width * height * variant.Bpp ) / 8;
+
+    Put32( data, BENCH_FOURCC('D','D','S',' ') );
+
+    // DDS_SURFACE_DESC
+    Put32( data, 124 );
+    Put32( data, DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | ( isBC ? DDSD_LINEARSIZE : DDSD_PITCH ) );
+    Put32( data, height );
+    Put32( data, width );
+    Put32( data, isBC ? topSize : ( width * variant.Bpp + 7 ) / 8 );
+    Put32( data, 0 );               // Depth
+    Put32( data, mipCount );
+    for( auto i=0; i<11; ++i )      // AlphaBitDepth, Reserved, Surface, ColorKey x 4.
+    { Put32( data, 0 ); }
+
+    // DDS_PIXEL_FORMAT
+    Put32( data, 32 );
+    Put32( data, variant.Flags );
+    Put32( data, variant.FourCC );
+    Put32( data, ( variant.Flags & DDPF_FOURCC ) ? 0 : variant.Bpp );
+    for( auto i=0; i<4; ++i )
+    { Put32( data, variant.Mask[i] ); }
+
+    Put32( data, DDSCAPS_TEXTURE | DDSCAPS_COMPLEX | DDSCAPS_MIPMAP );
+    for( auto i=0; i<4; ++i )       // Caps2, ReservedCaps x 2, TextureStage.
+    { Put32( data, 0 ); }
+
+    if ( variant.DXGIFormat != 0 )
+    {
+        // DDS_DXT10_HEADER
+        Put32( data, variant.DXGIFormat );
+        Put32( data, DIMENSION_TEXTURE2D );
+        Put32( data, 0 );
+        Put32( data, 1 );
+        Put32( data, 0 );
+    }
+
+    // 全ミップレベル分のペイロード. ローダーは内容を解釈しないので乱数で埋める.
+    pixelCount = 0;
+    size_t payload = 0;
+    auto w = width;
+    auto h = height;
+    for( uint32_t i=0; i<mipCount; ++i )
+    {
+        payload    += isBC
+            ? size_t( ( w + 3 ) / 4 ) * ( ( h + 3 ) / 4 ) * variant.Bpp
+            : ( size_t( w ) * h * variant.Bpp ) / 8;
+        pixelCount += uint64_t( w ) * h;
+        w = ( w > 1 ) ? ( w >> 1 ) : 1;
+        h = ( h > 1 ) ? ( h >> 1 ) : 1;
+    }
+
+    auto offset = data.size();
+    data.resize( offset + payload );
+    for( size_t i=0; i<payload; i+=4 )
+    {
+        auto value = random.Next();
+        for( size_t j=0; j<4 && i + j < payload; ++j )
+        { data[ offset + i + j ] = uint8_t( value >> ( j * 8 ) ); }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルを書き出してリストに追加します.
+//-------------------------------------------------------------------------------------------------
+bool AddFile
+(
+    const CorpusDesc&           desc,
+    LOADER_TYPE                 loader,
+    const char*                 group,
+    const char*                 ext,
+    uint32_t                    size,
+    uint64_t                    pixelCount,
+    const std::vector<uint8_t>& data,
+    std::vector<CorpusFile>&    files
+)
+{
+    char name[256];
+    snprintf( name, sizeof(name), "%s_%u.%s", group, size, ext );
+
+    CorpusFile file;
+    file.Loader     = loader;
+    file.Group      = group;
+    file.Path       = desc.OutputDir + "/" + name;
+    file.Width      = size;
+    file.Height     = size;
+    file.FileSize   = data.size();
+    file.PixelCount = pixelCount;
+
+    if ( !WriteBinary( file.Path, data ) )
+    { return false; }
+
+    files.push_back( file );
+    return true;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      ローダー名を取得します.
+//-------------------------------------------------------------------------------------------------
+const char* GetLoaderName( LOADER_TYPE type )
+{
+    switch( type )
+    {
+    case LOADER_TGA: return "tga";
+    case LOADER_BMP: return "bmp";
+    case LOADER_HDR: return "hdr";
+    case LOADER_DDS: return "dds";
+    default:         break;
+    }
+
+    return "unknown";
+}
+
+//-------------------------------------------------------------------------------------------------
+//      合成画像のコーパスを生成します.
+//-------------------------------------------------------------------------------------------------
+bool GenerateCorpus( const CorpusDesc& desc, std::vector<CorpusFile>& files )
+{
+    files.clear();
+
+    if ( !CreateBenchDirectory( desc.OutputDir.c_str() ) )
+    {
+        ELOGA( "Error : CreateBenchDirectory() Failed. path = %s", desc.OutputDir.c_str() );
+        return false;
+    }
+
+    for( auto size : desc.Sizes )
+    {
+        // BMP ローダーは行のパディングを扱わないため, 1bit でもパディングが生じない 32 の倍数に限定.
+        // HDR の新形式 RLE も横幅 8 以上が必要.
+        if ( size < 32 || ( size % 32 ) != 0 || size > 0x7fff )
+        {
+            ELOGA( "Error : Invalid Size. size = %u (must be a multiple of 32 in [32, 32736])", size );
+            return false;
+        }
+
+        // サイズ毎にシードを派生させて, サイズの組み合わせに依存しない内容にする.
+        Random random( desc.Seed ^ ( size * 0x9e3779b9u ) );
+
+        SourceImage image;
+        CreateSourceImage( size, size, random, image );
+
+        auto pixelCount = uint64_t( size ) * size;
+        std::vector<uint8_t> data;
+
+        if ( desc.LoaderMask & ( 1u << LOADER_TGA ) )
+        {
+            for( auto& variant : kTgaVariants )
+            {
+                data.clear();
+                BuildTga( image, variant, data );
+                if ( !AddFile( desc, LOADER_TGA, variant.Name, "tga", size, pixelCount, data, files ) )
+                { return false; }
+            }
+        }
+
+        if ( desc.LoaderMask & ( 1u << LOADER_BMP ) )
+        {
+            for( auto& variant : kBmpVariants )
+            {
+                data.clear();
+                BuildBmp( image, variant, data );
+                if ( !AddFile( desc, LOADER_BMP, variant.Name, "bmp", size, pixelCount, data, files ) )
+                { return false; }
+            }
+        }
+
+        if ( desc.LoaderMask & ( 1u << LOADER_HDR ) )
+        {
+            data.clear();
+            BuildHdr( image, false, data );
+            if ( !AddFile( desc, LOADER_HDR, "hdr_rgbe_flat", "hdr", size, pixelCount, data, files ) )
+            { return false; }
+
+            data.clear();
+            BuildHdr( image, true, data );
+            if ( !AddFile( desc, LOADER_HDR, "hdr_rgbe_rle", "hdr", size, pixelCount, data, files ) )
+            { return false; }
+        }
+
+        if ( desc.LoaderMask & ( 1u << LOADER_DDS ) )
+        {
+            for( auto& variant : kDdsVariants )
+            {
+                data.clear();
+                uint64_t count = 0;
+                BuildDds( size, size, variant, random, data, count );
+                if ( !AddFile( desc, LOADER_DDS, variant.Name, "dds", size, count, data, files ) )
+                { return false; }
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,125 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchMemory.cpp
+// Desc : Heap Allocation Tracker.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchMemory.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const size_t HEADER_SIZE = 16;   // サイズを記録するヘッダ (アライメントを保つため16バイト).
+
+//-------------------------------------------------------------------------------------------------
+// Global Variables.
+//-------------------------------------------------------------------------------------------------
+std::atomic<uint64_t>   g_AllocCount  ( 0 );
+std::atomic<uint64_t>   g_AllocBytes  ( 0 );
+std::atomic<uint64_t>   g_CurrentBytes( 0 );
+std::atomic<uint64_t>   g_PeakBytes   ( 0 );
+
+//-------------------------------------------------------------------------------------------------
+//      メモリを確保して統計を更新します.
+//-------------------------------------------------------------------------------------------------
+void* TrackedAlloc( size_t size )
+{
+    auto ptr = static_cast<uint8_t*>( malloc( size + HEADER_SIZE ) );
+    if ( ptr == nullptr )
+    { return nullptr; }
+
+    *reinterpret_cast<size_t*>( ptr ) = size;
+
+    g_AllocCount.fetch_add( 1, std::memory_order_relaxed );
+    g_AllocBytes.fetch_add( size, std::memory_order_relaxed );
+
+    auto current = g_CurrentBytes.fetch_add( size, std::memory_order_relaxed ) + size;
+    auto peak    = g_PeakBytes.load( std::memory_order_relaxed );
+    while( peak < current && !g_PeakBytes.compare_exchange_weak( peak, current, std::memory_order_relaxed ) )
+    { /* DO_NOTHING */ }
+
+    return ptr + HEADER_SIZE;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      メモリを解放して統計を更新します.
+//-------------------------------------------------------------------------------------------------
+void TrackedFree( void* ptr )
+{
+    if ( ptr == nullptr )
+    { return; }
+
+    auto head = static_cast<uint8_t*>( ptr ) - HEADER_SIZE;
+    g_CurrentBytes.fetch_sub( *reinterpret_cast<size_t*>( head ), std::memory_order_relaxed );
+    free( head );
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      ヒープ統計を取得します.
+//-------------------------------------------------------------------------------------------------
+HeapStats GetHeapStats()
+{
+    HeapStats result;
+    result.AllocCount   = g_AllocCount  .load( std::memory_order_relaxed );
+    result.AllocBytes   = g_AllocBytes  .load( std::memory_order_relaxed );
+    result.CurrentBytes = g_CurrentBytes.load( std::memory_order_relaxed );
+    result.PeakBytes    = g_PeakBytes   .load( std::memory_order_relaxed );
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ピーク値を現在の確保量にリセットします.
+//-------------------------------------------------------------------------------------------------
+void ResetHeapPeak()
+{ g_PeakBytes.store( g_CurrentBytes.load( std::memory_order_relaxed ), std::memory_order_relaxed ); }
+
+
+//-------------------------------------------------------------------------------------------------
+//      グローバル new / delete の置き換えです.
+//-------------------------------------------------------------------------------------------------
+void* operator new( size_t size )
+{
+    auto ptr = TrackedAlloc( size );
+    if ( ptr == nullptr )
+    { throw std::bad_alloc(); }
+    return ptr;
+}
+
+void* operator new[]( size_t size )
+{ return operator new( size ); }
+
+void* operator new( size_t size, const std::nothrow_t& ) throw()
+{ return TrackedAlloc( size ); }
+
+void* operator new[]( size_t size, const std::nothrow_t& ) throw()
+{ return TrackedAlloc( size ); }
+
+void operator delete( void* ptr ) throw()
+{ TrackedFree( ptr ); }
+
+void operator delete[]( void* ptr ) throw()
+{ TrackedFree( ptr ); }
+
+void operator delete( void* ptr, const std::nothrow_t& ) throw()
+{ TrackedFree( ptr ); }
+
+void operator delete[]( void* ptr, const std::nothrow_t& ) throw()
+{ TrackedFree( ptr ); }
+
+void operator delete( void* ptr, size_t ) throw()
+{ TrackedFree( ptr ); }
+
+void operator delete[]( void* ptr, size_t ) throw()
+{ TrackedFree( ptr ); }
@@ -0,0 +1,330 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchPlatform.cpp
+// Desc : Platform Compatibility Layer for Loader Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchPlatform.h>
+#include <asdxHash.h>
+#include <chrono>
+#include <cstdarg>
+#include <cstdlib>
+#include <cwchar>
+#include <string>
+#include <vector>
+
+#if defined(WIN32) || defined(_WIN32)
+#include <Windows.h>
+#include <Psapi.h>
+#pragma comment( lib, "psapi.lib" )
+#else
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <cerrno>
+#endif
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+//      CRC32 テーブルを取得します.
+//-------------------------------------------------------------------------------------------------
+const u32* GetCrcTable()
+{
+    static u32 s_Table[256] = {};
+    static bool s_Init = false;
+    if ( !s_Init )
+    {
+        for( u32 i=0; i<256; ++i )
+        {
+            auto c = i;
+            for( auto j=0; j<8; ++j )
+            { c = ( c & 1 ) ? ( 0xedb88320 ^ ( c >> 1 ) ) : ( c >> 1 ); }
+            s_Table[i] = c;
+        }
+        s_Init = true;
+    }
+    return s_Table;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      CRC32 を計算します.
+//-------------------------------------------------------------------------------------------------
+u32 ComputeCrc32( const u8* pBuffer, size_t size )
+{
+    auto table = GetCrcTable();
+    auto crc   = 0xffffffffu;
+    for( size_t i=0; i<size; ++i )
+    { crc = table[ ( crc ^ pBuffer[i] ) & 0xff ] ^ ( crc >> 8 ); }
+    return crc ^ 0xffffffffu;
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// CRC32 class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ローダーがファイル名のハッシュに使用するため, asdx ライブラリの代わりに実装します.
+
+CRC32::CRC32()
+: m_Hash( 0 )
+{ /* DO_NOTHING */ }
+
+CRC32::CRC32( const u32 size, const u8* pBuffer )
+: m_Hash( ComputeCrc32( pBuffer, size ) )
+{ /* DO_NOTHING */ }
+
+CRC32::CRC32( const char8* pBuffer )
+: m_Hash( ComputeCrc32( reinterpret_cast<const u8*>( pBuffer ), strlen( pBuffer ) ) )
+{ /* DO_NOTHING */ }
+
+CRC32::CRC32( const char16* pBuffer )
+: m_Hash( ComputeCrc32( reinterpret_cast<const u8*>( pBuffer ), wcslen( pBuffer ) * sizeof(char16) ) )
+{ /* DO_NOTHING */ }
+
+CRC32::CRC32( const u32 value )
+: m_Hash( value )
+{ /* DO_NOTHING */ }
+
+CRC32::CRC32( const CRC32& value )
+: m_Hash( value.m_Hash )
+{ /* DO_NOTHING */ }
+
+u32 CRC32::GetHash() const
+{ return m_Hash; }
+
+CRC32::operator u32()
+{ return m_Hash; }
+
+CRC32::operator const u32 () const
+{ return m_Hash; }
+
+bool CRC32::operator == ( const CRC32& value ) const
+{ return m_Hash == value.m_Hash; }
+
+bool CRC32::operator != ( const CRC32& value ) const
+{ return m_Hash != value.m_Hash; }
+
+CRC32& CRC32::operator = ( const CRC32& value )
+{
+    m_Hash = value.m_Hash;
+    return *this;
+}
+
+} // namespace asdx
+
+
+#if !defined(WIN32) && !defined(_WIN32)
+//-------------------------------------------------------------------------------------------------
+//      ワイド文字列のファイル名でファイルを開きます.
+//-------------------------------------------------------------------------------------------------
+int _wfopen_s( FILE** ppFile, const wchar_t* filename, const wchar_t* mode )
+{
+    if ( ppFile == nullptr || filename == nullptr || mode == nullptr )
+    { return EINVAL; }
+
+    char path[4096];
+    char fmode[16];
+    if ( wcstombs( path,  filename, sizeof(path)  ) == size_t(-1)
+      || wcstombs( fmode, mode,     sizeof(fmode) ) == size_t(-1) )
+    { return EINVAL; }
+
+    (*ppFile) = fopen( path, fmode );
+    return ( (*ppFile) != nullptr ) ? 0 : errno;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      sscanf_s() 互換の書式付き入力です.
+//-------------------------------------------------------------------------------------------------
+int sscanf_s( const char* buffer, const char* format, ... )
+{
+    static const int MAX_ARGS = 8;
+
+    void*       args[ MAX_ARGS ] = {};
+    int         count = 0;
+    std::string converted;
+
+    va_list va;
+    va_start( va, format );
+
+    for( auto p = format; *p != '\0'; ++p )
+    {
+        converted += *p;
+        if ( *p != '%' )
+        { continue; }
+
+        ++p;
+        if ( *p == '%' )
+        {
+            converted += *p;
+            continue;
+        }
+
+        auto suppress = ( *p == '*' );
+        auto spec     = p;
+        while( *spec != '\0' && strchr( "diouxXeEfgGaAcsSpn[", *spec ) == nullptr )
+        { ++spec; }
+
+        if ( *spec == '\0' || count >= MAX_ARGS )
+        {
+            va_end( va );
+            return -1;
+        }
+
+        if ( suppress )
+        {
+            converted.append( p, spec + 1 );
+            p = spec;
+            continue;
+        }
+
+        auto ptr = va_arg( va, void* );
+        if ( *spec == 's' || *spec == 'c' || *spec == '[' )
+        {
+            auto size = va_arg( va, unsigned int );
+            if ( size == 0 )
+            {
+                va_end( va );
+                return 0;
+            }
+
+            // 幅の指定が無い文字列はバッファサイズで制限する.
+            if ( *spec == 's' && spec == p )
+            { converted += std::to_string( size - 1 ); }
+        }
+
+        converted.append( p, spec + 1 );
+        p = spec;
+
+        // %[ は ] までをそのまま写す.
+        if ( *spec == '[' )
+        {
+            ++p;
+            if ( *p == '^' ) { converted += *p; ++p; }
+            if ( *p == ']' ) { converted += *p; ++p; }
+            while( *p != '\0' && *p != ']' ) { converted += *p; ++p; }
+            if ( *p == '\0' ) { --p; }
+            else { converted += *p; }
+        }
+
+        args[ count++ ] = ptr;
+    }
+
+    va_end( va );
+
+    return sscanf( buffer, converted.c_str(),
+        args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7] );
+}
+#endif//!defined(WIN32) && !defined(_WIN32)
+
+
+//-------------------------------------------------------------------------------------------------
+//      ログを標準エラー出力に書き出します.
+//-------------------------------------------------------------------------------------------------
+void BenchLogA( const char* format, ... )
+{
+    va_list va;
+    va_start( va, format );
+    vfprintf( stderr, format, va );
+    va_end( va );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ワイド文字列のログを標準エラー出力に書き出します.
+//-------------------------------------------------------------------------------------------------
+void BenchLogW( const wchar_t* format, ... )
+{
+#if defined(WIN32) || defined(_WIN32)
+    va_list va;
+    va_start( va, format );
+    vfwprintf( stderr, format, va );
+    va_end( va );
+#else
+    // glibc は %s をマルチバイト文字列として扱うため %ls に置き換える.
+    std::wstring converted;
+    for( auto p = format; *p != L'\0'; ++p )
+    {
+        converted += *p;
+        if ( *p != L'%' )
+        { continue; }
+
+        ++p;
+        while( *p != L'\0' && wcschr( L"-+ #0123456789.*", *p ) != nullptr )
+        { converted += *p; ++p; }
+
+        if ( *p == L'\0' )
+        { break; }
+
+        if ( *p == L's' )
+        { converted += L'l'; }
+        converted += *p;
+    }
+
+    // 書式文字列をワイド, 出力先をバイト指向で混在させないよう一旦バッファに展開する.
+    std::vector<wchar_t> buffer( 1024 );
+    va_list va;
+    va_start( va, format );
+    vswprintf( buffer.data(), buffer.size(), converted.c_str(), va );
+    va_end( va );
+
+    char text[4096];
+    if ( wcstombs( text, buffer.data(), sizeof(text) ) != size_t(-1) )
+    {
+        text[ sizeof(text) - 1 ] = '\0';
+        fputs( text, stderr );
+    }
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      高分解能タイマーの現在値を秒単位で取得します.
+//-------------------------------------------------------------------------------------------------
+double GetBenchTime()
+{
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double>( now ).count();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      プロセスのピーク常駐メモリサイズをバイト単位で取得します.
+//-------------------------------------------------------------------------------------------------
+uint64_t GetPeakRSS()
+{
+#if defined(WIN32) || defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters = {};
+    if ( !GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof(counters) ) )
+    { return 0; }
+    return uint64_t( counters.PeakWorkingSetSize );
+#else
+    struct rusage usage = {};
+    if ( getrusage( RUSAGE_SELF, &usage ) != 0 )
+    { return 0; }
+  #if defined(__APPLE__)
+    return uint64_t( usage.ru_maxrss );
+  #else
+    return uint64_t( usage.ru_maxrss ) * 1024;  // Linux は KiB 単位.
+  #endif
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ディレクトリを作成します. 既に存在する場合も成功とします.
+//-------------------------------------------------------------------------------------------------
+bool CreateBenchDirectory( const char* path )
+{
+#if defined(WIN32) || defined(_WIN32)
+    if ( CreateDirectoryA( path, nullptr ) )
+    { return true; }
+    return ( GetLastError() == ERROR_ALREADY_EXISTS );
+#else
+    if ( mkdir( path, 0755 ) == 0 )
+    { return true; }
+    return ( errno == EEXIST );
+#endif
+}
@@ -0,0 +1,189 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchReport.cpp
+// Desc : Benchmark Result Report.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchReport.h>
+#include <BenchPlatform.h>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+//      1行の JSON オブジェクトから文字列の値を取り出します.
+//-------------------------------------------------------------------------------------------------
+bool FindString( const std::string& line, const char* key, std::string& result )
+{
+    auto pattern = std::string( "\"" ) + key + "\":";
+    auto pos = line.find( pattern );
+    if ( pos == std::string::npos )
+    { return false; }
+
+    auto head = line.find( '"', pos + pattern.size() );
+    if ( head == std::string::npos )
+    { return false; }
+
+    auto tail = line.find( '"', head + 1 );
+    if ( tail == std::string::npos )
+    { return false; }
+
+    result = line.substr( head + 1, tail - head - 1 );
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      1行の JSON オブジェクトから数値を取り出します.
+//-------------------------------------------------------------------------------------------------
+bool FindNumber( const std::string& line, const char* key, double& result )
+{
+    auto pattern = std::string( "\"" ) + key + "\":";
+    auto pos = line.find( pattern );
+    if ( pos == std::string::npos )
+    { return false; }
+
+    result = strtod( line.c_str() + pos + pattern.size(), nullptr );
+    return true;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      結果を表形式で標準出力に書き出します.
+//-------------------------------------------------------------------------------------------------
+void PrintReport( const std::vector<BenchResult>& results )
+{
+    printf( "%-20s %5s %10s %10s %9s %8s %10s %10s %8s\n",
+        "format", "size", "file[KiB]", "MB/s", "Mpix/s", "allocs", "heap[KiB]", "rss[MiB]", "delta" );
+
+    for( auto& item : results )
+    {
+        char delta[32] = "-";
+        if ( item.BaselineMBPerSec > 0.0 )
+        {
+            snprintf( delta, sizeof(delta), "%+.1f%%",
+                ( item.MBPerSec / item.BaselineMBPerSec - 1.0 ) * 100.0 );
+        }
+
+        printf( "%-20s %5u %10.1f %10.1f %9.2f %8.1f %10.1f %10.1f %8s\n",
+            item.Group.c_str(),
+            item.Size,
+            double( item.FileSize ) / 1024.0,
+            item.MBPerSec,
+            item.MPixelsPerSec,
+            item.AllocsPerLoad,
+            double( item.PeakHeapBytes ) / 1024.0,
+            double( item.PeakRSS ) / ( 1024.0 * 1024.0 ),
+            delta );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      結果を JSON ファイルに書き出します.
+//-------------------------------------------------------------------------------------------------
+bool WriteReportJson( const char* path, const CorpusDesc& desc, const std::vector<BenchResult>& results )
+{
+    std::ofstream stream( path, std::ios::trunc );
+    if ( !stream.is_open() )
+    {
+        ELOGA( "Error : File Open Failed. path = %s", path );
+        return false;
+    }
+
+    char line[1024];
+
+    stream << "{\n";
+    snprintf( line, sizeof(line), "  \"seed\": %u,\n", desc.Seed );
+    stream << line;
+
+    stream << "  \"sizes\": [";
+    for( size_t i=0; i<desc.Sizes.size(); ++i )
+    { stream << ( ( i > 0 ) ? ", " : "" ) << desc.Sizes[i]; }
+    stream << "],\n";
+
+    stream << "  \"results\": [\n";
+    for( size_t i=0; i<results.size(); ++i )
+    {
+        auto& item = results[i];
+        snprintf( line, sizeof(line),
+            "    {\"name\": \"%s\", \"loader\": \"%s\", \"size\": %u, \"file_bytes\": %llu, \"pixels\": %llu, "
+            "\"iterations\": %llu, \"seconds\": %.6f, \"mb_per_sec\": %.3f, \"mpixels_per_sec\": %.3f, "
+            "\"msec_per_load\": %.6f, \"allocs_per_load\": %.2f, \"peak_heap_bytes\": %llu, \"peak_rss_bytes\": %llu}%s\n",
+            item.Group.c_str(),
+            GetLoaderName( item.Loader ),
+            item.Size,
+            (unsigned long long)item.FileSize,
+            (unsigned long long)item.PixelCount,
+            (unsigned long long)item.Iterations,
+            item.Seconds,
+            item.MBPerSec,
+            item.MPixelsPerSec,
+            item.MsecPerLoad,
+            item.AllocsPerLoad,
+            (unsigned long long)item.PeakHeapBytes,
+            (unsigned long long)item.PeakRSS,
+            ( i + 1 < results.size() ) ? "," : "" );
+        stream << line;
+    }
+    stream << "  ]\n";
+    stream << "}\n";
+
+    return stream.good();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      比較対象の JSON ファイルを読み込みます.
+//-------------------------------------------------------------------------------------------------
+bool LoadBaseline( const char* path, std::vector<BaselineEntry>& entries )
+{
+    std::ifstream stream( path );
+    if ( !stream.is_open() )
+    {
+        ELOGA( "Error : File Open Failed. path = %s", path );
+        return false;
+    }
+
+    entries.clear();
+
+    std::string line;
+    while( std::getline( stream, line ) )
+    {
+        BaselineEntry entry;
+        double size = 0.0;
+        if ( !FindString( line, "name", entry.Group )
+          || !FindNumber( line, "size", size )
+          || !FindNumber( line, "mb_per_sec", entry.MBPerSec ) )
+        { continue; }
+
+        entry.Size = uint32_t( size );
+        entries.push_back( entry );
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      比較対象の値を結果に設定します.
+//-------------------------------------------------------------------------------------------------
+void ApplyBaseline( const std::vector<BaselineEntry>& entries, std::vector<BenchResult>& results )
+{
+    for( auto& item : results )
+    {
+        item.BaselineMBPerSec = 0.0;
+        for( auto& entry : entries )
+        {
+            if ( entry.Size == item.Size && entry.Group == item.Group )
+            {
+                item.BaselineMBPerSec = entry.MBPerSec;
+                break;
+            }
+        }
+    }
+}
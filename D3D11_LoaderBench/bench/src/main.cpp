@@ -0,0 +1,282 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : main.cpp
+// Desc : Loader Benchmark Main Entry Point.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchPlatform.h>
+#include <BenchCorpus.h>
+#include <BenchMemory.h>
+#include <BenchReport.h>
+#include <asdxResTGA.h>
+#include <asdxResBMP.h>
+#include <asdxResHDR.h>
+#include <asdxResDDS.h>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BenchDesc structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BenchDesc
+{
+    CorpusDesc      Corpus;         //!< コーパスの生成設定です.
+    double          MinTime;        //!< 1ファイル当たりの最小計測時間 [sec] です.
+    uint32_t        MinIterations;  //!< 1ファイル当たりの最小読み込み回数です.
+    uint32_t        Warmup;         //!< 計測前の読み込み回数です.
+    std::string     Filter;         //!< 計測するフォーマット名に含まれる文字列です.
+    std::string     JsonPath;       //!< JSON の出力先です.
+    std::string     BaselinePath;   //!< 比較対象の JSON ファイルです.
+
+    BenchDesc()
+    : MinTime       ( 0.25 )
+    , MinIterations ( 5 )
+    , Warmup        ( 2 )
+    { /* DO_NOTHING */ }
+};
+
+//-------------------------------------------------------------------------------------------------
+//      使用方法を表示します.
+//-------------------------------------------------------------------------------------------------
+void PrintUsage()
+{
+    printf( "Usage : bench [options]\n" );
+    printf( "  -corpus <dir>        output directory of the synthetic corpus (default: bench_corpus)\n" );
+    printf( "  -sizes <a,b,...>     image sizes, multiples of 32 (default: 64,256,1024)\n" );
+    printf( "  -seed <N>            corpus random seed (default: 305419896)\n" );
+    printf( "  -loader <a,b,...>    loaders to run: tga, bmp, hdr, dds (default: all)\n" );
+    printf( "  -filter <text>       run only formats whose name contains <text>\n" );
+    printf( "  -mintime <sec>       minimum measuring time per file (default: 0.25)\n" );
+    printf( "  -miniters <N>        minimum loads per file (default: 5)\n" );
+    printf( "  -warmup <N>          loads before measuring (default: 2)\n" );
+    printf( "  -json <path>         write results as JSON\n" );
+    printf( "  -baseline <path>     compare MB/s against a previous JSON result\n" );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      カンマ区切りの文字列を分割します.
+//-------------------------------------------------------------------------------------------------
+std::vector<std::string> Split( const char* text )
+{
+    std::vector<std::string> result;
+    std::string items = text;
+    size_t head = 0;
+    while( head <= items.size() )
+    {
+        auto tail = items.find( ',', head );
+        if ( tail == std::string::npos )
+        { tail = items.size(); }
+
+        auto item = items.substr( head, tail - head );
+        if ( !item.empty() )
+        { result.push_back( item ); }
+
+        head = tail + 1;
+    }
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      コマンドライン引数を解析します.
+//-------------------------------------------------------------------------------------------------
+bool ParseArgs( int argc, char** argv, BenchDesc& desc )
+{
+    for( auto i=1; i<argc; ++i )
+    {
+        auto hasNext = ( i + 1 < argc );
+
+        if ( strcmp( argv[i], "-corpus" ) == 0 && hasNext )
+        { desc.Corpus.OutputDir = argv[++i]; }
+        else if ( strcmp( argv[i], "-sizes" ) == 0 && hasNext )
+        {
+            desc.Corpus.Sizes.clear();
+            for( auto& item : Split( argv[++i] ) )
+            { desc.Corpus.Sizes.push_back( uint32_t( atoi( item.c_str() ) ) ); }
+        }
+        else if ( strcmp( argv[i], "-seed" ) == 0 && hasNext )
+        { desc.Corpus.Seed = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else if ( strcmp( argv[i], "-loader" ) == 0 && hasNext )
+        {
+            desc.Corpus.LoaderMask = 0;
+            for( auto& item : Split( argv[++i] ) )
+            {
+                auto found = false;
+                for( auto type=0; type<NUM_LOADER_TYPE; ++type )
+                {
+                    if ( item == GetLoaderName( LOADER_TYPE( type ) ) )
+                    {
+                        desc.Corpus.LoaderMask |= ( 1u << type );
+                        found = true;
+                    }
+                }
+
+                if ( !found )
+                {
+                    ELOGA( "Error : Unknown Loader. name = %s", item.c_str() );
+                    return false;
+                }
+            }
+        }
+        else if ( strcmp( argv[i], "-filter" ) == 0 && hasNext )
+        { desc.Filter = argv[++i]; }
+        else if ( strcmp( argv[i], "-mintime" ) == 0 && hasNext )
+        { desc.MinTime = atof( argv[++i] ); }
+        else if ( strcmp( argv[i], "-miniters" ) == 0 && hasNext )
+        { desc.MinIterations = uint32_t( atoi( argv[++i] ) ); }
+        else if ( strcmp( argv[i], "-warmup" ) == 0 && hasNext )
+        { desc.Warmup = uint32_t( atoi( argv[++i] ) ); }
+        else if ( strcmp( argv[i], "-json" ) == 0 && hasNext )
+        { desc.JsonPath = argv[++i]; }
+        else if ( strcmp( argv[i], "-baseline" ) == 0 && hasNext )
+        { desc.BaselinePath = argv[++i]; }
+        else
+        {
+            ELOGA( "Error : Unknown Option. option = %s", argv[i] );
+            PrintUsage();
+            return false;
+        }
+    }
+
+    if ( desc.MinIterations == 0 )
+    { desc.MinIterations = 1; }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルを1回読み込み, 解像度を検証します.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+bool LoadOnce( const wchar_t* path, const CorpusFile& file )
+{
+    T resource;
+    if ( !resource.Load( path ) )
+    { return false; }
+
+    auto valid = ( resource.GetWidth()  == file.Width )
+              && ( resource.GetHeight() == file.Height );
+    resource.Release();
+    return valid;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ローダーの種類に応じてファイルを1回読み込みます.
+//-------------------------------------------------------------------------------------------------
+bool LoadFile( const wchar_t* path, const CorpusFile& file )
+{
+    switch( file.Loader )
+    {
+    case LOADER_TGA: return LoadOnce<asdx::ResTGA>( path, file );
+    case LOADER_BMP: return LoadOnce<asdx::ResBMP>( path, file );
+    case LOADER_HDR: return LoadOnce<asdx::ResHDR>( path, file );
+    case LOADER_DDS: return LoadOnce<asdx::ResDDS>( path, file );
+    default:         break;
+    }
+
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      1ファイルの読み込み性能を計測します.
+//-------------------------------------------------------------------------------------------------
+bool RunFile( const BenchDesc& desc, const CorpusFile& file, BenchResult& result )
+{
+    // コーパスのパスは ASCII のみなのでそのまま拡張する.
+    std::wstring path( file.Path.begin(), file.Path.end() );
+
+    for( uint32_t i=0; i<desc.Warmup || i == 0; ++i )
+    {
+        if ( !LoadFile( path.c_str(), file ) )
+        {
+            ELOGA( "Error : Load Failed. path = %s", file.Path.c_str() );
+            return false;
+        }
+    }
+
+    auto     before = GetHeapStats();
+    ResetHeapPeak();
+
+    uint64_t iterations = 0;
+    auto     begin      = GetBenchTime();
+    auto     elapsed    = 0.0;
+    do
+    {
+        LoadFile( path.c_str(), file );
+        iterations++;
+        elapsed = GetBenchTime() - begin;
+    }
+    while( elapsed < desc.MinTime || iterations < desc.MinIterations );
+
+    auto after = GetHeapStats();
+
+    result.Group            = file.Group;
+    result.Loader           = file.Loader;
+    result.Size             = file.Width;
+    result.FileSize         = file.FileSize;
+    result.PixelCount       = file.PixelCount;
+    result.Iterations       = iterations;
+    result.Seconds          = elapsed;
+    result.MBPerSec         = double( file.FileSize ) * iterations / elapsed / ( 1000.0 * 1000.0 );
+    result.MPixelsPerSec    = double( file.PixelCount ) * iterations / elapsed / ( 1000.0 * 1000.0 );
+    result.MsecPerLoad      = elapsed * 1000.0 / iterations;
+    result.AllocsPerLoad    = double( after.AllocCount - before.AllocCount ) / iterations;
+    result.PeakHeapBytes    = ( after.PeakBytes > before.CurrentBytes ) ? after.PeakBytes - before.CurrentBytes : 0;
+    result.PeakRSS          = GetPeakRSS();
+    result.BaselineMBPerSec = 0.0;
+
+    return true;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-------------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+    BenchDesc desc;
+    if ( !ParseArgs( argc, argv, desc ) )
+    { return -1; }
+
+    std::vector<BaselineEntry> baseline;
+    if ( !desc.BaselinePath.empty() && !LoadBaseline( desc.BaselinePath.c_str(), baseline ) )
+    { return -1; }
+
+    std::vector<CorpusFile> files;
+    if ( !GenerateCorpus( desc.Corpus, files ) )
+    { return -1; }
+
+    std::vector<BenchResult> results;
+    auto failed = 0;
+
+    for( auto& file : files )
+    {
+        if ( !desc.Filter.empty() && file.Group.find( desc.Filter ) == std::string::npos )
+        { continue; }
+
+        BenchResult result;
+        if ( !RunFile( desc, file, result ) )
+        {
+            failed++;
+            continue;
+        }
+
+        results.push_back( result );
+    }
+
+    ApplyBaseline( baseline, results );
+    PrintReport( results );
+
+    if ( !desc.JsonPath.empty() && !WriteReportJson( desc.JsonPath.c_str(), desc.Corpus, results ) )
+    { return -1; }
+
+    return ( failed == 0 ) ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchCorpus.h
+// Desc : Synthetic Asset Corpus Generator.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __BENCH_CORPUS_H__
+#define __BENCH_CORPUS_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// CorpusFile structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct CorpusFile
+{
+    std::string             Name;       //!< パック内のパスです (例 : "mesh/0001.msh").
+    std::vector<uint8_t>    Data;       //!< ファイルの内容です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// CorpusDesc structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct CorpusDesc
+{
+    uint64_t    TotalSize;      //!< 生成する総サイズです.
+    uint32_t    MinFileSize;    //!< 1ファイルの最小サイズです.
+    uint32_t    MaxFileSize;    //!< 1ファイルの最大サイズです.
+    uint32_t    Seed;           //!< 乱数シードです.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    CorpusDesc()
+    : TotalSize     ( 256ull * 1024 * 1024 )
+    , MinFileSize   ( 4 * 1024 )
+    , MaxFileSize   ( 4 * 1024 * 1024 )
+    , Seed          ( 0x12345678 )
+    { /* DO_NOTHING */ }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      合成アセットのコーパスを生成します.
+//!
+//! @param[in]      desc        生成設定です.
+//! @param[out]     files       生成したファイルの格納先です.
+//! @note       同じ設定からは常に同一のバイト列が生成されます.
+//!             メッシュ, BC 圧縮テクスチャ, フォント, シェーダソースを模したデータを混在させ,
+//!             圧縮しやすいものと圧縮しにくいものが両方含まれるようにします.
+//-------------------------------------------------------------------------------------------------
+void GenerateCorpus( const CorpusDesc& desc, std::vector<CorpusFile>& files );
+
+
+#endif//__BENCH_CORPUS_H__
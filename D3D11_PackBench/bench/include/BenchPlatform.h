@@ -0,0 +1,65 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchPlatform.h
+// Desc : Platform Compatibility Layer for Asset Pack Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __BENCH_PLATFORM_H__
+#define __BENCH_PLATFORM_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdio>
+#include <cstdint>
+
+
+#if !defined(WIN32) && !defined(_WIN32)
+//-------------------------------------------------------------------------------------------------
+//! @brief      fopen_s() 互換のファイルオープンです.
+//!
+//! @param[out]     ppFile      ファイルポインタの格納先です.
+//! @param[in]      path        ファイルパスです.
+//! @param[in]      mode        オープンモードです.
+//! @return     成功した場合は 0 を返却します.
+//-------------------------------------------------------------------------------------------------
+int fopen_s( FILE** ppFile, const char* path, const char* mode );
+
+#endif//!defined(WIN32) && !defined(_WIN32)
+
+
+//-------------------------------------------------------------------------------------------------
+// ベンチマークは asdx ライブラリをリンクしないため, パックモジュールのログ出力をここで受け取ります.
+// このヘッダはコンパイラオプションで強制インクルード (/FI, -include) して使用します.
+//-------------------------------------------------------------------------------------------------
+#define DLOGA( fmt, ... )   ((void)0)
+#define ILOGA( fmt, ... )   fprintf( stderr, fmt "\n", ##__VA_ARGS__ )
+#define WLOGA( fmt, ... )   fprintf( stderr, fmt "\n", ##__VA_ARGS__ )
+#define ELOGA( fmt, ... )   fprintf( stderr, "[File: %s, Line: %d] " fmt "\n", __FILE__, __LINE__, ##__VA_ARGS__ )
+#define ELOG                ELOGA
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      高分解能タイマーの現在値を秒単位で取得します.
+//-------------------------------------------------------------------------------------------------
+double GetBenchTime();
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ディレクトリを作成します. 既に存在する場合も成功とし, 同名のファイルがある場合は失敗とします.
+//! @note       失敗した場合はパスをログに出力します.
+//-------------------------------------------------------------------------------------------------
+bool CreateBenchDirectory( const char* path );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ファイルのページキャッシュを破棄します.
+//!
+//! @retval true    破棄を要求できた.
+//! @retval false   ファイルを開けなかった.
+//! @note       Linux では posix_fadvise( POSIX_FADV_DONTNEED ) を使用します.
+//!             Windows ではバッファリングなしでファイルを開き直してキャッシュを破棄させます.
+//!             どちらも他のプロセスが使用しているページは破棄されません.
+//-------------------------------------------------------------------------------------------------
+bool DropFileCache( const char* path );
+
+
+#endif//__BENCH_PLATFORM_H__
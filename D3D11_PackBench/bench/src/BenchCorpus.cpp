@@ -0,0 +1,216 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchCorpus.cpp
+// Desc : Synthetic Asset Corpus Generator.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchCorpus.h>
+#include <BenchPlatform.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+
+namespace /* anonymous */ {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ASSET_KIND enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum ASSET_KIND
+{
+    ASSET_MESH = 0,     //!< 頂点配列とインデックス配列です.
+    ASSET_TEXTURE,      //!< BC1 ブロック列です. ほとんど圧縮できません.
+    ASSET_FONT,         //!< 8bit のグリフビットマップです.
+    ASSET_SHADER,       //!< シェーダのソースコードです.
+    NUM_ASSET_KIND
+};
+
+static const char* kKindDir[NUM_ASSET_KIND] = { "mesh",  "texture", "font", "shader" };
+static const char* kKindExt[NUM_ASSET_KIND] = { ".msh",  ".dds",    ".fnt", ".hlsl" };
+
+static const char* kShaderWords[] = {
+    "float4", "float3", "float2", "float", "return", "cbuffer", "Texture2D", "SamplerState",
+    "struct", "VSOutput", "PSOutput", "Position", "Normal", "TexCoord", "mul", "normalize",
+    "saturate", "dot", "lerp", "Sample", "register", "SV_POSITION", "SV_TARGET", "{", "}",
+    "(", ")", ";", "=", "+", "*", "0.5f", "1.0f", "input", "output", "World", "View", "Proj",
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Random class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class Random
+{
+public:
+    explicit Random( uint32_t seed )
+    : m_State( ( seed != 0 ) ? seed : 0x9e3779b9 )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      xorshift32 で次の乱数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t Next()
+    {
+        m_State ^= m_State << 13;
+        m_State ^= m_State >> 17;
+        m_State ^= m_State << 5;
+        return m_State;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      [0, 1) の乱数を取得します.
+    //---------------------------------------------------------------------------------------------
+    double NextDouble()
+    { return ( Next() >> 8 ) * ( 1.0 / 16777216.0 ); }
+
+private:
+    uint32_t m_State;
+};
+
+//-------------------------------------------------------------------------------------------------
+//      値を追記します.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+void Append( std::vector<uint8_t>& data, const T& value )
+{
+    auto pBytes = reinterpret_cast<const uint8_t*>( &value );
+    data.insert( data.end(), pBytes, pBytes + sizeof(T) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      格子状のメッシュを生成します.
+//-------------------------------------------------------------------------------------------------
+void GenerateMesh( Random& random, size_t size, std::vector<uint8_t>& data )
+{
+    // 頂点 32 byte (位置, 法線, UV) と三角形 24 byte (インデックス 6 個分) でおよそ size になる格子です.
+    auto side = static_cast<uint32_t>( std::sqrt( double( size ) / 56.0 ) ) + 2;
+    auto freq = 1.0f + float( random.Next() % 8 );
+
+    Append( data, side );
+    for ( uint32_t y = 0; y < side; ++y )
+    {
+        for ( uint32_t x = 0; x < side; ++x )
+        {
+            auto u = float( x ) / float( side - 1 );
+            auto v = float( y ) / float( side - 1 );
+            auto h = 0.25f * std::sin( u * freq ) * std::cos( v * freq );
+
+            float vertex[8] = { u, h, v, 0.0f, 1.0f, 0.0f, u, v };
+            data.insert( data.end(), reinterpret_cast<uint8_t*>( vertex ), reinterpret_cast<uint8_t*>( vertex ) + sizeof(vertex) );
+        }
+    }
+
+    for ( uint32_t y = 0; y + 1 < side; ++y )
+    {
+        for ( uint32_t x = 0; x + 1 < side; ++x )
+        {
+            auto i0 = y * side + x;
+            uint32_t index[6] = { i0, i0 + side, i0 + 1, i0 + 1, i0 + side, i0 + side + 1 };
+            data.insert( data.end(), reinterpret_cast<uint8_t*>( index ), reinterpret_cast<uint8_t*>( index ) + sizeof(index) );
+        }
+    }
+
+    data.resize( size );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      BC1 ブロック列を生成します.
+//-------------------------------------------------------------------------------------------------
+void GenerateTexture( Random& random, size_t size, std::vector<uint8_t>& data )
+{
+    data.resize( size );
+    for ( size_t i = 0; i + 4 <= size; i += 4 )
+    {
+        auto value = random.Next();
+        memcpy( &data[i], &value, sizeof(value) );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      グリフビットマップを生成します.
+//-------------------------------------------------------------------------------------------------
+void GenerateFont( Random& random, size_t size, std::vector<uint8_t>& data )
+{
+    // 32x32 のグリフの中央付近にだけ画素がある, 余白の多いビットマップです.
+    data.resize( size, 0 );
+    for ( size_t base = 0; base < size; base += 32 * 32 )
+    {
+        auto x0 = 4 + random.Next() % 8;
+        auto x1 = 20 + random.Next() % 8;
+        for ( size_t y = 4; y < 28; ++y )
+        {
+            for ( size_t x = x0; x < x1; ++x )
+            {
+                auto i = base + y * 32 + x;
+                if ( i < size && ( random.Next() & 3 ) != 0 )
+                { data[i] = 0xFF; }
+            }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      シェーダのソースコードを生成します.
+//-------------------------------------------------------------------------------------------------
+void GenerateShader( Random& random, size_t size, std::vector<uint8_t>& data )
+{
+    auto wordCount = sizeof(kShaderWords) / sizeof(kShaderWords[0]);
+    while ( data.size() < size )
+    {
+        auto pWord = kShaderWords[ random.Next() % wordCount ];
+        data.insert( data.end(), pWord, pWord + strlen( pWord ) );
+        data.push_back( ( random.Next() % 8 == 0 ) ? '\n' : ' ' );
+    }
+
+    data.resize( size );
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      合成アセットのコーパスを生成します.
+//-------------------------------------------------------------------------------------------------
+void GenerateCorpus( const CorpusDesc& desc, std::vector<CorpusFile>& files )
+{
+    files.clear();
+
+    Random   random( desc.Seed );
+    uint64_t total = 0;
+    uint32_t index = 0;
+
+    auto logMin = std::log( double( desc.MinFileSize ) );
+    auto logMax = std::log( double( desc.MaxFileSize ) );
+
+    while ( total < desc.TotalSize )
+    {
+        // サイズは対数一様分布で選び, 小さなファイルが多く大きなファイルが少ない構成にします.
+        auto size = static_cast<size_t>( std::exp( logMin + ( logMax - logMin ) * random.NextDouble() ) );
+        size = ( size < desc.TotalSize - total ) ? size : static_cast<size_t>( desc.TotalSize - total );
+
+        auto kind = static_cast<ASSET_KIND>( index % NUM_ASSET_KIND );
+
+        char name[256];
+        sprintf( name, "%s/%05u%s", kKindDir[kind], index, kKindExt[kind] );
+
+        CorpusFile file;
+        file.Name = name;
+        file.Data.reserve( size + 256 );
+
+        switch ( kind )
+        {
+        case ASSET_MESH:    GenerateMesh   ( random, size, file.Data ); break;
+        case ASSET_TEXTURE: GenerateTexture( random, size, file.Data ); break;
+        case ASSET_FONT:    GenerateFont   ( random, size, file.Data ); break;
+        case ASSET_SHADER:  GenerateShader ( random, size, file.Data ); break;
+        default:            break;
+        }
+
+        total += file.Data.size();
+        index++;
+        files.push_back( std::move( file ) );
+    }
+}
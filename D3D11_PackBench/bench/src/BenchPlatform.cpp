@@ -0,0 +1,102 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : BenchPlatform.cpp
+// Desc : Platform Compatibility Layer for Asset Pack Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchPlatform.h>
+#include <chrono>
+
+#if defined(WIN32) || defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cerrno>
+#endif
+
+
+#if !defined(WIN32) && !defined(_WIN32)
+//-------------------------------------------------------------------------------------------------
+//      fopen_s() 互換のファイルオープンです.
+//-------------------------------------------------------------------------------------------------
+int fopen_s( FILE** ppFile, const char* path, const char* mode )
+{
+    *ppFile = fopen( path, mode );
+    return ( *ppFile != nullptr ) ? 0 : errno;
+}
+#endif//!defined(WIN32) && !defined(_WIN32)
+
+//-------------------------------------------------------------------------------------------------
+//      高分解能タイマーの現在値を秒単位で取得します.
+//-------------------------------------------------------------------------------------------------
+double GetBenchTime()
+{
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double>( now ).count();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ディレクトリを作成します.
+//-------------------------------------------------------------------------------------------------
+bool CreateBenchDirectory( const char* path )
+{
+    // 同名のファイル (ビルドした実行ファイルなど) がある場合は失敗とします.
+#if defined(WIN32) || defined(_WIN32)
+    auto ret = ( CreateDirectoryA( path, nullptr ) != FALSE );
+    if ( !ret && GetLastError() == ERROR_ALREADY_EXISTS )
+    {
+        auto attr = GetFileAttributesA( path );
+        ret = ( attr != INVALID_FILE_ATTRIBUTES ) && ( attr & FILE_ATTRIBUTE_DIRECTORY ) != 0;
+    }
+#else
+    auto ret = ( mkdir( path, 0755 ) == 0 );
+    if ( !ret && errno == EEXIST )
+    {
+        struct stat st;
+        ret = ( stat( path, &st ) == 0 ) && S_ISDIR( st.st_mode );
+    }
+#endif
+
+    if ( !ret )
+    { ELOGA( "Error : Directory Create Failed. path = %s", path ); }
+
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルのページキャッシュを破棄します.
+//-------------------------------------------------------------------------------------------------
+bool DropFileCache( const char* path )
+{
+#if defined(WIN32) || defined(_WIN32)
+    // 最後のキャッシュ付きハンドルが閉じられた後にバッファリングなしで開くと, キャッシュが破棄されます.
+    auto hFile = CreateFileA(
+        path,
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_FLAG_NO_BUFFERING,
+        nullptr );
+    if ( hFile == INVALID_HANDLE_VALUE )
+    { return false; }
+
+    CloseHandle( hFile );
+    return true;
+#else
+    auto fd = open( path, O_RDONLY );
+    if ( fd < 0 )
+    { return false; }
+
+    // ダーティページは破棄されないため, 先に書き戻します.
+    fdatasync( fd );
+    posix_fadvise( fd, 0, 0, POSIX_FADV_DONTNEED );
+    close( fd );
+    return true;
+#endif
+}
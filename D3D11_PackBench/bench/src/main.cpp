@@ -0,0 +1,471 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : main.cpp
+// Desc : Asset Pack Benchmark Main Entry Point.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <BenchPlatform.h>
+#include <BenchCorpus.h>
+#include <asdxAssetPack.h>
+#include <asdxJobSystem.h>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BenchDesc structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BenchDesc
+{
+    CorpusDesc      Corpus;         //!< コーパスの生成設定です.
+    std::string     Dir;            //!< 作業ディレクトリです.
+    uint32_t        BlockSize;      //!< 圧縮ブロックサイズです.
+    uint32_t        Threads;        //!< ワーカースレッド数です. 0 の場合は自動で決定します.
+    uint32_t        Iterations;     //!< 計測回数です.
+    bool            Warm;           //!< ページキャッシュを破棄せずに計測する場合は true です.
+
+    BenchDesc()
+    : Dir           ( "pack_bench_data" )
+    , BlockSize     ( asdx::ASSET_PACK_DEFAULT_BLOCK_SIZE )
+    , Threads       ( 0 )
+    , Iterations    ( 3 )
+    , Warm          ( false )
+    { /* DO_NOTHING */ }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BenchContext structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BenchContext
+{
+    std::vector<CorpusFile>     Files;          //!< コーパスです.
+    std::vector<std::string>    LoosePaths;     //!< 個別ファイルのパスです.
+    std::vector<size_t>         Offsets;        //!< 読み込み先バッファ内の各ファイルの位置です.
+    std::vector<uint8_t>        Buffer;         //!< 読み込み先バッファです.
+    std::string                 RawPack;        //!< 無圧縮パックのパスです.
+    std::string                 LzPack;         //!< 圧縮パックのパスです.
+    uint64_t                    TotalSize;      //!< 展開後の総サイズです.
+    uint64_t                    LooseSize;      //!< 個別ファイルの総サイズです.
+    uint64_t                    RawPackSize;    //!< 無圧縮パックのファイルサイズです.
+    uint64_t                    LzPackSize;     //!< 圧縮パックのファイルサイズです.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BENCH_CASE enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum BENCH_CASE
+{
+    CASE_LOOSE = 0,         //!< 個別ファイルを fopen() / fread() で読み込みます.
+    CASE_RAW_SERIAL,        //!< 無圧縮パックを1スレッドで読み込みます.
+    CASE_LZ_SERIAL,         //!< 圧縮パックを1スレッドで展開します.
+    CASE_RAW_PARALLEL,      //!< 無圧縮パックをエントリ単位で並列に読み込みます.
+    CASE_LZ_PARALLEL,       //!< 圧縮パックをエントリ単位とブロック単位で並列に展開します.
+    NUM_BENCH_CASE
+};
+
+static const char* kCaseName[NUM_BENCH_CASE] = {
+    "loose fread",
+    "raw pack serial",
+    "lz pack serial",
+    "raw pack parallel",
+    "lz pack parallel",
+};
+
+//-------------------------------------------------------------------------------------------------
+//      使用方法を表示します.
+//-------------------------------------------------------------------------------------------------
+void PrintUsage()
+{
+    printf( "Usage : bench [options]\n" );
+    printf( "  -dir <dir>           working directory (default: pack_bench_data)\n" );
+    printf( "  -size <MB>           total size of the synthetic corpus (default: 256)\n" );
+    printf( "  -block <KB>          compression block size, 64-256 (default: 128)\n" );
+    printf( "  -threads <N>         worker threads of the job system (default: auto)\n" );
+    printf( "  -iters <N>           measured iterations per case (default: 3)\n" );
+    printf( "  -seed <N>            corpus random seed (default: 305419896)\n" );
+    printf( "  -warm                keep the page cache between iterations\n" );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      コマンドライン引数を解析します.
+//-------------------------------------------------------------------------------------------------
+bool ParseArgs( int argc, char** argv, BenchDesc& desc )
+{
+    for( auto i=1; i<argc; ++i )
+    {
+        auto hasNext = ( i + 1 < argc );
+
+        if ( strcmp( argv[i], "-dir" ) == 0 && hasNext )
+        { desc.Dir = argv[++i]; }
+        else if ( strcmp( argv[i], "-size" ) == 0 && hasNext )
+        { desc.Corpus.TotalSize = strtoull( argv[++i], nullptr, 10 ) * 1024 * 1024; }
+        else if ( strcmp( argv[i], "-block" ) == 0 && hasNext )
+        { desc.BlockSize = uint32_t( strtoul( argv[++i], nullptr, 10 ) ) * 1024; }
+        else if ( strcmp( argv[i], "-threads" ) == 0 && hasNext )
+        { desc.Threads = uint32_t( atoi( argv[++i] ) ); }
+        else if ( strcmp( argv[i], "-iters" ) == 0 && hasNext )
+        { desc.Iterations = uint32_t( atoi( argv[++i] ) ); }
+        else if ( strcmp( argv[i], "-seed" ) == 0 && hasNext )
+        { desc.Corpus.Seed = uint32_t( strtoul( argv[++i], nullptr, 0 ) ); }
+        else if ( strcmp( argv[i], "-warm" ) == 0 )
+        { desc.Warm = true; }
+        else
+        {
+            ELOGA( "Error : Unknown Option. option = %s", argv[i] );
+            PrintUsage();
+            return false;
+        }
+    }
+
+    if ( desc.Corpus.TotalSize == 0 )
+    { desc.Corpus.TotalSize = 1024 * 1024; }
+
+    if ( desc.Iterations == 0 )
+    { desc.Iterations = 1; }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルサイズを取得します.
+//-------------------------------------------------------------------------------------------------
+uint64_t GetFileSize( const char* path )
+{
+    FILE* pFile = nullptr;
+    if ( fopen_s( &pFile, path, "rb" ) != 0 || pFile == nullptr )
+    { return 0; }
+
+    fseek( pFile, 0, SEEK_END );
+    auto size = uint64_t( ftell( pFile ) );
+    fclose( pFile );
+
+    return size;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      パックファイルを作成します.
+//-------------------------------------------------------------------------------------------------
+bool BuildPack( const BenchDesc& desc, BenchContext& context, bool compress, const std::string& path )
+{
+    asdx::AssetPackWriter writer;
+    writer.SetCompression( compress, desc.BlockSize );
+
+    for( auto& file : context.Files )
+    {
+        if ( !writer.AddMemory( file.Name.c_str(), file.Data.data(), file.Data.size() ) )
+        { return false; }
+    }
+
+    auto begin = GetBenchTime();
+    if ( !writer.Write( path.c_str() ) )
+    { return false; }
+    auto elapsed = GetBenchTime() - begin;
+
+    auto size = GetFileSize( path.c_str() );
+    printf( "  %-8s %8.2f MB -> %8.2f MB (%5.1f%%), %8.2f MB/s write\n",
+        compress ? "lz" : "raw",
+        double( context.TotalSize ) / ( 1024.0 * 1024.0 ),
+        double( size ) / ( 1024.0 * 1024.0 ),
+        100.0 * double( size ) / double( context.TotalSize ),
+        double( context.TotalSize ) / ( 1024.0 * 1024.0 ) / elapsed );
+
+    if ( compress )
+    { context.LzPackSize = size; }
+    else
+    { context.RawPackSize = size; }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      コーパスとパックファイルを準備します.
+//-------------------------------------------------------------------------------------------------
+bool Setup( const BenchDesc& desc, BenchContext& context )
+{
+    GenerateCorpus( desc.Corpus, context.Files );
+
+    context.TotalSize = 0;
+    context.LooseSize = 0;
+    context.Offsets.reserve( context.Files.size() );
+    for( auto& file : context.Files )
+    {
+        context.Offsets.push_back( size_t( context.TotalSize ) );
+        context.TotalSize += file.Data.size();
+    }
+
+    // 個別ファイルを書き出します.
+    auto looseDir = desc.Dir + "/loose";
+    if ( !CreateBenchDirectory( desc.Dir.c_str() ) || !CreateBenchDirectory( looseDir.c_str() ) )
+    { return false; }
+
+    for( auto& file : context.Files )
+    {
+        auto subDir = looseDir + "/" + file.Name.substr( 0, file.Name.find( '/' ) );
+        if ( !CreateBenchDirectory( subDir.c_str() ) )
+        { return false; }
+
+        auto path = looseDir + "/" + file.Name;
+
+        FILE* pFile = nullptr;
+        if ( fopen_s( &pFile, path.c_str(), "wb" ) != 0 || pFile == nullptr )
+        {
+            ELOGA( "Error : File Open Failed. path = %s", path.c_str() );
+            return false;
+        }
+
+        auto written = fwrite( file.Data.data(), 1, file.Data.size(), pFile );
+        fclose( pFile );
+
+        if ( written != file.Data.size() )
+        {
+            ELOGA( "Error : File Write Failed. path = %s", path.c_str() );
+            return false;
+        }
+
+        context.LooseSize += file.Data.size();
+        context.LoosePaths.push_back( path );
+    }
+
+    printf( "corpus : %zu files, %.2f MB\n",
+        context.Files.size(),
+        double( context.TotalSize ) / ( 1024.0 * 1024.0 ) );
+
+    context.RawPack = desc.Dir + "/raw.pak";
+    context.LzPack  = desc.Dir + "/lz.pak";
+
+    if ( !BuildPack( desc, context, false, context.RawPack )
+      || !BuildPack( desc, context, true,  context.LzPack ) )
+    { return false; }
+
+    // ページフォルトを計測に含めないよう, 読み込み先は事前に確保して触っておきます.
+    context.Buffer.resize( size_t( context.TotalSize ) );
+    memset( context.Buffer.data(), 0xCD, context.Buffer.size() );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      計測対象が使用するファイルのページキャッシュを破棄します.
+//-------------------------------------------------------------------------------------------------
+void DropCache( const BenchContext& context, BENCH_CASE type )
+{
+    switch( type )
+    {
+    case CASE_LOOSE:
+        for( auto& path : context.LoosePaths )
+        { DropFileCache( path.c_str() ); }
+        break;
+
+    case CASE_RAW_SERIAL:
+    case CASE_RAW_PARALLEL:
+        DropFileCache( context.RawPack.c_str() );
+        break;
+
+    case CASE_LZ_SERIAL:
+    case CASE_LZ_PARALLEL:
+        DropFileCache( context.LzPack.c_str() );
+        break;
+
+    default:
+        break;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      個別ファイルを読み込みます.
+//-------------------------------------------------------------------------------------------------
+bool ReadLoose( BenchContext& context )
+{
+    for( size_t i=0; i<context.Files.size(); ++i )
+    {
+        FILE* pFile = nullptr;
+        if ( fopen_s( &pFile, context.LoosePaths[i].c_str(), "rb" ) != 0 || pFile == nullptr )
+        { return false; }
+
+        auto size = context.Files[i].Data.size();
+        auto read = fread( &context.Buffer[ context.Offsets[i] ], 1, size, pFile );
+        fclose( pFile );
+
+        if ( read != size )
+        { return false; }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      パックファイルから全エントリを読み込みます.
+//-------------------------------------------------------------------------------------------------
+bool ReadPack( BenchContext& context, const std::string& path, bool parallel )
+{
+    asdx::AssetPack pack;
+    if ( !pack.Open( path.c_str() ) )
+    { return false; }
+
+    auto count = uint32_t( context.Files.size() );
+
+    auto read = [&]( uint32_t i, bool parallelBlocks ) -> bool
+    {
+        auto index = pack.FindIndex( context.Files[i].Name.c_str() );
+        if ( index < 0 )
+        { return false; }
+
+        return pack.Read(
+            uint32_t( index ),
+            &context.Buffer[ context.Offsets[i] ],
+            context.Files[i].Data.size(),
+            parallelBlocks );
+    };
+
+    if ( !parallel )
+    {
+        for( uint32_t i=0; i<count; ++i )
+        {
+            if ( !read( i, false ) )
+            { return false; }
+        }
+
+        return true;
+    }
+
+    // エントリ単位で分割し, 大きなエントリはさらにブロック単位でジョブに分割されます.
+    std::atomic<uint32_t> errors( 0 );
+    asdx::JobSystem::GetInstance().ParallelFor( count, [&]( uint32_t begin, uint32_t end )
+    {
+        for( auto i=begin; i<end; ++i )
+        {
+            if ( !read( i, true ) )
+            { errors.fetch_add( 1, std::memory_order_relaxed ); }
+        }
+    }, 1 );
+
+    return errors.load() == 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      読み込んだ内容がコーパスと一致するか確認します.
+//-------------------------------------------------------------------------------------------------
+bool Validate( const BenchContext& context )
+{
+    for( size_t i=0; i<context.Files.size(); ++i )
+    {
+        auto& file = context.Files[i];
+        if ( memcmp( &context.Buffer[ context.Offsets[i] ], file.Data.data(), file.Data.size() ) != 0 )
+        {
+            ELOGA( "Error : Data Mismatch. name = %s", file.Name.c_str() );
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      1ケースを計測します.
+//-------------------------------------------------------------------------------------------------
+bool RunCase( const BenchDesc& desc, BenchContext& context, BENCH_CASE type )
+{
+    uint64_t fileSize = context.LooseSize;
+    if ( type == CASE_RAW_SERIAL || type == CASE_RAW_PARALLEL )
+    { fileSize = context.RawPackSize; }
+    else if ( type == CASE_LZ_SERIAL || type == CASE_LZ_PARALLEL )
+    { fileSize = context.LzPackSize; }
+
+    auto best = 0.0;
+    auto sum  = 0.0;
+
+    for( uint32_t iter=0; iter<desc.Iterations; ++iter )
+    {
+        if ( !desc.Warm )
+        { DropCache( context, type ); }
+
+        memset( context.Buffer.data(), 0xCD, context.Buffer.size() );
+
+        auto begin = GetBenchTime();
+
+        auto ret = false;
+        switch( type )
+        {
+        case CASE_LOOSE:        ret = ReadLoose( context ); break;
+        case CASE_RAW_SERIAL:   ret = ReadPack ( context, context.RawPack, false ); break;
+        case CASE_LZ_SERIAL:    ret = ReadPack ( context, context.LzPack,  false ); break;
+        case CASE_RAW_PARALLEL: ret = ReadPack ( context, context.RawPack, true  ); break;
+        case CASE_LZ_PARALLEL:  ret = ReadPack ( context, context.LzPack,  true  ); break;
+        default:                break;
+        }
+
+        auto elapsed = GetBenchTime() - begin;
+
+        if ( !ret )
+        {
+            ELOGA( "Error : Read Failed. case = %s", kCaseName[type] );
+            return false;
+        }
+
+        if ( iter == 0 && !Validate( context ) )
+        { return false; }
+
+        best = ( iter == 0 || elapsed < best ) ? elapsed : best;
+        sum += elapsed;
+    }
+
+    auto avg = sum / double( desc.Iterations );
+    printf( "  %-20s %10.2f %10.2f %10.2f %10.2f\n",
+        kCaseName[type],
+        double( context.TotalSize ) / ( 1024.0 * 1024.0 ) / best,
+        double( fileSize ) / ( 1024.0 * 1024.0 ) / best,
+        best * 1000.0,
+        avg  * 1000.0 );
+
+    return true;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-------------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+    BenchDesc desc;
+    if ( !ParseArgs( argc, argv, desc ) )
+    { return 1; }
+
+    if ( !asdx::JobSystem::GetInstance().Init( desc.Threads ) )
+    { return 1; }
+
+    auto ret = 0;
+
+    BenchContext context;
+    if ( Setup( desc, context ) )
+    {
+        printf( "\n%s cache, %u iterations, %u KB blocks\n",
+            desc.Warm ? "warm" : "cold",
+            desc.Iterations,
+            desc.BlockSize / 1024 );
+        printf( "  %-20s %10s %10s %10s %10s\n", "case", "MB/s", "file MB/s", "best ms", "avg ms" );
+
+        for( auto type=0; type<NUM_BENCH_CASE; ++type )
+        {
+            if ( !RunCase( desc, context, BENCH_CASE( type ) ) )
+            {
+                ret = 1;
+                break;
+            }
+        }
+    }
+    else
+    { ret = 1; }
+
+    asdx::JobSystem::GetInstance().Term();
+    return ret;
+}
@@ -0,0 +1,283 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : main.cpp
+// Desc : Asset Pack Tool Main Entry Point.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <ToolPlatform.h>
+#include <asdxAssetPack.h>
+#include <asdxJobSystem.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+    #include <Windows.h>
+#else
+    #include <dirent.h>
+    #include <sys/stat.h>
+#endif//defined(_WIN32)
+
+
+namespace /* anonymous */ {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SourceFile structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct SourceFile
+{
+    std::string     Name;       //!< 入力ディレクトリからの相対パスです.
+    std::string     Path;       //!< ファイルパスです.
+};
+
+//-------------------------------------------------------------------------------------------------
+//      使用方法を表示します.
+//-------------------------------------------------------------------------------------------------
+void PrintUsage()
+{
+    printf( "Usage : packtool <command> [options]\n" );
+    printf( "  build <dir> <pack> [-prefix <path>] [-compress] [-block <KB>] [-verbose]\n" );
+    printf( "                       pack every file under <dir> into <pack>\n" );
+    printf( "                       entry names are relative to <dir>, prepended by <path>\n" );
+    printf( "                       -compress stores entries as LZ blocks of <KB> (64-256, default: 128)\n" );
+    printf( "  list <pack>          print entries of <pack>\n" );
+    printf( "  verify <pack>        check the CRC of every entry of <pack>\n" );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ディレクトリ以下のファイルを再帰的に列挙します.
+//-------------------------------------------------------------------------------------------------
+bool EnumerateFiles( const std::string& dir, const std::string& name, std::vector<SourceFile>& result )
+{
+#if defined(_WIN32)
+    WIN32_FIND_DATAA data;
+    auto hFind = FindFirstFileA( ( dir + "\\*" ).c_str(), &data );
+    if ( hFind == INVALID_HANDLE_VALUE )
+    {
+        fprintf( stderr, "Error : FindFirstFileA() Failed. path = %s\n", dir.c_str() );
+        return false;
+    }
+
+    auto ret = true;
+    do
+    {
+        if ( strcmp( data.cFileName, "." ) == 0 || strcmp( data.cFileName, ".." ) == 0 )
+        { continue; }
+
+        auto path  = dir + "\\" + data.cFileName;
+        auto entry = name.empty() ? std::string( data.cFileName ) : name + "/" + data.cFileName;
+
+        if ( data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY )
+        { ret = EnumerateFiles( path, entry, result ); }
+        else
+        { result.push_back( SourceFile{ entry, path } ); }
+    }
+    while ( ret && FindNextFileA( hFind, &data ) );
+
+    FindClose( hFind );
+    return ret;
+#else
+    auto pDir = opendir( dir.c_str() );
+    if ( pDir == nullptr )
+    {
+        fprintf( stderr, "Error : opendir() Failed. path = %s\n", dir.c_str() );
+        return false;
+    }
+
+    auto ret = true;
+    for ( auto pEntry = readdir( pDir ); ret && pEntry != nullptr; pEntry = readdir( pDir ) )
+    {
+        if ( strcmp( pEntry->d_name, "." ) == 0 || strcmp( pEntry->d_name, ".." ) == 0 )
+        { continue; }
+
+        auto path  = dir + "/" + pEntry->d_name;
+        auto entry = name.empty() ? std::string( pEntry->d_name ) : name + "/" + pEntry->d_name;
+
+        struct stat st;
+        if ( stat( path.c_str(), &st ) != 0 )
+        { continue; }
+
+        if ( S_ISDIR( st.st_mode ) )
+        { ret = EnumerateFiles( path, entry, result ); }
+        else if ( S_ISREG( st.st_mode ) )
+        { result.push_back( SourceFile{ entry, path } ); }
+    }
+
+    closedir( pDir );
+    return ret;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      パックファイルを作成します.
+//-------------------------------------------------------------------------------------------------
+int Build( int argc, char** argv )
+{
+    if ( argc < 4 )
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    std::string dir  = argv[2];
+    std::string pack = argv[3];
+    std::string prefix;
+    auto verbose   = false;
+    auto compress  = false;
+    auto blockSize = asdx::ASSET_PACK_DEFAULT_BLOCK_SIZE;
+
+    for ( auto i = 4; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-prefix" ) == 0 && i + 1 < argc )
+        { prefix = asdx::NormalizeAssetPath( argv[++i] ); }
+        else if ( strcmp( argv[i], "-compress" ) == 0 )
+        { compress = true; }
+        else if ( strcmp( argv[i], "-block" ) == 0 && i + 1 < argc )
+        { blockSize = static_cast<uint32_t>( strtoul( argv[++i], nullptr, 10 ) ) * 1024; }
+        else if ( strcmp( argv[i], "-verbose" ) == 0 )
+        { verbose = true; }
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    while ( !prefix.empty() && prefix.back() == '/' )
+    { prefix.pop_back(); }
+
+    auto begin = std::chrono::steady_clock::now();
+
+    std::vector<SourceFile> files;
+    if ( !EnumerateFiles( dir, prefix, files ) )
+    { return 1; }
+
+    asdx::AssetPackWriter writer;
+    writer.SetCompression( compress, blockSize );
+
+    for ( auto& file : files )
+    {
+        if ( verbose )
+        { printf( "  %s\n", file.Name.c_str() ); }
+
+        if ( !writer.AddFile( file.Name.c_str(), file.Path.c_str() ) )
+        { return 1; }
+    }
+
+    if ( !writer.Write( pack.c_str() ) )
+    { return 1; }
+
+    auto end  = std::chrono::steady_clock::now();
+    auto msec = std::chrono::duration<double, std::milli>( end - begin ).count();
+
+    // 書き出した結果を開き直して, 目次が正しく読めることを確認します.
+    asdx::AssetPack result;
+    if ( !result.Open( pack.c_str() ) )
+    { return 1; }
+
+    uint64_t payload    = 0;
+    uint64_t stored     = 0;
+    uint32_t compressed = 0;
+    for ( uint32_t i = 0; i < result.GetEntryCount(); ++i )
+    {
+        payload += result.GetSize( i );
+        stored  += result.GetStoredSize( i );
+        if ( result.IsCompressed( i ) )
+        { compressed++; }
+    }
+
+    printf( "%u files (%u compressed), %llu -> %llu bytes payload -> %s (%.2f msec)\n",
+        result.GetEntryCount(),
+        compressed,
+        static_cast<unsigned long long>( payload ),
+        static_cast<unsigned long long>( stored ),
+        pack.c_str(),
+        msec );
+
+    return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      エントリを表示します.
+//-------------------------------------------------------------------------------------------------
+int List( int argc, char** argv )
+{
+    if ( argc < 3 )
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    asdx::AssetPack pack;
+    if ( !pack.Open( argv[2] ) )
+    { return 1; }
+
+    for ( uint32_t i = 0; i < pack.GetEntryCount(); ++i )
+    {
+        printf( "%12llu %12llu %s  %s\n",
+            static_cast<unsigned long long>( pack.GetSize( i ) ),
+            static_cast<unsigned long long>( pack.GetStoredSize( i ) ),
+            pack.IsCompressed( i ) ? "lz " : "raw",
+            pack.GetEntryName( i ) );
+    }
+
+    printf( "%u entries\n", pack.GetEntryCount() );
+    return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      全エントリの CRC を検証します.
+//-------------------------------------------------------------------------------------------------
+int Verify( int argc, char** argv )
+{
+    if ( argc < 3 )
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    asdx::AssetPack pack;
+    if ( !pack.Open( argv[2] ) )
+    { return 1; }
+
+    auto errors = pack.VerifyAll();
+    printf( "%u entries, %u errors\n", pack.GetEntryCount(), errors );
+
+    return ( errors == 0 ) ? 0 : 1;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-------------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+    if ( argc < 2 )
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    // 圧縮と展開はブロック単位でジョブシステム上で並列に行います.
+    asdx::JobSystem::GetInstance().Init();
+
+    auto ret = 1;
+    if ( strcmp( argv[1], "build" ) == 0 )
+    { ret = Build( argc, argv ); }
+    else if ( strcmp( argv[1], "list" ) == 0 )
+    { ret = List( argc, argv ); }
+    else if ( strcmp( argv[1], "verify" ) == 0 )
+    { ret = Verify( argc, argv ); }
+    else
+    { PrintUsage(); }
+
+    asdx::JobSystem::GetInstance().Term();
+    return ret;
+}
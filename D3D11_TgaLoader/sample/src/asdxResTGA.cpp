@@ -55,10 +55,9 @@ void Parse24Bits( FILE* pFile, u32 size, u8* pPixels )
 {
     for( u32 i=0; i<size; ++i )
     {
-        pPixels[ i * 4 + 2 ] = (u8)fgetc( pFile );
-        pPixels[ i * 4 + 1 ] = (u8)fgetc( pFile );
-        pPixels[ i * 4 + 0 ] = (u8)fgetc( pFile );
-        pPixels[ i * 4 + 3 ] = 255;
+        pPixels[ i * 3 + 2 ] = (u8)fgetc( pFile );
+        pPixels[ i * 3 + 1 ] = (u8)fgetc( pFile );
+        pPixels[ i * 3 + 0 ] = (u8)fgetc( pFile );
     }
 }
 
@@ -495,7 +494,7 @@ bool ResTGA::Load( const char16* filename )
     if ( header.HasColorMap )
     {
         // カラーマップサイズを算出.
-        u32 colorMapSize = header.ColorMapEntry * ( header.ColorMapEntrySize >> 3 );
+        u32 colorMapSize = header.ColorMapLength * ( header.ColorMapEntrySize >> 3 );
 
         // メモリを確保.
         pColorMap = new (std::nothrow) u8 [ colorMapSize ];
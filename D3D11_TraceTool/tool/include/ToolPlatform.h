@@ -0,0 +1,40 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : ToolPlatform.h
+// Desc : Platform Compatibility Layer for Log Trace Tool.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __TOOL_PLATFORM_H__
+#define __TOOL_PLATFORM_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdio>
+#include <cerrno>
+
+
+//-------------------------------------------------------------------------------------------------
+// ツールは asdx ライブラリをリンクしないため, トレースモジュールのログ出力をここで受け取ります.
+// このヘッダはコンパイラオプションで強制インクルード (/FI, -include) して使用します.
+//-------------------------------------------------------------------------------------------------
+#define DLOGA( fmt, ... )   ((void)0)
+#define ILOGA( fmt, ... )   fprintf( stderr, fmt "\n", ##__VA_ARGS__ )
+#define WLOGA( fmt, ... )   fprintf( stderr, fmt "\n", ##__VA_ARGS__ )
+#define ELOGA( fmt, ... )   fprintf( stderr, "[File: %s, Line: %d] " fmt "\n", __FILE__, __LINE__, ##__VA_ARGS__ )
+#define ELOG                ELOGA
+
+
+#if !defined(_WIN32)
+//-------------------------------------------------------------------------------------------------
+//      Win32 CRT の fopen_s() 互換関数です.
+//-------------------------------------------------------------------------------------------------
+inline int fopen_s( FILE** ppFile, const char* path, const char* mode )
+{
+    *ppFile = fopen( path, mode );
+    return ( *ppFile != nullptr ) ? 0 : errno;
+}
+#endif//!defined(_WIN32)
+
+
+#endif//__TOOL_PLATFORM_H__
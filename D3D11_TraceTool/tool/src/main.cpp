@@ -0,0 +1,386 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : main.cpp
+// Desc : Log Trace Tool Main Entry Point.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <ToolPlatform.h>
+#include <asdxLogTrace.h>
+#include <asdxLogFormat.h>
+#include <algorithm>
+#include <cstdarg>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const char*  kLevelNames = "VIDWE";      // ログレベルの略称です.
+static const uint32_t kSlotArgSize = 480;       // SystemLogger の 1 スロットに格納できる引数のサイズ (64bit) です.
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FormatStats structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct FormatStats
+{
+    uint32_t    Id;         //!< 書式 ID です.
+    uint64_t    Count;      //!< ログ数です.
+    uint64_t    ArgBytes;   //!< 引数の合計サイズです.
+};
+
+//-------------------------------------------------------------------------------------------------
+//      使用方法を表示します.
+//-------------------------------------------------------------------------------------------------
+void PrintUsage()
+{
+    printf( "Usage : tracetool <command> [options]\n" );
+    printf( "  dump <trace> [-level <v|i|d|w|e>] [-thread <id>] [-format <id>]\n" );
+    printf( "                       print every record of <trace> as text\n" );
+    printf( "                       -level skips records below the given level\n" );
+    printf( "  formats <trace>      print the format table of <trace> with record counts\n" );
+    printf( "  check                pack and format sample logs and compare with the expected text\n" );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ログレベルの略称を取得します.
+//-------------------------------------------------------------------------------------------------
+char GetLevelName( asdx::LogLevel level )
+{
+    auto index = uint32_t( level );
+    return ( index < strlen( kLevelNames ) ) ? kLevelNames[index] : '?';
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルサイズを取得します.
+//-------------------------------------------------------------------------------------------------
+uint64_t GetFileSize( const char* path )
+{
+    FILE* pFile = nullptr;
+    if ( fopen_s( &pFile, path, "rb" ) != 0 )
+    { return 0; }
+
+    fseek( pFile, 0, SEEK_END );
+    auto size = ftell( pFile );
+    fclose( pFile );
+
+    return ( size > 0 ) ? uint64_t( size ) : 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      末尾の情報を表示します.
+//-------------------------------------------------------------------------------------------------
+void PrintSummary( const char* path, const asdx::LogTraceReader& reader, uint64_t count )
+{
+    auto size = GetFileSize( path );
+    fprintf( stderr, "%llu records, %u formats, %llu bytes (%.1f bytes/record)\n",
+        static_cast<unsigned long long>( count ),
+        reader.GetFormatCount(),
+        static_cast<unsigned long long>( size ),
+        ( count > 0 ) ? double( size ) / double( count ) : 0.0 );
+
+    if ( reader.IsBroken() )
+    { fprintf( stderr, "Warning : the trace ends with a broken or incomplete record.\n" ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      全レコードを文字列に復元して表示します.
+//-------------------------------------------------------------------------------------------------
+int Dump( int argc, char** argv )
+{
+    if ( argc < 3 )
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    auto        minLevel = 0u;
+    auto        threadId = 0ull;
+    auto        formatId = 0ull;
+    auto        byThread = false;
+    auto        byFormat = false;
+
+    for ( auto i = 3; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-level" ) == 0 && i + 1 < argc )
+        {
+            auto pName = strchr( kLevelNames, toupper( argv[++i][0] ) );
+            if ( pName == nullptr || argv[i][0] == '\0' )
+            {
+                PrintUsage();
+                return 1;
+            }
+            minLevel = uint32_t( pName - kLevelNames );
+        }
+        else if ( strcmp( argv[i], "-thread" ) == 0 && i + 1 < argc )
+        {
+            threadId = strtoull( argv[++i], nullptr, 10 );
+            byThread = true;
+        }
+        else if ( strcmp( argv[i], "-format" ) == 0 && i + 1 < argc )
+        {
+            formatId = strtoull( argv[++i], nullptr, 10 );
+            byFormat = true;
+        }
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    asdx::LogTraceReader reader;
+    if ( !reader.Open( argv[2] ) )
+    { return 1; }
+
+    asdx::LogTraceEvent event;
+    std::string text;
+    uint64_t    count = 0;
+
+    while ( reader.Next( event ) )
+    {
+        count++;
+
+        if ( uint32_t( event.Level ) < minLevel
+          || ( byThread && event.ThreadId != threadId )
+          || ( byFormat && event.FormatId != formatId ) )
+        { continue; }
+
+        text.clear();
+        asdx::FormatLogArgs( event.pFormat, event.pArgs, event.ArgSize, text );
+
+        if ( text.empty() || text.back() != '\n' )
+        { text.push_back( '\n' ); }
+
+        auto sec  = time_t( event.Time / 1000000000ull );
+        auto msec = uint32_t( ( event.Time / 1000000ull ) % 1000 );
+
+        tm local = {};
+    #if defined(_WIN32)
+        localtime_s( &local, &sec );
+    #else
+        localtime_r( &sec, &local );
+    #endif
+
+        printf( "%02d:%02d:%02d.%03u [%c][%5u] %s",
+            local.tm_hour,
+            local.tm_min,
+            local.tm_sec,
+            msec,
+            GetLevelName( event.Level ),
+            event.ThreadId,
+            text.c_str() );
+    }
+
+    PrintSummary( argv[2], reader, count );
+    return reader.IsBroken() ? 1 : 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      書式の一覧を表示します.
+//-------------------------------------------------------------------------------------------------
+int Formats( int argc, char** argv )
+{
+    if ( argc < 3 )
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    asdx::LogTraceReader reader;
+    if ( !reader.Open( argv[2] ) )
+    { return 1; }
+
+    std::vector<FormatStats> stats;
+    asdx::LogTraceEvent event;
+    uint64_t count = 0;
+
+    while ( reader.Next( event ) )
+    {
+        count++;
+
+        while ( stats.size() <= event.FormatId )
+        { stats.push_back( FormatStats{ uint32_t( stats.size() ), 0, 0 } ); }
+
+        stats[event.FormatId].Count++;
+        stats[event.FormatId].ArgBytes += event.ArgSize;
+    }
+
+    while ( stats.size() < reader.GetFormatCount() )
+    { stats.push_back( FormatStats{ uint32_t( stats.size() ), 0, 0 } ); }
+
+    // 出力が多い順に並べます.
+    std::stable_sort( stats.begin(), stats.end(), []( const FormatStats& lhs, const FormatStats& rhs )
+    { return lhs.Count > rhs.Count; });
+
+    printf( "%6s %12s %12s  %s\n", "id", "records", "arg bytes", "format" );
+    for ( auto& item : stats )
+    {
+        // 改行はエスケープして 1 行に収めます.
+        std::string format;
+        for ( auto p = reader.GetFormat( item.Id ); *p != '\0'; ++p )
+        {
+            if ( *p == '\n' )       { format += "\\n"; }
+            else if ( *p == '\r' )  { format += "\\r"; }
+            else if ( *p == '\t' )  { format += "\\t"; }
+            else                    { format.push_back( *p ); }
+        }
+
+        printf( "%6u %12llu %12llu  %s\n",
+            item.Id,
+            static_cast<unsigned long long>( item.Count ),
+            static_cast<unsigned long long>( item.ArgBytes ),
+            format.c_str() );
+    }
+
+    PrintSummary( argv[2], reader, count );
+    return reader.IsBroken() ? 1 : 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      引数をパックしてから書式化します. pPackedSize にはパックしたサイズを格納します.
+//-------------------------------------------------------------------------------------------------
+std::string PackAndFormat( uint32_t bufferSize, uint32_t* pPackedSize, const char* format, ... )
+{
+    std::vector<uint8_t> buffer( bufferSize );
+
+    va_list args;
+    va_start( args, format );
+    auto size = asdx::PackLogArgs( format, args, buffer.data(), bufferSize );
+    va_end( args );
+
+    if ( pPackedSize != nullptr )
+    { *pPackedSize = size; }
+
+    std::string result;
+    asdx::FormatLogArgs( format, buffer.data(), size, result );
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      検証結果を表示します.
+//-------------------------------------------------------------------------------------------------
+bool Expect( const char* name, bool passed, const std::string& text )
+{
+    printf( "%-24s %s\n", name, passed ? "ok" : "FAILED" );
+    if ( !passed )
+    { printf( "    result : %s\n", text.c_str() ); }
+
+    return passed;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      文字列が指定の末尾で終わるかどうかを判定します.
+//-------------------------------------------------------------------------------------------------
+bool EndsWith( const std::string& text, const char* suffix )
+{
+    auto length = strlen( suffix );
+    return text.size() >= length && text.compare( text.size() - length, length, suffix ) == 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      パックと書式化の往復を検証します.
+//-------------------------------------------------------------------------------------------------
+int Check()
+{
+    std::string longText ( 2000, 'a' );
+    std::string otherText( 2000, 'b' );
+    auto passed = true;
+
+    // 収まる場合は printf と同じ結果になります.
+    {
+        auto text = PackAndFormat( kSlotArgSize, nullptr, "%s %d %5.2f %x %c %p", "name", -12, 3.25, 255u, 'z', nullptr );
+
+        char expect[256];
+        snprintf( expect, sizeof(expect), "%s %d %5.2f %x %c %p", "name", -12, 3.25, 255u, 'z', nullptr );
+        passed &= Expect( "fit", text == expect, text );
+    }
+
+    // 長い文字列の後の引数も残ります.
+    {
+        auto text = PackAndFormat( kSlotArgSize, nullptr, "%s %d %u %.1f %s", longText.c_str(), -1, 2u, 0.5, "tail" );
+        passed &= Expect( "long string", EndsWith( text, "... -1 2 0.5 tail" ) && text.find( '%' ) == std::string::npos, text );
+    }
+
+    // 長い文字列が続く場合は後続の文字列にも一部を残します.
+    {
+        auto text = PackAndFormat( kSlotArgSize, nullptr, "%s|%s|%d", longText.c_str(), otherText.c_str(), 7 );
+        passed &= Expect( "two long strings", text.find( "...|bbbb" ) != std::string::npos && EndsWith( text, "...|7" ), text );
+    }
+
+    // 引数で指定する幅と精度も残ります.
+    {
+        auto text = PackAndFormat( kSlotArgSize, nullptr, "%s %*.*f", longText.c_str(), 6, 2, 1.5 );
+        passed &= Expect( "star width", EndsWith( text, "...   1.50" ), text );
+    }
+
+    // 後続の引数が無い場合は格納先をすべて使います.
+    {
+        auto text = PackAndFormat( kSlotArgSize, nullptr, "%s", longText.c_str() );
+        passed &= Expect( "last string", text.size() == kSlotArgSize - 4 && EndsWith( text, "..." ), text );
+    }
+
+    // 格納先が小さすぎる場合は収まらない変換指定をそのまま出力します.
+    {
+        auto text = PackAndFormat( 16, nullptr, "%s %d %d", longText.c_str(), 1, 2 );
+        passed &= Expect( "tiny buffer", EndsWith( text, " 1 %d" ), text );
+    }
+
+    // 精度を指定した文字列は終端文字が無くてもよく, 精度を超えて読みません.
+    // 格納先の直後を読むと AddressSanitizer で検出できるよう, 必要な長さだけ確保します.
+    {
+        std::vector<char> buffer( 8, 'c' );
+        auto text = PackAndFormat( kSlotArgSize, nullptr, "%.*s|%d", int( buffer.size() ), buffer.data(), 5 );
+        passed &= Expect( "precision star", text == "cccccccc|5", text );
+    }
+
+    {
+        uint32_t size = 0;
+        auto text = PackAndFormat( kSlotArgSize, &size, "%.4s|%d", longText.c_str(), 5 );
+        passed &= Expect( "precision", text == "aaaa|5" && size == ( 1 + 2 + 4 + 1 ) + ( 1 + 8 ), text );
+    }
+
+    {
+        std::vector<wchar_t> buffer( 3, L'w' );
+        auto text = PackAndFormat( kSlotArgSize, nullptr, "%.*ls|%d", int( buffer.size() ), buffer.data(), 5 );
+        passed &= Expect( "wide precision", text == "www|5", text );
+    }
+
+    return passed ? 0 : 1;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-------------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+    if ( argc < 2 )
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    auto ret = 1;
+    if ( strcmp( argv[1], "dump" ) == 0 )
+    { ret = Dump( argc, argv ); }
+    else if ( strcmp( argv[1], "formats" ) == 0 )
+    { ret = Formats( argc, argv ); }
+    else if ( strcmp( argv[1], "check" ) == 0 )
+    { ret = Check(); }
+    else
+    { PrintUsage(); }
+
+    return ret;
+}